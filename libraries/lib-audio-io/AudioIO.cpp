@@ -115,6 +115,9 @@ time warp info and AudioIOListener and whether the playback is looped.
 
 #include "Gain.h"
 
+#include "concurrency/WorkStealingPool.h"
+#include "concurrency/WorkerTeam.h"
+
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
    #define LOWER_BOUND 0.0
    #define UPPER_BOUND 1.0
@@ -309,6 +312,7 @@ AudioIO::AudioIO()
 void AudioIO::StartThread()
 {
    mAudioThread = std::thread(AudioThread, ref(mFinishAudioThread));
+   mCaptureThread = std::thread(CaptureThread, ref(mFinishAudioThread));
 }
 
 AudioIO::~AudioIO()
@@ -341,6 +345,8 @@ AudioIO::~AudioIO()
 
    mFinishAudioThread.store(true, std::memory_order_release);
    mAudioThread.join();
+   NotifyCaptureWriter();
+   mCaptureThread.join();
 }
 
 std::shared_ptr<RealtimeEffectState>
@@ -1083,6 +1089,8 @@ int AudioIO::StartStream(const TransportSequences &sequences,
       // playback, since our ring buffers have been primed already with 4 sec
       // of audio, but then we might be scrubbing, so do it.
       StartAudioThread();
+      if (!mCaptureSequences.empty())
+         StartCaptureWriter();
 
       mForceFadeOut.store(false, std::memory_order_relaxed);
 
@@ -1095,6 +1103,7 @@ int AudioIO::StartStream(const TransportSequences &sequences,
          mStreamToken = 0;
 
          StopAudioThread();
+         StopCaptureWriter();
 
          if (pListener && mNumCaptureChannels > 0)
             pListener->OnAudioIOStopRecording();
@@ -1325,6 +1334,23 @@ bool AudioIO::AllocateBuffers(
                   ));
             }
 
+            // The audio thread processes mixers itself too, so it needs help
+            // from at most one fewer threads than there are mixers.  Make
+            // them now, so that processing each slice allocates nothing.
+            using audacity::concurrency::WorkerTeam;
+            using audacity::concurrency::WorkStealingPool;
+            const auto nMixers = mPlaybackMixers.size();
+            const auto nThreads = AudioIOPlaybackThreads.Read();
+            const size_t nHelpers = nMixers < 2 ? 0 : std::min(nMixers - 1,
+               nThreads > 0
+                  ? size_t(nThreads - 1)
+                  : WorkStealingPool::DefaultThreadCount());
+            if (nHelpers == 0)
+               mpPlaybackTeam.reset();
+            else if (!mpPlaybackTeam ||
+               mpPlaybackTeam->GetHelperCount() != nHelpers)
+               mpPlaybackTeam = std::make_unique<WorkerTeam>(nHelpers);
+
             const auto timeQueueSize = 1 +
                (playbackBufferSize + TimeQueueGrainSize - 1)
                   / TimeQueueGrainSize;
@@ -1530,6 +1556,9 @@ void AudioIO::StopStream()
    // be sure it has really stopped before resetting mpTransportState
    WaitForAudioThreadStopped();
 
+   // The final drain of the capture buffers below happens in the audio thread
+   StopCaptureWriter();
+
 
    for( auto &ext : Extensions() )
       ext.StopOtherStream();
@@ -1868,6 +1897,29 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
    }
 }
 
+void AudioIO::CaptureThread(std::atomic<bool> &finish)
+{
+   AudioIO *const gAudioIO = AudioIO::Get();
+   while (!finish.load(std::memory_order_acquire)) {
+      // The audio thread notifies after each of its passes; the timeout
+      // is only a fallback
+      using namespace std::chrono;
+      std::unique_lock<std::mutex> lock{ gAudioIO->mCaptureWriterMutex };
+      gAudioIO->mCaptureWriterWakeUp.wait_for(lock, 50ms);
+      if (!gAudioIO->mCaptureWriterRunning.load(std::memory_order_relaxed))
+         continue;
+
+      // Draining is done without the lock, and StopCaptureWriter waits for
+      // the pass to end
+      gAudioIO->mCaptureWriterActive = true;
+      lock.unlock();
+      gAudioIO->DrainRecordBuffers();
+      lock.lock();
+      gAudioIO->mCaptureWriterActive = false;
+      gAudioIO->mCaptureWriterIdle.notify_all();
+   }
+}
+
 size_t AudioIoCallback::MinValue(
    const RingBuffers &buffers, size_t (RingBuffer::*pmf)() const)
 {
@@ -1906,7 +1958,13 @@ size_t AudioIO::GetCommonlyAvailCapture()
 void AudioIO::SequenceBufferExchange()
 {
    FillPlayBuffers();
-   DrainRecordBuffers();
+   // Disk latency in the capture thread must not delay the next
+   // FillPlayBuffers, so only drain here when that thread is not doing it,
+   // as in the final pass after stopping the stream
+   if (mCaptureWriterRunning.load(std::memory_order_acquire))
+      NotifyCaptureWriter();
+   else
+      DrainRecordBuffers();
 }
 
 void AudioIO::FillPlayBuffers()
@@ -2009,6 +2067,10 @@ bool AudioIO::ProcessPlaybackSlices(
    for(unsigned n = 0; n < mProcessingBuffers.size(); ++n)
       processingBufferOffsets[n] = mProcessingBuffers[n].size();
 
+   // mixer outputs of each slice
+   const auto nMixers = mPlaybackMixers.size();
+   const auto producedCounts = stackAllocate(size_t, nMixers);
+
    do {
       const auto slice =
          policy.GetPlaybackSlice(mPlaybackSchedule, available);
@@ -2022,19 +2084,31 @@ bool AudioIO::ProcessPlaybackSlices(
       // atomic variables, the time queue doesn't.
       mPlaybackSchedule.mTimeQueue.Producer(mPlaybackSchedule, slice);
 
+      // The mixer here isn't actually mixing: it's just doing
+      // resampling, format conversion, and possibly time track
+      // warping.  Each has its own sequence and buffers, so they may be
+      // processed concurrently, but all must finish before the copying
+      // to the processing buffers.
+      std::fill_n(producedCounts, nMixers, 0);
+      if (frames > 0 && toProduce) {
+         const auto process = [&](size_t iMixer) {
+            producedCounts[iMixer] =
+               mPlaybackMixers[iMixer]->Process(toProduce);
+         };
+         if (mpPlaybackTeam)
+            mpPlaybackTeam->Run(nMixers, process);
+         else
+            for (size_t iMixer = 0; iMixer < nMixers; ++iMixer)
+               process(iMixer);
+      }
+
       // mPlaybackMixers correspond one-to-one with mPlaybackSequences
       size_t iSequence = 0;
       // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
       size_t iBuffer = 0;
       for (auto &mixer : mPlaybackMixers) {
-         // The mixer here isn't actually mixing: it's just doing
-         // resampling, format conversion, and possibly time track
-         // warping
          if (frames > 0) {
-            size_t produced = 0;
-
-            if (toProduce)
-               produced = mixer->Process(toProduce);
+            const auto produced = producedCounts[iSequence];
 
             //wxASSERT(produced <= toProduce);
             // Copy (non-interleaved) mixer outputs to one or more ring buffers
@@ -2284,9 +2358,12 @@ void AudioIO::DrainRecordBuffers()
 
       double deltat = avail / mRate;
 
+      // When the writer falls behind, take whatever is ready rather than
+      // wait to accumulate a full batch
       if (mAudioThreadShouldCallSequenceBufferExchangeOnce
           .load(std::memory_order_relaxed) ||
-          deltat >= mMinCaptureSecsToCopy)
+          deltat >= mMinCaptureSecsToCopy ||
+          (avail > 0 && GetCaptureBacklog() >= 0.5))
       {
          bool newBlocks = false;
 
@@ -3381,6 +3458,39 @@ void AudioIoCallback::WaitForAudioThreadStopped()
    mAudioThreadAcknowledge.store(Acknowledge::eNone, std::memory_order_release);
 }
 
+void AudioIoCallback::StartCaptureWriter()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mCaptureWriterMutex };
+      mCaptureWriterRunning.store(true, std::memory_order_release);
+   }
+   NotifyCaptureWriter();
+}
+
+void AudioIoCallback::StopCaptureWriter()
+{
+   std::unique_lock<std::mutex> lock{ mCaptureWriterMutex };
+   mCaptureWriterRunning.store(false, std::memory_order_release);
+   mCaptureWriterIdle.wait(lock, [this]{ return !mCaptureWriterActive; });
+}
+
+void AudioIoCallback::NotifyCaptureWriter()
+{
+   mCaptureWriterWakeUp.notify_one();
+}
+
+double AudioIoCallback::GetCaptureBacklog() const
+{
+   double result = 0;
+   for (const auto &pBuffer : mCaptureBuffers) {
+      const auto ready = pBuffer->AvailForGet();
+      const auto capacity = ready + pBuffer->AvailForPut();
+      if (capacity > 0)
+         result = std::max(result, double(ready) / capacity);
+   }
+   return result;
+}
+
 void AudioIoCallback::ProcessOnceAndWait(std::chrono::milliseconds sleepTime)
 {
    mAudioThreadShouldCallSequenceBufferExchangeOnce
@@ -3406,3 +3516,4 @@ bool AudioIO::IsCapturing() const
 }
 
 BoolSetting SoundActivatedRecord{ "/AudioIO/SoundActivatedRecord", false };
+IntSetting AudioIOPlaybackThreads{ "/AudioIO/PlaybackThreads", 0 };
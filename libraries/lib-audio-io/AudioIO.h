@@ -17,6 +17,7 @@
 #include "AudioIOSequences.h"
 #include "PlaybackSchedule.h" // member variable
 
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -48,6 +49,10 @@ namespace RealtimeEffects {
    class ProcessingScope;
 }
 
+namespace audacity::concurrency {
+   class WorkerTeam;
+}
+
 bool ValidateDeviceNames();
 
 enum class Acknowledge { eNone = 0, eStart, eStop };
@@ -251,6 +256,20 @@ public:
    std::thread mAudioThread;
    std::atomic<bool> mFinishAudioThread{ false };
 
+   //! Drains the capture RingBuffers into the RecordableSequences, so that
+   //! block creation and database inserts never delay playback refill
+   std::thread mCaptureThread;
+   //! Set by the main thread while the capture thread, not the audio thread,
+   //! does the draining; changed only with mCaptureWriterMutex locked
+   std::atomic<bool> mCaptureWriterRunning{ false };
+   //! Set by the capture thread for the duration of each pass; guarded by
+   //! mCaptureWriterMutex
+   bool mCaptureWriterActive{ false };
+   std::mutex mCaptureWriterMutex;
+   std::condition_variable mCaptureWriterWakeUp;
+   //! Notified when a pass of the capture thread ends
+   std::condition_variable mCaptureWriterIdle;
+
    std::vector<std::unique_ptr<Resample>> mResample;
 
    using RingBuffers = std::vector<std::unique_ptr<RingBuffer>>;
@@ -273,6 +292,9 @@ public:
    std::vector<float *> mScratchPointers; //!< pointing into mScratchBuffers
 
    std::vector<std::unique_ptr<Mixer>> mPlaybackMixers;
+   //! Threads of its own that help the audio thread process mPlaybackMixers;
+   //! null when processing serially
+   std::unique_ptr<audacity::concurrency::WorkerTeam> mpPlaybackTeam;
 
    std::atomic<float>  mMixerOutputVol{ 1.0 };
    static int          mNextStreamToken;
@@ -322,6 +344,13 @@ public:
 
    void ProcessOnceAndWait( std::chrono::milliseconds sleepTime = std::chrono::milliseconds(50) );
 
+   //! Hand DrainRecordBuffers over to the capture thread
+   void StartCaptureWriter();
+   //! Take DrainRecordBuffers back, waiting for a pass in progress to finish
+   void StopCaptureWriter();
+   //! Wake the capture thread early, after the audio thread's pass
+   void NotifyCaptureWriter();
+
 
 
    std::atomic<bool>   mForceFadeOut{ false };
@@ -366,6 +395,14 @@ public:
       { return mRecordingException; }
 
 protected:
+   //! Fraction, between 0 and 1, of the fullest capture RingBuffer that is
+   //! not yet written to the recording sequences
+   /*!
+    Values near 1 mean that storage can't keep up and captured samples will
+    soon be lost
+    */
+   double GetCaptureBacklog() const;
+
    // A flag tested and set in one thread, cleared in another.  Perhaps
    // this guarantee of atomicity is more cautious than necessary.
    wxAtomicInt mRecordingException {};
@@ -567,6 +604,7 @@ public:
    double GetStreamTime();
 
    static void AudioThread(std::atomic<bool> &finish);
+   static void CaptureThread(std::atomic<bool> &finish);
 
    static void Init();
    static void Deinit();
@@ -654,5 +692,8 @@ private:
 };
 
 AUDIO_IO_API extern BoolSetting SoundActivatedRecord;
+//! Number of threads that process playback sequences; 0 chooses automatically,
+//! 1 processes serially in the audio thread
+AUDIO_IO_API extern IntSetting AudioIOPlaybackThreads;
 
 #endif
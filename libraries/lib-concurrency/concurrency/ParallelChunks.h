@@ -0,0 +1,75 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ParallelChunks.h
+ */
+
+#pragma once
+
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace audacity::concurrency
+{
+//! Invoke `body(begin, end)` for consecutive chunks covering [0, count)
+/*!
+ Chunks run in parallel on `pool` if it is not null, else serially in order.
+ Each invocation may own scratch state for its whole chunk.
+ */
+template<typename Body>
+void ParallelChunks(
+   WorkStealingPool* pool, size_t count, size_t chunkSize, const Body& body)
+{
+   if (count == 0)
+      return;
+   chunkSize = std::max<size_t>(chunkSize, 1);
+   const auto nChunks = (count + chunkSize - 1) / chunkSize;
+   const auto run = [&](size_t chunk) {
+      body(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+   };
+   if (!pool || nChunks == 1)
+      for (size_t chunk = 0; chunk < nChunks; ++chunk)
+         run(chunk);
+   else
+      pool->ParallelFor(nChunks, run);
+}
+
+//! A parallel loop whose iterations add into elements of `out` that other
+//! iterations may also add to
+/*!
+ `body(begin, end, add)` is invoked as for ParallelChunks, and calls
+ `add(index, value)` to mean `out[index] += value`.
+
+ When run in parallel, each chunk records its additions, which are then
+ applied in the order a serial loop would make them.  So the results are the
+ same bit for bit, whatever the number of threads, despite the non-associative
+ floating point additions.
+ */
+template<typename Value, typename T, typename Body>
+void OrderedScatterAdd(WorkStealingPool* pool, size_t count, size_t chunkSize,
+   T* out, const Body& body)
+{
+   if (!pool || pool->GetThreadCount() == 0 || count <= chunkSize)
+   {
+      body(size_t { 0 }, count,
+         [out](size_t index, Value value) { out[index] += value; });
+      return;
+   }
+
+   chunkSize = std::max<size_t>(chunkSize, 1);
+   std::vector<std::vector<std::pair<size_t, Value>>> additions(
+      (count + chunkSize - 1) / chunkSize);
+   ParallelChunks(pool, count, chunkSize, [&](size_t begin, size_t end) {
+      auto& chunkAdditions = additions[begin / chunkSize];
+      body(begin, end, [&chunkAdditions](size_t index, Value value) {
+         chunkAdditions.emplace_back(index, value);
+      });
+   });
+
+   for (const auto& chunkAdditions : additions)
+      for (const auto& [index, value] : chunkAdditions)
+         out[index] += value;
+}
+} // namespace audacity::concurrency
@@ -0,0 +1,211 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkStealingPool.cpp
+ */
+
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+
+namespace audacity::concurrency
+{
+struct WorkStealingPool::Worker final
+{
+   std::mutex mutex;
+   std::deque<Task> tasks;
+};
+
+WorkStealingPool::WorkStealingPool(size_t nThreads)
+{
+   mWorkers.reserve(nThreads);
+   for (size_t i = 0; i < nThreads; ++i)
+      mWorkers.push_back(std::make_unique<Worker>());
+
+   mThreads.reserve(nThreads);
+   for (size_t i = 0; i < nThreads; ++i)
+      mThreads.emplace_back([this, i] { WorkerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(mSleepMutex);
+      mStopping.store(true);
+   }
+   mWakeUp.notify_all();
+
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+size_t WorkStealingPool::DefaultThreadCount(size_t reserved)
+{
+   const size_t hardware = std::thread::hardware_concurrency();
+   return hardware > reserved + 1 ? hardware - reserved - 1 : 0;
+}
+
+WorkStealingPool& WorkStealingPool::GetShared()
+{
+   static WorkStealingPool pool { std::max<size_t>(DefaultThreadCount(), 2) };
+   return pool;
+}
+
+size_t WorkStealingPool::GetThreadCount() const noexcept
+{
+   return mThreads.size();
+}
+
+void WorkStealingPool::Post(Task task)
+{
+   assert(!mWorkers.empty());
+   if (mWorkers.empty())
+   {
+      task();
+      return;
+   }
+
+   Push(mNextQueue.fetch_add(1) % mWorkers.size(), std::move(task));
+}
+
+void WorkStealingPool::Push(size_t index, Task task)
+{
+   {
+      auto& worker = *mWorkers[index];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+   }
+   {
+      // Increment under the sleep mutex so that a worker about to wait
+      // cannot miss the notification
+      std::lock_guard<std::mutex> lock(mSleepMutex);
+      ++mQueued;
+   }
+   mWakeUp.notify_one();
+}
+
+bool WorkStealingPool::TryRunOne(size_t index)
+{
+   const auto nWorkers = mWorkers.size();
+   Task task;
+
+   for (size_t i = 0; i < nWorkers && !task; ++i)
+   {
+      auto& worker = *mWorkers[(index + i) % nWorkers];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (worker.tasks.empty())
+         continue;
+      // The owner takes the most recently pushed task, thieves the oldest
+      if (i == 0)
+      {
+         task = std::move(worker.tasks.back());
+         worker.tasks.pop_back();
+      }
+      else
+      {
+         task = std::move(worker.tasks.front());
+         worker.tasks.pop_front();
+      }
+   }
+
+   if (!task)
+      return false;
+
+   --mQueued;
+   task();
+   return true;
+}
+
+void WorkStealingPool::WorkerLoop(size_t index)
+{
+   while (true)
+   {
+      if (TryRunOne(index))
+         continue;
+
+      std::unique_lock<std::mutex> lock(mSleepMutex);
+      mWakeUp.wait(
+         lock, [this] { return mStopping.load() || mQueued.load() > 0; });
+
+      if (mStopping.load() && mQueued.load() == 0)
+         return;
+   }
+}
+
+void WorkStealingPool::ParallelFor(
+   size_t count, const std::function<void(size_t)>& task, size_t maxHelpers)
+{
+   if (count == 0)
+      return;
+
+   const auto nHelpers = std::min({ mWorkers.size(), count - 1, maxHelpers });
+   if (nHelpers == 0)
+   {
+      for (size_t i = 0; i < count; ++i)
+         task(i);
+      return;
+   }
+
+   //! Shared with the helpers, which may start after the caller returned,
+   //! and then find no index left to claim
+   struct Batch final
+   {
+      Batch(const std::function<void(size_t)>& task, size_t count)
+          : task { task }
+          , count { count }
+          , remaining { count }
+      {
+      }
+
+      //! Used only for claimed indices, so not after the caller returned
+      const std::function<void(size_t)>& task;
+      const size_t count;
+      std::atomic<size_t> next { 0 };
+      //! Decremented only under `mutex`
+      size_t remaining;
+      std::mutex mutex;
+      std::condition_variable done;
+      std::exception_ptr exception;
+   };
+   const auto pBatch = std::make_shared<Batch>(task, count);
+
+   // Claim indices until none is left
+   const auto drain = [](Batch& batch) {
+      for (size_t i; (i = batch.next.fetch_add(1)) < batch.count;)
+      {
+         std::exception_ptr exception;
+         try
+         {
+            batch.task(i);
+         }
+         catch (...)
+         {
+            exception = std::current_exception();
+         }
+
+         std::lock_guard<std::mutex> lock(batch.mutex);
+         if (exception && !batch.exception)
+            batch.exception = exception;
+         if (--batch.remaining == 0)
+            batch.done.notify_all();
+      }
+   };
+
+   const auto first = mNextQueue.fetch_add(nHelpers);
+   for (size_t i = 0; i < nHelpers; ++i)
+      Push((first + i) % mWorkers.size(), [pBatch, drain] { drain(*pBatch); });
+
+   // Helpers that are late, because their workers are busy with other tasks,
+   // leave more to the caller, which never waits for them to start
+   drain(*pBatch);
+
+   {
+      std::unique_lock<std::mutex> lock(pBatch->mutex);
+      pBatch->done.wait(lock, [&] { return pBatch->remaining == 0; });
+   }
+
+   if (pBatch->exception)
+      std::rethrow_exception(pBatch->exception);
+}
+} // namespace audacity::concurrency
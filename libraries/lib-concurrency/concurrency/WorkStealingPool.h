@@ -0,0 +1,92 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkStealingPool.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace audacity::concurrency
+{
+//! A fixed set of worker threads, each owning a queue of tasks
+/*!
+ Idle workers steal from the front of other workers' queues, while owners pop
+ from the back, so that uneven task durations balance out without a single
+ contended queue.
+
+ ParallelFor lets the calling thread take part in the work, so it is safe to
+ nest calls and a pool of zero threads degrades to serial execution on the
+ caller.  The caller runs only items of its own call, never other tasks
+ queued in the pool, so that one pool may serve all features of the
+ application, including the audio thread.
+ */
+class CONCURRENCY_API WorkStealingPool final
+{
+public:
+   using Task = std::function<void()>;
+
+   //! @param nThreads number of worker threads; may be zero
+   explicit WorkStealingPool(size_t nThreads);
+   ~WorkStealingPool();
+
+   WorkStealingPool(const WorkStealingPool&)            = delete;
+   WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+   //! Suggested number of workers to add to a calling thread, leaving
+   //! `reserved` cores for other threads
+   static size_t DefaultThreadCount(size_t reserved = 1);
+
+   //! The pool for background and parallel work of all features
+   /*!
+    It has DefaultThreadCount() workers, but at least two, so that Post() is
+    always possible and a task waiting for the disk does not stop all others.
+    Tasks must not wait for other tasks posted to the pool.
+    */
+   static WorkStealingPool& GetShared();
+
+   size_t GetThreadCount() const noexcept;
+
+   //! Enqueue a task that runs asynchronously on some worker
+   /*!
+    @pre `GetThreadCount() > 0`
+    */
+   void Post(Task task);
+
+   //! Invoke `task(i)` for each i in [0, count), returning when all are done
+   /*!
+    The calling thread executes tasks too, and at most `maxHelpers` workers
+    join it.  It invokes all that no worker has yet begun, and so waits only
+    for invocations in progress.  If any invocation throws, the first
+    exception is rethrown after all other invocations complete.
+    */
+   void ParallelFor(size_t count, const std::function<void(size_t)>& task,
+      size_t maxHelpers = std::numeric_limits<size_t>::max());
+
+private:
+   struct Worker;
+
+   void WorkerLoop(size_t index);
+   //! Pop from the queue of `index`, else steal from the others
+   bool TryRunOne(size_t index);
+   void Push(size_t index, Task task);
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
+   std::vector<std::thread> mThreads;
+
+   std::mutex mSleepMutex;
+   std::condition_variable mWakeUp;
+   std::atomic<size_t> mQueued { 0 };
+   std::atomic<size_t> mNextQueue { 0 };
+   std::atomic<bool> mStopping { false };
+}; // class WorkStealingPool
+} // namespace audacity::concurrency
@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkerTeam.cpp
+ */
+
+#include "WorkerTeam.h"
+
+#include <cassert>
+#include <utility>
+
+namespace audacity::concurrency
+{
+WorkerTeam::WorkerTeam(size_t nHelpers)
+{
+   mThreads.reserve(nHelpers);
+   for (size_t i = 0; i < nHelpers; ++i)
+      mThreads.emplace_back([this] { HelperLoop(); });
+}
+
+WorkerTeam::~WorkerTeam()
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+   }
+   mWakeUp.notify_all();
+
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+size_t WorkerTeam::GetHelperCount() const noexcept
+{
+   return mThreads.size();
+}
+
+void WorkerTeam::Run(size_t count, Invoker invoke, const void* pTask)
+{
+   assert(count <= UINT32_MAX);
+   if (mThreads.empty() || count < 2)
+   {
+      for (size_t i = 0; i < count; ++i)
+         invoke(pTask, i);
+      return;
+   }
+
+   uint32_t generation;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      generation = ++mGeneration;
+      mCount = count;
+      mInvoke = invoke;
+      mpTask = pTask;
+      mpException = nullptr;
+      mDone.store(0, std::memory_order_relaxed);
+      mClaim.store(
+         uint64_t { generation } << 32, std::memory_order_release);
+   }
+   mWakeUp.notify_all();
+
+   Work(generation, count, invoke, pTask);
+
+   // Wait only for the invocations that helpers began
+   while (mDone.load(std::memory_order_acquire) < count)
+      std::this_thread::yield();
+
+   std::exception_ptr pException;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      pException = std::exchange(mpException, nullptr);
+   }
+   if (pException)
+      std::rethrow_exception(pException);
+}
+
+void WorkerTeam::Work(
+   uint32_t generation, size_t count, Invoker invoke, const void* pTask)
+{
+   auto claim = mClaim.load(std::memory_order_acquire);
+   while (true)
+   {
+      if ((claim >> 32) != generation || (claim & UINT32_MAX) >= count)
+         return;
+      if (!mClaim.compare_exchange_weak(claim, claim + 1,
+             std::memory_order_acq_rel, std::memory_order_acquire))
+         continue;
+
+      try
+      {
+         invoke(pTask, claim & UINT32_MAX);
+      }
+      catch (...)
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         if (!mpException)
+            mpException = std::current_exception();
+      }
+      mDone.fetch_add(1, std::memory_order_release);
+      claim = mClaim.load(std::memory_order_acquire);
+   }
+}
+
+void WorkerTeam::HelperLoop()
+{
+   uint32_t seen = 0;
+   while (true)
+   {
+      uint32_t generation;
+      size_t count;
+      Invoker invoke;
+      const void* pTask;
+      {
+         std::unique_lock<std::mutex> lock(mMutex);
+         mWakeUp.wait(
+            lock, [&] { return mStopping || mGeneration != seen; });
+         if (mStopping)
+            return;
+         seen = generation = mGeneration;
+         count = mCount;
+         invoke = mInvoke;
+         pTask = mpTask;
+      }
+      Work(generation, count, invoke, pTask);
+   }
+}
+} // namespace audacity::concurrency
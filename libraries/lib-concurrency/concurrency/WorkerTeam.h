@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkerTeam.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace audacity::concurrency
+{
+//! Threads kept for one client, that repeatedly divides work among them
+/*!
+ Unlike WorkStealingPool::ParallelFor(), Run() allocates nothing and makes
+ no synchronization objects, so that a thread with deadlines, such as the one
+ that fills the playback buffers, may call it for every slice of work.  The
+ threads are made at construction and serve no other client.
+
+ Only one thread at a time may call Run().
+ */
+class CONCURRENCY_API WorkerTeam final
+{
+public:
+   //! @param nHelpers number of threads to join the caller of Run(); may be
+   //! zero
+   explicit WorkerTeam(size_t nHelpers);
+   ~WorkerTeam();
+
+   WorkerTeam(const WorkerTeam&)            = delete;
+   WorkerTeam& operator=(const WorkerTeam&) = delete;
+
+   size_t GetHelperCount() const noexcept;
+
+   //! Invoke `task(i)` for each i in [0, count), returning when all are done
+   /*!
+    The calling thread invokes tasks too, and waits only for invocations in
+    progress.  If any invocation throws, the first exception is rethrown after
+    all other invocations complete.
+    */
+   template<typename Task> void Run(size_t count, const Task& task)
+   {
+      Run(count, &Invoke<Task>, &task);
+   }
+
+private:
+   using Invoker = void (*)(const void* pTask, size_t i);
+
+   template<typename Task> static void Invoke(const void* pTask, size_t i)
+   {
+      (*static_cast<const Task*>(pTask))(i);
+   }
+
+   void Run(size_t count, Invoker invoke, const void* pTask);
+   void HelperLoop();
+   //! Invoke tasks of the given generation until none is left to claim
+   void Work(
+      uint32_t generation, size_t count, Invoker invoke, const void* pTask);
+
+   std::vector<std::thread> mThreads;
+
+   //! Guards the description of the work and the exception, and is held by
+   //! helpers only to wait or to read that description
+   std::mutex mMutex;
+   std::condition_variable mWakeUp;
+   uint32_t mGeneration { 0 };
+   size_t mCount { 0 };
+   Invoker mInvoke {};
+   const void* mpTask {};
+   std::exception_ptr mpException;
+   bool mStopping { false };
+
+   //! The generation in the high half, and the next index to claim in the
+   //! low half, so that a helper late for one Run() claims nothing of the
+   //! next
+   std::atomic<uint64_t> mClaim { 0 };
+   //! Invocations of the current generation that are complete
+   std::atomic<size_t> mDone { 0 };
+}; // class WorkerTeam
+} // namespace audacity::concurrency
@@ -0,0 +1,87 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ParallelChunksTests.cpp
+ */
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "concurrency/ParallelChunks.h"
+
+using namespace audacity::concurrency;
+
+namespace
+{
+constexpr size_t nColumns = 500;
+constexpr size_t nBins = 64;
+
+//! Like reassignment of spectrograms: each column adds powers to bins of
+//! nearby columns, with values spanning many orders of magnitude so that
+//! the order of additions changes the rounding
+std::vector<float> Scatter(WorkStealingPool* pool, size_t chunkSize)
+{
+   std::vector<float> out(nColumns * nBins);
+   OrderedScatterAdd<double>(
+      pool, nColumns, chunkSize, out.data(),
+      [](size_t begin, size_t end, const auto& add) {
+         for (auto column = begin; column < end; ++column)
+         {
+            std::mt19937 engine(static_cast<unsigned>(column));
+            std::uniform_int_distribution<int> shift { -5, 5 };
+            std::uniform_real_distribution<double> exponent { -8, 8 };
+            for (size_t bin = 0; bin < nBins; ++bin)
+            {
+               const auto target = static_cast<long>(column) + shift(engine);
+               const auto value = std::pow(10.0, exponent(engine));
+               if (target >= 0 && target < static_cast<long>(nColumns))
+                  add(target * nBins + bin, value);
+            }
+         }
+      });
+   return out;
+}
+} // namespace
+
+TEST_CASE("ParallelChunks", "")
+{
+   SECTION("chunks cover the range exactly once")
+   {
+      WorkStealingPool pool { 3 };
+      for (size_t chunkSize : { 1, 7, 16, 1000 })
+      {
+         std::vector<std::atomic<int>> visits(100);
+         // Catch2 assertions are not thread-safe
+         std::atomic<bool> boundsOk { true };
+         ParallelChunks(&pool, visits.size(), chunkSize,
+            [&](size_t begin, size_t end) {
+               if (begin >= end || end - begin > chunkSize)
+                  boundsOk = false;
+               for (auto i = begin; i < end; ++i)
+                  ++visits[i];
+            });
+         REQUIRE(boundsOk.load());
+         for (const auto& count : visits)
+            REQUIRE(count.load() == 1);
+      }
+   }
+
+   SECTION("OrderedScatterAdd gives the same bits as the serial loop")
+   {
+      const auto serial = Scatter(nullptr, 16);
+      for (size_t nThreads : { 0, 1, 3, 8 })
+      {
+         WorkStealingPool pool { nThreads };
+         for (size_t chunkSize : { 1, 16, 37 })
+         {
+            const auto parallel = Scatter(&pool, chunkSize);
+            REQUIRE(memcmp(parallel.data(), serial.data(),
+               serial.size() * sizeof(float)) == 0);
+         }
+      }
+   }
+}
@@ -0,0 +1,122 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkStealingPoolTests.cpp
+ */
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "concurrency/WorkStealingPool.h"
+
+using namespace audacity::concurrency;
+
+TEST_CASE("WorkStealingPool", "")
+{
+   SECTION("ParallelFor visits every index exactly once")
+   {
+      for (size_t nThreads : { 0, 1, 3, 8 })
+      {
+         WorkStealingPool pool { nThreads };
+         REQUIRE(pool.GetThreadCount() == nThreads);
+
+         std::vector<std::atomic<int>> visits(1000);
+         pool.ParallelFor(
+            visits.size(), [&](size_t i) { ++visits[i]; });
+
+         for (const auto& count : visits)
+            REQUIRE(count.load() == 1);
+      }
+   }
+
+   SECTION("ParallelFor may be nested")
+   {
+      WorkStealingPool pool { 2 };
+      std::atomic<int> total { 0 };
+      pool.ParallelFor(8, [&](size_t) {
+         pool.ParallelFor(8, [&](size_t) { ++total; });
+      });
+      REQUIRE(total.load() == 64);
+   }
+
+   SECTION("ParallelFor rethrows after joining")
+   {
+      WorkStealingPool pool { 4 };
+      std::atomic<int> finished { 0 };
+      REQUIRE_THROWS_AS(
+         pool.ParallelFor(
+            16,
+            [&](size_t i) {
+               if (i == 5)
+                  throw std::runtime_error("failure");
+               ++finished;
+            }),
+         std::runtime_error);
+      REQUIRE(finished.load() == 15);
+   }
+
+   SECTION("ParallelFor may return as soon as the last task finishes")
+   {
+      // Short batches on the stack, so that a worker still notifying after
+      // the caller returned would use a destroyed batch (visible under
+      // sanitizers)
+      WorkStealingPool pool { 4 };
+      std::atomic<int> total { 0 };
+      for (int i = 0; i < 10000; ++i)
+         pool.ParallelFor(3, [&](size_t) { ++total; });
+      REQUIRE(total.load() == 30000);
+   }
+
+   SECTION("Posted tasks run before destruction completes")
+   {
+      std::atomic<int> total { 0 };
+      {
+         WorkStealingPool pool { 3 };
+         for (int i = 0; i < 100; ++i)
+            pool.Post([&] { ++total; });
+      }
+      REQUIRE(total.load() == 100);
+   }
+
+   SECTION("ParallelFor does not wait for busy workers or run their tasks")
+   {
+      WorkStealingPool pool { 1 };
+      std::promise<void> release;
+      const auto released = release.get_future().share();
+      pool.Post([released] { released.wait(); });
+      // Queued behind the blocked task
+      std::promise<std::thread::id> posted;
+      pool.Post([&posted] { posted.set_value(std::this_thread::get_id()); });
+
+      const auto caller = std::this_thread::get_id();
+      std::vector<std::thread::id> ids(8);
+      pool.ParallelFor(
+         ids.size(), [&](size_t i) { ids[i] = std::this_thread::get_id(); });
+      for (const auto& id : ids)
+         REQUIRE(id == caller);
+
+      release.set_value();
+      REQUIRE(posted.get_future().get() != caller);
+   }
+
+   SECTION("ParallelFor uses at most the given count of helpers")
+   {
+      WorkStealingPool pool { 4 };
+      const auto caller = std::this_thread::get_id();
+      std::vector<std::thread::id> ids(100);
+      pool.ParallelFor(
+         ids.size(), [&](size_t i) { ids[i] = std::this_thread::get_id(); },
+         0);
+      for (const auto& id : ids)
+         REQUIRE(id == caller);
+   }
+
+   SECTION("The shared pool can always run posted tasks")
+   {
+      REQUIRE(WorkStealingPool::GetShared().GetThreadCount() >= 2);
+   }
+}
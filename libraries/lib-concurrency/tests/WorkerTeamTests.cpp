@@ -0,0 +1,69 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkerTeamTests.cpp
+ */
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "concurrency/WorkerTeam.h"
+
+using namespace audacity::concurrency;
+
+TEST_CASE("WorkerTeam", "")
+{
+   SECTION("Run visits every index exactly once")
+   {
+      for (size_t nHelpers : { 0, 1, 3, 8 })
+      {
+         WorkerTeam team { nHelpers };
+         REQUIRE(team.GetHelperCount() == nHelpers);
+
+         std::vector<std::atomic<int>> visits(1000);
+         auto visit = [&](size_t i) { ++visits[i]; };
+         team.Run(visits.size(), visit);
+
+         for (const auto& count : visits)
+            REQUIRE(count.load() == 1);
+      }
+   }
+
+   SECTION("Helpers late for one run take nothing of the next")
+   {
+      WorkerTeam team { 3 };
+      std::vector<int> sums(4);
+      for (int run = 0; run < 10000; ++run)
+      {
+         // Plain ints: each index must be written by one thread, and all
+         // writes must be visible when Run returns
+         std::fill(sums.begin(), sums.end(), 0);
+         auto add = [&](size_t i) { sums[i] += run; };
+         team.Run(sums.size(), add);
+         for (auto sum : sums)
+            REQUIRE(sum == run);
+      }
+   }
+
+   SECTION("Run rethrows after joining")
+   {
+      WorkerTeam team { 4 };
+      std::atomic<int> finished { 0 };
+      auto task = [&](size_t i) {
+         if (i == 5)
+            throw std::runtime_error("failure");
+         ++finished;
+      };
+      REQUIRE_THROWS_AS(team.Run(16, task), std::runtime_error);
+      REQUIRE(finished.load() == 15);
+
+      // The team is still usable
+      finished = 0;
+      auto count = [&](size_t) { ++finished; };
+      team.Run(16, count);
+      REQUIRE(finished.load() == 16);
+   }
+}
@@ -83,3 +83,8 @@ bool ExportPlugin::CheckFileName(wxFileName&, int) const
 {
   return true;
 }
+
+bool ExportPlugin::SupportsConcurrentExport(int) const
+{
+   return false;
+}
@@ -178,4 +178,14 @@ public:
     * respectively.
     **/
    virtual std::unique_ptr<ExportProcessor> CreateProcessor(int format) const = 0;
+
+   /**
+    * @brief Whether processors of the format may run Process() at the same
+    * time as one another, each with its own mixer, as when exporting
+    * multiple files.
+    *
+    * Default is false.  Override to return true when the encoder keeps no
+    * state shared between its processors.
+    **/
+   virtual bool SupportsConcurrentExport(int formatIndex) const;
 };
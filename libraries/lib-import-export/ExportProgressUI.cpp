@@ -15,6 +15,12 @@
 #include "Internat.h"
 #include "BasicUI.h"
 #include "FileException.h"
+#include "MemoryX.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace
 {
@@ -75,6 +81,85 @@ namespace
       
    };
 
+   //! Delegate of one task of a batch, which the batch polls
+   class BatchExportProgressDelegate final : public ExportProcessorDelegate
+   {
+      std::atomic<bool> mCancelled {false};
+      std::atomic<bool> mStopped {false};
+      std::atomic<double> mProgress {};
+
+      mutable std::mutex mStatusMutex;
+      TranslatableString mStatus;
+   public:
+
+      bool IsCancelled() const override
+      {
+         return mCancelled;
+      }
+
+      bool IsStopped() const override
+      {
+         return mStopped;
+      }
+
+      void SetStatusString(const TranslatableString& str) override
+      {
+         std::lock_guard<std::mutex> lock { mStatusMutex };
+         mStatus = str;
+      }
+
+      void OnProgress(double progress) override
+      {
+         mProgress = progress;
+      }
+
+      TranslatableString GetStatus() const
+      {
+         std::lock_guard<std::mutex> lock { mStatusMutex };
+         return mStatus;
+      }
+
+      double GetProgress() const
+      {
+         return mProgress;
+      }
+
+      void Cancel()
+      {
+         if(!mStopped)
+            mCancelled = true;
+      }
+
+      void Stop()
+      {
+         if(!mCancelled)
+            mStopped = true;
+      }
+   };
+
+   struct BatchExportSlot
+   {
+      size_t index;
+      BatchExportProgressDelegate delegate;
+      std::future<ExportResult> result;
+      std::thread thread;
+      //! Thrown when making the task
+      std::exception_ptr error;
+
+      bool IsDone() const
+      {
+         return !result.valid() ||
+            result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+      }
+   };
+
+   void ShowCompletedWithError()
+   {
+      BasicUI::ShowErrorDialog(
+         {}, XO("Export error"),
+         XO("Export completed with error."), {},
+         BasicUI::ErrorDialogOptions { BasicUI::ErrorDialogType::ModalError });
+   }
 }
 
 ExportResult ExportProgressUI::Show(ExportTask exportTask)
@@ -91,12 +176,142 @@ ExportResult ExportProgressUI::Show(ExportTask exportTask)
    ExceptionWrappedCall([&] { result = f.get(); });
 
    if(result == ExportResult::Error)
-   {
-      BasicUI::ShowErrorDialog(
-         {}, XO("Export error"),
-         XO("Export completed with error."), {},
-         BasicUI::ErrorDialogOptions { BasicUI::ErrorDialogType::ModalError });
-   }
+      ShowCompletedWithError();
 
    return result;
 }
+
+void ExportProgressUI::ShowBatch(size_t nTasks, const TaskFactory& makeTask,
+   const ResultHandler& onResult, size_t concurrency)
+{
+   constexpr long long ProgressSteps = 1000ul;
+
+   concurrency = std::clamp<size_t>(concurrency, 1,
+      std::max(1u, std::thread::hardware_concurrency()));
+
+   // Tasks made and not yet handled, in order
+   std::deque<std::unique_ptr<BatchExportSlot>> slots;
+   size_t nextIndex = 0;
+   size_t nHandled = 0;
+   bool proceed = true;
+   // Set when the dialog is stopped or cancelled, until the tasks that were
+   // running then are handled
+   bool interrupted = false;
+   std::unique_ptr<BasicUI::ProgressDialog> progressDialog;
+
+   auto cleanup = finally([&] {
+      // Not empty only after an exception from a handler
+      for(auto& pSlot : slots)
+      {
+         pSlot->delegate.Cancel();
+         if(pSlot->thread.joinable())
+            pSlot->thread.join();
+      }
+   });
+
+   while(true)
+   {
+      // Handle what finished before starting more, so that a handler that
+      // refuses to proceed prevents the start of any other task
+      while(!slots.empty() && slots.front()->IsDone())
+      {
+         const auto pSlot = std::move(slots.front());
+         slots.pop_front();
+         if(pSlot->thread.joinable())
+            pSlot->thread.join();
+         ++nHandled;
+
+         auto result = ExportResult::Error;
+         auto error = pSlot->error;
+         if(!error)
+         {
+            try
+            {
+               result = pSlot->result.get();
+            }
+            catch(...)
+            {
+               error = std::current_exception();
+            }
+         }
+         if(error || result != ExportResult::Success)
+            // Other dialogs come without the progress dialog
+            progressDialog.reset();
+         if(error)
+            ExceptionWrappedCall([&] { std::rethrow_exception(error); });
+         if(result == ExportResult::Error)
+            ShowCompletedWithError();
+
+         if(!onResult(pSlot->index, result) && proceed)
+         {
+            proceed = false;
+            for(auto& pOther : slots)
+               pOther->delegate.Cancel();
+         }
+      }
+
+      while(proceed && !interrupted && nextIndex < nTasks &&
+         static_cast<size_t>(std::count_if(slots.begin(), slots.end(),
+            [](const auto& pSlot) { return !pSlot->IsDone(); })) < concurrency)
+      {
+         auto pSlot = std::make_unique<BatchExportSlot>();
+         pSlot->index = nextIndex++;
+         ExportTask task;
+         try
+         {
+            task = makeTask(pSlot->index);
+         }
+         catch(...)
+         {
+            pSlot->error = std::current_exception();
+         }
+         if(!pSlot->error)
+         {
+            if(!task.valid())
+            {
+               ++nHandled;
+               continue;
+            }
+            pSlot->result = task.get_future();
+            pSlot->thread = std::thread(
+               std::move(task), std::ref(pSlot->delegate));
+         }
+         slots.push_back(std::move(pSlot));
+      }
+
+      if(interrupted && slots.empty())
+      {
+         interrupted = false;
+         progressDialog.reset();
+      }
+      if(slots.empty() && (!proceed || nextIndex == nTasks))
+         break;
+
+      // Report the progress of all files together, and the status of the
+      // first unfinished one
+      double progress = nHandled;
+      for(const auto& pSlot : slots)
+         progress += pSlot->IsDone() ? 1.0 : pSlot->delegate.GetProgress();
+      const auto status = slots.empty()
+         ? TranslatableString{} : slots.front()->delegate.GetStatus();
+      if(!progressDialog)
+         progressDialog = BasicUI::MakeProgress(XO("Export"), status);
+      else
+         progressDialog->SetMessage(status);
+      const auto pollResult = progressDialog->Poll(
+         progress / nTasks * ProgressSteps, ProgressSteps);
+      if(pollResult == BasicUI::ProgressResult::Cancelled ||
+         pollResult == BasicUI::ProgressResult::Stopped)
+      {
+         interrupted = true;
+         for(auto& pSlot : slots)
+            if(pollResult == BasicUI::ProgressResult::Cancelled)
+               pSlot->delegate.Cancel();
+            else
+               pSlot->delegate.Stop();
+      }
+
+      if(!slots.empty() && slots.front()->result.valid())
+         slots.front()->result.wait_for(std::chrono::milliseconds(50));
+   }
+}
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <functional>
 #include <future>
 
 #include "Export.h"
@@ -25,6 +26,33 @@ namespace ExportProgressUI
 {
 IMPORT_EXPORT_API ExportResult Show(ExportTask exportTask);
 
+//! Makes the task that exports a file of a batch
+/*! May return an invalid task, to skip the file; may throw */
+using TaskFactory = std::function<ExportTask(size_t index)>;
+
+//! Receives the result of the export of a file of a batch
+/*! @return false to start no more tasks, and to cancel those running */
+using ResultHandler = std::function<bool(size_t index, ExportResult result)>;
+
+//! Runs tasks exporting several files, some at the same time, with one
+//! progress dialog for all of them
+/*!
+ Tasks are made and their results handled on this thread, in order of index,
+ each task running on a thread of its own.  Each task has its own processor,
+ and so its own mixer.  The results of all tasks that were made are handled,
+ even after the handler returns false.  An exception thrown by a task is shown
+ when its result would be handled, and the result is then Error.
+
+ The dialog shows the progress of all files together.  Stopping or cancelling
+ applies to the tasks that are running, and no more tasks start until all of
+ those are handled.
+
+ @param concurrency the most tasks that run at once; 1 for encoders that are
+ not thread-safe.  It is also bounded by the count of cores.
+ */
+IMPORT_EXPORT_API void ShowBatch(size_t nTasks, const TaskFactory& makeTask,
+   const ResultHandler& onResult, size_t concurrency);
+
 template <typename Callable>
 void ExceptionWrappedCall(Callable callable)
 {
@@ -13,6 +13,8 @@
 
 #include "ImportForwards.h"
 #include "Identifier.h"
+#include <functional>
+#include <optional>
 #include <vector>
 #include <wx/tokenzr.h> // for enum wxStringTokenizerMode
 
@@ -182,7 +184,46 @@ public:
        std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
        TranslatableString& errorMessage);
 
+   //! Imports one file of a batch; the arguments are as for Import(), and
+   //! the listener is the one that the batch made for the file
+   using BatchImportFunction = std::function<bool(
+      WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
+      std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
+      TranslatableString& errorMessage)>;
+
+   //! Makes the listener for one file of a batch
+   /*!
+    Called on the thread of ImportBatch(), perhaps before earlier files are
+    committed, because the listener learns of the opening of a file before
+    the file is decoded ahead
+    */
+   using BatchListenerFactory = std::function<
+      std::unique_ptr<ImportProgressListener>(const FilePath& fName)>;
+
+   //! Called for each file of a batch in turn, which it imports by calling
+   //! the given function
+   /*! @return false to skip the rest of the batch */
+   using BatchVisitor = std::function<bool(
+      const FilePath& fName, const BatchImportFunction& import)>;
+
+   //! Imports several files, decoding some of them at the same time
+   /*!
+    Files that plugins can decode on other threads are decoded ahead on
+    workers, into buffers held in memory, as many at once as there are cores
+    and as fit in a memory budget; files too big for the budget are left to
+    Import(), which streams them.  The visitor is called on this thread for
+    each file, in the given order.  The function it receives reports to the
+    listener and makes tracks of the decoded samples with the track factory;
+    for other files, it calls Import().
+    */
+   void ImportBatch(AudacityProject& project, const FilePaths& fileNames,
+      const BatchListenerFactory& makeListener, const BatchVisitor& visitor);
+
  private:
+   using ImportPluginPtrs = std::vector< ImportPlugin* >;
+   //! Plugins to try for the file, in order
+   ImportPluginPtrs GetImportPlugins(const FilePath &fName) const;
+
     struct Traits : Registry::DefaultTraits
     {
        using LeafTypes = List<ImporterItem>;
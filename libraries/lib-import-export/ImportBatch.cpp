@@ -0,0 +1,223 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ImportBatch.cpp
+
+  @brief Importer::ImportBatch, which decodes files on worker threads
+
+**********************************************************************/
+#include "Import.h"
+
+#include "AcidizerTags.h"
+#include "ImportBatchScheduler.h"
+#include "ImportPlugin.h"
+#include "ImportProgressListener.h"
+#include "ImportUtils.h"
+#include "MemoryX.h"
+#include "Project.h"
+#include "Tags.h"
+#include "WaveTrack.h"
+#include "concurrency/WorkStealingPool.h"
+
+#include <wx/filename.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+using ByteCount = ImportFileHandle::ByteCount;
+using ImportResult = ImportProgressListener::ImportResult;
+
+//! Bound on decoded samples held in memory and not yet committed; bigger
+//! files are streamed by Import()
+constexpr ByteCount BatchMemoryBudget = 1ull << 30;
+
+//! Decoding of one file into memory, on a worker
+/*!
+ It is the listener for its own file handle, and no user interaction
+ happens until the results are committed on the thread of ImportBatch(),
+ which also makes the tracks
+ */
+struct BatchJob final
+   : ImportBatchScheduler::Job
+   , ImportProgressListener
+{
+   BatchJob(std::unique_ptr<ImportFileHandle> pHandle, ByteCount bytes)
+      : Job{ bytes }
+      , handle{ move(pHandle) }
+   {
+      // Receives only the tags that the file has, to be merged later
+      tags->Clear();
+   }
+
+   void Decode() override
+   {
+      handle->Decode(*this, audio, tags.get(), acidTags);
+   }
+   void Cancel() override { handle->Cancel(); }
+
+   bool OnImportFileOpened(ImportFileHandle &) override { return true; }
+   void OnImportProgress(double fraction) override { progress = fraction; }
+   void OnImportResult(ImportResult importResult) override
+   {
+      result = importResult;
+   }
+
+   const std::unique_ptr<ImportFileHandle> handle;
+   const std::shared_ptr<Tags> tags{ std::make_shared<Tags>() };
+
+   // Written by the worker, and read after it is done
+   DecodedAudio audio;
+   std::optional<LibFileFormats::AcidizerTags> acidTags;
+   ImportResult result{ ImportResult::Error };
+
+   std::atomic<double> progress{ 0 };
+};
+
+//! What the thread of ImportBatch() knows of each file
+struct BatchFile final
+{
+   std::unique_ptr<ImportProgressListener> listener;
+   //! The listener refused the file when it was opened for a job
+   bool declined{ false };
+};
+} // namespace
+
+void Importer::ImportBatch(AudacityProject& project,
+   const FilePaths& fileNames, const BatchListenerFactory& makeListener,
+   const BatchVisitor& visitor)
+{
+   auto busy = valueRestorer( project.mbBusyImporting, true );
+
+   auto &pool = audacity::concurrency::WorkStealingPool::GetShared();
+   const auto nFiles = fileNames.size();
+   std::vector<BatchFile> files(nFiles);
+
+   // Opens the file with the plugin that Import() would try first, if that
+   // one can decode on a worker; else Import() is left to do everything.
+   // The listener learns of the file here, before any worker touches the
+   // handle.
+   const auto makeJob = [&](size_t iFile)
+      -> std::shared_ptr<ImportBatchScheduler::Job>
+   {
+      const auto &fName = fileNames[iFile];
+      // Import() refuses these
+      if (wxFileName(fName).GetExt().IsSameAs(wxT("doc"), false))
+         return nullptr;
+      for (const auto plugin : GetImportPlugins(fName)) {
+         auto pHandle = plugin->Open(fName, &project);
+         if (!pHandle || pHandle->GetStreamCount() <= 0)
+            continue;
+         const auto bytes = pHandle->GetFileUncompressedBytes();
+         if (!pHandle->SupportsConcurrentImport() ||
+             pHandle->GetStreamCount() != 1 || bytes > BatchMemoryBudget)
+            return nullptr;
+         auto &file = files[iFile];
+         file.listener = makeListener(fName);
+         if (file.listener &&
+             !file.listener->OnImportFileOpened(*pHandle)) {
+            file.declined = true;
+            return nullptr;
+         }
+         pHandle->SetStreamUsage(0, true);
+         return std::make_shared<BatchJob>(move(pHandle), bytes);
+      }
+      return nullptr;
+   };
+
+   // Leave a worker for other tasks, such as summarizing the blocks that
+   // this thread makes from the decoded files.  Workers are not waited for
+   // when the batch stops early, but cancelled jobs end soon.
+   ImportBatchScheduler scheduler{ pool, nFiles,
+      std::max<size_t>(pool.GetThreadCount() - 1, 1), BatchMemoryBudget,
+      makeJob };
+
+   for (size_t ii = 0; ii < nFiles; ++ii) {
+      scheduler.Dispatch(ii);
+      const auto &fName = fileNames[ii];
+      auto &file = files[ii];
+      const auto pJob =
+         std::static_pointer_cast<BatchJob>(scheduler.GetJob(ii));
+      if (!file.listener && !file.declined)
+         file.listener = makeListener(fName);
+      const auto listener = file.listener.get();
+
+      const auto importNow = [&](WaveTrackFactory* trackFactory,
+         TrackHolders& tracks, Tags* tags,
+         std::optional<LibFileFormats::AcidizerTags>& acidTags,
+         TranslatableString& errorMessage)
+      {
+         return Import(project, fName, listener, trackFactory, tracks, tags,
+            acidTags, errorMessage);
+      };
+
+      bool proceed;
+      if (file.declined)
+         // As Import() does when the listener refuses the file
+         proceed = visitor(fName, [](auto&&...){ return false; });
+      else if (!pJob)
+         proceed = visitor(fName, importNow);
+      else
+         proceed = visitor(fName, [&](WaveTrackFactory* trackFactory,
+            TrackHolders& tracks, Tags* tags,
+            std::optional<LibFileFormats::AcidizerTags>& acidTags,
+            TranslatableString& errorMessage)
+         {
+            auto &job = *pJob;
+            job.Wait([&]{
+               if (listener)
+                  listener->OnImportProgress(job.progress);
+               scheduler.Dispatch(ii);
+            });
+            if (job.error)
+               std::rethrow_exception(job.error);
+
+            const auto result = job.result;
+            if ((result == ImportResult::Success ||
+                 result == ImportResult::Stopped) &&
+                !job.audio.channels.empty())
+            {
+               // Make the track here, where preferences are read and
+               // attached objects are built, and fill it
+               auto &audio = job.audio;
+               const auto track = trackFactory->Create(
+                  audio.channels.size(), audio.trackFormat, audio.rate);
+               size_t iChannel = 0;
+               for (const auto channel : track->Channels()) {
+                  auto &samples = audio.channels[iChannel++];
+                  channel->AppendBuffer(samples.data(), audio.format,
+                     samples.size() / SAMPLE_SIZE(audio.format), 1,
+                     audio.effectiveFormat);
+                  // Release memory as soon as possible
+                  std::vector<char>{}.swap(samples);
+               }
+               ImportUtils::FinalizeImport(tracks, *track);
+               if (tags)
+                  tags->Merge(*job.tags);
+               acidTags = move(job.acidTags);
+               if (listener)
+                  listener->OnImportResult(result);
+               return true;
+            }
+
+            if (result == ImportResult::Cancelled) {
+               if (listener)
+                  listener->OnImportResult(result);
+               return false;
+            }
+            // Import() tries again, and the plugins after the first, and
+            // reports the result
+            return importNow(
+               trackFactory, tracks, tags, acidTags, errorMessage);
+         });
+
+      // Doesn't wait, if the visitor did not import
+      scheduler.Release(ii);
+      file.listener.reset();
+      if (!proceed)
+         break;
+   }
+}
@@ -0,0 +1,131 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ImportBatchScheduler.cpp
+
+**********************************************************************/
+#include "ImportBatchScheduler.h"
+
+#include "concurrency/WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+ImportBatchScheduler::Job::Job(ByteCount bytes)
+   : bytes{ bytes }
+{
+}
+
+ImportBatchScheduler::Job::~Job() = default;
+
+void ImportBatchScheduler::Job::Run() noexcept
+{
+   try {
+      if (!mAbandoned)
+         Decode();
+   }
+   catch (...) {
+      error = std::current_exception();
+   }
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mDone = true;
+   mFinished.notify_all();
+}
+
+bool ImportBatchScheduler::Job::IsDone() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mDone;
+}
+
+void ImportBatchScheduler::Job::Wait(const std::function<void()> &poll)
+{
+   using namespace std::chrono_literals;
+   std::unique_lock<std::mutex> lock{ mMutex };
+   while (!mFinished.wait_for(lock, 50ms, [this]{ return mDone; })) {
+      lock.unlock();
+      poll();
+      lock.lock();
+   }
+}
+
+void ImportBatchScheduler::Job::Abandon()
+{
+   // A job still in the queue of the pool returns without decoding
+   mAbandoned = true;
+   Cancel();
+}
+
+ImportBatchScheduler::ImportBatchScheduler(
+   audacity::concurrency::WorkStealingPool &pool, size_t nFiles,
+   size_t maxRunning, ByteCount budget, JobFactory factory)
+   : mPool{ pool }
+   , mMaxRunning{ std::max<size_t>(maxRunning, 1) }
+   , mBudget{ budget }
+   , mFactory{ move(factory) }
+   , mJobs(nFiles)
+{
+}
+
+ImportBatchScheduler::~ImportBatchScheduler()
+{
+   // Later jobs first, so that a worker freed by the cancelling of an earlier
+   // one does not start them
+   for (auto iter = mJobs.rbegin(), end = mJobs.rend(); iter != end; ++iter)
+      if (const auto &pJob = *iter)
+         pJob->Abandon();
+}
+
+void ImportBatchScheduler::Dispatch(size_t current)
+{
+   const auto nFiles = mJobs.size();
+   while (mNextToPost < nFiles) {
+      const auto first = mJobs.begin() + current,
+         last = mJobs.begin() + std::max(current, mNextToPost);
+      const auto running = std::count_if(first, last,
+         [](const auto &pJob){ return pJob && !pJob->IsDone(); });
+      if (static_cast<size_t>(running) >= mMaxRunning)
+         return;
+      auto &pJob = mJobs[mNextToPost];
+      if (!pJob)
+         pJob = mFactory(mNextToPost);
+      if (pJob && pJob->bytes > mBudget)
+         // Too big to hold in memory; the caller imports it some other way
+         pJob.reset();
+      if (!pJob) {
+         ++mNextToPost;
+         continue;
+      }
+      if (mBytesInFlight + pJob->bytes > mBudget)
+         // Made but not posted; try again when earlier files are released
+         return;
+      mBytesInFlight += pJob->bytes;
+      mPool.Post([pJob]{ pJob->Run(); });
+      ++mNextToPost;
+   }
+}
+
+auto ImportBatchScheduler::GetJob(size_t iFile) const -> std::shared_ptr<Job>
+{
+   if (iFile < mNextToPost)
+      return mJobs[iFile];
+   return nullptr;
+}
+
+void ImportBatchScheduler::Release(size_t iFile)
+{
+   auto &pJob = mJobs[iFile];
+   if (!pJob)
+      return;
+   if (iFile < mNextToPost) {
+      mBytesInFlight -= pJob->bytes;
+      if (!pJob->IsDone())
+         pJob->Abandon();
+   }
+   else
+      // Made but never posted
+      pJob->Abandon();
+   pJob.reset();
+}
@@ -0,0 +1,116 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ImportBatchScheduler.h
+
+  @brief Decides which files of an import batch are decoded ahead, and when
+
+**********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace audacity::concurrency
+{
+class WorkStealingPool;
+}
+
+//! Posts jobs for the files of a batch to a pool, in the order of the files,
+//! as many at once as allowed and as fit in a memory budget
+/*!
+ All member functions are called on one thread, which commits the files in
+ order.  It never waits for a worker, except in Job::Wait(); abandoned jobs
+ finish on their own, and the pool keeps them alive until then.
+ */
+class IMPORT_EXPORT_API ImportBatchScheduler final
+{
+public:
+   using ByteCount = unsigned long long;
+
+   //! Decoding of one file, on a worker
+   class IMPORT_EXPORT_API Job /* not final */
+   {
+   public:
+      //! @param bytes estimate of the memory that the results occupy
+      explicit Job(ByteCount bytes);
+      virtual ~Job();
+
+      //! Called on the worker, unless the job was abandoned before it started
+      /*! May throw; the exception is kept in `error` */
+      virtual void Decode() = 0;
+
+      //! Called on the thread of the scheduler, perhaps while Decode() runs
+      virtual void Cancel() = 0;
+
+      //! Called by the pool
+      void Run() noexcept;
+
+      bool IsDone() const;
+
+      //! Wait for the worker, calling `poll` now and then
+      void Wait(const std::function<void()> &poll);
+
+      //! Make the worker stop soon without waiting for it
+      void Abandon();
+
+      bool IsAbandoned() const noexcept { return mAbandoned; }
+
+      const ByteCount bytes;
+
+      //! Written by the worker, and read after it is done
+      std::exception_ptr error;
+
+   private:
+      mutable std::mutex mMutex;
+      std::condition_variable mFinished;
+      bool mDone{ false };
+      std::atomic<bool> mAbandoned{ false };
+   };
+
+   //! Makes the job for file `iFile` on the thread of the scheduler
+   /*! @return null to leave the file to the caller */
+   using JobFactory = std::function<std::shared_ptr<Job>(size_t iFile)>;
+
+   /*!
+    @param maxRunning at most this many jobs are posted and not yet done
+    @param budget bound on the bytes of jobs posted and not yet released; a
+    job bigger than all of it is never posted, and is left to the caller
+    */
+   ImportBatchScheduler(audacity::concurrency::WorkStealingPool &pool,
+      size_t nFiles, size_t maxRunning, ByteCount budget, JobFactory factory);
+
+   //! Abandons the jobs not yet released, without waiting
+   ~ImportBatchScheduler();
+
+   //! Post jobs for files from `current` on, as the limits allow
+   /*! Files before `current` must have been released */
+   void Dispatch(size_t current);
+
+   //! @return the posted job for the file, else null
+   std::shared_ptr<Job> GetJob(size_t iFile) const;
+
+   //! Forget the job for the file, abandoning it if it is not done
+   void Release(size_t iFile);
+
+   //! @return bytes of the jobs posted and not yet released
+   ByteCount GetBytesInFlight() const noexcept { return mBytesInFlight; }
+
+private:
+   audacity::concurrency::WorkStealingPool &mPool;
+   const size_t mMaxRunning;
+   const ByteCount mBudget;
+   const JobFactory mFactory;
+
+   //! Jobs made and not yet released; those before mNextToPost are posted
+   std::vector<std::shared_ptr<Job>> mJobs;
+   size_t mNextToPost{ 0 };
+   ByteCount mBytesInFlight{ 0 };
+};
@@ -0,0 +1,159 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ImportPipeline.cpp
+
+**********************************************************************/
+#include "ImportPipeline.h"
+
+#include "Dither.h"
+#include "MemoryX.h"
+#include "concurrency/WorkStealingPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+//! One slot of the ring between the stages
+struct Chunk final
+{
+   Chunk(size_t nChannels, sampleFormat format, size_t chunkFrames)
+      : interleaved(nChannels * chunkFrames, format)
+   {
+      channels.reserve(nChannels);
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         channels.emplace_back(chunkFrames, format);
+      if (!interleaved.ptr() || std::any_of(channels.begin(), channels.end(),
+         [](const SampleBuffer &buffer){ return !buffer.ptr(); }))
+         throw std::bad_alloc{};
+   }
+
+   SampleBuffer interleaved;
+   std::vector<SampleBuffer> channels;
+   size_t frames = 0;
+   //! Whether deinterleaved and not yet consumed; guarded by the mutex
+   bool ready = false;
+};
+} // namespace
+
+sampleCount ImportPipeline::Run(size_t nChannels, sampleFormat format,
+   size_t chunkFrames, const Decoder &decoder, const Consumer &consumer,
+   const Progress &progress, size_t queueDepth)
+{
+   assert(nChannels > 0);
+   chunkFrames = std::max<size_t>(chunkFrames, 1);
+   queueDepth = std::max<size_t>(queueDepth, 1);
+
+   std::vector<Chunk> ring;
+   ring.reserve(queueDepth);
+   for (size_t ii = 0; ii < queueDepth; ++ii)
+      ring.emplace_back(nChannels, format, chunkFrames);
+
+   std::mutex mutex;
+   std::condition_variable changed;
+   // The rest is guarded by the mutex
+   size_t consumed = 0;
+   //! Index of the chunk after the last, when the decoder has finished
+   std::optional<size_t> end;
+   bool stopping = false;
+   std::exception_ptr error;
+
+   auto &pool = audacity::concurrency::WorkStealingPool::GetShared();
+   // Channels are copied in parallel.  The decoding thread takes part, so it
+   // never waits for workers busy with other tasks, and Run() may itself be
+   // called on a worker of the pool.
+   const auto deinterleave = [&](Chunk &chunk) {
+      const auto size = SAMPLE_SIZE(format);
+      pool.ParallelFor(nChannels, [&](size_t iChannel) {
+         CopySamples(chunk.interleaved.ptr() + iChannel * size, format,
+            chunk.channels[iChannel].ptr(), format, chunk.frames,
+            DitherType::none, nChannels, 1);
+      });
+      std::lock_guard<std::mutex> lock{ mutex };
+      chunk.ready = true;
+      changed.notify_all();
+   };
+
+   std::thread decoding{ [&]{
+      size_t ii = 0;
+      try {
+         for (;; ++ii) {
+            {
+               std::unique_lock<std::mutex> lock{ mutex };
+               changed.wait(lock,
+                  [&]{ return stopping || ii < consumed + queueDepth; });
+               if (stopping)
+                  return;
+            }
+            auto &chunk = ring[ii % queueDepth];
+            chunk.frames = std::min(
+               decoder(chunk.interleaved.ptr(), chunkFrames), chunkFrames);
+            std::unique_lock<std::mutex> lock{ mutex };
+            if (chunk.frames == 0) {
+               end = ii;
+               changed.notify_all();
+               return;
+            }
+            lock.unlock();
+            deinterleave(chunk);
+         }
+      }
+      catch (...) {
+         // Chunks before this one are still consumed, then the error
+         std::lock_guard<std::mutex> lock{ mutex };
+         end = ii;
+         error = std::current_exception();
+         changed.notify_all();
+      }
+   } };
+
+   auto cleanup = finally([&]{
+      {
+         std::lock_guard<std::mutex> lock{ mutex };
+         stopping = true;
+         changed.notify_all();
+      }
+      decoding.join();
+   });
+
+   sampleCount framesDone = 0;
+   std::vector<constSamplePtr> buffers(nChannels);
+   for (size_t ii = 0;; ++ii) {
+      auto &chunk = ring[ii % queueDepth];
+      {
+         std::unique_lock<std::mutex> lock{ mutex };
+         changed.wait(lock,
+            [&]{ return chunk.ready || end == ii; });
+         if (!chunk.ready) {
+            if (error)
+               std::rethrow_exception(error);
+            break;
+         }
+      }
+
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         buffers[iChannel] = chunk.channels[iChannel].ptr();
+      consumer(buffers.data(), chunk.frames);
+      framesDone += chunk.frames;
+
+      {
+         std::lock_guard<std::mutex> lock{ mutex };
+         chunk.ready = false;
+         ++consumed;
+         changed.notify_all();
+      }
+      if (!progress(framesDone))
+         break;
+   }
+   return framesDone;
+}
@@ -0,0 +1,66 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ImportPipeline.h
+
+  @brief Overlaps decoding, deinterleaving, and appending of imported samples
+
+**********************************************************************/
+#pragma once
+
+#include <functional>
+
+#include "SampleCount.h"
+#include "SampleFormat.h"
+
+//! Imports interleaved frames into the channels of a track, in stages that
+//! run at the same time
+/*!
+ A thread of its own decodes chunks of frames into a bounded ring of buffers,
+ and deinterleaves each chunk, with workers copying channels in parallel.  The
+ calling thread appends the chunks in order, so it remains the only one to
+ create sample blocks and to write to the project, while the summaries of the
+ blocks are computed by workers of the block factory.
+
+ Import plugins that decode interleaved samples supply a Decoder, and a
+ Consumer that appends to tracks or keeps the samples in memory.
+ */
+class IMPORT_EXPORT_API ImportPipeline final
+{
+public:
+   //! Fills `buffer` with at most `maxFrames` interleaved frames
+   /*!
+    Called repeatedly on the decoding thread.  May throw; Run() then rethrows.
+    @return the number of frames, zero at the end of the stream
+    */
+   using Decoder = std::function<size_t(samplePtr buffer, size_t maxFrames)>;
+
+   //! Called on the calling thread with each chunk, in order
+   /*!
+    @param channels deinterleaved samples, one buffer for each channel
+    */
+   using Consumer =
+      std::function<void(const constSamplePtr *channels, size_t frames)>;
+
+   //! Called on the calling thread after each chunk is consumed
+   /*!
+    @param framesDone count of frames consumed so far
+    @return false to stop the import
+    */
+   using Progress = std::function<bool(sampleCount framesDone)>;
+
+   //! Count of chunks that may be decoded ahead of the one being appended
+   static constexpr size_t DefaultQueueDepth = 4;
+
+   //! Decode until the end of the stream, or until `progress` returns false
+   /*!
+    @param format of the samples from `decoder`
+    @param chunkFrames at most this many frames are decoded at once
+    @return count of frames consumed
+    */
+   static sampleCount Run(size_t nChannels, sampleFormat format,
+      size_t chunkFrames, const Decoder &decoder, const Consumer &consumer,
+      const Progress &progress, size_t queueDepth = DefaultQueueDepth);
+};
@@ -9,6 +9,7 @@ Paul Licameli split from Import.cpp
 **********************************************************************/
 
 #include "ImportPlugin.h"
+#include "ImportProgressListener.h"
 
 #include <wx/filename.h>
 
@@ -38,6 +39,18 @@ TranslatableString ImportPlugin::FailureHint() const
 
 ImportFileHandle::~ImportFileHandle() = default;
 
+bool ImportFileHandle::SupportsConcurrentImport() const
+{
+   return false;
+}
+
+void ImportFileHandle::Decode(ImportProgressListener& progressListener,
+   DecodedAudio&, Tags*, std::optional<LibFileFormats::AcidizerTags>&)
+{
+   progressListener.OnImportResult(
+      ImportProgressListener::ImportResult::Error);
+}
+
 ImportFileHandleEx::ImportFileHandleEx(const FilePath & filename)
 :  mFilename(filename)
 {
@@ -48,9 +48,12 @@ but little else.
 #include "AcidizerTags.h"
 #include "Identifier.h"
 #include "Internat.h"
+#include "SampleFormat.h"
 #include "wxArrayStringEx.h"
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <vector>
 
 class AudacityProject;
 class WaveTrackFactory;
@@ -107,6 +110,21 @@ protected:
 class WaveTrack;
 using TrackHolders = std::vector<std::shared_ptr<Track>>;
 
+//! Samples of one stream that ImportFileHandle::Decode() produced, from
+//! which the thread that opened the file makes a track
+struct DecodedAudio final
+{
+   //! Format of the track to make, chosen when the file was opened
+   sampleFormat trackFormat{ floatSample };
+   //! Passed to WaveChannel::AppendBuffer
+   sampleFormat effectiveFormat{ floatSample };
+   //! Format of the samples in `channels`
+   sampleFormat format{ floatSample };
+   double rate{ 0 };
+   //! Deinterleaved samples, one buffer for each channel
+   std::vector<std::vector<char>> channels;
+};
+
 class IMPORT_EXPORT_API ImportFileHandle /* not final */
 {
 public:
@@ -150,6 +168,24 @@ public:
       TrackHolders& outTracks, Tags* tags,
       std::optional<LibFileFormats::AcidizerTags>& acidTags) = 0;
 
+   //! Whether Decode() is implemented
+   /*! Default returns false */
+   virtual bool SupportsConcurrentImport() const;
+
+   //! Like Import(), but decodes into memory, on a worker thread
+   /*!
+    Called only if SupportsConcurrentImport().  It must not make tracks or
+    read preferences, which belong to the thread that opened the file and
+    that makes the tracks from `audio` afterwards.  The Tags are its own, and
+    the listener does no user interaction.  Cancel() and Stop() may be called
+    from another thread.  If the batch stops early, it may still run after
+    Importer::ImportBatch() returns, and the handle is then destroyed on the
+    worker.  Default reports an error.
+    */
+   virtual void Decode(ImportProgressListener& progressListener,
+      DecodedAudio& audio, Tags* tags,
+      std::optional<LibFileFormats::AcidizerTags>& acidTags);
+
    virtual void Cancel() = 0;
 
    virtual void Stop() = 0;
@@ -158,8 +194,8 @@ public:
 class IMPORT_EXPORT_API ImportFileHandleEx : public ImportFileHandle
 {
    FilePath mFilename;
-   bool mCancelled{false};
-   bool mStopped{false};
+   std::atomic<bool> mCancelled{false};
+   std::atomic<bool> mStopped{false};
 public:
    ImportFileHandleEx(const FilePath& filename);
 
@@ -0,0 +1,370 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportProgressUITests.cpp
+
+**********************************************************************/
+#include "ExportProgressUI.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+//! Progress dialogs whose buttons are pressed by a script, and dialogs that
+//! are only counted
+struct TestServices final : BasicUI::Services
+{
+   struct ProgressDialog final : BasicUI::ProgressDialog
+   {
+      explicit ProgressDialog(TestServices& services) : services { services }
+      {
+      }
+
+      BasicUI::ProgressResult Poll(unsigned long long, unsigned long long,
+         const TranslatableString&) override
+      {
+         return services.onPoll ? services.onPoll()
+                                : BasicUI::ProgressResult::Success;
+      }
+      void SetMessage(const TranslatableString&) override {}
+      void SetDialogTitle(const TranslatableString&) override {}
+      void Reinit() override {}
+
+      TestServices& services;
+   };
+
+   TestServices() : previous { BasicUI::Install(this) } {}
+   ~TestServices() override { BasicUI::Install(previous); }
+
+   void DoCallAfter(const BasicUI::Action&) override {}
+   void DoYield() override {}
+   void DoShowErrorDialog(const BasicUI::WindowPlacement&,
+      const TranslatableString&, const TranslatableString&,
+      const ManualPageID&, const BasicUI::ErrorDialogOptions&) override
+   {
+      ++errorDialogs;
+   }
+   BasicUI::MessageBoxResult DoMessageBox(
+      const TranslatableString& message, BasicUI::MessageBoxOptions) override
+   {
+      messages.push_back(message.Translation());
+      return BasicUI::MessageBoxResult::Ok;
+   }
+   std::unique_ptr<BasicUI::ProgressDialog> DoMakeProgress(
+      const TranslatableString&, const TranslatableString&, unsigned,
+      const TranslatableString&) override
+   {
+      return std::make_unique<ProgressDialog>(*this);
+   }
+   std::unique_ptr<BasicUI::GenericProgressDialog> DoMakeGenericProgress(
+      const BasicUI::WindowPlacement&, const TranslatableString&,
+      const TranslatableString&, int) override
+   {
+      return nullptr;
+   }
+   int DoMultiDialog(const TranslatableString&, const TranslatableString&,
+      const TranslatableStrings&, const ManualPageID&,
+      const TranslatableString&, bool) override
+   {
+      return 0;
+   }
+   bool DoOpenInDefaultBrowser(const wxString&) override { return false; }
+   std::unique_ptr<BasicUI::WindowPlacement> DoFindFocus() override
+   {
+      return nullptr;
+   }
+   void DoSetFocus(const BasicUI::WindowPlacement&) override {}
+   bool IsUsingRtlLayout() const override { return false; }
+   bool IsUiThread() const override { return true; }
+
+   //! Called on the main thread by each poll of the progress dialog
+   std::function<BasicUI::ProgressResult()> onPoll;
+   size_t errorDialogs {};
+   std::vector<wxString> messages;
+
+   BasicUI::Services* const previous;
+};
+
+//! What a task does when released
+enum class Outcome
+{
+   Succeed,
+   Fail,
+   Throw,
+};
+
+//! Tasks that wait, each on its own thread, until the main thread releases
+//! them, or until cancelled or stopped
+struct Tasks final
+{
+   ExportTask Make(size_t index, Outcome outcome = Outcome::Succeed)
+   {
+      {
+         std::lock_guard lock { mutex };
+         made.push_back(index);
+      }
+      return ExportTask { [this, index, outcome](
+                             ExportProcessorDelegate& delegate) {
+         using namespace std::chrono_literals;
+         std::unique_lock lock { mutex };
+         events.push_back({ index, true });
+         running.push_back(index);
+         maxRunning = std::max(maxRunning, running.size());
+         while (!released.count(index) && !delegate.IsCancelled() &&
+                !delegate.IsStopped())
+            condition.wait_for(lock, 1ms);
+         events.push_back({ index, false });
+         running.erase(std::find(running.begin(), running.end(), index));
+
+         if (delegate.IsCancelled())
+            return ExportResult::Cancelled;
+         if (delegate.IsStopped())
+            return ExportResult::Stopped;
+         if (outcome == Outcome::Throw)
+            throw ExportException { "The disk broke" };
+         return outcome == Outcome::Fail ? ExportResult::Error
+                                         : ExportResult::Success;
+      } };
+   }
+
+   void Release(size_t index)
+   {
+      std::lock_guard lock { mutex };
+      released.insert(index);
+      condition.notify_all();
+   }
+
+   //! Tasks that started and are not released
+   std::vector<size_t> Waiting()
+   {
+      std::lock_guard lock { mutex };
+      std::vector<size_t> result;
+      for (const auto index : running)
+         if (!released.count(index))
+            result.push_back(index);
+      std::sort(result.begin(), result.end());
+      return result;
+   }
+
+   //! Indices in the order that the tasks finished
+   std::vector<size_t> Finished()
+   {
+      std::lock_guard lock { mutex };
+      std::vector<size_t> result;
+      for (const auto& [index, started] : events)
+         if (!started)
+            result.push_back(index);
+      return result;
+   }
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   std::vector<size_t> made;
+   //! Index, and whether the task started or finished
+   std::vector<std::pair<size_t, bool>> events;
+   std::vector<size_t> running;
+   size_t maxRunning {};
+   std::set<size_t> released;
+};
+
+//! Results given to the handler, in order of the calls
+struct Results final
+{
+   ExportProgressUI::ResultHandler Handler(bool proceed = true)
+   {
+      return [this, proceed](size_t index, ExportResult result) {
+         indices.push_back(index);
+         results.push_back(result);
+         return proceed;
+      };
+   }
+
+   std::vector<size_t> indices;
+   std::vector<ExportResult> results;
+};
+
+//! How many tasks ShowBatch runs at once when asked for 3
+size_t Limit()
+{
+   return std::min<size_t>(3, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+std::vector<size_t> Range(size_t first, size_t last)
+{
+   std::vector<size_t> result;
+   for (auto index = first; index < last; ++index)
+      result.push_back(index);
+   return result;
+}
+} // namespace
+
+TEST_CASE("ExportProgressUI::ShowBatch")
+{
+   TestServices services;
+   Tasks tasks;
+   Results results;
+   const auto limit = Limit();
+
+   SECTION("Handles results in order of index, whatever order they finish in")
+   {
+      // Task 2 is skipped
+      constexpr size_t nTasks = 6, nValid = 5;
+      size_t nReleased = 0;
+      // Once as many are running as may be, release the latest first
+      services.onPoll = [&] {
+         const auto waiting = tasks.Waiting();
+         if (!waiting.empty() &&
+             waiting.size() == std::min(limit, nValid - nReleased))
+         {
+            tasks.Release(waiting.back());
+            ++nReleased;
+         }
+         return BasicUI::ProgressResult::Success;
+      };
+      ExportProgressUI::ShowBatch(
+         nTasks,
+         [&](size_t index) {
+            return index == 2 ? ExportTask {} : tasks.Make(index);
+         },
+         results.Handler(), 3);
+
+      REQUIRE(results.indices == std::vector<size_t> { 0, 1, 3, 4, 5 });
+      REQUIRE(std::all_of(
+         results.results.begin(), results.results.end(),
+         [](auto result) { return result == ExportResult::Success; }));
+      REQUIRE(tasks.maxRunning <= limit);
+      if (limit > 1)
+      {
+         REQUIRE(tasks.maxRunning == limit);
+         // The first finished last
+         REQUIRE(tasks.Finished().back() == 0);
+      }
+      REQUIRE(services.errorDialogs == 0);
+   }
+
+   SECTION("A handler that refuses to proceed cancels the running tasks")
+   {
+      services.onPoll = [&] {
+         const auto waiting = tasks.Waiting();
+         if (waiting.size() == limit && waiting.front() == 0)
+            tasks.Release(0);
+         return BasicUI::ProgressResult::Success;
+      };
+      ExportProgressUI::ShowBatch(
+         5, [&](size_t index) { return tasks.Make(index); },
+         results.Handler(false), 3);
+
+      // No more were made, but the results of all that were made are handled
+      REQUIRE(tasks.made == Range(0, limit));
+      REQUIRE(results.indices == Range(0, limit));
+      REQUIRE(results.results.front() == ExportResult::Success);
+      REQUIRE(std::all_of(
+         results.results.begin() + 1, results.results.end(),
+         [](auto result) { return result == ExportResult::Cancelled; }));
+   }
+
+   SECTION("Cancelling the dialog cancels the running tasks")
+   {
+      services.onPoll = [&] {
+         return tasks.Waiting().size() == limit ?
+                   BasicUI::ProgressResult::Cancelled :
+                   BasicUI::ProgressResult::Success;
+      };
+      ExportProgressUI::ShowBatch(
+         5, [&](size_t index) { return tasks.Make(index); },
+         [record = results.Handler()](size_t index, ExportResult result) {
+            record(index, result);
+            return result != ExportResult::Cancelled;
+         },
+         3);
+
+      REQUIRE(tasks.made == Range(0, limit));
+      REQUIRE(results.indices == Range(0, limit));
+      REQUIRE(std::all_of(
+         results.results.begin(), results.results.end(),
+         [](auto result) { return result == ExportResult::Cancelled; }));
+      REQUIRE(services.errorDialogs == 0);
+   }
+
+   SECTION("Stopping the dialog starts no more tasks until those stopped are "
+           "handled")
+   {
+      bool stopped = false;
+      services.onPoll = [&] {
+         const auto waiting = tasks.Waiting();
+         if (!stopped && waiting.size() == limit)
+         {
+            stopped = true;
+            return BasicUI::ProgressResult::Stopped;
+         }
+         for (const auto index : waiting)
+            tasks.Release(index);
+         return BasicUI::ProgressResult::Success;
+      };
+      ExportProgressUI::ShowBatch(
+         5, [&](size_t index) { return tasks.Make(index); },
+         results.Handler(), 3);
+
+      REQUIRE(results.indices == Range(0, 5));
+      for (size_t index = 0; index < 5; ++index)
+         REQUIRE(results.results[index] == (index < limit ?
+            ExportResult::Stopped : ExportResult::Success));
+
+      // Each later task started after all the stopped ones finished
+      const auto firstLater = std::find_if(
+         tasks.events.begin(), tasks.events.end(),
+         [&](const auto& event) { return event.first >= limit; });
+      REQUIRE(std::count_if(tasks.events.begin(), firstLater,
+         [](const auto& event) { return !event.second; }) ==
+         static_cast<ptrdiff_t>(limit));
+   }
+
+   SECTION("Errors of tasks and of making them are shown, in order of index")
+   {
+      // Let every task finish at once
+      services.onPoll = [&] {
+         for (const auto index : tasks.Waiting())
+            tasks.Release(index);
+         return BasicUI::ProgressResult::Success;
+      };
+      ExportProgressUI::ShowBatch(
+         5,
+         [&](size_t index) {
+            switch (index)
+            {
+            case 1:
+               return tasks.Make(index, Outcome::Throw);
+            case 2:
+               throw ExportException { "No such format" };
+            case 3:
+               return tasks.Make(index, Outcome::Fail);
+            default:
+               return tasks.Make(index);
+            }
+         },
+         results.Handler(), 3);
+
+      // An error does not stop the batch
+      REQUIRE(results.indices == Range(0, 5));
+      REQUIRE(results.results == std::vector<ExportResult> {
+         ExportResult::Success, ExportResult::Error, ExportResult::Error,
+         ExportResult::Error, ExportResult::Success });
+      // The exceptions, whether thrown by a task on its own thread or by the
+      // making of it
+      REQUIRE(services.messages ==
+              std::vector<wxString> { "The disk broke", "No such format" });
+      // "Export completed with error." for each
+      REQUIRE(services.errorDialogs == 3);
+   }
+}
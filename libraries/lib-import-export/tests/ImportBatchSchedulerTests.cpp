@@ -0,0 +1,244 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportBatchSchedulerTests.cpp
+
+**********************************************************************/
+#include "ImportBatchScheduler.h"
+#include "concurrency/WorkStealingPool.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using audacity::concurrency::WorkStealingPool;
+using ByteCount = ImportBatchScheduler::ByteCount;
+
+namespace
+{
+//! Records what happens to it; Decode() blocks until released or cancelled
+struct TestJob final : ImportBatchScheduler::Job
+{
+   TestJob(size_t iFile, ByteCount bytes, std::vector<size_t>& order,
+      std::mutex& orderMutex)
+      : Job{ bytes }, iFile{ iFile }, order{ order }, orderMutex{ orderMutex }
+   {
+   }
+
+   void Decode() override
+   {
+      {
+         std::lock_guard<std::mutex> lock{ orderMutex };
+         order.push_back(iFile);
+      }
+      started = true;
+      std::unique_lock<std::mutex> lock{ mutex };
+      condition.wait(lock, [this]{ return released || cancelled; });
+      if (fail)
+         throw std::runtime_error{ "decoding failed" };
+   }
+
+   void Cancel() override
+   {
+      std::lock_guard<std::mutex> lock{ mutex };
+      cancelled = true;
+      condition.notify_all();
+   }
+
+   void Finish()
+   {
+      std::lock_guard<std::mutex> lock{ mutex };
+      released = true;
+      condition.notify_all();
+   }
+
+   const size_t iFile;
+   std::vector<size_t>& order;
+   std::mutex& orderMutex;
+   std::atomic<bool> started{ false };
+   bool fail{ false };
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   bool released{ false };
+   bool cancelled{ false };
+};
+
+struct Fixture
+{
+   //! Makes jobs of the given sizes; zero bytes means no job
+   explicit Fixture(std::vector<ByteCount> sizes)
+      : sizes{ move(sizes) }, made(this->sizes.size())
+   {
+   }
+
+   ImportBatchScheduler::JobFactory Factory()
+   {
+      return [this](size_t iFile) -> std::shared_ptr<ImportBatchScheduler::Job>
+      {
+         factoryCalls.push_back(iFile);
+         if (!sizes[iFile])
+            return nullptr;
+         return made[iFile] = std::make_shared<TestJob>(
+            iFile, sizes[iFile], order, orderMutex);
+      };
+   }
+
+   std::vector<ByteCount> sizes;
+   std::vector<std::shared_ptr<TestJob>> made;
+   std::vector<size_t> factoryCalls;
+   std::vector<size_t> order;
+   std::mutex orderMutex;
+};
+
+bool IsPosted(const ImportBatchScheduler& scheduler, size_t iFile)
+{
+   return scheduler.GetJob(iFile) != nullptr;
+}
+} // namespace
+
+TEST_CASE("ImportBatchScheduler", "")
+{
+   WorkStealingPool pool{ 4 };
+
+   SECTION("Makes and runs the jobs in the order of the files")
+   {
+      Fixture fixture{ { 1, 1, 0, 1, 1 } };
+      ImportBatchScheduler scheduler{ pool, 5, 1, 100, fixture.Factory() };
+      for (size_t ii = 0; ii < 5; ++ii) {
+         scheduler.Dispatch(ii);
+         if (const auto pJob = scheduler.GetJob(ii)) {
+            fixture.made[ii]->Finish();
+            pJob->Wait([&]{ scheduler.Dispatch(ii); });
+         }
+         scheduler.Release(ii);
+      }
+      REQUIRE(fixture.factoryCalls == std::vector<size_t>{ 0, 1, 2, 3, 4 });
+      REQUIRE(fixture.order == std::vector<size_t>{ 0, 1, 3, 4 });
+   }
+
+   SECTION("Posts no more than the limit of running jobs")
+   {
+      Fixture fixture{ { 1, 1, 1, 1 } };
+      ImportBatchScheduler scheduler{ pool, 4, 2, 100, fixture.Factory() };
+      scheduler.Dispatch(0);
+      REQUIRE(IsPosted(scheduler, 0));
+      REQUIRE(IsPosted(scheduler, 1));
+      REQUIRE(!IsPosted(scheduler, 2));
+
+      fixture.made[0]->Finish();
+      scheduler.GetJob(0)->Wait([]{});
+      scheduler.Dispatch(0);
+      REQUIRE(IsPosted(scheduler, 2));
+      REQUIRE(!IsPosted(scheduler, 3));
+
+      for (const auto &pJob : fixture.made)
+         if (pJob)
+            pJob->Finish();
+   }
+
+   SECTION("Keeps posted jobs within the budget")
+   {
+      Fixture fixture{ { 40, 40, 40, 10 } };
+      ImportBatchScheduler scheduler{ pool, 4, 8, 100, fixture.Factory() };
+      scheduler.Dispatch(0);
+      REQUIRE(IsPosted(scheduler, 0));
+      REQUIRE(IsPosted(scheduler, 1));
+      // Would exceed the budget, and later files wait for it
+      REQUIRE(!IsPosted(scheduler, 2));
+      REQUIRE(!IsPosted(scheduler, 3));
+      REQUIRE(scheduler.GetBytesInFlight() == 80);
+
+      // Done is not enough; the memory is held until released
+      fixture.made[0]->Finish();
+      scheduler.GetJob(0)->Wait([]{});
+      scheduler.Dispatch(0);
+      REQUIRE(!IsPosted(scheduler, 2));
+
+      scheduler.Release(0);
+      scheduler.Dispatch(1);
+      REQUIRE(IsPosted(scheduler, 2));
+      REQUIRE(IsPosted(scheduler, 3));
+      REQUIRE(scheduler.GetBytesInFlight() == 90);
+      // Each file was made just once
+      REQUIRE(fixture.factoryCalls == std::vector<size_t>{ 0, 1, 2, 3 });
+
+      for (const auto &pJob : fixture.made)
+         pJob->Finish();
+   }
+
+   SECTION("Leaves a job bigger than the budget to the caller")
+   {
+      Fixture fixture{ { 10, 200, 10 } };
+      ImportBatchScheduler scheduler{ pool, 3, 8, 100, fixture.Factory() };
+      scheduler.Dispatch(0);
+      REQUIRE(IsPosted(scheduler, 0));
+      REQUIRE(!IsPosted(scheduler, 1));
+      REQUIRE(IsPosted(scheduler, 2));
+      REQUIRE(scheduler.GetBytesInFlight() == 20);
+      REQUIRE(!fixture.made[1]->started);
+
+      fixture.made[0]->Finish();
+      fixture.made[2]->Finish();
+   }
+
+   SECTION("Keeps the exception of a job")
+   {
+      Fixture fixture{ { 1 } };
+      ImportBatchScheduler scheduler{ pool, 1, 1, 100, fixture.Factory() };
+      scheduler.Dispatch(0);
+      fixture.made[0]->fail = true;
+      fixture.made[0]->Finish();
+      const auto pJob = scheduler.GetJob(0);
+      pJob->Wait([]{});
+      REQUIRE(pJob->error);
+      REQUIRE_THROWS_AS(
+         std::rethrow_exception(pJob->error), std::runtime_error);
+   }
+
+   SECTION("Releases a running job without waiting")
+   {
+      Fixture fixture{ { 1, 1 } };
+      ImportBatchScheduler scheduler{ pool, 2, 1, 100, fixture.Factory() };
+      scheduler.Dispatch(0);
+      const auto pJob = scheduler.GetJob(0);
+      while (!fixture.made[0]->started)
+         std::this_thread::yield();
+      scheduler.Release(0);
+      REQUIRE(pJob->IsAbandoned());
+      REQUIRE(scheduler.GetBytesInFlight() == 0);
+      // Stops because it was cancelled
+      pJob->Wait([]{});
+   }
+
+   SECTION("Cancels queued jobs without waiting")
+   {
+      // One worker, so that the second job stays in the queue
+      WorkStealingPool one{ 1 };
+      Fixture fixture{ { 1, 1, 1 } };
+      {
+         ImportBatchScheduler scheduler{ one, 3, 2, 100, fixture.Factory() };
+         scheduler.Dispatch(0);
+         REQUIRE(IsPosted(scheduler, 0));
+         REQUIRE(IsPosted(scheduler, 1));
+         while (!fixture.made[0]->started)
+            std::this_thread::yield();
+         // Destruction abandons both jobs and returns
+      }
+      for (const auto &pJob : { fixture.made[0], fixture.made[1] }) {
+         pJob->Wait([]{});
+         REQUIRE(pJob->IsAbandoned());
+      }
+      // The queued job never decoded
+      REQUIRE(fixture.order == std::vector<size_t>{ 0 });
+      // Not made before the limit allowed
+      REQUIRE(!fixture.made[2]);
+   }
+}
@@ -0,0 +1,132 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportPipelineTests.cpp
+
+**********************************************************************/
+#include "ImportPipeline.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+constexpr size_t NChannels = 3;
+// Not a multiple of the chunk size
+constexpr size_t TotalFrames = 10000 + 7;
+
+float Sample(size_t frame, size_t channel)
+{
+   return frame + channel / 4.0f;
+}
+
+//! Decodes TotalFrames frames, in reads of varying sizes, possibly throwing
+//! after `failAt` frames
+ImportPipeline::Decoder MakeDecoder(size_t& position, size_t failAt = 0)
+{
+   return [&position, failAt](samplePtr buffer, size_t maxFrames) {
+      if (failAt && position >= failAt)
+         throw std::runtime_error { "decoding failed" };
+      // Sometimes short reads
+      const auto frames = std::min(
+         { maxFrames, TotalFrames - position, 1 + position % maxFrames });
+      const auto samples = reinterpret_cast<float*>(buffer);
+      for (size_t ii = 0; ii < frames; ++ii)
+         for (size_t iChannel = 0; iChannel < NChannels; ++iChannel)
+            samples[ii * NChannels + iChannel] =
+               Sample(position + ii, iChannel);
+      position += frames;
+      return frames;
+   };
+}
+
+struct Collector final
+{
+   std::vector<std::vector<float>> channels =
+      std::vector<std::vector<float>>(NChannels);
+
+   ImportPipeline::Consumer Consumer()
+   {
+      return [this](const constSamplePtr* buffers, size_t frames) {
+         for (size_t iChannel = 0; iChannel < NChannels; ++iChannel)
+         {
+            const auto samples =
+               reinterpret_cast<const float*>(buffers[iChannel]);
+            channels[iChannel].insert(
+               channels[iChannel].end(), samples, samples + frames);
+         }
+      };
+   }
+
+   bool Check(size_t frames) const
+   {
+      for (size_t iChannel = 0; iChannel < NChannels; ++iChannel)
+      {
+         if (channels[iChannel].size() != frames)
+            return false;
+         for (size_t ii = 0; ii < frames; ++ii)
+            if (channels[iChannel][ii] != Sample(ii, iChannel))
+               return false;
+      }
+      return true;
+   }
+};
+} // namespace
+
+TEST_CASE("ImportPipeline delivers all frames in order")
+{
+   for (const auto queueDepth :
+        { size_t { 1 }, size_t { 2 }, ImportPipeline::DefaultQueueDepth })
+      for (const size_t chunkFrames : { 1, 100, 4096, 20000 })
+      {
+         size_t position = 0;
+         Collector collector;
+         sampleCount lastProgress = 0;
+         const auto frames = ImportPipeline::Run(
+            NChannels, floatSample, chunkFrames, MakeDecoder(position),
+            collector.Consumer(),
+            [&](sampleCount framesDone) {
+               REQUIRE(framesDone > lastProgress);
+               lastProgress = framesDone;
+               return true;
+            },
+            queueDepth);
+         REQUIRE(frames == TotalFrames);
+         REQUIRE(lastProgress == TotalFrames);
+         REQUIRE(collector.Check(TotalFrames));
+      }
+}
+
+TEST_CASE("ImportPipeline stops when progress says so")
+{
+   size_t position = 0;
+   Collector collector;
+   const auto frames = ImportPipeline::Run(
+      NChannels, floatSample, 100, MakeDecoder(position), collector.Consumer(),
+      [](sampleCount framesDone) { return framesDone < 1000; });
+   REQUIRE(frames >= 1000);
+   REQUIRE(frames < TotalFrames);
+   REQUIRE(collector.Check(frames.as_size_t()));
+   // The decoder ran ahead by at most the queue depth
+   REQUIRE(
+      position <=
+      frames.as_size_t() + 100 * (ImportPipeline::DefaultQueueDepth + 1));
+}
+
+TEST_CASE("ImportPipeline rethrows errors of the decoder")
+{
+   size_t position = 0;
+   Collector collector;
+   REQUIRE_THROWS_AS(
+      ImportPipeline::Run(
+         NChannels, floatSample, 100, MakeDecoder(position, 5000),
+         collector.Consumer(), [](sampleCount) { return true; }),
+      std::runtime_error);
+   // Frames decoded before the error were all consumed
+   REQUIRE(collector.Check(position));
+}
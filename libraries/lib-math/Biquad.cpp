@@ -0,0 +1,861 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+Biquad.cpp
+
+Norm C
+Max Maisel
+
+***********************************************************************/
+
+#include "Biquad.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIQUAD_SSE2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BIQUAD_AVX2
+#define AVX2_TARGET
+#elif defined(__GNUC__)
+#define BIQUAD_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(__arm64__) || defined(_M_ARM64)
+#define BIQUAD_NEON
+#include <arm_neon.h>
+#endif
+
+#define square(a) ((a)*(a))
+#define PI M_PI
+
+Biquad::Biquad()
+{
+   fNumerCoeffs[B0] = 1;
+   fNumerCoeffs[B1] = 0;
+   fNumerCoeffs[B2] = 0;
+   fDenomCoeffs[A1] = 0;
+   fDenomCoeffs[A2] = 0;
+   Reset();
+}
+
+void Biquad::Reset()
+{
+   fPrevIn = 0;
+   fPrevPrevIn = 0;
+   fPrevOut = 0;
+   fPrevPrevOut = 0;
+}
+
+void Biquad::Process(const float* pfIn, float* pfOut, int iNumSamples)
+{
+   for (int i = 0; i < iNumSamples; i++)
+      *pfOut++ = ProcessOne(*pfIn++);
+}
+
+const double Biquad::s_fChebyCoeffs[MAX_Order][MAX_Order + 1] =
+{
+   // For Chebyshev polynomials of the first kind (see http://en.wikipedia.org/wiki/Chebyshev_polynomial)
+   // Coeffs are in the order 0, 1, 2...9
+   { 0,  1},        // order 1
+   {-1,  0,   2},   // order 2 etc.
+   { 0, -3,   0,    4},
+   { 1,  0,  -8,    0,    8},
+   { 0,  5,   0,  -20,    0,   16},
+   {-1,  0,  18,    0,  -48,    0,   32},
+   { 0, -7,   0,   56,    0, -112,    0,   64},
+   { 1,  0, -32,    0,  160,    0, -256,    0,  128},
+   { 0,  9,   0, -120,    0,  432,    0, -576,    0,   256},
+   {-1,  0,  50,    0, -400,    0, 1120,    0, -1280,    0, 512}
+};
+
+// order: filter order
+// fn: nyquist frequency, i.e. half sample rate
+// fc: cutoff frequency
+// subtype: highpass or lowpass
+ArrayOf<Biquad> Biquad::CalcButterworthFilter(int order, double fn, double fc, int subtype)
+{
+   ArrayOf<Biquad> pBiquad(size_t((order+1) / 2), true);
+   // Set up the coefficients in all the biquads
+   double fNorm = fc / fn;
+   if (fNorm >= 0.9999)
+      fNorm = 0.9999F;
+   double fC = tan (PI * fNorm / 2);
+   double fDCPoleDistSqr = 1.0F;
+   double fZPoleX, fZPoleY;
+
+   if ((order & 1) == 0)
+   {
+      // Even order
+      for (int iPair = 0; iPair < order/2; iPair++)
+      {
+         double fSPoleX = fC * cos (PI - (iPair + 0.5) * PI / order);
+         double fSPoleY = fC * sin (PI - (iPair + 0.5) * PI / order);
+         BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+         pBiquad[iPair].fNumerCoeffs [B0] = 1;
+         if (subtype == kLowPass)     // LOWPASS
+            pBiquad[iPair].fNumerCoeffs [B1] = 2;
+         else
+            pBiquad[iPair].fNumerCoeffs [B1] = -2;
+         pBiquad[iPair].fNumerCoeffs [B2] = 1;
+         pBiquad[iPair].fDenomCoeffs [A1] = -2 * fZPoleX;
+         pBiquad[iPair].fDenomCoeffs [A2] = square(fZPoleX) + square(fZPoleY);
+         if (subtype == kLowPass)     // LOWPASS
+            fDCPoleDistSqr *= Calc2D_DistSqr (1, 0, fZPoleX, fZPoleY);
+         else
+            fDCPoleDistSqr *= Calc2D_DistSqr (-1, 0, fZPoleX, fZPoleY);    // distance from Nyquist
+      }
+   }
+   else
+   {
+      // Odd order - first do the 1st-order section
+      double fSPoleX = -fC;
+      double fSPoleY = 0;
+      BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+      pBiquad[0].fNumerCoeffs [B0] = 1;
+      if (subtype == kLowPass)     // LOWPASS
+         pBiquad[0].fNumerCoeffs [B1] = 1;
+      else
+         pBiquad[0].fNumerCoeffs [B1] = -1;
+      pBiquad[0].fNumerCoeffs [B2] = 0;
+      pBiquad[0].fDenomCoeffs [A1] = -fZPoleX;
+      pBiquad[0].fDenomCoeffs [A2] = 0;
+      if (subtype == kLowPass)     // LOWPASS
+         fDCPoleDistSqr = 1 - fZPoleX;
+      else
+         fDCPoleDistSqr = fZPoleX + 1;    // dist from Nyquist
+      for (int iPair = 1; iPair <= order/2; iPair++)
+      {
+         double fSPoleX = fC * cos (PI - iPair * PI / order);
+         double fSPoleY = fC * sin (PI - iPair * PI / order);
+         BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+         pBiquad[iPair].fNumerCoeffs [B0] = 1;
+         if (subtype == kLowPass)     // LOWPASS
+            pBiquad[iPair].fNumerCoeffs [B1] = 2;
+         else
+            pBiquad[iPair].fNumerCoeffs [B1] = -2;
+         pBiquad[iPair].fNumerCoeffs [B2] = 1;
+         pBiquad[iPair].fDenomCoeffs [A1] = -2 * fZPoleX;
+         pBiquad[iPair].fDenomCoeffs [A2] = square(fZPoleX) + square(fZPoleY);
+         if (subtype == kLowPass)     // LOWPASS
+            fDCPoleDistSqr *= Calc2D_DistSqr (1, 0, fZPoleX, fZPoleY);
+         else
+            fDCPoleDistSqr *= Calc2D_DistSqr (-1, 0, fZPoleX, fZPoleY);    // distance from Nyquist
+      }
+   }
+   pBiquad[0].fNumerCoeffs [B0] *= fDCPoleDistSqr / (1 << order);   // mult by DC dist from poles, divide by dist from zeroes
+   pBiquad[0].fNumerCoeffs [B1] *= fDCPoleDistSqr / (1 << order);
+   pBiquad[0].fNumerCoeffs [B2] *= fDCPoleDistSqr / (1 << order);
+
+   return pBiquad;
+}
+
+// order: filter order
+// fn: nyquist frequency, i.e. half sample rate
+// fc: cutoff frequency
+// ripple: passband ripple in dB
+// subtype: highpass or lowpass
+ArrayOf<Biquad> Biquad::CalcChebyshevType1Filter(int order, double fn, double fc, double ripple, int subtype)
+{
+   ArrayOf<Biquad> pBiquad(size_t((order+1) / 2), true);
+   // Set up the coefficients in all the biquads
+   double fNorm = fc / fn;
+   if (fNorm >= 0.9999)
+      fNorm = 0.9999F;
+   double fC = tan (PI * fNorm / 2);
+   double fDCPoleDistSqr = 1.0F;
+   double fZPoleX, fZPoleY;
+   double fZZeroX;
+   double beta = cos (fNorm*PI);
+
+   double eps; eps = sqrt (pow (10.0, std::max(0.001, ripple) / 10.0) - 1);
+   double a; a = log (1 / eps + sqrt(1 / square(eps) + 1)) / order;
+   // Assume even order to start
+   for (int iPair = 0; iPair < order/2; iPair++)
+   {
+      double fSPoleX = -fC * sinh (a) * sin ((2*iPair + 1) * PI / (2 * order));
+      double fSPoleY = fC * cosh (a) * cos ((2*iPair + 1) * PI / (2 * order));
+      BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+      if (subtype == kLowPass)     // LOWPASS
+      {
+         fZZeroX = -1;
+         fDCPoleDistSqr = Calc2D_DistSqr (1, 0, fZPoleX, fZPoleY);
+         fDCPoleDistSqr /= 2*2;  // dist from zero at Nyquist
+      }
+      else
+      {
+         // Highpass - do the digital LP->HP transform on the poles and zeroes
+         ComplexDiv (beta - fZPoleX, -fZPoleY, 1 - beta * fZPoleX, -beta * fZPoleY, &fZPoleX, &fZPoleY);
+         fZZeroX = 1;
+         fDCPoleDistSqr = Calc2D_DistSqr (-1, 0, fZPoleX, fZPoleY);     // distance from Nyquist
+         fDCPoleDistSqr /= 2*2;  // dist from zero at Nyquist
+      }
+      pBiquad[iPair].fNumerCoeffs [B0] = fDCPoleDistSqr;
+      pBiquad[iPair].fNumerCoeffs [B1] = -2 * fZZeroX * fDCPoleDistSqr;
+      pBiquad[iPair].fNumerCoeffs [B2] = fDCPoleDistSqr;
+      pBiquad[iPair].fDenomCoeffs [A1] = -2 * fZPoleX;
+      pBiquad[iPair].fDenomCoeffs [A2] = square(fZPoleX) + square(fZPoleY);
+   }
+   if ((order & 1) == 0)
+   {
+      double fTemp = DB_TO_LINEAR(-std::max(0.001, ripple));      // at DC the response is down R dB (for even-order)
+      pBiquad[0].fNumerCoeffs [B0] *= fTemp;
+      pBiquad[0].fNumerCoeffs [B1] *= fTemp;
+      pBiquad[0].fNumerCoeffs [B2] *= fTemp;
+   }
+   else
+   {
+      // Odd order - now do the 1st-order section
+      double fSPoleX = -fC * sinh (a);
+      double fSPoleY = 0;
+      BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+      if (subtype == kLowPass)     // LOWPASS
+      {
+         fZZeroX = -1;
+         fDCPoleDistSqr = sqrt(Calc2D_DistSqr (1, 0, fZPoleX, fZPoleY));
+         fDCPoleDistSqr /= 2;  // dist from zero at Nyquist
+      }
+      else
+      {
+         // Highpass - do the digital LP->HP transform on the poles and zeroes
+         ComplexDiv (beta - fZPoleX, -fZPoleY, 1 - beta * fZPoleX, -beta * fZPoleY, &fZPoleX, &fZPoleY);
+         fZZeroX = 1;
+         fDCPoleDistSqr = sqrt(Calc2D_DistSqr (-1, 0, fZPoleX, fZPoleY));     // distance from Nyquist
+         fDCPoleDistSqr /= 2;  // dist from zero at Nyquist
+      }
+      pBiquad[(order-1)/2].fNumerCoeffs [B0] = fDCPoleDistSqr;
+      pBiquad[(order-1)/2].fNumerCoeffs [B1] = -fZZeroX * fDCPoleDistSqr;
+      pBiquad[(order-1)/2].fNumerCoeffs [B2] = 0;
+      pBiquad[(order-1)/2].fDenomCoeffs [A1] = -fZPoleX;
+      pBiquad[(order-1)/2].fDenomCoeffs [A2] = 0;
+   }
+   return pBiquad;
+}
+
+// order: filter order
+// fn: nyquist frequency, i.e. half sample rate
+// fc: cutoff frequency
+// ripple: stopband ripple in dB
+// subtype: highpass or lowpass
+ArrayOf<Biquad> Biquad::CalcChebyshevType2Filter(int order, double fn, double fc, double ripple, int subtype)
+{
+   ArrayOf<Biquad> pBiquad(size_t((order+1) / 2), true);
+   // Set up the coefficients in all the biquads
+   double fNorm = fc / fn;
+   if (fNorm >= 0.9999)
+      fNorm = 0.9999F;
+   double fC = tan (PI * fNorm / 2);
+   double fDCPoleDistSqr = 1.0F;
+   double fZPoleX, fZPoleY;
+   double fZZeroX, fZZeroY;
+   double beta = cos (fNorm*PI);
+
+   double fSZeroX, fSZeroY;
+   double fSPoleX, fSPoleY;
+   double eps = DB_TO_LINEAR(-std::max(0.001, ripple));
+   double a = log (1 / eps + sqrt(1 / square(eps) + 1)) / order;
+
+   // Assume even order
+   for (int iPair = 0; iPair < order/2; iPair++)
+   {
+      ComplexDiv (fC, 0, -sinh (a) * sin ((2*iPair + 1) * PI / (2 * order)),
+         cosh (a) * cos ((2*iPair + 1) * PI / (2 * order)),
+         &fSPoleX, &fSPoleY);
+      BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+      fSZeroX = 0;
+      fSZeroY = fC / cos (((2 * iPair) + 1) * PI / (2 * order));
+      BilinTransform (fSZeroX, fSZeroY, &fZZeroX, &fZZeroY);
+
+      if (subtype == kLowPass)     // LOWPASS
+      {
+         fDCPoleDistSqr = Calc2D_DistSqr (1, 0, fZPoleX, fZPoleY);
+         fDCPoleDistSqr /= Calc2D_DistSqr (1, 0, fZZeroX, fZZeroY);
+      }
+      else
+      {
+         // Highpass - do the digital LP->HP transform on the poles and zeroes
+         ComplexDiv (beta - fZPoleX, -fZPoleY, 1 - beta * fZPoleX, -beta * fZPoleY, &fZPoleX, &fZPoleY);
+         ComplexDiv (beta - fZZeroX, -fZZeroY, 1 - beta * fZZeroX, -beta * fZZeroY, &fZZeroX, &fZZeroY);
+         fDCPoleDistSqr = Calc2D_DistSqr (-1, 0, fZPoleX, fZPoleY);     // distance from Nyquist
+         fDCPoleDistSqr /= Calc2D_DistSqr (-1, 0, fZZeroX, fZZeroY);
+      }
+      pBiquad[iPair].fNumerCoeffs [B0] = fDCPoleDistSqr;
+      pBiquad[iPair].fNumerCoeffs [B1] = -2 * fZZeroX * fDCPoleDistSqr;
+      pBiquad[iPair].fNumerCoeffs [B2] = (square(fZZeroX) + square(fZZeroY)) * fDCPoleDistSqr;
+      pBiquad[iPair].fDenomCoeffs [A1] = -2 * fZPoleX;
+      pBiquad[iPair].fDenomCoeffs [A2] = square(fZPoleX) + square(fZPoleY);
+   }
+   // Now, if it's odd order, we have one more to do
+   if (order & 1)
+   {
+      int iPair = (order-1)/2; // we'll do it as a biquad, but it's just first-order
+      ComplexDiv (fC, 0, -sinh (a) * sin ((2*iPair + 1) * PI / (2 * order)),
+         cosh (a) * cos ((2*iPair + 1) * PI / (2 * order)),
+         &fSPoleX, &fSPoleY);
+      BilinTransform (fSPoleX, fSPoleY, &fZPoleX, &fZPoleY);
+      fZZeroX = -1;     // in the s-plane, the zero is at infinity
+      fZZeroY = 0;
+      if (subtype == kLowPass)     // LOWPASS
+      {
+         fDCPoleDistSqr = sqrt(Calc2D_DistSqr (1, 0, fZPoleX, fZPoleY));
+         fDCPoleDistSqr /= 2;
+      }
+      else
+      {
+         // Highpass - do the digital LP->HP transform on the poles and zeroes
+         ComplexDiv (beta - fZPoleX, -fZPoleY, 1 - beta * fZPoleX, -fZPoleY, &fZPoleX, &fZPoleY);
+         fZZeroX = 1;
+         fDCPoleDistSqr = sqrt(Calc2D_DistSqr (-1, 0, fZPoleX, fZPoleY));     // distance from Nyquist
+         fDCPoleDistSqr /= 2;
+      }
+      pBiquad[iPair].fNumerCoeffs [B0] = fDCPoleDistSqr;
+      pBiquad[iPair].fNumerCoeffs [B1] = -fZZeroX * fDCPoleDistSqr;
+      pBiquad[iPair].fNumerCoeffs [B2] = 0;
+      pBiquad[iPair].fDenomCoeffs [A1] = -fZPoleX;
+      pBiquad[iPair].fDenomCoeffs [A2] = 0;
+   }
+   return pBiquad;
+}
+
+void Biquad::ComplexDiv (double fNumerR, double fNumerI, double fDenomR, double fDenomI,
+                         double* pfQuotientR, double* pfQuotientI)
+{
+   double fDenom = square(fDenomR) + square(fDenomI);
+   *pfQuotientR = (fNumerR * fDenomR + fNumerI * fDenomI) / fDenom;
+   *pfQuotientI = (fNumerI * fDenomR - fNumerR * fDenomI) / fDenom;
+}
+
+bool Biquad::BilinTransform (double fSX, double fSY, double* pfZX, double* pfZY)
+{
+   double fDenom = square (1 - fSX) + square (fSY);
+   *pfZX = (1 - square (fSX) - square (fSY)) / fDenom;
+   *pfZY = 2 * fSY / fDenom;
+   return true;
+}
+
+float Biquad::Calc2D_DistSqr (double fX1, double fY1, double fX2, double fY2)
+{
+   return square (fX1 - fX2) + square (fY1 - fY2);
+}
+
+double Biquad::ChebyPoly(int Order, double NormFreq)   // NormFreq = 1 at the f0 point (where response is R dB down)
+{
+   // Calc cosh (Order * acosh (NormFreq));
+   double x = 1;
+   double fSum = 0;
+   assert (Order >= MIN_Order && Order <= MAX_Order);
+   for (int i = 0; i <= Order; i++)
+   {
+      fSum += s_fChebyCoeffs [Order-1][i] * x;
+      x *= NormFreq;
+   }
+   return fSum;
+}
+
+namespace
+{
+//! Lanes of vectors hold the sections of whole channels, in order
+constexpr size_t MaxLanes = 8;
+//! Lanes of a batch are rounded up to a multiple of the widest vectors
+constexpr size_t MaxWidth = 4;
+
+enum : size_t { B0, B1, B2, A1, A2, X1, X2, Y1, Y2, nArrays };
+
+//! Pointers into the values of a batch
+struct Lanes
+{
+   Lanes(std::vector<double>& values, size_t nLanes_, size_t nSections_,
+      size_t nChannels_)
+      : nLanes{ nLanes_ }, nSections{ nSections_ }, nChannels{ nChannels_ }
+   {
+      for (size_t ii = 0; ii < nArrays; ++ii)
+         arrays[ii] = values.data() + ii * nLanes;
+   }
+
+   //! Whether the lane takes the input of a channel, not the output of the
+   //! lane before it; extra lanes take zero
+   bool TakesInput(size_t lane) const
+   {
+      return lane % nSections == 0 || lane >= nChannels * nSections;
+   }
+
+   double* arrays[nArrays];
+   const size_t nLanes;
+   const size_t nSections;
+   const size_t nChannels;
+};
+
+//! Terms that do not depend on the input of the step nor on the last output
+//! are summed first, to shorten the chain of dependencies between steps.
+//! The vector kernels follow the same order of operations.
+inline double FilterScalar(const Lanes& lanes, size_t l, double x)
+{
+   const auto& a = lanes.arrays;
+   const double partial =
+      (a[B1][l] * a[X1][l] + a[B2][l] * a[X2][l]) - a[A2][l] * a[Y2][l];
+   const double y = (a[B0][l] * x + partial) - a[A1][l] * a[Y1][l];
+   a[X2][l] = a[X1][l];
+   a[X1][l] = x;
+   a[Y2][l] = a[Y1][l];
+   a[Y1][l] = y;
+   return y;
+}
+
+//! Step t, in which section s of each channel filters sample t - s, if
+//! there is such a sample
+void StepScalar(const Lanes& lanes, const float* const* in, float* const* out,
+   size_t t, size_t len)
+{
+   const auto nSections = lanes.nSections;
+   for (size_t channel = 0; channel < lanes.nChannels; ++channel)
+      // Later sections first, so that they see the outputs of earlier ones
+      // from the previous step
+      for (auto section = nSections; section-- > 0;)
+      {
+         if (t < section || t - section >= len)
+            continue;
+         const auto lane = channel * nSections + section;
+         const double x =
+            section == 0 ? in[channel][t] : lanes.arrays[Y1][lane - 1];
+         const auto y = FilterScalar(lanes, lane, x);
+         if (section == nSections - 1)
+            out[channel][t - section] = y;
+      }
+}
+
+//! Steps from first to last, in which all sections are busy
+void RunScalar(const Lanes& lanes, const float* const* in, float* const* out,
+   size_t first, size_t last)
+{
+   for (auto t = first; t < last; ++t)
+      StepScalar(lanes, in, out, t, last);
+}
+
+//! Steps of the vector kernels go in chunks, so that inputs and outputs
+//! move between channels and lanes outside of the chain of dependencies
+constexpr size_t ChunkSteps = 64;
+
+//! Gathers inputs of steps t0, t0 + 1... into the lanes that take them, in
+//! rows of nLanes values; the other lanes stay zero
+inline void Feed(const Lanes& lanes, size_t nLanes, const float* const* in,
+   size_t t0, size_t nSteps, double* feed)
+{
+   for (size_t channel = 0; channel < lanes.nChannels; ++channel)
+   {
+      const auto samples = in[channel] + t0;
+      auto row = feed + channel * lanes.nSections;
+      for (size_t ii = 0; ii < nSteps; ++ii, row += nLanes)
+         *row = samples[ii];
+   }
+}
+
+//! Scatters outputs of steps t0, t0 + 1... from the last lanes of the
+//! channels
+inline void Drain(const Lanes& lanes, size_t nLanes, const double* ys,
+   size_t t0, size_t nSteps, float* const* out)
+{
+   const auto last = lanes.nSections - 1;
+   for (size_t channel = 0; channel < lanes.nChannels; ++channel)
+   {
+      const auto samples = out[channel] + t0 - last;
+      auto row = ys + channel * lanes.nSections + last;
+      for (size_t ii = 0; ii < nSteps; ++ii, row += nLanes)
+         samples[ii] = *row;
+   }
+}
+
+// The loops over groups must unroll, so that arrays of vectors stay in
+// registers
+#if defined(__GNUC__)
+#define UNROLL _Pragma("GCC unroll 4")
+#else
+#define UNROLL
+#endif
+
+#ifdef BIQUAD_SSE2
+template<size_t nGroups>
+void RunSSE2Groups(const Lanes& lanes, const float* const* in,
+   float* const* out, size_t first, size_t last)
+{
+   constexpr size_t width = 2;
+   const auto& a = lanes.arrays;
+   __m128d b0[nGroups], b1[nGroups], b2[nGroups], a1[nGroups], a2[nGroups],
+      x1[nGroups], x2[nGroups], y1[nGroups], y2[nGroups], takes[nGroups];
+   UNROLL for (size_t g = 0; g < nGroups; ++g)
+   {
+      const auto l = g * width;
+      b0[g] = _mm_loadu_pd(a[B0] + l), b1[g] = _mm_loadu_pd(a[B1] + l),
+      b2[g] = _mm_loadu_pd(a[B2] + l), a1[g] = _mm_loadu_pd(a[A1] + l),
+      a2[g] = _mm_loadu_pd(a[A2] + l), x1[g] = _mm_loadu_pd(a[X1] + l),
+      x2[g] = _mm_loadu_pd(a[X2] + l), y1[g] = _mm_loadu_pd(a[Y1] + l),
+      y2[g] = _mm_loadu_pd(a[Y2] + l);
+      const auto mask = [&](size_t lane) {
+         return lanes.TakesInput(lane) ? -1 : 0; };
+      takes[g] = _mm_castsi128_pd(
+         _mm_set_epi64x(mask(l + 1), mask(l)));
+   }
+
+   constexpr auto nLanes = nGroups * width;
+   double feed[ChunkSteps * nLanes] = {}, ys[ChunkSteps * nLanes];
+   for (auto t0 = first; t0 < last; t0 += ChunkSteps)
+   {
+      const auto nSteps = std::min(ChunkSteps, last - t0);
+      Feed(lanes, nLanes, in, t0, nSteps, feed);
+      for (size_t ii = 0; ii < nSteps; ++ii)
+      {
+         const auto row = ii * nLanes;
+         __m128d x[nGroups];
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+         {
+            // Each lane takes the last output of the lane before it
+            const auto shifted = _mm_shuffle_pd(y1[g ? g - 1 : 0], y1[g], 1);
+            x[g] = _mm_or_pd(_mm_andnot_pd(takes[g], shifted),
+               _mm_loadu_pd(feed + row + g * width));
+         }
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+         {
+            const auto partial = _mm_sub_pd(
+               _mm_add_pd(_mm_mul_pd(b1[g], x1[g]), _mm_mul_pd(b2[g], x2[g])),
+               _mm_mul_pd(a2[g], y2[g]));
+            const auto y = _mm_sub_pd(
+               _mm_add_pd(_mm_mul_pd(b0[g], x[g]), partial),
+               _mm_mul_pd(a1[g], y1[g]));
+            x2[g] = x1[g], x1[g] = x[g], y2[g] = y1[g], y1[g] = y;
+            _mm_storeu_pd(ys + row + g * width, y);
+         }
+      }
+      Drain(lanes, nLanes, ys, t0, nSteps, out);
+   }
+
+   UNROLL for (size_t g = 0; g < nGroups; ++g)
+   {
+      const auto l = g * width;
+      _mm_storeu_pd(a[X1] + l, x1[g]), _mm_storeu_pd(a[X2] + l, x2[g]),
+      _mm_storeu_pd(a[Y1] + l, y1[g]), _mm_storeu_pd(a[Y2] + l, y2[g]);
+   }
+}
+
+void RunSSE2(const Lanes& lanes, const float* const* in, float* const* out,
+   size_t first, size_t last)
+{
+   switch (lanes.nLanes / 2)
+   {
+   case 2: return RunSSE2Groups<2>(lanes, in, out, first, last);
+   case 4: return RunSSE2Groups<4>(lanes, in, out, first, last);
+   default: return RunScalar(lanes, in, out, first, last);
+   }
+}
+#endif
+
+#ifdef BIQUAD_AVX2
+bool HasAVX2()
+{
+#if defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7)
+      return false;
+   __cpuid(info, 1);
+   // The processor has AVX and the system saves its registers
+   constexpr int osxsave = 1 << 27, avx = 1 << 28;
+   if ((info[2] & (osxsave | avx)) != (osxsave | avx) ||
+       (_xgetbv(0) & 6) != 6)
+      return false;
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#else
+   return __builtin_cpu_supports("avx2");
+#endif
+}
+
+template<size_t nGroups>
+AVX2_TARGET void RunAVX2Groups(const Lanes& lanes, const float* const* in,
+   float* const* out, size_t first, size_t last)
+{
+   constexpr size_t width = 4;
+   const auto& a = lanes.arrays;
+   __m256d b0[nGroups], b1[nGroups], b2[nGroups], a1[nGroups], a2[nGroups],
+      x1[nGroups], x2[nGroups], y1[nGroups], y2[nGroups], takes[nGroups];
+   UNROLL for (size_t g = 0; g < nGroups; ++g)
+   {
+      const auto l = g * width;
+      b0[g] = _mm256_loadu_pd(a[B0] + l), b1[g] = _mm256_loadu_pd(a[B1] + l),
+      b2[g] = _mm256_loadu_pd(a[B2] + l), a1[g] = _mm256_loadu_pd(a[A1] + l),
+      a2[g] = _mm256_loadu_pd(a[A2] + l), x1[g] = _mm256_loadu_pd(a[X1] + l),
+      x2[g] = _mm256_loadu_pd(a[X2] + l), y1[g] = _mm256_loadu_pd(a[Y1] + l),
+      y2[g] = _mm256_loadu_pd(a[Y2] + l);
+      const auto mask = [&](size_t lane) {
+         return lanes.TakesInput(lane) ? -1 : 0; };
+      takes[g] = _mm256_castsi256_pd(
+         _mm256_set_epi64x(mask(l + 3), mask(l + 2), mask(l + 1), mask(l)));
+   }
+
+   constexpr auto nLanes = nGroups * width;
+   double feed[ChunkSteps * nLanes] = {}, ys[ChunkSteps * nLanes];
+   for (auto t0 = first; t0 < last; t0 += ChunkSteps)
+   {
+      const auto nSteps = std::min(ChunkSteps, last - t0);
+      Feed(lanes, nLanes, in, t0, nSteps, feed);
+      for (size_t ii = 0; ii < nSteps; ++ii)
+      {
+         const auto row = ii * nLanes;
+         __m256d rotated[nGroups], x[nGroups];
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+            rotated[g] = _mm256_permute4x64_pd(y1[g], _MM_SHUFFLE(2, 1, 0, 3));
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+         {
+            // Each lane takes the last output of the lane before it
+            const auto shifted =
+               _mm256_blend_pd(rotated[g], rotated[g ? g - 1 : 0], 1);
+            x[g] = _mm256_or_pd(_mm256_andnot_pd(takes[g], shifted),
+               _mm256_loadu_pd(feed + row + g * width));
+         }
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+         {
+            const auto partial = _mm256_sub_pd(
+               _mm256_add_pd(
+                  _mm256_mul_pd(b1[g], x1[g]), _mm256_mul_pd(b2[g], x2[g])),
+               _mm256_mul_pd(a2[g], y2[g]));
+            const auto y = _mm256_sub_pd(
+               _mm256_add_pd(_mm256_mul_pd(b0[g], x[g]), partial),
+               _mm256_mul_pd(a1[g], y1[g]));
+            x2[g] = x1[g], x1[g] = x[g], y2[g] = y1[g], y1[g] = y;
+            _mm256_storeu_pd(ys + row + g * width, y);
+         }
+      }
+      Drain(lanes, nLanes, ys, t0, nSteps, out);
+   }
+
+   UNROLL for (size_t g = 0; g < nGroups; ++g)
+   {
+      const auto l = g * width;
+      _mm256_storeu_pd(a[X1] + l, x1[g]), _mm256_storeu_pd(a[X2] + l, x2[g]),
+      _mm256_storeu_pd(a[Y1] + l, y1[g]), _mm256_storeu_pd(a[Y2] + l, y2[g]);
+   }
+}
+
+void RunAVX2(const Lanes& lanes, const float* const* in, float* const* out,
+   size_t first, size_t last)
+{
+   switch (lanes.nLanes / 4)
+   {
+   case 1: return RunAVX2Groups<1>(lanes, in, out, first, last);
+   case 2: return RunAVX2Groups<2>(lanes, in, out, first, last);
+   default: return RunScalar(lanes, in, out, first, last);
+   }
+}
+#endif
+
+#ifdef BIQUAD_NEON
+template<size_t nGroups>
+void RunNEONGroups(const Lanes& lanes, const float* const* in,
+   float* const* out, size_t first, size_t last)
+{
+   constexpr size_t width = 2;
+   const auto& a = lanes.arrays;
+   float64x2_t b0[nGroups], b1[nGroups], b2[nGroups], a1[nGroups],
+      a2[nGroups], x1[nGroups], x2[nGroups], y1[nGroups], y2[nGroups];
+   uint64x2_t takes[nGroups];
+   UNROLL for (size_t g = 0; g < nGroups; ++g)
+   {
+      const auto l = g * width;
+      b0[g] = vld1q_f64(a[B0] + l), b1[g] = vld1q_f64(a[B1] + l),
+      b2[g] = vld1q_f64(a[B2] + l), a1[g] = vld1q_f64(a[A1] + l),
+      a2[g] = vld1q_f64(a[A2] + l), x1[g] = vld1q_f64(a[X1] + l),
+      x2[g] = vld1q_f64(a[X2] + l), y1[g] = vld1q_f64(a[Y1] + l),
+      y2[g] = vld1q_f64(a[Y2] + l);
+      const uint64_t mask[] = {
+         lanes.TakesInput(l) ? ~uint64_t{} : 0,
+         lanes.TakesInput(l + 1) ? ~uint64_t{} : 0 };
+      takes[g] = vld1q_u64(mask);
+   }
+
+   constexpr auto nLanes = nGroups * width;
+   double feed[ChunkSteps * nLanes] = {}, ys[ChunkSteps * nLanes];
+   for (auto t0 = first; t0 < last; t0 += ChunkSteps)
+   {
+      const auto nSteps = std::min(ChunkSteps, last - t0);
+      Feed(lanes, nLanes, in, t0, nSteps, feed);
+      for (size_t ii = 0; ii < nSteps; ++ii)
+      {
+         const auto row = ii * nLanes;
+         float64x2_t x[nGroups];
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+         {
+            // Each lane takes the last output of the lane before it
+            const auto shifted = vextq_f64(y1[g ? g - 1 : 0], y1[g], 1);
+            x[g] = vbslq_f64(
+               takes[g], vld1q_f64(feed + row + g * width), shifted);
+         }
+         UNROLL for (size_t g = 0; g < nGroups; ++g)
+         {
+            // Separate multiplications and additions, not fused, as in the
+            // scalar kernels
+            const auto partial = vsubq_f64(
+               vaddq_f64(vmulq_f64(b1[g], x1[g]), vmulq_f64(b2[g], x2[g])),
+               vmulq_f64(a2[g], y2[g]));
+            const auto y = vsubq_f64(
+               vaddq_f64(vmulq_f64(b0[g], x[g]), partial),
+               vmulq_f64(a1[g], y1[g]));
+            x2[g] = x1[g], x1[g] = x[g], y2[g] = y1[g], y1[g] = y;
+            vst1q_f64(ys + row + g * width, y);
+         }
+      }
+      Drain(lanes, nLanes, ys, t0, nSteps, out);
+   }
+
+   UNROLL for (size_t g = 0; g < nGroups; ++g)
+   {
+      const auto l = g * width;
+      vst1q_f64(a[X1] + l, x1[g]), vst1q_f64(a[X2] + l, x2[g]),
+      vst1q_f64(a[Y1] + l, y1[g]), vst1q_f64(a[Y2] + l, y2[g]);
+   }
+}
+
+void RunNEON(const Lanes& lanes, const float* const* in, float* const* out,
+   size_t first, size_t last)
+{
+   switch (lanes.nLanes / 2)
+   {
+   case 2: return RunNEONGroups<2>(lanes, in, out, first, last);
+   case 4: return RunNEONGroups<4>(lanes, in, out, first, last);
+   default: return RunScalar(lanes, in, out, first, last);
+   }
+}
+#endif
+} // namespace
+
+struct BiquadCascade::Kernels final
+{
+   const char* name;
+   //! Steps from first to last, in which all sections are busy
+   void (*Run)(const Lanes& lanes, const float* const* in, float* const* out,
+      size_t first, size_t last);
+};
+
+namespace
+{
+const BiquadCascade::Kernels ScalarKernels{ "Scalar", RunScalar };
+#ifdef BIQUAD_SSE2
+const BiquadCascade::Kernels SSE2Kernels{ "SSE2", RunSSE2 };
+#endif
+#ifdef BIQUAD_AVX2
+const BiquadCascade::Kernels AVX2Kernels{ "AVX2", RunAVX2 };
+#endif
+#ifdef BIQUAD_NEON
+const BiquadCascade::Kernels NEONKernels{ "NEON", RunNEON };
+#endif
+} // namespace
+
+BiquadCascade::BiquadCascade() = default;
+
+BiquadCascade::BiquadCascade(
+   const Biquad* sections, size_t nSections, size_t nChannels)
+   : mNumSections{ nSections }
+   , mNumChannels{ nSections > 0 ? nChannels : 0 }
+{
+   if (mNumChannels == 0)
+      return;
+   // A channel with more sections than fit in the vectors is a batch alone,
+   // which the scalar kernels process
+   const auto channelsPerBatch = std::max<size_t>(1, MaxLanes / nSections);
+   for (size_t first = 0; first < mNumChannels; first += channelsPerBatch)
+   {
+      Batch batch;
+      batch.firstChannel = first;
+      batch.nChannels = std::min(channelsPerBatch, mNumChannels - first);
+      batch.nLanes = (batch.nChannels * nSections + MaxWidth - 1) / MaxWidth *
+                     MaxWidth;
+      batch.values.resize(nArrays * batch.nLanes);
+      mBatches.push_back(std::move(batch));
+   }
+   SetSections(sections);
+}
+
+void BiquadCascade::SetSections(const Biquad* sections)
+{
+   for (auto& batch : mBatches)
+   {
+      const Lanes lanes{ batch.values, batch.nLanes, mNumSections,
+                         batch.nChannels };
+      for (size_t channel = 0; channel < batch.nChannels; ++channel)
+         for (size_t section = 0; section < mNumSections; ++section)
+         {
+            const auto lane = channel * mNumSections + section;
+            const auto& biquad = sections[section];
+            lanes.arrays[B0][lane] = biquad.fNumerCoeffs[Biquad::B0];
+            lanes.arrays[B1][lane] = biquad.fNumerCoeffs[Biquad::B1];
+            lanes.arrays[B2][lane] = biquad.fNumerCoeffs[Biquad::B2];
+            lanes.arrays[A1][lane] = biquad.fDenomCoeffs[Biquad::A1];
+            lanes.arrays[A2][lane] = biquad.fDenomCoeffs[Biquad::A2];
+         }
+   }
+}
+
+void BiquadCascade::Reset()
+{
+   for (auto& batch : mBatches)
+      std::fill(batch.values.begin() + X1 * batch.nLanes, batch.values.end(),
+         0.0);
+}
+
+void BiquadCascade::Process(
+   const float* const* in, float* const* out, size_t len)
+{
+   Process(GetKernels(), in, out, len);
+}
+
+void BiquadCascade::Process(const Kernels& kernels,
+   const float* const* in, float* const* out, size_t len)
+{
+   if (len == 0)
+      return;
+   // Section s is busy from step s until step len + s - 1
+   const auto lag = mNumSections - 1;
+   for (auto& batch : mBatches)
+   {
+      const Lanes lanes{ batch.values, batch.nLanes, mNumSections,
+                         batch.nChannels };
+      const auto batchIn = in + batch.firstChannel;
+      const auto batchOut = out + batch.firstChannel;
+      for (size_t t = 0; t < lag; ++t)
+         StepScalar(lanes, batchIn, batchOut, t, len);
+      if (len > lag)
+         kernels.Run(lanes, batchIn, batchOut, lag, len);
+      for (auto t = std::max(lag, len); t < len + lag; ++t)
+         StepScalar(lanes, batchIn, batchOut, t, len);
+   }
+}
+
+const BiquadCascade::Kernels& BiquadCascade::GetKernels()
+{
+   static const auto& kernels = *GetSupportedKernels().back();
+   return kernels;
+}
+
+std::vector<const BiquadCascade::Kernels*> BiquadCascade::GetSupportedKernels()
+{
+   std::vector<const Kernels*> result { &ScalarKernels };
+#ifdef BIQUAD_SSE2
+   result.push_back(&SSE2Kernels);
+#endif
+#ifdef BIQUAD_AVX2
+   if (HasAVX2())
+      result.push_back(&AVX2Kernels);
+#endif
+#ifdef BIQUAD_NEON
+   result.push_back(&NEONKernels);
+#endif
+   return result;
+}
+
+const char* BiquadCascade::GetName(const Kernels& kernels)
+{
+   return kernels.name;
+}
@@ -0,0 +1,149 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+Biquad.h
+
+Norm C
+Max Maisel
+
+***********************************************************************/
+
+#ifndef __BIQUAD_H__
+#define __BIQUAD_H__
+
+#include "MemoryX.h"
+
+#include <vector>
+
+/// \brief Represents a biquad digital filter.
+struct MATH_API Biquad
+{
+   Biquad();
+   void Reset();
+   void Process(const float* pfIn, float* pfOut, int iNumSamples);
+
+   enum
+   {
+      /// Numerator coefficient indices
+      B0=0, B1, B2,
+      /// Denominator coefficient indices
+      A1=0, A2,
+
+      /// Possible filter orders for the Calc...Filter(...) functions
+      MIN_Order = 1,
+      MAX_Order = 10
+   };
+
+   inline float ProcessOne(float fIn)
+   {
+      // Biquad must use double for all calculations. Otherwise some
+      // filters may have catastrophic rounding errors!
+      double fOut = double(fIn) * fNumerCoeffs[B0] +
+            fPrevIn * fNumerCoeffs[B1] +
+            fPrevPrevIn * fNumerCoeffs[B2] -
+            fPrevOut * fDenomCoeffs[A1] -
+            fPrevPrevOut * fDenomCoeffs[A2];
+      fPrevPrevIn = fPrevIn;
+      fPrevIn = fIn;
+      fPrevPrevOut = fPrevOut;
+      fPrevOut = fOut;
+      return fOut;
+   }
+
+   double fNumerCoeffs[3]; // B0 B1 B2
+   double fDenomCoeffs[2]; // A1 A2, A0 == 1.0
+   double fPrevIn;
+   double fPrevPrevIn;
+   double fPrevOut;
+   double fPrevPrevOut;
+
+   enum kSubTypes
+   {
+      kLowPass,
+      kHighPass,
+      nSubTypes
+   };
+
+   static ArrayOf<Biquad> CalcButterworthFilter(int order, double fn, double fc, int type);
+   static ArrayOf<Biquad> CalcChebyshevType1Filter(int order, double fn, double fc, double ripple, int type);
+   static ArrayOf<Biquad> CalcChebyshevType2Filter(int order, double fn, double fc, double ripple, int type);
+
+   static void ComplexDiv (double fNumerR, double fNumerI, double fDenomR, double fDenomI,
+                           double* pfQuotientR, double* pfQuotientI);
+   static bool BilinTransform (double fSX, double fSY, double* pfZX, double* pfZY);
+   static float Calc2D_DistSqr (double fX1, double fY1, double fX2, double fY2);
+
+   static const double s_fChebyCoeffs[MAX_Order][MAX_Order + 1];
+   static double ChebyPoly(int Order, double NormFreq);
+};
+
+/// \brief Filters blocks of samples of one or more channels through the same
+/// cascade of biquads.
+/*!
+ Each section of each channel is a lane of a vector, and lanes filter one
+ sample each per step, every section lagging one sample behind the section
+ before it.  So a cascade of one channel is vectorized as well as several
+ channels with short cascades.
+
+ All state is double, also the signal between the sections, which
+ Biquad::Process rounds to float.  Results differ from a cascade of
+ Biquad::Process calls only by that rounding.
+ */
+class MATH_API BiquadCascade final
+{
+public:
+   //! Processing functions for one instruction set
+   struct Kernels;
+
+   //! Filters nothing
+   BiquadCascade();
+
+   //! Each channel gets a copy of the sections, with cleared state
+   BiquadCascade(const Biquad* sections, size_t nSections, size_t nChannels);
+
+   size_t GetNumSections() const { return mNumSections; }
+   size_t GetNumChannels() const { return mNumChannels; }
+
+   //! Changes the coefficients of all channels but keeps their state
+   //! @pre `sections` has GetNumSections() elements
+   void SetSections(const Biquad* sections);
+
+   //! Clears the state of all sections
+   void Reset();
+
+   //! Filters len samples of each channel; in and out may be the same
+   void Process(const float* const* in, float* const* out, size_t len);
+
+   //! Same, with the given kernels, for tests and benchmarks
+   void Process(const Kernels& kernels,
+      const float* const* in, float* const* out, size_t len);
+
+   //! The fastest kernels that the processor supports, found at the first
+   //! call
+   static const Kernels& GetKernels();
+
+   //! All kernel sets that the processor supports, the scalar ones first
+   static std::vector<const Kernels*> GetSupportedKernels();
+
+   static const char* GetName(const Kernels& kernels);
+
+private:
+   //! Whole channels whose sections fit together in a few vectors
+   struct Batch
+   {
+      size_t firstChannel;
+      size_t nChannels;
+      //! Count of lanes, rounded up to whole vectors
+      size_t nLanes;
+      //! Arrays of nLanes values each: coefficients B0 B1 B2 A1 A2, then
+      //! state X1 X2 Y1 Y2; extra lanes have zero coefficients
+      std::vector<double> values;
+   };
+
+   std::vector<Batch> mBatches;
+   size_t mNumSections{ 0 };
+   size_t mNumChannels{ 0 };
+};
+
+#endif
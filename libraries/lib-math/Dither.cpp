@@ -36,6 +36,7 @@ and get deterministic behaviour.
 
 
 #include "Dither.h"
+#include "SampleConversion.h"
 
 #include "Internat.h"
 #include "Prefs.h"
@@ -45,6 +46,8 @@ and get deterministic behaviour.
 // (Note: this file should be included first)
 #include "float_cast.h"
 
+#include <algorithm>
+#include <atomic>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
@@ -60,6 +63,9 @@ and get deterministic behaviour.
 constexpr int BUF_SIZE = 8;
 constexpr int BUF_MASK = 7;
 
+// Samples are converted in blocks of this size, in buffers on the stack
+constexpr size_t BLOCK_SIZE = 256;
+
 // Lipshitz's minimally audible FIR
 const float SHAPED_BS[] = { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f };
 
@@ -70,120 +76,182 @@ struct State {
     float mBuffer[8 /* = BUF_SIZE */];
 } mState;
 
-using Ditherer = float (*)(State &, float);
-
-// This is supposed to produce white noise and no dc
-static inline float DITHER_NOISE()
+// White noise with no dc.  Each thread has its own generator, seeded
+// differently.
+static SampleConversion::NoiseState &DitherNoise()
 {
-    return rand() / (float)RAND_MAX - 0.5f;
+    static std::atomic<uint32_t> seeds{ 1 };
+    static thread_local SampleConversion::NoiseState noise{ seeds++ };
+    return noise;
 }
 
 // Defines for sample conversion
 constexpr auto CONVERT_DIV16 = float(1<<15);
 constexpr auto CONVERT_DIV24 = float(1<<23);
 
-// Dereference sample pointer and convert to float sample
-static inline float FROM_INT16(const short *ptr)
+template<typename T>
+static inline void Gather(const T *src, size_t stride, T *dst, size_t len)
 {
-    return *ptr / CONVERT_DIV16;
+    for (size_t ii = 0; ii < len; ++ii, src += stride)
+        dst[ii] = *src;
 }
 
-static inline float FROM_INT24(const int *ptr)
+template<typename T>
+static inline void Scatter(const T *src, T *dst, size_t stride, size_t len)
 {
-    return *ptr / CONVERT_DIV24;
+    for (size_t ii = 0; ii < len; ++ii, dst += stride)
+        *dst = src[ii];
 }
 
-// For float, we internally allow values greater than 1.0, which
-// would blow up the dithering to int values.  FROM_FLOAT is
-// only used to dither to int, so clip here.
-static inline float FROM_FLOAT(const float *ptr)
-{
-    return *((float*)(ptr)) > 1.0
-        ?  1.0 :
-        *((float*)(ptr)) < -1.0
-            ? -1.0 :
-            *((float*)(ptr));
-}
-
-// Store float sample 'sample' into pointer 'ptr', clip it, if necessary
-template<typename dst_type>
-static inline void IMPLEMENT_STORE(
-    dst_type *ptr, float sample, dst_type min_bound, dst_type max_bound)
+// Convert with a kernel for contiguous buffers; interleaved samples are
+// gathered into blocks first, and scattered after
+template<typename srcType, typename dstType>
+static void CONVERT_LOOP(
+    void (*convert)(const srcType *, dstType *, size_t),
+    const srcType *src, size_t srcStride,
+    dstType *dst, size_t dstStride, size_t len)
 {
-    int x = lrintf(sample);
-    if (x > max_bound)
-        *ptr = max_bound;
-    else if (x<(min_bound))
-        *ptr = min_bound;
-    else
-        *ptr = static_cast<dst_type>(x);
+    if (srcStride == 1 && dstStride == 1) {
+        convert(src, dst, len);
+        return;
+    }
+    srcType srcBlock[BLOCK_SIZE];
+    dstType dstBlock[BLOCK_SIZE];
+    for (size_t done = 0; done < len; done += BLOCK_SIZE) {
+        const auto count = std::min(BLOCK_SIZE, len - done);
+        auto s = src + done * srcStride;
+        if (srcStride != 1)
+            Gather(s, srcStride, srcBlock, count), s = srcBlock;
+        const auto d = dstStride == 1 ? dst + done : dstBlock;
+        convert(s, d, count);
+        if (dstStride != 1)
+            Scatter(dstBlock, dst + done * dstStride, dstStride, count);
+    }
 }
 
-// Dither single float 'sample' and store it in pointer 'dst', using 'dither' as algorithm
-static inline void DITHER_TO_INT16(Ditherer dither, State &state,
-   short *dst, float sample)
+// Shaped dither of a block of samples, already scaled, which become the
+// values to round.  The error of each rounding is fed back, so this is serial.
+static inline void ShapedDither(State &state,
+    float *samples, const float *noise, size_t len)
 {
-    IMPLEMENT_STORE<short>(dst,
-        dither(state, sample * CONVERT_DIV16),
-        short(-32768), short(32767));
+    for (size_t ii = 0; ii < len; ++ii) {
+        // Generate triangular dither, +-1 LSB, flat psd
+        float r = noise[2 * ii] + noise[2 * ii + 1];
+        float sample = samples[ii];
+        if(sample != sample)  // test for NaN
+           sample = 0; // and do the best we can with it
+
+        // Run FIR
+        float xe = sample + state.mBuffer[state.mPhase] * SHAPED_BS[0]
+            + state.mBuffer[(state.mPhase - 1) & BUF_MASK] * SHAPED_BS[1]
+            + state.mBuffer[(state.mPhase - 2) & BUF_MASK] * SHAPED_BS[2]
+            + state.mBuffer[(state.mPhase - 3) & BUF_MASK] * SHAPED_BS[3]
+            + state.mBuffer[(state.mPhase - 4) & BUF_MASK] * SHAPED_BS[4];
+
+        // Accumulate FIR and triangular noise
+        float result = xe + r;
+
+        // Roll buffer and store last error
+        state.mPhase = (state.mPhase + 1) & BUF_MASK;
+        state.mBuffer[state.mPhase] = xe - lrintf(result);
+
+        samples[ii] = result;
+    }
 }
 
-// Dither single float 'sample' and store it in pointer 'dst', using 'dither' as algorithm
-static inline void DITHER_TO_INT24(Ditherer dither, State &state,
-   int *dst, float sample)
+// Implement a dithering loop, a block at a time:  load samples as float,
+// clipping float samples to [-1, 1]; make the dither noise; round with
+// clipping to the destination format
+template<typename dstType>
+static void DITHER_LOOP(DitherType ditherType, State &state,
+    void (*quantize)(const float *, const float *, float, dstType *, size_t),
+    float scale,
+    constSamplePtr src, sampleFormat srcFormat, size_t srcStride,
+    dstType *dst, size_t dstStride, size_t len)
 {
-    IMPLEMENT_STORE<int>(dst,
-        dither(state, sample * CONVERT_DIV24), -8388608, 8388607);
-}
-
-// Implement one single dither step
+    const auto &kernels = SampleConversion::GetKernels();
+    auto &generator = DitherNoise();
+
+    float samples[BLOCK_SIZE];
+    int intSamples[BLOCK_SIZE];
+    float noise[2 * BLOCK_SIZE];
+    float dither[BLOCK_SIZE];
+    dstType dstBlock[BLOCK_SIZE];
+
+    for (size_t done = 0; done < len; done += BLOCK_SIZE) {
+        const auto count = std::min(BLOCK_SIZE, len - done);
+
+        if (srcFormat == floatSample) {
+            auto s = reinterpret_cast<const float *>(src) + done * srcStride;
+            if (srcStride != 1)
+                Gather(s, srcStride, samples, count), s = samples;
+            kernels.ClipFloat(s, samples, count);
+        }
+        else {
+            auto s = reinterpret_cast<const int *>(src) + done * srcStride;
+            if (srcStride != 1)
+                Gather(s, srcStride, intSamples, count), s = intSamples;
+            kernels.Int24ToFloat(s, samples, count);
+        }
 
-// Implement a dithering loop
-template<typename srcType, typename dstType>
-static inline void DITHER_LOOP( Ditherer dither, State &state,
-    void (*store)(Ditherer, State &, dstType *, float),
-    float (*load)(const srcType *),
-    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
-    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
-{
-    char *d;
-    const char *s;
-    unsigned int ii;
-    for (d = (char*)dst, s = (char*)src, ii = 0;
-        ii < len;
-        ii++, d += SAMPLE_SIZE(dstFormat) * dstStride,
-        s += SAMPLE_SIZE(srcFormat) * srcStride) {
-            store(dither, state, reinterpret_cast<dstType *>(d), load(reinterpret_cast<const srcType *>(s)));
+        const float *pDither = nullptr;
+        auto quantizeScale = scale;
+        switch (ditherType) {
+        case DitherType::none:
+            break;
+        case DitherType::rectangle:
+            // Apply one-step noise
+            kernels.Noise(generator, dither, count);
+            pDither = dither;
+            break;
+        case DitherType::triangle:
+            // High pass filtered:  differences of successive noise values
+            noise[0] = state.mTriangleState;
+            kernels.Noise(generator, noise + 1, count);
+            for (size_t ii = 0; ii < count; ++ii)
+                dither[ii] = noise[ii + 1] - noise[ii];
+            state.mTriangleState = noise[count];
+            pDither = dither;
+            break;
+        case DitherType::shaped:
+            kernels.Noise(generator, noise, 2 * count);
+            for (size_t ii = 0; ii < count; ++ii)
+                samples[ii] *= scale;
+            ShapedDither(state, samples, noise, count);
+            quantizeScale = 1.0f;
+            break;
+        default:
+            wxASSERT(false); // unknown dither algorithm
         }
+
+        const auto d = dstStride == 1 ? dst + done : dstBlock;
+        quantize(samples, pDither, quantizeScale, d, count);
+        if (dstStride != 1)
+            Scatter(dstBlock, dst + done * dstStride, dstStride, count);
+    }
 }
 
 // Implement a dither. There are only 3 cases where we must dither,
 // in all other cases, no dithering is necessary.
-static inline void DITHER( Ditherer dither, State &state,
+static inline void DITHER(DitherType ditherType, State &state,
    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
 {
-    if (srcFormat == int24Sample && dstFormat == int16Sample)
-        DITHER_LOOP<int, short>(dither, state,
-            DITHER_TO_INT16, FROM_INT24, dst,
-            int16Sample, dstStride, src, int24Sample, srcStride, len);
-    else if (srcFormat == floatSample && dstFormat == int16Sample)
-        DITHER_LOOP<float, short>(dither, state,
-            DITHER_TO_INT16, FROM_FLOAT, dst,
-            int16Sample, dstStride, src, floatSample, srcStride, len);
+    const auto &kernels = SampleConversion::GetKernels();
+    if ((srcFormat == int24Sample || srcFormat == floatSample) &&
+        dstFormat == int16Sample)
+        DITHER_LOOP<short>(ditherType, state,
+            kernels.QuantizeToInt16, CONVERT_DIV16,
+            src, srcFormat, srcStride,
+            reinterpret_cast<short *>(dst), dstStride, len);
     else if (srcFormat == floatSample && dstFormat == int24Sample)
-        DITHER_LOOP<float, int>(dither, state,
-            DITHER_TO_INT24, FROM_FLOAT, dst,
-            int24Sample, dstStride, src, floatSample, srcStride, len);
+        DITHER_LOOP<int>(ditherType, state,
+            kernels.QuantizeToInt24, CONVERT_DIV24,
+            src, srcFormat, srcStride,
+            reinterpret_cast<int *>(dst), dstStride, len);
     else { wxASSERT(false); }
 }
 
-
-static inline float NoDither(State &, float sample);
-static inline float RectangleDither(State &, float sample);
-static inline float TriangleDither(State &state, float sample);
-static inline float ShapedDither(State &state, float sample);
-
 Dither::Dither()
 {
     // On startup, initialize dither by resetting values
@@ -236,6 +304,8 @@ void Dither::Apply(enum DitherType ditherType,
     if (len == 0)
         return; // nothing to do
 
+    const auto &kernels = SampleConversion::GetKernels();
+
     if (destFormat == sourceFormat)
     {
         // No need to dither, because source and destination
@@ -279,45 +349,34 @@ void Dither::Apply(enum DitherType ditherType,
         auto d = (float*)dest;
 
         if (sourceFormat == int16Sample)
-        {
-            auto s = (const short*)source;
-            for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-                *d = FROM_INT16(s);
-        } else
+            CONVERT_LOOP(kernels.Int16ToFloat, (const short*)source,
+                sourceStride, d, destStride, len);
+        else
         if (sourceFormat == int24Sample)
-        {
-            auto s = (const int*)source;
-            for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-                *d = FROM_INT24(s);
-        } else {
+            CONVERT_LOOP(kernels.Int24ToFloat, (const int*)source,
+                sourceStride, d, destStride, len);
+        else {
             wxASSERT(false); // source format unknown
         }
     } else
     if (destFormat == int24Sample && sourceFormat == int16Sample)
     {
         // Special case when promoting 16 bit to 24 bit
-        auto d = (int*)dest;
-        auto s = (const short*)source;
-        for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-            *d = ((int)*s) << 8;
+        CONVERT_LOOP(kernels.Int16ToInt24, (const short*)source,
+            sourceStride, (int*)dest, destStride, len);
     } else
     {
         // We must do dithering
         switch (ditherType)
         {
         case DitherType::none:
-            DITHER(NoDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
-            break;
         case DitherType::rectangle:
-            DITHER(RectangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER(ditherType, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::triangle:
-            Reset(); // reset dither filter for this NEW conversion
-            DITHER(TriangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
-            break;
         case DitherType::shaped:
             Reset(); // reset dither filter for this NEW conversion
-            DITHER(ShapedDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER(ditherType, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         default:
             wxASSERT(false); // unknown dither algorithm
@@ -325,55 +384,6 @@ void Dither::Apply(enum DitherType ditherType,
     }
 }
 
-// Dither implementations
-
-// No dither, just return sample
-inline float NoDither(State &, float sample)
-{
-    return sample;
-}
-
-// Rectangle dithering, apply one-step noise
-inline float RectangleDither(State &, float sample)
-{
-    return sample - DITHER_NOISE();
-}
-
-// Triangle dither - high pass filtered
-inline float TriangleDither(State &state, float sample)
-{
-    float r = DITHER_NOISE();
-    float result = sample + r - state.mTriangleState;
-    state.mTriangleState = r;
-
-    return result;
-}
-
-// Shaped dither
-inline float ShapedDither(State &state, float sample)
-{
-    // Generate triangular dither, +-1 LSB, flat psd
-    float r = DITHER_NOISE() + DITHER_NOISE();
-    if(sample != sample)  // test for NaN
-       sample = 0; // and do the best we can with it
-
-    // Run FIR
-    float xe = sample + state.mBuffer[state.mPhase] * SHAPED_BS[0]
-        + state.mBuffer[(state.mPhase - 1) & BUF_MASK] * SHAPED_BS[1]
-        + state.mBuffer[(state.mPhase - 2) & BUF_MASK] * SHAPED_BS[2]
-        + state.mBuffer[(state.mPhase - 3) & BUF_MASK] * SHAPED_BS[3]
-        + state.mBuffer[(state.mPhase - 4) & BUF_MASK] * SHAPED_BS[4];
-
-    // Accumulate FIR and triangular noise
-    float result = xe + r;
-
-    // Roll buffer and store last error
-    state.mPhase = (state.mPhase + 1) & BUF_MASK;
-    state.mBuffer[state.mPhase] = xe - lrintf(result);
-
-    return result;
-}
-
 static const std::initializer_list<EnumValueSymbol> choicesDither{
    { XO("None") },
    { XO("Rectangle") },
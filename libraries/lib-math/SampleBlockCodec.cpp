@@ -0,0 +1,592 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleBlockCodec.cpp
+
+**********************************************************************/
+#include "SampleBlockCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace SampleBlockCodec
+{
+namespace
+{
+// Sample values are handled as unsigned 32 bit words, and all arithmetic on
+// them wraps, so that any bit pattern, even a NaN, survives the round trip
+uint32_t ToWord(constSamplePtr src, size_t i, sampleFormat format)
+{
+   switch (format)
+   {
+   case int16Sample:
+      return static_cast<uint32_t>(
+         static_cast<int32_t>(reinterpret_cast<const int16_t*>(src)[i]));
+   case floatSample:
+   {
+      // Map the bits of floats to integers of the same ordering, so that
+      // neighbouring values of either sign are close
+      uint32_t bits;
+      memcpy(&bits, src + i * sizeof(bits), sizeof(bits));
+      return (bits & 0x80000000u) ? bits ^ 0x7FFFFFFFu : bits;
+   }
+   default:
+      // 24 bit samples are held in 32 bit ints
+      return reinterpret_cast<const uint32_t*>(src)[i];
+   }
+}
+
+void FromWord(uint32_t word, samplePtr dest, size_t i, sampleFormat format)
+{
+   switch (format)
+   {
+   case int16Sample:
+      reinterpret_cast<int16_t*>(dest)[i] = static_cast<int16_t>(word);
+      break;
+   case floatSample:
+   {
+      const uint32_t bits =
+         (word & 0x80000000u) ? word ^ 0x7FFFFFFFu : word;
+      memcpy(dest + i * sizeof(bits), &bits, sizeof(bits));
+      break;
+   }
+   default:
+      reinterpret_cast<uint32_t*>(dest)[i] = word;
+      break;
+   }
+}
+
+unsigned CountTrailingZeros(uint64_t value)
+{
+#ifdef _MSC_VER
+   unsigned long index;
+   return _BitScanForward64(&index, value) ? index : 64;
+#else
+   return value ? __builtin_ctzll(value) : 64;
+#endif
+}
+
+//! Least significant bits are written first
+class BitWriter final
+{
+public:
+   explicit BitWriter(std::vector<uint8_t>& out)
+       : mOut { out }
+   {
+   }
+
+   //! @pre `bits <= 32` and `value < 2^bits`
+   void Put(uint32_t value, unsigned bits)
+   {
+      mAcc |= static_cast<uint64_t>(value) << mBits;
+      mBits += bits;
+      while (mBits >= 8)
+      {
+         mOut.push_back(static_cast<uint8_t>(mAcc));
+         mAcc >>= 8;
+         mBits -= 8;
+      }
+   }
+
+   void Finish()
+   {
+      if (mBits > 0)
+         mOut.push_back(static_cast<uint8_t>(mAcc));
+      mAcc = 0;
+      mBits = 0;
+   }
+
+private:
+   std::vector<uint8_t>& mOut;
+   uint64_t mAcc = 0;
+   unsigned mBits = 0;
+};
+
+//! Reads zeroes past the end, but remembers that it did
+class BitReader final
+{
+public:
+   BitReader(const uint8_t* begin, size_t size)
+       : mPos { begin }
+       , mEnd { begin + size }
+       , mAvailable { size * 8 }
+   {
+   }
+
+   //! @pre `bits <= 32`
+   uint32_t Get(unsigned bits)
+   {
+      Refill();
+      const auto result = static_cast<uint32_t>(
+         mAcc & ((uint64_t { 1 } << bits) - 1));
+      Consume(bits);
+      return result;
+   }
+
+   //! Count zeroes up to and including a one, or fail after `limit` zeroes
+   /*! @return the count of zeroes, or `limit + 1` for failure */
+   unsigned GetUnary(unsigned limit)
+   {
+      Refill();
+      const auto zeroes = std::min(CountTrailingZeros(mAcc), limit + 1);
+      if (zeroes <= limit)
+         Consume(zeroes + 1);
+      return zeroes;
+   }
+
+   bool Overrun() const
+   {
+      return mConsumed > mAvailable;
+   }
+
+private:
+   //! Guarantee at least 57 bits in the accumulator
+   void Refill()
+   {
+      while (mBits <= 56)
+      {
+         const uint64_t byte = mPos < mEnd ? *mPos++ : 0;
+         mAcc |= byte << mBits;
+         mBits += 8;
+      }
+   }
+
+   void Consume(unsigned bits)
+   {
+      mAcc >>= bits;
+      mBits -= bits;
+      mConsumed += bits;
+   }
+
+   const uint8_t* mPos;
+   const uint8_t* const mEnd;
+   const size_t mAvailable;
+   size_t mConsumed = 0;
+   uint64_t mAcc = 0;
+   unsigned mBits = 0;
+};
+
+// Lossless: a choice among fixed polynomial predictors for each frame, as in
+// FLAC, and residuals Rice coded with a parameter for each frame.
+// Float samples that were converted from integers, as when importing 16 or
+// 24 bit files, are coded as those integers.  Low bits that are zero in all
+// samples of a frame are not coded.
+
+constexpr size_t FrameSize = 4096;
+constexpr unsigned MaxOrder = 3;
+constexpr unsigned OrderBits = 2;
+constexpr unsigned RiceBits = 5;
+constexpr unsigned ShiftBits = 5;
+//! Longer unary prefixes are escaped to a raw 32 bit residual
+constexpr unsigned EscapeLength = 24;
+
+//! Scale of float samples that are multiples of the 24 bit quantum
+constexpr float IntegerScale = 8388608.f;
+
+struct History final
+{
+   uint32_t a = 0, b = 0, c = 0;
+
+   uint32_t Predict(unsigned order) const
+   {
+      switch (order)
+      {
+      case 0:
+         return 0;
+      case 1:
+         return a;
+      case 2:
+         return 2 * a - b;
+      default:
+         return 3 * a - 3 * b + c;
+      }
+   }
+
+   void Push(uint32_t word)
+   {
+      c = b;
+      b = a;
+      a = word;
+   }
+};
+
+uint32_t ZigZag(uint32_t residual)
+{
+   return (residual << 1) ^ (0u - (residual >> 31));
+}
+
+uint32_t UnZigZag(uint32_t value)
+{
+   return (value >> 1) ^ (0u - (value & 1));
+}
+
+//! @return whether all the floats are multiples of 2^-23 in [-1, 1], and
+//! then replace `words` with those multiples
+bool FloatsToIntegers(const float* src, size_t len, uint32_t* words)
+{
+   for (size_t i = 0; i < len; ++i)
+   {
+      const auto scaled = src[i] * IntegerScale;
+      // This test also fails for NaN
+      if (!(std::abs(scaled) <= IntegerScale))
+         return false;
+      const auto integer = static_cast<int32_t>(scaled);
+      // Compare bits, so that -0 is not mistaken for 0
+      const float restored = integer / IntegerScale;
+      if (memcmp(&restored, src + i, sizeof(float)) != 0)
+         return false;
+      words[i] = static_cast<uint32_t>(integer);
+   }
+   return true;
+}
+
+std::vector<uint8_t> EncodeLossless(
+   constSamplePtr src, size_t numsamples, sampleFormat format)
+{
+   std::vector<uint8_t> result;
+   result.reserve(numsamples * SAMPLE_SIZE(format) / 2);
+   BitWriter writer { result };
+
+   std::vector<uint32_t> words(std::min(numsamples, FrameSize));
+   History history;
+   for (size_t start = 0; start < numsamples; start += FrameSize)
+   {
+      const auto len = std::min(FrameSize, numsamples - start);
+
+      bool integers = false;
+      if (format == floatSample)
+         integers = FloatsToIntegers(
+            reinterpret_cast<const float*>(src) + start, len, words.data());
+      if (!integers)
+         for (size_t i = 0; i < len; ++i)
+            words[i] = ToWord(src, start + i, format);
+
+      uint32_t all = 0;
+      for (size_t i = 0; i < len; ++i)
+         all |= words[i];
+      const auto shift = all ? std::min(CountTrailingZeros(all), 31u) : 0;
+      if (shift > 0)
+         for (size_t i = 0; i < len; ++i)
+            words[i] = static_cast<uint32_t>(
+               static_cast<int32_t>(words[i]) >> shift);
+
+      // Choose the order with the least total magnitude of residuals
+      uint64_t sums[MaxOrder + 1] {};
+      {
+         auto h = history;
+         for (size_t i = 0; i < len; ++i)
+         {
+            for (unsigned order = 0; order <= MaxOrder; ++order)
+               sums[order] += ZigZag(words[i] - h.Predict(order));
+            h.Push(words[i]);
+         }
+      }
+      const auto order = static_cast<unsigned>(
+         std::min_element(sums, sums + MaxOrder + 1) - sums);
+
+      // Choose the Rice parameter near the log of the mean
+      unsigned k = 0;
+      while (k < 31 && (static_cast<uint64_t>(len) << k) < sums[order])
+         ++k;
+
+      writer.Put(integers, 1);
+      writer.Put(shift, ShiftBits);
+      writer.Put(order, OrderBits);
+      writer.Put(k, RiceBits);
+      for (size_t i = 0; i < len; ++i)
+      {
+         const auto value = ZigZag(words[i] - history.Predict(order));
+         history.Push(words[i]);
+         const auto quotient = value >> k;
+         if (quotient < EscapeLength)
+         {
+            writer.Put(0, quotient);
+            writer.Put(1, 1);
+            if (k > 0)
+               writer.Put(value & ((1u << k) - 1), k);
+         }
+         else
+         {
+            writer.Put(0, EscapeLength);
+            writer.Put(1, 1);
+            writer.Put(value, 32);
+         }
+      }
+   }
+   writer.Finish();
+   return result;
+}
+
+bool DecodeLossless(const uint8_t* src, size_t srcbytes, samplePtr dest,
+   size_t numsamples, sampleFormat format)
+{
+   BitReader reader { src, srcbytes };
+   History history;
+   for (size_t start = 0; start < numsamples; start += FrameSize)
+   {
+      const auto len = std::min(FrameSize, numsamples - start);
+      const bool integers = reader.Get(1);
+      const auto shift = reader.Get(ShiftBits);
+      const auto order = reader.Get(OrderBits);
+      const auto k = reader.Get(RiceBits);
+      if (order > MaxOrder || (integers && format != floatSample))
+         return false;
+      for (size_t i = 0; i < len; ++i)
+      {
+         const auto quotient = reader.GetUnary(EscapeLength);
+         uint32_t value;
+         if (quotient < EscapeLength)
+            value = (quotient << k) | (k > 0 ? reader.Get(k) : 0);
+         else if (quotient == EscapeLength)
+            value = reader.Get(32);
+         else
+            return false;
+         const auto word = history.Predict(order) + UnZigZag(value);
+         history.Push(word);
+         const auto shifted = word << shift;
+         if (integers)
+            reinterpret_cast<float*>(dest)[start + i] =
+               static_cast<int32_t>(shifted) / IntegerScale;
+         else
+            FromWord(shifted, dest, start + i, format);
+      }
+      if (reader.Overrun())
+         return false;
+   }
+   return true;
+}
+
+// LZ4: the block format of https://github.com/lz4/lz4, applied after
+// grouping the bytes of samples by significance, so that the slowly changing
+// high bytes make long matches
+
+constexpr size_t MinMatch = 4;
+constexpr size_t LastLiterals = 5;
+constexpr size_t MatchFindLimit = 12;
+constexpr unsigned HashLog = 16;
+constexpr size_t MaxOffset = 65535;
+constexpr uint32_t NoPosition = ~uint32_t {};
+
+uint32_t Read32(const uint8_t* p)
+{
+   uint32_t result;
+   memcpy(&result, p, sizeof(result));
+   return result;
+}
+
+void PutLength(std::vector<uint8_t>& out, size_t length)
+{
+   for (; length >= 255; length -= 255)
+      out.push_back(255);
+   out.push_back(static_cast<uint8_t>(length));
+}
+
+void PutSequence(std::vector<uint8_t>& out, const uint8_t* literals,
+   size_t nLiterals, size_t offset, size_t matchLength)
+{
+   const auto extraMatch = matchLength - MinMatch;
+   out.push_back(static_cast<uint8_t>(
+      (std::min<size_t>(nLiterals, 15) << 4) |
+      std::min<size_t>(extraMatch, 15)));
+   if (nLiterals >= 15)
+      PutLength(out, nLiterals - 15);
+   out.insert(out.end(), literals, literals + nLiterals);
+   out.push_back(static_cast<uint8_t>(offset));
+   out.push_back(static_cast<uint8_t>(offset >> 8));
+   if (extraMatch >= 15)
+      PutLength(out, extraMatch - 15);
+}
+
+void PutLastLiterals(
+   std::vector<uint8_t>& out, const uint8_t* literals, size_t nLiterals)
+{
+   out.push_back(static_cast<uint8_t>(std::min<size_t>(nLiterals, 15) << 4));
+   if (nLiterals >= 15)
+      PutLength(out, nLiterals - 15);
+   out.insert(out.end(), literals, literals + nLiterals);
+}
+
+std::vector<uint8_t> CompressLZ4(const uint8_t* src, size_t size)
+{
+   std::vector<uint8_t> result;
+   result.reserve(size / 2);
+
+   size_t anchor = 0;
+   if (size > MatchFindLimit)
+   {
+      std::vector<uint32_t> table(size_t { 1 } << HashLog, NoPosition);
+      const auto hash = [](uint32_t sequence) {
+         return (sequence * 2654435761u) >> (32 - HashLog);
+      };
+      const auto matchLimit = size - LastLiterals;
+      size_t pos = 0;
+      while (pos + MatchFindLimit < size)
+      {
+         const auto sequence = Read32(src + pos);
+         auto& entry = table[hash(sequence)];
+         const auto candidate = entry;
+         entry = static_cast<uint32_t>(pos);
+         if (
+            candidate == NoPosition || pos - candidate > MaxOffset ||
+            Read32(src + candidate) != sequence)
+         {
+            // Skip faster through incompressible stretches
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+         }
+
+         auto length = MinMatch;
+         while (pos + length < matchLimit &&
+                src[candidate + length] == src[pos + length])
+            ++length;
+
+         PutSequence(
+            result, src + anchor, pos - anchor, pos - candidate, length);
+         pos += length;
+         anchor = pos;
+      }
+   }
+   PutLastLiterals(result, src + anchor, size - anchor);
+   return result;
+}
+
+bool GetLength(const uint8_t*& pos, const uint8_t* end, size_t& length)
+{
+   uint8_t byte;
+   do
+   {
+      if (pos == end)
+         return false;
+      byte = *pos++;
+      length += byte;
+   } while (byte == 255);
+   return true;
+}
+
+bool DecompressLZ4(
+   const uint8_t* src, size_t srcbytes, uint8_t* dest, size_t size)
+{
+   const auto end = src + srcbytes;
+   size_t out = 0;
+   while (src < end)
+   {
+      const auto token = *src++;
+
+      size_t nLiterals = token >> 4;
+      if (nLiterals == 15 && !GetLength(src, end, nLiterals))
+         return false;
+      if (nLiterals > static_cast<size_t>(end - src) ||
+          nLiterals > size - out)
+         return false;
+      memcpy(dest + out, src, nLiterals);
+      src += nLiterals;
+      out += nLiterals;
+
+      // The last sequence has no match
+      if (src == end)
+         break;
+
+      if (end - src < 2)
+         return false;
+      const size_t offset = src[0] | (src[1] << 8);
+      src += 2;
+      if (offset == 0 || offset > out)
+         return false;
+
+      size_t length = token & 15;
+      if (length == 15 && !GetLength(src, end, length))
+         return false;
+      length += MinMatch;
+      if (length > size - out)
+         return false;
+
+      const auto from = dest + out - offset;
+      if (offset >= length)
+         memcpy(dest + out, from, length);
+      else
+         // Overlapping copy repeats a pattern
+         for (size_t i = 0; i < length; ++i)
+            dest[out + i] = from[i];
+      out += length;
+   }
+   return out == size;
+}
+
+std::vector<uint8_t> EncodeLZ4(
+   constSamplePtr src, size_t numsamples, sampleFormat format)
+{
+   const size_t sampleSize = SAMPLE_SIZE(format);
+   std::vector<uint8_t> shuffled(numsamples * sampleSize);
+   for (size_t byte = 0; byte < sampleSize; ++byte)
+   {
+      auto plane = shuffled.data() + byte * numsamples;
+      for (size_t i = 0; i < numsamples; ++i)
+         plane[i] = src[i * sampleSize + byte];
+   }
+   return CompressLZ4(shuffled.data(), shuffled.size());
+}
+
+bool DecodeLZ4(const uint8_t* src, size_t srcbytes, samplePtr dest,
+   size_t numsamples, sampleFormat format)
+{
+   const size_t sampleSize = SAMPLE_SIZE(format);
+   std::vector<uint8_t> shuffled(numsamples * sampleSize);
+   if (!DecompressLZ4(src, srcbytes, shuffled.data(), shuffled.size()))
+      return false;
+   for (size_t byte = 0; byte < sampleSize; ++byte)
+   {
+      const auto plane = shuffled.data() + byte * numsamples;
+      for (size_t i = 0; i < numsamples; ++i)
+         dest[i * sampleSize + byte] = plane[i];
+   }
+   return true;
+}
+} // namespace
+
+std::vector<uint8_t> Encode(
+   Codec codec, constSamplePtr src, size_t numsamples, sampleFormat format)
+{
+   std::vector<uint8_t> result;
+   switch (codec)
+   {
+   case Codec::Lossless:
+      result = EncodeLossless(src, numsamples, format);
+      break;
+   case Codec::LZ4:
+      result = EncodeLZ4(src, numsamples, format);
+      break;
+   default:
+      return {};
+   }
+   if (result.size() >= numsamples * SAMPLE_SIZE(format))
+      return {};
+   return result;
+}
+
+bool Decode(Codec codec, const void* src, size_t srcbytes, samplePtr dest,
+   size_t numsamples, sampleFormat format)
+{
+   const auto bytes = static_cast<const uint8_t*>(src);
+   switch (codec)
+   {
+   case Codec::None:
+      if (srcbytes != numsamples * SAMPLE_SIZE(format))
+         return false;
+      memcpy(dest, src, srcbytes);
+      return true;
+   case Codec::Lossless:
+      return DecodeLossless(bytes, srcbytes, dest, numsamples, format);
+   case Codec::LZ4:
+      return DecodeLZ4(bytes, srcbytes, dest, numsamples, format);
+   default:
+      return false;
+   }
+}
+} // namespace SampleBlockCodec
@@ -0,0 +1,49 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleBlockCodec.h
+
+  @brief Lossless compression of the samples of one block
+
+**********************************************************************/
+#pragma once
+
+#include "SampleFormat.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace SampleBlockCodec
+{
+//! Identifies the encoding of stored samples
+/*! These values persist in saved project files, so must not be changed in
+ later program versions */
+enum class Codec : unsigned
+{
+   //! Samples are stored as they are in memory
+   None = 0,
+   //! Fixed linear prediction per frame, with Rice coded residuals
+   Lossless = 1,
+   //! Bytes regrouped by significance, then LZ4 block compression; faster
+   //! than Lossless but compresses less
+   LZ4 = 2,
+
+   nCodecs
+};
+
+//! Compress `numsamples` samples of format `format`
+/*!
+ @return the encoded bytes, or an empty vector if `codec` is None, or if the
+ encoding would not be smaller than the samples, which then should be stored
+ unencoded
+ */
+MATH_API std::vector<uint8_t> Encode(
+   Codec codec, constSamplePtr src, size_t numsamples, sampleFormat format);
+
+//! Reverse Encode, writing exactly `numsamples` samples to `dest`
+/*! @return false if the encoded bytes are malformed */
+MATH_API bool Decode(Codec codec, const void* src, size_t srcbytes,
+   samplePtr dest, size_t numsamples, sampleFormat format);
+} // namespace SampleBlockCodec
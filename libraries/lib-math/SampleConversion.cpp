@@ -0,0 +1,604 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.cpp
+
+**********************************************************************/
+#include "SampleConversion.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "float_cast.h"
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLE_CONVERSION_SSE2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SAMPLE_CONVERSION_AVX2
+#define AVX2_TARGET
+#elif defined(__GNUC__)
+#define SAMPLE_CONVERSION_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(__arm64__) || defined(_M_ARM64)
+#define SAMPLE_CONVERSION_NEON
+#include <arm_neon.h>
+#endif
+
+namespace SampleConversion
+{
+namespace
+{
+constexpr float Int16Scale = 1.0f / (1 << 15);
+constexpr float Int24Scale = 1.0f / (1 << 23);
+constexpr float Int16Min = -32768.0f, Int16Max = 32767.0f;
+constexpr float Int24Min = -8388608.0f, Int24Max = 8388607.0f;
+
+// Bounds are whole numbers, so clamping before rounding is the same as
+// clamping after.  NaN becomes the lower bound, as in the vector kernels.
+inline float Clamp(float x, float lo, float hi)
+{
+   return x > hi ? hi : !(x >= lo) ? lo : x;
+}
+
+inline uint32_t Step(uint32_t x)
+{
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   return x;
+}
+
+//! Mantissa bits make a float in [1, 2), then centered
+inline float ToNoise(uint32_t x)
+{
+   const uint32_t bits = (x >> 9) | 0x3f800000u;
+   float result;
+   memcpy(&result, &bits, sizeof result);
+   return result - 1.5f;
+}
+
+// Scalar kernels, also used for the tails of the vector kernels
+
+void Int16ToFloatScalar(const int16_t* src, float* dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = src[i] * Int16Scale;
+}
+
+void Int24ToFloatScalar(const int32_t* src, float* dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = src[i] * Int24Scale;
+}
+
+void Int16ToInt24Scalar(const int16_t* src, int32_t* dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = static_cast<int32_t>(src[i]) * 256;
+}
+
+void ClipFloatScalar(const float* src, float* dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = Clamp(src[i], -1.0f, 1.0f);
+}
+
+void QuantizeToInt16Scalar(
+   const float* src, const float* noise, float scale, int16_t* dst,
+   size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+   {
+      const auto x = src[i] * scale + (noise ? noise[i] : 0.0f);
+      dst[i] = static_cast<int16_t>(lrintf(Clamp(x, Int16Min, Int16Max)));
+   }
+}
+
+void QuantizeToInt24Scalar(
+   const float* src, const float* noise, float scale, int32_t* dst,
+   size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+   {
+      const auto x = src[i] * scale + (noise ? noise[i] : 0.0f);
+      dst[i] = static_cast<int32_t>(lrintf(Clamp(x, Int24Min, Int24Max)));
+   }
+}
+
+void NoiseScalar(NoiseState& state, float* dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+   {
+      auto& lane = state.lanes[i % NoiseState::nLanes];
+      lane = Step(lane);
+      dst[i] = ToNoise(lane);
+   }
+}
+
+const Kernels ScalarKernels {
+   "Scalar",
+   Int16ToFloatScalar,
+   Int24ToFloatScalar,
+   Int16ToInt24Scalar,
+   ClipFloatScalar,
+   QuantizeToInt16Scalar,
+   QuantizeToInt24Scalar,
+   NoiseScalar,
+};
+
+#ifdef SAMPLE_CONVERSION_SSE2
+void Int16ToFloatSSE2(const int16_t* src, float* dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(Int16Scale);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x =
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      // Sign extend by shifting down from the high halves
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+   }
+   Int16ToFloatScalar(src + i, dst + i, len - i);
+}
+
+void Int24ToFloatSSE2(const int32_t* src, float* dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(Int24Scale);
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+   {
+      const auto x =
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+   }
+   Int24ToFloatScalar(src + i, dst + i, len - i);
+}
+
+void Int16ToInt24SSE2(const int16_t* src, int32_t* dst, size_t len)
+{
+   const auto zero = _mm_setzero_si128();
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x =
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      // Samples in the high halves, shifted down by 8 with sign
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(zero, x), 8);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(zero, x), 8);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), hi);
+   }
+   Int16ToInt24Scalar(src + i, dst + i, len - i);
+}
+
+// max_ps returns its second operand if either is NaN
+inline __m128 ClampSSE2(__m128 x, __m128 lo, __m128 hi)
+{
+   return _mm_min_ps(_mm_max_ps(x, lo), hi);
+}
+
+void ClipFloatSSE2(const float* src, float* dst, size_t len)
+{
+   const auto lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+      _mm_storeu_ps(dst + i, ClampSSE2(_mm_loadu_ps(src + i), lo, hi));
+   ClipFloatScalar(src + i, dst + i, len - i);
+}
+
+//! Rounds by the current mode, which is to nearest, as lrintf does
+inline __m128i QuantizeSSE2(
+   const float* src, const float* noise, __m128 scale, __m128 lo, __m128 hi)
+{
+   auto x = _mm_mul_ps(_mm_loadu_ps(src), scale);
+   if (noise)
+      x = _mm_add_ps(x, _mm_loadu_ps(noise));
+   return _mm_cvtps_epi32(ClampSSE2(x, lo, hi));
+}
+
+void QuantizeToInt16SSE2(
+   const float* src, const float* noise, float scale, int16_t* dst,
+   size_t len)
+{
+   const auto vScale = _mm_set1_ps(scale);
+   const auto lo = _mm_set1_ps(Int16Min), hi = _mm_set1_ps(Int16Max);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto a =
+         QuantizeSSE2(src + i, noise ? noise + i : nullptr, vScale, lo, hi);
+      const auto b = QuantizeSSE2(
+         src + i + 4, noise ? noise + i + 4 : nullptr, vScale, lo, hi);
+      _mm_storeu_si128(
+         reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+   }
+   QuantizeToInt16Scalar(
+      src + i, noise ? noise + i : nullptr, scale, dst + i, len - i);
+}
+
+void QuantizeToInt24SSE2(
+   const float* src, const float* noise, float scale, int32_t* dst,
+   size_t len)
+{
+   const auto vScale = _mm_set1_ps(scale);
+   const auto lo = _mm_set1_ps(Int24Min), hi = _mm_set1_ps(Int24Max);
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+      _mm_storeu_si128(
+         reinterpret_cast<__m128i*>(dst + i),
+         QuantizeSSE2(src + i, noise ? noise + i : nullptr, vScale, lo, hi));
+   QuantizeToInt24Scalar(
+      src + i, noise ? noise + i : nullptr, scale, dst + i, len - i);
+}
+
+inline __m128i StepSSE2(__m128i x)
+{
+   x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+   x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+   return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+inline __m128 ToNoiseSSE2(__m128i x)
+{
+   const auto bits =
+      _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3f800000));
+   return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.5f));
+}
+
+void NoiseSSE2(NoiseState& state, float* dst, size_t len)
+{
+   static_assert(NoiseState::nLanes == 8);
+   auto lanes = reinterpret_cast<__m128i*>(state.lanes);
+   auto a = _mm_loadu_si128(lanes), b = _mm_loadu_si128(lanes + 1);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      a = StepSSE2(a);
+      b = StepSSE2(b);
+      _mm_storeu_ps(dst + i, ToNoiseSSE2(a));
+      _mm_storeu_ps(dst + i + 4, ToNoiseSSE2(b));
+   }
+   _mm_storeu_si128(lanes, a);
+   _mm_storeu_si128(lanes + 1, b);
+   NoiseScalar(state, dst + i, len - i);
+}
+
+const Kernels SSE2Kernels {
+   "SSE2",
+   Int16ToFloatSSE2,
+   Int24ToFloatSSE2,
+   Int16ToInt24SSE2,
+   ClipFloatSSE2,
+   QuantizeToInt16SSE2,
+   QuantizeToInt24SSE2,
+   NoiseSSE2,
+};
+#endif
+
+#ifdef SAMPLE_CONVERSION_AVX2
+bool HasAVX2()
+{
+#if defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7)
+      return false;
+   __cpuid(info, 1);
+   // The processor has AVX and the system saves its registers
+   constexpr int osxsave = 1 << 27, avx = 1 << 28;
+   if ((info[2] & (osxsave | avx)) != (osxsave | avx) ||
+       (_xgetbv(0) & 6) != 6)
+      return false;
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#else
+   return __builtin_cpu_supports("avx2");
+#endif
+}
+
+AVX2_TARGET void Int16ToFloatAVX2(const int16_t* src, float* dst, size_t len)
+{
+   const auto scale = _mm256_set1_ps(Int16Scale);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x = _mm256_cvtepi16_epi32(
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+      _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+   }
+   Int16ToFloatScalar(src + i, dst + i, len - i);
+}
+
+AVX2_TARGET void Int24ToFloatAVX2(const int32_t* src, float* dst, size_t len)
+{
+   const auto scale = _mm256_set1_ps(Int24Scale);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x =
+         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+   }
+   Int24ToFloatScalar(src + i, dst + i, len - i);
+}
+
+AVX2_TARGET void Int16ToInt24AVX2(const int16_t* src, int32_t* dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x = _mm256_cvtepi16_epi32(
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+      _mm256_storeu_si256(
+         reinterpret_cast<__m256i*>(dst + i), _mm256_slli_epi32(x, 8));
+   }
+   Int16ToInt24Scalar(src + i, dst + i, len - i);
+}
+
+AVX2_TARGET inline __m256 ClampAVX2(__m256 x, __m256 lo, __m256 hi)
+{
+   return _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+}
+
+AVX2_TARGET void ClipFloatAVX2(const float* src, float* dst, size_t len)
+{
+   const auto lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+      _mm256_storeu_ps(dst + i, ClampAVX2(_mm256_loadu_ps(src + i), lo, hi));
+   ClipFloatScalar(src + i, dst + i, len - i);
+}
+
+AVX2_TARGET inline __m256i QuantizeAVX2(
+   const float* src, const float* noise, __m256 scale, __m256 lo, __m256 hi)
+{
+   auto x = _mm256_mul_ps(_mm256_loadu_ps(src), scale);
+   if (noise)
+      x = _mm256_add_ps(x, _mm256_loadu_ps(noise));
+   return _mm256_cvtps_epi32(ClampAVX2(x, lo, hi));
+}
+
+AVX2_TARGET void QuantizeToInt16AVX2(
+   const float* src, const float* noise, float scale, int16_t* dst,
+   size_t len)
+{
+   const auto vScale = _mm256_set1_ps(scale);
+   const auto lo = _mm256_set1_ps(Int16Min), hi = _mm256_set1_ps(Int16Max);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x =
+         QuantizeAVX2(src + i, noise ? noise + i : nullptr, vScale, lo, hi);
+      // Packing within halves keeps the order, for one vector
+      const auto packed = _mm_packs_epi32(
+         _mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+   }
+   QuantizeToInt16Scalar(
+      src + i, noise ? noise + i : nullptr, scale, dst + i, len - i);
+}
+
+AVX2_TARGET void QuantizeToInt24AVX2(
+   const float* src, const float* noise, float scale, int32_t* dst,
+   size_t len)
+{
+   const auto vScale = _mm256_set1_ps(scale);
+   const auto lo = _mm256_set1_ps(Int24Min), hi = _mm256_set1_ps(Int24Max);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+      _mm256_storeu_si256(
+         reinterpret_cast<__m256i*>(dst + i),
+         QuantizeAVX2(src + i, noise ? noise + i : nullptr, vScale, lo, hi));
+   QuantizeToInt24Scalar(
+      src + i, noise ? noise + i : nullptr, scale, dst + i, len - i);
+}
+
+AVX2_TARGET void NoiseAVX2(NoiseState& state, float* dst, size_t len)
+{
+   auto lanes = reinterpret_cast<__m256i*>(state.lanes);
+   auto x = _mm256_loadu_si256(lanes);
+   const auto one = _mm256_set1_epi32(0x3f800000);
+   const auto half = _mm256_set1_ps(1.5f);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+      x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+      x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+      const auto bits = _mm256_or_si256(_mm256_srli_epi32(x, 9), one);
+      _mm256_storeu_ps(dst + i, _mm256_sub_ps(_mm256_castsi256_ps(bits), half));
+   }
+   _mm256_storeu_si256(lanes, x);
+   NoiseScalar(state, dst + i, len - i);
+}
+
+const Kernels AVX2Kernels {
+   "AVX2",
+   Int16ToFloatAVX2,
+   Int24ToFloatAVX2,
+   Int16ToInt24AVX2,
+   ClipFloatAVX2,
+   QuantizeToInt16AVX2,
+   QuantizeToInt24AVX2,
+   NoiseAVX2,
+};
+#endif
+
+#ifdef SAMPLE_CONVERSION_NEON
+void Int16ToFloatNEON(const int16_t* src, float* dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x = vld1q_s16(src + i);
+      const auto lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+      const auto hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+      vst1q_f32(dst + i, vmulq_n_f32(lo, Int16Scale));
+      vst1q_f32(dst + i + 4, vmulq_n_f32(hi, Int16Scale));
+   }
+   Int16ToFloatScalar(src + i, dst + i, len - i);
+}
+
+void Int24ToFloatNEON(const int32_t* src, float* dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+      vst1q_f32(
+         dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), Int24Scale));
+   Int24ToFloatScalar(src + i, dst + i, len - i);
+}
+
+void Int16ToInt24NEON(const int16_t* src, int32_t* dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      const auto x = vld1q_s16(src + i);
+      vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(x), 8));
+      vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(x), 8));
+   }
+   Int16ToInt24Scalar(src + i, dst + i, len - i);
+}
+
+// maxnm returns the number if the other operand is NaN
+inline float32x4_t ClampNEON(float32x4_t x, float32x4_t lo, float32x4_t hi)
+{
+   return vminq_f32(vmaxnmq_f32(x, lo), hi);
+}
+
+void ClipFloatNEON(const float* src, float* dst, size_t len)
+{
+   const auto lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+      vst1q_f32(dst + i, ClampNEON(vld1q_f32(src + i), lo, hi));
+   ClipFloatScalar(src + i, dst + i, len - i);
+}
+
+//! Rounds to nearest with ties to even, as lrintf does in the default mode
+inline int32x4_t QuantizeNEON(
+   const float* src, const float* noise, float scale, float32x4_t lo,
+   float32x4_t hi)
+{
+   auto x = vmulq_n_f32(vld1q_f32(src), scale);
+   if (noise)
+      x = vaddq_f32(x, vld1q_f32(noise));
+   return vcvtnq_s32_f32(ClampNEON(x, lo, hi));
+}
+
+void QuantizeToInt16NEON(
+   const float* src, const float* noise, float scale, int16_t* dst,
+   size_t len)
+{
+   const auto lo = vdupq_n_f32(Int16Min), hi = vdupq_n_f32(Int16Max);
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+      vst1_s16(
+         dst + i,
+         vqmovn_s32(
+            QuantizeNEON(src + i, noise ? noise + i : nullptr, scale, lo, hi)));
+   QuantizeToInt16Scalar(
+      src + i, noise ? noise + i : nullptr, scale, dst + i, len - i);
+}
+
+void QuantizeToInt24NEON(
+   const float* src, const float* noise, float scale, int32_t* dst,
+   size_t len)
+{
+   const auto lo = vdupq_n_f32(Int24Min), hi = vdupq_n_f32(Int24Max);
+   size_t i = 0;
+   for (; i + 4 <= len; i += 4)
+      vst1q_s32(
+         dst + i,
+         QuantizeNEON(src + i, noise ? noise + i : nullptr, scale, lo, hi));
+   QuantizeToInt24Scalar(
+      src + i, noise ? noise + i : nullptr, scale, dst + i, len - i);
+}
+
+inline uint32x4_t StepNEON(uint32x4_t x)
+{
+   x = veorq_u32(x, vshlq_n_u32(x, 13));
+   x = veorq_u32(x, vshrq_n_u32(x, 17));
+   return veorq_u32(x, vshlq_n_u32(x, 5));
+}
+
+inline float32x4_t ToNoiseNEON(uint32x4_t x)
+{
+   const auto bits = vorrq_u32(vshrq_n_u32(x, 9), vdupq_n_u32(0x3f800000));
+   return vsubq_f32(vreinterpretq_f32_u32(bits), vdupq_n_f32(1.5f));
+}
+
+void NoiseNEON(NoiseState& state, float* dst, size_t len)
+{
+   static_assert(NoiseState::nLanes == 8);
+   auto a = vld1q_u32(state.lanes), b = vld1q_u32(state.lanes + 4);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8)
+   {
+      a = StepNEON(a);
+      b = StepNEON(b);
+      vst1q_f32(dst + i, ToNoiseNEON(a));
+      vst1q_f32(dst + i + 4, ToNoiseNEON(b));
+   }
+   vst1q_u32(state.lanes, a);
+   vst1q_u32(state.lanes + 4, b);
+   NoiseScalar(state, dst + i, len - i);
+}
+
+const Kernels NEONKernels {
+   "NEON",
+   Int16ToFloatNEON,
+   Int24ToFloatNEON,
+   Int16ToInt24NEON,
+   ClipFloatNEON,
+   QuantizeToInt16NEON,
+   QuantizeToInt24NEON,
+   NoiseNEON,
+};
+#endif
+} // namespace
+
+NoiseState::NoiseState(uint32_t seed)
+{
+   // splitmix32 decorrelates the lanes
+   for (auto& lane : lanes)
+   {
+      auto z = (seed += 0x9e3779b9u);
+      z = (z ^ (z >> 16)) * 0x85ebca6bu;
+      z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+      z ^= z >> 16;
+      lane = z ? z : 1;
+   }
+}
+
+std::vector<const Kernels*> GetSupportedKernels()
+{
+   std::vector<const Kernels*> result { &ScalarKernels };
+#ifdef SAMPLE_CONVERSION_SSE2
+   result.push_back(&SSE2Kernels);
+#endif
+#ifdef SAMPLE_CONVERSION_AVX2
+   if (HasAVX2())
+      result.push_back(&AVX2Kernels);
+#endif
+#ifdef SAMPLE_CONVERSION_NEON
+   result.push_back(&NEONKernels);
+#endif
+   return result;
+}
+
+const Kernels& GetKernels()
+{
+   static const auto& kernels = *GetSupportedKernels().back();
+   return kernels;
+}
+} // namespace SampleConversion
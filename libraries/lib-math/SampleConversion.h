@@ -0,0 +1,67 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.h
+
+  @brief Vectorized kernels for conversion between sample formats
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SampleConversion
+{
+//! Independent xorshift generators, interleaved so that lanes of vectors
+//! step them together
+struct NoiseState final
+{
+   static constexpr size_t nLanes = 8;
+   uint32_t lanes[nLanes];
+
+   //! Seeds all lanes, which must not be zero
+   explicit NoiseState(uint32_t seed = 1);
+};
+
+//! Kernels for contiguous buffers, which may not overlap, except that
+//! ClipFloat may work in place.  All kernel sets compute the same results, bit
+//! for bit.
+struct Kernels final
+{
+   //! For reports
+   const char* name;
+
+   void (*Int16ToFloat)(const int16_t* src, float* dst, size_t len);
+   void (*Int24ToFloat)(const int32_t* src, float* dst, size_t len);
+   void (*Int16ToInt24)(const int16_t* src, int32_t* dst, size_t len);
+
+   //! Clips floats to [-1, 1], which NaN becomes -1, before dithering to
+   //! integers
+   void (*ClipFloat)(const float* src, float* dst, size_t len);
+
+   //! Round `src[i] * scale + noise[i]` to nearest, saturating; noise may be
+   //! null.  scale is a power of two, so that products are exact
+   void (*QuantizeToInt16)(
+      const float* src, const float* noise, float scale, int16_t* dst,
+      size_t len);
+   //! Round `src[i] * scale + noise[i]` to nearest, clipping to 24 bits;
+   //! noise may be null.  scale is a power of two
+   void (*QuantizeToInt24)(
+      const float* src, const float* noise, float scale, int32_t* dst,
+      size_t len);
+
+   //! Uniform noise in [-0.5, 0.5), taking values from the lanes in turn
+   void (*Noise)(NoiseState& state, float* dst, size_t len);
+};
+
+//! The fastest kernels that the processor supports, found at the first call
+MATH_API const Kernels& GetKernels();
+
+//! All kernel sets that the processor supports, the scalar ones first; for
+//! tests and benchmarks
+MATH_API std::vector<const Kernels*> GetSupportedKernels();
+} // namespace SampleConversion
@@ -0,0 +1,87 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadBenchmark.cpp
+
+**********************************************************************/
+#include "Biquad.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+// Set to true to compare the throughput of cascades with that of
+// Biquad::Process, for the shapes that the effects use
+static constexpr auto runLocally = false;
+
+// As the blocks of effects
+constexpr size_t Length = 4096;
+constexpr auto Repetitions = 2000;
+
+template<typename Function>
+void Report(const char* name, size_t samples, Function function)
+{
+   const auto start = std::chrono::steady_clock::now();
+   for (auto i = 0; i < Repetitions; ++i)
+      function();
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+   std::cout << std::setw(24) << name << ": " << std::fixed
+             << std::setprecision(0)
+             << Repetitions * samples / elapsed.count() / 1e6
+             << " Msamples/s\n";
+}
+} // namespace
+
+TEST_CASE("BiquadBenchmark")
+{
+   if (!runLocally)
+      return;
+
+   std::vector<float> samples(Length * 2);
+   for (size_t i = 0; i < samples.size(); ++i)
+      samples[i] = 0.5f * std::sin(i * 0.01f);
+   float* const channels[] = { samples.data(), samples.data() + Length };
+
+   // As the order 10 filter of the Filter effect, on one channel, and as the
+   // two weighting filters of loudness measurement, on stereo
+   const auto filter = Biquad::CalcButterworthFilter(
+      10, 22050, 1000, Biquad::kLowPass);
+   const auto weighting = Biquad::CalcButterworthFilter(
+      4, 22050, 40, Biquad::kHighPass);
+   struct Shape
+   {
+      const char* name;
+      const Biquad* sections;
+      size_t nSections, nChannels;
+   };
+   for (const auto& shape :
+        { Shape { "5 sections, 1 channel", filter.get(), 5, 1 },
+          Shape { "2 sections, 2 channels", weighting.get(), 2, 2 } })
+   {
+      std::cout << shape.name << "\n";
+      ArrayOf<Biquad> biquads(shape.nSections * shape.nChannels);
+      for (size_t i = 0; i < shape.nSections * shape.nChannels; ++i)
+         biquads[i] = shape.sections[i % shape.nSections];
+      Report("Biquad::Process", Length * shape.nChannels, [&] {
+         for (size_t channel = 0; channel < shape.nChannels; ++channel)
+            for (size_t section = 0; section < shape.nSections; ++section)
+               biquads[channel * shape.nSections + section].Process(
+                  channels[channel], channels[channel], Length);
+      });
+      BiquadCascade cascade { shape.sections, shape.nSections,
+                              shape.nChannels };
+      for (const auto pKernels : BiquadCascade::GetSupportedKernels())
+         Report(BiquadCascade::GetName(*pKernels), Length * shape.nChannels,
+            [&] {
+               cascade.Process(*pKernels, channels, channels, Length);
+            });
+   }
+}
@@ -0,0 +1,199 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadTests.cpp
+
+**********************************************************************/
+#include "Biquad.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+constexpr double Rate = 44100;
+// Not a multiple of any vector width, so that odd blocks are tested too
+constexpr size_t Length = 10000 + 3;
+
+std::vector<float> MakeSignal(unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> result(Length);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+//! Filters as the effects did before they used BiquadCascade
+std::vector<float> FilterOneByOne(ArrayOf<Biquad>& sections, size_t nSections,
+   std::vector<float> samples)
+{
+   for (size_t ii = 0; ii < nSections; ++ii)
+   {
+      sections[ii].Reset();
+      sections[ii].Process(samples.data(), samples.data(), samples.size());
+   }
+   return samples;
+}
+
+//! Filters channels, in blocks of the given size
+std::vector<std::vector<float>> FilterCascade(BiquadCascade& cascade,
+   const BiquadCascade::Kernels& kernels,
+   const std::vector<std::vector<float>>& channels, size_t blockSize)
+{
+   auto result = channels;
+   std::vector<float*> pointers;
+   for (auto& channel : result)
+      pointers.push_back(channel.data());
+   cascade.Reset();
+   for (size_t start = 0; start < Length; start += blockSize)
+   {
+      // In place
+      cascade.Process(kernels, pointers.data(), pointers.data(),
+         std::min(blockSize, Length - start));
+      for (auto& pointer : pointers)
+         pointer += blockSize;
+   }
+   return result;
+}
+
+struct Design
+{
+   const char* name;
+   ArrayOf<Biquad> sections;
+   size_t nSections;
+};
+
+std::vector<Design> MakeDesigns()
+{
+   std::vector<Design> result;
+   const auto nyquist = Rate / 2;
+   for (auto order = int(Biquad::MIN_Order); order <= Biquad::MAX_Order;
+        order += 3)
+   {
+      const size_t nSections = (order + 1) / 2;
+      result.push_back({ "Butterworth lowpass",
+         Biquad::CalcButterworthFilter(order, nyquist, 1000, Biquad::kLowPass),
+         nSections });
+      result.push_back({ "Chebyshev I highpass",
+         Biquad::CalcChebyshevType1Filter(
+            order, nyquist, 200, 1, Biquad::kHighPass),
+         nSections });
+      result.push_back({ "Chebyshev II lowpass",
+         Biquad::CalcChebyshevType2Filter(
+            order, nyquist, 5000, 30, Biquad::kLowPass),
+         nSections });
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("BiquadCascade agrees with Biquad::Process")
+{
+   for (auto& design : MakeDesigns())
+   {
+      INFO(design.name << ", " << design.nSections << " sections");
+      const std::vector<std::vector<float>> channels {
+         MakeSignal(1), MakeSignal(2), MakeSignal(3) };
+      BiquadCascade cascade { design.sections.get(), design.nSections,
+                              channels.size() };
+      REQUIRE(cascade.GetNumSections() == design.nSections);
+      REQUIRE(cascade.GetNumChannels() == channels.size());
+
+      std::vector<std::vector<float>> expected;
+      for (const auto& channel : channels)
+         expected.push_back(
+            FilterOneByOne(design.sections, design.nSections, channel));
+
+      for (const auto pKernels : BiquadCascade::GetSupportedKernels())
+      {
+         INFO(BiquadCascade::GetName(*pKernels));
+         for (const size_t blockSize : { Length, size_t(512), size_t(3),
+                                         size_t(1) })
+         {
+            const auto actual =
+               FilterCascade(cascade, *pKernels, channels, blockSize);
+            for (size_t channel = 0; channel < channels.size(); ++channel)
+               for (size_t ii = 0; ii < Length; ++ii)
+                  // Biquad::Process rounds to float between sections
+                  REQUIRE(actual[channel][ii] ==
+                          Approx(expected[channel][ii]).margin(1e-5));
+         }
+      }
+   }
+}
+
+TEST_CASE("BiquadCascade kernels agree with the scalar kernels")
+{
+   const auto allKernels = BiquadCascade::GetSupportedKernels();
+   REQUIRE(!allKernels.empty());
+   REQUIRE(&BiquadCascade::GetKernels() == allKernels.back());
+
+   // Counts of lanes that make whole vectors, partial ones, and several
+   // batches
+   for (const size_t nChannels : { 1, 2, 5, 6 })
+      for (auto& design : MakeDesigns())
+      {
+         INFO(design.name << ", " << design.nSections << " sections, "
+                          << nChannels << " channels");
+         std::vector<std::vector<float>> channels;
+         for (size_t channel = 0; channel < nChannels; ++channel)
+            channels.push_back(MakeSignal(10 + channel));
+         BiquadCascade cascade { design.sections.get(), design.nSections,
+                                 nChannels };
+         const auto expected =
+            FilterCascade(cascade, *allKernels.front(), channels, 1000);
+         for (const auto pKernels : allKernels)
+         {
+            INFO(BiquadCascade::GetName(*pKernels));
+            const auto actual =
+               FilterCascade(cascade, *pKernels, channels, 1000);
+            for (size_t channel = 0; channel < nChannels; ++channel)
+               for (size_t ii = 0; ii < Length; ++ii)
+                  // Exact, unless the compiler fuses the scalar arithmetic
+                  REQUIRE(actual[channel][ii] ==
+                          Approx(expected[channel][ii]).margin(1e-12));
+         }
+      }
+}
+
+TEST_CASE("BiquadCascade keeps its state when coefficients change")
+{
+   const auto nyquist = Rate / 2;
+   const auto low =
+      Biquad::CalcButterworthFilter(4, nyquist, 500, Biquad::kLowPass);
+   const auto high =
+      Biquad::CalcButterworthFilter(4, nyquist, 500, Biquad::kHighPass);
+   auto samples = MakeSignal(4);
+   const auto half = Length / 2;
+
+   auto expected = samples;
+   Biquad sections[] = { low[0], low[1] };
+   for (auto& section : sections)
+      section.Process(expected.data(), expected.data(), half);
+   for (size_t ii = 0; ii < 2; ++ii)
+   {
+      sections[ii].fNumerCoeffs[0] = high[ii].fNumerCoeffs[0];
+      sections[ii].fNumerCoeffs[1] = high[ii].fNumerCoeffs[1];
+      sections[ii].fNumerCoeffs[2] = high[ii].fNumerCoeffs[2];
+      sections[ii].fDenomCoeffs[0] = high[ii].fDenomCoeffs[0];
+      sections[ii].fDenomCoeffs[1] = high[ii].fDenomCoeffs[1];
+      sections[ii].Process(
+         expected.data() + half, expected.data() + half, Length - half);
+   }
+
+   BiquadCascade cascade { low.get(), 2, 1 };
+   float* pointer = samples.data();
+   cascade.Process(&pointer, &pointer, half);
+   cascade.SetSections(high.get());
+   pointer += half;
+   cascade.Process(&pointer, &pointer, Length - half);
+   for (size_t ii = 0; ii < Length; ++ii)
+      REQUIRE(samples[ii] == Approx(expected[ii]).margin(1e-5));
+}
@@ -0,0 +1,104 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlockCodecBenchmark.cpp
+
+**********************************************************************/
+#include "SampleBlockCodec.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace SampleBlockCodec;
+
+namespace
+{
+// Set to true to compare the read throughput of encoded blocks with that of
+// unencoded blocks, as stored before codecs were introduced
+static constexpr auto runLocally = false;
+
+// The default maximum size of a sample block
+constexpr size_t BlockSize = 262144;
+constexpr size_t NumBlocks = 64;
+
+//! A mix of tones and some noise, converted from 16 bit audio as by import
+std::vector<float> MakeBlock(unsigned seed)
+{
+   std::vector<float> result(BlockSize);
+   std::mt19937 engine { seed };
+   std::normal_distribution<float> noise { 0.f, 1e-3f };
+   for (size_t i = 0; i < BlockSize; ++i)
+      result[i] = std::round(
+                     32767 * (0.4f * std::sin(i * 0.0627f + seed) +
+                              0.2f * std::sin(i * 0.0131f) + noise(engine))) /
+                  32768;
+   return result;
+}
+
+//! Decode all blocks repeatedly, as a reading of the project would
+void Report(const char* name, Codec codec,
+   const std::vector<std::vector<float>>& blocks)
+{
+   std::vector<std::vector<uint8_t>> stored;
+   size_t storedBytes = 0;
+   for (const auto& block : blocks)
+   {
+      auto encoded = Encode(
+         codec, reinterpret_cast<constSamplePtr>(block.data()), BlockSize,
+         floatSample);
+      if (encoded.empty())
+      {
+         const auto bytes = reinterpret_cast<const uint8_t*>(block.data());
+         encoded.assign(bytes, bytes + BlockSize * sizeof(float));
+      }
+      storedBytes += encoded.size();
+      stored.push_back(move(encoded));
+   }
+
+   constexpr auto repetitions = 10;
+   std::vector<float> dest(BlockSize);
+   const auto start = std::chrono::steady_clock::now();
+   for (auto i = 0; i < repetitions; ++i)
+      for (const auto& encoded : stored)
+      {
+         const auto actual =
+            encoded.size() == BlockSize * sizeof(float) ? Codec::None : codec;
+         REQUIRE(Decode(
+            actual, encoded.data(), encoded.size(),
+            reinterpret_cast<samplePtr>(dest.data()), BlockSize,
+            floatSample));
+      }
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+   const double rawBytes = double(NumBlocks) * BlockSize * sizeof(float);
+   std::cout << std::setw(10) << name << ": ratio " << std::fixed
+             << std::setprecision(3) << storedBytes / rawBytes << ", read "
+             << std::setprecision(1)
+             << repetitions * rawBytes / elapsed.count() / (1 << 20)
+             << " MiB/s of samples, "
+             << repetitions * storedBytes / elapsed.count() / (1 << 20)
+             << " MiB/s from storage\n";
+}
+} // namespace
+
+TEST_CASE("SampleBlockCodecBenchmark")
+{
+   if (!runLocally)
+      return;
+
+   std::vector<std::vector<float>> blocks;
+   for (unsigned i = 0; i < NumBlocks; ++i)
+      blocks.push_back(MakeBlock(i));
+
+   Report("none", Codec::None, blocks);
+   Report("lossless", Codec::Lossless, blocks);
+   Report("lz4", Codec::LZ4, blocks);
+}
@@ -0,0 +1,159 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlockCodecTests.cpp
+
+**********************************************************************/
+#include "SampleBlockCodec.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace SampleBlockCodec;
+
+namespace
+{
+std::vector<char> MakeSamples(
+   sampleFormat format, size_t numsamples, bool noisy, unsigned seed = 0)
+{
+   std::vector<char> result(numsamples * SAMPLE_SIZE(format));
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   for (size_t i = 0; i < numsamples; ++i)
+   {
+      const auto value =
+         noisy ? noise(engine) : 0.8f * std::sin(i * 0.01f) * std::sin(i * 1e-4f);
+      switch (format)
+      {
+      case int16Sample:
+         reinterpret_cast<int16_t*>(result.data())[i] =
+            static_cast<int16_t>(std::lround(value * 32767));
+         break;
+      case int24Sample:
+         reinterpret_cast<int32_t*>(result.data())[i] =
+            static_cast<int32_t>(std::lround(value * 8388607));
+         break;
+      default:
+         reinterpret_cast<float*>(result.data())[i] = value;
+         break;
+      }
+   }
+   return result;
+}
+
+void RequireRoundTrip(
+   Codec codec, const std::vector<char>& samples, sampleFormat format)
+{
+   const auto numsamples = samples.size() / SAMPLE_SIZE(format);
+   const auto encoded =
+      Encode(codec, samples.data(), numsamples, format);
+   if (encoded.empty())
+      // Incompressible, so stored as is
+      return;
+   REQUIRE(encoded.size() < samples.size());
+
+   std::vector<char> decoded(samples.size());
+   REQUIRE(Decode(
+      codec, encoded.data(), encoded.size(), decoded.data(), numsamples,
+      format));
+   REQUIRE(memcmp(decoded.data(), samples.data(), samples.size()) == 0);
+}
+} // namespace
+
+TEST_CASE("SampleBlockCodec")
+{
+   const auto codec = GENERATE(Codec::Lossless, Codec::LZ4);
+   const auto format = GENERATE(int16Sample, int24Sample, floatSample);
+   // Include sizes that are not multiples of the frame size, and tiny ones
+   const size_t numsamples = GENERATE(1, 13, 4096, 4097, 262144);
+
+   SECTION("smooth signal is compressed losslessly")
+   {
+      const auto samples = MakeSamples(format, numsamples, false);
+      RequireRoundTrip(codec, samples, format);
+      if (numsamples >= 4096 && codec == Codec::Lossless)
+         REQUIRE(!Encode(codec, samples.data(), numsamples, format).empty());
+   }
+
+   SECTION("noise survives the round trip")
+   {
+      RequireRoundTrip(codec, MakeSamples(format, numsamples, true), format);
+   }
+
+   SECTION("silence is compressed")
+   {
+      const std::vector<char> samples(numsamples * SAMPLE_SIZE(format));
+      RequireRoundTrip(codec, samples, format);
+      if (numsamples >= 4096)
+         REQUIRE(!Encode(codec, samples.data(), numsamples, format).empty());
+   }
+
+   SECTION("extreme and non-finite values survive the round trip")
+   {
+      auto samples = MakeSamples(format, numsamples, false);
+      if (format == floatSample)
+      {
+         const float specials[] = {
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+            -0.f,
+            std::numeric_limits<float>::denorm_min(),
+            -std::numeric_limits<float>::max(),
+         };
+         for (size_t i = 0; i < numsamples; i += 7)
+            reinterpret_cast<float*>(samples.data())[i] =
+               specials[(i / 7) % std::size(specials)];
+      }
+      else if (format == int16Sample)
+      {
+         for (size_t i = 0; i < numsamples; i += 5)
+            reinterpret_cast<int16_t*>(samples.data())[i] =
+               (i / 5) % 2 ? std::numeric_limits<int16_t>::min() :
+                             std::numeric_limits<int16_t>::max();
+      }
+      else
+      {
+         for (size_t i = 0; i < numsamples; i += 5)
+            reinterpret_cast<int32_t*>(samples.data())[i] =
+               (i / 5) % 2 ? -8388608 : 8388607;
+      }
+      RequireRoundTrip(codec, samples, format);
+   }
+}
+
+TEST_CASE("SampleBlockCodec rejects malformed data")
+{
+   const auto codec = GENERATE(Codec::Lossless, Codec::LZ4);
+   const size_t numsamples = 65536;
+   const auto samples = MakeSamples(floatSample, numsamples, false);
+   const auto encoded =
+      Encode(codec, samples.data(), numsamples, floatSample);
+   REQUIRE(!encoded.empty());
+
+   std::vector<char> decoded(samples.size());
+   // Truncation must be detected, and must not overrun the buffers
+   REQUIRE(!Decode(
+      codec, encoded.data(), encoded.size() / 2, decoded.data(), numsamples,
+      floatSample));
+   REQUIRE(!Decode(
+      Codec::None, encoded.data(), encoded.size(), decoded.data(), numsamples,
+      floatSample));
+}
+
+TEST_CASE("SampleBlockCodec::None")
+{
+   const auto samples = MakeSamples(floatSample, 1000, false);
+   REQUIRE(Encode(Codec::None, samples.data(), 1000, floatSample).empty());
+   std::vector<char> decoded(samples.size());
+   REQUIRE(Decode(
+      Codec::None, samples.data(), samples.size(), decoded.data(), 1000,
+      floatSample));
+   REQUIRE(decoded == samples);
+}
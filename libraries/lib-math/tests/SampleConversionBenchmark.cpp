@@ -0,0 +1,102 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleConversionBenchmark.cpp
+
+**********************************************************************/
+#include "Dither.h"
+#include "SampleConversion.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+
+using namespace SampleConversion;
+
+namespace
+{
+// Set to true to compare the throughput of the kernels for each instruction
+// set, and of whole conversions with dither
+static constexpr auto runLocally = false;
+
+// Fits in the caches, as the buffers of import and export do
+constexpr size_t Length = 65536;
+constexpr auto Repetitions = 2000;
+
+template<typename Function>
+void Report(const char* name, size_t samples, Function function)
+{
+   const auto start = std::chrono::steady_clock::now();
+   for (auto i = 0; i < Repetitions; ++i)
+      function();
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+   std::cout << std::setw(28) << name << ": " << std::fixed
+             << std::setprecision(0)
+             << Repetitions * samples / elapsed.count() / 1e6
+             << " Msamples/s\n";
+}
+} // namespace
+
+TEST_CASE("SampleConversionBenchmark")
+{
+   if (!runLocally)
+      return;
+
+   std::vector<float> floats(Length), noise(Length);
+   std::vector<int16_t> int16s(Length);
+   std::vector<int32_t> int24s(Length);
+   for (size_t i = 0; i < Length; ++i)
+      floats[i] = 0.9f * std::sin(i * 0.01f);
+
+   for (const auto pKernels : GetSupportedKernels())
+   {
+      const auto& kernels = *pKernels;
+      std::cout << kernels.name << "\n";
+      NoiseState state;
+      Report("int16 to float", Length, [&] {
+         kernels.Int16ToFloat(int16s.data(), floats.data(), Length);
+      });
+      Report("int24 to float", Length, [&] {
+         kernels.Int24ToFloat(int24s.data(), floats.data(), Length);
+      });
+      Report("noise", Length, [&] { kernels.Noise(state, noise.data(), Length); });
+      Report("float to int16 with noise", Length, [&] {
+         kernels.QuantizeToInt16(
+            floats.data(), noise.data(), 32768.0f, int16s.data(), Length);
+      });
+      Report("float to int24", Length, [&] {
+         kernels.QuantizeToInt24(
+            floats.data(), nullptr, 8388608.0f, int24s.data(), Length);
+      });
+   }
+
+   std::cout << "Dither::Apply, " << GetKernels().name << "\n";
+   Dither dither;
+   for (const auto& [name, type] :
+        { std::pair { "none", DitherType::none },
+          std::pair { "rectangle", DitherType::rectangle },
+          std::pair { "triangle", DitherType::triangle },
+          std::pair { "shaped", DitherType::shaped } })
+   {
+      Report(name, Length, [&] {
+         dither.Apply(
+            type, reinterpret_cast<constSamplePtr>(floats.data()), floatSample,
+            reinterpret_cast<samplePtr>(int16s.data()), int16Sample, Length);
+      });
+      // To one channel of interleaved stereo
+      Report((std::string(name) + ", interleaved").c_str(), Length / 2, [&] {
+         dither.Apply(
+            type, reinterpret_cast<constSamplePtr>(floats.data()), floatSample,
+            reinterpret_cast<samplePtr>(int16s.data()), int16Sample,
+            Length / 2, 1, 2);
+      });
+   }
+}
@@ -0,0 +1,210 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleConversionTests.cpp
+
+**********************************************************************/
+#include "Dither.h"
+#include "SampleConversion.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace SampleConversion;
+
+namespace
+{
+// Not a multiple of any vector width, so that tails are tested too
+constexpr size_t Length = 1000 + 3;
+
+std::vector<float> MakeFloats(unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -1.2f, 1.2f };
+   std::vector<float> result(Length);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   // Extremes, ties, and NaN
+   const float special[] = { 1.0f, -1.0f, 2.0f, -2.0f, 0.5f / 32768,
+                             1.5f / 32768, -0.5f / 32768, 0.0f, -0.0f,
+                             std::numeric_limits<float>::quiet_NaN(),
+                             std::numeric_limits<float>::infinity() };
+   std::copy(std::begin(special), std::end(special), result.begin());
+   return result;
+}
+
+std::vector<int16_t> MakeInt16s(unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::vector<int16_t> result(Length);
+   for (auto& sample : result)
+      sample = static_cast<int16_t>(engine());
+   result[0] = -32768, result[1] = 32767;
+   return result;
+}
+
+std::vector<int32_t> MakeInt24s(unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::vector<int32_t> result(Length);
+   for (auto& sample : result)
+      sample = static_cast<int32_t>(engine() % (1 << 24)) - (1 << 23);
+   result[0] = -8388608, result[1] = 8388607;
+   return result;
+}
+} // namespace
+
+TEST_CASE("SampleConversion kernels agree with the scalar kernels")
+{
+   const auto allKernels = GetSupportedKernels();
+   REQUIRE(!allKernels.empty());
+   const auto& scalar = *allKernels.front();
+   REQUIRE(&GetKernels() == allKernels.back());
+
+   const auto floats = MakeFloats(1);
+   const auto int16s = MakeInt16s(2);
+   const auto int24s = MakeInt24s(3);
+
+   std::vector<float> noise(Length);
+   const float* const noises[] = { nullptr, noise.data() };
+   NoiseState noiseState { 4 };
+   scalar.Noise(noiseState, noise.data(), Length);
+
+   for (const auto pKernels : allKernels)
+   {
+      const auto& kernels = *pKernels;
+      INFO(kernels.name);
+
+      std::vector<float> expected(Length), actual(Length);
+      scalar.Int16ToFloat(int16s.data(), expected.data(), Length);
+      kernels.Int16ToFloat(int16s.data(), actual.data(), Length);
+      REQUIRE(actual == expected);
+
+      scalar.Int24ToFloat(int24s.data(), expected.data(), Length);
+      kernels.Int24ToFloat(int24s.data(), actual.data(), Length);
+      REQUIRE(actual == expected);
+
+      std::vector<int32_t> expected24(Length), actual24(Length);
+      scalar.Int16ToInt24(int16s.data(), expected24.data(), Length);
+      kernels.Int16ToInt24(int16s.data(), actual24.data(), Length);
+      REQUIRE(actual24 == expected24);
+
+      scalar.ClipFloat(floats.data(), expected.data(), Length);
+      kernels.ClipFloat(floats.data(), actual.data(), Length);
+      REQUIRE(actual == expected);
+      // NaN becomes -1
+      REQUIRE(actual[9] == -1.0f);
+
+      // Clipped samples, with and without noise, and unclipped ones, which
+      // saturate
+      for (const auto& source : { expected, floats })
+         for (const auto pNoise : noises)
+         {
+            std::vector<int16_t> expected16(Length), actual16(Length);
+            scalar.QuantizeToInt16(
+               source.data(), pNoise, 32768.0f, expected16.data(), Length);
+            kernels.QuantizeToInt16(
+               source.data(), pNoise, 32768.0f, actual16.data(), Length);
+            REQUIRE(actual16 == expected16);
+
+            scalar.QuantizeToInt24(
+               source.data(), pNoise, 8388608.0f, expected24.data(), Length);
+            kernels.QuantizeToInt24(
+               source.data(), pNoise, 8388608.0f, actual24.data(), Length);
+            REQUIRE(actual24 == expected24);
+         }
+
+      NoiseState state { 4 };
+      kernels.Noise(state, actual.data(), Length);
+      REQUIRE(actual == noise);
+   }
+}
+
+TEST_CASE("SampleConversion rounding and noise")
+{
+   const auto& kernels = GetKernels();
+
+   // Ties round to even, and bounds saturate
+   const float samples[] = { 0.5f, 1.5f, -0.5f, -2.5f, 40000.0f, -40000.0f,
+                             32767.4f, -32768.0f };
+   int16_t rounded[8];
+   kernels.QuantizeToInt16(samples, nullptr, 1.0f, rounded, 8);
+   const int16_t expected[] = { 0, 2, 0, -2, 32767, -32768, 32767, -32768 };
+   REQUIRE(std::equal(rounded, rounded + 8, expected));
+
+   // 16 bit samples survive a round trip through float
+   const auto int16s = MakeInt16s(5);
+   std::vector<float> floats(Length);
+   std::vector<int16_t> back(Length);
+   kernels.Int16ToFloat(int16s.data(), floats.data(), Length);
+   kernels.QuantizeToInt16(floats.data(), nullptr, 32768.0f, back.data(), Length);
+   REQUIRE(back == int16s);
+
+   // Noise is in range and has no dc
+   std::vector<float> noise(100000);
+   NoiseState state;
+   kernels.Noise(state, noise.data(), noise.size());
+   double sum = 0;
+   for (auto value : noise)
+   {
+      REQUIRE(value >= -0.5f);
+      REQUIRE(value < 0.5f);
+      sum += value;
+   }
+   REQUIRE(std::abs(sum / noise.size()) < 0.01);
+}
+
+TEST_CASE("Dither::Apply with interleaved samples")
+{
+   const auto floats = MakeFloats(6);
+   constexpr size_t stride = 3;
+   std::vector<float> interleaved(Length * stride);
+   for (size_t i = 0; i < Length; ++i)
+      interleaved[i * stride + 1] = floats[i];
+
+   for (const auto type : { DitherType::none, DitherType::rectangle,
+                            DitherType::triangle, DitherType::shaped })
+   {
+      Dither dither;
+      std::vector<int16_t> plain(Length), strided(Length * 2);
+      dither.Apply(
+         type, reinterpret_cast<constSamplePtr>(floats.data()), floatSample,
+         reinterpret_cast<samplePtr>(plain.data()), int16Sample, Length);
+      dither.Apply(
+         type, reinterpret_cast<constSamplePtr>(interleaved.data() + 1),
+         floatSample, reinterpret_cast<samplePtr>(strided.data()),
+         int16Sample, Length, stride, 2);
+
+      for (size_t i = 0; i < Length; ++i)
+      {
+         const auto clipped = std::isnan(floats[i]) ?
+            -1.0f : std::clamp(floats[i], -1.0f, 1.0f);
+         const auto exact = clipped * 32768.0f;
+         // Without noise shaping, dither changes a sample by at most one
+         // step; noise shaping feeds back errors of a few steps
+         const auto tolerance = type == DitherType::none ? 0.5f :
+                                type == DitherType::shaped ? 16.0f : 1.5f;
+         const auto bounded = std::clamp(exact, -32768.0f, 32767.0f);
+         REQUIRE(std::abs(plain[i] - bounded) <= tolerance);
+         REQUIRE(std::abs(strided[2 * i] - bounded) <= tolerance);
+         if (type == DitherType::none)
+            REQUIRE(plain[i] == strided[2 * i]);
+      }
+   }
+
+   // Conversions to float, also interleaved
+   const auto int16s = MakeInt16s(7);
+   std::vector<float> converted(Length * 2);
+   Dither {}.Apply(
+      DitherType::none, reinterpret_cast<constSamplePtr>(int16s.data()),
+      int16Sample, reinterpret_cast<samplePtr>(converted.data()),
+      floatSample, Length, 1, 2);
+   for (size_t i = 0; i < Length; ++i)
+      REQUIRE(converted[2 * i] == int16s[i] / 32768.0f);
+}
@@ -31,6 +31,7 @@ a draggable point type.
 
 #include <float.h>
 #include <math.h>
+#include <cmath>
 
 #include <wx/wxcrtvararg.h>
 #include <wx/brush.h>
@@ -55,22 +56,24 @@ Envelope::~Envelope()
 
 bool Envelope::IsTrivial() const
 {
-   return mDefaultValue == 1.0 && mEnv.empty();
+   return mDefaultValue == 1.0 && mEnv->empty();
 }
 
 bool Envelope::ConsistencyCheck()
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    bool consistent = true;
 
    bool disorder;
    do {
       disorder = false;
-      for ( size_t ii = 0, count = mEnv.size(); ii < count; ) {
+      for ( size_t ii = 0, count = points.size(); ii < count; ) {
          // Find range of points with equal T
-         const double thisT = mEnv[ii].GetT();
+         const double thisT = points[ii].GetT();
          double nextT = 0.0f;
          auto nextI = ii + 1;
-         while ( nextI < count && thisT == ( nextT = mEnv[nextI].GetT() ) )
+         while ( nextI < count && thisT == ( nextT = points[nextI].GetT() ) )
             ++nextI;
 
          if ( nextI < count && nextT < thisT )
@@ -99,7 +102,7 @@ bool Envelope::ConsistencyCheck()
          ++mVersion;
          consistent = false;
          // repair it
-         std::stable_sort( mEnv.begin(), mEnv.end(),
+         std::stable_sort( points.begin(), points.end(),
             []( const EnvPoint &a, const EnvPoint &b )
                { return a.GetT() < b.GetT(); } );
       }
@@ -116,6 +119,8 @@ bool Envelope::ConsistencyCheck()
 /// @maxValue - the NEW maximum value
 void Envelope::RescaleValues(double minValue, double maxValue)
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    double oldMinValue = mMinValue;
    double oldMaxValue = mMaxValue;
    mMinValue = minValue;
@@ -126,9 +131,9 @@ void Envelope::RescaleValues(double minValue, double maxValue)
    mDefaultValue = ClampValue(mMinValue + (mMaxValue - mMinValue) * factor);
 
    // rescale all points
-   for( unsigned int i = 0; i < mEnv.size(); i++ ) {
-      factor = (mEnv[i].GetVal() - oldMinValue) / (oldMaxValue - oldMinValue);
-      mEnv[i].SetVal( this, mMinValue + (mMaxValue - mMinValue) * factor );
+   for( unsigned int i = 0; i < points.size(); i++ ) {
+      factor = (points[i].GetVal() - oldMinValue) / (oldMaxValue - oldMinValue);
+      points[i].SetVal( this, mMinValue + (mMaxValue - mMinValue) * factor );
    }
 
    ++mVersion;
@@ -139,7 +144,9 @@ void Envelope::RescaleValues(double minValue, double maxValue)
 /// @value - the y-value for the flat envelope.
 void Envelope::Flatten(double value)
 {
-   mEnv.clear();
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   points.clear();
    mDefaultValue = ClampValue(value);
 
    ++mVersion;
@@ -147,12 +154,14 @@ void Envelope::Flatten(double value)
 
 void Envelope::SetDragPoint(int dragPoint)
 {
-   mDragPoint = std::max(-1, std::min(int(mEnv.size() - 1), dragPoint));
+   mDragPoint = std::max(-1, std::min(int(mEnv->size() - 1), dragPoint));
    mDragPointValid = (mDragPoint >= 0);
 }
 
 void Envelope::SetDragPointValid(bool valid)
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    mDragPointValid = (valid && mDragPoint >= 0);
    if (mDragPoint >= 0 && !valid) {
       // We're going to be deleting the point; On
@@ -162,28 +171,28 @@ void Envelope::SetDragPointValid(bool valid)
       // to the same position as the previous or next point.
 
       static const double big = std::numeric_limits<double>::max();
-      auto size = mEnv.size();
+      auto size = points.size();
 
       if( size <= 1) {
          // There is only one point - just move it
          // off screen and at default height.
          // temporary state when dragging only!
-         mEnv[mDragPoint].SetT(big);
-         mEnv[mDragPoint].SetVal( this, mDefaultValue );
+         points[mDragPoint].SetT(big);
+         points[mDragPoint].SetVal( this, mDefaultValue );
          return;
       }
       else if ( mDragPoint + 1 == (int)size ) {
          // Put the point at the height of the last point, but also off screen.
-         mEnv[mDragPoint].SetT(big);
-         mEnv[mDragPoint].SetVal( this, mEnv[ size - 1 ].GetVal() );
+         points[mDragPoint].SetT(big);
+         points[mDragPoint].SetVal( this, points[ size - 1 ].GetVal() );
       }
       else {
          // Place it exactly on its right neighbour.
          // That way the drawing code will overpaint the dark dot with
          // a light dot, as if it were deleted.
-         const auto &neighbor = mEnv[mDragPoint + 1];
-         mEnv[mDragPoint].SetT(neighbor.GetT());
-         mEnv[mDragPoint].SetVal( this, neighbor.GetVal() );
+         const auto &neighbor = points[mDragPoint + 1];
+         points[mDragPoint].SetT(neighbor.GetT());
+         points[mDragPoint].SetVal( this, neighbor.GetVal() );
       }
    }
 
@@ -192,6 +201,8 @@ void Envelope::SetDragPointValid(bool valid)
 
 void Envelope::MoveDragPoint(double newWhen, double value)
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    SetDragPointValid(true);
    if (!mDragPointValid)
       return;
@@ -202,11 +213,11 @@ void Envelope::MoveDragPoint(double newWhen, double value)
    double limitHi = mTrackLen;
 
    if (mDragPoint > 0)
-      limitLo = std::max(limitLo, mEnv[mDragPoint - 1].GetT());
-   if (mDragPoint + 1 < (int)mEnv.size())
-      limitHi = std::min(limitHi, mEnv[mDragPoint + 1].GetT());
+      limitLo = std::max(limitLo, points[mDragPoint - 1].GetT());
+   if (mDragPoint + 1 < (int)points.size())
+      limitHi = std::min(limitHi, points[mDragPoint + 1].GetT());
 
-   EnvPoint &dragPoint = mEnv[mDragPoint];
+   EnvPoint &dragPoint = points[mDragPoint];
    const double tt =
       std::max(limitLo, std::min(limitHi, newWhen));
 
@@ -228,11 +239,13 @@ void Envelope::ClearDragPoint()
 }
 
 void Envelope::SetRange(double minValue, double maxValue) {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    mMinValue = minValue;
    mMaxValue = maxValue;
    mDefaultValue = ClampValue(mDefaultValue);
-   for( unsigned int i = 0; i < mEnv.size(); i++ )
-      mEnv[i].SetVal( this, mEnv[i].GetVal() ); // this clamps the value to the NEW range
+   for( unsigned int i = 0; i < points.size(); i++ )
+      points[i].SetVal( this, points[i].GetVal() ); // this clamps the value to the NEW range
 
    ++mVersion;
 }
@@ -241,17 +254,19 @@ void Envelope::SetRange(double minValue, double maxValue) {
 // copy of another, or when truncating a track.
 void Envelope::AddPointAtEnd( double t, double val )
 {
-   mEnv.push_back( EnvPoint{ t, val } );
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   points.push_back( EnvPoint{ t, val } );
 
    // Assume copied points were stored by nondecreasing time.
    // Allow no more than two points at exactly the same time.
    // Maybe that happened, because extra points were inserted at the boundary
    // of the copied range, which were not in the source envelope.
-   auto nn = mEnv.size() - 1;
-   while ( nn >= 2 && mEnv[ nn - 2 ].GetT() == t ) {
+   auto nn = points.size() - 1;
+   while ( nn >= 2 && points[ nn - 2 ].GetT() == t ) {
       // Of three or more points at the same time, erase one in the middle,
       // not the one newly added.
-      mEnv.erase( mEnv.begin() + nn - 1 );
+      points.erase( points.begin() + nn - 1 );
       --nn;
    }
 
@@ -273,19 +288,21 @@ Envelope::Envelope(const Envelope &orig, double t0, double t1)
 }
 
 Envelope::Envelope(const Envelope &orig)
-   : mDB(orig.mDB)
+   : mEnv(orig.mEnv)
+   , mDB(orig.mDB)
    , mMinValue(orig.mMinValue)
    , mMaxValue(orig.mMaxValue)
    , mDefaultValue(orig.mDefaultValue)
 {
    mOffset = orig.mOffset;
    mTrackLen = orig.mTrackLen;
-   CopyRange(orig, 0, orig.GetNumberOfPoints());
 }
 
 void Envelope::CopyRange(const Envelope &orig, size_t begin, size_t end)
 {
-   size_t len = orig.mEnv.size();
+   // One session for all the points
+   auto writer = mEnv.Write();
+   size_t len = orig.mEnv->size();
    size_t i = begin;
 
    // Create the point at 0 if it needs interpolated representation
@@ -338,8 +355,8 @@ bool Envelope::HandleXMLTag(const std::string_view& tag, const AttributesList& a
    if (numPoints < 0)
       return false;
 
-   mEnv.clear();
-   mEnv.reserve(numPoints);
+   mLoadedPoints.clear();
+   mLoadedPoints.reserve(numPoints);
    return true;
 }
 
@@ -348,20 +365,28 @@ XMLTagHandler *Envelope::HandleXMLChild(const std::string_view& tag)
    if (tag != "controlpoint")
       return NULL;
 
-   mEnv.push_back( EnvPoint{} );
-   return &mEnv.back();
+   mLoadedPoints.push_back( EnvPoint{} );
+   return &mLoadedPoints.back();
+}
+
+void Envelope::HandleXMLEndTag(const std::string_view& tag)
+{
+   // Publish the points all at once, after their attributes are read
+   if (tag == "envelope")
+      mEnv.Reset(std::exchange(mLoadedPoints, {}));
 }
 
 void Envelope::WriteXML(XMLWriter &xmlFile) const
 // may throw
 {
+   const auto &points = *mEnv;
    unsigned int ctrlPt;
 
    xmlFile.StartTag(wxT("envelope"));
-   xmlFile.WriteAttr(wxT("numpoints"), mEnv.size());
+   xmlFile.WriteAttr(wxT("numpoints"), points.size());
 
-   for (ctrlPt = 0; ctrlPt < mEnv.size(); ctrlPt++) {
-      const EnvPoint &point = mEnv[ctrlPt];
+   for (ctrlPt = 0; ctrlPt < points.size(); ctrlPt++) {
+      const EnvPoint &point = points[ctrlPt];
       xmlFile.StartTag(wxT("controlpoint"));
       xmlFile.WriteAttr(wxT("t"), point.GetT(), 12);
       xmlFile.WriteAttr(wxT("val"), point.GetVal(), 12);
@@ -373,21 +398,27 @@ void Envelope::WriteXML(XMLWriter &xmlFile) const
 
 void Envelope::Delete( int point )
 {
-   mEnv.erase(mEnv.begin() + point);
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   points.erase(points.begin() + point);
 
    ++mVersion;
 }
 
 void Envelope::Insert(int point, const EnvPoint &p) noexcept
 {
-   mEnv.insert(mEnv.begin() + point, p);
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   points.insert(points.begin() + point, p);
 
    ++mVersion;
 }
 
 void Envelope::Insert(double when, double value)
 {
-   mEnv.push_back(EnvPoint { when, value });
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   points.push_back(EnvPoint { when, value });
 
    ++mVersion;
 }
@@ -395,6 +426,8 @@ void Envelope::Insert(double when, double value)
 /*! @excsafety{No-fail} */
 void Envelope::CollapseRegion(double t0, double t1, double sampleDur) noexcept
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    if ( t1 <= t0 )
       return;
 
@@ -451,12 +484,12 @@ void Envelope::CollapseRegion(double t0, double t1, double sampleDur) noexcept
          rightPoint = false;
    }
    else
-      mEnv.erase( mEnv.begin() + begin, mEnv.begin() + end );
+      points.erase( points.begin() + begin, points.begin() + end );
 
    // Shift points left after deleted region.
-   auto len = mEnv.size();
+   auto len = points.size();
    for ( size_t i = begin; i < len; ++i ) {
-      auto &point = mEnv[i];
+      auto &point = points[i];
       if (rightPoint && (int)i == begin)
          // Avoid roundoff error.
          // Make exactly equal times of neighboring points so that we have
@@ -485,8 +518,10 @@ void Envelope::CollapseRegion(double t0, double t1, double sampleDur) noexcept
 /*! @excsafety{No-fail} */
 void Envelope::PasteEnvelope( double t0, const Envelope *e, double sampleDur )
 {
-   const bool wasEmpty = (this->mEnv.size() == 0);
-   auto otherSize = e->mEnv.size();
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   const bool wasEmpty = (points.size() == 0);
+   auto otherSize = e->mEnv->size();
    const double otherDur = e->mTrackLen;
    const auto otherOffset = e->mOffset;
    const auto deltat = otherOffset + otherDur;
@@ -515,7 +550,7 @@ void Envelope::PasteEnvelope( double t0, const Envelope *e, double sampleDur )
       auto range = EqualRange( t0, sampleDur );
       auto index = range.first;
       if ( index + 2 == range.second &&
-           ( newT0 = mEnv[ index ].GetT() ) == mEnv[ 1 + index ].GetT() )
+           ( newT0 = points[ index ].GetT() ) == points[ 1 + index ].GetT() )
          t0 = newT0;
    }
 
@@ -530,19 +565,19 @@ void Envelope::PasteEnvelope( double t0, const Envelope *e, double sampleDur )
    auto insertAt = range.first + 1;
 
    // Copy points from e -- maybe skipping those at the extremes
-   auto end = e->mEnv.end();
-   if ( otherSize != 0 && e->mEnv[ otherSize - 1 ].GetT() == otherDur )
+   auto end = e->mEnv->end();
+   if ( otherSize != 0 && (*e->mEnv)[ otherSize - 1 ].GetT() == otherDur )
       // ExpandRegion already made an equivalent limit point
       --end, --otherSize;
-   auto begin = e->mEnv.begin();
-   if ( otherSize != 0 && otherOffset == 0.0 && e->mEnv[ 0 ].GetT() == 0.0 )
+   auto begin = e->mEnv->begin();
+   if ( otherSize != 0 && otherOffset == 0.0 && (*e->mEnv)[ 0 ].GetT() == 0.0 )
       ++begin, --otherSize;
-   mEnv.insert( mEnv.begin() + insertAt, begin, end );
+   points.insert( points.begin() + insertAt, begin, end );
 
    // Adjust their times
    for ( size_t index = insertAt, last = insertAt + otherSize;
          index < last; ++index ) {
-      auto &point = mEnv[ index ];
+      auto &point = points[ index ];
       // The mOffset of the envelope-pasted-from is irrelevant.
       // The GetT() times in it are relative to its start.
       // The new GetT() times are relative to the envelope-pasted-to start.
@@ -571,21 +606,23 @@ void Envelope::PasteEnvelope( double t0, const Envelope *e, double sampleDur )
 void Envelope::RemoveUnneededPoints(
    size_t startAt, bool rightward, bool testNeighbors) noexcept
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    // startAt is the index of a recently inserted point which might make no
    // difference in envelope evaluation, or else might cause nearby points to
    // make no difference.
 
-   auto isDiscontinuity = [this]( size_t index ) noexcept {
+   auto isDiscontinuity = [&points]( size_t index ) noexcept {
       // Assume array accesses are in-bounds
-      const EnvPoint &point1 = mEnv[ index ];
-      const EnvPoint &point2 = mEnv[ index + 1 ];
+      const EnvPoint &point1 = points[ index ];
+      const EnvPoint &point2 = points[ index + 1 ];
       return point1.GetT() == point2.GetT() &&
          fabs( point1.GetVal() - point2.GetVal() ) > VALUE_TOLERANCE;
    };
 
-   auto remove = [this]( size_t index, bool leftLimit ) noexcept {
+   auto remove = [this, &points]( size_t index, bool leftLimit ) noexcept {
       // Assume array accesses are in-bounds
-      const auto &point = mEnv[ index ];
+      const auto &point = points[ index ];
       auto when = point.GetT();
       auto val = point.GetVal();
       Delete( index );  // try it to see if it's doing anything
@@ -602,7 +639,7 @@ void Envelope::RemoveUnneededPoints(
       }
    };
 
-   auto len = mEnv.size();
+   auto len = points.size();
 
    bool leftLimit =
       !rightward && startAt + 1 < len && isDiscontinuity( startAt );
@@ -640,6 +677,8 @@ void Envelope::RemoveUnneededPoints(
 std::pair< int, int > Envelope::ExpandRegion
    ( double t0, double tlen, double *pLeftVal, double *pRightVal )
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    // t0 is relative time
 
    double val = GetValueRelative( t0 );
@@ -656,9 +695,9 @@ std::pair< int, int > Envelope::ExpandRegion
    }
 
    // Shift points.
-   auto len = mEnv.size();
+   auto len = points.size();
    for ( unsigned int ii = index; ii < len; ++ii ) {
-      auto &point = mEnv[ ii ];
+      auto &point = points[ ii ];
       point.SetT( point.GetT() + tlen );
    }
 
@@ -699,20 +738,22 @@ void Envelope::InsertSpace( double t0, double tlen )
 
 int Envelope::Reassign(double when, double value)
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    when -= mOffset;
 
-   int len = mEnv.size();
+   int len = points.size();
    if (len == 0)
       return -1;
 
    int i = 0;
-   while (i < len && when > mEnv[i].GetT())
+   while (i < len && when > points[i].GetT())
       i++;
 
-   if (i >= len || when < mEnv[i].GetT())
+   if (i >= len || when < points[i].GetT())
       return -1;
 
-   mEnv[i].SetVal(this, value);
+   points[i].SetVal(this, value);
 
    ++mVersion;
 
@@ -722,7 +763,7 @@ int Envelope::Reassign(double when, double value)
 
 size_t Envelope::GetNumberOfPoints() const
 {
-   return mEnv.size();
+   return mEnv->size();
 }
 
 double Envelope::GetDefaultValue() const
@@ -739,13 +780,14 @@ void Envelope::GetPoints(double *bufferWhen,
                          double *bufferValue,
                          int bufferLen) const
 {
-   int n = mEnv.size();
+   const auto &points = *mEnv;
+   int n = points.size();
    if (n > bufferLen)
       n = bufferLen;
    int i;
    for (i = 0; i < n; i++) {
-      bufferWhen[i] = mEnv[i].GetT() - mOffset;
-      bufferValue[i] = mEnv[i].GetVal();
+      bufferWhen[i] = points[i].GetT() - mOffset;
+      bufferValue[i] = points[i].GetVal();
    }
 }
 
@@ -766,6 +808,8 @@ void Envelope::Cap( double sampleDur )
  */
 int Envelope::InsertOrReplaceRelative(double when, double value) noexcept
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
 #if defined(_DEBUG)
    // in debug builds, do a spot of argument checking
    if(when > mTrackLen + 0.0000001)
@@ -790,7 +834,7 @@ int Envelope::InsertOrReplaceRelative(double when, double value) noexcept
    if ( index < range.second )
       // modify existing
       // In case of a discontinuity, ALWAYS CHANGING LEFT LIMIT ONLY!
-      mEnv[ index ].SetVal( this, value );
+      points[ index ].SetVal( this, value );
    else
      // Add NEW
       Insert( index, EnvPoint { when, value } );
@@ -806,8 +850,8 @@ std::pair<int, int> Envelope::EqualRange(double when, double sampleDur)
    // by binary search; if empty, it still indicates where to
    // insert.
    const auto tolerance = sampleDur / 2;
-   auto begin = mEnv.begin();
-   auto end = mEnv.end();
+   auto begin = mEnv->begin();
+   auto end = mEnv->end();
    auto first = std::lower_bound(
       begin, end,
       EnvPoint{ when - tolerance, 0.0 },
@@ -831,6 +875,8 @@ void Envelope::SetOffset(double newOffset)
 /*! @excsafety{No-fail} */
 void Envelope::SetTrackLen( double trackLen, double sampleDur )
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    // Preserve the left-side limit at trackLen.
    auto range = EqualRange( trackLen, sampleDur );
    bool needPoint = ( range.first == range.second && trackLen < mTrackLen );
@@ -843,7 +889,7 @@ void Envelope::SetTrackLen( double trackLen, double sampleDur )
    // Shrink the array.
    // If more than one point already at the end, keep only the first of them.
    int newLen = std::min( 1 + range.first, range.second );
-   mEnv.resize( newLen );
+   points.resize( newLen );
 
    ++mVersion;
 
@@ -854,13 +900,15 @@ void Envelope::SetTrackLen( double trackLen, double sampleDur )
 /*! @excsafety{No-fail} */
 void Envelope::RescaleTimes( double newLength )
 {
+   auto writer = mEnv.Write();
+   auto &points = *writer;
    if ( mTrackLen == 0 ) {
-      for ( auto &point : mEnv )
+      for ( auto &point : points )
          point.SetT( 0 );
    }
    else {
       auto ratio = newLength / mTrackLen;
-      for ( auto &point : mEnv )
+      for ( auto &point : points )
          point.SetT( point.GetT() * ratio );
    }
    mTrackLen = newLength;
@@ -870,7 +918,9 @@ void Envelope::RescaleTimes( double newLength )
 
 void Envelope::RescaleTimesBy(double ratio)
 {
-   for (auto& point : mEnv)
+   auto writer = mEnv.Write();
+   auto &points = *writer;
+   for (auto& point : points)
       point.SetT(point.GetT() * ratio);
    if (mTrackLen != DBL_MAX)
       mTrackLen *= ratio;
@@ -890,22 +940,23 @@ double Envelope::GetValueRelative(double t, bool leftLimit) const noexcept
 {
    double temp;
 
-   GetValuesRelative(&temp, 1, t, 0.0, leftLimit);
+   GetValuesRelative(*mEnv, &temp, 1, t, 0.0, leftLimit);
    return temp;
 }
 
 // relative time
 /// @param Lo returns last index at or before this time, maybe -1
 /// @param Hi returns first index after this time, maybe past the end
-void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
+void Envelope::BinarySearchForTime(const EnvArray &points,
+   int &Lo, int &Hi, double t) const noexcept
 {
    // Optimizations for the usual pattern of repeated calls with
    // small increases of t.
    {
-      if (mSearchGuess >= 0 && mSearchGuess < (int)mEnv.size()) {
-         if (t >= mEnv[mSearchGuess].GetT() &&
-             (1 + mSearchGuess == (int)mEnv.size() ||
-              t < mEnv[1 + mSearchGuess].GetT())) {
+      if (mSearchGuess >= 0 && mSearchGuess < (int)points.size()) {
+         if (t >= points[mSearchGuess].GetT() &&
+             (1 + mSearchGuess == (int)points.size() ||
+              t < points[1 + mSearchGuess].GetT())) {
             Lo = mSearchGuess;
             Hi = 1 + mSearchGuess;
             return;
@@ -913,10 +964,10 @@ void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
       }
 
       ++mSearchGuess;
-      if (mSearchGuess >= 0 && mSearchGuess < (int)mEnv.size()) {
-         if (t >= mEnv[mSearchGuess].GetT() &&
-             (1 + mSearchGuess == (int)mEnv.size() ||
-              t < mEnv[1 + mSearchGuess].GetT())) {
+      if (mSearchGuess >= 0 && mSearchGuess < (int)points.size()) {
+         if (t >= points[mSearchGuess].GetT() &&
+             (1 + mSearchGuess == (int)points.size() ||
+              t < points[1 + mSearchGuess].GetT())) {
             Lo = mSearchGuess;
             Hi = 1 + mSearchGuess;
             return;
@@ -925,13 +976,13 @@ void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
    }
 
    Lo = -1;
-   Hi = mEnv.size();
+   Hi = points.size();
 
    // Invariants:  Lo is not less than -1, Hi not more than size
    while (Hi > (Lo + 1)) {
       int mid = (Lo + Hi) / 2;
       // mid must be strictly between Lo and Hi, therefore a valid index
-      if (t < mEnv[mid].GetT())
+      if (t < points[mid].GetT())
          Hi = mid;
       else
          Lo = mid;
@@ -944,17 +995,17 @@ void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
 // relative time
 /// @param Lo returns last index before this time, maybe -1
 /// @param Hi returns first index at or after this time, maybe past the end
-void Envelope::BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
-   const noexcept
+void Envelope::BinarySearchForTime_LeftLimit(const EnvArray &points,
+   int &Lo, int &Hi, double t) const noexcept
 {
    Lo = -1;
-   Hi = mEnv.size();
+   Hi = points.size();
 
    // Invariants:  Lo is not less than -1, Hi not more than size
    while (Hi > (Lo + 1)) {
       int mid = (Lo + Hi) / 2;
       // mid must be strictly between Lo and Hi, therefore a valid index
-      if (t <= mEnv[mid].GetT())
+      if (t <= points[mid].GetT())
          Hi = mid;
       else
          Lo = mid;
@@ -969,9 +1020,10 @@ void Envelope::BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
 /// or log interpolation.
 /// @param iPoint index in env array to look at.
 /// @return value there, or its (safe) log10.
-double Envelope::GetInterpolationStartValueAtPoint(int iPoint) const noexcept
+double Envelope::GetInterpolationStartValueAtPoint(
+   const EnvArray &points, int iPoint) const noexcept
 {
-   double v = mEnv[ iPoint ].GetVal();
+   double v = points[ iPoint ].GetVal();
    if( !mDB )
       return v;
    else
@@ -983,22 +1035,25 @@ void Envelope::GetValues( double *buffer, int bufferLen,
 {
    // Convert t0 from absolute to clip-relative time
    t0 -= mOffset;
-   GetValuesRelative( buffer, bufferLen, t0, tstep);
+   // Read one version of the points, even if another thread publishes a new
+   // one meanwhile
+   const auto pPoints = mEnv.Load();
+   GetValuesRelative( *pPoints, buffer, bufferLen, t0, tstep);
 }
 
-void Envelope::GetValuesRelative
-   (double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
+void Envelope::GetValuesRelative(const EnvArray &points,
+   double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
    const noexcept
 {
    // JC: If bufferLen ==0 we have probably just allocated a zero sized buffer.
    // wxASSERT( bufferLen > 0 );
 
    const auto epsilon = tstep / 2;
-   int len = mEnv.size();
+   int len = points.size();
 
    double t = t0;
    double increment = 0;
-   if ( len > 1 && t <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
+   if ( len > 1 && t <= points[0].GetT() && points[0].GetT() == points[1].GetT() )
       increment = leftLimit ? -epsilon : epsilon;
 
    double tprev, vprev, tnext = 0, vnext, vstep = 0;
@@ -1016,15 +1071,15 @@ void Envelope::GetValuesRelative
       auto tplus = t + increment;
 
       // IF before envelope THEN first value
-      if ( leftLimit ? tplus <= mEnv[0].GetT() : tplus < mEnv[0].GetT() ) {
-         buffer[b] = mEnv[0].GetVal();
+      if ( leftLimit ? tplus <= points[0].GetT() : tplus < points[0].GetT() ) {
+         buffer[b] = points[0].GetVal();
          t += tstep;
          continue;
       }
       // IF after envelope THEN last value
       if ( leftLimit
-            ? tplus > mEnv[len - 1].GetT() : tplus >= mEnv[len - 1].GetT() ) {
-         buffer[b] = mEnv[len - 1].GetVal();
+            ? tplus > points[len - 1].GetT() : tplus >= points[len - 1].GetT() ) {
+         buffer[b] = points[len - 1].GetVal();
          t += tstep;
          continue;
       }
@@ -1040,18 +1095,18 @@ void Envelope::GetValuesRelative
 
          int lo,hi;
          if ( leftLimit )
-            BinarySearchForTime_LeftLimit( lo, hi, tplus );
+            BinarySearchForTime_LeftLimit( points, lo, hi, tplus );
          else
-            BinarySearchForTime( lo, hi, tplus );
+            BinarySearchForTime( points, lo, hi, tplus );
 
-         // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
-         // mEnv[len - 1] is after tplus, therefore hi <= len - 1
+         // points[0] is before tplus because of eliminations above, therefore lo >= 0
+         // points[len - 1] is after tplus, therefore hi <= len - 1
          wxASSERT( lo >= 0 && hi <= len - 1 );
 
-         tprev = mEnv[lo].GetT();
-         tnext = mEnv[hi].GetT();
+         tprev = points[lo].GetT();
+         tnext = points[hi].GetT();
 
-         if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
+         if ( hi + 1 < len && tnext == points[ hi + 1 ].GetT() )
             // There is a discontinuity after this point-to-point interval.
             // Usually will stop evaluating in this interval when time is slightly
             // before tNext, then use the right limit.
@@ -1064,8 +1119,8 @@ void Envelope::GetValuesRelative
          else
             increment = 0;
 
-         vprev = GetInterpolationStartValueAtPoint( lo );
-         vnext = GetInterpolationStartValueAtPoint( hi );
+         vprev = GetInterpolationStartValueAtPoint( points, lo );
+         vnext = GetInterpolationStartValueAtPoint( points, hi );
 
          // Interpolate, either linear or log depending on mDB.
          double dt = (tnext - tprev);
@@ -1102,24 +1157,148 @@ void Envelope::GetValuesRelative
    }
 }
 
+bool Envelope::GetSegments( EnvelopeSegments &segments, size_t len,
+                            double t0, double tstep, size_t maxSize ) const
+{
+   // Convert t0 from absolute to clip-relative time
+   t0 -= mOffset;
+   const auto pPoints = mEnv.Load();
+   return GetSegmentsRelative( *pPoints, segments, len, t0, tstep, maxSize );
+}
+
+// Follows GetValuesRelative() without leftLimit, but finds the extent of each
+// point-to-point interval at once instead of stepping through it
+bool Envelope::GetSegmentsRelative(const EnvArray &points,
+   EnvelopeSegments &segments, size_t len, double t0, double tstep,
+   size_t maxSize) const
+{
+   const int nPoints = points.size();
+   // Checked before each append, even one that might merge
+   const auto full = [&]{ return segments.size() >= maxSize; };
+
+   // IF empty envelope THEN default value
+   if (nPoints <= 0) {
+      if (full())
+         return false;
+      AppendConstantEnvelopeSegment(segments, len, mDefaultValue);
+      return true;
+   }
+
+   const auto epsilon = tstep / 2;
+   double increment = 0;
+   if ( nPoints > 1 && t0 <= points[0].GetT() &&
+        points[0].GetT() == points[1].GetT() )
+      increment = epsilon;
+
+   // Times are computed from the sample number, not accumulated
+   const auto timeAt = [&](size_t b) { return t0 + b * tstep; };
+
+   // How many samples from b on come before limit, given the increment
+   const auto countBefore = [&](size_t b, double limit) -> size_t {
+      const auto before = [&](size_t bb) {
+         return timeAt(bb) + increment < limit; };
+      if (tstep <= 0)
+         return before(b) ? len - b : 0;
+      const auto estimate = std::ceil((limit - increment - timeAt(b)) / tstep);
+      auto count = static_cast<size_t>(
+         std::clamp(estimate, 0.0, static_cast<double>(len - b)));
+      // Correct for roundoff
+      while (count > 0 && !before(b + count - 1))
+         --count;
+      while (b + count < len && before(b + count))
+         ++count;
+      return count;
+   };
+
+   size_t b = 0;
+   while (b < len) {
+      const auto t = timeAt(b);
+      const auto tplus = t + increment;
+
+      // IF before envelope THEN first value
+      if ( tplus < points[0].GetT() ) {
+         const auto count = countBefore(b, points[0].GetT());
+         if (full())
+            return false;
+         AppendConstantEnvelopeSegment(segments, count, points[0].GetVal());
+         b += count;
+         continue;
+      }
+      // IF after envelope THEN last value
+      if ( tplus >= points[nPoints - 1].GetT() ) {
+         if (full())
+            return false;
+         AppendConstantEnvelopeSegment(
+            segments, len - b, points[nPoints - 1].GetVal());
+         break;
+      }
+
+      int lo, hi;
+      BinarySearchForTime( points, lo, hi, tplus );
+      wxASSERT( lo >= 0 && hi <= nPoints - 1 );
+
+      const auto tprev = points[lo].GetT();
+      const auto tnext = points[hi].GetT();
+
+      // See the discontinuity handling in GetValuesRelative()
+      if ( hi + 1 < nPoints && tnext == points[ hi + 1 ].GetT() )
+         increment = epsilon;
+      else
+         increment = 0;
+
+      const auto vprev = GetInterpolationStartValueAtPoint( points, lo );
+      const auto vnext = GetInterpolationStartValueAtPoint( points, hi );
+
+      // Interpolate, either linear or log depending on mDB.
+      const double dt = (tnext - tprev);
+      const double to = t - tprev;
+      double v, vstep;
+      if (dt > 0.0)
+      {
+         v = (vprev * (dt - to) + vnext * to) / dt;
+         vstep = (vnext - vprev) * tstep / dt;
+      }
+      else
+      {
+         v = vnext;
+         vstep = 0.0;
+      }
+
+      // An adjustment if logarithmic scale.
+      if( mDB )
+      {
+         v = pow(10.0, v);
+         vstep = pow( 10.0, vstep );
+      }
+
+      // The first sample is in this interval even if the increment changed
+      const auto count = 1 + countBefore(b + 1, tnext);
+      if (full())
+         return false;
+      segments.push_back({ count, v, vstep, mDB });
+      b += count;
+   }
+   return true;
+}
+
 // relative time
 int Envelope::NumberOfPointsAfter(double t) const
 {
    int lo,hi;
-   BinarySearchForTime( lo, hi, t );
+   BinarySearchForTime( *mEnv, lo, hi, t );
 
-   return mEnv.size() - hi;
+   return mEnv->size() - hi;
 }
 
 // relative time
 double Envelope::NextPointAfter(double t) const
 {
    int lo,hi;
-   BinarySearchForTime( lo, hi, t );
-   if (hi >= (int)mEnv.size())
+   BinarySearchForTime( *mEnv, lo, hi, t );
+   if (hi >= (int)mEnv->size())
       return t;
    else
-      return mEnv[hi].GetT();
+      return (*mEnv)[hi].GetT();
 }
 
 double Envelope::Average( double t0, double t1 ) const
@@ -1223,6 +1402,8 @@ static double SolveIntegrateInverseInterpolated(double y1, double y2, double tim
 // but make sure it gets reset when the envelope is changed.
 double Envelope::Integral( double t0, double t1 ) const
 {
+   const auto pPoints = mEnv.Load();
+   const auto &points = *pPoints;
    if(t0 == t1)
       return 0.0;
    if(t0 > t1)
@@ -1230,7 +1411,7 @@ double Envelope::Integral( double t0, double t1 ) const
       return -Integral(t1, t0); // this makes more sense than returning the default value
    }
 
-   unsigned int count = mEnv.size();
+   unsigned int count = points.size();
    if(count == 0) // 'empty' envelope
       return (t1 - t0) * mDefaultValue;
 
@@ -1239,25 +1420,25 @@ double Envelope::Integral( double t0, double t1 ) const
 
    double total = 0.0, lastT, lastVal;
    unsigned int i; // this is the next point to check
-   if(t0 < mEnv[0].GetT()) // t0 preceding the first point
+   if(t0 < points[0].GetT()) // t0 preceding the first point
    {
-      if(t1 <= mEnv[0].GetT())
-         return (t1 - t0) * mEnv[0].GetVal();
+      if(t1 <= points[0].GetT())
+         return (t1 - t0) * points[0].GetVal();
       i = 1;
-      lastT = mEnv[0].GetT();
-      lastVal = mEnv[0].GetVal();
+      lastT = points[0].GetT();
+      lastVal = points[0].GetVal();
       total += (lastT - t0) * lastVal;
    }
-   else if(t0 >= mEnv[count - 1].GetT()) // t0 at or following the last point
+   else if(t0 >= points[count - 1].GetT()) // t0 at or following the last point
    {
-      return (t1 - t0) * mEnv[count - 1].GetVal();
+      return (t1 - t0) * points[count - 1].GetVal();
    }
    else // t0 enclosed by points
    {
       // Skip any points that come before t0 using binary search
       int lo, hi;
-      BinarySearchForTime(lo, hi, t0);
-      lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
+      BinarySearchForTime(points, lo, hi, t0);
+      lastVal = InterpolatePoints(points[lo].GetVal(), points[hi].GetVal(), (t0 - points[lo].GetT()) / (points[hi].GetT() - points[lo].GetT()), mDB);
       lastT = t0;
       i = hi; // the point immediately after t0.
    }
@@ -1269,16 +1450,16 @@ double Envelope::Integral( double t0, double t1 ) const
       {
          return total + (t1 - lastT) * lastVal;
       }
-      else if(mEnv[i].GetT() >= t1) // this point follows the end of the range
+      else if(points[i].GetT() >= t1) // this point follows the end of the range
       {
-         double thisVal = InterpolatePoints(mEnv[i - 1].GetVal(), mEnv[i].GetVal(), (t1 - mEnv[i - 1].GetT()) / (mEnv[i].GetT() - mEnv[i - 1].GetT()), mDB);
+         double thisVal = InterpolatePoints(points[i - 1].GetVal(), points[i].GetVal(), (t1 - points[i - 1].GetT()) / (points[i].GetT() - points[i - 1].GetT()), mDB);
          return total + IntegrateInterpolated(lastVal, thisVal, t1 - lastT, mDB);
       }
       else // this point precedes the end of the range
       {
-         total += IntegrateInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
-         lastT = mEnv[i].GetT();
-         lastVal = mEnv[i].GetVal();
+         total += IntegrateInterpolated(lastVal, points[i].GetVal(), points[i].GetT() - lastT, mDB);
+         lastT = points[i].GetT();
+         lastVal = points[i].GetVal();
          i++;
       }
    }
@@ -1286,6 +1467,8 @@ double Envelope::Integral( double t0, double t1 ) const
 
 double Envelope::IntegralOfInverse( double t0, double t1 ) const
 {
+   const auto pPoints = mEnv.Load();
+   const auto &points = *pPoints;
    if(t0 == t1)
       return 0.0;
    if(t0 > t1)
@@ -1293,7 +1476,7 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
       return -IntegralOfInverse(t1, t0); // this makes more sense than returning the default value
    }
 
-   unsigned int count = mEnv.size();
+   unsigned int count = points.size();
    if(count == 0) // 'empty' envelope
       return (t1 - t0) / mDefaultValue;
 
@@ -1302,25 +1485,25 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
 
    double total = 0.0, lastT, lastVal;
    unsigned int i; // this is the next point to check
-   if(t0 < mEnv[0].GetT()) // t0 preceding the first point
+   if(t0 < points[0].GetT()) // t0 preceding the first point
    {
-      if(t1 <= mEnv[0].GetT())
-         return (t1 - t0) / mEnv[0].GetVal();
+      if(t1 <= points[0].GetT())
+         return (t1 - t0) / points[0].GetVal();
       i = 1;
-      lastT = mEnv[0].GetT();
-      lastVal = mEnv[0].GetVal();
+      lastT = points[0].GetT();
+      lastVal = points[0].GetVal();
       total += (lastT - t0) / lastVal;
    }
-   else if(t0 >= mEnv[count - 1].GetT()) // t0 at or following the last point
+   else if(t0 >= points[count - 1].GetT()) // t0 at or following the last point
    {
-      return (t1 - t0) / mEnv[count - 1].GetVal();
+      return (t1 - t0) / points[count - 1].GetVal();
    }
    else // t0 enclosed by points
    {
       // Skip any points that come before t0 using binary search
       int lo, hi;
-      BinarySearchForTime(lo, hi, t0);
-      lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
+      BinarySearchForTime(points, lo, hi, t0);
+      lastVal = InterpolatePoints(points[lo].GetVal(), points[hi].GetVal(), (t0 - points[lo].GetT()) / (points[hi].GetT() - points[lo].GetT()), mDB);
       lastT = t0;
       i = hi; // the point immediately after t0.
    }
@@ -1332,16 +1515,16 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
       {
          return total + (t1 - lastT) / lastVal;
       }
-      else if(mEnv[i].GetT() >= t1) // this point follows the end of the range
+      else if(points[i].GetT() >= t1) // this point follows the end of the range
       {
-         double thisVal = InterpolatePoints(mEnv[i - 1].GetVal(), mEnv[i].GetVal(), (t1 - mEnv[i - 1].GetT()) / (mEnv[i].GetT() - mEnv[i - 1].GetT()), mDB);
+         double thisVal = InterpolatePoints(points[i - 1].GetVal(), points[i].GetVal(), (t1 - points[i - 1].GetT()) / (points[i].GetT() - points[i - 1].GetT()), mDB);
          return total + IntegrateInverseInterpolated(lastVal, thisVal, t1 - lastT, mDB);
       }
       else // this point precedes the end of the range
       {
-         total += IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
-         lastT = mEnv[i].GetT();
-         lastVal = mEnv[i].GetVal();
+         total += IntegrateInverseInterpolated(lastVal, points[i].GetVal(), points[i].GetT() - lastT, mDB);
+         lastT = points[i].GetT();
+         lastVal = points[i].GetVal();
          i++;
       }
    }
@@ -1349,10 +1532,12 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
 
 double Envelope::SolveIntegralOfInverse( double t0, double area ) const
 {
+   const auto pPoints = mEnv.Load();
+   const auto &points = *pPoints;
    if(area == 0.0)
       return t0;
 
-   const auto count = mEnv.size();
+   const auto count = points.size();
    if(count == 0) // 'empty' envelope
       return t0 + area * mDefaultValue;
 
@@ -1362,42 +1547,42 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
       // Now we can safely assume t0 is relative time!
       double lastT, lastVal;
       int i; // this is the next point to check
-      if(t0 < mEnv[0].GetT()) // t0 preceding the first point
+      if(t0 < points[0].GetT()) // t0 preceding the first point
       {
          if (area < 0) {
-            return t0 + area * mEnv[0].GetVal();
+            return t0 + area * points[0].GetVal();
          }
          else {
             i = 1;
-            lastT = mEnv[0].GetT();
-            lastVal = mEnv[0].GetVal();
+            lastT = points[0].GetT();
+            lastVal = points[0].GetVal();
             double added = (lastT - t0) / lastVal;
             if(added >= area)
-               return t0 + area * mEnv[0].GetVal();
+               return t0 + area * points[0].GetVal();
             area -= added;
          }
       }
-      else if(t0 >= mEnv[count - 1].GetT()) // t0 at or following the last point
+      else if(t0 >= points[count - 1].GetT()) // t0 at or following the last point
       {
          if (area < 0) {
             i = (int)count - 2;
-            lastT = mEnv[count - 1].GetT();
-            lastVal = mEnv[count - 1].GetVal();
+            lastT = points[count - 1].GetT();
+            lastVal = points[count - 1].GetVal();
             double added = (lastT - t0) / lastVal; // negative
             if(added <= area)
-               return t0 + area * mEnv[count - 1].GetVal();
+               return t0 + area * points[count - 1].GetVal();
             area -= added;
          }
          else {
-            return t0 + area * mEnv[count - 1].GetVal();
+            return t0 + area * points[count - 1].GetVal();
          }
       }
       else // t0 enclosed by points
       {
          // Skip any points that come before t0 using binary search
          int lo, hi;
-         BinarySearchForTime(lo, hi, t0);
-         lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
+         BinarySearchForTime(points, lo, hi, t0);
+         lastVal = InterpolatePoints(points[lo].GetVal(), points[hi].GetVal(), (t0 - points[lo].GetT()) / (points[hi].GetT() - points[lo].GetT()), mDB);
          lastT = t0;
          if (area < 0)
             i = lo;
@@ -1411,12 +1596,12 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
          while (i >= 0)
          {
             double added =
-               -IntegrateInverseInterpolated(mEnv[i].GetVal(), lastVal, lastT - mEnv[i].GetT(), mDB);
+               -IntegrateInverseInterpolated(points[i].GetVal(), lastVal, lastT - points[i].GetT(), mDB);
             if(added <= area)
-               return lastT - SolveIntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), lastT - mEnv[i].GetT(), -area, mDB);
+               return lastT - SolveIntegrateInverseInterpolated(lastVal, points[i].GetVal(), lastT - points[i].GetT(), -area, mDB);
             area -= added;
-            lastT = mEnv[i].GetT();
-            lastVal = mEnv[i].GetVal();
+            lastT = points[i].GetT();
+            lastVal = points[i].GetVal();
             --i;
          }
          return lastT + area * lastVal;
@@ -1425,12 +1610,12 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
          // loop through the rest of the envelope points until we get to t1
          while (i < (int)count)
          {
-            double added = IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
+            double added = IntegrateInverseInterpolated(lastVal, points[i].GetVal(), points[i].GetT() - lastT, mDB);
             if(added >= area)
-               return lastT + SolveIntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, area, mDB);
+               return lastT + SolveIntegrateInverseInterpolated(lastVal, points[i].GetVal(), points[i].GetT() - lastT, area, mDB);
             area -= added;
-            lastT = mEnv[i].GetT();
-            lastVal = mEnv[i].GetVal();
+            lastT = points[i].GetT();
+            lastVal = points[i].GetVal();
             i++;
          }
          return lastT + area * lastVal;
@@ -13,8 +13,11 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <limits>
 #include <vector>
 
+#include "CopyOnWrite.h"
+#include "EnvelopeSegments.h"
 #include "XMLTagHandler.h"
 
 class wxRect;
@@ -104,6 +107,7 @@ public:
    // Newfangled XML file I/O
    bool HandleXMLTag(const std::string_view& tag, const AttributesList& attrs) override;
    XMLTagHandler *HandleXMLChild(const std::string_view& tag) override;
+   void HandleXMLEndTag(const std::string_view& tag) override;
    void WriteXML(XMLWriter &xmlFile) const /* not override */;
 
    // Handling Cut/Copy/Paste events
@@ -137,6 +141,17 @@ public:
     * more than one value in a row. */
    void GetValues(double *buffer, int len, double t0, double tstep) const;
 
+   /** \brief Get many envelope values at once, as segments.
+    *
+    * Appends segments of total length len to `segments`.  Between control
+    * points, values follow one law, so a long buffer needs few segments.
+    * The size of `segments` never exceeds `maxSize`, so nothing is allocated
+    * if that is within the capacity.
+    * @return false, leaving the segments incomplete, if more are needed */
+   bool GetSegments(EnvelopeSegments &segments, size_t len,
+      double t0, double tstep,
+      size_t maxSize = std::numeric_limits<size_t>::max()) const;
+
    // Guarantee an envelope point at the end of the domain.
    void Cap( double sampleDur );
 
@@ -148,9 +163,12 @@ private:
       ( size_t startAt, bool rightward, bool testNeighbors = true ) noexcept;
 
    double GetValueRelative(double t, bool leftLimit = false) const noexcept;
-   void GetValuesRelative
-      (double *buffer, int len, double t0, double tstep, bool leftLimit = false)
+   void GetValuesRelative(const EnvArray &points,
+      double *buffer, int len, double t0, double tstep, bool leftLimit = false)
       const noexcept;
+   bool GetSegmentsRelative(const EnvArray &points,
+      EnvelopeSegments &segments, size_t len, double t0, double tstep,
+      size_t maxSize) const;
    // relative time
    int NumberOfPointsAfter(double t) const;
    // relative time
@@ -163,7 +181,7 @@ public:
    double IntegralOfInverse( double t0, double t1 ) const;
    double SolveIntegralOfInverse( double t0, double area) const;
 
-   void Clear() { mEnv.clear(); }
+   void Clear() { mEnv.Reset({}); }
 
    /** \brief Add a point at a particular absolute time coordinate */
    int InsertOrReplace(double when, double value)
@@ -190,7 +208,7 @@ public:
    /** \brief Accessor for points */
    const EnvPoint &operator[] (int index) const
    {
-      return mEnv[index];
+      return (*mEnv)[index];
    }
 
    double GetDefaultValue() const;
@@ -227,13 +245,19 @@ private:
    void AddPointAtEnd( double t, double val );
    void CopyRange(const Envelope &orig, size_t begin, size_t end);
    // relative time
-   void BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept;
-   void BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
-      const noexcept;
-   double GetInterpolationStartValueAtPoint(int iPoint) const noexcept;
-
-   // The list of envelope control points.
-   EnvArray mEnv;
+   void BinarySearchForTime(const EnvArray &points,
+      int &Lo, int &Hi, double t) const noexcept;
+   void BinarySearchForTime_LeftLimit(const EnvArray &points,
+      int &Lo, int &Hi, double t) const noexcept;
+   double GetInterpolationStartValueAtPoint(
+      const EnvArray &points, int iPoint) const noexcept;
+
+   // The list of envelope control points, shared with copies of this
+   // envelope until either is changed.  Playback reads a published version
+   // while the main thread may make the next one.
+   CopyOnWrite<EnvArray> mEnv;
+   // Points read from XML, published when the envelope tag ends
+   EnvArray mLoadedPoints;
 
    /** \brief The time at which the envelope starts, i.e. the start offset */
    double mOffset { 0.0 };
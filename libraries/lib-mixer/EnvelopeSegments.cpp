@@ -0,0 +1,127 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file EnvelopeSegments.cpp
+
+**********************************************************************/
+#include "EnvelopeSegments.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+double EnvelopeSegment::ValueAt(size_t i) const
+{
+   return exponential
+      ? value * std::pow(step, static_cast<double>(i))
+      : value + step * i;
+}
+
+void AppendConstantEnvelopeSegment(
+   EnvelopeSegments &segments, size_t length, double value)
+{
+   if (length == 0)
+      return;
+   if (!segments.empty()) {
+      auto &last = segments.back();
+      if (last.IsConstant() && last.value == value) {
+         last.length += length;
+         return;
+      }
+   }
+   segments.push_back({ length, value, 0.0, false });
+}
+
+size_t EnvelopeSegmentsLength(const EnvelopeSegments &segments)
+{
+   return std::accumulate(segments.begin(), segments.end(), size_t{},
+      [](size_t sum, const EnvelopeSegment &segment){
+         return sum + segment.length; });
+}
+
+bool IsUnitEnvelope(const EnvelopeSegments &segments)
+{
+   return std::all_of(segments.begin(), segments.end(),
+      [](const EnvelopeSegment &segment){
+         return segment.IsConstant() && segment.value == 1.0; });
+}
+
+void ReverseEnvelopeSegments(EnvelopeSegments &segments)
+{
+   for (auto &segment : segments) {
+      if (segment.length == 0 || segment.IsConstant())
+         continue;
+      segment.value = segment.ValueAt(segment.length - 1);
+      segment.step = segment.exponential ? 1.0 / segment.step : -segment.step;
+   }
+   std::reverse(segments.begin(), segments.end());
+}
+
+void DropEnvelopeSegmentsFront(EnvelopeSegments &segments, size_t count)
+{
+   auto iter = segments.begin();
+   for (; iter != segments.end() && count > 0; ++iter) {
+      if (count < iter->length) {
+         iter->value = iter->ValueAt(count);
+         iter->length -= count;
+         break;
+      }
+      count -= iter->length;
+   }
+   segments.erase(segments.begin(), iter);
+}
+
+namespace {
+void ApplyConstant(float value, float *buffer, size_t length)
+{
+   for (size_t i = 0; i < length; ++i)
+      buffer[i] *= value;
+}
+
+void ApplyLinear(float value, float step, float *buffer, size_t length)
+{
+   for (size_t i = 0; i < length; ++i)
+      buffer[i] *= value + step * static_cast<float>(i);
+}
+
+void ApplyExponential(
+   double value, double step, float *buffer, size_t length)
+{
+   // Each block of values is the value at its start times the same powers of
+   // the step; only the start is accumulated, in double precision
+   constexpr size_t BlockSize = 16;
+   float powers[BlockSize];
+   double power = 1.0;
+   for (auto &p : powers) {
+      p = power;
+      power *= step;
+   }
+   size_t i = 0;
+   for (; i + BlockSize <= length; i += BlockSize) {
+      const float start = value;
+      for (size_t j = 0; j < BlockSize; ++j)
+         buffer[i + j] *= start * powers[j];
+      value *= power;
+   }
+   const float start = value;
+   for (size_t j = 0; i + j < length; ++j)
+      buffer[i + j] *= start * powers[j];
+}
+}
+
+void ApplyEnvelopeSegments(const EnvelopeSegments &segments, float *buffer)
+{
+   for (const auto &segment : segments) {
+      const auto length = segment.length;
+      if (segment.IsConstant()) {
+         if (segment.value != 1.0)
+            ApplyConstant(segment.value, buffer, length);
+      }
+      else if (segment.exponential)
+         ApplyExponential(segment.value, segment.step, buffer, length);
+      else
+         ApplyLinear(segment.value, segment.step, buffer, length);
+      buffer += length;
+   }
+}
@@ -0,0 +1,63 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file EnvelopeSegments.h
+  @brief Envelope values over a buffer, described as few linear or
+  exponential runs
+
+**********************************************************************/
+#ifndef __AUDACITY_ENVELOPE_SEGMENTS__
+#define __AUDACITY_ENVELOPE_SEGMENTS__
+
+#include <cstddef>
+#include <vector>
+
+//! A run of consecutive samples over which envelope values follow one linear
+//! or exponential law
+struct MIXER_API EnvelopeSegment final {
+   //! Number of samples
+   size_t length{};
+   //! Value at the first sample
+   double value{ 1.0 };
+   //! Difference of consecutive values if linear, their ratio if exponential
+   double step{ 0.0 };
+   bool exponential{ false };
+
+   bool IsConstant() const { return step == (exponential ? 1.0 : 0.0); }
+
+   //! Value at the i-th sample of the segment
+   double ValueAt(size_t i) const;
+};
+
+//! Envelope values of consecutive samples, in order
+using EnvelopeSegments = std::vector<EnvelopeSegment>;
+
+//! Append a run of constant value, extending the last segment if it is
+//! constant with the same value
+MIXER_API void AppendConstantEnvelopeSegment(
+   EnvelopeSegments &segments, size_t length, double value);
+
+//! @return the sum of the lengths
+MIXER_API size_t EnvelopeSegmentsLength(const EnvelopeSegments &segments);
+
+//! @return whether all values are 1
+MIXER_API bool IsUnitEnvelope(const EnvelopeSegments &segments);
+
+//! Change segments to describe the same values in the reverse order
+MIXER_API void ReverseEnvelopeSegments(EnvelopeSegments &segments);
+
+//! Remove the values of the first `count` samples
+MIXER_API void DropEnvelopeSegmentsFront(
+   EnvelopeSegments &segments, size_t count);
+
+//! Multiply each sample of `buffer` by the corresponding envelope value
+/*!
+ Values are computed in closed form within each segment, not accumulated
+ sample by sample, so that the loops vectorize.
+ @pre `buffer` has at least `EnvelopeSegmentsLength(segments)` samples
+ */
+MIXER_API void ApplyEnvelopeSegments(
+   const EnvelopeSegments &segments, float *buffer);
+
+#endif
@@ -65,6 +65,26 @@ double ComputeWarpFactor(const Envelope &env, double t0, double t1)
 
 }
 
+void MixerSource::ApplyEnvelope(unsigned nChannels, float *const buffers[],
+   size_t len, double t, bool backwards)
+{
+   if (mpSeq->GetEnvelopeSegments(
+      mEnvSegments, len, t, backwards, mEnvSegments.capacity())) {
+      if (!IsUnitEnvelope(mEnvSegments))
+         for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+            ApplyEnvelopeSegments(mEnvSegments, buffers[iChannel]);
+      return;
+   }
+
+   // Many control points in the buffer
+   mpSeq->GetEnvelopeValues(mEnvValues.data(), len, t, backwards);
+   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+      const auto pFloat = buffers[iChannel];
+      for (size_t i = 0; i < len; i++)
+         pFloat[i] *= mEnvValues[i];
+   }
+}
+
 size_t MixerSource::MixVariableRates(
    unsigned nChannels, const size_t maxOut, float *floatBuffers[])
 {
@@ -135,14 +155,8 @@ size_t MixerSource::MixVariableRates(
                // for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
                   // memset(dst[i], 0, sizeof(float) * getLen);
             }
-            mpSeq->GetEnvelopeValues(
-               mEnvValues.data(), getLen, (pos).as_double() / sequenceRate,
-               backwards);
-            for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-               const auto queue = mSampleQueue[iChannel].data();
-               for (decltype(getLen) i = 0; i < getLen; i++)
-                  queue[(queueLen) + i] *= mEnvValues[i];
-            }
+            ApplyEnvelope(nChannels, dst.data(), getLen,
+               (pos).as_double() / sequenceRate, backwards);
 
             if (backwards)
                pos -= getLen;
@@ -260,13 +274,8 @@ size_t MixerSource::MixSameRate(unsigned nChannels, const size_t maxOut,
       
    }
 
-   mpSeq->GetEnvelopeValues(mEnvValues.data(), slen, t, backwards);
-
-   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-      const auto pFloat = floatBuffers[iChannel];
-      for (size_t i = 0; i < slen; i++)
-         pFloat[i] *= mEnvValues[i]; // Track gain control will go here?
-   }
+   // Track gain control will go here?
+   ApplyEnvelope(nChannels, floatBuffers, slen, t, backwards);
 
    if (backwards)
       pos -= slen;
@@ -306,6 +315,7 @@ MixerSource::MixerSource(
    , mpMap{ pMap }
 {
    assert(mTimesAndSpeed);
+   mEnvSegments.reserve(sMaxEnvSegments);
    auto t0 = mTimesAndSpeed->mT0;
    mSamplePos = GetSequence().TimeToLongSamples(t0);
    MakeResamplers();
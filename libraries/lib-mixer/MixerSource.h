@@ -15,6 +15,7 @@
 #define __AUDACITY_MIXER_SOURCE__
 
 #include "AudioGraphSource.h"
+#include "EnvelopeSegments.h"
 #include "MixerOptions.h"
 #include "SampleCount.h"
 #include <memory>
@@ -79,6 +80,14 @@ private:
     */
    static constexpr size_t sQueueMaxLen = 65536;
 
+   //! Capacity for envelope segments, reserved so that fetching them does
+   //! not allocate; buffers that need more get per-sample values instead
+   static constexpr size_t sMaxEnvSegments = 256;
+
+   //! Multiply buffers of `len` samples from time `t` by the gain envelope
+   void ApplyEnvelope(unsigned nChannels, float *const buffers[], size_t len,
+      double t, bool backwards);
+
    /*!
     Assume floatBuffers has extent nChannels
     @post result: `result <= maxOut`
@@ -127,7 +136,11 @@ private:
    const ResampleParameters mResampleParameters;
    std::vector<std::unique_ptr<Resample>> mResample;
 
-   //! Gain envelopes are applied to input before other transformations
+   //! Gain envelopes are applied to input before other transformations,
+   //! as segments if few enough describe them
+   EnvelopeSegments mEnvSegments;
+   //! Otherwise as values, one for each sample of the largest block that may
+   //! be fetched at once
    std::vector<double> mEnvValues;
 
    //! many-to-one mixing of channels
@@ -11,6 +11,7 @@ Paul Licameli split from SampleFrame.h
 #define __AUDACITY_WIDE_SAMPLE_SEQUENCE_
 
 #include "AudioGraphChannel.h"
+#include "EnvelopeSegments.h"
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
@@ -126,6 +127,20 @@ public:
     */
    virtual void GetEnvelopeValues(
       double* buffer, size_t bufferLen, double t0, bool backwards) const = 0;
+
+   //! Fetch the same envelope values as GetEnvelopeValues(), but as segments
+   /*!
+    Replaces the contents of `segments` with segments of total length
+    `bufferLen`, never more than `maxSize` of them, so that nothing is
+    allocated if that is within the capacity
+    @param backwards if true, fetch values in reverse order, from `t0` to
+       `t0 - bufferLen / rate`
+    @return false, leaving the segments incomplete, if more are needed; then
+       use GetEnvelopeValues()
+    */
+   virtual bool GetEnvelopeSegments(
+      EnvelopeSegments& segments, size_t bufferLen, double t0,
+      bool backwards, size_t maxSize) const = 0;
 };
 
 #endif
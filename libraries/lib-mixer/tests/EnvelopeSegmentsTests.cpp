@@ -0,0 +1,163 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EnvelopeSegmentsTests.cpp
+
+**********************************************************************/
+#include "Envelope.h"
+#include "EnvelopeSegments.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr auto Rate = 44100.0;
+constexpr auto Step = 1.0 / Rate;
+
+std::vector<double> Expand(const EnvelopeSegments& segments)
+{
+   std::vector<double> values;
+   for (const auto& segment : segments)
+      for (size_t i = 0; i < segment.length; ++i)
+         values.push_back(segment.ValueAt(i));
+   return values;
+}
+
+void RequireClose(const std::vector<double>& a, const std::vector<double>& b)
+{
+   REQUIRE(a.size() == b.size());
+   for (size_t i = 0; i < a.size(); ++i)
+   {
+      INFO(i);
+      REQUIRE(a[i] == Approx(b[i]).epsilon(1e-6));
+   }
+}
+} // namespace
+
+TEST_CASE("Envelope::GetSegments")
+{
+   const auto exponential = GENERATE(false, true);
+   Envelope envelope { exponential, 1e-7, 2.0, 1.0 };
+   envelope.SetOffset(0.5);
+   envelope.SetTrackLen(10.0);
+
+   SECTION("Empty envelope gives one segment of the default value")
+   {
+      EnvelopeSegments segments;
+      envelope.GetSegments(segments, 1000, 0.0, Step);
+      REQUIRE(segments.size() == 1);
+      REQUIRE(segments[0].length == 1000);
+      REQUIRE(segments[0].value == 1.0);
+      REQUIRE(segments[0].IsConstant());
+   }
+
+   SECTION("Segments give the same values as GetValues")
+   {
+      envelope.InsertOrReplace(1.0, 0.5);
+      envelope.InsertOrReplace(2.0, 1.5);
+      // A discontinuity
+      envelope.InsertOrReplace(3.0, 0.25);
+      envelope.Insert(3.0, 1.0);
+      envelope.InsertOrReplace(4.0, 0.1);
+
+      const auto t0 = GENERATE(0.0, 1.2, 2.999, 4.5);
+      const size_t length = 5 * Rate;
+      std::vector<double> values(length);
+      envelope.GetValues(values.data(), length, t0, Step);
+
+      EnvelopeSegments segments;
+      envelope.GetSegments(segments, length, t0, Step);
+      // One per interval, and constant segments at the ends
+      REQUIRE(segments.size() <= 6);
+      RequireClose(Expand(segments), values);
+   }
+
+   SECTION("Segments stay within the given size")
+   {
+      for (int i = 0; i < 50; ++i)
+         envelope.InsertOrReplace(0.5 + 0.01 * i, 1.0 + (i % 2));
+      const size_t length = Rate;
+
+      EnvelopeSegments segments;
+      segments.reserve(10);
+      const auto data = segments.data();
+      REQUIRE(!envelope.GetSegments(segments, length, 0.0, Step, 10));
+      REQUIRE(segments.size() <= 10);
+      REQUIRE(segments.data() == data);
+
+      segments.clear();
+      REQUIRE(envelope.GetSegments(segments, length, 0.0, Step, 60));
+      REQUIRE(segments.size() <= 60);
+      std::vector<double> values(length);
+      envelope.GetValues(values.data(), length, 0.0, Step);
+      RequireClose(Expand(segments), values);
+   }
+}
+
+TEST_CASE("EnvelopeSegments")
+{
+   const EnvelopeSegments segments {
+      { 37, 0.5, 0.0, false },
+      { 100, 0.5, 0.01, false },
+      { 1000, 1.5, 0.999, true },
+      { 3, 1.0, 0.0, false },
+   };
+
+   SECTION("ApplyEnvelopeSegments multiplies by the values")
+   {
+      const auto values = Expand(segments);
+      std::vector<float> buffer(values.size());
+      for (size_t i = 0; i < buffer.size(); ++i)
+         buffer[i] = std::sin(0.01 * i);
+      auto expected = buffer;
+      for (size_t i = 0; i < buffer.size(); ++i)
+         expected[i] *= values[i];
+
+      ApplyEnvelopeSegments(segments, buffer.data());
+      for (size_t i = 0; i < buffer.size(); ++i)
+      {
+         INFO(i);
+         REQUIRE(buffer[i] == Approx(expected[i]).margin(1e-6));
+      }
+   }
+
+   SECTION("ReverseEnvelopeSegments reverses the values")
+   {
+      auto reversed = segments;
+      ReverseEnvelopeSegments(reversed);
+      auto values = Expand(segments);
+      std::reverse(values.begin(), values.end());
+      RequireClose(Expand(reversed), values);
+   }
+
+   SECTION("DropEnvelopeSegmentsFront drops values")
+   {
+      const auto count = GENERATE(0, 36, 37, 500, 1140);
+      auto dropped = segments;
+      DropEnvelopeSegmentsFront(dropped, count);
+      const auto values = Expand(segments);
+      RequireClose(
+         Expand(dropped),
+         std::vector<double>(values.begin() + count, values.end()));
+   }
+
+   SECTION("Constant segments are merged")
+   {
+      EnvelopeSegments merged;
+      AppendConstantEnvelopeSegment(merged, 10, 1.0);
+      AppendConstantEnvelopeSegment(merged, 0, 2.0);
+      AppendConstantEnvelopeSegment(merged, 20, 1.0);
+      REQUIRE(merged.size() == 1);
+      REQUIRE(EnvelopeSegmentsLength(merged) == 30);
+      REQUIRE(IsUnitEnvelope(merged));
+      AppendConstantEnvelopeSegment(merged, 5, 0.5);
+      REQUIRE(merged.size() == 2);
+      REQUIRE(!IsUnitEnvelope(merged));
+   }
+}
@@ -24,7 +24,11 @@ for shared and private configs - which need to move out.
 
 
 #include <algorithm>
+#include <optional>
+#include <string>
 
+#include <wx/file.h>
+#include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/tokenzr.h>
 
@@ -37,6 +41,7 @@ for shared and private configs - which need to move out.
 #include "ModuleManager.h"
 #include "PlatformCompatibility.h"
 #include "Base64.h"
+#include "PluginRegistrySnapshot.h"
 #include "Variant.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -538,10 +543,186 @@ bool PluginManager::DropFile(const wxString &fileName)
    return false;
 }
 
+namespace {
+// Providers load first, so that plug-ins may find them
+constexpr PluginType LoadOrder[] {
+   PluginTypeModule,
+   PluginTypeEffect,
+   PluginTypeAudacityCommand,
+   PluginTypeExporter,
+   PluginTypeImporter,
+   PluginTypeStub,
+};
+
+std::string ToUTF8(const wxString &str)
+{
+   return str.ToStdString(wxConvUTF8);
+}
+
+//! Read the values of all plug-in groups of one type that LoadGroup uses
+std::vector<PluginRegistryRecord>
+ReadGroup(audacity::BasicSettings &registry, PluginType type)
+{
+   const auto readString = [&](const wxString &key)
+      -> std::optional<std::string>
+   {
+      wxString value;
+      if (!registry.Read(key, &value))
+         return {};
+      return ToUTF8(value);
+   };
+   const auto readBool = [&](const wxString &key) -> std::optional<bool>
+   {
+      bool value;
+      if (!registry.Read(key, &value))
+         return {};
+      return value;
+   };
+
+   std::vector<PluginRegistryRecord> records;
+   wxString cfgPath = REGROOT + PluginManager::GetPluginTypeString(type) + wxCONFIG_PATH_SEPARATOR;
+
+   const auto cfgGroup = registry.BeginGroup(cfgPath);
+   for(const auto& group : registry.GetChildGroups())
+   {
+      const auto effectGroup = registry.BeginGroup(group);
+      auto &record = records.emplace_back();
+      record.group = ToUTF8(group);
+      record.providerID = readString(KEY_PROVIDERID).value_or(std::string{});
+      record.path = readString(KEY_PATH).value_or(std::string{});
+      record.symbol = readString(KEY_SYMBOL);
+      record.version = readString(KEY_VERSION);
+      record.vendor = readString(KEY_VENDOR);
+      record.enabled = readBool(KEY_ENABLED).value_or(false);
+      record.valid = readBool(KEY_VALID).value_or(false);
+      if (type == PluginTypeEffect) {
+         record.effectType = readString(KEY_EFFECTTYPE);
+         record.effectFamily = readString(KEY_EFFECTFAMILY);
+         record.effectDefault = readBool(KEY_EFFECTDEFAULT);
+         record.effectInteractive = readBool(KEY_EFFECTINTERACTIVE);
+         record.effectRealtime = readString(KEY_EFFECTREALTIME);
+         record.effectAutomatable = readBool(KEY_EFFECTAUTOMATABLE);
+      }
+      else if (type == PluginTypeImporter) {
+         record.importerIdent = readString(KEY_IMPORTERIDENT);
+         record.importerExtensions = readString(KEY_IMPORTEREXTENSIONS);
+      }
+   }
+   return records;
+}
+
+FilePath RegistrySnapshotPath(const FilePath &registryPath)
+{
+   return registryPath + wxT(".snapshot");
+}
+
+std::optional<std::string> ReadWholeFile(const FilePath &path)
+{
+   if (!wxFileExists(path))
+      return {};
+   wxFile file;
+   if (!file.Open(path))
+      return {};
+   const auto length = file.Length();
+   if (length < 0)
+      return {};
+   std::string contents(static_cast<size_t>(length), '\0');
+   if (file.Read(contents.data(), contents.size()) != length)
+      return {};
+   return contents;
+}
+
+//! Coarsest resolution of file modification times, in milliseconds, as on FAT
+constexpr wxLongLong_t RegistryTimeResolution = 2000;
+
+//! Failures only cost the speed of the next Load()
+void WriteSnapshotFile(const FilePath &path, const std::string &bytes)
+{
+   // Write a temporary file and rename it, so that an interrupted write
+   // leaves no truncated snapshot
+   const auto tempPath = path + wxT(".tmp");
+   bool written = false;
+   {
+      wxFile file;
+      written = file.Create(tempPath, true) &&
+         file.Write(bytes.data(), bytes.size()) == bytes.size() &&
+         file.Close();
+   }
+   if (!written || !wxRenameFile(tempPath, path, true))
+      wxRemoveFile(tempPath);
+}
+
+//! @return a snapshot, if there is one that matches the text registry
+std::optional<PluginRegistrySnapshot>
+ReadRegistrySnapshot(const FilePath &registryPath)
+{
+   const auto bytes = ReadWholeFile(RegistrySnapshotPath(registryPath));
+   if (!bytes)
+      return {};
+   auto snapshot = PluginRegistrySnapshot::Deserialize(*bytes);
+   if (!snapshot)
+      return {};
+
+   // Compare the size and time, which need no reading
+   const wxFileName fileName{ registryPath };
+   const auto modified = fileName.GetModificationTime();
+   if (!modified.IsValid() ||
+       modified.GetValue().GetValue() != snapshot->stamp.modified ||
+       fileName.GetSize().GetValue() != snapshot->stamp.size)
+      return {};
+
+   // Times may be as coarse as two seconds.  A registry rewritten within the
+   // same tick as the stamp was taken could keep its time and size, so only
+   // when the snapshot was written well after the stamp do they suffice.
+   // Otherwise compare the contents too, and if they match, write the
+   // snapshot again, so that later loads need not.
+   const auto snapshotPath = RegistrySnapshotPath(registryPath);
+   const auto written = wxFileName{ snapshotPath }.GetModificationTime();
+   if (written.IsValid() &&
+       written.GetValue().GetValue() - snapshot->stamp.modified >=
+          RegistryTimeResolution)
+      return snapshot;
+
+   const auto contents = ReadWholeFile(registryPath);
+   if (!contents ||
+       PluginRegistrySnapshot::Hash(*contents) != snapshot->stamp.hash)
+      return {};
+   WriteSnapshotFile(snapshotPath, *bytes);
+
+   return snapshot;
+}
+
+//! Stamp the snapshot with the present state of the text registry and write
+//! it; failures only cost the speed of the next Load()
+void WriteRegistrySnapshot(
+   const FilePath &registryPath, PluginRegistrySnapshot snapshot)
+{
+   const auto contents = ReadWholeFile(registryPath);
+   const auto modified = wxFileName{ registryPath }.GetModificationTime();
+   if (!contents || !modified.IsValid())
+      return;
+   snapshot.stamp = { contents->size(), modified.GetValue().GetValue(),
+      PluginRegistrySnapshot::Hash(*contents) };
+
+   WriteSnapshotFile(RegistrySnapshotPath(registryPath), snapshot.Serialize());
+}
+}
+
 void PluginManager::Load()
 {
+   const auto registryPath = FileNames::PluginRegistry();
+
+   // Skip parsing the text registry if it did not change since the last
+   // snapshot
+   if (auto snapshot = ReadRegistrySnapshot(registryPath)) {
+      mRegver = wxString::FromUTF8(snapshot->version);
+      for (const auto &group : snapshot->groups)
+         LoadGroup(group.records, static_cast<PluginType>(group.type));
+      return;
+   }
+
    // Create/Open the registry
-   auto pRegistry = sFactory(FileNames::PluginRegistry());
+   auto pRegistry = sFactory(registryPath);
    auto &registry = *pRegistry;
 
    // If this group doesn't exist then we have something that's not a registry.
@@ -603,20 +784,20 @@ void PluginManager::Load()
       registry.Flush();
    }
 
-   // Load all provider plugins first
-   LoadGroup(&registry, PluginTypeModule);
-
-   // Now the rest
-   LoadGroup(&registry, PluginTypeEffect);
-   LoadGroup(&registry, PluginTypeAudacityCommand );
-   LoadGroup(&registry, PluginTypeExporter);
-   LoadGroup(&registry, PluginTypeImporter);
-
-   LoadGroup(&registry, PluginTypeStub);
+   PluginRegistrySnapshot snapshot;
+   snapshot.version = ToUTF8(mRegver);
+   for (const auto type : LoadOrder) {
+      auto &group = snapshot.groups.emplace_back();
+      group.type = type;
+      group.records = ReadGroup(registry, type);
+      LoadGroup(group.records, type);
+   }
+   WriteRegistrySnapshot(registryPath, std::move(snapshot));
    return;
 }
 
-void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType type)
+void PluginManager::LoadGroup(
+   const std::vector<PluginRegistryRecord> &records, PluginType type)
 {
 #ifdef __WXMAC__
    // Bug 1590: On Mac, we should purge the registry of Nyquist plug-ins
@@ -652,17 +833,11 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
    auto AcceptPath = [](const wxString&){ return true; };
 #endif
 
-   wxString strVal;
-   bool boolVal;
-   wxString cfgPath = REGROOT + GetPluginTypeString(type) + wxCONFIG_PATH_SEPARATOR;
-
-   const auto cfgGroup = pRegistry->BeginGroup(cfgPath);
-   for(const auto& group : pRegistry->GetChildGroups())
+   for (const auto &record : records)
    {
       PluginDescriptor plug;
-      const auto effectGroup = pRegistry->BeginGroup(group);
 
-      auto groupName = ConvertID(group);
+      auto groupName = ConvertID(wxString::FromUTF8(record.group));
 
       // Bypass group if the ID is already in use
       if (mRegisteredPlugins.count(groupName))
@@ -672,23 +847,16 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
       plug.SetID(groupName);
       plug.SetPluginType(type);
 
-      // Get the provider ID and bypass group if not found
-      if (!pRegistry->Read(KEY_PROVIDERID, &strVal, {}))
-      {
-         // Bypass group if the provider isn't valid
-         if (!strVal.empty() && !mRegisteredPlugins.count(strVal))
-            continue;
-      }
-      plug.SetProviderID(PluginID(strVal));
+      plug.SetProviderID(PluginID(wxString::FromUTF8(record.providerID)));
 
       // Get the path (optional)
-      pRegistry->Read(KEY_PATH, &strVal, {});
-      if (!AcceptPath(strVal))
+      const auto path = wxString::FromUTF8(record.path);
+      if (!AcceptPath(path))
          // Ignore the obsolete path in the config file, during session,
          // but don't remove it from the file.  Maybe you really want to
          // switch back to the other version of Audacity and lose nothing.
          continue;
-      plug.SetPath(strVal);
+      plug.SetPath(path);
 
       /*
        // PRL: Ignore names  written in configs before 2.3.0!
@@ -707,27 +875,27 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
       // Note, KEY_SYMBOL started getting written to config files in 2.1.0.
       // KEY_NAME (now ignored) was written before that, but only for VST
       // effects.
-      if (!pRegistry->Read(KEY_SYMBOL, &strVal))
+      if (!record.symbol)
          continue;
 
       // Related to Bug2778: config file only remembered an internal name,
       // so this symbol may not contain the correct TranslatableString.
       // See calls to IsPluginRegistered which can correct that.
-      plug.SetSymbol(strVal);
+      plug.SetSymbol(wxString::FromUTF8(*record.symbol));
 
       // Get the version and bypass group if not found
-      if (!pRegistry->Read(KEY_VERSION, &strVal))
+      if (!record.version)
       {
          continue;
       }
-      plug.SetVersion(strVal);
+      plug.SetVersion(wxString::FromUTF8(*record.version));
 
       // Get the vendor and bypass group if not found
-      if (!pRegistry->Read(KEY_VENDOR, &strVal))
+      if (!record.vendor)
       {
          continue;
       }
-      plug.SetVendor( strVal );
+      plug.SetVendor(wxString::FromUTF8(*record.vendor));
 
 #if 0
       // This was done before version 2.2.2, but the value was not really used
@@ -743,12 +911,10 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
 #endif
 
       // Is it enabled...default to no if not found
-      pRegistry->Read(KEY_ENABLED, &boolVal, false);
-      plug.SetEnabled(boolVal);
+      plug.SetEnabled(record.enabled);
 
       // Is it valid...default to no if not found
-      pRegistry->Read(KEY_VALID, &boolVal, false);
-      plug.SetValid(boolVal);
+      plug.SetValid(record.valid);
 
       switch (type)
       {
@@ -761,9 +927,10 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
          case PluginTypeEffect:
          {
             // Get the effect type and bypass group if not found
-            if (!pRegistry->Read(KEY_EFFECTTYPE, &strVal))
+            if (!record.effectType)
                continue;
 
+            const auto strVal = wxString::FromUTF8(*record.effectType);
             if (strVal == KEY_EFFECTTYPE_NONE)
                plug.SetEffectType(EffectTypeNone);
             else if (strVal == KEY_EFFECTTYPE_ANALYZE)
@@ -780,58 +947,61 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
                continue;
 
             // Get the effect family and bypass group if not found
-            if (!pRegistry->Read(KEY_EFFECTFAMILY, &strVal))
+            if (!record.effectFamily)
             {
                continue;
             }
-            plug.SetEffectFamily(strVal);
+            plug.SetEffectFamily(wxString::FromUTF8(*record.effectFamily));
 
             // Is it a default (above the line) effect and bypass group if not found
-            if (!pRegistry->Read(KEY_EFFECTDEFAULT, &boolVal))
+            if (!record.effectDefault)
             {
                continue;
             }
-            plug.SetEffectDefault(boolVal);
+            plug.SetEffectDefault(*record.effectDefault);
 
             // Is it an interactive effect and bypass group if not found
-            if (!pRegistry->Read(KEY_EFFECTINTERACTIVE, &boolVal))
+            if (!record.effectInteractive)
             {
                continue;
             }
-            plug.SetEffectInteractive(boolVal);
+            plug.SetEffectInteractive(*record.effectInteractive);
 
             // Is it a realtime capable effect and bypass group if not found
-            if (!pRegistry->Read(KEY_EFFECTREALTIME, &strVal))
+            if (!record.effectRealtime)
             {
                continue;
             }
-            plug.DeserializeRealtimeSupport(strVal);
+            plug.DeserializeRealtimeSupport(
+               wxString::FromUTF8(*record.effectRealtime));
 
             // Does the effect support automation...bypass group if not found
-            if (!pRegistry->Read(KEY_EFFECTAUTOMATABLE, &boolVal))
+            if (!record.effectAutomatable)
             {
                continue;
             }
-            plug.SetEffectAutomatable(boolVal);
+            plug.SetEffectAutomatable(*record.effectAutomatable);
          }
          break;
 
          case PluginTypeImporter:
          {
             // Get the importer identifier and bypass group if not found
-            if (!pRegistry->Read(KEY_IMPORTERIDENT, &strVal))
+            if (!record.importerIdent)
             {
                continue;
             }
-            plug.SetImporterIdentifier(strVal);
+            plug.SetImporterIdentifier(
+               wxString::FromUTF8(*record.importerIdent));
 
             // Get the importer extensions and bypass group if not found
-            if (!pRegistry->Read(KEY_IMPORTEREXTENSIONS, &strVal))
+            if (!record.importerExtensions)
             {
                continue;
             }
             FileExtensions extensions;
-            wxStringTokenizer tkr(strVal, wxT(":"));
+            wxStringTokenizer tkr(
+               wxString::FromUTF8(*record.importerExtensions), wxT(":"));
             while (tkr.HasMoreTokens())
             {
                extensions.push_back(tkr.GetNextToken());
@@ -869,25 +1039,29 @@ void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType typ
 void PluginManager::Save()
 {
    // Create/Open the registry
-   auto pRegistry = sFactory(FileNames::PluginRegistry());
+   const auto registryPath = FileNames::PluginRegistry();
+   auto pRegistry = sFactory(registryPath);
    auto &registry = *pRegistry;
 
    // Clear pluginregistry.cfg (not audacity.cfg)
    registry.Clear();
 
+   std::map<PluginType, std::vector<PluginRegistryRecord>> records;
+
    // Save the individual groups
-   SaveGroup(&registry, PluginTypeEffect);
-   SaveGroup(&registry, PluginTypeExporter);
-   SaveGroup(&registry, PluginTypeAudacityCommand);
-   SaveGroup(&registry, PluginTypeImporter);
-   SaveGroup(&registry, PluginTypeStub);
+   records[PluginTypeEffect] = SaveGroup(&registry, PluginTypeEffect);
+   records[PluginTypeExporter] = SaveGroup(&registry, PluginTypeExporter);
+   records[PluginTypeAudacityCommand] =
+      SaveGroup(&registry, PluginTypeAudacityCommand);
+   records[PluginTypeImporter] = SaveGroup(&registry, PluginTypeImporter);
+   records[PluginTypeStub] = SaveGroup(&registry, PluginTypeStub);
 
    // Not used by 2.1.1 or greater, but must save to allow users to switch between 2.1.0
    // and 2.1.1+.  This should be removed after a few releases past 2.1.0.
    //SaveGroup(&registry, PluginTypeNone);
 
    // And now the providers
-   SaveGroup(&registry, PluginTypeModule);
+   records[PluginTypeModule] = SaveGroup(&registry, PluginTypeModule);
 
    // Write the version string
    registry.Write(REGVERKEY, REGVERCUR);
@@ -896,6 +1070,13 @@ void PluginManager::Save()
    registry.Flush();
 
    mRegver = REGVERCUR;
+
+   // Snapshot what was written, for the next Load()
+   PluginRegistrySnapshot snapshot;
+   snapshot.version = ToUTF8(mRegver);
+   for (const auto type : LoadOrder)
+      snapshot.groups.push_back({ type, std::move(records[type]) });
+   WriteRegistrySnapshot(registryPath, std::move(snapshot));
 }
 
 void PluginManager::NotifyPluginsChanged()
@@ -927,8 +1108,10 @@ void PluginManager::StoreCustomPaths(const PluginProvider& provider, const Plugi
    mSettings->Write(key, wxJoin(wxarr, ';'));
 }
 
-void PluginManager::SaveGroup(audacity::BasicSettings *pRegistry, PluginType type)
+std::vector<PluginRegistryRecord>
+PluginManager::SaveGroup(audacity::BasicSettings *pRegistry, PluginType type)
 {
+   std::vector<PluginRegistryRecord> records;
    wxString group = GetPluginTypeString(type);
    for (auto &pair : mRegisteredPlugins) {
       auto & plug = pair.second;
@@ -938,24 +1121,36 @@ void PluginManager::SaveGroup(audacity::BasicSettings *pRegistry, PluginType typ
          continue;
       }
 
-      const auto pluginGroup = pRegistry->BeginGroup(REGROOT + group + wxCONFIG_PATH_SEPARATOR + ConvertID(plug.GetID()));
+      // Record the same values that LoadGroup would read back
+      auto &record = records.emplace_back();
+      const auto id = ConvertID(plug.GetID());
+      record.group = ToUTF8(id);
+
+      const auto pluginGroup = pRegistry->BeginGroup(REGROOT + group + wxCONFIG_PATH_SEPARATOR + id);
 
       pRegistry->Write(KEY_PATH, plug.GetPath());
+      record.path = ToUTF8(plug.GetPath());
 
       // See comments with the corresponding load-time call to SetSymbol().
       pRegistry->Write(KEY_SYMBOL, plug.GetSymbol().Internal());
+      record.symbol = ToUTF8(plug.GetSymbol().Internal());
 
       // PRL:  Writing KEY_NAME which is no longer read, but older Audacity
       // versions expect to find it.
       pRegistry->Write(KEY_NAME, plug.GetSymbol().Msgid().MSGID());
 
       pRegistry->Write(KEY_VERSION, plug.GetUntranslatedVersion());
+      record.version = ToUTF8(plug.GetUntranslatedVersion());
       pRegistry->Write(KEY_VENDOR, plug.GetVendor());
+      record.vendor = ToUTF8(plug.GetVendor());
       // Write a blank -- see comments in LoadGroup:
       pRegistry->Write(KEY_DESCRIPTION, wxString{});
       pRegistry->Write(KEY_PROVIDERID, plug.GetProviderID());
+      record.providerID = ToUTF8(plug.GetProviderID());
       pRegistry->Write(KEY_ENABLED, plug.IsEnabled());
+      record.enabled = plug.IsEnabled();
       pRegistry->Write(KEY_VALID, plug.IsValid());
+      record.valid = plug.IsValid();
 
       switch (type)
       {
@@ -985,12 +1180,20 @@ void PluginManager::SaveGroup(audacity::BasicSettings *pRegistry, PluginType typ
             pRegistry->Write(KEY_EFFECTINTERACTIVE, plug.IsEffectInteractive());
             pRegistry->Write(KEY_EFFECTREALTIME, plug.SerializeRealtimeSupport());
             pRegistry->Write(KEY_EFFECTAUTOMATABLE, plug.IsEffectAutomatable());
+
+            record.effectType = ToUTF8(stype);
+            record.effectFamily = ToUTF8(plug.GetEffectFamily());
+            record.effectDefault = plug.IsEffectDefault();
+            record.effectInteractive = plug.IsEffectInteractive();
+            record.effectRealtime = ToUTF8(plug.SerializeRealtimeSupport());
+            record.effectAutomatable = plug.IsEffectAutomatable();
          }
          break;
 
          case PluginTypeImporter:
          {
             pRegistry->Write(KEY_IMPORTERIDENT, plug.GetImporterIdentifier());
+            record.importerIdent = ToUTF8(plug.GetImporterIdentifier());
             const auto & extensions = plug.GetImporterExtensions();
             wxString strExt;
             for (size_t i = 0, cnt = extensions.size(); i < cnt; i++)
@@ -999,6 +1202,7 @@ void PluginManager::SaveGroup(audacity::BasicSettings *pRegistry, PluginType typ
             }
             strExt.RemoveLast(1);
             pRegistry->Write(KEY_IMPORTEREXTENSIONS, strExt);
+            record.importerExtensions = ToUTF8(strExt);
          }
          break;
 
@@ -1007,7 +1211,7 @@ void PluginManager::SaveGroup(audacity::BasicSettings *pRegistry, PluginType typ
       }
    }
 
-   return;
+   return records;
 }
 
 // Here solely for the purpose of Nyquist Workbench until
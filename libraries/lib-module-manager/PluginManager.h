@@ -42,6 +42,7 @@ typedef std::map<PluginID, PluginDescriptor> PluginMap;
 typedef wxArrayString PluginIDs;
 
 class PluginRegistrationDialog;
+struct PluginRegistryRecord;
 
 struct PluginsChangedMessage { };
 
@@ -201,8 +202,12 @@ private:
 
    void InitializePlugins();
 
-   void LoadGroup(audacity::BasicSettings* pRegistry, PluginType type);
-   void SaveGroup(audacity::BasicSettings* pRegistry, PluginType type);
+   //! Register plug-ins of one type from the records of the registry
+   void LoadGroup(
+      const std::vector<PluginRegistryRecord>& records, PluginType type);
+   //! @return the records that were written
+   std::vector<PluginRegistryRecord>
+   SaveGroup(audacity::BasicSettings* pRegistry, PluginType type);
 
    PluginDescriptor & CreatePlugin(const PluginID & id, ComponentInterface *ident, PluginType type);
 
@@ -0,0 +1,247 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginRegistrySnapshot.cpp
+
+**********************************************************************/
+#include "PluginRegistrySnapshot.h"
+
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+namespace {
+// Change the format version whenever the layout changes; older snapshots
+// are then ignored and rebuilt from the text registry
+constexpr char Magic[4] = { 'A', 'P', 'R', 'S' };
+constexpr uint32_t FormatVersion = 1;
+
+// Values are written in the byte order of the machine, which is the only one
+// that reads them
+class Writer final {
+public:
+   template<typename T> void Number(T value)
+   {
+      static_assert(std::is_arithmetic_v<T>);
+      mBytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+   }
+
+   void String(const std::string &value)
+   {
+      Number(static_cast<uint32_t>(value.size()));
+      mBytes.append(value);
+   }
+
+   void Bool(bool value) { Number(static_cast<uint8_t>(value)); }
+
+   void OptionalString(const std::optional<std::string> &value)
+   {
+      Bool(value.has_value());
+      if (value)
+         String(*value);
+   }
+
+   void OptionalBool(const std::optional<bool> &value)
+   {
+      // 2 for absent
+      Number(static_cast<uint8_t>(value ? *value : 2));
+   }
+
+   void Bytes(const char *bytes, size_t size) { mBytes.append(bytes, size); }
+
+   std::string Take() { return std::move(mBytes); }
+
+private:
+   std::string mBytes;
+};
+
+// Reads past the end just set a failure flag, checked once at the end
+class Reader final {
+public:
+   explicit Reader(const std::string &bytes)
+      : mData{ bytes.data() }, mSize{ bytes.size() }
+   {}
+
+   bool Good() const { return mGood; }
+   bool AtEnd() const { return mPosition == mSize; }
+
+   template<typename T> T Number()
+   {
+      static_assert(std::is_arithmetic_v<T>);
+      T value{};
+      if (Take(sizeof(value)))
+         memcpy(&value, mData + mPosition - sizeof(value), sizeof(value));
+      return value;
+   }
+
+   std::string String()
+   {
+      const auto size = Number<uint32_t>();
+      if (!Take(size))
+         return {};
+      return { mData + mPosition - size, size };
+   }
+
+   bool Bool()
+   {
+      const auto value = Number<uint8_t>();
+      if (value > 1)
+         mGood = false;
+      return value == 1;
+   }
+
+   std::optional<std::string> OptionalString()
+   {
+      if (Bool())
+         return String();
+      return {};
+   }
+
+   std::optional<bool> OptionalBool()
+   {
+      const auto value = Number<uint8_t>();
+      if (value > 2)
+         mGood = false;
+      if (value == 2)
+         return {};
+      return value == 1;
+   }
+
+   bool Bytes(const char *expected, size_t size)
+   {
+      if (!Take(size) || memcmp(mData + mPosition - size, expected, size) != 0)
+         mGood = false;
+      return mGood;
+   }
+
+private:
+   bool Take(size_t size)
+   {
+      if (!mGood || mSize - mPosition < size) {
+         mGood = false;
+         return false;
+      }
+      mPosition += size;
+      return true;
+   }
+
+   const char *const mData;
+   const size_t mSize;
+   size_t mPosition{ 0 };
+   bool mGood{ true };
+};
+
+auto Tie(const PluginRegistryRecord &record)
+{
+   return std::tie(record.group, record.providerID, record.path,
+      record.symbol, record.version, record.vendor,
+      record.enabled, record.valid,
+      record.effectType, record.effectFamily, record.effectDefault,
+      record.effectInteractive, record.effectRealtime,
+      record.effectAutomatable,
+      record.importerIdent, record.importerExtensions);
+}
+}
+
+bool PluginRegistryRecord::operator ==(const PluginRegistryRecord &other) const
+{
+   return Tie(*this) == Tie(other);
+}
+
+bool PluginRegistrySnapshot::Stamp::operator ==(const Stamp &other) const
+{
+   return size == other.size && modified == other.modified &&
+      hash == other.hash;
+}
+
+uint64_t PluginRegistrySnapshot::Hash(const std::string &contents)
+{
+   uint64_t hash = 0xcbf29ce484222325ull;
+   for (const auto byte : contents) {
+      hash ^= static_cast<unsigned char>(byte);
+      hash *= 0x100000001b3ull;
+   }
+   return hash;
+}
+
+std::string PluginRegistrySnapshot::Serialize() const
+{
+   Writer writer;
+   writer.Bytes(Magic, sizeof(Magic));
+   writer.Number(FormatVersion);
+   writer.Number(stamp.size);
+   writer.Number(stamp.modified);
+   writer.Number(stamp.hash);
+   writer.String(version);
+   writer.Number(static_cast<uint32_t>(groups.size()));
+   for (const auto &group : groups) {
+      writer.Number(group.type);
+      writer.Number(static_cast<uint32_t>(group.records.size()));
+      for (const auto &record : group.records) {
+         writer.String(record.group);
+         writer.String(record.providerID);
+         writer.String(record.path);
+         writer.OptionalString(record.symbol);
+         writer.OptionalString(record.version);
+         writer.OptionalString(record.vendor);
+         writer.Bool(record.enabled);
+         writer.Bool(record.valid);
+         writer.OptionalString(record.effectType);
+         writer.OptionalString(record.effectFamily);
+         writer.OptionalBool(record.effectDefault);
+         writer.OptionalBool(record.effectInteractive);
+         writer.OptionalString(record.effectRealtime);
+         writer.OptionalBool(record.effectAutomatable);
+         writer.OptionalString(record.importerIdent);
+         writer.OptionalString(record.importerExtensions);
+      }
+   }
+   return writer.Take();
+}
+
+std::optional<PluginRegistrySnapshot>
+PluginRegistrySnapshot::Deserialize(const std::string &bytes)
+{
+   Reader reader{ bytes };
+   if (!reader.Bytes(Magic, sizeof(Magic)) ||
+       reader.Number<uint32_t>() != FormatVersion)
+      return {};
+
+   PluginRegistrySnapshot snapshot;
+   snapshot.stamp.size = reader.Number<uint64_t>();
+   snapshot.stamp.modified = reader.Number<int64_t>();
+   snapshot.stamp.hash = reader.Number<uint64_t>();
+   snapshot.version = reader.String();
+   const auto nGroups = reader.Number<uint32_t>();
+   for (uint32_t iGroup = 0; reader.Good() && iGroup < nGroups; ++iGroup) {
+      auto &group = snapshot.groups.emplace_back();
+      group.type = reader.Number<uint32_t>();
+      const auto nRecords = reader.Number<uint32_t>();
+      for (uint32_t iRecord = 0; reader.Good() && iRecord < nRecords;
+           ++iRecord)
+      {
+         auto &record = group.records.emplace_back();
+         record.group = reader.String();
+         record.providerID = reader.String();
+         record.path = reader.String();
+         record.symbol = reader.OptionalString();
+         record.version = reader.OptionalString();
+         record.vendor = reader.OptionalString();
+         record.enabled = reader.Bool();
+         record.valid = reader.Bool();
+         record.effectType = reader.OptionalString();
+         record.effectFamily = reader.OptionalString();
+         record.effectDefault = reader.OptionalBool();
+         record.effectInteractive = reader.OptionalBool();
+         record.effectRealtime = reader.OptionalString();
+         record.effectAutomatable = reader.OptionalBool();
+         record.importerIdent = reader.OptionalString();
+         record.importerExtensions = reader.OptionalString();
+      }
+   }
+   if (!reader.Good() || !reader.AtEnd())
+      return {};
+   return snapshot;
+}
@@ -0,0 +1,88 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginRegistrySnapshot.h
+  @brief Compact binary copy of pluginregistry.cfg, for fast startup
+
+**********************************************************************/
+#ifndef __AUDACITY_PLUGIN_REGISTRY_SNAPSHOT__
+#define __AUDACITY_PLUGIN_REGISTRY_SNAPSHOT__
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+//! Values of one plug-in group of the registry that PluginManager reads back
+/*!
+ Strings are UTF-8.  Absent optional values stand for keys missing from the
+ group; the other values have defaults when missing.
+ */
+struct MODULE_MANAGER_API PluginRegistryRecord final {
+   //! Name of the group, which is the encoded plug-in ID
+   std::string group;
+   std::string providerID;
+   std::string path;
+   std::optional<std::string> symbol;
+   std::optional<std::string> version;
+   std::optional<std::string> vendor;
+   bool enabled{ false };
+   bool valid{ false };
+
+   // Effects only
+   std::optional<std::string> effectType;
+   std::optional<std::string> effectFamily;
+   std::optional<bool> effectDefault;
+   std::optional<bool> effectInteractive;
+   std::optional<std::string> effectRealtime;
+   std::optional<bool> effectAutomatable;
+
+   // Importers only
+   std::optional<std::string> importerIdent;
+   std::optional<std::string> importerExtensions;
+
+   bool operator ==(const PluginRegistryRecord &other) const;
+};
+
+//! The plug-in groups of a text registry, and what identifies its contents
+/*!
+ The text registry remains the source of truth.  A snapshot is only usable
+ while its stamp matches the registry file.
+ */
+struct MODULE_MANAGER_API PluginRegistrySnapshot final {
+   //! Identifies the contents of a registry file
+   struct Stamp final {
+      uint64_t size{};
+      //! Modification time, in milliseconds
+      int64_t modified{};
+      uint64_t hash{};
+
+      bool operator ==(const Stamp &other) const;
+      bool operator !=(const Stamp &other) const { return !(*this == other); }
+   };
+
+   //! Records of plug-ins of one type, in registry order
+   struct Group final {
+      //! A PluginType value
+      uint32_t type{};
+      std::vector<PluginRegistryRecord> records;
+   };
+
+   Stamp stamp;
+   //! The registry version string
+   std::string version;
+   std::vector<Group> groups;
+
+   //! 64-bit FNV-1a hash of the contents of a registry file
+   static uint64_t Hash(const std::string &contents);
+
+   std::string Serialize() const;
+
+   //! @return nullopt if the bytes are not a snapshot in the current format
+   static std::optional<PluginRegistrySnapshot>
+   Deserialize(const std::string &bytes);
+};
+
+#endif
@@ -0,0 +1,186 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PluginRegistrySnapshotTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "PluginRegistrySnapshot.h"
+
+#include <cstring>
+
+namespace
+{
+PluginRegistryRecord MakeEffect()
+{
+   PluginRegistryRecord record;
+   record.group = "Effect_Nyquist_Prompt";
+   record.providerID = "Nyquist";
+   record.path = u8"/usr/share/audacity/plug-ins/écho.ny";
+   record.symbol = "Nyquist Prompt";
+   record.version = "4.04";
+   record.vendor = "Audacity";
+   record.enabled = true;
+   record.valid = true;
+   record.effectType = "Tool";
+   record.effectFamily = "Nyquist";
+   record.effectDefault = true;
+   record.effectInteractive = false;
+   record.effectRealtime = "0";
+   record.effectAutomatable = true;
+   return record;
+}
+
+PluginRegistryRecord MakeImporter()
+{
+   PluginRegistryRecord record;
+   record.group = "Importer_FFmpeg";
+   record.providerID = "Builtin";
+   // Empty, but present, strings
+   record.path = "";
+   record.symbol = "";
+   record.enabled = false;
+   record.valid = true;
+   record.importerIdent = "FFmpeg";
+   record.importerExtensions = "mp4 m4a";
+   return record;
+}
+
+PluginRegistrySnapshot MakeSnapshot()
+{
+   PluginRegistrySnapshot snapshot;
+   snapshot.stamp = { 12345, 1700000000123, 0x0123456789abcdefull };
+   snapshot.version = "1.2";
+   snapshot.groups.push_back({ 1, { MakeEffect(), PluginRegistryRecord{} } });
+   snapshot.groups.push_back({ 5, {} });
+   snapshot.groups.push_back({ 4, { MakeImporter() } });
+   return snapshot;
+}
+
+void RequireEqual(
+   const PluginRegistrySnapshot &actual, const PluginRegistrySnapshot &expected)
+{
+   REQUIRE(actual.stamp == expected.stamp);
+   REQUIRE(actual.version == expected.version);
+   REQUIRE(actual.groups.size() == expected.groups.size());
+   for (size_t ii = 0; ii < expected.groups.size(); ++ii) {
+      REQUIRE(actual.groups[ii].type == expected.groups[ii].type);
+      REQUIRE(actual.groups[ii].records == expected.groups[ii].records);
+   }
+}
+
+// Offsets of the fixed fields at the start of the format
+constexpr size_t versionOffset = 4;
+constexpr size_t stampOffset = versionOffset + sizeof(uint32_t);
+} // namespace
+
+TEST_CASE("PluginRegistrySnapshot round trip")
+{
+   SECTION("Keeps all values, and tells absent values from empty ones")
+   {
+      const auto snapshot = MakeSnapshot();
+      const auto restored =
+         PluginRegistrySnapshot::Deserialize(snapshot.Serialize());
+      REQUIRE(restored);
+      RequireEqual(*restored, snapshot);
+
+      const auto &importer = restored->groups[2].records[0];
+      REQUIRE(importer.symbol == std::string{});
+      REQUIRE(!importer.version);
+      REQUIRE(!importer.effectDefault);
+
+      const auto &effect = restored->groups[0].records[0];
+      REQUIRE(effect.effectInteractive == false);
+   }
+
+   SECTION("Keeps an empty snapshot")
+   {
+      const PluginRegistrySnapshot snapshot;
+      const auto restored =
+         PluginRegistrySnapshot::Deserialize(snapshot.Serialize());
+      REQUIRE(restored);
+      RequireEqual(*restored, snapshot);
+   }
+
+   SECTION("Serializes equal snapshots alike")
+   {
+      REQUIRE(MakeSnapshot().Serialize() == MakeSnapshot().Serialize());
+   }
+}
+
+TEST_CASE("PluginRegistrySnapshot rejects what it did not write")
+{
+   const auto bytes = MakeSnapshot().Serialize();
+   REQUIRE(PluginRegistrySnapshot::Deserialize(bytes));
+
+   SECTION("Truncated at any length")
+   {
+      for (size_t length = 0; length < bytes.size(); ++length)
+         REQUIRE(!PluginRegistrySnapshot::Deserialize(bytes.substr(0, length)));
+   }
+
+   SECTION("With trailing bytes")
+   {
+      REQUIRE(!PluginRegistrySnapshot::Deserialize(bytes + '\0'));
+   }
+
+   SECTION("With another magic number")
+   {
+      auto corrupt = bytes;
+      corrupt[0] = 'X';
+      REQUIRE(!PluginRegistrySnapshot::Deserialize(corrupt));
+   }
+
+   SECTION("In another format version")
+   {
+      auto other = bytes;
+      uint32_t version;
+      memcpy(&version, other.data() + versionOffset, sizeof(version));
+      for (const auto otherVersion : { version - 1, version + 1 }) {
+         memcpy(other.data() + versionOffset, &otherVersion, sizeof(version));
+         REQUIRE(!PluginRegistrySnapshot::Deserialize(other));
+      }
+   }
+
+   SECTION("With a bad boolean")
+   {
+      // A snapshot of one record with no optional values, so that the last
+      // bytes are the optional values, each one byte
+      PluginRegistrySnapshot snapshot;
+      snapshot.groups.push_back({ 1, { PluginRegistryRecord{} } });
+      auto corrupt = snapshot.Serialize();
+      REQUIRE(PluginRegistrySnapshot::Deserialize(corrupt));
+      // The importer extensions: absent is 0, present is 1
+      corrupt.back() = 2;
+      REQUIRE(!PluginRegistrySnapshot::Deserialize(corrupt));
+      // The automatable flag of an effect: 2 is absent, more is bad
+      corrupt.back() = 0;
+      corrupt[corrupt.size() - 3] = 3;
+      REQUIRE(!PluginRegistrySnapshot::Deserialize(corrupt));
+   }
+
+   SECTION("With a string longer than the rest")
+   {
+      PluginRegistrySnapshot snapshot;
+      snapshot.version = "1.2";
+      auto corrupt = snapshot.Serialize();
+      const uint32_t length = 1000;
+      memcpy(corrupt.data() + stampOffset + 3 * sizeof(uint64_t), &length,
+         sizeof(length));
+      REQUIRE(!PluginRegistrySnapshot::Deserialize(corrupt));
+   }
+}
+
+TEST_CASE("PluginRegistrySnapshot::Hash")
+{
+   // Reference values of 64-bit FNV-1a
+   REQUIRE(PluginRegistrySnapshot::Hash("") == 0xcbf29ce484222325ull);
+   REQUIRE(PluginRegistrySnapshot::Hash("a") == 0xaf63dc4c8601ec8cull);
+   REQUIRE(PluginRegistrySnapshot::Hash("foobar") == 0x85944171f73967e8ull);
+
+   REQUIRE(PluginRegistrySnapshot::Hash("[pluginregistry]\nA=1\n") !=
+      PluginRegistrySnapshot::Hash("[pluginregistry]\nA=2\n"));
+}
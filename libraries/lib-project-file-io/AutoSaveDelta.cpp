@@ -0,0 +1,171 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveDelta.cpp
+
+**********************************************************************/
+#include "AutoSaveDelta.h"
+
+#include "MemoryStream.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace {
+constexpr char Magic[4] = { 'A', 'S', 'D', '1' };
+enum : uint8_t { CopyRecord = 'C', LiteralRecord = 'L' };
+
+// FNV-1a
+uint64_t Digest(const void* data, size_t size)
+{
+   auto p = static_cast<const uint8_t*>(data);
+   uint64_t hash = 14695981039346656037ULL;
+   for (size_t ii = 0; ii < size; ++ii)
+      hash = (hash ^ p[ii]) * 1099511628211ULL;
+   return hash;
+}
+
+// Little-endian, whatever the machine
+void WriteU64(MemoryStream& out, uint64_t value)
+{
+   uint8_t bytes[8];
+   for (auto& byte : bytes)
+      byte = value & 0xFF, value >>= 8;
+   out.AppendData(bytes, sizeof bytes);
+}
+
+bool ReadU64(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+{
+   if (end - p < 8)
+      return false;
+   value = 0;
+   for (int ii = 7; ii >= 0; --ii)
+      value = (value << 8) | p[ii];
+   p += 8;
+   return true;
+}
+}
+
+void AutoSaveDelta::Reset() noexcept
+{
+   mFragments.clear();
+   mBase.clear();
+   mBase.shrink_to_fit();
+   mDigest = 0;
+}
+
+void AutoSaveDelta::SetBase(
+   const void* data, size_t size, const std::vector<Range>& fragments)
+{
+   Reset();
+   auto bytes = static_cast<const uint8_t*>(data);
+   for (auto [begin, end] : fragments)
+      mFragments.emplace(Digest(bytes + begin, end - begin), Range{ begin, end });
+   mBase.assign(bytes, bytes + size);
+   mDigest = Digest(data, size);
+}
+
+size_t AutoSaveDelta::Encode(const void* data, size_t size,
+   const std::vector<Fragment>& fragments, MemoryStream& out) const
+{
+   auto bytes = static_cast<const uint8_t*>(data);
+   out.AppendData(Magic, sizeof Magic);
+   WriteU64(out, mDigest);
+   WriteU64(out, mBase.size());
+
+   size_t literalBytes = 0;
+   // Adjacent copies of adjacent ranges of the base are coalesced
+   Range copy{};
+   const auto flushCopy = [&] {
+      if (copy.second > copy.first) {
+         out.AppendByte(CopyRecord);
+         WriteU64(out, copy.first);
+         WriteU64(out, copy.second - copy.first);
+      }
+      copy = {};
+   };
+   const auto writeLiteral = [&](size_t begin, size_t end) {
+      if (end > begin) {
+         flushCopy();
+         out.AppendByte(LiteralRecord);
+         WriteU64(out, end - begin);
+         out.AppendData(bytes + begin, end - begin);
+         literalBytes += end - begin;
+      }
+   };
+
+   // Find a range of the base with the same bytes as the fragment; a digest
+   // only narrows the search, because distinct fragments may share one
+   const auto findInBase = [&](const Fragment& fragment) -> std::optional<Range> {
+      const auto [begin, end] = fragment.range;
+      if (fragment.base) {
+         assert(fragment.base->second - fragment.base->first == end - begin);
+         return fragment.base;
+      }
+      const auto [first, last] =
+         mFragments.equal_range(Digest(bytes + begin, end - begin));
+      for (auto iter = first; iter != last; ++iter) {
+         const auto [baseBegin, baseEnd] = iter->second;
+         if (baseEnd - baseBegin == end - begin &&
+             memcmp(mBase.data() + baseBegin, bytes + begin, end - begin) == 0)
+            return iter->second;
+      }
+      return {};
+   };
+
+   size_t pos = 0;
+   for (const auto& fragment : fragments) {
+      const auto found = findInBase(fragment);
+      if (!found)
+         continue;
+      const auto [begin, end] = fragment.range;
+      writeLiteral(pos, begin);
+      if (copy.second != found->first)
+         flushCopy(), copy.first = found->first;
+      copy.second = found->second;
+      pos = end;
+   }
+   writeLiteral(pos, size);
+   flushCopy();
+
+   return literalBytes;
+}
+
+bool AutoSaveDelta::Apply(const void* base, size_t baseSize,
+   const void* delta, size_t deltaSize, std::vector<uint8_t>& out)
+{
+   auto p = static_cast<const uint8_t*>(delta);
+   const auto end = p + deltaSize;
+   uint64_t digest, size;
+   if (deltaSize < sizeof Magic || memcmp(p, Magic, sizeof Magic) != 0)
+      return false;
+   p += sizeof Magic;
+   if (!ReadU64(p, end, digest) || !ReadU64(p, end, size) ||
+       size != baseSize || digest != Digest(base, baseSize))
+      return false;
+
+   auto baseBytes = static_cast<const uint8_t*>(base);
+   out.clear();
+   while (p != end) {
+      const auto tag = *p++;
+      uint64_t first, length;
+      if (tag == CopyRecord) {
+         if (!ReadU64(p, end, first) || !ReadU64(p, end, length) ||
+             first > baseSize || length > baseSize - first)
+            return false;
+         out.insert(out.end(), baseBytes + first, baseBytes + first + length);
+      }
+      else if (tag == LiteralRecord) {
+         if (!ReadU64(p, end, length) ||
+             length > static_cast<uint64_t>(end - p))
+            return false;
+         out.insert(out.end(), p, p + length);
+         p += length;
+      }
+      else
+         return false;
+   }
+   return true;
+}
@@ -0,0 +1,88 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveDelta.h
+
+  @brief Encoding of autosave documents as differences from a full one
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class MemoryStream;
+
+//! Remembers the track fragments of the last full autosave document, so that
+//! later documents can be written as the fragments that changed
+/*!
+ Documents are the data streams of ProjectSerializer.  Because the dictionary
+ of names is shared by all serializers of one run and only grows, a fragment
+ of one document may be copied into another of the same run, which is then
+ decoded with the later dictionary.
+
+ A delta is a sequence of copies of byte ranges of the base and of literal
+ bytes; it also records a digest of the base, so that it is never applied to
+ another.
+
+ The base is kept, so that a fragment found by digest is copied only if its
+ bytes really are equal.
+ */
+class PROJECT_FILE_IO_API AutoSaveDelta final
+{
+public:
+   //! Begin and end offsets of a fragment within a document
+   using Range = std::pair<size_t, size_t>;
+
+   //! A fragment of a document to encode
+   struct Fragment {
+      Range range;
+      //! A range of the base that the caller knows to hold the same bytes,
+      //! so that they need not be compared
+      std::optional<Range> base;
+   };
+
+   //! Whether there is a base
+   bool IsEmpty() const noexcept { return mBase.empty(); }
+
+   //! Forget the base
+   void Reset() noexcept;
+
+   //! Remember the document as the base for later deltas
+   /*!
+    @param fragments ranges of the serializations of tracks
+    */
+   void SetBase(const void* data, size_t size,
+      const std::vector<Range>& fragments);
+
+   //! Size of the base document
+   size_t BaseSize() const noexcept { return mBase.size(); }
+
+   //! Append the encoding of a document as differences from the base
+   /*!
+    @pre `!IsEmpty()`
+    @return the number of literal bytes in the delta
+    */
+   size_t Encode(const void* data, size_t size,
+      const std::vector<Fragment>& fragments, MemoryStream& out) const;
+
+   //! Reconstruct a document from the base and a delta
+   /*!
+    @return false, and `out` is unspecified, if the delta was not made from
+    this base or is corrupt
+    */
+   static bool Apply(const void* base, size_t baseSize,
+      const void* delta, size_t deltaSize, std::vector<uint8_t>& out);
+
+private:
+   //! Ranges of the base that hold fragments, by digest
+   std::unordered_multimap<uint64_t, Range> mFragments;
+   std::vector<uint8_t> mBase;
+   uint64_t mDigest {};
+};
@@ -0,0 +1,38 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BufferedProjectMemoryStream.cpp
+
+**********************************************************************/
+#include "BufferedProjectMemoryStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+BufferedProjectMemoryStream::BufferedProjectMemoryStream(
+   const std::vector<uint8_t>& dict, const std::vector<uint8_t>& doc)
+    : BufferedStreamReader(32 * 1024)
+    , mParts{ &dict, &doc }
+{
+}
+
+bool BufferedProjectMemoryStream::HasMoreData() const
+{
+   return mNextPart < mParts.size();
+}
+
+size_t BufferedProjectMemoryStream::ReadData(void* buffer, size_t maxBytes)
+{
+   if (mNextPart >= mParts.size())
+      return 0;
+   auto& part = *mParts[mNextPart];
+   const auto bytes = std::min(maxBytes, part.size() - mOffset);
+   if (bytes > 0)
+      memcpy(buffer, part.data() + mOffset, bytes);
+   mOffset += bytes;
+   if (mOffset == part.size())
+      ++mNextPart, mOffset = 0;
+   return bytes;
+}
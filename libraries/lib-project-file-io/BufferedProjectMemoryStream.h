@@ -0,0 +1,34 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BufferedProjectMemoryStream.h
+
+**********************************************************************/
+#pragma once
+
+#include "BufferedStreamReader.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+//! Reads a dictionary and a document already in memory, as
+//! ProjectFileIO reads them from the database
+class PROJECT_FILE_IO_API BufferedProjectMemoryStream final
+   : public BufferedStreamReader
+{
+public:
+   BufferedProjectMemoryStream(
+      const std::vector<uint8_t>& dict, const std::vector<uint8_t>& doc);
+
+protected:
+   bool HasMoreData() const override;
+   size_t ReadData(void* buffer, size_t maxBytes) override;
+
+private:
+   const std::array<const std::vector<uint8_t>*, 2> mParts;
+   size_t mNextPart{ 0 };
+   size_t mOffset{ 0 };
+};
@@ -29,8 +29,11 @@ Paul Licameli -- split from ProjectFileIO.cpp
 #define xstr(a) str(a)
 #define str(a) #a
 
+// Incremental auto-vacuum lets ProjectFileIO::Compact() reclaim free pages in
+// place; like the page size, it can only change on an empty database
 static const char* PageSizeConfig =
    "PRAGMA <schema>.page_size = " xstr(AUDACITY_PROJECT_PAGE_SIZE) ";"
+   "PRAGMA <schema>.auto_vacuum = INCREMENTAL;"
    "VACUUM;";
 
 // Configuration to provide "safe" connections
@@ -426,6 +429,33 @@ sqlite3 *DBConnection::DB()
    return mDB;
 }
 
+sqlite3 *DBConnection::OpenWorkerDB()
+{
+   const auto name = sqlite3_db_filename(DB(), "main");
+
+   sqlite3 *db = nullptr;
+   int rc = sqlite3_open(name, &db);
+   if (rc == SQLITE_OK)
+      rc = ModeConfig(db, "main", SafeConfig);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "DBConnection::OpenWorkerDB");
+
+      wxLogMessage("Failed to open worker connection to %s: %d, %s\n",
+         name,
+         rc,
+         sqlite3_errstr(rc));
+      sqlite3_close(db);
+      return nullptr;
+   }
+
+   // Without automatic checkpoints, the WAL would grow until the next commit
+   // of the primary connection
+   sqlite3_wal_hook(db, CheckpointHook, this);
+   return db;
+}
+
 int DBConnection::GetLastRC() const
 {
    return sqlite3_errcode(mDB);
@@ -490,6 +520,53 @@ sqlite3_stmt *DBConnection::Prepare(enum StatementID id, const char *sql)
    return stmt;
 }
 
+long long DBConnection::ReserveBlockID()
+{
+   std::lock_guard<std::mutex> guard(mBlockIDMutex);
+
+   // Resynchronize with the table only when nothing is reserved, so that
+   // rows inserted by other means are accounted for
+   if (mReservedBlockIDs == 0)
+   {
+      // Respect AUTOINCREMENT, never reusing the id of a deleted row
+      auto stmt = Prepare(GetMaxSampleBlockID,
+         "SELECT max("
+         "  coalesce((SELECT seq FROM sqlite_sequence"
+         "            WHERE name = 'sampleblocks'), 0),"
+         "  coalesce((SELECT max(blockid) FROM sampleblocks), 0));");
+
+      auto cleanup = finally([stmt]{
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
+      });
+
+      int rc = sqlite3_step(stmt);
+      if (rc != SQLITE_ROW)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "DBConnection::ReserveBlockID");
+         ThrowException(false);
+      }
+      mNextBlockID = sqlite3_column_int64(stmt, 0) + 1;
+   }
+
+   ++mReservedBlockIDs;
+   return mNextBlockID++;
+}
+
+void DBConnection::ReleaseBlockID()
+{
+   std::lock_guard<std::mutex> guard(mBlockIDMutex);
+   wxASSERT(mReservedBlockIDs > 0);
+   if (mReservedBlockIDs > 0)
+      --mReservedBlockIDs;
+}
+
+std::unique_lock<std::recursive_mutex> DBConnection::LockForWriting()
+{
+   return std::unique_lock<std::recursive_mutex>{ mWriteMutex };
+}
+
 void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
 {
    int rc = SQLITE_OK;
@@ -602,13 +679,16 @@ int DBConnection::CheckpointHook(void *data, sqlite3 *db, const char *schema, in
 
 struct DBConnectionTransactionScopeImpl final : TransactionScopeImpl {
    explicit DBConnectionTransactionScopeImpl(DBConnection &connection)
-      : mConnection{ connection } {}
+      : mConnection{ connection }
+      , mWriteLock{ connection.LockForWriting() } {}
    ~DBConnectionTransactionScopeImpl() override;
    bool TransactionStart(const wxString &name) override;
    bool TransactionCommit(const wxString &name) override;
    bool TransactionRollback(const wxString &name) override;
 
    DBConnection &mConnection;
+   //! Other threads wait to write until the transaction ends
+   const std::unique_lock<std::recursive_mutex> mWriteLock;
 };
 
 static TransactionScope::Factory::Scope scope {
@@ -701,6 +781,11 @@ bool DBConnectionTransactionScopeImpl::TransactionRollback(const wxString &name)
    return TransactionCommit(name);
 }
 
+void ConnectionPtr::FlushPendingBlocks()
+{
+   Publish({});
+}
+
 ConnectionPtr::~ConnectionPtr()
 {
    wxASSERT_MSG(!mpConnection, wxT("Project file was not closed at shutdown"));
@@ -22,6 +22,7 @@ Paul Licameli -- split from ProjectFileIO.h
 
 #include "ClientData.h"
 #include "Identifier.h"
+#include "Observer.h"
 
 struct sqlite3;
 struct sqlite3_stmt;
@@ -68,6 +69,15 @@ public:
 
    sqlite3 *DB();
 
+   //! Open another connection to the same database, for one worker thread
+   /*!
+    It is configured as safe, like DB(), and its commits also wake the
+    checkpoint thread.  The caller must close it with sqlite3_close() before
+    calling Close().
+    @return null on failure
+    */
+   sqlite3 *OpenWorkerDB();
+
    int GetLastRC() const ;
    const wxString GetLastMessage() const;
 
@@ -80,13 +90,30 @@ public:
       InsertSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      GetMaxSampleBlockID,
+      LoadSpectrogramTile,
+      StoreSpectrogramTile
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
    void SetBypass( bool bypass );
    bool ShouldBypass();
 
+   //! Choose the id of a row of sampleblocks that will be inserted later
+   /*!
+    The id is distinct from those of all rows and of all other ids reserved
+    and not yet released.  May throw.
+    */
+   long long ReserveBlockID();
+   //! The reserved id was inserted, or never will be
+   void ReleaseBlockID();
+
+   //! Hold the lock while writing, for the whole of a savepoint, so that
+   //! statements of other threads don't fall inside it
+   /*! The same thread may lock again while holding it */
+   std::unique_lock<std::recursive_mutex> LockForWriting();
+
    //! Just set stored errors
    void SetError(
       const TranslatableString &msg,
@@ -125,6 +152,12 @@ private:
    std::shared_ptr<DBConnectionErrors> mpErrors;
    CheckpointFailureCallback mCallback;
 
+   std::recursive_mutex mWriteMutex;
+
+   std::mutex mBlockIDMutex;
+   long long mNextBlockID{ 0 };
+   size_t mReservedBlockIDs{ 0 };
+
    // Bypass transactions if database will be deleted after close
    bool mBypass;
 };
@@ -135,9 +168,13 @@ using Connection = std::unique_ptr<DBConnection>;
 // project's current database connection, which is initialized on demand,
 // and may be redirected, temporarily or permanently, to another connection
 // when backing the project up or saving or saving-as.
+//! Sent before the database must contain all sample blocks created so far
+struct FlushPendingBlocksMessage {};
+
 class ConnectionPtr final
    : public ClientData::Base
    , public std::enable_shared_from_this< ConnectionPtr >
+   , public Observer::Publisher<FlushPendingBlocksMessage>
 {
 public:
    static ConnectionPtr &Get( AudacityProject &project );
@@ -145,7 +182,14 @@ public:
 
    ~ConnectionPtr() override;
 
+   //! Make write-behind queues of sample blocks write to the database
+   /*! May throw */
+   void FlushPendingBlocks();
+
    Connection mpConnection;
+   //! Whether any sample block was stored or loaded with a codec, so that
+   //! the project needs a newer version to be opened
+   std::atomic<bool> mHasEncodedBlocks{ false };
 };
 
 #endif
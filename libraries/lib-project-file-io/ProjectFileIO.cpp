@@ -10,10 +10,12 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIO.h"
 
+#include <algorithm>
 #include <atomic>
 #include <sqlite3.h>
 #include <optional>
 #include <cstring>
+#include <map>
 
 #include <wx/crt.h>
 #include <wx/log.h>
@@ -21,6 +23,7 @@ Paul Licameli split from AudacityProject.cpp
 #include <wx/utils.h>
 
 #include "ActiveProjects.h"
+#include "BufferedProjectMemoryStream.h"
 #include "CodeConversions.h"
 #include "DBConnection.h"
 #include "FileNames.h"
@@ -31,6 +34,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectSerializer.h"
 #include "FileNames.h"
 #include "SampleBlock.h"
+#include "SpectrogramTileStore.h"
 #include "TempDirectory.h"
 #include "TransactionScope.h"
 #include "WaveTrack.h"
@@ -70,6 +74,14 @@ Paul Licameli split from AudacityProject.cpp
 // types, such as the Linux "file" command.
 static const int ProjectFileID = PACK('A', 'U', 'D', 'Y');
 
+// Free pages reclaimed per transaction when compacting in place, 16 MiB with
+// the usual page size; cancellation waits for at most one such step
+static const int IncrementalVacuumPages = 256;
+
+// Free pages alone don't make compaction in place worthwhile, unless they are
+// at least this percentage of the file, and enough for a step of the above
+static const int MinFreePagesPercent = 10;
+
 // The "ProjectFileVersion" represents the version of Audacity at which a specific
 // database schema was used. It is assumed that any changes to the database schema
 // will require a new Audacity version so if schema changes are required set this
@@ -101,6 +113,9 @@ static const char *ProjectFileSchema =
    // settings.
    "PRAGMA <schema>.application_id = %d;"
    "PRAGMA <schema>.user_version = %u;"
+   // Takes effect only before the first table is made; this is what
+   // converts older files when CopyTo() compacts them
+   "PRAGMA <schema>.auto_vacuum = INCREMENTAL;"
    ""
    // project is a binary representation of an XML file.
    // it's in binary for speed.
@@ -124,7 +139,8 @@ static const char *ProjectFileSchema =
    // CREATE SQL autosave
    // autosave is a binary representation of an XML file.
    // it's in binary for speed.
-   // One instance only.  id is always 1.
+   // id 1 holds a full document.  id 2, if present, holds a delta to apply
+   // to it (see AutoSaveDelta), with the dictionary that decodes the result.
    // dict is a dictionary of fieldnames.
    // doc is the binary representation of the XML
    // in the doc, fieldnames are replaced by 2 byte dictionary
@@ -167,6 +183,57 @@ static const char *ProjectFileSchema =
    "  samples              BLOB"
    ");";
 
+// CREATE SQL sampleblockusage
+// One row, id 1, holding the number of sample blocks and the total of their
+// sizes as GetDiskUsage() estimates them.  The triggers keep it up to date in
+// the same transaction as each insertion or deletion of a block, so totals
+// are read without a scan of sampleblocks.
+//
+// Files written before this table existed, or compacted by a version that
+// does not know it, are repaired when opened:  the row is computed then by one
+// scan.  Versions that do not know the table still fire the triggers.
+static const char *UsageLedgerSchema =
+   "CREATE TABLE IF NOT EXISTS <schema>.sampleblockusage"
+   "("
+   "  id                   INTEGER PRIMARY KEY,"
+   "  blockcount           INTEGER,"
+   "  bytes                INTEGER"
+   ");"
+   ""
+   "INSERT OR REPLACE INTO <schema>.sampleblockusage"
+   "  SELECT 1, Count(*), ifnull(sum("
+   "    length(blockid) + length(sampleformat) +"
+   "    length(summin) + length(summax) + length(sumrms) +"
+   "    length(summary256) + length(summary64k) +"
+   "    length(samples)), 0)"
+   "  FROM <schema>.sampleblocks;"
+   ""
+   "CREATE TRIGGER IF NOT EXISTS <schema>.sampleblockusage_insert"
+   "  AFTER INSERT ON sampleblocks"
+   "  BEGIN"
+   "    UPDATE sampleblockusage SET"
+   "      blockcount = blockcount + 1,"
+   "      bytes = bytes + ifnull("
+   "        length(new.blockid) + length(new.sampleformat) +"
+   "        length(new.summin) + length(new.summax) + length(new.sumrms) +"
+   "        length(new.summary256) + length(new.summary64k) +"
+   "        length(new.samples), 0)"
+   "    WHERE id = 1;"
+   "  END;"
+   ""
+   "CREATE TRIGGER IF NOT EXISTS <schema>.sampleblockusage_delete"
+   "  AFTER DELETE ON sampleblocks"
+   "  BEGIN"
+   "    UPDATE sampleblockusage SET"
+   "      blockcount = blockcount - 1,"
+   "      bytes = bytes - ifnull("
+   "        length(old.blockid) + length(old.sampleformat) +"
+   "        length(old.summin) + length(old.summax) + length(old.sumrms) +"
+   "        length(old.summary256) + length(old.summary64k) +"
+   "        length(old.samples), 0)"
+   "    WHERE id = 1;"
+   "  END;";
+
 
 class SQLiteBlobStream final
 {
@@ -372,6 +439,93 @@ protected:
 
 constexpr std::array<const char*, 2> BufferedProjectBlobStream::Columns;
 
+static bool ReadBlob(sqlite3* db, const char* table, const char* column,
+   int64_t rowID, std::vector<uint8_t>& result)
+{
+   auto blobStream =
+      SQLiteBlobStream::Open(db, "main", table, column, rowID, true);
+   if (!blobStream)
+      return false;
+
+   result.clear();
+   constexpr int chunkSize = 1024 * 1024;
+   while (!blobStream->IsEof())
+   {
+      const auto size = result.size();
+      result.resize(size + chunkSize);
+      int bytesRead = chunkSize;
+      if (SQLITE_OK != blobStream->Read(result.data() + size, bytesRead))
+         return false;
+      result.resize(size + bytesRead);
+   }
+   return true;
+}
+
+//! Copy bytes of a stream without making all of it contiguous
+static std::vector<uint8_t>
+CopyStreamRange(const MemoryStream &stream, size_t begin, size_t end)
+{
+   std::vector<uint8_t> result;
+   result.reserve(end - begin);
+   size_t offset = 0;
+   for (const auto [data, size] : stream) {
+      const auto first = std::max(offset, begin), last = std::min(offset + size, end);
+      if (first < last) {
+         const auto bytes = static_cast<const uint8_t *>(data);
+         result.insert(result.end(), bytes + (first - offset), bytes + (last - offset));
+      }
+      offset += size;
+      if (offset >= end)
+         break;
+   }
+   return result;
+}
+
+//! Serializations of wave tracks in the last autosave, reused by the next
+//! for the tracks that did not change
+/*!
+ Each serialization keeps a copy of its track, made as undo states copy
+ tracks, and so sharing the sample sequences while they are unchanged.  The
+ old copy and the track are compared as the old and new undo states would
+ be.  A serialization is reused only when WaveTrack::WritesSameXML() is sure
+ of the sameness; other kinds of tracks, which are cheap to write, and
+ anything uncertain are serialized again.
+ */
+struct ProjectFileIO::AutoSaveFragments final
+{
+   struct Fragment {
+      //! The track as it was serialized
+      std::shared_ptr<const WaveTrack> pSnapshot;
+      std::vector<uint8_t> bytes;
+      //! Where the same bytes are in the base of the delta, if there
+      std::optional<AutoSaveDelta::Range> base;
+   };
+
+   Fragment *Find(const Track &track)
+   {
+      const auto iter = fragments.find(track.GetId());
+      if (iter == fragments.end())
+         return nullptr;
+      const auto pTrack = dynamic_cast<const WaveTrack *>(&track);
+      if (!pTrack || !pTrack->WritesSameXML(*iter->second.pSnapshot))
+         return nullptr;
+      return &iter->second;
+   }
+
+   std::map<TrackId, Fragment> fragments;
+};
+
+namespace {
+// Older versions would recover the full autosave document without the delta
+ProjectFormatExtensionsRegistry::Extension autoSaveDeltaExtension(
+   [](const AudacityProject &project) -> ProjectFormatVersion {
+      if (ProjectFileIO::Get(project).HasAutoSaveDelta())
+         return AutoSaveDeltaFormatVersion;
+      return BaseProjectFormatVersion;
+   }
+);
+}
+
 bool ProjectFileIO::InitializeSQL()
 {
    if (audacity::sqlite::Initialize().IsError())
@@ -407,6 +561,7 @@ const ProjectFileIO &ProjectFileIO::Get( const AudacityProject &project )
 ProjectFileIO::ProjectFileIO(AudacityProject &project)
    : mProject{ project }
    , mpErrors{ std::make_shared<DBConnectionErrors>() }
+   , mpAutoSaveFragments{ std::make_unique<AutoSaveFragments>() }
 {
    mPrevConn = nullptr;
 
@@ -548,6 +703,13 @@ bool ProjectFileIO::CloseConnection()
    if (!curConn)
       return false;
 
+   // Release the blocks held by copies of tracks for autosave while their
+   // database is open
+   mpAutoSaveFragments->fragments.clear();
+
+   // Not much we can do if this fails; the blocks are lost
+   FlushPendingBlocks();
+
    if (!curConn->Close())
    {
       return false;
@@ -566,6 +728,10 @@ void ProjectFileIO::SaveConnection()
    // Should do nothing in proper usage, but be sure not to leak a connection:
    DiscardConnection();
 
+   // Blocks created so far belong in the connection being set aside
+   if (CurrConn())
+      FlushPendingBlocks();
+
    mPrevConn = std::move(CurrConn());
    mPrevFileName = mFileName;
    mPrevTemporary = mTemporary;
@@ -785,7 +951,19 @@ bool ProjectFileIO::CheckVersion()
       );
       return false;
    }
-   
+
+   // Repair a file that lacks the usage ledger
+   if (!GetValue("SELECT Count(*) FROM sqlite_master "
+                 "WHERE type='table' AND name='sampleblockusage';", result))
+   {
+      return false;
+   }
+
+   if (wxStrtol<char **>(result, nullptr, 10) == 0)
+   {
+      return InstallUsageLedger(db);
+   }
+
    return true;
 }
 
@@ -806,6 +984,29 @@ bool ProjectFileIO::InstallSchema(sqlite3 *db, const char *schema /* = "main" */
       return false;
    }
 
+   return InstallUsageLedger(db, schema);
+}
+
+bool ProjectFileIO::InstallUsageLedger(sqlite3 *db, const char *schema /* = "main" */)
+{
+   int rc;
+
+   // The table, its row, and the triggers appear together or not at all
+   wxString sql;
+   sql.Printf("SAVEPOINT usageledger;%sRELEASE usageledger;", UsageLedgerSchema);
+   sql.Replace("<schema>", schema);
+
+   rc = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      SetDBError(
+         XO("Unable to initialize the project file")
+      );
+      sqlite3_exec(db, "ROLLBACK TO usageledger; RELEASE usageledger;",
+         nullptr, nullptr, nullptr);
+      return false;
+   }
+
    return true;
 }
 
@@ -925,6 +1126,9 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
    if (!pConn)
       return false;
 
+   if (!FlushPendingBlocks())
+      return false;
+
    // Get access to the active tracklist
    auto pProject = &mProject;
 
@@ -1141,6 +1345,9 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
          }
       }
 
+      // Spectrograms computed for the blocks copied remain valid
+      SpectrogramTileStore::CopyTo(db, "outbound");
+
       // Write the doc.
       //
       // If we're compacting a temporary project (user initiated from the File
@@ -1200,7 +1407,8 @@ bool ProjectFileIO::ShouldCompact(const std::vector<const TrackList *> &tracks)
       return 0;
    };
 
-   if (!Query("SELECT Count(*) FROM sampleblocks;", cb) || blockcount == 0)
+   if (!Query("SELECT blockcount FROM sampleblockusage WHERE id = 1;", cb) ||
+       blockcount == 0)
    {
       // Shouldn't compact since we don't have the full picture
       return false;
@@ -1405,6 +1613,130 @@ ProjectFileIO::BackupProject::~BackupProject()
    }
 }
 
+bool ProjectFileIO::CanCompactInPlace()
+{
+   int64_t autoVacuum = 0;
+   // 2 is INCREMENTAL
+   return GetValue("PRAGMA auto_vacuum;", autoVacuum, true) && autoVacuum == 2;
+}
+
+bool ProjectFileIO::ShouldReclaimFreePages()
+{
+   int64_t freePages = 0;
+   int64_t pageCount = 0;
+   if (!GetValue("PRAGMA freelist_count;", freePages) ||
+       !GetValue("PRAGMA page_count;", pageCount))
+      return false;
+
+   wxLogDebug(wxT("free pages = %lld page count = %lld"),
+      (long long)freePages, (long long)pageCount);
+   return freePages >= IncrementalVacuumPages &&
+      freePages * 100 > pageCount * MinFreePagesPercent;
+}
+
+bool ProjectFileIO::CompactInPlace(const std::vector<const TrackList *> &tracks)
+{
+   if (!FlushPendingBlocks())
+      return false;
+
+   // Leave the same contents as CopyTo() would leave in the copy:  only the
+   // blocks of the tracks, and the document of the first of them
+   {
+      ProjectSerializer doc;
+      WriteXMLHeader(doc);
+      WriteXML(doc, false, tracks.empty() ? nullptr : tracks[0]);
+
+      TransactionScope transaction(mProject, "Compact");
+
+      if (!tracks.empty())
+      {
+         BlockIDs blockids;
+         for (auto trackList : tracks)
+            if (trackList)
+               WaveTrackUtilities::InspectBlocks(*trackList, {}, &blockids);
+
+         if (!DeleteBlocks(blockids, true))
+            return false;
+      }
+
+      // A delta would not apply to the new autosave document
+      if (IsTemporary()
+         ? !(DiscardAutoSaveDelta() && WriteDoc("autosave", doc))
+         : !(WriteDoc("project", doc) && AutoSaveDelete()))
+         return false;
+
+      if (!transaction.Commit())
+         return false;
+   }
+
+   int64_t freePages = 0;
+   if (!GetValue("PRAGMA freelist_count;", freePages))
+      return false;
+   if (freePages == 0)
+      return true;
+
+   // Reclaim the pages on another connection, in a worker thread, so that the
+   // progress dialog stays responsive.  Each step is its own transaction, so
+   // that cancellation keeps the pages already reclaimed, and the next
+   // compaction resumes with the rest
+   const auto db = GetConnection().OpenWorkerDB();
+   if (!db)
+   {
+      SetError(XO("Unable to compact the project file"));
+      return false;
+   }
+
+   const auto sql = wxString::Format(
+      "PRAGMA incremental_vacuum(%d);", IncrementalVacuumPages).ToStdString();
+   std::atomic<int64_t> reclaimed{ 0 };
+   std::atomic_bool cancelled{ false };
+   std::atomic_bool done{ false };
+   int rc = SQLITE_OK;
+   auto thread = std::thread([&]
+   {
+      while (!cancelled && reclaimed < freePages)
+      {
+         rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+         if (rc != SQLITE_OK)
+            break;
+         reclaimed = std::min<int64_t>(
+            freePages, reclaimed + IncrementalVacuumPages);
+      }
+      done = true;
+   });
+
+   {
+      auto progress = BasicUI::MakeProgress(
+         XO("Progress"), XO("Compacting project"), BasicUI::ProgressShowCancel);
+
+      while (!done)
+      {
+         using namespace std::chrono;
+         std::this_thread::sleep_for(50ms);
+         if (progress &&
+             progress->Poll(reclaimed, freePages) !=
+                BasicUI::ProgressResult::Success)
+            cancelled = true;
+      }
+   }
+   thread.join();
+   sqlite3_close(db);
+
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectFileIO::CompactInPlace");
+
+      SetError(
+         XO("Unable to compact the project file"),
+         Verbatim(sqlite3_errstr(rc)), rc
+      );
+      return false;
+   }
+
+   return true;
+}
+
 void ProjectFileIO::Compact(
    const std::vector<const TrackList *> &tracks, bool force)
 {
@@ -1415,12 +1747,19 @@ void ProjectFileIO::Compact(
    // at project close time will still occur.
    mHadUnused = true;
 
+   // Files made with incremental auto-vacuum need no copy.  Others are copied,
+   // and the copy can then be compacted in place next time.
+   const bool inPlace = CanCompactInPlace();
+
    // If forcing compaction, bypass inspection.
    if (!force)
    {
       // Don't compact if this is a temporary project or if it's determined there are not
-      // enough unused blocks to make it worthwhile.
-      if (IsTemporary() || !ShouldCompact(tracks))
+      // enough unused blocks to make it worthwhile.  In place, also reclaim
+      // pages that a cancelled compaction left free, or that deletions freed,
+      // when there are enough of them.
+      if (IsTemporary() ||
+          !(ShouldCompact(tracks) || (inPlace && ShouldReclaimFreePages())))
       {
          // Delete the AutoSave doc it if exists
          if (IsModified())
@@ -1439,6 +1778,12 @@ void ProjectFileIO::Compact(
       }
    }
 
+   if (inPlace)
+   {
+      mWasCompacted = CompactInPlace(tracks);
+      return;
+   }
+
    wxString origName = mFileName;
    wxString backName = origName + "_compact_back";
    wxString tempName = origName + "_compact_temp";
@@ -1744,7 +2089,8 @@ void ProjectFileIO::WriteXMLHeader(XMLWriter &xmlFile) const
 
 void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
                              bool recording /* = false */,
-                             const TrackList *tracks /* = nullptr */)
+                             const TrackList *tracks /* = nullptr */,
+                             const TrackWriter &writeTrack)
 // may throw
 {
    auto &proj = mProject;
@@ -1777,7 +2123,10 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
          // when pushing.  Don't auto-save it.
          return;
       }
-      useTrack->WriteXML(xmlFile);
+      if (writeTrack)
+         writeTrack(xmlFile, *useTrack);
+      else
+         useTrack->WriteXML(xmlFile);
    });
 
    xmlFile.EndTag(wxT("project"));
@@ -1785,19 +2134,101 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
    //TIMER_STOP( xml_writer_timer );
 }
 
+bool ProjectFileIO::DiscardAutoSaveDelta()
+{
+   mAutoSaveDelta.Reset();
+   mHasAutoSaveDelta = false;
+   return Query("DELETE FROM main.autosave WHERE id = 2;",
+      [](auto...) { return 0; });
+}
+
 bool ProjectFileIO::AutoSave(bool recording)
 {
+   auto &autoSaveFragments = *mpAutoSaveFragments;
+
+   const auto db = DB();
+   const auto haveBase = !mAutoSaveDelta.IsEmpty() && mAutoSaveDeltaDB == db;
+   if (!haveBase)
+      autoSaveFragments.fragments.clear();
+
+   // Serialize the changed tracks and copy the others from the last autosave
    ProjectSerializer autosave;
+   std::vector<AutoSaveDelta::Fragment> fragments;
+   std::vector<TrackId> fragmentTracks;
+   decltype(autoSaveFragments.fragments) newFragments;
    WriteXMLHeader(autosave);
-   WriteXML(autosave, recording);
+   WriteXML(autosave, recording, nullptr,
+      [&](XMLWriter &, const Track &track) {
+         const auto begin = autosave.GetData().GetSize();
+         fragmentTracks.push_back(track.GetId());
+         if (const auto pFragment = autoSaveFragments.Find(track)) {
+            auto &bytes = pFragment->bytes;
+            autosave.WriteSerialized(bytes.data(), bytes.size());
+            fragments.push_back(
+               { { begin, begin + bytes.size() }, pFragment->base });
+            newFragments.emplace(track.GetId(), std::move(*pFragment));
+            return;
+         }
+         track.WriteXML(autosave);
+         const auto end = autosave.GetData().GetSize();
+         fragments.push_back({ { begin, end }, {} });
+         if (const auto pTrack = dynamic_cast<const WaveTrack *>(&track))
+            newFragments.emplace(track.GetId(), AutoSaveFragments::Fragment{
+               std::static_pointer_cast<const WaveTrack>(pTrack->Duplicate()),
+               CopyStreamRange(autosave.GetData(), begin, end), {} });
+      });
+   // Forget the tracks that are gone
+   autoSaveFragments.fragments.swap(newFragments);
+
+   const auto &data = autosave.GetData();
 
-   if (WriteDoc("autosave", autosave))
+   // Write only the tracks that changed since the last full document, unless
+   // so much changed that replaying the delta would cost more than half of
+   // loading a full document
+   if (haveBase)
    {
-      mModified = true;
-      return true;
+      MemoryStream delta;
+      const auto literalBytes = mAutoSaveDelta.Encode(
+         data.GetData(), data.GetSize(), fragments, delta);
+      if (literalBytes <= mAutoSaveDelta.BaseSize() / 2)
+      {
+         // WriteDoc stamps the version that the delta requires
+         mHasAutoSaveDelta = true;
+         if (!WriteDoc("autosave", autosave.GetDict(), delta, "main", 2))
+            return false;
+         mModified = true;
+         return true;
+      }
    }
 
-   return false;
+   {
+      // Replace the full document and remove any delta from the old one
+      // together
+      const auto hadDelta = mHasAutoSaveDelta;
+      TransactionScope transaction(mProject, "AutoSave");
+      if (!DiscardAutoSaveDelta() ||
+          !WriteDoc("autosave", autosave) ||
+          !transaction.Commit())
+      {
+         mHasAutoSaveDelta = hadDelta;
+         return false;
+      }
+   }
+   std::vector<AutoSaveDelta::Range> ranges;
+   for (const auto &fragment : fragments)
+      ranges.push_back(fragment.range);
+   mAutoSaveDelta.SetBase(data.GetData(), data.GetSize(), ranges);
+   mAutoSaveDeltaDB = db;
+
+   // Remember where the kept serializations are in the new base
+   for (size_t ii = 0; ii < fragments.size(); ++ii) {
+      const auto iter = autoSaveFragments.fragments.find(fragmentTracks[ii]);
+      if (iter != autoSaveFragments.fragments.end())
+         iter->second.base = fragments[ii].range;
+   }
+
+   mModified = true;
+   return true;
 }
 
 bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
@@ -1809,6 +2240,7 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       db = DB();
    }
 
+   mAutoSaveDelta.Reset();
    rc = sqlite3_exec(db, "DELETE FROM autosave;", nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
@@ -1821,29 +2253,60 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       return false;
    }
 
+   if (mHasAutoSaveDelta)
+   {
+      // The delta no longer requires a newer version to open the file
+      mHasAutoSaveDelta = false;
+      const auto requiredVersion =
+         ProjectFormatExtensionsRegistry::Get().GetRequiredVersion(mProject);
+      char sql[64];
+      sqlite3_snprintf(sizeof(sql), sql,
+         "PRAGMA user_version = %u;", requiredVersion.GetPacked());
+      // Failure leaves only a stricter version than needed
+      (void) sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
+   }
+
    mModified = false;
 
    return true;
 }
 
+bool ProjectFileIO::FlushPendingBlocks()
+{
+   return GuardedCall<bool>( [this]{
+      ConnectionPtr::Get(mProject).FlushPendingBlocks();
+      return true;
+   } );
+}
+
 bool ProjectFileIO::WriteDoc(const char *table,
                              const ProjectSerializer &autosave,
                              const char *schema /* = "main" */)
+{
+   return WriteDoc(table, autosave.GetDict(), autosave.GetData(), schema, 1);
+}
+
+bool ProjectFileIO::WriteDoc(const char *table, const MemoryStream &dict,
+   const MemoryStream &data, const char *schema, int id)
 {
    auto db = DB();
 
+   // The document must not refer to blocks missing from the database,
+   // and the flushing must not happen inside the transaction below
+   if (!FlushPendingBlocks())
+      return false;
+
    TransactionScope transaction(mProject, "UpdateProject");
 
    int rc;
 
-   // For now, we always use an ID of 1. This will replace the previously
-   // written row every time.
+   // This will replace the previously written row every time.
    char sql[256];
    sqlite3_snprintf(
       sizeof(sql), sql,
-      "INSERT INTO %s.%s(id, dict, doc) VALUES(1, ?1, ?2)"
+      "INSERT INTO %s.%s(id, dict, doc) VALUES(%d, ?1, ?2)"
       "       ON CONFLICT(id) DO UPDATE SET dict = ?1, doc = ?2;",
-      schema, table);
+      schema, table, id);
 
    sqlite3_stmt *stmt = nullptr;
    auto cleanup = finally([&]
@@ -1867,9 +2330,6 @@ bool ProjectFileIO::WriteDoc(const char *table,
       return false;
    }
 
-   const MemoryStream& dict = autosave.GetDict();
-   const MemoryStream& data = autosave.GetData();
-
    // Bind statement parameters
    // Might return SQL_MISUSE which means it's our mistake that we violated
    // preconditions; should return SQL_OK which is 0
@@ -1911,8 +2371,8 @@ bool ProjectFileIO::WriteDoc(const char *table,
 
    int64_t rowID = 0;
 
-   const wxString rowIDSql =
-      wxString::Format("SELECT ROWID FROM %s.%s WHERE id = 1;", schema, table);
+   const wxString rowIDSql = wxString::Format(
+      "SELECT ROWID FROM %s.%s WHERE id = %d;", schema, table, id);
 
    if (!GetValue(rowIDSql, rowID, true))
    {
@@ -2066,10 +2526,46 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    else
    {
       // Load 'er up
-      BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
+      int64_t deltaRowId = -1;
+      std::vector<uint8_t> dict, doc;
+      if (useAutosave &&
+          GetValue("SELECT ROWID FROM main.autosave WHERE id = 2;",
+             deltaRowId, true))
+      {
+         // Apply the delta to the full autosave document
+         std::vector<uint8_t> base, delta;
+         if (!(ReadBlob(DB(), "autosave", "doc", rowId, base) &&
+               ReadBlob(DB(), "autosave", "doc", deltaRowId, delta) &&
+               ReadBlob(DB(), "autosave", "dict", deltaRowId, dict) &&
+               AutoSaveDelta::Apply(base.data(), base.size(),
+                  delta.data(), delta.size(), doc)))
+         {
+            wxLogWarning("Ignoring an autosave delta that does not apply");
+            deltaRowId = -1;
+            BasicUI::ShowErrorDialog( {},
+               XO("Warning"),
+               XO("The most recent changes to the project could not be "
+                  "recovered.\nThe project is recovered as it was at an "
+                  "earlier automatic save."),
+               ""
+               );
+         }
+      }
 
-      success = ProjectSerializer::Decode(stream, this);
+      if (deltaRowId >= 0)
+      {
+         BufferedProjectMemoryStream stream(dict, doc);
+         success = ProjectSerializer::Decode(stream, this);
+         // The row stays until the next full autosave replaces it
+         if (success)
+            mHasAutoSaveDelta = true;
+      }
+      else
+      {
+         BufferedProjectBlobStream stream(
+            DB(), "main", useAutosave ? "autosave" : "project", rowId);
+         success = ProjectSerializer::Decode(stream, this);
+      }
 
       if (!success)
       {
@@ -2543,6 +3039,7 @@ int64_t ProjectFileIO::GetBlockUsage(SampleBlockID blockid)
    auto pConn = CurrConn().get();
    if (!pConn)
       return 0;
+   FlushPendingBlocks();
    return GetDiskUsage(*pConn, blockid);
 }
 
@@ -2568,6 +3065,7 @@ int64_t ProjectFileIO::GetTotalUsage()
    auto pConn = CurrConn().get();
    if (!pConn)
       return 0;
+   FlushPendingBlocks();
    return GetDiskUsage(*pConn, 0);
 }
 
@@ -2582,13 +3080,9 @@ int64_t ProjectFileIO::GetDiskUsage(DBConnection &conn, SampleBlockID blockid /*
 
    if (blockid == 0)
    {
+      // Kept by triggers; see UsageLedgerSchema
       static const char* statement =
-R"(SELECT
-	sum(length(blockid) + length(sampleformat) +
-	length(summin) + length(summax) + length(sumrms) +
-	length(summary256) + length(summary64k) +
-	length(samples))
-FROM sampleblocks;)";
+R"(SELECT bytes FROM sampleblockusage WHERE id = 1;)";
 
       stmt = conn.Prepare(DBConnection::GetAllSampleBlocksSize, statement);
    }
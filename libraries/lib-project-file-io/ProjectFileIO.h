@@ -11,15 +11,18 @@ Paul Licameli split from AudacityProject.h
 #ifndef __AUDACITY_PROJECT_FILE_IO__
 #define __AUDACITY_PROJECT_FILE_IO__
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <unordered_set>
 
 #include <wx/event.h>
 
+#include "AutoSaveDelta.h"
 #include "ClientData.h" // to inherit
 #include "Observer.h"
 #include "Prefs.h" // to inherit
+#include "SampleBlockCodec.h"
 #include "XMLTagHandler.h" // to inherit
 
 struct sqlite3;
@@ -30,8 +33,10 @@ struct sqlite3_value;
 class AudacityProject;
 class DBConnection;
 struct DBConnectionErrors;
+class MemoryStream;
 class ProjectSerializer;
 class SqliteSampleBlock;
+class Track;
 class TrackList;
 class WaveTrack;
 
@@ -46,6 +51,13 @@ using Connection = std::unique_ptr<DBConnection>;
 
 using BlockIDs = std::unordered_set<SampleBlockID>;
 
+//! Encoding of samples of new blocks, read when a project is opened
+extern PROJECT_FILE_IO_API EnumSetting<SampleBlockCodec::Codec>
+   SampleBlockCodecSetting;
+//! Megabytes of decoded samples that each project keeps for reading again,
+//! read when a project is opened
+extern PROJECT_FILE_IO_API IntSetting DecodedBlockCacheSize;
+
 //! Subscribe to ProjectFileIO to receive messages; always in idle time
 enum class ProjectFileIOMessage : int {
    CheckpointFailure,   //!< Failure happened in a worker thread
@@ -113,6 +125,10 @@ public:
    bool AutoSave(bool recording = false);
    bool AutoSaveDelete(sqlite3 *db = nullptr);
 
+   //! Whether the autosave table holds a delta, which older versions of
+   //! Audacity would ignore
+   bool HasAutoSaveDelta() const { return mHasAutoSaveDelta; }
+
    bool OpenProject();
    void CloseProject();
    bool ReopenProject();
@@ -232,8 +248,11 @@ private:
    void OnCheckpointFailure();
 
    void WriteXMLHeader(XMLWriter &xmlFile) const;
+   //! Writes one track, in place of Track::WriteXML
+   using TrackWriter = std::function<void(XMLWriter &, const Track &)>;
    void WriteXML(XMLWriter &xmlFile, bool recording = false,
-      const TrackList *tracks = nullptr) /* not override */;
+      const TrackList *tracks = nullptr,
+      const TrackWriter &writeTrack = {}) /* not override */;
 
    // XMLTagHandler callback methods
    bool HandleXMLTag(const std::string_view& tag, const AttributesList &attrs) override;
@@ -271,9 +290,20 @@ private:
 
    bool CheckVersion();
    bool InstallSchema(sqlite3 *db, const char *schema = "main");
+   //! Create the table of the count and size of sample blocks, and the
+   //! triggers that update it, computing it from the blocks already present
+   bool InstallUsageLedger(sqlite3 *db, const char *schema = "main");
+
+   //! Insert sample blocks still queued for writing; report errors
+   bool FlushPendingBlocks();
 
    // Write project or autosave XML (binary) documents
    bool WriteDoc(const char *table, const ProjectSerializer &autosave, const char *schema = "main");
+   //! Remove the autosave delta from the database and forget its base
+   bool DiscardAutoSaveDelta();
+   //! Write the row with the given id, with the dictionary and data
+   bool WriteDoc(const char *table, const MemoryStream &dict,
+      const MemoryStream &data, const char *schema, int id);
 
    // Application defined function to verify blockid exists is in set of blockids
    static void InSet(sqlite3_context *context, int argc, sqlite3_value **argv);
@@ -300,6 +330,13 @@ private:
        int errorCode = -1);
 
    bool ShouldCompact(const std::vector<const TrackList *> &tracks);
+   //! Whether the file was made with incremental auto-vacuum
+   bool CanCompactInPlace();
+   //! Whether enough of the file is free pages to reclaim them in place
+   bool ShouldReclaimFreePages();
+   //! Delete blocks not in the tracks and reclaim free pages a few at a time,
+   //! without copying the file; may be cancelled, and resumed by another call
+   bool CompactInPlace(const std::vector<const TrackList *> &tracks);
 
 private:
    Connection &CurrConn();
@@ -332,6 +369,17 @@ private:
    Connection mPrevConn;
    FilePath mPrevFileName;
    bool mPrevTemporary;
+
+   //! The last full autosave document written in this run, from which
+   //! later autosaves are written as deltas
+   AutoSaveDelta mAutoSaveDelta;
+   //! The database to which mAutoSaveDelta's base was written
+   sqlite3 *mAutoSaveDeltaDB{};
+   bool mHasAutoSaveDelta{ false };
+
+   struct AutoSaveFragments;
+   //! Serializations of the tracks in the last autosave
+   std::unique_ptr<AutoSaveFragments> mpAutoSaveFragments;
 };
 
 //! Makes a temporary project that doesn't display on the screen
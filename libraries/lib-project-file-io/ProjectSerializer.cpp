@@ -22,6 +22,7 @@
 #include <codecvt>
 #include <locale>
 #include <deque>
+#include <optional>
 
 #include <wx/log.h>
 
@@ -221,14 +222,28 @@ public:
       mHandlers.pop_back();
    }
 
-   void WriteAttr(const std::string_view& name, std::string value)
+   //! A string to fill with an attribute value or content, then pass to
+   //! WriteAttr or WriteData
+   /*!
+    The string keeps its capacity for reuse after the tag is emitted, so that
+    decoding does not allocate for each attribute
+    */
+   std::string& NextString()
+   {
+      if (mStringsUsed == mStringsCache.size())
+         mStringsCache.emplace_back();
+      return mStringsCache[mStringsUsed++];
+   }
+
+   //! @pre `value` was obtained from NextString()
+   void WriteAttr(const std::string_view& name, const std::string& value)
    {
       assert(mInTag);
 
       if (!mInTag)
          return;
 
-      mAttributes.emplace_back(name, CacheString(std::move(value)));
+      mAttributes.emplace_back(name, std::string_view{ value });
    }
 
    template <typename T> void WriteAttr(const std::string_view& name, T value)
@@ -241,16 +256,18 @@ public:
       mAttributes.emplace_back(name, XMLAttributeValueView(value));
    }
 
-   void WriteData(std::string value)
+   //! @pre `value` was obtained from NextString()
+   void WriteData(const std::string& value)
    {
+      // Emitting the tag releases, but does not overwrite, the value
       if (mInTag)
          EmitStartTag();
 
       if (XMLTagHandler* const handler = mHandlers.back())
-         handler->HandleXMLContent(CacheString(std::move(value)));
+         handler->HandleXMLContent(value);
    }
 
-   void WriteRaw(std::string)
+   void WriteRaw()
    {
       // This method is intentionally left empty.
       // The only data that is serialized by FT_Raw
@@ -295,24 +312,20 @@ private:
          }
       }
 
-      mStringsCache.clear();
+      mStringsUsed = 0;
       mAttributes.clear();
       mInTag = false;
    }
 
-   std::string_view CacheString(std::string string)
-   {
-      mStringsCache.emplace_back(std::move(string));
-      return mStringsCache.back();
-   }
-
    XMLTagHandler* mBaseHandler;
 
    std::vector<XMLTagHandler*> mHandlers;
 
    std::string_view mCurrentTagName;
 
+   //! Growing a deque does not move the strings that the attributes view
    std::deque<std::string> mStringsCache;
+   size_t mStringsUsed { 0 };
    AttributesList mAttributes;
 
    bool mInTag { false };
@@ -325,7 +338,7 @@ private:
 // }
 
 template<typename BaseCharType>
-std::string FastStringConvert(const void* bytes, int bytesCount)
+void FastStringConvert(const void* bytes, int bytesCount, std::string& result)
 {
    constexpr int charSize = sizeof(BaseCharType);
 
@@ -334,16 +347,22 @@ std::string FastStringConvert(const void* bytes, int bytesCount)
    const auto begin = static_cast<const BaseCharType*>(bytes);
    const auto end = begin + bytesCount / charSize;
 
-   const bool isAscii = std::all_of(
-      begin, end,
-      [](BaseCharType c)
-      { return static_cast<std::make_unsigned_t<BaseCharType>>(c) < 0x7f; });
-
-   if (isAscii)
-      return std::string(begin, end);
-   
-   return std::wstring_convert<std::codecvt_utf8<BaseCharType>, BaseCharType>()
-      .to_bytes(begin, end);
+   // Narrow in place, assuming ASCII, which is the usual case; this reuses
+   // the capacity of result
+   result.resize(end - begin);
+   auto out = result.begin();
+   for (auto p = begin; p != end; ++p, ++out)
+   {
+      const auto c = static_cast<std::make_unsigned_t<BaseCharType>>(*p);
+      if (c >= 0x7f)
+      {
+         result = std::wstring_convert<
+            std::codecvt_utf8<BaseCharType>, BaseCharType>()
+               .to_bytes(begin, end);
+         return;
+      }
+      *out = static_cast<char>(c);
+   }
 }
 } // namespace
 
@@ -469,6 +488,11 @@ void ProjectSerializer::Write(const wxString & value)
    mBuffer.AppendData(value.wx_str(), len);
 }
 
+void ProjectSerializer::WriteSerialized(const void *data, size_t size)
+{
+   mBuffer.AppendData(data, size);
+}
+
 void ProjectSerializer::WriteName(const wxString & name)
 {
    wxASSERT(name.length() * sizeof(wxStringCharType) <= SHRT_MAX);
@@ -528,30 +552,32 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
    XMLTagHandlerAdapter adapter(handler);
 
    std::vector<char> bytes;
+   // Names indexed by id, which are small and dense; a deque, so that
+   // views of names stay valid while it grows
+   using IdMap = std::deque<std::optional<std::string>>;
    IdMap mIds;
    std::vector<IdMap> mIdStack;
    char mCharSize = 0;
 
-   mIds.clear();
-
    struct Error{}; // exception type for short-range try/catch
    auto Lookup = [&mIds]( UShort id ) -> std::string_view
    {
-      auto iter = mIds.find( id );
-      if (iter == mIds.end())
+      if (id >= mIds.size() || !mIds[id])
       {
          throw Error{};
       }
 
-      return iter->second;
+      return *mIds[id];
    };
 
    int64_t stringsCount = 0;
    int64_t stringsLength = 0;
 
-   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len) -> std::string
+   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len, std::string& result)
    {
-      bytes.reserve( len );
+      if (len < 0)
+         throw Error{};
+      bytes.resize( len );
       auto data = bytes.data();
       in.Read( data, len );
 
@@ -561,20 +587,23 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
       switch (mCharSize)
       {
          case 1:
-            return std::string(bytes.data(), len);
+            result.assign(bytes.data(), len);
+            return;
 
          case 2:
-            return FastStringConvert<char16_t>(bytes.data(), len);
+            FastStringConvert<char16_t>(bytes.data(), len, result);
+            return;
 
          case 4:
-            return FastStringConvert<char32_t>(bytes.data(), len);
+            FastStringConvert<char32_t>(bytes.data(), len, result);
+            return;
 
          default:
             wxASSERT_MSG(false, wxT("Characters size not 1, 2, or 4"));
          break;
       }
 
-      return {};
+      result.clear();
    };
 
    try
@@ -603,7 +632,9 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                auto len = ReadUShort( in );
-               mIds[id] = ReadString(len);
+               if (id >= mIds.size())
+                  mIds.resize(id + 1);
+               ReadString(len, mIds[id].emplace());
             }
             break;
 
@@ -627,8 +658,10 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                int len = ReadLength( in );
-               
-               adapter.WriteAttr(Lookup(id), ReadString(len));
+               auto& value = adapter.NextString();
+               ReadString(len, value);
+
+               adapter.WriteAttr(Lookup(id), value);
             }
             break;
 
@@ -705,14 +738,21 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             case FT_Data:
             {
                int len = ReadLength( in );
-               adapter.WriteData(ReadString(len));
+               auto& value = adapter.NextString();
+               ReadString(len, value);
+               adapter.WriteData(value);
             }
             break;
 
             case FT_Raw:
             {
                int len = ReadLength( in );
-               adapter.WriteRaw(ReadString(len));
+               if (len < 0)
+                  throw Error{};
+               // Skip it
+               bytes.resize( len );
+               in.Read( bytes.data(), len );
+               adapter.WriteRaw();
             }
             break;
 
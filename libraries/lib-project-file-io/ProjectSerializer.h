@@ -30,7 +30,6 @@ class BufferedStreamReader;
 ///
 
 using NameMap = std::unordered_map<wxString, unsigned short>;
-using IdMap = std::unordered_map<unsigned short, std::string>;
 
 // This class's overrides do NOT throw AudacityException.
 class PROJECT_FILE_IO_API ProjectSerializer final : public XMLWriter
@@ -59,6 +58,13 @@ public:
    void WriteData(const wxString & value) override;
    void Write(const wxString & data) override;
 
+   //! Append data that a serializer wrote earlier in this run
+   /*!
+    Names in the data were added to the dictionary shared by all serializers
+    of the run, so they stay valid.
+    */
+   void WriteSerialized(const void *data, size_t size);
+
    const MemoryStream& GetDict() const;
    const MemoryStream& GetData() const;
 
@@ -0,0 +1,276 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SpectrogramTileStore.cpp
+
+**********************************************************************/
+#include "SpectrogramTileStore.h"
+
+#include <sqlite3.h>
+
+#include "BasicUI.h"
+#include "DBConnection.h"
+#include "MemoryX.h"
+#include "Project.h"
+
+#include <wx/log.h>
+#include <wx/string.h>
+
+#include <cstring>
+
+BoolSetting SpectrogramTileCacheSetting{
+   L"/ProjectFile/SpectrogramTileCache", false };
+
+namespace {
+// CREATE SQL spectrogramtiles
+// Not part of ProjectFileSchema:  created on demand, so that projects never
+// shown as spectrograms don't have it.  Rows are a cache that may be dropped
+// at any time; the trigger keeps them from outliving their sample blocks.
+// One row per block, so that changes of settings or zoom replace rows.
+const char* TileSchema =
+   "CREATE TABLE IF NOT EXISTS <schema>.spectrogramtiles"
+   "("
+   "  blockid              INTEGER PRIMARY KEY,"
+   "  params               INTEGER,"
+   "  columns              INTEGER,"
+   "  context              INTEGER,"
+   "  data                 BLOB"
+   ");"
+   "CREATE TRIGGER IF NOT EXISTS <schema>.spectrogramtiles_delete"
+   "  AFTER DELETE ON sampleblocks"
+   "  BEGIN"
+   "    DELETE FROM spectrogramtiles WHERE blockid = old.blockid;"
+   "  END;";
+
+bool InstallTileSchema(sqlite3* db, const char* schema)
+{
+   wxString sql{ TileSchema };
+   sql.Replace("<schema>", schema);
+   if (sqlite3_exec(db, sql.ToUTF8(), nullptr, nullptr, nullptr) != SQLITE_OK)
+   {
+      wxLogDebug(wxT("SpectrogramTileStore - SQLITE error %s"),
+         sqlite3_errmsg(db));
+      return false;
+   }
+   return true;
+}
+
+bool HasTileTable(sqlite3* db, const char* schema)
+{
+   wxString sql;
+   sql.Printf("SELECT 1 FROM %s.sqlite_master"
+      " WHERE type = 'table' AND name = 'spectrogramtiles';", schema);
+   bool found = false;
+   sqlite3_exec(db, sql.ToUTF8(),
+      [](void* found, int, char**, char**) {
+         *static_cast<bool*>(found) = true;
+         return 0;
+      }, &found, nullptr);
+   return found;
+}
+}
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sSpectrogramTileStoreKey{
+   [](AudacityProject& project) {
+      return std::make_shared<SpectrogramTileStore>(project);
+   }
+};
+
+SpectrogramTileStore& SpectrogramTileStore::Get(AudacityProject& project)
+{
+   return project.AttachedObjects::Get<SpectrogramTileStore>(
+      sSpectrogramTileStoreKey);
+}
+
+SpectrogramTileStore::SpectrogramTileStore(AudacityProject& project)
+    : mProject { project }
+{
+}
+
+SpectrogramTileStore::~SpectrogramTileStore() = default;
+
+DBConnection* SpectrogramTileStore::GetConnection(bool create)
+{
+   auto& pConnection = ConnectionPtr::Get(mProject).mpConnection;
+   if (!pConnection)
+      return nullptr;
+   // The connection may have been redirected to another file since the
+   // last call
+   const auto db = pConnection->DB();
+   if (db != mCheckedDB)
+   {
+      mCheckedDB = db;
+      mHasTable = HasTileTable(db, "main");
+   }
+   if (!mHasTable)
+   {
+      if (!create || !InstallTileSchema(db, "main"))
+         return nullptr;
+      mHasTable = true;
+   }
+   return pConnection.get();
+}
+
+bool SpectrogramTileStore::Load(
+   const Key& key, unsigned long long context, std::vector<int16_t>& data)
+try
+{
+   const auto matches = [&](unsigned long long params, size_t nColumns,
+      unsigned long long tileContext) {
+      return params == key.params && nColumns == key.nColumns &&
+         tileContext == context;
+   };
+
+   if (const auto iter = mPending.find(key.blockID); iter != mPending.end())
+   {
+      const auto& tile = iter->second;
+      if (!matches(tile.key.params, tile.key.nColumns, tile.context))
+         return false;
+      data = tile.data;
+      return true;
+   }
+
+   const auto pConnection = GetConnection(false);
+   if (!pConnection)
+      return false;
+
+   // BIND SQL spectrogramtiles
+   // Prepare and cache statement...automatically finalized at DB close
+   const auto stmt = pConnection->Prepare(DBConnection::LoadSpectrogramTile,
+      "SELECT params, columns, context, data FROM spectrogramtiles"
+      "  WHERE blockid = ?1;");
+   auto cleanup = finally([stmt] {
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+
+   if (sqlite3_bind_int64(stmt, 1, key.blockID))
+   {
+      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      return false;
+   }
+
+   if (sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+
+   if (!matches(
+      static_cast<unsigned long long>(sqlite3_column_int64(stmt, 0)),
+      sqlite3_column_int64(stmt, 1),
+      static_cast<unsigned long long>(sqlite3_column_int64(stmt, 2))))
+      return false;
+
+   const auto blob = sqlite3_column_blob(stmt, 3);
+   const size_t bytes = sqlite3_column_bytes(stmt, 3);
+   data.resize(bytes / sizeof(int16_t));
+   if (bytes > 0)
+      memcpy(data.data(), blob, data.size() * sizeof(int16_t));
+   return true;
+}
+catch (...)
+{
+   return false;
+}
+
+void SpectrogramTileStore::Store(std::vector<Tile> tiles)
+{
+   if (tiles.empty())
+      return;
+
+   for (auto& tile : tiles)
+   {
+      const auto blockID = tile.key.blockID;
+      mPending.insert_or_assign(blockID, std::move(tile));
+   }
+
+   if (!mFlushScheduled)
+   {
+      mFlushScheduled = true;
+      BasicUI::CallAfter([wThis = weak_from_this()]{
+         if (auto pThis = wThis.lock())
+            pThis->Flush();
+      });
+   }
+}
+
+void SpectrogramTileStore::Flush()
+try
+{
+   mFlushScheduled = false;
+   // Tiles are a cache:  those that fail to be written are dropped
+   const auto pending = std::move(mPending);
+   mPending.clear();
+   if (pending.empty())
+      return;
+
+   const auto pConnection = GetConnection(true);
+   if (!pConnection)
+      return;
+   const auto db = pConnection->DB();
+   const auto writeLock = pConnection->LockForWriting();
+
+   // A savepoint, not BEGIN, because there may be an outer transaction
+   if (sqlite3_exec(db, "SAVEPOINT SpectrogramTiles;",
+      nullptr, nullptr, nullptr) != SQLITE_OK)
+      return;
+   auto release = finally([db] {
+      sqlite3_exec(db, "RELEASE SpectrogramTiles;", nullptr, nullptr, nullptr);
+   });
+
+   // BIND SQL spectrogramtiles
+   // Rows of blocks still in the write-behind queue are skipped, so that no
+   // row can refer to a block id that is released without being inserted
+   const auto stmt = pConnection->Prepare(DBConnection::StoreSpectrogramTile,
+      "INSERT OR REPLACE INTO spectrogramtiles"
+      "  (blockid, params, columns, context, data)"
+      "  SELECT ?1, ?2, ?3, ?4, ?5"
+      "  WHERE EXISTS (SELECT 1 FROM sampleblocks WHERE blockid = ?1);");
+
+   for (const auto& [blockID, tile] : pending)
+   {
+      auto cleanup = finally([stmt] {
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
+      });
+      const auto& key = tile.key;
+      if (sqlite3_bind_int64(stmt, 1, key.blockID) ||
+          sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(key.params)) ||
+          sqlite3_bind_int64(stmt, 3, key.nColumns) ||
+          sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(tile.context)) ||
+          sqlite3_bind_blob(stmt, 5, tile.data.data(),
+             tile.data.size() * sizeof(int16_t), SQLITE_STATIC))
+      {
+         wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+         return;
+      }
+      if (sqlite3_step(stmt) != SQLITE_DONE)
+      {
+         // Perhaps the disk is full; nothing depends on the tiles
+         wxLogDebug(wxT("SpectrogramTileStore::Flush - SQLITE error %s"),
+            sqlite3_errmsg(db));
+         return;
+      }
+   }
+}
+catch (...)
+{
+}
+
+void SpectrogramTileStore::CopyTo(sqlite3* db, const char* schema)
+{
+   if (!HasTileTable(db, "main") || !InstallTileSchema(db, schema))
+      return;
+
+   wxString sql;
+   sql.Printf(
+      "INSERT INTO %s.spectrogramtiles"
+      "  SELECT * FROM main.spectrogramtiles"
+      "  WHERE blockid IN (SELECT blockid FROM %s.sampleblocks);",
+      schema, schema);
+   if (sqlite3_exec(db, sql.ToUTF8(), nullptr, nullptr, nullptr) != SQLITE_OK)
+      wxLogDebug(wxT("SpectrogramTileStore::CopyTo - SQLITE error %s"),
+         sqlite3_errmsg(db));
+}
@@ -0,0 +1,106 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SpectrogramTileStore.h
+
+  @brief Persistence of spectrogram columns computed from sample blocks
+
+**********************************************************************/
+#pragma once
+
+#include "ClientData.h" // to inherit
+#include "Prefs.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+class AudacityProject;
+class DBConnection;
+
+//! Whether spectrograms computed for display are kept in the project file
+extern PROJECT_FILE_IO_API BoolSetting SpectrogramTileCacheSetting;
+
+//! Keeps spectrogram columns in the project database, so that they need not
+//! be computed again after the project is reopened
+/*!
+ A tile holds the columns computed from the samples of one block, in an
+ encoding chosen by the caller.  Columns near the ends of the block also read
+ samples of neighbouring blocks, so a tile also records a hash of those, and
+ is found only while the block has the same neighbours.
+
+ A block has at most one tile, so that the table grows only with the
+ project:  storing a tile replaces any other of the same block, whatever its
+ settings or count of columns.  Tiles are deleted with their blocks.
+
+ Stored tiles are queued, and written to the database in one transaction
+ when the application is next idle, so that drawing does not wait for the
+ disk.  A tile is not written for a block not yet in the database.  The
+ table is created by the first write, so that loading from a project without
+ tiles changes nothing in its file.
+
+ Failures are only logged; no member function throws.
+ */
+class PROJECT_FILE_IO_API SpectrogramTileStore final
+   : public ClientData::Base
+   , public std::enable_shared_from_this<SpectrogramTileStore>
+{
+public:
+   struct Key final
+   {
+      long long blockID;
+      //! Hash of the analysis settings
+      unsigned long long params;
+      size_t nColumns;
+   };
+
+   struct Tile final
+   {
+      Key key;
+      //! Hash of the sequence of ids of blocks whose samples were read
+      unsigned long long context;
+      std::vector<int16_t> data;
+   };
+
+   static SpectrogramTileStore& Get(AudacityProject& project);
+
+   explicit SpectrogramTileStore(AudacityProject& project);
+   ~SpectrogramTileStore() override;
+
+   //! @return whether a tile with the given key and context was found,
+   //! queued or in the database, and then `data` holds its contents
+   bool Load(const Key& key, unsigned long long context,
+      std::vector<int16_t>& data);
+
+   //! Queue the tiles to be written later, replacing any of the same blocks
+   void Store(std::vector<Tile> tiles);
+
+   //! Write all queued tiles now, in one transaction
+   void Flush();
+
+   //! Copy the tiles of blocks present in the attached database `schema`
+   /*!
+    Used when the project is compacted or saved to another file; does nothing
+    if no tile was ever stored
+    */
+   static void CopyTo(sqlite3* db, const char* schema);
+
+private:
+   /*!
+    @param create whether to create the table if the database lacks it
+    @return null if there is no connection, or no table
+    */
+   DBConnection* GetConnection(bool create);
+
+   AudacityProject& mProject;
+   //! The database that mHasTable describes
+   sqlite3* mCheckedDB {};
+   bool mHasTable { false };
+   //! Tiles not yet written, by block id
+   std::unordered_map<long long, Tile> mPending;
+   bool mFlushScheduled { false };
+};
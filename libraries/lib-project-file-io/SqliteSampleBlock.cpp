@@ -13,7 +13,10 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 
 #include "BasicUI.h"
 #include "DBConnection.h"
+#include "LRUCache.h"
 #include "ProjectFileIO.h"
+#include "ProjectFormatExtensionsRegistry.h"
+#include "SampleBlockCodec.h"
 #include "SampleFormat.h"
 #include "AudioSegmentSampleView.h"
 #include "XMLTagHandler.h"
@@ -25,12 +28,41 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include "WaveTrackUtilities.h"
 
 #include "SentryHelper.h"
+#include "concurrency/WorkStealingPool.h"
 #include <wx/log.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 class SqliteSampleBlockFactory;
 
+namespace {
+//! Lets a worker, or else the first thread that needs the results, prepare
+//! a block, so that no thread waits for a task still queued behind others
+struct PrepareOnce final
+{
+   //! Invoke `prepare` unless it was invoked already; wait while another
+   //! thread invokes it.  Keep what it throws.
+   template<typename Prepare> void operator()(const Prepare& prepare)
+   {
+      std::call_once(flag, [&]{
+         try {
+            prepare();
+         }
+         catch (...) {
+            error = std::current_exception();
+         }
+      });
+   }
+
+   std::once_flag flag;
+   std::exception_ptr error;
+};
+}
+
 ///\brief Implementation of @ref SampleBlock using Sqlite database
 class SqliteSampleBlock final : public SampleBlock
 {
@@ -53,6 +85,8 @@ public:
 
    //! Numbers of bytes needed for 256 and for 64k summaries
    using Sizes = std::pair< size_t, size_t >;
+   //! Insert the row, with the id reserved by SetSamples
+   /*! The factory's pending mutex must be held */
    void Commit(Sizes sizes);
 
    void Delete();
@@ -84,24 +118,47 @@ public:
 private:
    bool IsSilent() const { return mBlockID <= 0; }
    void Load(SampleBlockID sbid);
+   //! All samples as floats, found in or added to the factory's cache
+   /*! May throw */
+   std::shared_ptr<std::vector<float>> GetDecoded();
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
                    DBConnection::StatementID id,
                    const char *sql);
+   //! @param samples whether the blob holds the samples, which may be
+   //! encoded, rather than a summary
    size_t GetBlob(void *dest,
                   sampleFormat destformat,
                   sqlite3_stmt *stmt,
                   sampleFormat srcformat,
                   size_t srcoffset,
-                  size_t srcbytes);
+                  size_t srcbytes,
+                  bool samples);
+   //! Read from the contents not yet committed, if still pending
+   /*! @return whether the block was pending */
+   bool GetPending(void *dest,
+                   sampleFormat destformat,
+                   const ArrayOf<char> &src,
+                   size_t srcsize,
+                   sampleFormat srcformat,
+                   size_t srcoffset,
+                   size_t srcbytes);
 
    enum {
       fields = 3, /* min, max, rms */
       bytesPerFrame = fields * sizeof(float),
    };
    Sizes SetSizes( size_t numsamples, sampleFormat srcformat );
+   //! Calculate the minimum, maximum, and RMS of the whole block
+   void CalcTotals();
    void CalcSummary(Sizes sizes);
+   //! Calculate the 256 and 64k summaries and encode mSamples
+   void Prepare(Sizes sizes);
+   //! If SetSamples() left Prepare() to a worker, call it now, unless the
+   //! worker has begun, and then wait for it
+   /*! @return whether it succeeded; if not, Commit() rethrows its exception */
+   bool WaitPrepared() noexcept;
 
 private:
    //! This must never be called for silent blocks
@@ -117,6 +174,10 @@ private:
    const std::shared_ptr<SqliteSampleBlockFactory> mpFactory;
    bool mValid{ false };
    bool mLocked = false;
+   //! Whether the id is reserved but the row not yet inserted; then the
+   //! arrays below are still allocated.  Guarded by the factory's mutex
+   bool mPending = false;
+   Sizes mSummarySizes{};
 
    SampleBlockID mBlockID{ 0 };
 
@@ -124,6 +185,11 @@ private:
    size_t mSampleBytes;
    size_t mSampleCount;
    sampleFormat mSampleFormat;
+   //! Encoding of the samples in the database; mSampleBytes and mSamples
+   //! are always for the decoded samples
+   SampleBlockCodec::Codec mCodec{ SampleBlockCodec::Codec::None };
+   //! While pending, the encoded samples, if mCodec is not None
+   std::vector<uint8_t> mEncoded;
 
    ArrayOf<char> mSummary256;
    ArrayOf<char> mSummary64k;
@@ -131,6 +197,12 @@ private:
    double mSumMax;
    double mSumRms;
 
+   //! Not null if SetSamples() posted Prepare() to a worker; the summaries,
+   //! mCodec, and mEncoded may be read only after WaitPrepared(), but the
+   //! totals above are ready before.  Shared with the task, which may run
+   //! after this is destroyed, and then does nothing.
+   std::shared_ptr<PrepareOnce> mpPrepare;
+
 #if defined(WORDS_BIGENDIAN)
 #error All sample block data is little endian...big endian not yet supported
 #endif
@@ -174,13 +246,38 @@ public:
       return mSampleBlockDeletionCallback;
    }
 
+   //! Insert all pending blocks in one transaction
+   /*! May throw, leaving the blocks pending */
+   void Flush();
+
 private:
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
 
+   //! Queue a newly created block for a later Flush
+   void Enqueue(const std::shared_ptr<SqliteSampleBlock> &sb);
+   //! Flushes when enough blocks are pending or the oldest is old enough,
+   //! so that threads that create blocks, such as recording, never write
+   void WriterThread();
+   //! Remove a pending block being destroyed before Flush
+   /*! @return whether the block was pending */
+   bool Forget(SqliteSampleBlock &sb) noexcept;
+
+   //! Maximum number of blocks inserted in one transaction
+   static constexpr size_t MaxPendingBlocks = 64;
+   //! Number of blocks at which the thread that creates them flushes
+   static constexpr size_t MaxQueuedBlocks = 4 * MaxPendingBlocks;
+   //! Maximum age of the oldest block in the queue
+   static constexpr std::chrono::milliseconds MaxPendingDelay{ 1000 };
+
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
+   //! Encoding of new blocks, fixed for the lifetime of the project window;
+   //! blocks already stored keep their own encodings
+   const SampleBlockCodec::Codec mCodec;
+   //! Decoded samples of blocks recently read, beyond the lifetimes of views
+   LRUCache<SampleBlockID, std::vector<float>> mDecodedBlocks;
    Observer::Subscription mUndoSubscription;
    SampleBlock::DeletionCallback mSampleBlockDeletionCallback;
    const std::shared_ptr<ConnectionPtr> mppConnection;
@@ -192,10 +289,25 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+
+   Observer::Subscription mFlushSubscription;
+
+   //! Guards the members below and the mPending flags of blocks
+   std::mutex mPendingMutex;
+   std::vector<std::pair<
+      SqliteSampleBlock*, std::weak_ptr<SqliteSampleBlock>>> mPendingBlocks;
+   std::chrono::steady_clock::time_point mOldestPending;
+   std::condition_variable mPendingChanged;
+   bool mStopWriter{ false };
+
+   std::thread mWriterThread;
 };
 
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
    : mProject{ project }
+   , mCodec{ SampleBlockCodecSetting.ReadEnum() }
+   , mDecodedBlocks{
+      static_cast<size_t>(std::max(0, DecodedBlockCacheSize.Read())) << 20 }
    , mppConnection{ ConnectionPtr::Get(project).shared_from_this() }
 {
    mUndoSubscription = UndoManager::Get(project)
@@ -209,9 +321,24 @@ SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
             return;
          }
       });
+   mFlushSubscription = mppConnection->Subscribe(
+      [this](const FlushPendingBlocksMessage&){ Flush(); });
+   mWriterThread = std::thread{ [this]{ WriterThread(); } };
 }
 
-SqliteSampleBlockFactory::~SqliteSampleBlockFactory() = default;
+SqliteSampleBlockFactory::~SqliteSampleBlockFactory()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mPendingMutex };
+      mStopWriter = true;
+      mPendingChanged.notify_one();
+   }
+   mWriterThread.join();
+
+   const auto stats = mDecodedBlocks.GetStats();
+   wxLogDebug(wxT("Decoded sample block cache: %zu hits, %zu misses, %zu evictions"),
+      stats.hits, stats.misses, stats.evictions);
+}
 
 SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    constSamplePtr src, size_t numsamples, sampleFormat srcformat )
@@ -220,9 +347,152 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    sb->SetSamples(src, numsamples, srcformat);
    // block id has now been assigned
    mAllBlocks[ sb->GetBlockID() ] = sb;
+   Enqueue(sb);
    return sb;
 }
 
+void SqliteSampleBlockFactory::Enqueue(
+   const std::shared_ptr<SqliteSampleBlock> &sb)
+{
+   bool backlog;
+   {
+      std::lock_guard<std::mutex> lock{ mPendingMutex };
+      sb->mPending = true;
+      if (mPendingBlocks.empty()) {
+         mOldestPending = std::chrono::steady_clock::now();
+         // Start the writer's timer
+         mPendingChanged.notify_one();
+      }
+      mPendingBlocks.emplace_back(sb.get(), sb);
+      if (mPendingBlocks.size() >= MaxPendingBlocks)
+         mPendingChanged.notify_one();
+      backlog = mPendingBlocks.size() >= MaxQueuedBlocks;
+   }
+   // The writer is kept waiting, maybe by a transaction of this thread; don't
+   // let memory grow without bound
+   if (backlog)
+      Flush();
+}
+
+void SqliteSampleBlockFactory::WriterThread()
+{
+   std::unique_lock<std::mutex> lock{ mPendingMutex };
+   while (!mStopWriter) {
+      if (mPendingBlocks.empty()) {
+         mPendingChanged.wait(lock);
+         continue;
+      }
+      const auto deadline = mOldestPending + MaxPendingDelay;
+      if (mPendingBlocks.size() < MaxPendingBlocks &&
+          std::chrono::steady_clock::now() < deadline) {
+         mPendingChanged.wait_until(lock, deadline);
+         continue;
+      }
+
+      lock.unlock();
+      bool failed = false;
+      try {
+         Flush();
+      }
+      catch (...) {
+         // The blocks stay pending; a Flush on the main thread reports the
+         // error, if it persists
+         failed = true;
+      }
+      lock.lock();
+      if (failed)
+         mPendingChanged.wait_for(lock, MaxPendingDelay,
+            [this]{ return mStopWriter; });
+   }
+}
+
+void SqliteSampleBlockFactory::Flush()
+{
+   // Declared before the locks, so that destructors of blocks, which may
+   // call Forget() or Delete(), run after unlocking
+   std::vector<std::shared_ptr<SqliteSampleBlock>> blocks;
+
+   auto &pConnection = mppConnection->mpConnection;
+   if (!pConnection)
+      return;
+   // Lock for writing before the queue, as transactions of the main thread
+   // do, and hold it for the whole savepoint
+   const auto writeLock = pConnection->LockForWriting();
+
+   std::lock_guard<std::mutex> lock{ mPendingMutex };
+   if (mPendingBlocks.empty())
+      return;
+
+   // Blocks already expired are left to Forget()
+   blocks.reserve(mPendingBlocks.size());
+   for (auto &pair : mPendingBlocks)
+      if (auto sb = pair.second.lock(); sb && sb->mPending)
+         blocks.push_back(move(sb));
+
+   if (!blocks.empty()) {
+      auto &conn = *pConnection;
+      auto db = conn.DB();
+
+      // A savepoint, not BEGIN, because there may be an outer transaction
+      if (sqlite3_exec(db, "SAVEPOINT SampleBlocks;",
+         nullptr, nullptr, nullptr) != SQLITE_OK)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(conn.GetLastRC()));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlockFactory::Flush::savepoint");
+         conn.ThrowException(true);
+      }
+
+      try {
+         for (auto &sb : blocks)
+            sb->Commit(sb->mSummarySizes);
+      }
+      catch (...) {
+         sqlite3_exec(db, "ROLLBACK TO SampleBlocks; RELEASE SampleBlocks;",
+            nullptr, nullptr, nullptr);
+         throw;
+      }
+
+      if (sqlite3_exec(db, "RELEASE SampleBlocks;",
+         nullptr, nullptr, nullptr) != SQLITE_OK)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(conn.GetLastRC()));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlockFactory::Flush::release");
+         sqlite3_exec(db, "ROLLBACK TO SampleBlocks; RELEASE SampleBlocks;",
+            nullptr, nullptr, nullptr);
+         conn.ThrowException(true);
+      }
+
+      for (auto &sb : blocks) {
+         sb->mPending = false;
+         // Reset local arrays
+         sb->mSamples.reset();
+         sb->mSummary256.reset();
+         sb->mSummary64k.reset();
+         sb->mEncoded = std::vector<uint8_t>{};
+         conn.ReleaseBlockID();
+      }
+   }
+
+   mPendingBlocks.clear();
+}
+
+bool SqliteSampleBlockFactory::Forget(SqliteSampleBlock &sb) noexcept
+{
+   std::lock_guard<std::mutex> lock{ mPendingMutex };
+   if (!sb.mPending)
+      return false;
+
+   sb.mPending = false;
+   const auto end = mPendingBlocks.end(),
+      iter = std::find_if(mPendingBlocks.begin(), end,
+         [&](auto &pair){ return pair.first == &sb; });
+   if (iter != end)
+      mPendingBlocks.erase(iter);
+   if (auto &pConnection = mppConnection->mpConnection)
+      pConnection->ReleaseBlockID();
+   return true;
+}
+
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
    SampleBlockIDs result;
@@ -312,19 +582,15 @@ BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
    if (cache)
       return cache;
 
-   const auto newCache =
-      std::make_shared<std::vector<float>>(mSampleCount);
+   std::shared_ptr<std::vector<float>> newCache;
    try {
-      const auto cachedSize = DoGetSamples(
-         reinterpret_cast<samplePtr>(newCache->data()), floatSample, 0,
-         mSampleCount);
-      assert(cachedSize == mSampleCount);
+      newCache = GetDecoded();
    }
    catch (...)
    {
       if (mayThrow)
          std::rethrow_exception(std::current_exception());
-      std::fill(newCache->begin(), newCache->end(), 0.f);
+      newCache = std::make_shared<std::vector<float>>(mSampleCount, 0.f);
    }
    mCache = newCache;
    return newCache;
@@ -345,6 +611,10 @@ SqliteSampleBlock::SqliteSampleBlock(
 
 SqliteSampleBlock::~SqliteSampleBlock()
 {
+   // The worker must be done with this, or never begin
+   if (mpPrepare)
+      GuardedCall([this]{ (*mpPrepare)([]{}); });
+
    if (
       const auto cb = mpFactory ? mpFactory->GetSampleBlockDeletionCallback() :
                                   SampleBlock::DeletionCallback {})
@@ -352,6 +622,14 @@ SqliteSampleBlock::~SqliteSampleBlock()
       cb(*this);
    }
 
+   // The id might be reused by another block if this one was never inserted
+   if (mpFactory && !IsSilent())
+      mpFactory->mDecodedBlocks.Erase(mBlockID);
+
+   // A block never inserted needs no deletion
+   if (mpFactory && mpFactory->Forget(*this))
+      return;
+
    if (IsSilent()) {
       // The block object was constructed but failed to Load() or Commit().
       // Or it's a silent block with no row in the database.
@@ -397,6 +675,9 @@ DBConnection *SqliteSampleBlock::Conn() const
 void SqliteSampleBlock::CloseLock() noexcept
 {
    mLocked = true;
+   // A locked block must survive in the database
+   if (mpFactory)
+      GuardedCall( [this]{ mpFactory->Flush(); } );
 }
 
 SampleBlockID SqliteSampleBlock::GetBlockID() const
@@ -425,6 +706,33 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
       return numsamples;
    }
 
+   if (destformat == floatSample) {
+      // Reads of the whole block, as for summaries, go through the cache, so
+      // that reading the same region again, as by scrubbing or repainting,
+      // need not query and convert again.  Reads of a part use the cache
+      // only if the block is there already, and otherwise read just that
+      // part below, rather than decode all of it into the cache.
+      const auto decoded = (sampleoffset == 0 && numsamples >= mSampleCount)
+         ? GetDecoded()
+         : mpFactory->mDecodedBlocks.Find(mBlockID);
+      if (decoded) {
+         CopyBlob(dest, floatSample,
+            reinterpret_cast<constSamplePtr>(decoded->data()),
+            decoded->size() * sizeof(float), floatSample,
+            sampleoffset * sizeof(float), numsamples * sizeof(float));
+         return numsamples;
+      }
+   }
+
+   if (GetPending(dest,
+                  destformat,
+                  mSamples,
+                  mSampleBytes,
+                  mSampleFormat,
+                  sampleoffset * SAMPLE_SIZE(mSampleFormat),
+                  numsamples * SAMPLE_SIZE(mSampleFormat)))
+      return numsamples;
+
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
       "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
@@ -434,7 +742,34 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
                   stmt,
                   mSampleFormat,
                   sampleoffset * SAMPLE_SIZE(mSampleFormat),
-                  numsamples * SAMPLE_SIZE(mSampleFormat)) / SAMPLE_SIZE(mSampleFormat);
+                  numsamples * SAMPLE_SIZE(mSampleFormat),
+                  true) / SAMPLE_SIZE(mSampleFormat);
+}
+
+auto SqliteSampleBlock::GetDecoded() -> std::shared_ptr<std::vector<float>>
+{
+   if (IsSilent())
+      return std::make_shared<std::vector<float>>(mSampleCount, 0.f);
+
+   auto &cache = mpFactory->mDecodedBlocks;
+   if (auto result = cache.Find(mBlockID))
+      return result;
+
+   auto result = std::make_shared<std::vector<float>>(mSampleCount);
+   const auto dest = result->data();
+   if (GetPending(dest, floatSample, mSamples, mSampleBytes, mSampleFormat,
+      0, mSampleBytes))
+      // Still held in memory until written, as while recording or importing;
+      // not worth keeping twice
+      return result;
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
+      "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
+   GetBlob(dest, floatSample, stmt, mSampleFormat, 0, mSampleBytes, true);
+
+   cache.Insert(mBlockID, result, result->size() * sizeof(float));
+   return result;
 }
 
 void SqliteSampleBlock::SetSamples(constSamplePtr src,
@@ -445,15 +780,59 @@ void SqliteSampleBlock::SetSamples(constSamplePtr src,
    mSamples.reinit(mSampleBytes);
    memcpy(mSamples.get(), src, mSampleBytes);
 
-   CalcSummary( sizes );
+   // Sequence needs these as soon as the block is appended
+   CalcTotals();
+
+   // Summarize and encode on a worker, so that the thread producing the
+   // samples, such as an importer, can go on, while the thread that creates
+   // blocks remains the only one to write to the database; keep the decoded
+   // samples too, for reads while pending
+   mpPrepare = std::make_shared<PrepareOnce>();
+   audacity::concurrency::WorkStealingPool::GetShared().Post(
+      [this, sizes, pPrepare = mpPrepare]{
+         (*pPrepare)([&]{ Prepare(sizes); });
+      });
 
-   Commit( sizes );
+   // The factory commits later, in a batch with other blocks, but the id
+   // is known now
+   mSummarySizes = sizes;
+   mBlockID = Conn()->ReserveBlockID();
+   mValid = true;
+}
+
+void SqliteSampleBlock::Prepare(Sizes sizes)
+{
+   CalcSummary(sizes);
+   auto encoded = SampleBlockCodec::Encode(
+      mpFactory->mCodec, mSamples.get(), mSampleCount, mSampleFormat);
+   if (!encoded.empty()) {
+      mCodec = mpFactory->mCodec;
+      mEncoded = move(encoded);
+   }
+}
+
+bool SqliteSampleBlock::WaitPrepared() noexcept
+{
+   if (!mpPrepare)
+      return true;
+   try {
+      (*mpPrepare)([this]{ Prepare(mSummarySizes); });
+   }
+   catch (...) {
+      return false;
+   }
+   return !mpPrepare->error;
 }
 
 bool SqliteSampleBlock::GetSummary256(float *dest,
                                       size_t frameoffset,
                                       size_t numframes)
 {
+   if (!WaitPrepared())
+      return false;
+   if (GetPending(dest, floatSample, mSummary256, mSummarySizes.first,
+      floatSample, frameoffset * bytesPerFrame, numframes * bytesPerFrame))
+      return true;
    return GetSummary(dest, frameoffset, numframes, DBConnection::GetSummary256,
       "SELECT summary256 FROM sampleblocks WHERE blockid = ?1;");
 }
@@ -462,6 +841,11 @@ bool SqliteSampleBlock::GetSummary64k(float *dest,
                                       size_t frameoffset,
                                       size_t numframes)
 {
+   if (!WaitPrepared())
+      return false;
+   if (GetPending(dest, floatSample, mSummary64k, mSummarySizes.second,
+      floatSample, frameoffset * bytesPerFrame, numframes * bytesPerFrame))
+      return true;
    return GetSummary(dest, frameoffset, numframes, DBConnection::GetSummary64k,
       "SELECT summary64k FROM sampleblocks WHERE blockid = ?1;");
 }
@@ -486,7 +870,8 @@ bool SqliteSampleBlock::GetSummary(float *dest,
                      stmt,
                      floatSample,
                      frameoffset * fields * SAMPLE_SIZE(floatSample),
-                     numframes * fields * SAMPLE_SIZE(floatSample));
+                     numframes * fields * SAMPLE_SIZE(floatSample),
+                     false);
          return true;
       }
       catch ( const AudacityException & ) {
@@ -573,8 +958,79 @@ size_t SqliteSampleBlock::GetSpaceUsage() const
 {
    if (IsSilent())
       return 0;
-   else
+   else {
+      // The row must exist to be measured
+      mpFactory->Flush();
       return ProjectFileIO::GetDiskUsage(*Conn(), mBlockID);
+   }
+}
+
+namespace {
+// The sampleformat column holds the sampleFormat in its low 32 bits.  For
+// encoded samples, it also holds the codec, and the count of samples, which
+// the length of the blob no longer tells.  Rows of unencoded samples are the
+// same as before there were codecs.
+constexpr unsigned CodecShift = 32;
+constexpr long long CodecMask = 0xFF;
+constexpr unsigned CountShift = 40;
+
+long long PackFormat(
+   sampleFormat format, SampleBlockCodec::Codec codec, size_t count)
+{
+   auto result = static_cast<long long>(format);
+   if (codec != SampleBlockCodec::Codec::None)
+      result |= (static_cast<long long>(codec) << CodecShift) |
+         (static_cast<long long>(count) << CountShift);
+   return result;
+}
+
+SampleBlockCodec::Codec UnpackCodec(long long packed)
+{
+   return static_cast<SampleBlockCodec::Codec>(
+      (packed >> CodecShift) & CodecMask);
+}
+
+//! Copy a range of bytes of a blob, padding with zeroes past its end
+void CopyBlob(void *dest, sampleFormat destformat,
+   constSamplePtr src, size_t blobbytes, sampleFormat srcformat,
+   size_t srcoffset, size_t srcbytes)
+{
+   srcoffset = std::min(srcoffset, blobbytes);
+   const auto minbytes = std::min(srcbytes, blobbytes - srcoffset);
+
+   wxASSERT(destformat == floatSample || destformat == srcformat);
+
+   CopySamples(src + srcoffset,
+               srcformat,
+               (samplePtr) dest,
+               destformat,
+               minbytes / SAMPLE_SIZE(srcformat));
+
+   dest = ((samplePtr) dest) + minbytes;
+
+   if (srcbytes - minbytes)
+   {
+      memset(dest, 0, srcbytes - minbytes);
+   }
+}
+}
+
+bool SqliteSampleBlock::GetPending(void *dest,
+                                   sampleFormat destformat,
+                                   const ArrayOf<char> &src,
+                                   size_t srcsize,
+                                   sampleFormat srcformat,
+                                   size_t srcoffset,
+                                   size_t srcbytes)
+{
+   if (!mpFactory)
+      return false;
+   std::lock_guard<std::mutex> lock{ mpFactory->mPendingMutex };
+   if (!mPending)
+      return false;
+   CopyBlob(dest, destformat, src.get(), srcsize, srcformat,
+      srcoffset, srcbytes);
+   return true;
 }
 
 size_t SqliteSampleBlock::GetBlob(void *dest,
@@ -582,7 +1038,8 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
                                   sqlite3_stmt *stmt,
                                   sampleFormat srcformat,
                                   size_t srcoffset,
-                                  size_t srcbytes)
+                                  size_t srcbytes,
+                                  bool samples)
 {
    auto db = DB();
 
@@ -594,7 +1051,6 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    }
 
    int rc;
-   size_t minbytes = 0;
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
@@ -637,14 +1093,6 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    samplePtr src = (samplePtr) sqlite3_column_blob(stmt, 0);
    size_t blobbytes = (size_t) sqlite3_column_bytes(stmt, 0);
 
-   srcoffset = std::min(srcoffset, blobbytes);
-   minbytes = std::min(srcbytes, blobbytes - srcoffset);
-
-   if (srcoffset != 0)
-   {
-      srcoffset += 0;
-   }
-
    /*
     Will dithering happen in CopySamples?  Answering this as of 3.0.3 by
     examining all uses.
@@ -679,20 +1127,27 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
 
     Therefore, no dithering even there!
     */
-   wxASSERT(destformat == floatSample || destformat == srcformat);
+   if (samples && mCodec != SampleBlockCodec::Codec::None) {
+      // Decode all, even to read only a part
+      SampleBuffer decoded(mSampleCount, srcformat);
+      if (!SampleBlockCodec::Decode(mCodec, src, blobbytes,
+         decoded.ptr(), mSampleCount, srcformat))
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::GetBlob::decode");
 
-   CopySamples(src + srcoffset,
-               srcformat,
-               (samplePtr) dest,
-               destformat,
-               minbytes / SAMPLE_SIZE(srcformat));
+         wxLogDebug(wxT("SqliteSampleBlock::GetBlob - can't decode block %lld"), mBlockID);
 
-   dest = ((samplePtr) dest) + minbytes;
+         // Clear statement bindings and rewind statement
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
 
-   if (srcbytes - minbytes)
-   {
-      memset(dest, 0, srcbytes - minbytes);
+         Conn()->ThrowException( false );
+      }
+      CopyBlob(dest, destformat, decoded.ptr(), mSampleBytes, srcformat,
+         srcoffset, srcbytes);
    }
+   else
+      CopyBlob(dest, destformat, src, blobbytes, srcformat, srcoffset, srcbytes);
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
@@ -755,12 +1210,21 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
 
    // Retrieve returned data
    mBlockID = sbid;
-   mSampleFormat = (sampleFormat) sqlite3_column_int(stmt, 0);
+   const auto packed = sqlite3_column_int64(stmt, 0);
+   mSampleFormat = (sampleFormat) (packed & 0xFFFFFFFF);
+   mCodec = UnpackCodec(packed);
    mSumMin = sqlite3_column_double(stmt, 1);
    mSumMax = sqlite3_column_double(stmt, 2);
    mSumRms = sqlite3_column_double(stmt, 3);
-   mSampleBytes = sqlite3_column_int(stmt, 4);
-   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   if (mCodec == SampleBlockCodec::Codec::None) {
+      mSampleBytes = sqlite3_column_int(stmt, 4);
+      mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   }
+   else {
+      mSampleCount = packed >> CountShift;
+      mSampleBytes = mSampleCount * SAMPLE_SIZE(mSampleFormat);
+      mpFactory->mppConnection->mHasEncodedBlocks = true;
+   }
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
@@ -774,25 +1238,37 @@ void SqliteSampleBlock::Commit(Sizes sizes)
    const auto mSummary256Bytes = sizes.first;
    const auto mSummary64kBytes = sizes.second;
 
+   // Rethrows a failure of Prepare()
+   if (mpPrepare) {
+      (*mpPrepare)([this, sizes]{ Prepare(sizes); });
+      if (mpPrepare->error)
+         std::rethrow_exception(mpPrepare->error);
+   }
+
    auto db = DB();
    int rc;
 
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::InsertSampleBlock,
       "INSERT INTO sampleblocks (sampleformat, summin, summax, sumrms,"
-      "                          summary256, summary64k, samples)"
-      "                         VALUES(?1,?2,?3,?4,?5,?6,?7);");
+      "                          summary256, summary64k, samples, blockid)"
+      "                         VALUES(?1,?2,?3,?4,?5,?6,?7,?8);");
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
    // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int(stmt, 1, static_cast<int>(mSampleFormat)) ||
+   const bool encoded = mCodec != SampleBlockCodec::Codec::None;
+   if (sqlite3_bind_int64(stmt, 1,
+          PackFormat(mSampleFormat, mCodec, mSampleCount)) ||
        sqlite3_bind_double(stmt, 2, mSumMin) ||
        sqlite3_bind_double(stmt, 3, mSumMax) ||
        sqlite3_bind_double(stmt, 4, mSumRms) ||
        sqlite3_bind_blob(stmt, 5, mSummary256.get(), mSummary256Bytes, SQLITE_STATIC) ||
        sqlite3_bind_blob(stmt, 6, mSummary64k.get(), mSummary64kBytes, SQLITE_STATIC) ||
-       sqlite3_bind_blob(stmt, 7, mSamples.get(), mSampleBytes, SQLITE_STATIC))
+       sqlite3_bind_blob(stmt, 7,
+          encoded ? static_cast<const void*>(mEncoded.data()) : mSamples.get(),
+          encoded ? mEncoded.size() : mSampleBytes, SQLITE_STATIC) ||
+       sqlite3_bind_int64(stmt, 8, mBlockID))
    {
 
       ADD_EXCEPTION_CONTEXT(
@@ -821,23 +1297,12 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       Conn()->ThrowException( true );
    }
 
-   // Retrieve returned data
-   mBlockID = sqlite3_last_insert_rowid(db);
-
-   // Reset local arrays
-   mSamples.reset();
-   mSummary256.reset();
-   mSummary64k.reset();
-   {
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      mCache.reset();
-   }
-
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
    sqlite3_reset(stmt);
 
-   mValid = true;
+   if (encoded)
+      mpFactory->mppConnection->mHasEncodedBlocks = true;
 }
 
 void SqliteSampleBlock::Delete()
@@ -845,6 +1310,9 @@ void SqliteSampleBlock::Delete()
    auto db = DB();
    int rc;
 
+   // Don't fall inside the savepoint of a writer on another thread
+   const auto writeLock = Conn()->LockForWriting();
+
    wxASSERT(!IsSilent());
 
    // Prepare and cache statement...automatically finalized at DB close
@@ -908,6 +1376,46 @@ auto SqliteSampleBlock::SetSizes(
 /// This method also has the side effect of setting the mSumMin,
 /// mSumMax, and mSumRms members of this class.
 ///
+void SqliteSampleBlock::CalcTotals()
+{
+   // Squares are summed in floats for each 256 samples, as they used to be
+   // for the 256 summaries, so that results are unchanged
+   float buffer[256];
+   float min = 0;
+   float max = 0;
+   double totalSquares = 0.0;
+
+   for (size_t start = 0; start < mSampleCount; start += 256)
+   {
+      const auto count = std::min<size_t>(256, mSampleCount - start);
+      const float *samples;
+      if (mSampleFormat == floatSample)
+         samples = (const float *) mSamples.get() + start;
+      else
+      {
+         SamplesToFloats(mSamples.get() + start * SAMPLE_SIZE(mSampleFormat),
+            mSampleFormat, buffer, count);
+         samples = buffer;
+      }
+
+      if (start == 0)
+         min = max = samples[0];
+      float sumsq = 0.0f;
+      for (size_t j = 0; j < count; ++j)
+      {
+         const float f1 = samples[j];
+         sumsq += f1 * f1;
+         min = std::min(min, f1);
+         max = std::max(max, f1);
+      }
+      totalSquares += sumsq;
+   }
+
+   mSumMin = min;
+   mSumMax = max;
+   mSumRms = mSampleCount > 0 ? sqrt(totalSquares / mSampleCount) : 0.0;
+}
+
 void SqliteSampleBlock::CalcSummary(Sizes sizes)
 {
    const auto mSummary256Bytes = sizes.first;
@@ -937,7 +1445,6 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    float min;
    float max;
    float sumsq;
-   double totalSquares = 0.0;
    double fraction = 0.0;
 
    // Recalc 256 summaries
@@ -972,8 +1479,6 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
          }
       }
 
-      totalSquares += sumsq;
-
       summary256[i * fields] = min;
       summary256[i * fields + 1] = max;
       // The rms is correct, but this may be for less than 256 samples in last loop.
@@ -991,9 +1496,6 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
       summary256[i * fields + 2] = 0.0f;       // rms
    }
 
-   // Calculate now while we can do it accurately
-   mSumRms = sqrt(totalSquares / mSampleCount);
-
    // Recalc 64K summaries
    sumLen = (mSampleCount + 65535) / 65536;
 
@@ -1039,26 +1541,6 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
       summary64k[i * fields + 1] = 0.0f; // probably should be -FLT_MAX, need a test case
       summary64k[i * fields + 2] = 0.0f; // just padding
    }
-
-   // Recalc block-level summary (mRMS already calculated)
-   min = summary64k[0];
-   max = summary64k[1];
-
-   for (int i = 1; i < sumLen; ++i)
-   {
-      if (summary64k[i * fields] < min)
-      {
-         min = summary64k[i * fields];
-      }
-
-      if (summary64k[i * fields + 1] > max)
-      {
-         max = summary64k[i * fields + 1];
-      }
-   }
-
-   mSumMin = min;
-   mSumMax = max;
 }
 
 //! Just to find a denominator for a progress indicator.
@@ -1133,6 +1615,42 @@ void SqliteSampleBlockFactory::OnEndPurge()
    mSampleBlockDeletionCallback = {};
 }
 
+EnumSetting<SampleBlockCodec::Codec> SampleBlockCodecSetting{
+   wxT("/ProjectFile/SampleBlockCodec"),
+   {
+      ByColumns,
+      {
+         XO("None"),
+         /* i18n-hint: a compression of audio that is slower but saves more
+          disk space, without any change of the sound */
+         XO("Lossless (smaller)"),
+         /* i18n-hint: LZ4 names a fast compression algorithm */
+         XO("LZ4 (faster)"),
+      },
+      { wxT("None"), wxT("Lossless"), wxT("LZ4") }
+   },
+   0, // "None"
+   {
+      SampleBlockCodec::Codec::None,
+      SampleBlockCodec::Codec::Lossless,
+      SampleBlockCodec::Codec::LZ4,
+   },
+};
+
+IntSetting DecodedBlockCacheSize{ L"/ProjectFile/DecodedBlockCacheSize", 256 };
+
+namespace {
+// Older versions can't read encoded samples.  Projects that never stored a
+// block with a codec, as with the default setting, stay readable by them.
+ProjectFormatExtensionsRegistry::Extension encodedBlocksExtension(
+   [](const AudacityProject& project) -> ProjectFormatVersion {
+      if (ConnectionPtr::Get(project).mHasEncodedBlocks)
+         return EncodedBlocksFormatVersion;
+      return BaseProjectFormatVersion;
+   }
+);
+}
+
 // Inject our database implementation at startup
 static SampleBlockFactory::Factory::Scope scope{ []( AudacityProject &project )
 {
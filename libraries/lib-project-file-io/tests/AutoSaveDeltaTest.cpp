@@ -0,0 +1,115 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AutoSaveDeltaTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "AutoSaveDelta.h"
+#include "MemoryStream.h"
+
+#include <string>
+
+namespace
+{
+struct Document
+{
+   std::string bytes;
+   std::vector<AutoSaveDelta::Range> ranges;
+
+   explicit Document(std::initializer_list<std::string> parts)
+   {
+      // A header, then one fragment for each part
+      bytes = "header";
+      for (const auto& part : parts)
+      {
+         ranges.emplace_back(bytes.size(), bytes.size() + part.size());
+         bytes += part;
+      }
+   }
+
+   std::vector<AutoSaveDelta::Fragment> Fragments() const
+   {
+      std::vector<AutoSaveDelta::Fragment> result;
+      for (const auto& range : ranges)
+         result.push_back({ range, {} });
+      return result;
+   }
+};
+
+std::vector<uint8_t> ToBytes(const MemoryStream& stream)
+{
+   auto data = static_cast<const uint8_t*>(stream.GetData());
+   return { data, data + stream.GetSize() };
+}
+} // namespace
+
+TEST_CASE("AutoSaveDelta", "")
+{
+   const Document base { "first track", "second track", "third track" };
+   AutoSaveDelta delta;
+   REQUIRE(delta.IsEmpty());
+   delta.SetBase(base.bytes.data(), base.bytes.size(), base.ranges);
+   REQUIRE(delta.BaseSize() == base.bytes.size());
+
+   const auto roundTrip = [&](const Document& doc,
+                             const std::vector<AutoSaveDelta::Fragment>& fragments,
+                             size_t expectedLiteral) {
+      MemoryStream out;
+      const auto literal =
+         delta.Encode(doc.bytes.data(), doc.bytes.size(), fragments, out);
+      REQUIRE(literal == expectedLiteral);
+      const auto encoded = ToBytes(out);
+      std::vector<uint8_t> decoded;
+      REQUIRE(AutoSaveDelta::Apply(
+         base.bytes.data(), base.bytes.size(), encoded.data(), encoded.size(),
+         decoded));
+      REQUIRE(std::string(decoded.begin(), decoded.end()) == doc.bytes);
+      return encoded;
+   };
+
+   SECTION("Unchanged fragments are copied from the base")
+   {
+      const Document doc { "first track", "second track", "third track" };
+      // Only the header is literal
+      roundTrip(doc, doc.Fragments(), 6);
+   }
+
+   SECTION("Changed and reordered fragments")
+   {
+      const Document doc { "third track", "changed!", "first track" };
+      roundTrip(doc, doc.Fragments(), 6 + 8);
+   }
+
+   SECTION("A fragment of the same length but other bytes is literal")
+   {
+      const Document doc { "first track", "second trac!", "third track" };
+      roundTrip(doc, doc.Fragments(), 6 + 12);
+   }
+
+   SECTION("Known ranges of the base are copied without comparison")
+   {
+      const Document doc { "first track", "second track", "third track" };
+      auto fragments = doc.Fragments();
+      for (size_t ii = 0; ii < fragments.size(); ++ii)
+         fragments[ii].base = base.ranges[ii];
+      roundTrip(doc, fragments, 6);
+   }
+
+   SECTION("A delta applies only to its base")
+   {
+      const Document doc { "first track", "changed", "third track" };
+      const auto encoded = roundTrip(doc, doc.Fragments(), 6 + 7);
+      const Document other { "first track", "second track", "third trick" };
+      std::vector<uint8_t> decoded;
+      REQUIRE(!AutoSaveDelta::Apply(
+         other.bytes.data(), other.bytes.size(), encoded.data(),
+         encoded.size(), decoded));
+      REQUIRE(!AutoSaveDelta::Apply(
+         base.bytes.data(), base.bytes.size(), encoded.data(),
+         encoded.size() - 1, decoded));
+   }
+}
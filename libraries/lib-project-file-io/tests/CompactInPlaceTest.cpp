@@ -0,0 +1,132 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CompactInPlaceTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "TestProject.h"
+
+#include "DBConnection.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Each is 64 pages, and enough of them free are more than one step of
+// incremental vacuum
+constexpr size_t blockSize = 1 << 20;
+
+std::vector<float> MakeSamples(size_t count, unsigned seed)
+{
+   // Random, so that the blocks take as much space encoded as not
+   std::mt19937 engine{ seed };
+   std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+   std::vector<float> samples(count);
+   std::generate(samples.begin(), samples.end(),
+      [&]{ return distribution(engine); });
+   return samples;
+}
+
+std::vector<SampleBlockPtr> MakeBlocks(
+   TestProject &test, size_t count, size_t size = blockSize)
+{
+   std::vector<SampleBlockPtr> blocks;
+   for (size_t ii = 0; ii < count; ++ii) {
+      const auto samples = MakeSamples(size, ii);
+      blocks.push_back(test.factory->Create(
+         reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+         floatSample));
+   }
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+   return blocks;
+}
+
+int64_t GetPragma(TestProject &test, const char *sql)
+{
+   const auto db = ProjectFileIO::Get(*test.project).GetConnection().DB();
+   sqlite3_stmt *stmt = nullptr;
+   REQUIRE(sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK);
+   REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+   const auto result = sqlite3_column_int64(stmt, 0);
+   sqlite3_finalize(stmt);
+   return result;
+}
+
+int64_t GetFreePages(TestProject &test)
+{
+   return GetPragma(test, "PRAGMA freelist_count;");
+}
+} // namespace
+
+TEST_CASE("Compacting in place reclaims free pages")
+{
+   TestProject test;
+   auto &projectFileIO = ProjectFileIO::Get(*test.project);
+   REQUIRE(GetPragma(test, "PRAGMA auto_vacuum;") == 2);
+
+   auto blocks = MakeBlocks(test, 8);
+   const auto pageCount = GetPragma(test, "PRAGMA page_count;");
+
+   // Delete every other block
+   std::vector<SampleBlockPtr> kept;
+   for (size_t ii = 0; ii < blocks.size(); ii += 2)
+      kept.push_back(blocks[ii]);
+   blocks.clear();
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+   REQUIRE(GetFreePages(test) >= 4 * 64);
+
+   // Temporary projects compact only when forced
+   projectFileIO.Compact({}, true);
+   REQUIRE(projectFileIO.WasCompacted());
+   REQUIRE(GetFreePages(test) == 0);
+   REQUIRE(GetPragma(test, "PRAGMA page_count;") < pageCount);
+
+   // The blocks that were moved to fill the holes are intact
+   std::vector<float> samples(blockSize);
+   for (size_t ii = 0; ii < kept.size(); ++ii) {
+      REQUIRE(kept[ii]->GetSamples(reinterpret_cast<samplePtr>(samples.data()),
+         floatSample, 0, blockSize) == blockSize);
+      REQUIRE(samples == MakeSamples(blockSize, 2 * ii));
+   }
+}
+
+TEST_CASE("Free pages alone make a saved project compact past a threshold")
+{
+   TestProject test;
+   auto &projectFileIO = ProjectFileIO::Get(*test.project);
+   // Not temporary
+   REQUIRE(projectFileIO.SaveProject(projectFileIO.GetFileName(), nullptr));
+   REQUIRE(!projectFileIO.IsTemporary());
+
+   SECTION("Enough free pages are reclaimed")
+   {
+      MakeBlocks(test, 8);
+      ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+      REQUIRE(GetFreePages(test) >= 256);
+
+      // No blocks remain, so free pages are the only reason to compact
+      projectFileIO.Compact({});
+      REQUIRE(projectFileIO.WasCompacted());
+      REQUIRE(GetFreePages(test) == 0);
+   }
+
+   SECTION("Fewer than one step of incremental vacuum are left")
+   {
+      MakeBlocks(test, 1, 1000);
+      ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+      const auto freePages = GetFreePages(test);
+      REQUIRE(freePages < 256);
+
+      projectFileIO.Compact({});
+      REQUIRE(!projectFileIO.WasCompacted());
+      REQUIRE(GetFreePages(test) == freePages);
+   }
+}
@@ -0,0 +1,224 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectSerializerTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "BufferedProjectMemoryStream.h"
+#include "MemoryStream.h"
+#include "ProjectSerializer.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Set to `true` to print the time taken to decode a project of a million
+// labels
+static constexpr auto runLocally = false;
+
+std::vector<uint8_t> ToBytes(const MemoryStream& stream)
+{
+   std::vector<uint8_t> bytes;
+   bytes.reserve(stream.GetSize());
+   for (const auto [data, size] : stream)
+   {
+      const auto first = static_cast<const uint8_t*>(data);
+      bytes.insert(bytes.end(), first, first + size);
+   }
+   return bytes;
+}
+
+//! The dictionary and the document of a serializer, as ProjectFileIO reads
+//! them back
+struct SerializedProject final
+{
+   explicit SerializedProject(const ProjectSerializer& serializer)
+       : dict { ToBytes(serializer.GetDict()) }
+       , doc { ToBytes(serializer.GetData()) }
+   {
+   }
+
+   std::vector<uint8_t> dict;
+   std::vector<uint8_t> doc;
+};
+
+//! Rewrites what it decodes as text
+struct Printer final : XMLTagHandler
+{
+   bool HandleXMLTag(
+      const std::string_view& tag, const AttributesList& attrs) override
+   {
+      text += "<" + std::string(tag);
+      for (auto& [name, value] : attrs)
+         text += " " + std::string(name) + "=" + value.ToString();
+      text += ">";
+      return true;
+   }
+   void HandleXMLEndTag(const std::string_view& tag) override
+   {
+      text += "</" + std::string(tag) + ">";
+   }
+   void HandleXMLContent(const std::string_view& content) override
+   {
+      text += content;
+   }
+   XMLTagHandler* HandleXMLChild(const std::string_view&) override
+   {
+      return this;
+   }
+   std::string text;
+};
+
+//! Reads the titles of labels, as LabelTrack would
+struct LabelReader final : XMLTagHandler
+{
+   bool HandleXMLTag(
+      const std::string_view& tag, const AttributesList& attrs) override
+   {
+      if (tag == "label")
+         for (auto& [name, value] : attrs)
+         {
+            std::string_view title;
+            if (name == "title" && value.TryGet(title))
+               ++count, bytes += title.size();
+         }
+      return true;
+   }
+   void HandleXMLContent(const std::string_view& content) override
+   {
+      bytes += content.size();
+   }
+   XMLTagHandler* HandleXMLChild(const std::string_view&) override
+   {
+      return this;
+   }
+   size_t count {};
+   size_t bytes {};
+};
+
+//! Several titles of labels, some long and some not ASCII
+wxString LabelTitle(long long ii)
+{
+   switch (ii % 4)
+   {
+   case 0:
+      return wxString::Format(wxT("Verse %lld"), ii);
+   case 1:
+      return wxString::Format(
+         wxT("A much longer title of the label that comes after verse %lld, ")
+         wxT("as someone might write to describe a take"), ii - 1);
+   case 2:
+      return wxString::Format(
+         wxT("Caf%s %lld"), wxString::FromUTF8("\xC3\xA9"), ii);
+   default:
+      return {};
+   }
+}
+} // namespace
+
+TEST_CASE("ProjectSerializer round trip")
+{
+   ProjectSerializer serializer;
+   serializer.StartTag(wxT("project"));
+   serializer.WriteAttr(wxT("name"), wxT("A rather long name for a project"));
+   serializer.WriteAttr(wxT("rate"), 44100);
+   serializer.StartTag(wxT("label"));
+   serializer.WriteAttr(wxT("title"), wxString::FromUTF8("caf\xC3\xA9"));
+   serializer.WriteAttr(wxT("t"), 2);
+   serializer.EndTag(wxT("label"));
+   serializer.StartTag(wxT("tag"));
+   serializer.WriteData(wxT("some content"));
+   serializer.EndTag(wxT("tag"));
+   serializer.EndTag(wxT("project"));
+
+   SerializedProject project { serializer };
+   BufferedProjectMemoryStream stream { project.dict, project.doc };
+   Printer printer;
+   REQUIRE(ProjectSerializer::Decode(stream, &printer));
+   REQUIRE(
+      printer.text ==
+      "<project name=A rather long name for a project rate=44100>"
+      "<label title=caf\xC3\xA9 t=2></label>"
+      "<tag>some content</tag></project>");
+}
+
+TEST_CASE("ProjectSerializer reuses no stale string values")
+{
+   // Longer values followed by shorter, ASCII by not, and several string
+   // values in one tag, over more than one buffer of the stream
+   constexpr auto numLabels = 4000;
+   ProjectSerializer serializer;
+   std::string expected;
+   serializer.StartTag(wxT("labeltrack"));
+   expected += "<labeltrack>";
+   for (long long ii = 0; ii < numLabels; ++ii)
+   {
+      const auto title = LabelTitle(ii), other = LabelTitle(ii + 1);
+      serializer.StartTag(wxT("label"));
+      serializer.WriteAttr(wxT("title"), title);
+      serializer.WriteAttr(wxT("t"), ii);
+      serializer.WriteAttr(wxT("other"), other);
+      serializer.EndTag(wxT("label"));
+      expected += "<label title=" + std::string(title.ToUTF8()) +
+                  " t=" + std::to_string(ii) +
+                  " other=" + std::string(other.ToUTF8()) + "></label>";
+   }
+   serializer.WriteData(LabelTitle(1));
+   expected += std::string(LabelTitle(1).ToUTF8());
+   serializer.EndTag(wxT("labeltrack"));
+   expected += "</labeltrack>";
+
+   SerializedProject project { serializer };
+   REQUIRE(project.doc.size() > 32 * 1024);
+   BufferedProjectMemoryStream stream { project.dict, project.doc };
+   Printer printer;
+   REQUIRE(ProjectSerializer::Decode(stream, &printer));
+   REQUIRE(printer.text == expected);
+}
+
+TEST_CASE("ProjectSerializer decoding benchmark")
+{
+   if (!runLocally)
+      return;
+
+   // String attributes, which are converted, rather than numbers, which are
+   // stored typed
+   constexpr auto numLabels = 1000000;
+   ProjectSerializer serializer;
+   size_t expectedBytes = 0;
+   serializer.StartTag(wxT("project"));
+   serializer.StartTag(wxT("labeltrack"));
+   serializer.WriteAttr(wxT("name"), wxT("Labels"));
+   for (long long ii = 0; ii < numLabels; ++ii)
+   {
+      const auto title = LabelTitle(ii);
+      expectedBytes += title.ToUTF8().length();
+      serializer.StartTag(wxT("label"));
+      serializer.WriteAttr(wxT("t"), ii * 0.5);
+      serializer.WriteAttr(wxT("t1"), ii * 0.5 + 0.25);
+      serializer.WriteAttr(wxT("title"), title);
+      serializer.EndTag(wxT("label"));
+   }
+   serializer.EndTag(wxT("labeltrack"));
+   serializer.EndTag(wxT("project"));
+
+   SerializedProject project { serializer };
+   BufferedProjectMemoryStream stream { project.dict, project.doc };
+   LabelReader reader;
+   const auto start = std::chrono::steady_clock::now();
+   REQUIRE(ProjectSerializer::Decode(stream, &reader));
+   const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+   REQUIRE(reader.count == numLabels);
+   REQUIRE(reader.bytes == expectedBytes);
+   std::cout << "Decoded " << numLabels << " labels of "
+             << project.doc.size() << " bytes in " << elapsed.count()
+             << " ms\n";
+}
@@ -0,0 +1,137 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileStoreTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "TestProject.h"
+
+#include "DBConnection.h"
+#include "SpectrogramTileStore.h"
+
+#include <vector>
+
+namespace
+{
+using Tile = SpectrogramTileStore::Tile;
+
+constexpr unsigned long long params = 1234;
+constexpr unsigned long long context = 5678;
+
+SampleBlockPtr MakeBlock(TestProject &test)
+{
+   const std::vector<float> samples(1000, 0.5f);
+   return test.factory->Create(
+      reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+      floatSample);
+}
+
+Tile MakeTile(const SampleBlock &block, unsigned long long tileParams,
+   size_t nColumns, int16_t value)
+{
+   return { { block.GetBlockID(), tileParams, nColumns }, context,
+      std::vector<int16_t>(nColumns * 4, value) };
+}
+
+//! Whether the database, not the queue of a store, has the tile
+bool IsWritten(AudacityProject &project, const Tile &tile)
+{
+   SpectrogramTileStore fresh{ project };
+   std::vector<int16_t> data;
+   return fresh.Load(tile.key, tile.context, data) && data == tile.data;
+}
+} // namespace
+
+TEST_CASE("SpectrogramTileStore loads what it stored")
+{
+   TestProject test;
+   auto &store = SpectrogramTileStore::Get(*test.project);
+   const auto block = MakeBlock(test);
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+
+   const auto tile = MakeTile(*block, params, 3, 7);
+   store.Store({ tile });
+
+   // Found while queued, before it is written
+   std::vector<int16_t> data;
+   REQUIRE(store.Load(tile.key, context, data));
+   REQUIRE(data == tile.data);
+   REQUIRE(!IsWritten(*test.project, tile));
+
+   store.Flush();
+   REQUIRE(IsWritten(*test.project, tile));
+   data.clear();
+   REQUIRE(store.Load(tile.key, context, data));
+   REQUIRE(data == tile.data);
+}
+
+TEST_CASE("SpectrogramTileStore finds no tile for other settings")
+{
+   TestProject test;
+   auto &store = SpectrogramTileStore::Get(*test.project);
+   const auto block = MakeBlock(test);
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+
+   const auto tile = MakeTile(*block, params, 3, 7);
+   store.Store({ tile });
+
+   const auto check = [&]{
+      std::vector<int16_t> data;
+      auto key = tile.key;
+      key.params = params + 1;
+      REQUIRE(!store.Load(key, context, data));
+      key = tile.key;
+      key.nColumns = 4;
+      REQUIRE(!store.Load(key, context, data));
+      REQUIRE(!store.Load(tile.key, context + 1, data));
+   };
+   check();
+   store.Flush();
+   check();
+}
+
+TEST_CASE("SpectrogramTileStore keeps one tile for each block")
+{
+   TestProject test;
+   auto &store = SpectrogramTileStore::Get(*test.project);
+   const auto block = MakeBlock(test);
+   const auto other = MakeBlock(test);
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+
+   const auto oldTile = MakeTile(*block, params, 3, 7);
+   const auto otherTile = MakeTile(*other, params, 3, 8);
+   store.Store({ oldTile, otherTile });
+   store.Flush();
+
+   // Other settings replace the tile of the block only
+   const auto newTile = MakeTile(*block, params + 1, 5, 9);
+   store.Store({ newTile });
+   std::vector<int16_t> data;
+   REQUIRE(!store.Load(oldTile.key, context, data));
+   store.Flush();
+   REQUIRE(!IsWritten(*test.project, oldTile));
+   REQUIRE(IsWritten(*test.project, newTile));
+   REQUIRE(IsWritten(*test.project, otherTile));
+}
+
+TEST_CASE("SpectrogramTileStore deletes tiles with their blocks")
+{
+   TestProject test;
+   auto &store = SpectrogramTileStore::Get(*test.project);
+   auto block = MakeBlock(test);
+   const auto other = MakeBlock(test);
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+
+   const auto tile = MakeTile(*block, params, 3, 7);
+   const auto otherTile = MakeTile(*other, params, 3, 8);
+   store.Store({ tile, otherTile });
+   store.Flush();
+
+   block.reset();
+   REQUIRE(!IsWritten(*test.project, tile));
+   REQUIRE(IsWritten(*test.project, otherTile));
+}
@@ -0,0 +1,153 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SqliteSampleBlockTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "TestProject.h"
+
+#include "DBConnection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Set to `true` to print how long creating blocks takes, compared with
+// summarizing and encoding them in the background
+static constexpr auto runLocally = false;
+
+std::vector<float> MakeSamples(size_t count, unsigned seed)
+{
+   std::mt19937 engine{ seed };
+   std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+   std::vector<float> samples(count);
+   std::generate(samples.begin(), samples.end(),
+      [&]{ return distribution(engine); });
+   return samples;
+}
+} // namespace
+
+TEST_CASE("SqliteSampleBlock totals are known as soon as it is created")
+{
+   TestProject test;
+
+   // Not a multiple of 256 or of 64k
+   const auto samples = MakeSamples(3 * 65536 + 1000, 1);
+   const auto block = test.factory->Create(
+      reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+      floatSample);
+
+   // What Sequence reads when a block is appended
+   const auto totals = block->GetMinMaxRMS();
+   const auto [min, max] = std::minmax_element(samples.begin(), samples.end());
+   REQUIRE(totals.min == *min);
+   REQUIRE(totals.max == *max);
+   double sumsq = 0;
+   for (const auto sample : samples)
+      sumsq += sample * sample;
+   REQUIRE(totals.RMS == Approx(std::sqrt(sumsq / samples.size())));
+
+   // Summaries, computed in the background, agree
+   std::vector<float> summary64k(3 * 4);
+   REQUIRE(block->GetSummary64k(summary64k.data(), 0, 4));
+   float summaryMin = summary64k[0], summaryMax = summary64k[1];
+   for (size_t ii = 1; ii < 4; ++ii) {
+      summaryMin = std::min(summaryMin, summary64k[3 * ii]);
+      summaryMax = std::max(summaryMax, summary64k[3 * ii + 1]);
+   }
+   REQUIRE(summaryMin == totals.min);
+   REQUIRE(summaryMax == totals.max);
+
+   std::vector<float> summary256(3);
+   REQUIRE(block->GetSummary256(summary256.data(), 0, 1));
+   const auto [min256, max256] =
+      std::minmax_element(samples.begin(), samples.begin() + 256);
+   REQUIRE(summary256[0] == *min256);
+   REQUIRE(summary256[1] == *max256);
+}
+
+TEST_CASE("SqliteSampleBlock reads parts and wholes alike")
+{
+   TestProject test;
+
+   const auto samples = MakeSamples(100000, 3);
+   const auto block = test.factory->Create(
+      reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+      floatSample);
+
+   // A part, the whole, and a part past the end, which is padded with zeroes
+   const auto check = [&]{
+      std::vector<float> part(1000);
+      REQUIRE(block->GetSamples(reinterpret_cast<samplePtr>(part.data()),
+         floatSample, 5000, part.size()) == part.size());
+      REQUIRE(std::equal(part.begin(), part.end(), samples.begin() + 5000));
+
+      std::vector<float> whole(samples.size());
+      REQUIRE(block->GetSamples(reinterpret_cast<samplePtr>(whole.data()),
+         floatSample, 0, whole.size()) == whole.size());
+      REQUIRE(whole == samples);
+
+      std::vector<float> end(1000, 1.0f);
+      REQUIRE(block->GetSamples(reinterpret_cast<samplePtr>(end.data()),
+         floatSample, samples.size() - 500, end.size()) == end.size());
+      REQUIRE(std::equal(
+         end.begin(), end.begin() + 500, samples.end() - 500));
+      REQUIRE(std::all_of(end.begin() + 500, end.end(),
+         [](float sample){ return sample == 0; }));
+   };
+
+   // While still pending
+   check();
+
+   // Once written, a part before the whole is read from the database, and
+   // after it from the decoded block
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+   check();
+   check();
+}
+
+TEST_CASE("SqliteSampleBlock creation overlaps with summarizing")
+{
+   if (!runLocally)
+      return;
+
+   TestProject test;
+
+   constexpr auto numBlocks = 200;
+   constexpr auto blockSize = 262144;
+   const auto samples = MakeSamples(blockSize, 2);
+   std::vector<SampleBlockPtr> blocks;
+   blocks.reserve(numBlocks);
+
+   using namespace std::chrono;
+   const auto start = steady_clock::now();
+   for (int ii = 0; ii < numBlocks; ++ii) {
+      blocks.push_back(test.factory->Create(
+         reinterpret_cast<constSamplePtr>(samples.data()), blockSize,
+         floatSample));
+      // As Sequence does
+      blocks.back()->GetMinMaxRMS();
+   }
+   const auto created = steady_clock::now();
+
+   std::vector<float> summary64k(3 * (blockSize / 65536));
+   for (const auto &block : blocks)
+      REQUIRE(block->GetSummary64k(
+         summary64k.data(), 0, blockSize / 65536));
+   const auto summarized = steady_clock::now();
+
+   std::cout << "Created " << numBlocks << " blocks in "
+             << duration_cast<milliseconds>(created - start).count()
+             << " ms; all summaries were ready after "
+             << duration_cast<milliseconds>(summarized - start).count()
+             << " ms\n";
+}
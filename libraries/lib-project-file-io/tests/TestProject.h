@@ -0,0 +1,49 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TestProject.h
+
+**********************************************************************/
+#pragma once
+
+#include <catch2/catch.hpp>
+
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "SampleBlock.h"
+
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+//! A project with a database in a temporary file
+struct TestProject final
+{
+   TestProject()
+   {
+      REQUIRE(ProjectFileIO::InitializeSQL());
+      fileName = wxFileName::CreateTempFileName(wxT("ProjectFileIOTest"));
+      wxRemoveFile(fileName);
+      auto &projectFileIO = ProjectFileIO::Get(*project);
+      projectFileIO.SetFileName(fileName + wxT(".aup3"));
+      REQUIRE(projectFileIO.OpenProject());
+      factory = SampleBlockFactory::New(*project);
+   }
+
+   ~TestProject()
+   {
+      factory.reset();
+      auto &projectFileIO = ProjectFileIO::Get(*project);
+      projectFileIO.CloseProject();
+      for (const auto suffix :
+         { wxT(".aup3"), wxT(".aup3-wal"), wxT(".aup3-shm") })
+         wxRemoveFile(fileName + suffix);
+   }
+
+   MockedPrefs prefs;
+   const std::shared_ptr<AudacityProject> project{ AudacityProject::Create() };
+   wxString fileName;
+   SampleBlockFactoryPtr factory;
+};
@@ -0,0 +1,166 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UsageLedgerTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "TestProject.h"
+
+#include "DBConnection.h"
+
+#include <sqlite3.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+//! Count of blocks and their total size
+using Usage = std::pair<int64_t, int64_t>;
+
+Usage QueryUsage(sqlite3 *db, const char *sql)
+{
+   sqlite3_stmt *stmt = nullptr;
+   REQUIRE(sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK);
+   REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+   const Usage result{
+      sqlite3_column_int64(stmt, 0), sqlite3_column_int64(stmt, 1) };
+   sqlite3_finalize(stmt);
+   return result;
+}
+
+//! What the triggers keep
+Usage GetLedger(sqlite3 *db)
+{
+   return QueryUsage(db,
+      "SELECT blockcount, bytes FROM sampleblockusage WHERE id = 1;");
+}
+
+//! What a scan of the blocks finds
+Usage ScanBlocks(sqlite3 *db)
+{
+   return QueryUsage(db,
+      "SELECT Count(*), ifnull(sum("
+      "  length(blockid) + length(sampleformat) +"
+      "  length(summin) + length(summax) + length(sumrms) +"
+      "  length(summary256) + length(summary64k) +"
+      "  length(samples)), 0)"
+      "FROM sampleblocks;");
+}
+
+sqlite3 *GetDB(TestProject &test)
+{
+   return ProjectFileIO::Get(*test.project).GetConnection().DB();
+}
+
+//! Checks the ledger against a scan, and returns the count of blocks
+int64_t CheckLedger(TestProject &test)
+{
+   ConnectionPtr::Get(*test.project).FlushPendingBlocks();
+   const auto ledger = GetLedger(GetDB(test));
+   REQUIRE(ledger == ScanBlocks(GetDB(test)));
+   REQUIRE(ledger.second ==
+      ProjectFileIO::Get(*test.project).GetTotalUsage());
+   return ledger.first;
+}
+
+std::vector<SampleBlockPtr> MakeBlocks(TestProject &test, size_t count)
+{
+   // Various sizes, and samples that do not all compress alike
+   std::mt19937 engine{ 5 };
+   std::uniform_int_distribution<size_t> length{ 1, 100000 };
+   std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+   std::vector<SampleBlockPtr> blocks;
+   for (size_t ii = 0; ii < count; ++ii) {
+      std::vector<float> samples(length(engine));
+      for (auto &sample : samples)
+         sample = ii % 2 ? distribution(engine) : 0.25f;
+      blocks.push_back(test.factory->Create(
+         reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+         floatSample));
+   }
+   return blocks;
+}
+
+//! Removes the files of a project at the end of a scope
+struct ProjectFilesRemover final
+{
+   ~ProjectFilesRemover()
+   {
+      for (const auto suffix : { wxT(""), wxT("-wal"), wxT("-shm") })
+         wxRemoveFile(fileName + suffix);
+   }
+   wxString fileName;
+};
+} // namespace
+
+TEST_CASE("The usage ledger counts blocks as they are inserted and deleted")
+{
+   TestProject test;
+   REQUIRE(CheckLedger(test) == 0);
+
+   auto blocks = MakeBlocks(test, 5);
+   REQUIRE(CheckLedger(test) == 5);
+
+   blocks.erase(blocks.begin() + 1, blocks.begin() + 3);
+   REQUIRE(CheckLedger(test) == 3);
+
+   blocks.clear();
+   REQUIRE(CheckLedger(test) == 0);
+   REQUIRE(GetLedger(GetDB(test)) == Usage{ 0, 0 });
+}
+
+TEST_CASE("The usage ledger of a copy counts the copied blocks")
+{
+   // Destroyed after the project closes
+   ProjectFilesRemover remover;
+   TestProject test;
+   auto &projectFileIO = ProjectFileIO::Get(*test.project);
+   // A saved project is copied, not renamed, when saved as another file
+   REQUIRE(projectFileIO.SaveProject(projectFileIO.GetFileName(), nullptr));
+
+   auto blocks = MakeBlocks(test, 4);
+   REQUIRE(CheckLedger(test) == 4);
+   const auto usage = GetLedger(GetDB(test));
+
+   remover.fileName = test.fileName + wxT("_copy.aup3");
+   REQUIRE(projectFileIO.SaveProject(remover.fileName, nullptr));
+   REQUIRE(projectFileIO.GetFileName() == remover.fileName);
+   REQUIRE(CheckLedger(test) == 4);
+   REQUIRE(GetLedger(GetDB(test)) == usage);
+
+   // The triggers of the copy work too
+   blocks.pop_back();
+   REQUIRE(CheckLedger(test) == 3);
+}
+
+TEST_CASE("Opening a file without the usage ledger rebuilds it")
+{
+   TestProject test;
+   auto &projectFileIO = ProjectFileIO::Get(*test.project);
+   auto blocks = MakeBlocks(test, 4);
+   REQUIRE(CheckLedger(test) == 4);
+
+   // As in a file written by an older version, or compacted by one
+   REQUIRE(sqlite3_exec(GetDB(test),
+      "DROP TRIGGER sampleblockusage_insert;"
+      "DROP TRIGGER sampleblockusage_delete;"
+      "DROP TABLE sampleblockusage;",
+      nullptr, nullptr, nullptr) == SQLITE_OK);
+   // Not counted by anything
+   blocks.pop_back();
+
+   REQUIRE(projectFileIO.ReopenProject());
+   REQUIRE(CheckLedger(test) == 3);
+
+   // And kept again
+   blocks.pop_back();
+   REQUIRE(CheckLedger(test) == 2);
+   MakeBlocks(test, 1);
+   REQUIRE(CheckLedger(test) == 2);
+}
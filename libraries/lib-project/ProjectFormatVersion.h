@@ -38,7 +38,20 @@ PROJECT_API bool operator==(ProjectFormatVersion lhs, ProjectFormatVersion rhs)
 PROJECT_API bool operator!=(ProjectFormatVersion lhs, ProjectFormatVersion rhs) noexcept;
 PROJECT_API bool operator<(ProjectFormatVersion lhs, ProjectFormatVersion rhs) noexcept;
 
-//! This constant represents the current version of Audacity
+/*!
+   Versions of the format that a release introduced are that of the release.
+   Changes of the format between releases raise the ModLevel instead, so that
+   the release stays the same, and builds of that release refuse the files
+   that use the changes.
+ */
+//! Version of the format that keeps autosaves as deltas of a full document
+PROJECT_API extern const ProjectFormatVersion AutoSaveDeltaFormatVersion;
+//! Version of the format that stores sample blocks encoded by a codec
+PROJECT_API extern const ProjectFormatVersion EncodedBlocksFormatVersion;
+
+//! This constant represents the newest version of the format that this build
+//! reads, which is the current version of Audacity, or later if the format
+//! changed since its release
 PROJECT_API extern const ProjectFormatVersion SupportedProjectFormatVersion;
 //! This is a helper constant for the "most compatible" project version with the value (3, 0, 0, 0). 
 PROJECT_API extern const ProjectFormatVersion BaseProjectFormatVersion;
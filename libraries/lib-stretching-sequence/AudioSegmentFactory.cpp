@@ -20,10 +20,15 @@
 using ClipConstHolder = std::shared_ptr<const ClipInterface>;
 
 AudioSegmentFactory::AudioSegmentFactory(
-   int sampleRate, int numChannels, ClipConstHolders clips)
+   int sampleRate, int numChannels, ClipConstHolders clips,
+   StretchedClipCache* renderCache)
     : mClips { std::move(clips) }
     , mSampleRate { sampleRate }
     , mNumChannels { numChannels }
+    , mRenderSession { renderCache ?
+                          std::make_unique<StretchedClipCache::Session>(
+                             *renderCache) :
+                          nullptr }
 {
 }
 
@@ -36,6 +41,31 @@ AudioSegmentFactory::CreateAudioSegmentSequence(
              CreateAudioSegmentSequenceBackward(playbackStartTime);
 }
 
+void AudioSegmentFactory::Prepare(
+   double playbackStartTime, PlaybackDirection direction)
+{
+   if (!mRenderSession)
+      return;
+   const auto forward = direction == PlaybackDirection::forward;
+   for (const auto& clip : mClips)
+   {
+      // Where playback enters the clip: at its start, or at the start time
+      // if it lies within the clip
+      if (forward && clip->GetPlayEndTime() > playbackStartTime)
+      {
+         mRenderSession->Request(*clip);
+         mRenderSession->RequestCheckpoint(
+            *clip,
+            std::max(0., playbackStartTime - clip->GetPlayStartTime()),
+            direction);
+      }
+      else if (!forward && clip->GetPlayStartTime() < playbackStartTime)
+         mRenderSession->RequestCheckpoint(
+            *clip, std::max(0., clip->GetPlayEndTime() - playbackStartTime),
+            direction);
+   }
+}
+
 std::vector<std::shared_ptr<AudioSegment>>
 AudioSegmentFactory::CreateAudioSegmentSequenceForward(double t0)
 {
@@ -59,8 +89,21 @@ AudioSegmentFactory::CreateAudioSegmentSequenceForward(double t0)
       }
       else if (clip->GetPlayEndTime() <= t0)
          continue;
-      segments.push_back(std::make_shared<ClipSegment>(
-         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward));
+      const auto durationToDiscard = t0 - clip->GetPlayStartTime();
+      std::shared_ptr<AudioSegment> segment;
+      if (mRenderSession)
+      {
+         segment = mRenderSession->CreateSegment(*clip, durationToDiscard);
+         if (!segment)
+            // Stretch live until the rendering that Prepare() asked for is
+            // ready
+            segment = mRenderSession->CreateLiveSegment(
+               *clip, durationToDiscard, PlaybackDirection::forward);
+      }
+      else
+         segment = std::make_shared<ClipSegment>(
+            *clip, durationToDiscard, PlaybackDirection::forward);
+      segments.push_back(std::move(segment));
       t0 = clip->GetPlayEndTime();
    }
    return segments;
@@ -90,8 +133,13 @@ AudioSegmentFactory::CreateAudioSegmentSequenceBackward(double t0)
       }
       else if (clip->GetPlayStartTime() >= t0)
          continue;
-      segments.push_back(std::make_shared<ClipSegment>(
-         *clip, clip->GetPlayEndTime() - t0, PlaybackDirection::backward));
+      const auto durationToDiscard = clip->GetPlayEndTime() - t0;
+      segments.push_back(
+         mRenderSession ?
+            mRenderSession->CreateLiveSegment(
+               *clip, durationToDiscard, PlaybackDirection::backward) :
+            std::make_shared<ClipSegment>(
+               *clip, durationToDiscard, PlaybackDirection::backward));
       t0 = clip->GetPlayStartTime();
    }
    return segments;
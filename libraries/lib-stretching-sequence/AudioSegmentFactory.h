@@ -13,6 +13,7 @@
 
 #include "AudioSegmentFactoryInterface.h"
 #include "ClipInterface.h"
+#include "StretchedClipCache.h"
 #include "TimeAndPitchInterface.h"
 
 #include <memory>
@@ -24,11 +25,23 @@ class STRETCHING_SEQUENCE_API AudioSegmentFactory final :
     public AudioSegmentFactoryInterface
 {
 public:
-   AudioSegmentFactory(int sampleRate, int numChannels, ClipConstHolders clips);
+   /*!
+    @param renderCache if not null, forward segments of stretched clips copy
+    from its renderings when there are any ; other segments of stretched
+    clips resume from its checkpoints ; Prepare() asks for both
+    */
+   AudioSegmentFactory(
+      int sampleRate, int numChannels, ClipConstHolders clips,
+      StretchedClipCache* renderCache = nullptr);
 
    std::vector<std::shared_ptr<AudioSegment>> CreateAudioSegmentSequence(
       double playbackStartTime, PlaybackDirection) override;
 
+   //! Asks the render cache for renderings of the stretched clips that
+   //! forward playback from the given time reaches, and for checkpoints where
+   //! it enters each of them
+   void Prepare(double playbackStartTime, PlaybackDirection) override;
+
 private:
    std::vector<std::shared_ptr<AudioSegment>>
    CreateAudioSegmentSequenceForward(double playbackStartTime);
@@ -40,4 +53,6 @@ private:
    const ClipConstHolders mClips;
    const int mSampleRate;
    const int mNumChannels;
+   // Destroyed before the clips, which its renderers read
+   const std::unique_ptr<StretchedClipCache::Session> mRenderSession;
 };
@@ -1,3 +1,7 @@
 #include "AudioSegmentFactoryInterface.h"
 
 AudioSegmentFactoryInterface::~AudioSegmentFactoryInterface() = default;
+
+void AudioSegmentFactoryInterface::Prepare(double, PlaybackDirection)
+{
+}
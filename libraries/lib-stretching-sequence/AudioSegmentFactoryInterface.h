@@ -26,4 +26,8 @@ public:
 
    virtual std::vector<std::shared_ptr<AudioSegment>>
    CreateAudioSegmentSequence(double playbackStartTime, PlaybackDirection) = 0;
+
+   //! Called on the main thread before playback, for each time that it starts
+   //! from and may come back to; does nothing by default
+   virtual void Prepare(double playbackStartTime, PlaybackDirection);
 };
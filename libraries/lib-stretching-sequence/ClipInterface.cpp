@@ -3,3 +3,8 @@
 ClipTimes::~ClipTimes() = default;
 
 ClipInterface::~ClipInterface() = default;
+
+size_t ClipInterface::GetContentVersion() const
+{
+   return 0;
+}
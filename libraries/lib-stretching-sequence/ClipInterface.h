@@ -63,6 +63,14 @@ public:
    [[nodiscard]] virtual Observer::Subscription
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const = 0;
+
+   /*!
+    * Identifies the samples that `GetSampleView` gives: it changes, to a value
+    * that no clip had before, whenever they may have changed. Zero, the
+    * default, means the clip has no such identity, and nothing computed from
+    * its samples may be cached.
+    */
+   virtual size_t GetContentVersion() const;
 };
 
 using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
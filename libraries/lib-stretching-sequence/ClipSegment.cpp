@@ -38,18 +38,43 @@ GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
 }
 } // namespace
 
+struct ClipSegment::Checkpoint
+{
+   sampleCount position;
+   std::shared_ptr<const StaffPadTimeAndPitch::Snapshot> stretcher;
+};
+
+namespace
+{
+std::unique_ptr<StaffPadTimeAndPitch> CreateStretcher(
+   const ClipInterface& clip, ClipTimeAndPitchSource& source,
+   const ClipSegment::Checkpoint* checkpoint)
+{
+   const auto params = GetStretchingParameters(clip);
+   if (
+      checkpoint &&
+      checkpoint->stretcher->Matches(clip.GetRate(), clip.NChannels(), params))
+   {
+      source.SetPosition(checkpoint->position);
+      return std::make_unique<StaffPadTimeAndPitch>(
+         clip.GetRate(), clip.NChannels(), source, params,
+         checkpoint->stretcher.get());
+   }
+   return std::make_unique<StaffPadTimeAndPitch>(
+      clip.GetRate(), clip.NChannels(), source, params);
+}
+} // namespace
+
 ClipSegment::ClipSegment(
    const ClipInterface& clip, double durationToDiscard,
-   PlaybackDirection direction)
+   PlaybackDirection direction, const Checkpoint* checkpoint)
     : mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
          clip, durationToDiscard) }
     , mSource { clip, durationToDiscard, direction }
     , mPreserveFormants { clip.GetPitchAndSpeedPreset() ==
                           PitchAndSpeedPreset::OptimizeForVoice }
     , mCentShift { clip.GetCentShift() }
-    , mStretcher { std::make_unique<StaffPadTimeAndPitch>(
-         clip.GetRate(), clip.NChannels(), mSource,
-         GetStretchingParameters(clip)) }
+    , mStretcher { CreateStretcher(clip, mSource, checkpoint) }
     , mOnSemitoneShiftChangeSubscription { clip.SubscribeToCentShiftChange(
          [this](int cents) {
             mCentShift = cents;
@@ -92,6 +117,18 @@ size_t ClipSegment::GetFloats(float* const* buffers, size_t numSamples)
    return numSamplesToProduce;
 }
 
+std::shared_ptr<const ClipSegment::Checkpoint>
+ClipSegment::TakeCheckpoint() const
+{
+   if (mTotalNumSamplesProduced > 0)
+      return nullptr;
+   auto stretcher = mStretcher->TakeSnapshot();
+   if (!stretcher)
+      return nullptr;
+   return std::make_shared<Checkpoint>(
+      Checkpoint { mSource.GetPosition(), std::move(stretcher) });
+}
+
 bool ClipSegment::Empty() const
 {
    return mTotalNumSamplesProduced == mTotalNumSamplesToProduce;
@@ -18,7 +18,7 @@
 #include <memory>
 
 class ClipInterface;
-class TimeAndPitchInterface;
+class StaffPadTimeAndPitch;
 
 using PitchRatioChangeCbSubscriber =
    std::function<void(std::function<void(double)>)>;
@@ -30,10 +30,24 @@ using PitchRatioChangeCbSubscriber =
 class STRETCHING_SEQUENCE_API ClipSegment final : public AudioSegment
 {
 public:
+   //! Where a segment stood before producing any samples, for another of the
+   //! same clip, start and direction to resume from instead of priming its
+   //! stretcher
+   struct Checkpoint;
+
+   /*!
+    @param checkpoint if not null, taken from a segment of the same clip, with
+    the same stretching parameters, start and direction
+    */
    ClipSegment(const ClipInterface&,
-      double durationToDiscard, PlaybackDirection);
+      double durationToDiscard, PlaybackDirection,
+      const Checkpoint* checkpoint = nullptr);
    ~ClipSegment() override;
 
+   //! @return null if samples were produced already, or if nothing is gained
+   //! in resuming, as when the clip is not stretched
+   std::shared_ptr<const Checkpoint> TakeCheckpoint() const;
+
    // AudioSegment
    size_t GetFloats(float* const* buffers, size_t numSamples) override;
    bool Empty() const override;
@@ -50,7 +64,7 @@ private:
    // Careful that this guy is constructed after `mSource`, which it refers to
    // in its ctor.
    // todo(mhodgkinson) make this safe.
-   std::unique_ptr<TimeAndPitchInterface> mStretcher;
+   std::unique_ptr<StaffPadTimeAndPitch> mStretcher;
    Observer::Subscription mOnSemitoneShiftChangeSubscription;
    Observer::Subscription mOnFormantPreservationChangeSubscription;
 };
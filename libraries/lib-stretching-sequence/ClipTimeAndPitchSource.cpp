@@ -91,3 +91,13 @@ size_t ClipTimeAndPitchSource::NChannels() const
 {
    return mClip.NChannels();
 }
+
+sampleCount ClipTimeAndPitchSource::GetPosition() const
+{
+   return mLastReadSample;
+}
+
+void ClipTimeAndPitchSource::SetPosition(sampleCount position)
+{
+   mLastReadSample = position;
+}
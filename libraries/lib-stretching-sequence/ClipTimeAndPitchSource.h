@@ -32,6 +32,11 @@ public:
 
    size_t NChannels() const;
 
+   //! Where the next forward Pull starts, or where the next backward one ends
+   sampleCount GetPosition() const;
+   //! Continue from where another source of the same clip and direction was
+   void SetPosition(sampleCount position);
+
 private:
    const ClipInterface& mClip;
    sampleCount mLastReadSample = 0;
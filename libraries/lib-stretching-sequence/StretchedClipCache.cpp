@@ -0,0 +1,479 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file StretchedClipCache.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioSegment.h"
+#include "ClipSegment.h"
+#include "concurrency/WorkStealingPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <tuple>
+
+BoolSetting StretchedClipRendering{ L"/AudioIO/RenderStretchedClips", false };
+IntSetting StretchedClipCacheSize{ L"/AudioIO/StretchedClipCacheSize", 256 };
+
+namespace
+{
+constexpr size_t DefaultMemoryBudget = 256 << 20;
+
+bool NeedsStretching(const ClipInterface& clip)
+{
+   return clip.GetStretchRatio() != 1.0 || clip.GetCentShift() != 0;
+}
+
+sampleCount
+GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
+{
+   // As for ClipSegment
+   return sampleCount { clip.GetVisibleSampleCount().as_double() *
+                           clip.GetStretchRatio() -
+                        durationToDiscard * clip.GetRate() + .5 };
+}
+
+//! Output samples before where a segment starts
+sampleCount GetStart(const ClipInterface& clip, double durationToDiscard)
+{
+   return sampleCount { durationToDiscard * clip.GetRate() + .5 };
+}
+
+//! Copies from a rendering, until the pitch shift or the preset of the clip
+//! changes, and then stretches live
+class RenderedClipSegment final : public AudioSegment
+{
+public:
+   RenderedClipSegment(
+      const ClipInterface& clip, double durationToDiscard,
+      std::shared_ptr<const StretchedClipCache::Rendering> rendering)
+       : mClip { clip }
+       , mRendering { std::move(rendering) }
+       , mPosition { mRendering->length -
+                     std::clamp(
+                        GetTotalNumSamplesToProduce(clip, durationToDiscard),
+                        sampleCount { 0 }, mRendering->length) }
+       , mOnCentShiftChangeSubscription { clip.SubscribeToCentShiftChange(
+            [this](int) { mChanged = true; }) }
+       , mOnPresetChangeSubscription {
+          clip.SubscribeToPitchAndSpeedPresetChange(
+             [this](PitchAndSpeedPreset) { mChanged = true; })
+       }
+   {
+   }
+
+   ~RenderedClipSegment() override
+   {
+      mOnCentShiftChangeSubscription.Reset();
+      mOnPresetChangeSubscription.Reset();
+   }
+
+   size_t GetFloats(float* const* buffers, size_t numSamples) override
+   {
+      if (!mLive && mChanged)
+         mLive = std::make_unique<ClipSegment>(
+            mClip, mPosition.as_double() / mClip.GetRate(),
+            PlaybackDirection::forward);
+      if (mLive)
+         return mLive->GetFloats(buffers, numSamples);
+
+      constexpr auto blockSize = StretchedClipCache::Rendering::BlockSize;
+      const auto numSamplesToProduce =
+         limitSampleBufferSize(numSamples, mRendering->length - mPosition);
+      const auto start = mPosition.as_size_t();
+      for (size_t iChannel = 0; iChannel < NChannels(); ++iChannel)
+      {
+         const auto& blocks = mRendering->channels[iChannel];
+         size_t copied = 0;
+         while (copied < numSamplesToProduce)
+         {
+            const auto position = start + copied;
+            const auto& block = *blocks[position / blockSize];
+            const auto offset = position % blockSize;
+            const auto count =
+               std::min(numSamplesToProduce - copied, block.size() - offset);
+            std::copy_n(
+               block.data() + offset, count, buffers[iChannel] + copied);
+            copied += count;
+         }
+      }
+      mPosition += numSamplesToProduce;
+      return numSamplesToProduce;
+   }
+
+   bool Empty() const override
+   {
+      return mLive ? mLive->Empty() : mPosition == mRendering->length;
+   }
+
+   size_t NChannels() const override
+   {
+      return mRendering->channels.size();
+   }
+
+private:
+   const ClipInterface& mClip;
+   const std::shared_ptr<const StretchedClipCache::Rendering> mRendering;
+   sampleCount mPosition;
+   std::unique_ptr<ClipSegment> mLive;
+   std::atomic<bool> mChanged = false;
+   Observer::Subscription mOnCentShiftChangeSubscription;
+   Observer::Subscription mOnPresetChangeSubscription;
+};
+} // namespace
+
+bool StretchedClipCache::Key::operator<(const Key& other) const
+{
+   return std::tie(
+             contentVersion, visibleSampleCount, rate, nChannels,
+             stretchRatio, centShift, preset) <
+          std::tie(
+             other.contentVersion, other.visibleSampleCount, other.rate,
+             other.nChannels, other.stretchRatio, other.centShift,
+             other.preset);
+}
+
+bool StretchedClipCache::Key::operator==(const Key& other) const
+{
+   return !(*this < other) && !(other < *this);
+}
+
+bool StretchedClipCache::CheckpointKey::operator<(
+   const CheckpointKey& other) const
+{
+   if (key < other.key)
+      return true;
+   if (other.key < key)
+      return false;
+   return std::tie(direction, start) < std::tie(other.direction, other.start);
+}
+
+size_t StretchedClipCache::Rendering::GetSpaceUsage() const
+{
+   size_t result = 0;
+   for (const auto& blocks : channels)
+      for (const auto& block : blocks)
+         result += block->size() * sizeof(float);
+   return result;
+}
+
+struct StretchedClipCache::Session::State
+{
+   std::mutex mutex;
+   std::condition_variable idle;
+   //! Workers reading clips of the session
+   size_t nRunning { 0 };
+   //! Keys of renderings requested and not finished
+   std::set<Key> pending;
+   std::atomic<bool> cancelled { false };
+};
+
+StretchedClipCache::Session::Session(StretchedClipCache& cache)
+    : mCache { cache }
+    , mState { std::make_shared<State>() }
+{
+}
+
+StretchedClipCache::Session::~Session()
+{
+   // Workers that did not start yet won't read the clips, or the cache
+   std::unique_lock<std::mutex> lock { mState->mutex };
+   mState->cancelled = true;
+   mState->idle.wait(lock, [this] { return mState->nRunning == 0; });
+   for (const auto& key : mState->pending)
+      mCache.EndRendering(key, nullptr);
+}
+
+std::shared_ptr<AudioSegment> StretchedClipCache::Session::CreateSegment(
+   const ClipInterface& clip, double durationToDiscard)
+{
+   if (!NeedsStretching(clip))
+      return nullptr;
+   const auto key = GetKey(clip);
+   if (!key)
+      return nullptr;
+   auto rendering = mCache.Find(*key, false);
+   if (!rendering)
+      return nullptr;
+   return std::make_shared<RenderedClipSegment>(
+      clip, durationToDiscard, std::move(rendering));
+}
+
+std::shared_ptr<AudioSegment> StretchedClipCache::Session::CreateLiveSegment(
+   const ClipInterface& clip, double durationToDiscard,
+   PlaybackDirection direction)
+{
+   const auto key =
+      NeedsStretching(clip) ? GetKey(clip) : std::optional<Key> {};
+   const auto checkpoint = key ?
+      mCache.FindCheckpoint(
+         { *key, direction, GetStart(clip, durationToDiscard) }, false) :
+      nullptr;
+   return std::make_shared<ClipSegment>(
+      clip, durationToDiscard, direction, checkpoint.get());
+}
+
+void StretchedClipCache::Session::RequestCheckpoint(
+   const ClipInterface& clip, double durationToDiscard,
+   PlaybackDirection direction)
+{
+   if (!NeedsStretching(clip))
+      return;
+   const auto key = GetKey(clip);
+   if (!key)
+      return;
+   const CheckpointKey checkpointKey { *key, direction,
+                                       GetStart(clip, durationToDiscard) };
+   if (mCache.FindCheckpoint(checkpointKey))
+      return;
+   Post([&cache = mCache, &clip, durationToDiscard, checkpointKey] {
+      try
+      {
+         // Constructing the segment primes its stretcher
+         const ClipSegment segment { clip, durationToDiscard,
+                                     checkpointKey.direction };
+         if (GetKey(clip) == checkpointKey.key)
+            cache.AddCheckpoint(checkpointKey, segment.TakeCheckpoint());
+      }
+      catch (...)
+      {
+         // Playback primes live
+      }
+   });
+}
+
+void StretchedClipCache::Session::Request(const ClipInterface& clip)
+{
+   if (!NeedsStretching(clip))
+      return;
+   const auto key = GetKey(clip);
+   if (!key)
+      return;
+   const auto estimatedSpace =
+      static_cast<size_t>(
+         key->visibleSampleCount.as_double() * key->stretchRatio + 1) *
+      key->nChannels * sizeof(float);
+   if (!mCache.BeginRendering(*key, estimatedSpace))
+      return;
+   {
+      std::lock_guard<std::mutex> lock { mState->mutex };
+      mState->pending.insert(*key);
+   }
+
+   Post([&cache = mCache, state = mState, &clip, key = *key] {
+      std::shared_ptr<const Rendering> rendering;
+      try
+      {
+         rendering = Render(clip, [&] { return state->cancelled.load(); });
+         // Don't keep what the clip no longer sounds like
+         const auto current = GetKey(clip);
+         if (rendering && !(current && *current == key))
+            rendering.reset();
+      }
+      catch (...)
+      {
+         // Playback goes on stretching live
+      }
+      cache.EndRendering(key, std::move(rendering));
+
+      std::lock_guard<std::mutex> lock { state->mutex };
+      state->pending.erase(key);
+   });
+}
+
+void StretchedClipCache::Session::Post(std::function<void()> job)
+{
+   audacity::concurrency::WorkStealingPool::GetShared().Post(
+      [state = mState, job = std::move(job)] {
+         {
+            std::lock_guard<std::mutex> lock { state->mutex };
+            if (state->cancelled)
+               return;
+            ++state->nRunning;
+         }
+         job();
+         std::lock_guard<std::mutex> lock { state->mutex };
+         --state->nRunning;
+         state->idle.notify_all();
+      });
+}
+
+StretchedClipCache* StretchedClipCache::GetForPlayback()
+{
+   static StretchedClipCache cache;
+   if (!StretchedClipRendering.Read())
+   {
+      // Release what earlier playback kept
+      cache.SetMemoryBudget(0);
+      return nullptr;
+   }
+   cache.SetMemoryBudget(
+      static_cast<size_t>(std::max(0, StretchedClipCacheSize.Read())) << 20);
+   return &cache;
+}
+
+StretchedClipCache::StretchedClipCache()
+    : mMemoryBudget { DefaultMemoryBudget }
+{
+}
+
+StretchedClipCache::~StretchedClipCache() = default;
+
+void StretchedClipCache::SetMemoryBudget(size_t bytes)
+{
+   // Declared before the lock, so freed after it is released
+   Entries removed;
+   std::lock_guard<std::mutex> lock { mMutex };
+   mMemoryBudget = bytes;
+   removed = Trim();
+}
+
+std::optional<StretchedClipCache::Key>
+StretchedClipCache::GetKey(const ClipInterface& clip)
+{
+   const auto contentVersion = clip.GetContentVersion();
+   if (contentVersion == 0)
+      return std::nullopt;
+   return Key { contentVersion,         clip.GetVisibleSampleCount(),
+                clip.GetRate(),         clip.NChannels(),
+                clip.GetStretchRatio(), clip.GetCentShift(),
+                clip.GetPitchAndSpeedPreset() };
+}
+
+std::shared_ptr<const StretchedClipCache::Rendering>
+StretchedClipCache::Find(const Key& key, bool wait)
+{
+   std::unique_lock<std::mutex> lock { mMutex, std::defer_lock };
+   if (wait)
+      lock.lock();
+   else if (!lock.try_lock())
+      return nullptr;
+   const auto found = mIndex.find(key);
+   if (found == mIndex.end())
+      return nullptr;
+   mEntries.splice(mEntries.begin(), mEntries, found->second);
+   return found->second->second;
+}
+
+bool StretchedClipCache::HasCheckpoint(
+   const ClipInterface& clip, double durationToDiscard,
+   PlaybackDirection direction)
+{
+   const auto key = GetKey(clip);
+   return key && FindCheckpoint(
+      { *key, direction, GetStart(clip, durationToDiscard) }) != nullptr;
+}
+
+void StretchedClipCache::Add(
+   const Key& key, std::shared_ptr<const Rendering> rendering)
+{
+   // Declared before the lock, so freed after it is released
+   Entries removed;
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (!rendering || mIndex.count(key) ||
+       rendering->GetSpaceUsage() > mMemoryBudget)
+      return;
+   mSpaceUsage += rendering->GetSpaceUsage();
+   mEntries.emplace_front(key, std::move(rendering));
+   mIndex.emplace(key, mEntries.begin());
+   removed = Trim();
+}
+
+std::shared_ptr<const StretchedClipCache::Rendering>
+StretchedClipCache::Render(
+   const ClipInterface& clip, const std::function<bool()>& cancelled)
+{
+   ClipSegment segment { clip, 0., PlaybackDirection::forward };
+   const auto nChannels = segment.NChannels();
+   auto result = std::make_shared<Rendering>();
+   result->channels.resize(nChannels);
+   result->length = 0;
+   std::vector<float*> buffers(nChannels);
+   while (!segment.Empty())
+   {
+      if (cancelled && cancelled())
+         return nullptr;
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+      {
+         auto block =
+            std::make_shared<std::vector<float>>(Rendering::BlockSize);
+         buffers[iChannel] = block->data();
+         result->channels[iChannel].push_back(std::move(block));
+      }
+      const auto produced =
+         segment.GetFloats(buffers.data(), Rendering::BlockSize);
+      for (auto& blocks : result->channels)
+         blocks.back()->resize(produced);
+      result->length += produced;
+   }
+   return result;
+}
+
+StretchedClipCache::Checkpoint
+StretchedClipCache::FindCheckpoint(const CheckpointKey& key, bool wait)
+{
+   std::unique_lock<std::mutex> lock { mMutex, std::defer_lock };
+   if (wait)
+      lock.lock();
+   else if (!lock.try_lock())
+      return nullptr;
+   const auto found = mCheckpointIndex.find(key);
+   if (found == mCheckpointIndex.end())
+      return nullptr;
+   mCheckpoints.splice(mCheckpoints.begin(), mCheckpoints, found->second);
+   return found->second->second;
+}
+
+void StretchedClipCache::AddCheckpoint(
+   const CheckpointKey& key, Checkpoint checkpoint)
+{
+   // Declared before the lock, so freed after it is released
+   Checkpoints removed;
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (!checkpoint || mCheckpointIndex.count(key))
+      return;
+   mCheckpoints.emplace_front(key, std::move(checkpoint));
+   mCheckpointIndex.emplace(key, mCheckpoints.begin());
+   if (mCheckpoints.size() > MaxCheckpoints)
+   {
+      mCheckpointIndex.erase(mCheckpoints.back().first);
+      removed.splice(
+         removed.end(), mCheckpoints, std::prev(mCheckpoints.end()));
+   }
+}
+
+bool StretchedClipCache::BeginRendering(const Key& key, size_t estimatedSpace)
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (estimatedSpace > mMemoryBudget || mIndex.count(key))
+      return false;
+   return mInProgress.insert(key).second;
+}
+
+void StretchedClipCache::EndRendering(
+   const Key& key, std::shared_ptr<const Rendering> rendering)
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mInProgress.erase(key);
+   }
+   Add(key, std::move(rendering));
+}
+
+StretchedClipCache::Entries StretchedClipCache::Trim()
+{
+   Entries removed;
+   while (mSpaceUsage > mMemoryBudget && !mEntries.empty())
+   {
+      const auto last = std::prev(mEntries.end());
+      mSpaceUsage -= last->second->GetSpaceUsage();
+      mIndex.erase(last->first);
+      removed.splice(removed.end(), mEntries, last);
+   }
+   return removed;
+}
@@ -0,0 +1,221 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file StretchedClipCache.h
+
+  @brief Stretched and pitch-shifted clips, rendered in the background
+
+**********************************************************************/
+#pragma once
+
+#include "AudioSegmentSampleView.h"
+#include "ClipInterface.h"
+#include "ClipSegment.h"
+#include "Prefs.h"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+
+class AudioSegment;
+
+//! Whether playback renders stretched clips in the background, read when
+//! playback starts
+extern STRETCHING_SEQUENCE_API BoolSetting StretchedClipRendering;
+//! Megabytes of rendered stretched clips kept for playback, read when
+//! playback starts
+extern STRETCHING_SEQUENCE_API IntSetting StretchedClipCacheSize;
+
+//! Renders the stretched and pitch-shifted output of clips on a worker, and
+//! keeps it for later playback
+/*!
+ Playback of a clip whose stretch ratio or pitch shift differs from 1 runs a
+ stretcher live.  The first time, a Session also asks for a rendering of the
+ whole clip, so that later playback, such as the next pass of a loop, only
+ copies samples.
+
+ Renderings are found by the content version of the clip and by its stretching
+ parameters, so that a rendering of a clip that changed is never served.  The
+ least recently used ones are dropped to keep within a memory budget.
+
+ Until a rendering is ready, and when playing backward, segments stretch
+ live.  When playback starts, a worker primes a stretcher at each place where
+ playback enters a clip, and keeps a checkpoint of it.  A live segment that
+ starts at the same place, as at each pass of a loop, resumes from it rather
+ than priming a stretcher from scratch on the audio thread.
+ */
+class STRETCHING_SEQUENCE_API StretchedClipCache final
+{
+public:
+   //! Identifies the output of a clip
+   struct Key
+   {
+      size_t contentVersion;
+      sampleCount visibleSampleCount;
+      int rate;
+      size_t nChannels;
+      double stretchRatio;
+      int centShift;
+      PitchAndSpeedPreset preset;
+
+      bool operator<(const Key& other) const;
+      bool operator==(const Key& other) const;
+   };
+
+   //! Count of checkpoints kept, the least recently used being dropped
+   static constexpr size_t MaxCheckpoints = 32;
+
+   //! The output of a clip, from its play start time to its play end time
+   struct Rendering
+   {
+      static constexpr size_t BlockSize = 1 << 16;
+
+      //! For each channel, `BlockSize` samples in each block but the last
+      std::vector<std::vector<BlockSampleView>> channels;
+      sampleCount length;
+
+      size_t GetSpaceUsage() const;
+   };
+
+   //! Renderings asked for by one sequence
+   /*!
+    Clips are read on the worker while a session lasts, as they are by
+    playback, so a session should not outlive the playback that uses it.
+    */
+   class STRETCHING_SEQUENCE_API Session final
+   {
+   public:
+      explicit Session(StretchedClipCache& cache);
+      //! Stops the renderings that it asked for, and waits for their workers
+      ~Session();
+
+      //! A segment copying from the rendering of `clip`, if there is one
+      /*!
+       It plays forward as a ClipSegment would, and changes to live stretching
+       if the pitch shift or preset of the clip changes.
+
+       Lookups don't wait for workers that use the cache, so that the audio
+       thread may call this and CreateLiveSegment().
+       @return null if the clip is not rendered
+       */
+      std::shared_ptr<AudioSegment>
+      CreateSegment(const ClipInterface& clip, double durationToDiscard);
+
+      //! A ClipSegment, resumed from a checkpoint with the same start if
+      //! there is one
+      std::shared_ptr<AudioSegment> CreateLiveSegment(
+         const ClipInterface& clip, double durationToDiscard,
+         PlaybackDirection direction);
+
+      //! Prime a stretcher for `clip` on a worker, and keep a checkpoint of
+      //! it for live segments with the same start, unless there is one
+      /*!
+       Call on the main thread when playback starts, for the places that it
+       enters the clip, so that checkpoints are neither taken on the audio
+       thread nor for every place that playback may jump to.
+       @pre `clip` outlives this
+       */
+      void RequestCheckpoint(const ClipInterface& clip,
+         double durationToDiscard, PlaybackDirection direction);
+
+      //! Start rendering `clip` on a worker, unless it needs no stretching,
+      //! or is rendered or being rendered
+      /*!
+       Call on the main thread when playback starts.
+       @pre `clip` outlives this
+       */
+      void Request(const ClipInterface& clip);
+
+   private:
+      struct State;
+
+      //! Runs `job` on a worker, unless the session ends first
+      void Post(std::function<void()> job);
+
+      StretchedClipCache& mCache;
+      const std::shared_ptr<State> mState;
+   };
+
+   //! The cache for playback, with the budget of StretchedClipCacheSize
+   /*! @return null if StretchedClipRendering is off */
+   static StretchedClipCache* GetForPlayback();
+
+   StretchedClipCache();
+   ~StretchedClipCache();
+
+   //! Zero keeps no renderings, and so disables background rendering
+   void SetMemoryBudget(size_t bytes);
+
+   //! @return nullopt if the output of the clip must not be cached
+   static std::optional<Key> GetKey(const ClipInterface& clip);
+
+   /*!
+    @param wait if false, as on the audio thread, give up rather than wait
+    for another thread that uses the cache
+    @return null if there is no rendering for the key
+    */
+   std::shared_ptr<const Rendering> Find(const Key& key, bool wait = true);
+
+   //! Whether live segments of `clip` with this start resume from a
+   //! checkpoint
+   bool HasCheckpoint(const ClipInterface& clip, double durationToDiscard,
+      PlaybackDirection direction);
+
+   //! Keeps a rendering, dropping others if over budget
+   void Add(const Key& key, std::shared_ptr<const Rendering> rendering);
+
+   //! Makes a rendering, on this thread; for tests and workers
+   /*!
+    @param cancelled polled between blocks
+    @return null if cancelled
+    */
+   static std::shared_ptr<const Rendering> Render(const ClipInterface& clip,
+      const std::function<bool()>& cancelled = {});
+
+private:
+   //! Identifies where a live segment starts
+   struct CheckpointKey
+   {
+      Key key;
+      PlaybackDirection direction;
+      //! Samples of output discarded, so that starts that differ by less
+      //! than a sample, in rounding of times, share checkpoints
+      sampleCount start;
+
+      bool operator<(const CheckpointKey& other) const;
+   };
+   using Checkpoint = std::shared_ptr<const ClipSegment::Checkpoint>;
+
+   Checkpoint FindCheckpoint(const CheckpointKey& key, bool wait = true);
+   void AddCheckpoint(const CheckpointKey& key, Checkpoint checkpoint);
+
+   using Entries = std::list<std::pair<Key, std::shared_ptr<const Rendering>>>;
+
+   //! @return false if the key is rendered, being rendered, or too big
+   bool BeginRendering(const Key& key, size_t estimatedSpace);
+   void EndRendering(const Key& key, std::shared_ptr<const Rendering> rendering);
+   //! Removes the least recently used renderings until within budget
+   /*! @return the removed renderings, to be freed outside of the lock */
+   Entries Trim();
+
+   std::mutex mMutex;
+   //! Most recently used first
+   Entries mEntries;
+   std::map<Key, Entries::iterator> mIndex;
+   //! Keys of renderings that workers make
+   std::set<Key> mInProgress;
+   size_t mSpaceUsage { 0 };
+   size_t mMemoryBudget;
+
+   using Checkpoints = std::list<std::pair<CheckpointKey, Checkpoint>>;
+   //! Most recently used first
+   Checkpoints mCheckpoints;
+   std::map<CheckpointKey, Checkpoints::iterator> mCheckpointIndex;
+};
@@ -43,6 +43,12 @@ void StretchingSequence::ResetCursor(double t, PlaybackDirection direction)
    mExpectedStart = TimeToLongSamples(t);
 }
 
+void StretchingSequence::PrepareToPlay(
+   double t, PlaybackDirection direction) const
+{
+   mAudioSegmentFactory->Prepare(t, direction);
+}
+
 bool StretchingSequence::GetNext(
    float* const buffers[], size_t numChannels, size_t numSamples)
 {
@@ -149,6 +155,14 @@ void StretchingSequence::GetEnvelopeValues(
    mSequence.GetEnvelopeValues(buffer, bufferLen, t0, backwards);
 }
 
+bool StretchingSequence::GetEnvelopeSegments(
+   EnvelopeSegments& segments, size_t bufferLen, double t0,
+   bool backwards, size_t maxSize) const
+{
+   return mSequence.GetEnvelopeSegments(
+      segments, bufferLen, t0, backwards, maxSize);
+}
+
 AudioGraph::ChannelType StretchingSequence::GetChannelType() const
 {
    return mSequence.GetChannelType();
@@ -187,11 +201,12 @@ bool StretchingSequence::MutableGet(
 }
 
 std::shared_ptr<StretchingSequence> StretchingSequence::Create(
-   const PlayableSequence& sequence, const ClipConstHolders& clips)
+   const PlayableSequence& sequence, const ClipConstHolders& clips,
+   StretchedClipCache* renderCache)
 {
    const int sampleRate = sequence.GetRate();
    return std::make_shared<StretchingSequence>(
       sequence, sampleRate, sequence.NChannels(),
       std::make_unique<AudioSegmentFactory>(
-         sampleRate, sequence.NChannels(), clips));
+         sampleRate, sequence.NChannels(), clips, renderCache));
 }
@@ -20,6 +20,7 @@
 class AudioSegment;
 class AudioSegmentFactoryInterface;
 class ClipInterface;
+class StretchedClipCache;
 using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
 
 // For now this class assumes forward reading, which will be sufficient for the
@@ -27,8 +28,14 @@ using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
 class STRETCHING_SEQUENCE_API StretchingSequence final : public PlayableSequence
 {
 public:
-   static std::shared_ptr<StretchingSequence>
-   Create(const PlayableSequence&, const ClipConstHolders& clips);
+   /*!
+    @param renderCache if not null, stretched clips are rendered in the
+    background, and stretchers are primed in the background for each place
+    given to PrepareToPlay(), for playback that comes back to them
+    */
+   static std::shared_ptr<StretchingSequence> Create(
+      const PlayableSequence&, const ClipConstHolders& clips,
+      StretchedClipCache* renderCache = nullptr);
 
    StretchingSequence(
       const PlayableSequence&, int sampleRate, size_t numChannels,
@@ -45,6 +52,9 @@ public:
    void GetEnvelopeValues(
       double* buffer, size_t bufferLen, double t0,
       bool backwards) const override;
+   bool GetEnvelopeSegments(
+      EnvelopeSegments& segments, size_t bufferLen, double t0,
+      bool backwards, size_t maxSize) const override;
    bool DoGet(
       size_t iChannel, size_t nBuffers, const samplePtr buffers[],
       sampleFormat format, sampleCount start, size_t len, bool backwards,
@@ -60,6 +70,10 @@ public:
    AudioGraph::ChannelType GetChannelType() const override;
 
    // class methods
+   //! Call on the main thread before playback, for each time that it starts
+   //! from and may come back to, as at each pass of a loop
+   void PrepareToPlay(double t, PlaybackDirection) const;
+
    bool GetFloats(
       float* buffers[], sampleCount start, size_t len, bool backwards) const;
 
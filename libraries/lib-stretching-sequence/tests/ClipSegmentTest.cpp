@@ -15,6 +15,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <cmath>
+
 namespace
 {
 constexpr auto sampleRate = 3;
@@ -75,4 +77,41 @@ TEST_CASE("ClipSegment")
                                std::vector<float> { 3.f, 2.f, 1.f, 0.f, 0.f };
       REQUIRE(output.channelVectors[0] == expected);
    }
+
+   SECTION("resumes from a checkpoint as it would have after priming")
+   {
+      std::vector<float> audio(10000);
+      for (auto i = 0u; i < audio.size(); ++i)
+         audio[i] = std::sin(i * 0.1f);
+      constexpr auto rate = 44100;
+      const auto clip = std::make_shared<FloatVectorClip>(rate, audio, 2u);
+      clip->stretchRatio = 1.5;
+      // Also with the formant shifter
+      if (GENERATE(false, true))
+      {
+         clip->centShift = 300;
+         clip->preset = PitchAndSpeedPreset::OptimizeForVoice;
+      }
+      const auto playbackOffset = 1000. / rate;
+      ClipSegment first { *clip, playbackOffset, direction };
+      const auto checkpoint = first.TakeCheckpoint();
+      REQUIRE(checkpoint);
+      ClipSegment second { *clip, playbackOffset, direction, checkpoint.get() };
+      constexpr auto numSamples = 20000u;
+      AudioContainer expected(numSamples, 2u);
+      AudioContainer actual(numSamples, 2u);
+      REQUIRE(
+         first.GetFloats(expected.channelPointers.data(), numSamples) ==
+         second.GetFloats(actual.channelPointers.data(), numSamples));
+      REQUIRE(actual.channelVectors == expected.channelVectors);
+      REQUIRE(!first.TakeCheckpoint());
+   }
+
+   SECTION("has no checkpoint if not stretched")
+   {
+      const auto clip = std::make_shared<FloatVectorClip>(
+         sampleRate, FloatVectorVector { { 1.f, 2.f, 3.f } });
+      ClipSegment sut { *clip, 0., direction };
+      REQUIRE(!sut.TakeCheckpoint());
+   }
 }
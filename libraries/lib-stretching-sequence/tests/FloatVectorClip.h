@@ -51,7 +51,7 @@ public:
 
    int GetCentShift() const override
    {
-      return 0;
+      return centShift;
    }
 
    Observer::Subscription
@@ -62,7 +62,7 @@ public:
 
    PitchAndSpeedPreset GetPitchAndSpeedPreset() const override
    {
-      return PitchAndSpeedPreset::Default;
+      return preset;
    }
 
    Observer::Subscription SubscribeToPitchAndSpeedPresetChange(
@@ -71,9 +71,17 @@ public:
       return {};
    }
 
+   size_t GetContentVersion() const override
+   {
+      return contentVersion;
+   }
+
 public:
    double stretchRatio = 1.;
+   int centShift = 0;
+   PitchAndSpeedPreset preset = PitchAndSpeedPreset::Default;
    double playStartTime = 0.;
+   size_t contentVersion = 0;
 
 private:
    double GetPlayDuration() const;
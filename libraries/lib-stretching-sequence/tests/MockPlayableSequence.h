@@ -72,6 +72,17 @@ public:
    {
    }
 
+   bool GetEnvelopeSegments(
+      EnvelopeSegments& segments, size_t bufferLen, double t0,
+      bool backwards, size_t maxSize) const override
+   {
+      segments.clear();
+      if (maxSize == 0)
+         return false;
+      AppendConstantEnvelopeSegment(segments, bufferLen, 1.0);
+      return true;
+   }
+
    // AudioGraph::Channel
    AudioGraph::ChannelType GetChannelType() const override
    {
@@ -0,0 +1,181 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCacheTest.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioSegment.h"
+#include "ClipSegment.h"
+#include "FloatVectorClip.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+
+std::shared_ptr<FloatVectorClip> MakeClip()
+{
+   // More than one block of output
+   std::vector<float> audio(sampleRate * 2);
+   for (size_t i = 0; i < audio.size(); ++i)
+      audio[i] = std::sin(i * 0.05f) * 0.5f;
+   auto clip = std::make_shared<FloatVectorClip>(sampleRate, audio, 2u);
+   clip->stretchRatio = 1.5;
+   clip->contentVersion = 1;
+   return clip;
+}
+
+std::vector<std::vector<float>> Play(AudioSegment& segment)
+{
+   std::vector<std::vector<float>> result(segment.NChannels());
+   std::vector<std::vector<float>> buffers(
+      segment.NChannels(), std::vector<float>(1000));
+   std::vector<float*> pointers;
+   for (auto& buffer : buffers)
+      pointers.push_back(buffer.data());
+   while (!segment.Empty())
+   {
+      const auto produced = segment.GetFloats(pointers.data(), 1000);
+      for (size_t i = 0; i < buffers.size(); ++i)
+         result[i].insert(
+            result[i].end(), buffers[i].begin(),
+            buffers[i].begin() + produced);
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("StretchedClipCache")
+{
+   const auto clip = MakeClip();
+   const auto key = StretchedClipCache::GetKey(*clip);
+   REQUIRE(key.has_value());
+
+   SECTION("Render gives what live stretching does")
+   {
+      const auto rendering = StretchedClipCache::Render(*clip);
+      REQUIRE(rendering);
+      ClipSegment live { *clip, 0., PlaybackDirection::forward };
+      const auto expected = Play(live);
+      REQUIRE(rendering->length == sampleCount { expected[0].size() });
+      REQUIRE(
+         rendering->channels[0].size() ==
+         (expected[0].size() + StretchedClipCache::Rendering::BlockSize - 1) /
+            StretchedClipCache::Rendering::BlockSize);
+      for (size_t i = 0; i < expected.size(); ++i)
+      {
+         std::vector<float> actual;
+         for (const auto& block : rendering->channels[i])
+            actual.insert(actual.end(), block->begin(), block->end());
+         REQUIRE(actual == expected[i]);
+      }
+   }
+
+   SECTION("Render can be cancelled")
+   {
+      REQUIRE(!StretchedClipCache::Render(*clip, [] { return true; }));
+   }
+
+   SECTION("Unversioned clips have no key")
+   {
+      clip->contentVersion = 0;
+      REQUIRE(!StretchedClipCache::GetKey(*clip).has_value());
+   }
+
+   SECTION("Sessions serve renderings of the same key only")
+   {
+      StretchedClipCache cache;
+      StretchedClipCache::Session session { cache };
+      REQUIRE(!session.CreateSegment(*clip, 0.));
+
+      cache.Add(*key, StretchedClipCache::Render(*clip));
+      REQUIRE(cache.Find(*key));
+      const auto durationToDiscard = GENERATE(0., 0.25, 2.9);
+      const auto segment = session.CreateSegment(*clip, durationToDiscard);
+      REQUIRE(segment);
+      // As many samples as stretching live from the same time
+      ClipSegment live { *clip, durationToDiscard, PlaybackDirection::forward };
+      REQUIRE(Play(*segment)[1].size() == Play(live)[1].size());
+
+      clip->contentVersion = 2;
+      REQUIRE(!session.CreateSegment(*clip, 0.));
+      clip->contentVersion = 1;
+      clip->stretchRatio = 1.25;
+      REQUIRE(!session.CreateSegment(*clip, 0.));
+   }
+
+   SECTION("Live segments resume from checkpoints")
+   {
+      StretchedClipCache cache;
+      StretchedClipCache::Session session { cache };
+      const auto direction =
+         GENERATE(PlaybackDirection::forward, PlaybackDirection::backward);
+      const auto durationToDiscard = GENERATE(0., 0.5);
+      ClipSegment live { *clip, durationToDiscard, direction };
+      const auto expected = Play(live);
+      // Live segments don't take checkpoints themselves
+      REQUIRE(Play(*session.CreateLiveSegment(
+                 *clip, durationToDiscard, direction)) == expected);
+      REQUIRE(!cache.HasCheckpoint(*clip, durationToDiscard, direction));
+
+      session.RequestCheckpoint(*clip, durationToDiscard, direction);
+      const auto deadline =
+         std::chrono::steady_clock::now() + std::chrono::seconds(30);
+      while (!cache.HasCheckpoint(*clip, durationToDiscard, direction) &&
+             std::chrono::steady_clock::now() < deadline)
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      REQUIRE(cache.HasCheckpoint(*clip, durationToDiscard, direction));
+      // Also for a start that differs by less than a sample
+      REQUIRE(cache.HasCheckpoint(
+         *clip, durationToDiscard + 0.1 / sampleRate, direction));
+      REQUIRE(Play(*session.CreateLiveSegment(
+                 *clip, durationToDiscard, direction)) == expected);
+   }
+
+   SECTION("Renderings over budget are dropped")
+   {
+      StretchedClipCache cache;
+      const auto rendering = StretchedClipCache::Render(*clip);
+      cache.SetMemoryBudget(rendering->GetSpaceUsage());
+      cache.Add(*key, rendering);
+      REQUIRE(cache.Find(*key));
+
+      auto otherKey = *key;
+      otherKey.contentVersion = 2;
+      cache.Add(otherKey, rendering);
+      REQUIRE(cache.Find(otherKey));
+      REQUIRE(!cache.Find(*key));
+
+      cache.SetMemoryBudget(0);
+      REQUIRE(!cache.Find(otherKey));
+   }
+
+   SECTION("Playback has a cache only if rendering is on")
+   {
+      StretchedClipRendering.Write(false);
+      REQUIRE(!StretchedClipCache::GetForPlayback());
+      StretchedClipRendering.Write(true);
+      REQUIRE(StretchedClipCache::GetForPlayback());
+      StretchedClipRendering.Reset();
+   }
+
+   SECTION("Sessions render in the background")
+   {
+      StretchedClipCache cache;
+      StretchedClipCache::Session session { cache };
+      session.Request(*clip);
+      const auto deadline =
+         std::chrono::steady_clock::now() + std::chrono::seconds(30);
+      while (!cache.Find(*key) && std::chrono::steady_clock::now() < deadline)
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      REQUIRE(session.CreateSegment(*clip, 0.));
+   }
+}
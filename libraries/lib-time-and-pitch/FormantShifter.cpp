@@ -65,6 +65,11 @@ void FormantShifter::Reset()
    mFft.reset();
 }
 
+size_t FormantShifter::GetFftSize() const
+{
+   return mFft ? mFft->getSize() : 0;
+}
+
 void FormantShifter::Process(
    const float* powSpec, std::complex<float>* spec, double factor)
 {
@@ -36,6 +36,10 @@ public:
    void Reset(size_t fftSize);
    void Reset();
 
+   //! @return 0 if `Reset(fftSize)` wasn't called or `Reset()` was called
+   //! since
+   size_t GetFftSize() const;
+
    /*!
     * \brief Processes `spectrum` in place, or does nothing if `Reset(fftSize)`
     * wasn't called or `Reset()` was called since.
@@ -61,6 +61,15 @@ public:
     _position0 = 0;
   }
 
+  /// copy contents and position of a buffer of the same size
+  void assign(const CircularSampleBuffer& other)
+  {
+    assert(_allocatedSize == other._allocatedSize);
+    if (_buffer && _allocatedSize > 0)
+      vo::copy(other._buffer, _buffer, _allocatedSize);
+    _position0 = other._position0;
+  }
+
   void write(int offset, const SampleT& sample)
   {
     _buffer[(_position0 + offset) & _bufferSizeMask] = sample;
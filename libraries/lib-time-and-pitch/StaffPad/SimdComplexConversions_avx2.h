@@ -0,0 +1,336 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * AVX2 version of SimdComplexConversions_sse2.h, eight lanes at a time.
+ * The same operations are done in the same order, so that results are the
+ * same, bit for bit, as long as the compiler does not fuse multiplications
+ * and additions (-ffp-contract=off).
+ *
+ * Functions are compiled for AVX2 whatever the compiler flags, so callers must
+ * check that the processor supports it.
+ */
+
+#pragma once
+
+#include "SimdComplexConversions_sse2.h"
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_COMPLEX_AVX2_TARGET
+#else
+#define SIMD_COMPLEX_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace simd_complex_conversions::avx2
+{
+//! Like std::pair, which would drop the vector type's attributes
+struct m256_pair
+{
+   __m256 first;
+   __m256 second;
+};
+
+SIMD_COMPLEX_AVX2_TARGET inline __m256 atan_ps(__m256 x)
+{
+   using namespace details;
+
+   __m256 sign_bit, y;
+
+   sign_bit = x;
+   /* take the absolute value */
+   x = _mm256_and_ps(x, _mm256_set1_ps(inv_sign_mask));
+   /* extract the sign bit (upper one) */
+   sign_bit = _mm256_and_ps(sign_bit, _mm256_set1_ps(sign_mask));
+
+   /* range reduction, init x and y depending on range */
+   /* x > 2.414213562373095 */
+   __m256 cmp0 =
+      _mm256_cmp_ps(x, _mm256_set1_ps(2.414213562373095f), _CMP_GT_OQ);
+   /* x > 0.4142135623730950 */
+   __m256 cmp1 =
+      _mm256_cmp_ps(x, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OQ);
+
+   /* x > 0.4142135623730950 && !( x > 2.414213562373095 ) */
+   __m256 cmp2 = _mm256_andnot_ps(cmp0, cmp1);
+
+   /* -( 1.0/x ) */
+   __m256 y0 = _mm256_and_ps(cmp0, _mm256_set1_ps(cephes_PIO2F));
+   __m256 x0 = _mm256_div_ps(_mm256_set1_ps(1.0f), x);
+   x0 = _mm256_xor_ps(x0, _mm256_set1_ps(sign_mask));
+
+   __m256 y1 = _mm256_and_ps(cmp2, _mm256_set1_ps(cephes_PIO4F));
+   /* (x-1.0)/(x+1.0) */
+   __m256 x1_o = _mm256_sub_ps(x, _mm256_set1_ps(1.0f));
+   __m256 x1_u = _mm256_add_ps(x, _mm256_set1_ps(1.0f));
+   __m256 x1 = _mm256_div_ps(x1_o, x1_u);
+
+   __m256 x2 = _mm256_and_ps(cmp2, x1);
+   x0 = _mm256_and_ps(cmp0, x0);
+   x2 = _mm256_or_ps(x2, x0);
+   cmp1 = _mm256_or_ps(cmp0, cmp2);
+   x2 = _mm256_and_ps(cmp1, x2);
+   x = _mm256_andnot_ps(cmp1, x);
+   x = _mm256_or_ps(x2, x);
+
+   y = _mm256_or_ps(y0, y1);
+
+   __m256 zz = _mm256_mul_ps(x, x);
+   __m256 acc = _mm256_set1_ps(atancof_p0);
+   acc = _mm256_mul_ps(acc, zz);
+   acc = _mm256_sub_ps(acc, _mm256_set1_ps(atancof_p1));
+   acc = _mm256_mul_ps(acc, zz);
+   acc = _mm256_add_ps(acc, _mm256_set1_ps(atancof_p2));
+   acc = _mm256_mul_ps(acc, zz);
+   acc = _mm256_sub_ps(acc, _mm256_set1_ps(atancof_p3));
+   acc = _mm256_mul_ps(acc, zz);
+   acc = _mm256_mul_ps(acc, x);
+   acc = _mm256_add_ps(acc, x);
+   y = _mm256_add_ps(y, acc);
+
+   /* update the sign */
+   y = _mm256_xor_ps(y, sign_bit);
+
+   return y;
+}
+
+SIMD_COMPLEX_AVX2_TARGET inline __m256 atan2_ps(__m256 y, __m256 x)
+{
+   using namespace details;
+
+   __m256 zero = _mm256_setzero_ps();
+   __m256 x_eq_0 = _mm256_cmp_ps(x, zero, _CMP_EQ_OQ);
+   __m256 x_gt_0 = _mm256_cmp_ps(x, zero, _CMP_GT_OQ);
+   __m256 y_eq_0 = _mm256_cmp_ps(y, zero, _CMP_EQ_OQ);
+   __m256 x_lt_0 = _mm256_cmp_ps(x, zero, _CMP_LT_OQ);
+   __m256 y_lt_0 = _mm256_cmp_ps(y, zero, _CMP_LT_OQ);
+
+   __m256 zero_mask = _mm256_and_ps(x_eq_0, y_eq_0);
+   __m256 zero_mask_other_case = _mm256_and_ps(y_eq_0, x_gt_0);
+   zero_mask = _mm256_or_ps(zero_mask, zero_mask_other_case);
+
+   __m256 pio2_mask = _mm256_andnot_ps(y_eq_0, x_eq_0);
+   __m256 pio2_mask_sign = _mm256_and_ps(y_lt_0, _mm256_set1_ps(sign_mask));
+   __m256 pio2_result = _mm256_set1_ps(cephes_PIO2F);
+   pio2_result = _mm256_xor_ps(pio2_result, pio2_mask_sign);
+   pio2_result = _mm256_and_ps(pio2_mask, pio2_result);
+
+   __m256 pi_mask = _mm256_and_ps(y_eq_0, x_lt_0);
+   __m256 pi = _mm256_set1_ps(cephes_PIF);
+   __m256 pi_result = _mm256_and_ps(pi_mask, pi);
+
+   __m256 swap_sign_mask_offset = _mm256_and_ps(x_lt_0, y_lt_0);
+   swap_sign_mask_offset =
+      _mm256_and_ps(swap_sign_mask_offset, _mm256_set1_ps(sign_mask));
+
+   __m256 offset1 = _mm256_set1_ps(cephes_PIF);
+   offset1 = _mm256_xor_ps(offset1, swap_sign_mask_offset);
+
+   __m256 offset = _mm256_and_ps(x_lt_0, offset1);
+
+   __m256 arg = _mm256_div_ps(y, x);
+   __m256 atan_result = atan_ps(arg);
+   atan_result = _mm256_add_ps(atan_result, offset);
+
+   /* select between zero_result, pio2_result and atan_result */
+
+   __m256 result = _mm256_andnot_ps(zero_mask, pio2_result);
+   atan_result = _mm256_andnot_ps(zero_mask, atan_result);
+   atan_result = _mm256_andnot_ps(pio2_mask, atan_result);
+   result = _mm256_or_ps(result, atan_result);
+   result = _mm256_or_ps(result, pi_result);
+
+   return result;
+}
+
+SIMD_COMPLEX_AVX2_TARGET inline m256_pair sincos_ps(__m256 x)
+{
+   using namespace details;
+   __m256 xmm1, xmm2, xmm3 = _mm256_setzero_ps(), sign_bit_sin, y;
+   __m256i emm0, emm2, emm4;
+
+   sign_bit_sin = x;
+   /* take the absolute value */
+   x = _mm256_and_ps(x, _mm256_set1_ps(inv_sign_mask));
+   /* extract the sign bit (upper one) */
+   sign_bit_sin = _mm256_and_ps(sign_bit_sin, _mm256_set1_ps(sign_mask));
+
+   /* scale by 4/Pi */
+   y = _mm256_mul_ps(x, _mm256_set1_ps(cephes_FOPI));
+
+   /* store the integer part of y in emm2 */
+   emm2 = _mm256_cvttps_epi32(y);
+
+   /* j=(j+1) & (~1) (see the cephes sources) */
+   emm2 = _mm256_add_epi32(emm2, _mm256_set1_epi32(1));
+   emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(~1));
+   y = _mm256_cvtepi32_ps(emm2);
+
+   emm4 = emm2;
+
+   /* get the swap sign flag for the sine */
+   emm0 = _mm256_and_si256(emm2, _mm256_set1_epi32(4));
+   emm0 = _mm256_slli_epi32(emm0, 29);
+   __m256 swap_sign_bit_sin = _mm256_castsi256_ps(emm0);
+
+   /* get the polynom selection mask for the sine*/
+   emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(2));
+   emm2 = _mm256_cmpeq_epi32(emm2, _mm256_setzero_si256());
+   __m256 poly_mask = _mm256_castsi256_ps(emm2);
+
+   /* The magic pass: "Extended precision modular arithmetic"
+      x = ((x - y * DP1) - y * DP2) - y * DP3; */
+   xmm1 = _mm256_set1_ps(minus_cephes_DP1);
+   xmm2 = _mm256_set1_ps(minus_cephes_DP2);
+   xmm3 = _mm256_set1_ps(minus_cephes_DP3);
+   xmm1 = _mm256_mul_ps(y, xmm1);
+   xmm2 = _mm256_mul_ps(y, xmm2);
+   xmm3 = _mm256_mul_ps(y, xmm3);
+   x = _mm256_add_ps(x, xmm1);
+   x = _mm256_add_ps(x, xmm2);
+   x = _mm256_add_ps(x, xmm3);
+
+   emm4 = _mm256_sub_epi32(emm4, _mm256_set1_epi32(2));
+   emm4 = _mm256_andnot_si256(emm4, _mm256_set1_epi32(4));
+   emm4 = _mm256_slli_epi32(emm4, 29);
+   __m256 sign_bit_cos = _mm256_castsi256_ps(emm4);
+
+   sign_bit_sin = _mm256_xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+   /* Evaluate the first polynom  (0 <= x <= Pi/4) */
+   __m256 z = _mm256_mul_ps(x, x);
+   y = _mm256_set1_ps(coscof_p0);
+
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_add_ps(y, _mm256_set1_ps(coscof_p1));
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_add_ps(y, _mm256_set1_ps(coscof_p2));
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_mul_ps(y, z);
+   __m256 tmp = _mm256_mul_ps(z, _mm256_set1_ps(0.5f));
+   y = _mm256_sub_ps(y, tmp);
+   y = _mm256_add_ps(y, _mm256_set1_ps(1));
+
+   /* Evaluate the second polynom  (Pi/4 <= x <= 0) */
+
+   __m256 y2 = _mm256_set1_ps(sincof_p0);
+   y2 = _mm256_mul_ps(y2, z);
+   y2 = _mm256_add_ps(y2, _mm256_set1_ps(sincof_p1));
+   y2 = _mm256_mul_ps(y2, z);
+   y2 = _mm256_add_ps(y2, _mm256_set1_ps(sincof_p2));
+   y2 = _mm256_mul_ps(y2, z);
+   y2 = _mm256_mul_ps(y2, x);
+   y2 = _mm256_add_ps(y2, x);
+
+   /* select the correct result from the two polynoms */
+   xmm3 = poly_mask;
+   __m256 ysin2 = _mm256_and_ps(xmm3, y2);
+   __m256 ysin1 = _mm256_andnot_ps(xmm3, y);
+   y2 = _mm256_sub_ps(y2, ysin2);
+   y = _mm256_sub_ps(y, ysin1);
+
+   xmm1 = _mm256_add_ps(ysin1, ysin2);
+   xmm2 = _mm256_add_ps(y, y2);
+
+   /* update the sign */
+   return { _mm256_xor_ps(xmm1, sign_bit_sin),
+            _mm256_xor_ps(xmm2, sign_bit_cos) };
+}
+
+SIMD_COMPLEX_AVX2_TARGET inline __m256 norm(__m256 x, __m256 y)
+{
+   return _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+}
+
+/// Order of lanes after deinterleaving with in-lane shuffles: 0 1 4 5 2 3 6 7.
+/// The same permutation undoes it.
+SIMD_COMPLEX_AVX2_TARGET inline __m256 permute_lanes(__m256 x)
+{
+   return _mm256_castpd_ps(
+      _mm256_permute4x64_pd(_mm256_castps_pd(x), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+/// Deinterleaves eight complex numbers, in the order of permute_lanes
+SIMD_COMPLEX_AVX2_TARGET inline m256_pair
+load_complex(const std::complex<float>* input)
+{
+   // Safe according to C++ standard
+   auto p1 = _mm256_loadu_ps(reinterpret_cast<const float*>(input));
+   auto p2 = _mm256_loadu_ps(reinterpret_cast<const float*>(input + 4));
+
+   // p1 = {real(c1), imag(c1), ..., real(c4), imag(c4)}
+   // p2 = {real(c5), imag(c5), ..., real(c8), imag(c8)}
+   // rp and ip hold the parts of c1 c2 c5 c6 c3 c4 c7 c8
+
+   auto rp = _mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 0, 2, 0));
+   auto ip = _mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(3, 1, 3, 1));
+   return { rp, ip };
+}
+
+SIMD_COMPLEX_AVX2_TARGET inline void
+calc_phases(const std::complex<float>* input, float* output, int n)
+{
+   for (int i = 0; i <= n - 8; i += 8)
+   {
+      auto [rp, ip] = load_complex(input + i);
+      _mm256_storeu_ps(output + i, permute_lanes(atan2_ps(ip, rp)));
+   }
+   // deal with last partial packet
+   const auto i = n & (~7);
+   simd_complex_conversions::perform_parallel_simd_aligned(
+      input + i, output + i, n - i,
+      [](const __m128 rp, const __m128 ip, __m128& out)
+      { out = simd_complex_conversions::atan2_ps(ip, rp); });
+}
+
+SIMD_COMPLEX_AVX2_TARGET inline void
+calc_norms(const std::complex<float>* input, float* output, int n)
+{
+   for (int i = 0; i <= n - 8; i += 8)
+   {
+      auto [rp, ip] = load_complex(input + i);
+      _mm256_storeu_ps(output + i, permute_lanes(norm(rp, ip)));
+   }
+   // deal with last partial packet
+   const auto i = n & (~7);
+   simd_complex_conversions::perform_parallel_simd_aligned(
+      input + i, output + i, n - i,
+      [](const __m128 rp, const __m128 ip, __m128& out)
+      { out = simd_complex_conversions::norm(rp, ip); });
+}
+
+SIMD_COMPLEX_AVX2_TARGET inline void rotate(
+   const float* oldPhase, const float* newPhase, std::complex<float>* output,
+   int n)
+{
+   for (int i = 0; i <= n - 8; i += 8)
+   {
+      // In the order of the deinterleaved parts below
+      auto [sin, cos] = sincos_ps(permute_lanes(
+         oldPhase ? _mm256_sub_ps(
+                       _mm256_loadu_ps(newPhase + i),
+                       _mm256_loadu_ps(oldPhase + i)) :
+                    _mm256_loadu_ps(newPhase + i)));
+
+      auto [rp, ip] = load_complex(output + i);
+
+      // We need to calculate (rp, ip) * (cos, sin) -> (rp*cos - ip*sin, rp*sin + ip*cos)
+
+      auto out_rp =
+         _mm256_sub_ps(_mm256_mul_ps(rp, cos), _mm256_mul_ps(ip, sin));
+      auto out_ip =
+         _mm256_add_ps(_mm256_mul_ps(rp, sin), _mm256_mul_ps(ip, cos));
+
+      // Interleaving in each half undoes the shuffles
+      auto p1 = _mm256_unpacklo_ps(out_rp, out_ip);
+      auto p2 = _mm256_unpackhi_ps(out_rp, out_ip);
+
+      _mm256_storeu_ps(reinterpret_cast<float*>(output + i), p1);
+      _mm256_storeu_ps(reinterpret_cast<float*>(output + i + 4), p2);
+   }
+   // deal with last partial packet
+   const auto i = n & (~7);
+   simd_complex_conversions::rotate_parallel_simd_aligned(
+      oldPhase ? oldPhase + i : nullptr, newPhase + i, output + i, n - i);
+}
+
+} // namespace simd_complex_conversions::avx2
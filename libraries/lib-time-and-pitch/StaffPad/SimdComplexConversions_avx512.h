@@ -0,0 +1,365 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * AVX-512 version of SimdComplexConversions_sse2.h, sixteen lanes at a time.
+ * Comparisons give masks, which are widened to vectors, so that the same
+ * operations are done in the same order, and results are the same, bit for
+ * bit.  AVX512F implies FMA, so the compiler must not fuse multiplications and
+ * additions (-ffp-contract=off).
+ *
+ * Only AVX512F is required.  Functions are compiled for it whatever the
+ * compiler flags, so callers must check that the processor supports it.
+ */
+
+#pragma once
+
+#include "SimdComplexConversions_avx2.h"
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_COMPLEX_AVX512_TARGET
+#else
+#define SIMD_COMPLEX_AVX512_TARGET __attribute__((target("avx512f")))
+#endif
+
+namespace simd_complex_conversions::avx512
+{
+//! Like std::pair, which would drop the vector type's attributes
+struct m512_pair
+{
+   __m512 first;
+   __m512 second;
+};
+
+namespace ops
+{
+// Bitwise operations on floats are not in AVX512F
+SIMD_COMPLEX_AVX512_TARGET inline __m512 and_ps(__m512 a, __m512 b)
+{
+   return _mm512_castsi512_ps(
+      _mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline __m512 andnot_ps(__m512 a, __m512 b)
+{
+   return _mm512_castsi512_ps(
+      _mm512_andnot_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline __m512 or_ps(__m512 a, __m512 b)
+{
+   return _mm512_castsi512_ps(
+      _mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline __m512 xor_ps(__m512 a, __m512 b)
+{
+   return _mm512_castsi512_ps(
+      _mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+/// all bits set in the lanes of the mask, as SSE comparisons give
+SIMD_COMPLEX_AVX512_TARGET inline __m512 widen(__mmask16 mask)
+{
+   return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(mask, -1));
+}
+
+template <int predicate>
+SIMD_COMPLEX_AVX512_TARGET inline __m512 cmp_ps(__m512 a, __m512 b)
+{
+   return widen(_mm512_cmp_ps_mask(a, b, predicate));
+}
+} // namespace ops
+
+SIMD_COMPLEX_AVX512_TARGET inline __m512 atan_ps(__m512 x)
+{
+   using namespace simd_complex_conversions::details;
+   using namespace ops;
+
+   __m512 sign_bit, y;
+
+   sign_bit = x;
+   /* take the absolute value */
+   x = and_ps(x, _mm512_set1_ps(inv_sign_mask));
+   /* extract the sign bit (upper one) */
+   sign_bit = and_ps(sign_bit, _mm512_set1_ps(sign_mask));
+
+   /* range reduction, init x and y depending on range */
+   /* x > 2.414213562373095 */
+   __m512 cmp0 = cmp_ps<_CMP_GT_OQ>(x, _mm512_set1_ps(2.414213562373095f));
+   /* x > 0.4142135623730950 */
+   __m512 cmp1 = cmp_ps<_CMP_GT_OQ>(x, _mm512_set1_ps(0.4142135623730950f));
+
+   /* x > 0.4142135623730950 && !( x > 2.414213562373095 ) */
+   __m512 cmp2 = andnot_ps(cmp0, cmp1);
+
+   /* -( 1.0/x ) */
+   __m512 y0 = and_ps(cmp0, _mm512_set1_ps(cephes_PIO2F));
+   __m512 x0 = _mm512_div_ps(_mm512_set1_ps(1.0f), x);
+   x0 = xor_ps(x0, _mm512_set1_ps(sign_mask));
+
+   __m512 y1 = and_ps(cmp2, _mm512_set1_ps(cephes_PIO4F));
+   /* (x-1.0)/(x+1.0) */
+   __m512 x1_o = _mm512_sub_ps(x, _mm512_set1_ps(1.0f));
+   __m512 x1_u = _mm512_add_ps(x, _mm512_set1_ps(1.0f));
+   __m512 x1 = _mm512_div_ps(x1_o, x1_u);
+
+   __m512 x2 = and_ps(cmp2, x1);
+   x0 = and_ps(cmp0, x0);
+   x2 = or_ps(x2, x0);
+   cmp1 = or_ps(cmp0, cmp2);
+   x2 = and_ps(cmp1, x2);
+   x = andnot_ps(cmp1, x);
+   x = or_ps(x2, x);
+
+   y = or_ps(y0, y1);
+
+   __m512 zz = _mm512_mul_ps(x, x);
+   __m512 acc = _mm512_set1_ps(atancof_p0);
+   acc = _mm512_mul_ps(acc, zz);
+   acc = _mm512_sub_ps(acc, _mm512_set1_ps(atancof_p1));
+   acc = _mm512_mul_ps(acc, zz);
+   acc = _mm512_add_ps(acc, _mm512_set1_ps(atancof_p2));
+   acc = _mm512_mul_ps(acc, zz);
+   acc = _mm512_sub_ps(acc, _mm512_set1_ps(atancof_p3));
+   acc = _mm512_mul_ps(acc, zz);
+   acc = _mm512_mul_ps(acc, x);
+   acc = _mm512_add_ps(acc, x);
+   y = _mm512_add_ps(y, acc);
+
+   /* update the sign */
+   y = xor_ps(y, sign_bit);
+
+   return y;
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline __m512 atan2_ps(__m512 y, __m512 x)
+{
+   using namespace simd_complex_conversions::details;
+   using namespace ops;
+
+   __m512 zero = _mm512_setzero_ps();
+   __m512 x_eq_0 = cmp_ps<_CMP_EQ_OQ>(x, zero);
+   __m512 x_gt_0 = cmp_ps<_CMP_GT_OQ>(x, zero);
+   __m512 y_eq_0 = cmp_ps<_CMP_EQ_OQ>(y, zero);
+   __m512 x_lt_0 = cmp_ps<_CMP_LT_OQ>(x, zero);
+   __m512 y_lt_0 = cmp_ps<_CMP_LT_OQ>(y, zero);
+
+   __m512 zero_mask = and_ps(x_eq_0, y_eq_0);
+   __m512 zero_mask_other_case = and_ps(y_eq_0, x_gt_0);
+   zero_mask = or_ps(zero_mask, zero_mask_other_case);
+
+   __m512 pio2_mask = andnot_ps(y_eq_0, x_eq_0);
+   __m512 pio2_mask_sign = and_ps(y_lt_0, _mm512_set1_ps(sign_mask));
+   __m512 pio2_result = _mm512_set1_ps(cephes_PIO2F);
+   pio2_result = xor_ps(pio2_result, pio2_mask_sign);
+   pio2_result = and_ps(pio2_mask, pio2_result);
+
+   __m512 pi_mask = and_ps(y_eq_0, x_lt_0);
+   __m512 pi = _mm512_set1_ps(cephes_PIF);
+   __m512 pi_result = and_ps(pi_mask, pi);
+
+   __m512 swap_sign_mask_offset = and_ps(x_lt_0, y_lt_0);
+   swap_sign_mask_offset =
+      and_ps(swap_sign_mask_offset, _mm512_set1_ps(sign_mask));
+
+   __m512 offset1 = _mm512_set1_ps(cephes_PIF);
+   offset1 = xor_ps(offset1, swap_sign_mask_offset);
+
+   __m512 offset = and_ps(x_lt_0, offset1);
+
+   __m512 arg = _mm512_div_ps(y, x);
+   __m512 atan_result = atan_ps(arg);
+   atan_result = _mm512_add_ps(atan_result, offset);
+
+   /* select between zero_result, pio2_result and atan_result */
+
+   __m512 result = andnot_ps(zero_mask, pio2_result);
+   atan_result = andnot_ps(zero_mask, atan_result);
+   atan_result = andnot_ps(pio2_mask, atan_result);
+   result = or_ps(result, atan_result);
+   result = or_ps(result, pi_result);
+
+   return result;
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline m512_pair
+sincos_ps(__m512 x)
+{
+   using namespace simd_complex_conversions::details;
+   using namespace ops;
+   __m512 xmm1, xmm2, xmm3 = _mm512_setzero_ps(), sign_bit_sin, y;
+   __m512i emm0, emm2, emm4;
+
+   sign_bit_sin = x;
+   /* take the absolute value */
+   x = and_ps(x, _mm512_set1_ps(inv_sign_mask));
+   /* extract the sign bit (upper one) */
+   sign_bit_sin = and_ps(sign_bit_sin, _mm512_set1_ps(sign_mask));
+
+   /* scale by 4/Pi */
+   y = _mm512_mul_ps(x, _mm512_set1_ps(cephes_FOPI));
+
+   /* store the integer part of y in emm2 */
+   emm2 = _mm512_cvttps_epi32(y);
+
+   /* j=(j+1) & (~1) (see the cephes sources) */
+   emm2 = _mm512_add_epi32(emm2, _mm512_set1_epi32(1));
+   emm2 = _mm512_and_si512(emm2, _mm512_set1_epi32(~1));
+   y = _mm512_cvtepi32_ps(emm2);
+
+   emm4 = emm2;
+
+   /* get the swap sign flag for the sine */
+   emm0 = _mm512_and_si512(emm2, _mm512_set1_epi32(4));
+   emm0 = _mm512_slli_epi32(emm0, 29);
+   __m512 swap_sign_bit_sin = _mm512_castsi512_ps(emm0);
+
+   /* get the polynom selection mask for the sine*/
+   emm2 = _mm512_and_si512(emm2, _mm512_set1_epi32(2));
+   __m512 poly_mask =
+      widen(_mm512_cmpeq_epi32_mask(emm2, _mm512_setzero_si512()));
+
+   /* The magic pass: "Extended precision modular arithmetic"
+      x = ((x - y * DP1) - y * DP2) - y * DP3; */
+   xmm1 = _mm512_set1_ps(minus_cephes_DP1);
+   xmm2 = _mm512_set1_ps(minus_cephes_DP2);
+   xmm3 = _mm512_set1_ps(minus_cephes_DP3);
+   xmm1 = _mm512_mul_ps(y, xmm1);
+   xmm2 = _mm512_mul_ps(y, xmm2);
+   xmm3 = _mm512_mul_ps(y, xmm3);
+   x = _mm512_add_ps(x, xmm1);
+   x = _mm512_add_ps(x, xmm2);
+   x = _mm512_add_ps(x, xmm3);
+
+   emm4 = _mm512_sub_epi32(emm4, _mm512_set1_epi32(2));
+   emm4 = _mm512_andnot_si512(emm4, _mm512_set1_epi32(4));
+   emm4 = _mm512_slli_epi32(emm4, 29);
+   __m512 sign_bit_cos = _mm512_castsi512_ps(emm4);
+
+   sign_bit_sin = xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+   /* Evaluate the first polynom  (0 <= x <= Pi/4) */
+   __m512 z = _mm512_mul_ps(x, x);
+   y = _mm512_set1_ps(coscof_p0);
+
+   y = _mm512_mul_ps(y, z);
+   y = _mm512_add_ps(y, _mm512_set1_ps(coscof_p1));
+   y = _mm512_mul_ps(y, z);
+   y = _mm512_add_ps(y, _mm512_set1_ps(coscof_p2));
+   y = _mm512_mul_ps(y, z);
+   y = _mm512_mul_ps(y, z);
+   __m512 tmp = _mm512_mul_ps(z, _mm512_set1_ps(0.5f));
+   y = _mm512_sub_ps(y, tmp);
+   y = _mm512_add_ps(y, _mm512_set1_ps(1));
+
+   /* Evaluate the second polynom  (Pi/4 <= x <= 0) */
+
+   __m512 y2 = _mm512_set1_ps(sincof_p0);
+   y2 = _mm512_mul_ps(y2, z);
+   y2 = _mm512_add_ps(y2, _mm512_set1_ps(sincof_p1));
+   y2 = _mm512_mul_ps(y2, z);
+   y2 = _mm512_add_ps(y2, _mm512_set1_ps(sincof_p2));
+   y2 = _mm512_mul_ps(y2, z);
+   y2 = _mm512_mul_ps(y2, x);
+   y2 = _mm512_add_ps(y2, x);
+
+   /* select the correct result from the two polynoms */
+   xmm3 = poly_mask;
+   __m512 ysin2 = and_ps(xmm3, y2);
+   __m512 ysin1 = andnot_ps(xmm3, y);
+   y2 = _mm512_sub_ps(y2, ysin2);
+   y = _mm512_sub_ps(y, ysin1);
+
+   xmm1 = _mm512_add_ps(ysin1, ysin2);
+   xmm2 = _mm512_add_ps(y, y2);
+
+   /* update the sign */
+   return { xor_ps(xmm1, sign_bit_sin), xor_ps(xmm2, sign_bit_cos) };
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline __m512 norm(__m512 x, __m512 y)
+{
+   return _mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y));
+}
+
+/// Deinterleaves sixteen complex numbers, in order
+SIMD_COMPLEX_AVX512_TARGET inline m512_pair
+load_complex(const std::complex<float>* input)
+{
+   // Safe according to C++ standard
+   auto p1 = _mm512_loadu_ps(reinterpret_cast<const float*>(input));
+   auto p2 = _mm512_loadu_ps(reinterpret_cast<const float*>(input + 8));
+
+   const auto real_index = _mm512_setr_epi32(
+      0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+   const auto imag_index = _mm512_setr_epi32(
+      1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+   return { _mm512_permutex2var_ps(p1, real_index, p2),
+            _mm512_permutex2var_ps(p1, imag_index, p2) };
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline void
+calc_phases(const std::complex<float>* input, float* output, int n)
+{
+   for (int i = 0; i <= n - 16; i += 16)
+   {
+      auto [rp, ip] = load_complex(input + i);
+      _mm512_storeu_ps(output + i, atan2_ps(ip, rp));
+   }
+   // deal with last partial packet
+   const auto i = n & (~15);
+   avx2::calc_phases(input + i, output + i, n - i);
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline void
+calc_norms(const std::complex<float>* input, float* output, int n)
+{
+   for (int i = 0; i <= n - 16; i += 16)
+   {
+      auto [rp, ip] = load_complex(input + i);
+      _mm512_storeu_ps(output + i, norm(rp, ip));
+   }
+   // deal with last partial packet
+   const auto i = n & (~15);
+   avx2::calc_norms(input + i, output + i, n - i);
+}
+
+SIMD_COMPLEX_AVX512_TARGET inline void rotate(
+   const float* oldPhase, const float* newPhase, std::complex<float>* output,
+   int n)
+{
+   const auto low_index = _mm512_setr_epi32(
+      0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+   const auto high_index = _mm512_setr_epi32(
+      8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+   for (int i = 0; i <= n - 16; i += 16)
+   {
+      auto [sin, cos] = sincos_ps(
+         oldPhase ? _mm512_sub_ps(
+                       _mm512_loadu_ps(newPhase + i),
+                       _mm512_loadu_ps(oldPhase + i)) :
+                    _mm512_loadu_ps(newPhase + i));
+
+      auto [rp, ip] = load_complex(output + i);
+
+      // We need to calculate (rp, ip) * (cos, sin) -> (rp*cos - ip*sin, rp*sin + ip*cos)
+
+      auto out_rp =
+         _mm512_sub_ps(_mm512_mul_ps(rp, cos), _mm512_mul_ps(ip, sin));
+      auto out_ip =
+         _mm512_add_ps(_mm512_mul_ps(rp, sin), _mm512_mul_ps(ip, cos));
+
+      auto p1 = _mm512_permutex2var_ps(out_rp, low_index, out_ip);
+      auto p2 = _mm512_permutex2var_ps(out_rp, high_index, out_ip);
+
+      _mm512_storeu_ps(reinterpret_cast<float*>(output + i), p1);
+      _mm512_storeu_ps(reinterpret_cast<float*>(output + i + 8), p2);
+   }
+   // deal with last partial packet
+   const auto i = n & (~15);
+   avx2::rotate(
+      oldPhase ? oldPhase + i : nullptr, newPhase + i, output + i, n - i);
+}
+
+} // namespace simd_complex_conversions::avx512
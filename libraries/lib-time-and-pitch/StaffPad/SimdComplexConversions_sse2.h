@@ -133,7 +133,6 @@ inline __m128 atan2_ps(__m128 y, __m128 x)
    __m128 zero = _mm_setzero_ps();
    __m128 x_eq_0 = _mm_cmpeq_ps(x, zero);
    __m128 x_gt_0 = _mm_cmpgt_ps(x, zero);
-   __m128 x_le_0 = _mm_cmple_ps(x, zero);
    __m128 y_eq_0 = _mm_cmpeq_ps(y, zero);
    __m128 x_lt_0 = _mm_cmplt_ps(x, zero);
    __m128 y_lt_0 = _mm_cmplt_ps(y, zero);
@@ -178,7 +177,14 @@ inline __m128 atan2_ps(__m128 y, __m128 x)
    return result;
 }
 
-inline std::pair<__m128, __m128> sincos_ps(__m128 x)
+//! A plain struct, because std::pair would drop the vector type's attributes
+struct m128_pair
+{
+   __m128 first;
+   __m128 second;
+};
+
+inline m128_pair sincos_ps(__m128 x)
 {
    using namespace details;
    __m128 xmm1, xmm2, xmm3 = _mm_setzero_ps(), sign_bit_sin, y;
@@ -268,8 +274,7 @@ inline std::pair<__m128, __m128> sincos_ps(__m128 x)
    xmm2 = _mm_add_ps(y, y2);
 
    /* update the sign */
-   return std::make_pair(
-      _mm_xor_ps(xmm1, sign_bit_sin), _mm_xor_ps(xmm2, sign_bit_cos));
+   return { _mm_xor_ps(xmm1, sign_bit_sin), _mm_xor_ps(xmm2, sign_bit_cos) };
 }
 
 inline float atan2_ss(float y, float x)
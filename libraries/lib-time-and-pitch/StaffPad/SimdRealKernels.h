@@ -0,0 +1,55 @@
+/*
+Kernels for real vectors, as wide as SimdTypes.h makes float_xn.
+
+Included by VectorOps.cpp, and by VectorOps_avx.cpp, which is compiled for AVX.
+The functions have internal linkage, so that each file keeps its own width.
+*/
+
+#pragma once
+
+#include "SimdTypes.h"
+
+#include <cassert>
+#include <cstdint>
+
+namespace staffpad {
+namespace vo {
+namespace {
+
+void unwrapPhasesSimd(float* v, int32_t n)
+{
+  audio::simd::perform_parallel_simd_aligned(v, n, [](auto& a) { a = a - rint(a * 0.15915494309f) * 6.283185307f; });
+}
+
+void fftShiftSimd(float* v, int32_t n)
+{
+  assert((n & 1) == 0);
+  int n2 = n >> 1;
+  audio::simd::perform_parallel_simd_aligned(v, v + n2, n2, [](auto& a, auto& b) {
+    auto tmp = a;
+    a = b;
+    b = tmp;
+  });
+}
+
+void lrToMsSimd(float* ch1, float* ch2, int32_t n)
+{
+  audio::simd::perform_parallel_simd_aligned(ch1, ch2, n, [](auto& a, auto& b) {
+    auto l = a, r = b;
+    a = 0.5f * (l + r);
+    b = 0.5f * (l - r);
+  });
+}
+
+void msToLrSimd(float* ch1, float* ch2, int32_t n)
+{
+  audio::simd::perform_parallel_simd_aligned(ch1, ch2, n, [](auto& a, auto& b) {
+    auto m = a, s = b;
+    a = m + s;
+    b = m - s;
+  });
+}
+
+} // namespace
+} // namespace vo
+} // namespace staffpad
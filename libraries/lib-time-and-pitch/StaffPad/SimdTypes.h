@@ -15,7 +15,9 @@
 #define __vecc
 #endif
 
-#if defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#if defined(__AVX__)
+#include "SimdTypes_avx.h"
+#elif defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
 #include "SimdTypes_sse2.h"
 #elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
 #include "SimdTypes_neon.h"
@@ -25,6 +27,30 @@
 
 namespace staffpad::audio::simd {
 
+/// loads a float vector of type V from aligned memory
+template <typename V>
+V load_aligned(const float *x);
+
+template <>
+__finl float_x4 __vecc load_aligned<float_x4>(const float *x)
+{
+  return float_x4_load_aligned(x);
+}
+
+/// the widest float vector that the file is compiled for, which
+/// perform_parallel_simd_aligned() uses
+#if defined(__AVX__)
+template <>
+__finl float_x8 __vecc load_aligned<float_x8>(const float *x)
+{
+  return float_x8_load_aligned(x);
+}
+
+using float_xn = float_x8;
+#else
+using float_xn = float_x4;
+#endif
+
 /// reserve aligned memory. Needs to be freed with aligned_free()
 inline void *aligned_malloc(size_t required_bytes, size_t alignment)
 {
@@ -87,16 +113,16 @@ template <typename fnc>
 __finl void perform_parallel_simd_aligned(float *a, float *b, int n, const fnc &f)
 {
   // fnc& f needs to be a lambda of type [](auto &a, auto &b){}.
-  // the autos will be float_x4/float
-  constexpr int N = 4;
+  // the autos will be float_xn/float
+  constexpr int N = sizeof(float_xn) / sizeof(float);
   constexpr int byte_size = sizeof(float);
 
   assert(is_aligned(a, N * byte_size) && is_aligned(b, N * byte_size));
 
   for (int i = 0; i <= n - N; i += N)
   {
-    auto x = float_x4_load_aligned(a + i);
-    auto y = float_x4_load_aligned(b + i);
+    auto x = load_aligned<float_xn>(a + i);
+    auto y = load_aligned<float_xn>(b + i);
     f(x, y);
     store_aligned(x, a + i);
     store_aligned(y, b + i);
@@ -111,13 +137,13 @@ template <typename fnc>
 __finl void perform_parallel_simd_aligned(float *a, int n, const fnc &f)
 {
   // fnc& f needs to be a lambda of type [](auto &a){}.
-  constexpr int N = 4;
+  constexpr int N = sizeof(float_xn) / sizeof(float);
   constexpr int byte_size = sizeof(float);
   assert(is_aligned(a, N * byte_size));
 
   for (int i = 0; i <= n - N; i += N)
   {
-    auto x = float_x4_load_aligned(a + i);
+    auto x = load_aligned<float_xn>(a + i);
     f(x);
     store_aligned(x, a + i);
   }
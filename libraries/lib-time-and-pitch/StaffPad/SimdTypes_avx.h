@@ -0,0 +1,78 @@
+/*
+AVX simd types, eight floats wide.
+
+Only for files compiled for AVX (-mavx, /arch:AVX), which SimdTypes.h detects.
+Such files must be called only when the processor supports AVX, and should not
+define inline functions that other files also use, lest the linker keep the AVX
+copy.
+*/
+
+#pragma once
+
+#include "SimdTypes_sse2.h"
+
+#include <immintrin.h>
+
+namespace staffpad::audio::simd {
+
+struct float_x8
+{
+  __m256 s;
+  __finl float_x8()
+  {
+  }
+
+  /// enables math like: float_x8 a = 0.5f * b;
+  __finl float_x8(float val)
+  {
+    s = _mm256_set1_ps(val);
+  }
+
+  __finl float_x8(const __m256 &val) : s(val)
+  {
+  }
+};
+
+__finl float_x8 __vecc float_x8_from_float(float x)
+{
+  return _mm256_set1_ps(x);
+}
+
+__finl float_x8 __vecc float_x8_load_aligned(const float *x)
+{
+  return _mm256_load_ps(x);
+}
+
+__finl void __vecc store_aligned(const float_x8 &a, float *x)
+{
+  _mm256_store_ps(x, a.s);
+}
+
+__finl float_x8 __vecc operator+(float_x8 a, float_x8 b)
+{
+  return _mm256_add_ps(a.s, b.s);
+}
+
+__finl float_x8 __vecc operator-(float_x8 a, float_x8 b)
+{
+  return _mm256_sub_ps(a.s, b.s);
+}
+
+__finl float_x8 __vecc operator*(float_x8 a, float_x8 b)
+{
+  return _mm256_mul_ps(a.s, b.s);
+}
+
+__finl float_x8 __vecc sqrt(const float_x8 &a)
+{
+  return _mm256_sqrt_ps(a.s);
+}
+
+/// rounds to nearest even, as the float_x4 version does
+__finl float_x8 __vecc rint(const float_x8 &a)
+{
+  __m256i A = _mm256_cvtps_epi32(a.s);
+  return _mm256_cvtepi32_ps(A);
+}
+
+} // namespace staffpad::audio::simd
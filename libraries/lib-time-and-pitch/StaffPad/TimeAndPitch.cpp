@@ -85,6 +85,32 @@ struct TimeAndPitch::impl
   double hop_s_err = 0.0;
 
   std::vector<int> peak_index, trough_index;
+
+  void copyStateFrom(const impl& other, int numChannels)
+  {
+    randomGenerator = other.randomGenerator;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+      inResampleInputBuffer[ch].assign(other.inResampleInputBuffer[ch]);
+      inCircularBuffer[ch].assign(other.inCircularBuffer[ch]);
+      outCircularBuffer[ch].assign(other.outCircularBuffer[ch]);
+    }
+    normalizationBuffer.assign(other.normalizationBuffer);
+
+    // Only those that outlive a hop, the others being scratch space
+    norm.assignSamples(other.norm);
+    last_norm.assignSamples(other.last_norm);
+    phase.assignSamples(other.phase);
+    last_phase.assignSamples(other.last_phase);
+    phase_accum.assignSamples(other.phase_accum);
+    random_phases.assignSamples(other.random_phases);
+
+    exact_hop_a = other.exact_hop_a;
+    hop_a_err = other.hop_a_err;
+    exact_hop_s = other.exact_hop_s;
+    next_exact_hop_s = other.next_exact_hop_s;
+    hop_s_err = other.hop_s_err;
+  }
 };
 
 TimeAndPitch::TimeAndPitch(
@@ -187,6 +213,22 @@ void TimeAndPitch::reset()
   _resampleReadPos = 0.0;
 }
 
+void TimeAndPitch::copyStateFrom(const TimeAndPitch& other)
+{
+  assert(fftSize == other.fftSize);
+  assert(_numChannels == other._numChannels);
+  assert(_maxBlockSize == other._maxBlockSize);
+  d->copyStateFrom(*other.d, _numChannels);
+  _resampleReadPos = other._resampleReadPos;
+  _availableOutputSamples = other._availableOutputSamples;
+  _overlap_a = other._overlap_a;
+  _analysis_hop_counter = other._analysis_hop_counter;
+  _expectedPhaseChangePerBinPerSample = other._expectedPhaseChangePerBinPerSample;
+  _timeStretch = other._timeStretch;
+  _pitchFactor = other._pitchFactor;
+  _outBufferWriteOffset = other._outBufferWriteOffset;
+}
+
 namespace {
 
 // wrap a phase value into -PI..PI
@@ -196,41 +238,6 @@ inline float _unwrapPhase(float arg)
   return arg - rint(arg * 0.15915494309f) * 6.283185307f;
 }
 
-void _unwrapPhaseVec(float* v, int n)
-{
-  audio::simd::perform_parallel_simd_aligned(v, n, [](auto& a) { a = a - rint(a * 0.15915494309f) * 6.283185307f; });
-}
-
-/// rotate even-sized array by half its size to align fft phase at the center
-void _fft_shift(float* v, int n)
-{
-  assert((n & 1) == 0);
-  int n2 = n >> 1;
-  audio::simd::perform_parallel_simd_aligned(v, v + n2, n2, [](auto& a, auto& b) {
-    auto tmp = a;
-    a = b;
-    b = tmp;
-  });
-}
-
-void _lr_to_ms(float* ch1, float* ch2, int n)
-{
-  audio::simd::perform_parallel_simd_aligned(ch1, ch2, n, [](auto& a, auto& b) {
-    auto l = a, r = b;
-    a = 0.5f * (l + r);
-    b = 0.5f * (l - r);
-  });
-}
-
-void _ms_to_lr(float* ch1, float* ch2, int n)
-{
-  audio::simd::perform_parallel_simd_aligned(ch1, ch2, n, [](auto& a, auto& b) {
-    auto m = a, s = b;
-    a = m + s;
-    b = m - s;
-  });
-}
-
 } // namespace
 
 // ----------------------------------------------------------------------------
@@ -373,12 +380,12 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
   if (d->exact_hop_a != d->exact_hop_s)
   {
     if (_numChannels == 2)
-      _lr_to_ms(d->fft_timeseries.getPtr(0), d->fft_timeseries.getPtr(1), fftSize);
+      vo::lrToMs(d->fft_timeseries.getPtr(0), d->fft_timeseries.getPtr(1), fftSize);
 
     for (int ch = 0; ch < _numChannels; ++ch)
     {
       vo::multiply(d->fft_timeseries.getPtr(ch), d->cosWindow.getPtr(0), d->fft_timeseries.getPtr(ch), fftSize);
-      _fft_shift(d->fft_timeseries.getPtr(ch), fftSize);
+      vo::fftShift(d->fft_timeseries.getPtr(ch), fftSize);
     }
 
     // determine norm/phase
@@ -402,7 +409,7 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
       _time_stretch<2>((float)hop_a, (float)hop_s);
 
     for (int ch = 0; ch < _numChannels; ++ch)
-      _unwrapPhaseVec(d->phase_accum.getPtr(ch), _numBins);
+      vo::unwrapPhases(d->phase_accum.getPtr(ch), _numBins);
 
     for (int ch = 0; ch < _numChannels; ++ch)
       vo::rotate(d->phase.getPtr(ch), d->phase_accum.getPtr(ch), d->spectrum.getPtr(ch),
@@ -414,11 +421,11 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
                            d->fft_timeseries.getNumSamples());
 
     if (_numChannels == 2)
-      _ms_to_lr(d->fft_timeseries.getPtr(0), d->fft_timeseries.getPtr(1), fftSize);
+      vo::msToLr(d->fft_timeseries.getPtr(0), d->fft_timeseries.getPtr(1), fftSize);
 
     for (int ch = 0; ch < _numChannels; ++ch)
     {
-      _fft_shift(d->fft_timeseries.getPtr(ch), fftSize);
+      vo::fftShift(d->fft_timeseries.getPtr(ch), fftSize);
       vo::multiply(d->fft_timeseries.getPtr(ch), d->cosWindow.getPtr(0), d->fft_timeseries.getPtr(ch), fftSize);
     }
   }
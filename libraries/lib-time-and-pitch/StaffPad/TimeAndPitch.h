@@ -10,7 +10,7 @@
 
 namespace staffpad {
 
-class TimeAndPitch
+class TIME_AND_PITCH_API TimeAndPitch
 {
 public:
   /**
@@ -83,6 +83,14 @@ public:
   */
   void reset();
 
+  /**
+    Copies the processing state of `other`, so that this continues exactly as
+    `other` would, without being fed the input that primed it. Both must have
+    the same FFT size and be set up alike. The timbre shifting callback and the
+    imaging reduction setting are not copied.
+  */
+  void copyStateFrom(const TimeAndPitch& other);
+
 private:
   const int fftSize;
   static constexpr int overlap = 4;
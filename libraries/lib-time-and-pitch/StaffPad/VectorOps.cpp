@@ -0,0 +1,241 @@
+#include "VectorOps.h"
+#include "SimdRealKernels.h"
+
+#include <atomic>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2_COMPLEX 1
+#include "SimdComplexConversions_avx512.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace staffpad {
+namespace vo {
+
+/// defined in VectorOps_avx.cpp; null if the build has no AVX kernels
+const RealKernels* getAVXRealKernels();
+
+namespace {
+
+void calcPhasesScalar(const std::complex<float>* src, float* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++)
+    dst[i] = std::arg(src[i]);
+}
+
+void calcNormsScalar(const std::complex<float>* src, float* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++)
+    dst[i] = std::norm(src[i]);
+}
+
+void rotateScalar(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++) {
+    const auto theta = oldPhase ? newPhase[i] - oldPhase[i] : newPhase[i];
+    dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
+  }
+}
+
+const ComplexKernels scalarKernels {
+  "Scalar",
+  calcPhasesScalar,
+  calcNormsScalar,
+  rotateScalar,
+};
+
+#if USE_SSE2_COMPLEX
+
+void calcPhasesSSE2(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::perform_parallel_simd_aligned(
+     src, dst, n,
+     [](const __m128 rp, const __m128 ip, __m128& out)
+     { out = simd_complex_conversions::atan2_ps(ip, rp); });
+}
+
+void calcNormsSSE2(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::perform_parallel_simd_aligned(
+     src, dst, n,
+     [](const __m128 rp, const __m128 ip, __m128& out)
+     { out = simd_complex_conversions::norm(rp, ip); });
+}
+
+void rotateSSE2(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  simd_complex_conversions::rotate_parallel_simd_aligned(
+     oldPhase, newPhase, dst, n);
+}
+
+const ComplexKernels sse2Kernels {
+  "SSE2",
+  calcPhasesSSE2,
+  calcNormsSSE2,
+  rotateSSE2,
+};
+
+// Whether the processor has the features, and the system saves the registers
+// that they use
+#if defined(_MSC_VER)
+bool hasFeatures(int leaf7Ebx, unsigned long long xcr0)
+{
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  constexpr int osxsave = 1 << 27, avx = 1 << 28;
+  if ((info[2] & (osxsave | avx)) != (osxsave | avx) ||
+      (_xgetbv(0) & xcr0) != xcr0)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & leaf7Ebx) == leaf7Ebx;
+}
+
+bool hasAVX()
+{
+  return hasFeatures(0, 0x6);
+}
+
+bool hasAVX2()
+{
+  return hasFeatures(1 << 5, 0x6);
+}
+
+bool hasAVX512()
+{
+  return hasFeatures(1 << 16, 0xe6);
+}
+#else
+bool hasAVX()
+{
+  return __builtin_cpu_supports("avx");
+}
+
+bool hasAVX2()
+{
+  return __builtin_cpu_supports("avx2");
+}
+
+bool hasAVX512()
+{
+  return __builtin_cpu_supports("avx512f");
+}
+#endif
+
+SIMD_COMPLEX_AVX2_TARGET void calcPhasesAVX2(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::avx2::calc_phases(src, dst, n);
+}
+
+SIMD_COMPLEX_AVX2_TARGET void calcNormsAVX2(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::avx2::calc_norms(src, dst, n);
+}
+
+SIMD_COMPLEX_AVX2_TARGET void rotateAVX2(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  simd_complex_conversions::avx2::rotate(oldPhase, newPhase, dst, n);
+}
+
+const ComplexKernels avx2Kernels {
+  "AVX2",
+  calcPhasesAVX2,
+  calcNormsAVX2,
+  rotateAVX2,
+};
+
+SIMD_COMPLEX_AVX512_TARGET void calcPhasesAVX512(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::avx512::calc_phases(src, dst, n);
+}
+
+SIMD_COMPLEX_AVX512_TARGET void calcNormsAVX512(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::avx512::calc_norms(src, dst, n);
+}
+
+SIMD_COMPLEX_AVX512_TARGET void rotateAVX512(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  simd_complex_conversions::avx512::rotate(oldPhase, newPhase, dst, n);
+}
+
+const ComplexKernels avx512Kernels {
+  "AVX-512",
+  calcPhasesAVX512,
+  calcNormsAVX512,
+  rotateAVX512,
+};
+
+#endif
+
+const RealKernels defaultRealKernels {
+#if USE_SSE2_COMPLEX
+  "SSE2",
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+  "NEON",
+#else
+  "Scalar",
+#endif
+  unwrapPhasesSimd,
+  fftShiftSimd,
+  lrToMsSimd,
+  msToLrSimd,
+};
+
+std::atomic<const ComplexKernels*>& currentComplexKernels()
+{
+  static std::atomic<const ComplexKernels*> kernels { getSupportedComplexKernels().back() };
+  return kernels;
+}
+
+} // namespace
+
+std::vector<const ComplexKernels*> getSupportedComplexKernels()
+{
+  std::vector<const ComplexKernels*> result { &scalarKernels };
+#if USE_SSE2_COMPLEX
+  result.push_back(&sse2Kernels);
+  if (hasAVX2())
+  {
+    result.push_back(&avx2Kernels);
+    if (hasAVX512())
+      result.push_back(&avx512Kernels);
+  }
+#endif
+  return result;
+}
+
+const ComplexKernels& getComplexKernels()
+{
+  return *currentComplexKernels().load(std::memory_order_relaxed);
+}
+
+void setComplexKernels(const ComplexKernels& kernels)
+{
+  currentComplexKernels().store(&kernels, std::memory_order_relaxed);
+}
+
+std::vector<const RealKernels*> getSupportedRealKernels()
+{
+  std::vector<const RealKernels*> result { &defaultRealKernels };
+#if USE_SSE2_COMPLEX
+  if (const auto avxKernels = getAVXRealKernels(); avxKernels && hasAVX())
+    result.push_back(avxKernels);
+#endif
+  return result;
+}
+
+const RealKernels& getRealKernels()
+{
+  static const auto& kernels = *getSupportedRealKernels().back();
+  return kernels;
+}
+
+} // namespace vo
+} // namespace staffpad
@@ -13,15 +13,7 @@
 #include <complex>
 #include <cstdint>
 #include <cstring>
-
-#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64) || \
-                          (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
-#define USE_SSE2_COMPLEX 1
-#endif
-
-#if USE_SSE2_COMPLEX
-#   include "SimdComplexConversions_sse2.h"
-#endif
+#include <vector>
 
 namespace staffpad {
 namespace vo {
@@ -99,52 +91,91 @@ inline void findMaxElement(const T* src, int32_t n, int32_t& maxIndex, T& maxVal
   }
 }
 
-#if USE_SSE2_COMPLEX
+/// Kernels for complex spectra, vectorized as widely as the processor allows.
+/// All vectorized kernels compute the same results, bit for bit; the scalar
+/// ones differ slightly.
+struct ComplexKernels
+{
+  /// for reports
+  const char* name;
+
+  void (*calcPhases)(const std::complex<float>* src, float* dst, int32_t n);
+  void (*calcNorms)(const std::complex<float>* src, float* dst, int32_t n);
+  /// multiplies dst[i] by a unit complex of argument newPhase[i] - oldPhase[i],
+  /// or newPhase[i] if oldPhase is null
+  void (*rotate)(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n);
+};
+
+/// the widest kernels that the processor supports, found at the first call
+TIME_AND_PITCH_API const ComplexKernels& getComplexKernels();
+
+/// all kernels that the processor supports, the scalar ones first; for tests
+/// and benchmarks
+TIME_AND_PITCH_API std::vector<const ComplexKernels*> getSupportedComplexKernels();
+
+/// makes getComplexKernels() return one of getSupportedComplexKernels(), e.g.
+/// to compare the output of the scalar kernels; for tests and benchmarks
+TIME_AND_PITCH_API void setComplexKernels(const ComplexKernels& kernels);
 
 inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 {
-  simd_complex_conversions::perform_parallel_simd_aligned(
-     src, dst, n,
-     [](const __m128 rp, const __m128 ip, __m128& out)
-     { out = simd_complex_conversions::atan2_ps(ip, rp); });
+  getComplexKernels().calcPhases(src, dst, n);
 }
 
 inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
 {
-  simd_complex_conversions::perform_parallel_simd_aligned(
-     src, dst, n,
-     [](const __m128 rp, const __m128 ip, __m128& out)
-     { out = simd_complex_conversions::norm(rp, ip); });
+  getComplexKernels().calcNorms(src, dst, n);
 }
 
-inline void rotate(
-   const float* oldPhase, const float* newPhase, std::complex<float>* dst,
-   int32_t n)
+inline void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
 {
-  simd_complex_conversions::rotate_parallel_simd_aligned(
-     oldPhase, newPhase, dst, n);
+  getComplexKernels().rotate(oldPhase, newPhase, dst, n);
 }
-#else
-inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
+
+/// Kernels for real vectors, vectorized as widely as the processor allows.
+/// All compute the same results, bit for bit.
+struct RealKernels
 {
-  for (int32_t i = 0; i < n; i++)
-    dst[i] = std::arg(src[i]);
+  /// for reports
+  const char* name;
+
+  /// wraps each phase into -PI..PI
+  void (*unwrapPhases)(float* v, int32_t n);
+  /// rotates an even-sized array by half its size, to align fft phase at the
+  /// center
+  void (*fftShift)(float* v, int32_t n);
+  /// converts left and right channels to mid and side, in place
+  void (*lrToMs)(float* ch1, float* ch2, int32_t n);
+  /// converts mid and side channels to left and right, in place
+  void (*msToLr)(float* ch1, float* ch2, int32_t n);
+};
+
+/// the widest kernels that the processor supports, found at the first call
+TIME_AND_PITCH_API const RealKernels& getRealKernels();
+
+/// all kernels that the processor supports, the narrowest first; for tests and
+/// benchmarks
+TIME_AND_PITCH_API std::vector<const RealKernels*> getSupportedRealKernels();
+
+inline void unwrapPhases(float* v, int32_t n)
+{
+  getRealKernels().unwrapPhases(v, n);
 }
 
-inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
+inline void fftShift(float* v, int32_t n)
 {
-  for (int32_t i = 0; i < n; i++)
-    dst[i] = std::norm(src[i]);
+  getRealKernels().fftShift(v, n);
 }
 
-inline void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+inline void lrToMs(float* ch1, float* ch2, int32_t n)
 {
-  for (int32_t i = 0; i < n; i++) {
-    const auto theta = oldPhase ? newPhase[i] - oldPhase[i] : newPhase[i];
-    dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
-  }
+  getRealKernels().lrToMs(ch1, ch2, n);
+}
+
+inline void msToLr(float* ch1, float* ch2, int32_t n)
+{
+  getRealKernels().msToLr(ch1, ch2, n);
 }
-#endif
 
 } // namespace vo
 } // namespace staffpad
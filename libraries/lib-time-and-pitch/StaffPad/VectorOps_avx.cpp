@@ -0,0 +1,34 @@
+// Compiled for AVX where the build supports it; see CMakeLists.txt. Include
+// nothing here that instantiates inline functions that other files also use.
+#include "VectorOps.h"
+
+#if defined(__AVX__)
+#include "SimdRealKernels.h"
+#endif
+
+namespace staffpad {
+namespace vo {
+
+#if defined(__AVX__)
+namespace {
+const RealKernels avxRealKernels {
+  "AVX",
+  unwrapPhasesSimd,
+  fftShiftSimd,
+  lrToMsSimd,
+  msToLrSimd,
+};
+} // namespace
+#endif
+
+const RealKernels* getAVXRealKernels()
+{
+#if defined(__AVX__)
+  return &avxRealKernels;
+#else
+  return nullptr;
+#endif
+}
+
+} // namespace vo
+} // namespace staffpad
@@ -66,6 +66,12 @@ std::unique_ptr<staffpad::TimeAndPitch> CreateTimeAndPitch(
    return timeAndPitch;
 }
 
+double GetCutoffQuefrency()
+{
+   return TimeAndPitchExperimentalSettings::GetCutoffQuefrencyOverride()
+      .value_or(0.002);
+}
+
 std::unique_ptr<FormantShifterLoggerInterface>
 GetFormantShifterLogger(int sampleRate)
 {
@@ -77,25 +83,44 @@ GetFormantShifterLogger(int sampleRate)
 }
 } // namespace
 
+bool StaffPadTimeAndPitch::Snapshot::Matches(
+   int sampleRate, size_t numChannels, const Parameters& parameters) const
+{
+   return mTimeAndPitch && sampleRate == mSampleRate &&
+          numChannels == mNumChannels &&
+          parameters.timeRatio == mParameters.timeRatio &&
+          parameters.pitchRatio == mParameters.pitchRatio &&
+          parameters.preserveFormants == mParameters.preserveFormants &&
+          // The override may have changed since
+          GetFftSize(sampleRate, parameters.preserveFormants) == mFftSize &&
+          GetCutoffQuefrency() == mCutoffQuefrency;
+}
+
 StaffPadTimeAndPitch::StaffPadTimeAndPitch(
    int sampleRate, size_t numChannels, TimeAndPitchSource& audioSource,
-   const Parameters& parameters)
+   const Parameters& parameters, const Snapshot* warmState)
     : mSampleRate(sampleRate)
     , mParameters(parameters)
     , mFormantShifterLogger(GetFormantShifterLogger(sampleRate))
-    , mFormantShifter(
-         sampleRate,
-         TimeAndPitchExperimentalSettings::GetCutoffQuefrencyOverride()
-            .value_or(0.002),
-         *mFormantShifterLogger)
+    , mFormantShifter(sampleRate, GetCutoffQuefrency(), *mFormantShifterLogger)
     , mAudioSource(audioSource)
     , mReadBuffer(maxBlockSize, numChannels)
     , mNumChannels(numChannels)
 {
-   if (mParameters.preserveFormants)
-      mFormantShifter.Reset(
-         GetFftSize(sampleRate, parameters.preserveFormants));
-   if (
+   const auto formantShifterFftSize = warmState ?
+      warmState->mFormantShifterFftSize :
+      mParameters.preserveFormants ?
+      GetFftSize(sampleRate, parameters.preserveFormants) : 0;
+   if (formantShifterFftSize > 0)
+      mFormantShifter.Reset(formantShifterFftSize);
+   if (warmState)
+   {
+      assert(warmState->Matches(sampleRate, numChannels, mParameters));
+      mTimeAndPitch = CreateTimeAndPitch(
+         mSampleRate, mNumChannels, mParameters, mFormantShifter);
+      mTimeAndPitch->copyStateFrom(*warmState->mTimeAndPitch);
+   }
+   else if (
       !TimeAndPitchInterface::IsPassThroughMode(mParameters.timeRatio) ||
       // No need for sophisticated comparison for pitch ratio, as our UI doesn't
       // allow changes smaller than a cent.
@@ -175,6 +200,26 @@ void StaffPadTimeAndPitch::OnFormantPreservationChange(bool preserve)
       InitializeStretcher();
 }
 
+std::shared_ptr<const StaffPadTimeAndPitch::Snapshot>
+StaffPadTimeAndPitch::TakeSnapshot() const
+{
+   if (!mTimeAndPitch)
+      return nullptr;
+   auto snapshot = std::make_shared<Snapshot>();
+   snapshot->mSampleRate = mSampleRate;
+   snapshot->mNumChannels = mNumChannels;
+   snapshot->mParameters = mParameters;
+   snapshot->mFftSize = GetFftSize(mSampleRate, mParameters.preserveFormants);
+   snapshot->mCutoffQuefrency = mFormantShifter.cutoffQuefrency;
+   snapshot->mFormantShifterFftSize = mFormantShifter.GetFftSize();
+   // Never processes, so needs no timbre shifting
+   snapshot->mTimeAndPitch =
+      std::make_unique<staffpad::TimeAndPitch>(snapshot->mFftSize);
+   snapshot->mTimeAndPitch->setup(static_cast<int>(mNumChannels), maxBlockSize);
+   snapshot->mTimeAndPitch->copyStateFrom(*mTimeAndPitch);
+   return snapshot;
+}
+
 void StaffPadTimeAndPitch::InitializeStretcher()
 {
    mTimeAndPitch = CreateTimeAndPitch(
@@ -8,13 +8,44 @@ class TIME_AND_PITCH_API StaffPadTimeAndPitch final :
     public TimeAndPitchInterface
 {
 public:
+   //! The state of a primed stretcher, from which others may resume instead
+   //! of pulling the same input again
+   class TIME_AND_PITCH_API Snapshot final
+   {
+   public:
+      //! Whether a stretcher with these settings may resume from this
+      bool
+      Matches(int sampleRate, size_t numChannels, const Parameters&) const;
+
+   private:
+      friend StaffPadTimeAndPitch;
+
+      int mSampleRate = 0;
+      size_t mNumChannels = 0;
+      Parameters mParameters;
+      int mFftSize = 0;
+      //! The formant shifter keeps no samples from one frame to the next, so
+      //! its configuration is all there is to resume
+      double mCutoffQuefrency = 0;
+      size_t mFormantShifterFftSize = 0;
+      std::unique_ptr<staffpad::TimeAndPitch> mTimeAndPitch;
+   };
+
+   /*!
+    @param warmState if not null, the stretcher resumes from it, as if it had
+    pulled what the stretcher that took it did ; it must match the other
+    arguments
+    */
    StaffPadTimeAndPitch(
       int sampleRate, size_t numChannels, TimeAndPitchSource&,
-      const Parameters&);
+      const Parameters&, const Snapshot* warmState = nullptr);
    void GetSamples(float* const*, size_t) override;
    void OnCentShiftChange(int cents) override;
    void OnFormantPreservationChange(bool preserve) override;
 
+   //! @return null in pass-through mode, which has no state to keep
+   std::shared_ptr<const Snapshot> TakeSnapshot() const;
+
 private:
    bool IllState() const;
    void InitializeStretcher();
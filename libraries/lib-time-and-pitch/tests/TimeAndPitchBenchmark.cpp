@@ -0,0 +1,137 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TimeAndPitchBenchmark.cpp
+
+**********************************************************************/
+#include "StaffPad/TimeAndPitch.h"
+#include "StaffPad/VectorOps.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+// Set to true to compare the throughput of the complex kernels for each
+// instruction set, and of whole stretches at several ratios
+static constexpr auto runLocally = false;
+
+// As StaffPadTimeAndPitch uses them for 44.1kHz without formant preservation
+constexpr auto FftSize = 4096;
+constexpr auto MaxBlockSize = 1024;
+constexpr auto NumChannels = 2;
+constexpr auto SampleRate = 44100;
+
+// Half the bins of the FFT, as TimeAndPitch processes them
+constexpr auto NumBins = FftSize / 2 + 1;
+constexpr auto KernelRepetitions = 20000;
+
+template <typename Function>
+double SecondsFor(int repetitions, Function function)
+{
+   const auto start = std::chrono::steady_clock::now();
+   for (auto i = 0; i < repetitions; ++i)
+      function();
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+   return elapsed.count();
+}
+
+void ReportKernel(const char* name, double seconds)
+{
+   std::cout << std::setw(20) << name << ": " << std::fixed
+             << std::setprecision(0)
+             << KernelRepetitions * NumBins / seconds / 1e6 << " Mbins/s\n";
+}
+} // namespace
+
+TEST_CASE("TimeAndPitchBenchmark")
+{
+   if (!runLocally)
+      return;
+
+   std::vector<std::complex<float>> spectrum(NumBins);
+   std::vector<float> phases(NumBins), norms(NumBins), newPhases(NumBins);
+   for (auto i = 0; i < NumBins; ++i)
+   {
+      spectrum[i] = std::polar(1.f + i % 7, 0.1f * i);
+      newPhases[i] = 0.37f * i;
+   }
+
+   for (const auto pKernels : staffpad::vo::getSupportedComplexKernels())
+   {
+      const auto& kernels = *pKernels;
+      std::cout << kernels.name << "\n";
+      ReportKernel("calcPhases", SecondsFor(KernelRepetitions, [&] {
+                      kernels.calcPhases(
+                         spectrum.data(), phases.data(), NumBins);
+                   }));
+      ReportKernel("calcNorms", SecondsFor(KernelRepetitions, [&] {
+                      kernels.calcNorms(
+                         spectrum.data(), norms.data(), NumBins);
+                   }));
+      ReportKernel("rotate", SecondsFor(KernelRepetitions, [&] {
+                      kernels.rotate(
+                         phases.data(), newPhases.data(), spectrum.data(),
+                         NumBins);
+                   }));
+   }
+
+   // Ten seconds of a chirp, which the stretcher can't skip through
+   const auto inputLength = 10 * SampleRate;
+   std::vector<std::vector<float>> input(
+      NumChannels, std::vector<float>(inputLength));
+   for (auto c = 0; c < NumChannels; ++c)
+      for (auto i = 0; i < inputLength; ++i)
+         input[c][i] = 0.5f * std::sin(
+                                 0.01f * i + 1e-7f * i * i + c);
+
+   std::vector<std::vector<float>> output(
+      NumChannels, std::vector<float>(MaxBlockSize));
+   std::cout << "Using " << staffpad::vo::getComplexKernels().name
+             << " complex and " << staffpad::vo::getRealKernels().name
+             << " real kernels\n";
+   for (const auto ratio : { 0.5, 0.8, 1.25, 2.0, 4.0 })
+   {
+      staffpad::TimeAndPitch timeAndPitch { FftSize };
+      timeAndPitch.setup(NumChannels, MaxBlockSize);
+      timeAndPitch.setTimeStretchAndPitchFactor(ratio, 1.);
+
+      auto numInput = 0;
+      auto numOutput = 0;
+      const auto seconds = SecondsFor(1, [&] {
+         while (true)
+         {
+            const auto numRequired = std::min(
+               timeAndPitch.getSamplesToNextHop(), MaxBlockSize);
+            if (numInput + numRequired > inputLength)
+               break;
+            const float* in[] { input[0].data() + numInput,
+                                input[1].data() + numInput };
+            timeAndPitch.feedAudio(in, numRequired);
+            numInput += numRequired;
+            auto numAvailable = timeAndPitch.getNumAvailableOutputSamples();
+            while (numAvailable > 0)
+            {
+               const auto numToGet = std::min(numAvailable, MaxBlockSize);
+               float* out[] { output[0].data(), output[1].data() };
+               timeAndPitch.retrieveAudio(out, numToGet);
+               numAvailable -= numToGet;
+               numOutput += numToGet;
+            }
+         }
+      });
+      std::cout << "stretch " << std::setw(4) << std::setprecision(2)
+                << ratio << ": " << std::setprecision(1)
+                << numInput / seconds / SampleRate << "x real time in, "
+                << numOutput / seconds / SampleRate << "x real time out\n";
+   }
+}
@@ -0,0 +1,138 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CopyOnWrite.h
+
+**********************************************************************/
+#pragma once
+
+#include <memory>
+#include <utility>
+
+//! Holds a value with value semantics, but copies of the holder share storage
+//! until one of them is modified
+/*!
+ Copying the holder is cheap, so that, for instance, undo states can keep
+ unchanged data of tracks without duplicating it.
+
+ A value, once published, is never modified.  Modification happens in a
+ session opened by Write(), on a working copy that replaces the published
+ value, with release ordering, when the outermost session ends.  So another
+ thread, such as the audio thread, may Load() the value while the holder is
+ being changed, and it reads either the old value or the new one entirely.
+
+ Only one thread may modify the holder, or use operator*, and sessions may
+ nest on it.  Every session copies the value, so batch many small changes in
+ one session.
+ */
+template<typename T> class CopyOnWrite final
+{
+public:
+   CopyOnWrite()
+       : mpValue { std::make_shared<const T>() }
+   {
+   }
+
+   explicit CopyOnWrite(T value)
+       : mpValue { std::make_shared<const T>(std::move(value)) }
+   {
+   }
+
+   CopyOnWrite(const CopyOnWrite& other)
+       : mpValue { other.Load() }
+   {
+   }
+   CopyOnWrite& operator=(const CopyOnWrite& other)
+   {
+      if (this != &other)
+         Publish(other.Load());
+      return *this;
+   }
+
+   //! The moved-from holder gets a new default value
+   CopyOnWrite(CopyOnWrite&& other)
+       : mpValue { other.Load() }
+   {
+      other.Publish(std::make_shared<const T>());
+   }
+   CopyOnWrite& operator=(CopyOnWrite&& other)
+   {
+      if (this != &other)
+      {
+         Publish(other.Load());
+         other.Publish(std::make_shared<const T>());
+      }
+      return *this;
+   }
+
+   //! Access from the modifying thread, seeing changes of an open session
+   const T& operator*() const noexcept
+   {
+      return mpWorking ? *mpWorking : *mpValue;
+   }
+   const T* operator->() const noexcept { return &**this; }
+
+   //! Access from any thread to the last published value, which stays
+   //! unchanged while the pointer is held
+   std::shared_ptr<const T> Load() const
+   {
+      return std::atomic_load_explicit(&mpValue, std::memory_order_acquire);
+   }
+
+   //! A session of modification
+   class Writer final
+   {
+   public:
+      explicit Writer(CopyOnWrite& holder)
+          : mHolder { holder }
+      {
+         if (mHolder.mDepth++ == 0)
+            mHolder.mpWorking = std::make_shared<T>(*mHolder.mpValue);
+      }
+      Writer(const Writer&) = delete;
+      Writer& operator=(const Writer&) = delete;
+      ~Writer()
+      {
+         if (--mHolder.mDepth == 0)
+            mHolder.Publish(std::move(mHolder.mpWorking));
+      }
+
+      T& operator*() const noexcept { return *mHolder.mpWorking; }
+      T* operator->() const noexcept { return mHolder.mpWorking.get(); }
+
+   private:
+      CopyOnWrite& mHolder;
+   };
+
+   //! Open a session, which publishes the changes when the outermost ends
+   Writer Write() { return Writer { *this }; }
+
+   //! Replace the value, not affecting other holders that shared it; not
+   //! during a session
+   void Reset(T value)
+   {
+      Publish(std::make_shared<const T>(std::move(value)));
+   }
+
+   //! Whether the holders share storage, and so certainly have equal values
+   bool Shares(const CopyOnWrite& other) const noexcept
+   {
+      return mpValue == other.mpValue;
+   }
+
+private:
+   void Publish(std::shared_ptr<const T> pValue)
+   {
+      std::atomic_store_explicit(
+         &mpValue, std::move(pValue), std::memory_order_release);
+   }
+
+   //! Changed only by atomic stores, and only by the modifying thread, which
+   //! may therefore read it plainly
+   std::shared_ptr<const T> mpValue;
+   //! Exists only during a session
+   std::shared_ptr<T> mpWorking;
+   int mDepth { 0 };
+};
@@ -0,0 +1,154 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LRUCache.h
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//! Thread-safe map from keys to shared values, bounded by a total cost
+/*!
+ When an insertion makes the total cost exceed the budget, the least recently
+ found or inserted entries are evicted.  Values are shared, so that an evicted
+ value stays valid for those still holding it.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache final
+{
+public:
+   using ValuePtr = std::shared_ptr<Value>;
+
+   struct Stats final
+   {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t evictions = 0;
+      size_t entries = 0;
+      size_t cost = 0;
+   };
+
+   explicit LRUCache(size_t budget)
+       : mBudget { budget }
+   {
+   }
+
+   LRUCache(const LRUCache&) = delete;
+   LRUCache& operator=(const LRUCache&) = delete;
+
+   //! Counts a hit or a miss, and makes a found entry the most recent
+   /*! @return null if not found */
+   ValuePtr Find(const Key& key)
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      const auto iter = mIndex.find(key);
+      if (iter == mIndex.end())
+      {
+         ++mStats.misses;
+         return {};
+      }
+      ++mStats.hits;
+      mEntries.splice(mEntries.begin(), mEntries, iter->second);
+      return iter->second->value;
+   }
+
+   //! Insert or replace the entry for `key` as the most recent
+   /*! A value costing more than the whole budget is not kept */
+   void Insert(const Key& key, ValuePtr value, size_t cost)
+   {
+      // Destroy values after unlocking
+      std::vector<ValuePtr> evicted;
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (const auto iter = mIndex.find(key); iter != mIndex.end())
+      {
+         evicted.push_back(move(iter->second->value));
+         Remove(iter);
+      }
+      if (cost > mBudget)
+         return;
+      mEntries.push_front({ key, move(value), cost });
+      mIndex.emplace(key, mEntries.begin());
+      mStats.cost += cost;
+      Shrink(evicted);
+   }
+
+   void Erase(const Key& key)
+   {
+      ValuePtr value;
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (const auto iter = mIndex.find(key); iter != mIndex.end())
+      {
+         value = move(iter->second->value);
+         Remove(iter);
+      }
+   }
+
+   void Clear()
+   {
+      decltype(mEntries) entries;
+      std::lock_guard<std::mutex> lock { mMutex };
+      mIndex.clear();
+      mEntries.swap(entries);
+      mStats.cost = 0;
+   }
+
+   void SetBudget(size_t budget)
+   {
+      std::vector<ValuePtr> evicted;
+      std::lock_guard<std::mutex> lock { mMutex };
+      mBudget = budget;
+      Shrink(evicted);
+   }
+
+   Stats GetStats() const
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      auto result = mStats;
+      result.entries = mEntries.size();
+      return result;
+   }
+
+private:
+   struct Entry final
+   {
+      Key key;
+      ValuePtr value;
+      size_t cost;
+   };
+   using Entries = std::list<Entry>;
+   using Index = std::unordered_map<Key, typename Entries::iterator, Hash>;
+
+   //! @pre mMutex is locked
+   void Remove(typename Index::iterator iter)
+   {
+      mStats.cost -= iter->second->cost;
+      mEntries.erase(iter->second);
+      mIndex.erase(iter);
+   }
+
+   //! @pre mMutex is locked
+   void Shrink(std::vector<ValuePtr>& evicted)
+   {
+      while (mStats.cost > mBudget)
+      {
+         auto& last = mEntries.back();
+         evicted.push_back(move(last.value));
+         Remove(mIndex.find(last.key));
+         ++mStats.evictions;
+      }
+   }
+
+   mutable std::mutex mMutex;
+   Entries mEntries;
+   Index mIndex;
+   size_t mBudget;
+   Stats mStats;
+};
@@ -0,0 +1,123 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CopyOnWriteTest.cpp
+
+**********************************************************************/
+
+#include "CopyOnWrite.h"
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST_CASE("CopyOnWrite")
+{
+   CopyOnWrite<std::vector<int>> a { std::vector<int> { 1, 2, 3 } };
+
+   SECTION("Copies share until modified")
+   {
+      auto b = a;
+      REQUIRE(a.Shares(b));
+      const auto& before = *a;
+
+      b.Write()->push_back(4);
+      REQUIRE(!a.Shares(b));
+      REQUIRE(*a == std::vector<int> { 1, 2, 3 });
+      REQUIRE(*b == std::vector<int> { 1, 2, 3, 4 });
+      REQUIRE(&*a == &before);
+   }
+
+   SECTION("Modification of the original leaves the copy")
+   {
+      auto b = a;
+      (*a.Write())[0] = 7;
+      REQUIRE(*a == std::vector<int> { 7, 2, 3 });
+      REQUIRE(*b == std::vector<int> { 1, 2, 3 });
+   }
+
+   SECTION("Changes are published when the outermost session ends")
+   {
+      const auto published = a.Load();
+      {
+         auto writer = a.Write();
+         writer->push_back(4);
+         {
+            auto inner = a.Write();
+            inner->push_back(5);
+         }
+         // The modifying thread sees the changes, others do not yet
+         REQUIRE(*a == std::vector<int> { 1, 2, 3, 4, 5 });
+         REQUIRE(a.Load() == published);
+      }
+      REQUIRE(*a.Load() == std::vector<int> { 1, 2, 3, 4, 5 });
+      // A loaded value is never modified
+      REQUIRE(*published == std::vector<int> { 1, 2, 3 });
+   }
+
+   SECTION("Reset affects only one holder")
+   {
+      auto b = a;
+      a.Reset({ 9 });
+      REQUIRE(*a == std::vector<int> { 9 });
+      REQUIRE(*b == std::vector<int> { 1, 2, 3 });
+   }
+
+   SECTION("Moved-from holder is empty and usable")
+   {
+      auto b = std::move(a);
+      REQUIRE(a->empty());
+      REQUIRE(b->size() == 3);
+      a.Write()->push_back(1);
+      REQUIRE(a->size() == 1);
+   }
+
+   SECTION("A copy read by another thread is never modified")
+   {
+      std::vector<int> sums;
+      std::thread reader;
+      {
+         auto b = a;
+         reader = std::thread([b = std::move(b), &sums] {
+            for (int ii = 0; ii < 1000; ++ii)
+               sums.push_back(std::accumulate(b->begin(), b->end(), 0));
+         });
+      }
+      // The copy may be gone, or not, by now
+      for (int ii = 0; ii < 1000; ++ii)
+         (*a.Write())[0] = ii;
+      reader.join();
+      REQUIRE(std::all_of(sums.begin(), sums.end(),
+         [](int sum) { return sum == 6; }));
+      REQUIRE(*a == std::vector<int> { 999, 2, 3 });
+   }
+
+   SECTION("Another thread loads whole versions while the holder changes")
+   {
+      std::vector<int> sums;
+      std::atomic<bool> done { false };
+      std::thread reader([&] {
+         while (!done.load(std::memory_order_acquire))
+         {
+            const auto pValue = a.Load();
+            sums.push_back(std::accumulate(pValue->begin(), pValue->end(), 0));
+         }
+      });
+      for (int ii = 1; ii <= 1000; ++ii)
+      {
+         // Each version sums to zero, but not between the two changes
+         auto writer = a.Write();
+         (*writer)[0] = ii;
+         (*writer)[1] = -ii - 3;
+      }
+      done.store(true, std::memory_order_release);
+      reader.join();
+      REQUIRE(std::all_of(sums.begin(), sums.end(),
+         [](int sum) { return sum == 6 || sum == 0; }));
+   }
+}
@@ -0,0 +1,94 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LRUCacheTest.cpp
+
+**********************************************************************/
+
+#include "LRUCache.h"
+#include <catch2/catch.hpp>
+
+#include <string>
+
+TEST_CASE("LRUCache")
+{
+   LRUCache<int, std::string> cache { 10 };
+   const auto make = [](const char* str) {
+      return std::make_shared<std::string>(str);
+   };
+
+   SECTION("counts hits and misses")
+   {
+      REQUIRE(!cache.Find(1));
+      cache.Insert(1, make("one"), 3);
+      REQUIRE(*cache.Find(1) == "one");
+      const auto stats = cache.GetStats();
+      REQUIRE(stats.hits == 1);
+      REQUIRE(stats.misses == 1);
+      REQUIRE(stats.entries == 1);
+      REQUIRE(stats.cost == 3);
+   }
+
+   SECTION("evicts the least recently used")
+   {
+      cache.Insert(1, make("one"), 4);
+      cache.Insert(2, make("two"), 4);
+      // Make 1 more recent than 2
+      REQUIRE(cache.Find(1));
+      cache.Insert(3, make("three"), 4);
+      REQUIRE(cache.Find(1));
+      REQUIRE(!cache.Find(2));
+      REQUIRE(cache.Find(3));
+      REQUIRE(cache.GetStats().evictions == 1);
+      REQUIRE(cache.GetStats().cost == 8);
+   }
+
+   SECTION("evicted values stay valid for their holders")
+   {
+      cache.Insert(1, make("one"), 10);
+      const auto held = cache.Find(1);
+      cache.Insert(2, make("two"), 10);
+      REQUIRE(!cache.Find(1));
+      REQUIRE(*held == "one");
+   }
+
+   SECTION("replaces an entry")
+   {
+      cache.Insert(1, make("one"), 4);
+      cache.Insert(1, make("uno"), 6);
+      REQUIRE(*cache.Find(1) == "uno");
+      REQUIRE(cache.GetStats().cost == 6);
+      REQUIRE(cache.GetStats().entries == 1);
+   }
+
+   SECTION("does not keep a value costing more than the budget")
+   {
+      cache.Insert(1, make("one"), 4);
+      cache.Insert(2, make("two"), 11);
+      REQUIRE(cache.Find(1));
+      REQUIRE(!cache.Find(2));
+   }
+
+   SECTION("erases and clears")
+   {
+      cache.Insert(1, make("one"), 4);
+      cache.Insert(2, make("two"), 4);
+      cache.Erase(1);
+      REQUIRE(!cache.Find(1));
+      REQUIRE(cache.GetStats().cost == 4);
+      cache.Clear();
+      REQUIRE(!cache.Find(2));
+      REQUIRE(cache.GetStats().cost == 0);
+   }
+
+   SECTION("shrinks to a smaller budget")
+   {
+      cache.Insert(1, make("one"), 4);
+      cache.Insert(2, make("two"), 4);
+      cache.SetBudget(5);
+      REQUIRE(!cache.Find(1));
+      REQUIRE(cache.Find(2));
+   }
+}
@@ -11,9 +11,11 @@
 #include "GraphicsDataCache.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <type_traits>
 
+#include "BasicUI.h"
 #include "ZoomInfo.h"
 
 #include "float_cast.h"
@@ -94,6 +96,39 @@ int64_t GraphicsDataCacheBase::GetMaxViewportWidth() const noexcept
    return mMaxWidth;
 }
 
+void GraphicsDataCacheBase::SetDataReadyCallback(DataReadyCallback callback)
+{
+   if (callback)
+      mDataReadyCallback =
+         std::make_shared<const DataReadyCallback>(std::move(callback));
+   else
+      mDataReadyCallback.reset();
+}
+
+auto GraphicsDataCacheBase::CoalescedRefresh(std::function<void()> refresh)
+   -> DataReadyCallback
+{
+   auto pending = std::make_shared<std::atomic<bool>>(false);
+   return [refresh = std::move(refresh),
+           pending = std::move(pending)](const GraphicsDataCacheKey&)
+   {
+      if (pending->exchange(true))
+         return;
+      BasicUI::CallAfter(
+         [refresh, pending]
+         {
+            pending->store(false);
+            refresh();
+         });
+   };
+}
+
+std::shared_ptr<const GraphicsDataCacheBase::DataReadyCallback>
+GraphicsDataCacheBase::GetDataReadyCallback() const
+{
+   return mDataReadyCallback;
+}
+
 GraphicsDataCacheBase::GraphicsDataCacheBase(double sampleRate)
     : mScaledSampleRate { sampleRate }
 {
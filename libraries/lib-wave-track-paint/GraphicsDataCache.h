@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <type_traits>
 #include <vector>
@@ -68,9 +69,30 @@ public:
    void UpdateViewportWidth(int64_t width) noexcept;
    int64_t GetMaxViewportWidth() const noexcept;
 
+   //! Type of the function called, on any thread, when the data of an element
+   //! that was filled in the background are ready
+   using DataReadyCallback = std::function<void(const GraphicsDataCacheKey& key)>;
+
+   //! Allow implementations that support it to fill elements in the background
+   /*!
+    An element awaiting its data is an incomplete placeholder, updated again on
+    later lookups; the callback should cause such a lookup, for instance by a
+    repaint.  An empty callback makes filling synchronous again.
+    */
+   void SetDataReadyCallback(DataReadyCallback callback);
+
+   //! Makes a data ready callback that calls `refresh` on the main thread, by
+   //! BasicUI::CallAfter, just once for all the calls made before it runs
+   /*! Copies of the callback, as for several caches, share the coalescing */
+   static DataReadyCallback CoalescedRefresh(std::function<void()> refresh);
+
 protected:
    explicit GraphicsDataCacheBase(double scaledSampleRate);
 
+   //! Null unless elements may be filled in the background.  Shared, so that
+   //! work in progress may outlive the cache
+   std::shared_ptr<const DataReadyCallback> GetDataReadyCallback() const;
+
    void SetScaledSampleRate(double scaledSampleRate);
 
    //! Element of the cache lookup
@@ -129,6 +151,8 @@ private:
    // This is a helper vector to implement the heap structure for the LRU policy
    std::vector<size_t> mLRUHelper;
 
+   std::shared_ptr<const DataReadyCallback> mDataReadyCallback;
+
    // Sample rate associated with this cache
    double mScaledSampleRate {}; // DV: Why do we use double for sample rate? I don't know
 
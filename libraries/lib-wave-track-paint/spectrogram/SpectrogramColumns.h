@@ -0,0 +1,103 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SpectrogramColumns.h
+
+  Split from SpectrumCache.cpp
+
+**********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "concurrency/ParallelChunks.h"
+
+//! Number of spectrogram columns computed by one task
+constexpr size_t SpectrogramColumnsPerChunk = 16;
+
+//! Fill columns [lowerBoundX, upperBoundX) of `freq`, which holds `nBins`
+//! values per column
+/*!
+ `computeColumn(state, xx, add)` computes column `xx` and returns false if
+ it lies beyond the audio.  Without reassignment it writes only the bins of
+ its own column; with it, it passes powers to `add(index, power)`, which may
+ reach other columns, and then up to `edgeLimit` columns beyond each end of
+ the range are also computed, and the sums are converted to dB.
+
+ `makeState()` makes the scratch state owned by each chunk of columns.
+
+ Chunks run on `pool` if it is not null, else serially; additions are
+ applied in the order of the serial loop, so the results are the same to
+ the bit either way.
+ */
+template<typename MakeState, typename ComputeColumn>
+void ComputeSpectrogramColumns(
+   audacity::concurrency::WorkStealingPool* pool, bool reassignment,
+   int lowerBoundX, int upperBoundX, int edgeLimit, size_t nBins, float* freq,
+   const std::vector<float>& gainFactors, const MakeState& makeState,
+   const ComputeColumn& computeColumn)
+{
+   using namespace audacity::concurrency;
+   if (upperBoundX <= lowerBoundX)
+      return;
+   const size_t nColumns = upperBoundX - lowerBoundX;
+
+   const auto computeColumns = [&](size_t begin, size_t end, const auto& add)
+   {
+      auto state = makeState();
+      for (auto xx = lowerBoundX + (int)begin, last = lowerBoundX + (int)end;
+         xx < last; ++xx)
+         computeColumn(state, xx, add);
+   };
+   if (!reassignment) {
+      ParallelChunks(pool, nColumns, SpectrogramColumnsPerChunk,
+         [&](size_t begin, size_t end) {
+            computeColumns(begin, end, [](size_t, double) {});
+         });
+      return;
+   }
+
+   OrderedScatterAdd<double>(
+      pool, nColumns, SpectrogramColumnsPerChunk, freq, computeColumns);
+
+   // Need to look beyond the edges of the range to accumulate more
+   // time reassignments.
+   // I'm not sure what's a good stopping criterion?
+   auto state = makeState();
+   const auto add = [freq](size_t index, double power) {
+      freq[index] += power;
+   };
+   auto xx = lowerBoundX;
+   for (int ii = 0; ii < edgeLimit; ++ii)
+      if (!computeColumn(state, --xx, add))
+         break;
+   xx = upperBoundX;
+   for (int ii = 0; ii < edgeLimit; ++ii)
+      if (!computeColumn(state, xx++, add))
+         break;
+
+   // Now Convert to dB terms.  Do this only after accumulating
+   // power values, which may cross columns with the time correction.
+   ParallelChunks(pool, nColumns, SpectrogramColumnsPerChunk,
+      [&](size_t begin, size_t end) {
+      for (auto col = begin; col < end; ++col) {
+         float *const results = &freq[nBins * (lowerBoundX + col)];
+         for (size_t ii = 0; ii < nBins; ++ii) {
+            float &power = results[ii];
+            if (power <= 0)
+               power = -160.0;
+            else
+               power = 10.0*log10f(power);
+         }
+         if (!gainFactors.empty()) {
+            // Apply a frequency-dependent gain factor
+            for (size_t ii = 0; ii < nBins; ++ii)
+               results[ii] += gainFactors[ii];
+         }
+      }
+   });
+}
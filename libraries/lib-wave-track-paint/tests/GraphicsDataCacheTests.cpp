@@ -10,10 +10,14 @@
 
 #include <catch2/catch.hpp>
 
+#include <atomic>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
+#include "BasicUI.h"
 #include "GraphicsDataCache.h"
 #include "ZoomInfo.h"
 
@@ -117,3 +121,34 @@ TEST_CASE("graphics-data-cache", "")
       CheckCacheElementLookup(cache, info, t0, t1, itemsCount);
    }
 }
+
+TEST_CASE("GraphicsDataCacheBase::CoalescedRefresh", "")
+{
+   // Without services, BasicUI::CallAfter queues the actions until Yield
+   std::atomic<int> refreshes { 0 };
+   const auto callback =
+      GraphicsDataCacheBase::CoalescedRefresh([&] { ++refreshes; });
+   // As for the caches of several channels
+   const auto copy = callback;
+
+   std::vector<std::thread> threads;
+   for (int i = 0; i < 4; ++i)
+      threads.emplace_back([&, i] {
+         for (int j = 0; j < 100; ++j)
+            (i % 2 ? copy : callback)({ 44100.0, j });
+      });
+   for (auto& thread : threads)
+      thread.join();
+   REQUIRE(refreshes == 0);
+
+   BasicUI::Yield();
+   REQUIRE(refreshes == 1);
+
+   // Data that arrive after the refresh cause another
+   callback({ 44100.0, 0 });
+   BasicUI::Yield();
+   REQUIRE(refreshes == 2);
+
+   BasicUI::Yield();
+   REQUIRE(refreshes == 2);
+}
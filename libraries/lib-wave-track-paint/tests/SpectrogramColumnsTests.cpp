@@ -0,0 +1,127 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ SpectrogramColumnsTests.cpp
+
+ **********************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "spectrogram/SpectrogramColumns.h"
+
+using namespace audacity::concurrency;
+
+namespace
+{
+constexpr size_t nBins = 64;
+//! Columns of audio; the filled range lies inside, so that reassignment
+//! also computes columns beyond its edges
+constexpr int nAudioColumns = 600;
+constexpr int lowerBoundX = 37;
+constexpr int upperBoundX = 537;
+constexpr int edgeLimit = 20;
+
+struct State
+{
+   std::vector<float> scratch;
+};
+
+//! Fills the columns as SpecCache::Populate does, with a column function
+//! like CalculateOneSpectrum: powers spanning many orders of magnitude, so
+//! that the order of additions changes the rounding
+std::vector<float> Fill(
+   WorkStealingPool* pool, bool reassignment, std::atomic<int>& nComputed)
+{
+   std::vector<float> freq(nAudioColumns * nBins);
+   const std::vector<float> gainFactors(nBins, 0.5f);
+   ComputeSpectrogramColumns(
+      pool, reassignment, lowerBoundX, upperBoundX, edgeLimit, nBins,
+      freq.data(), gainFactors, [] { return State { std::vector<float>(nBins) }; },
+      [&](State& state, int xx, const auto& add) {
+         if (xx < 0 || xx >= nAudioColumns)
+            return false;
+         ++nComputed;
+         std::mt19937 engine(static_cast<unsigned>(xx));
+         std::uniform_int_distribution<int> shift { -5, 5 };
+         std::uniform_real_distribution<double> exponent { -8, 8 };
+         for (size_t bin = 0; bin < nBins; ++bin)
+            state.scratch[bin] = std::pow(10.0, exponent(engine));
+         for (size_t bin = 0; bin < nBins; ++bin)
+         {
+            const auto target = xx + shift(engine);
+            if (!reassignment)
+               freq[xx * nBins + bin] = 10.0f * std::log10(state.scratch[bin]);
+            else if (target >= lowerBoundX && target < upperBoundX)
+               add(target * nBins + bin, state.scratch[bin]);
+         }
+         return true;
+      });
+   return freq;
+}
+} // namespace
+
+TEST_CASE("ComputeSpectrogramColumns", "")
+{
+   SECTION("gives the same bits with one thread or many")
+   {
+      for (const auto reassignment : { false, true })
+      {
+         std::atomic<int> nSerial { 0 };
+         const auto serial = Fill(nullptr, reassignment, nSerial);
+         WorkStealingPool one { 1 }, many { 8 };
+         for (const auto pool :
+              { &one, &many, &WorkStealingPool::GetShared() })
+         {
+            std::atomic<int> nParallel { 0 };
+            const auto parallel = Fill(pool, reassignment, nParallel);
+            REQUIRE(nParallel == nSerial);
+            REQUIRE(memcmp(parallel.data(), serial.data(),
+               serial.size() * sizeof(float)) == 0);
+         }
+      }
+   }
+
+   SECTION("computes the edges beyond the range only with reassignment")
+   {
+      std::atomic<int> nComputed { 0 };
+      Fill(nullptr, false, nComputed);
+      REQUIRE(nComputed == upperBoundX - lowerBoundX);
+
+      nComputed = 0;
+      Fill(nullptr, true, nComputed);
+      REQUIRE(nComputed == upperBoundX - lowerBoundX + 2 * edgeLimit);
+   }
+
+   SECTION("stops at the ends of the audio")
+   {
+      std::vector<float> freq(nAudioColumns * nBins);
+      int nComputed = 0;
+      ComputeSpectrogramColumns(
+         nullptr, true, 0, nAudioColumns, edgeLimit, nBins, freq.data(), {},
+         [] { return 0; }, [&](int, int xx, const auto&) {
+            if (xx < 0 || xx >= nAudioColumns)
+               return false;
+            ++nComputed;
+            return true;
+         });
+      REQUIRE(nComputed == nAudioColumns);
+   }
+
+   SECTION("leaves other columns alone")
+   {
+      std::atomic<int> nComputed { 0 };
+      const auto freq = Fill(nullptr, true, nComputed);
+      for (size_t ii = 0; ii < lowerBoundX * nBins; ++ii)
+         REQUIRE(freq[ii] == 0);
+      for (size_t ii = upperBoundX * nBins; ii < freq.size(); ++ii)
+         REQUIRE(freq[ii] == 0);
+   }
+}
@@ -0,0 +1,251 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ WaveDataCacheTests.cpp
+
+ **********************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MockSampleBlockFactory.h"
+#include "WaveClip.h"
+#include "concurrency/WorkStealingPool.h"
+#include "waveform/WaveDataCache.h"
+
+using audacity::concurrency::WorkStealingPool;
+
+namespace
+{
+constexpr int sampleRate = 44100;
+
+std::unique_ptr<WaveClip> MakeClip(const SampleBlockFactoryPtr& factory)
+{
+   auto clip = std::make_unique<WaveClip>(1, factory, floatSample, sampleRate);
+   std::vector<float> samples(4000000);
+   for (size_t ii = 0; ii < samples.size(); ++ii)
+      samples[ii] = std::sin(ii * 0.001f) * (ii % 7) / 7.0f;
+   constSamplePtr buffers[] { reinterpret_cast<constSamplePtr>(
+      samples.data()) };
+   clip->Append(buffers, floatSample, samples.size(), 1, floatSample);
+   clip->Flush();
+   return clip;
+}
+
+//! Keys of elements within the clip, at zooms that read samples, and the
+//! summaries of 256 and of 4096 samples
+std::vector<GraphicsDataCacheKey> MakeKeys()
+{
+   std::vector<GraphicsDataCacheKey> keys;
+   for (const int64_t samplesPerColumn : { 1, 300, 5000 })
+      for (int64_t element = 0; element < 3; ++element)
+         keys.push_back({ double(sampleRate) / samplesPerColumn,
+            element * int64_t(GraphicsDataCacheBase::CacheElementWidth) *
+               samplesPerColumn });
+   return keys;
+}
+
+//! Counts the calls of the data ready callback for each key
+struct ReadyKeys final
+{
+   GraphicsDataCacheBase::DataReadyCallback Callback()
+   {
+      auto token = std::make_shared<int>();
+      tasks = token;
+      return [this, token](const GraphicsDataCacheKey& key) {
+         std::lock_guard lock { mutex };
+         ++counts[{ key.PixelsPerSecond, key.FirstSample }];
+         condition.notify_all();
+      };
+   }
+
+   bool WaitFor(const GraphicsDataCacheKey& key)
+   {
+      using namespace std::chrono_literals;
+      std::unique_lock lock { mutex };
+      return condition.wait_for(lock, 10s, [&] {
+         return counts.count({ key.PixelsPerSecond, key.FirstSample }) > 0;
+      });
+   }
+
+   //! Wait until the callback is destroyed, by the cache and by all tasks
+   //! that shared it
+   bool WaitForTasks()
+   {
+      using namespace std::chrono_literals;
+      for (int ii = 0; ii < 10000 && !tasks.expired(); ++ii)
+         std::this_thread::sleep_for(1ms);
+      return tasks.expired();
+   }
+
+   size_t Total()
+   {
+      std::lock_guard lock { mutex };
+      size_t total = 0;
+      for (const auto& [key, count] : counts)
+         total += count;
+      return total;
+   }
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   std::map<std::pair<double, int64_t>, size_t> counts;
+   std::weak_ptr<void> tasks;
+};
+
+//! Occupies all workers of the shared pool until released, so that tasks
+//! posted meanwhile stay queued
+struct PoolBlocker final
+{
+   PoolBlocker()
+   {
+      auto& pool = WorkStealingPool::GetShared();
+      nThreads = pool.GetThreadCount();
+      for (size_t ii = 0; ii < nThreads; ++ii)
+         pool.Post([this] {
+            std::unique_lock lock { mutex };
+            ++started;
+            condition.notify_all();
+            condition.wait(lock, [this] { return released; });
+            ++finished;
+            condition.notify_all();
+         });
+      std::unique_lock lock { mutex };
+      condition.wait(lock, [this] { return started == nThreads; });
+   }
+
+   void Release()
+   {
+      std::lock_guard lock { mutex };
+      released = true;
+      condition.notify_all();
+   }
+
+   ~PoolBlocker()
+   {
+      Release();
+      std::unique_lock lock { mutex };
+      condition.wait(lock, [this] { return finished == nThreads; });
+   }
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   size_t nThreads {};
+   size_t started {};
+   size_t finished {};
+   bool released {};
+};
+
+//! Ignores the first column, which is smoothed with the previous element
+bool IsFlat(const WaveCacheElement& element)
+{
+   return std::all_of(
+      element.Data.begin() + 1, element.Data.end(), [](const auto& column) {
+         return column.min == 0 && column.max == 0 && column.rms == 0;
+      });
+}
+} // namespace
+
+TEST_CASE("WaveDataCache fills in the background")
+{
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   const auto clip = MakeClip(factory);
+   const auto keys = MakeKeys();
+
+   SECTION("Gives a flat placeholder, and then the data of a synchronous fill")
+   {
+      ReadyKeys ready;
+      WaveDataCache sync { *clip, 0 }, async { *clip, 0 };
+      async.SetDataReadyCallback(ready.Callback());
+
+      for (const auto& key : keys)
+      {
+         const auto expected = sync.PerformLookup(key);
+         REQUIRE(expected);
+
+         const auto placeholder = async.PerformLookup(key);
+         REQUIRE(placeholder);
+         REQUIRE(!placeholder->IsComplete);
+         REQUIRE(placeholder->AvailableColumns ==
+            GraphicsDataCacheBase::CacheElementWidth);
+         REQUIRE(IsFlat(*placeholder));
+
+         REQUIRE(ready.WaitFor(key));
+         const auto actual = async.PerformLookup(key);
+         REQUIRE(actual);
+         REQUIRE(actual->IsComplete == expected->IsComplete);
+         REQUIRE(actual->AvailableColumns == expected->AvailableColumns);
+         for (size_t column = 0; column < expected->AvailableColumns; ++column)
+         {
+            REQUIRE(actual->Data[column].min == expected->Data[column].min);
+            REQUIRE(actual->Data[column].max == expected->Data[column].max);
+            REQUIRE(actual->Data[column].rms == expected->Data[column].rms);
+         }
+      }
+      // One callback for each element
+      for (const auto& [key, count] : ready.counts)
+         REQUIRE(count == 1);
+   }
+
+   SECTION("Fills synchronously without a callback")
+   {
+      WaveDataCache cache { *clip, 0 };
+      const auto element = cache.PerformLookup(keys.front());
+      REQUIRE(element);
+      REQUIRE(element->IsComplete);
+      REQUIRE(!IsFlat(*element));
+   }
+
+   SECTION("Cancelled fills call no callback")
+   {
+      ReadyKeys ready;
+      WaveDataCache cache { *clip, 0 };
+      cache.SetDataReadyCallback(ready.Callback());
+      {
+         PoolBlocker blocker;
+         for (const auto& key : keys)
+            REQUIRE(cache.PerformLookup(key));
+         cache.Invalidate();
+      }
+      cache.SetDataReadyCallback({});
+      // The queued tasks ran, but found their fills cancelled
+      REQUIRE(ready.WaitForTasks());
+      REQUIRE(ready.Total() == 0);
+   }
+}
+
+TEST_CASE("WaveDataCache destructor does not wait for queued fills")
+{
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   auto clip = MakeClip(factory);
+   const std::weak_ptr<SampleBlock> block =
+      clip->GetSequenceBlockArray(0)->begin()->sb;
+
+   ReadyKeys ready;
+   {
+      PoolBlocker blocker;
+      {
+         WaveDataCache cache { *clip, 0 };
+         cache.SetDataReadyCallback(ready.Callback());
+         for (const auto& key : MakeKeys())
+            REQUIRE(cache.PerformLookup(key));
+         // Would never return if it waited for the blocked workers
+      }
+      // Queued tasks hold no sample blocks
+      clip.reset();
+      REQUIRE(block.expired());
+   }
+   REQUIRE(ready.WaitForTasks());
+   REQUIRE(ready.Total() == 0);
+}
@@ -14,7 +14,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
+#include <optional>
 
 #include "SampleBlock.h"
 #include "SampleFormat.h"
@@ -22,6 +25,7 @@
 #include "WaveClip.h"
 
 #include "RoundUpUnsafe.h"
+#include "concurrency/WorkStealingPool.h"
 
 namespace
 {
@@ -72,6 +76,10 @@ public:
          FillBlocksFromAppendBuffer<256>(
             appendBuffer, appendedSamples, outBlock);
          break;
+      case WaveCacheSampleBlock::Type::MinMaxRMS4k:
+         FillBlocksFromAppendBuffer<4 * 1024>(
+            appendBuffer, appendedSamples, outBlock);
+         break;
       case WaveCacheSampleBlock::Type::MinMaxRMS64k:
          FillBlocksFromAppendBuffer<64 * 1024>(
             appendBuffer, appendedSamples, outBlock);
@@ -177,6 +185,103 @@ private:
    size_t mLastProcessedSample { 0 };
 };
 
+//! Reads the data of the stored block containing the sample
+bool ReadStoredBlock(
+   const BlockArray& blocks, SampleBlockFactory& factory,
+   int64_t requiredSample, WaveCacheSampleBlock::Type dataType,
+   WaveCacheSampleBlock& outBlock)
+{
+   const auto blockIndex  = blocks.FindBlock(requiredSample);
+   const auto& inputBlock = blocks[blockIndex];
+
+   outBlock.FirstSample = inputBlock.start.as_long_long();
+   outBlock.NumSamples  = inputBlock.sb->GetSampleCount();
+
+   switch (dataType)
+   {
+   case WaveCacheSampleBlock::Type::Samples:
+   {
+      samplePtr ptr = static_cast<samplePtr>(
+         static_cast<void*>(outBlock.GetWritePointer(outBlock.NumSamples)));
+
+      inputBlock.sb->GetSamples(
+         ptr, floatSample, 0, outBlock.NumSamples, false);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS256:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 256);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      inputBlock.sb->GetSummary256(ptr, 0, framesCount);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS4k:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 4 * 1024);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      factory.GetSummary4k(inputBlock.sb, ptr, 0, framesCount);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS64k:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 64 * 1024);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      inputBlock.sb->GetSummary64k(ptr, 0, framesCount);
+   }
+   break;
+   default:
+      return false;
+   }
+
+   outBlock.DataType = dataType;
+
+   return true;
+}
+
+//! Adds the statistics of the whole stored blocks from firstSample and within
+//! samplesCount to the summary
+//! @return how many samples they have
+size_t SummarizeWholeBlocks(
+   const BlockArray& blocks, int64_t firstSample, size_t samplesCount,
+   WaveCacheSampleBlock::Summary& summary)
+{
+   const auto numSamples = blocks.GetNumSamples();
+   if (firstSample < 0 || firstSample >= numSamples)
+      return 0;
+
+   const auto first = blocks.FindBlock(firstSample);
+   if (blocks[first].start != firstSample)
+      return 0;
+
+   // The block containing the end, if any, is not whole
+   const auto end = sampleCount { firstSample } + samplesCount;
+   const auto last = end >= numSamples ? blocks.size() : blocks.FindBlock(end);
+   if (last == first)
+      return 0;
+
+   const auto blocksSummary = blocks.GetSummary(first, last);
+   const auto count = blocksSummary.samples.as_size_t();
+   if (count == 0)
+      return 0;
+
+   summary.Min = std::min(summary.Min, blocksSummary.min);
+   summary.Max = std::max(summary.Max, blocksSummary.max);
+   summary.SquaresSum += blocksSummary.sumOfSquares;
+   summary.SumItemsCount += count;
+   summary.SamplesCount = count;
+
+   return count;
+}
+
 WaveDataCache::DataProvider
 MakeDefaultDataProvider(const WaveClip& clip, int channelIndex)
 {
@@ -202,61 +307,65 @@ MakeDefaultDataProvider(const WaveClip& clip, int channelIndex)
          return appendBufferHelper.FillBuffer(*clip, outBlock, channelIndex);
       }
 
-      const auto blockIndex  = sequence->FindBlock(requiredSample);
-      const auto& inputBlock = sequence->GetBlockArray()[blockIndex];
-
-      outBlock.FirstSample = inputBlock.start.as_long_long();
-      outBlock.NumSamples  = inputBlock.sb->GetSampleCount();
-
-      switch (dataType)
-      {
-      case WaveCacheSampleBlock::Type::Samples:
-      {
-         samplePtr ptr = static_cast<samplePtr>(
-            static_cast<void*>(outBlock.GetWritePointer(outBlock.NumSamples)));
-
-         inputBlock.sb->GetSamples(
-            ptr, floatSample, 0, outBlock.NumSamples, false);
-      }
-      break;
-      case WaveCacheSampleBlock::Type::MinMaxRMS256:
-      {
-         size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 256);
-
-         float* ptr =
-            static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
-
-         inputBlock.sb->GetSummary256(ptr, 0, framesCount);
-      }
-      break;
-      case WaveCacheSampleBlock::Type::MinMaxRMS64k:
-      {
-         size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 64 * 1024);
-
-         float* ptr =
-            static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
-
-         inputBlock.sb->GetSummary64k(ptr, 0, framesCount);
-      }
-      break;
-      default:
-         return false;
-      }
-
-      outBlock.DataType = dataType;
-
-      return true;
+      return ReadStoredBlock(
+         sequence->GetBlockArray(), *sequence->GetFactory(), requiredSample,
+         dataType, outBlock);
    };
 }
 
+WaveDataCache::WholeBlocksProvider
+MakeWholeBlocksProvider(const WaveClip& clip, int channelIndex)
+{
+   return [sequence = clip.GetSequence(channelIndex)](
+             int64_t firstSample, size_t samplesCount,
+             WaveCacheSampleBlock::Summary& summary) -> size_t
+   {
+      return SummarizeWholeBlocks(
+         sequence->GetBlockArray(), firstSample, samplesCount, summary);
+   };
+}
 } // namespace
 
+//! Data of an element, read in the background
+struct WaveCacheAsyncFill final
+{
+   //! Guards Blocks and Factory
+   std::mutex Mutex;
+   //! Until the task starts, or the fill is cancelled first, so that queued
+   //! tasks keep no sample blocks
+   std::optional<BlockArray> Blocks;
+   //! Released with Blocks
+   SampleBlockFactoryPtr Factory;
+
+   std::atomic<bool> Cancelled { false };
+   //! Set after the other members are written
+   std::atomic<bool> Done { false };
+   //! Whether the result was taken by the element
+   bool Taken { false };
+
+   WaveCacheElement::Columns Data {};
+   size_t AvailableColumns { 0 };
+   bool IsComplete { false };
+   bool Processed { false };
+};
+
+//! Counts the fills whose tasks have started, for one cache
+struct WaveCacheRunningFills final
+{
+   std::mutex Mutex;
+   std::condition_variable Finished;
+   size_t Count { 0 };
+};
+
 WaveDataCache::WaveDataCache(const WaveClip& waveClip, int channelIndex)
     : GraphicsDataCache<WaveCacheElement>(
          waveClip.GetRate() / waveClip.GetStretchRatio(),
          [] { return std::make_unique<WaveCacheElement>(); })
     , mProvider { MakeDefaultDataProvider(waveClip, channelIndex) }
+    , mWholeBlocksProvider { MakeWholeBlocksProvider(waveClip, channelIndex) }
     , mWaveClip { waveClip }
+    , mChannelIndex { channelIndex }
+    , mRunningFills { std::make_shared<WaveCacheRunningFills>() }
     , mStretchChangedSubscription {
        const_cast<WaveClip&>(waveClip)
           .Observer::Publisher<StretchRatioChange>::Subscribe(
@@ -268,36 +377,188 @@ WaveDataCache::WaveDataCache(const WaveClip& waveClip, int channelIndex)
 {
 }
 
+WaveDataCache::~WaveDataCache()
+{
+   // Cancel all fills.  Those not started give up their blocks now, and
+   // the others stop at the next column
+   Invalidate();
+
+   std::unique_lock lock { mRunningFills->Mutex };
+   mRunningFills->Finished.wait(
+      lock, [this] { return mRunningFills->Count == 0; });
+}
+
 bool WaveDataCache::InitializeElement(
    const GraphicsDataCacheKey& key, WaveCacheElement& element)
 {
+   if (const auto fill = element.PendingFill)
+   {
+      // The element stays a placeholder until the data arrive
+      if (!fill->Done.load(std::memory_order_acquire))
+         return true;
+
+      if (!fill->Taken)
+      {
+         fill->Taken              = true;
+         element.Data             = fill->Data;
+         element.AvailableColumns = fill->AvailableColumns;
+         element.IsComplete       = fill->IsComplete;
+         return fill->Processed;
+      }
+      // Else the data read in the background did not complete the element,
+      // and later updates are synchronous, as for samples not yet stored
+   }
+   else if (StartAsyncFill(key, element))
+      return true;
+
    auto sw = FrameStatistics::CreateStopwatch(
       FrameStatistics::SectionID::WaveDataCache);
 
-   element.AvailableColumns = 0;
+   return FillColumns(
+      key, GetScaledSampleRate(), mProvider, mWholeBlocksProvider,
+      mCachedBlock, element.Data, element.AvailableColumns,
+      element.IsComplete);
+}
+
+bool WaveDataCache::StartAsyncFill(
+   const GraphicsDataCacheKey& key, WaveCacheElement& element)
+{
+   auto callback = GetDataReadyCallback();
+   if (!callback)
+      return false;
+
+   const auto sequence = mWaveClip.GetSequence(mChannelIndex);
+   const auto scaledSampleRate = GetScaledSampleRate();
+   const auto samplesPerColumn =
+      std::max(0.0, scaledSampleRate / key.PixelsPerSecond);
+   const auto lastSample = key.FirstSample +
+      static_cast<int64_t>(std::ceil(samplesPerColumn * CacheElementWidth));
+
+   // The append buffer may change at any time, so it is read at once
+   if (key.FirstSample < 0 ||
+       lastSample > sequence->GetNumSamples().as_long_long())
+      return false;
+
+   auto fill = std::make_shared<WaveCacheAsyncFill>();
+   // Copying the array is cheap, and later edits of the sequence do not
+   // change the copy
+   fill->Blocks = sequence->GetBlockArray();
+   fill->Factory = sequence->GetFactory();
+   element.PendingFill = fill;
+
+   // A flat line until the data arrive
+   element.Data.fill({ 0.0f, 0.0f, 0.0f });
+   element.AvailableColumns = CacheElementWidth;
+   element.IsComplete       = false;
+
+   // Workers take the most recently requested elements first
+   audacity::concurrency::WorkStealingPool::GetShared().Post(
+      [fill = std::move(fill), key, scaledSampleRate,
+       callback = std::move(callback), running = mRunningFills]
+      {
+         // Counted from taking the blocks until releasing them, because
+         // they must not outlive the cache
+         std::optional<BlockArray> blocks;
+         SampleBlockFactoryPtr pFactory;
+         {
+            std::lock_guard lock { fill->Mutex };
+            if (!fill->Blocks)
+               return;
+            blocks.swap(fill->Blocks);
+            pFactory.swap(fill->Factory);
+            std::lock_guard runningLock { running->Mutex };
+            ++running->Count;
+         }
+         auto finished = finally(
+            [&]
+            {
+               std::lock_guard lock { running->Mutex };
+               --running->Count;
+               running->Finished.notify_all();
+            });
+         // Destroyed before finished
+         const auto snapshot = std::move(*blocks);
+         blocks.reset();
+         const auto factory = std::move(pFactory);
+
+         if (fill->Cancelled.load())
+            return;
+
+         const DataProvider provider =
+            [&snapshot, &factory](
+               int64_t requiredSample, WaveCacheSampleBlock::Type dataType,
+               WaveCacheSampleBlock& outBlock)
+         {
+            return requiredSample >= 0 &&
+                   requiredSample < snapshot.GetNumSamples() &&
+                   ReadStoredBlock(snapshot, *factory, requiredSample,
+                      dataType, outBlock);
+         };
+         const WholeBlocksProvider wholeBlocksProvider =
+            [&snapshot](
+               int64_t firstSample, size_t samplesCount,
+               WaveCacheSampleBlock::Summary& summary)
+         {
+            return SummarizeWholeBlocks(
+               snapshot, firstSample, samplesCount, summary);
+         };
+
+         WaveCacheSampleBlock cachedBlock;
+         fill->Processed = FillColumns(
+            key, scaledSampleRate, provider, wholeBlocksProvider, cachedBlock,
+            fill->Data, fill->AvailableColumns, fill->IsComplete,
+            &fill->Cancelled);
+
+         if (fill->Cancelled.load())
+            return;
+
+         fill->Done.store(true, std::memory_order_release);
+         (*callback)(key);
+      });
+
+   return true;
+}
+
+bool WaveDataCache::FillColumns(
+   const GraphicsDataCacheKey& key, double scaledSampleRate,
+   const DataProvider& provider,
+   const WholeBlocksProvider& wholeBlocksProvider,
+   WaveCacheSampleBlock& cachedBlock, WaveCacheElement::Columns& columns,
+   size_t& availableColumns, bool& isComplete,
+   const std::atomic<bool>* cancelled)
+{
+   availableColumns = 0;
 
    int64_t firstSample = key.FirstSample;
 
    const auto samplesPerColumn =
-      std::max(0.0, GetScaledSampleRate() / key.PixelsPerSecond);
+      std::max(0.0, scaledSampleRate / key.PixelsPerSecond);
 
    const size_t elementSamplesCount =
       samplesPerColumn * WaveDataCache::CacheElementWidth;
    size_t processedSamples = 0;
 
+   // Choose the coarsest summary that still has a few items per column, so
+   // that the work per column is about the same at any zoom
    const WaveCacheSampleBlock::Type blockType =
       samplesPerColumn >= 64 * 1024 ?
          WaveCacheSampleBlock::Type::MinMaxRMS64k :
-         (samplesPerColumn >= 256 ? WaveCacheSampleBlock::Type::MinMaxRMS256 :
-                                    WaveCacheSampleBlock::Type::Samples);
+      samplesPerColumn >= 4 * 1024 ?
+         WaveCacheSampleBlock::Type::MinMaxRMS4k :
+      samplesPerColumn >= 256 ?
+         WaveCacheSampleBlock::Type::MinMaxRMS256 :
+         WaveCacheSampleBlock::Type::Samples;
 
-   if (blockType != mCachedBlock.DataType)
-      mCachedBlock.Reset();
+   if (blockType != cachedBlock.DataType)
+      cachedBlock.Reset();
 
    size_t columnIndex = 0;
 
    for (; columnIndex < WaveDataCache::CacheElementWidth; ++columnIndex)
    {
+      if (cancelled && cancelled->load(std::memory_order_relaxed))
+         break;
+
       WaveCacheSampleBlock::Summary summary;
 
       auto samplesLeft =
@@ -305,11 +566,26 @@ bool WaveDataCache::InitializeElement(
 
       while (samplesLeft != 0)
       {
-         if (!mCachedBlock.ContainsSample(firstSample))
-            if (!mProvider(firstSample, blockType, mCachedBlock))
+         // Blocks wholly inside the column need not be read
+         if (blockType != WaveCacheSampleBlock::Type::Samples)
+         {
+            const auto count =
+               wholeBlocksProvider(firstSample, samplesLeft, summary);
+
+            if (count != 0)
+            {
+               samplesLeft -= count;
+               firstSample += count;
+               processedSamples += count;
+               continue;
+            }
+         }
+
+         if (!cachedBlock.ContainsSample(firstSample))
+            if (!provider(firstSample, blockType, cachedBlock))
                break;
 
-         summary = mCachedBlock.GetSummary(firstSample, samplesLeft, summary);
+         summary = cachedBlock.GetSummary(firstSample, samplesLeft, summary);
          if(summary.SamplesCount == 0)
             break;
 
@@ -320,7 +596,7 @@ bool WaveDataCache::InitializeElement(
 
       if (summary.SamplesCount > 0)
       {
-         auto& column = element.Data[columnIndex];
+         auto& column = columns[columnIndex];
 
          column.min = summary.Min;
          column.max = summary.Max;
@@ -330,8 +606,8 @@ bool WaveDataCache::InitializeElement(
 
       if (columnIndex > 0)
       {
-         const auto prevColumn = element.Data[columnIndex - 1];
-         auto& column = element.Data[columnIndex];
+         const auto prevColumn = columns[columnIndex - 1];
+         auto& column = columns[columnIndex];
 
          bool updated = false;
 
@@ -358,8 +634,8 @@ bool WaveDataCache::InitializeElement(
       }
    }
 
-   element.AvailableColumns = columnIndex;
-   element.IsComplete       = processedSamples == elementSamplesCount;
+   availableColumns = columnIndex;
+   isComplete       = processedSamples == elementSamplesCount;
 
    return processedSamples != 0;
 }
@@ -453,6 +729,9 @@ WaveCacheSampleBlock::Summary WaveCacheSampleBlock::GetSummary(
    case WaveCacheSampleBlock::Type::MinMaxRMS256:
       processBlock<256>(data, from, samplesCount, summary);
       break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS4k:
+      processBlock<4 * 1024>(data, from, samplesCount, summary);
+      break;
    case WaveCacheSampleBlock::Type::MinMaxRMS64k:
       processBlock<64 * 1024>(data, from, samplesCount, summary);
       break;
@@ -494,3 +773,18 @@ void WaveCacheElement::Smooth(GraphicsDataCacheElementBase* prevElement)
       firstColumn.rms =
          std::clamp(firstColumn.rms, firstColumn.min, firstColumn.max);
 }
+
+void WaveCacheElement::Dispose()
+{
+   if (PendingFill)
+   {
+      PendingFill->Cancelled.store(true);
+      {
+         // Released here if the task did not start
+         std::lock_guard lock { PendingFill->Mutex };
+         PendingFill->Blocks.reset();
+         PendingFill->Factory.reset();
+      }
+      PendingFill.reset();
+   }
+}
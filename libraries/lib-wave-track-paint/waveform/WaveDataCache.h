@@ -11,6 +11,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <numeric>
 #include <vector>
@@ -21,6 +22,8 @@
 #include "Observer.h"
 
 class WaveClip;
+struct WaveCacheAsyncFill;
+struct WaveCacheRunningFills;
 
 //! Helper structure used to transfer the data between the data and graphics layers
 struct WAVE_TRACK_PAINT_API WaveCacheSampleBlock final
@@ -35,6 +38,11 @@ struct WAVE_TRACK_PAINT_API WaveCacheSampleBlock final
        * calculated over 256 samples.
        */
       MinMaxRMS256,
+      /*!
+       * Each element of the resulting array is a tuple (min, max, rms)
+       * calculated over 4096 samples.
+       */
+      MinMaxRMS4k,
       /*!
        * Each element of the resulting array is a tuple (min, max, rms)
        * calculated over 256 samples.
@@ -85,7 +93,12 @@ struct WAVE_TRACK_PAINT_API WaveCacheElement final : GraphicsDataCacheElementBas
    Columns Data;
    size_t AvailableColumns { 0 };
 
+   //! Not null when the data are read in the background
+   std::shared_ptr<WaveCacheAsyncFill> PendingFill;
+
    void Smooth(GraphicsDataCacheElementBase* prevElement) override;
+   //! Cancels the reading of the data, if it is pending
+   void Dispose() override;
 };
 
 //! Cache that contains the waveform data
@@ -94,17 +107,44 @@ class WAVE_TRACK_PAINT_API WaveDataCache final :
 {
 public:
    using DataProvider = std::function<bool (int64_t requiredSample, WaveCacheSampleBlock::Type dataType, WaveCacheSampleBlock& block)>;
+   //! Adds to the summary the whole blocks that start at firstSample and end
+   //! within samplesCount, from block-level statistics, and returns how many
+   //! samples they have
+   using WholeBlocksProvider = std::function<size_t(
+      int64_t firstSample, size_t samplesCount,
+      WaveCacheSampleBlock::Summary& summary)>;
 
    WaveDataCache(const WaveClip& waveClip, int channelIndex);
+   //! Cancels the fills in the background, and waits only for those that
+   //! started, which stop at the next column
+   ~WaveDataCache() override;
 
 private:
    bool InitializeElement(
       const GraphicsDataCacheKey& key, WaveCacheElement& element) override;
 
+   //! Makes the element a placeholder and reads its data in the background,
+   //! if a data ready callback is set and the data are all in sample blocks
+   bool StartAsyncFill(
+      const GraphicsDataCacheKey& key, WaveCacheElement& element);
+
+   //! Fills the columns from the providers, stopping early if cancelled
+   //! @return whether any sample was processed
+   static bool FillColumns(
+      const GraphicsDataCacheKey& key, double scaledSampleRate,
+      const DataProvider& provider,
+      const WholeBlocksProvider& wholeBlocksProvider,
+      WaveCacheSampleBlock& cachedBlock, WaveCacheElement::Columns& columns,
+      size_t& availableColumns, bool& isComplete,
+      const std::atomic<bool>* cancelled = nullptr);
+
    DataProvider mProvider;
+   WholeBlocksProvider mWholeBlocksProvider;
 
    WaveCacheSampleBlock mCachedBlock;
 
    const WaveClip& mWaveClip;
+   const int mChannelIndex;
+   const std::shared_ptr<WaveCacheRunningFills> mRunningFills;
    Observer::Subscription mStretchChangedSubscription;
 };
@@ -0,0 +1,385 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BlockArray.cpp
+
+**********************************************************************/
+#include "BlockArray.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <random>
+#include <utility>
+
+#include "SampleBlock.h"
+
+struct BlockArray::Node
+{
+   NodePtr left, right;
+   SeqBlock::SampleBlockPtr sb;
+   //! Samples in sb
+   size_t length {};
+   //! Statistics of sb alone
+   Summary block;
+   //! Statistics of the subtree, including its total of samples
+   Summary subtree;
+   //! Blocks in the subtree
+   size_t size {};
+   //! Parents have higher priorities than children
+   unsigned priority {};
+   //! The owner of the array that made the node, which may change it in place
+   //! while it still has that owner
+   unsigned long long owner {};
+};
+
+namespace {
+using Node = BlockArray::Node;
+using NodePtr = std::shared_ptr<Node>;
+
+size_t Size(const NodePtr& p)
+{
+   return p ? p->size : 0;
+}
+
+sampleCount Samples(const NodePtr& p)
+{
+   return p ? p->subtree.samples : 0;
+}
+
+void Update(Node& node)
+{
+   node.size = Size(node.left) + 1 + Size(node.right);
+   node.subtree = {};
+   if (node.left)
+      node.subtree.Add(node.left->subtree);
+   node.subtree.Add(node.block);
+   if (node.right)
+      node.subtree.Add(node.right->subtree);
+}
+
+void SetBlock(Node& node, SeqBlock::SampleBlockPtr sb)
+{
+   node.length = sb ? sb->GetSampleCount() : 0;
+   node.block = {};
+   if (node.length > 0) {
+      // Not reading samples; errors leave zeroes, as for display
+      const auto stats = sb->GetMinMaxRMS(false);
+      node.block.min = stats.min;
+      node.block.max = stats.max;
+      node.block.sumOfSquares = double(stats.RMS) * stats.RMS * node.length;
+      node.block.samples = node.length;
+   }
+   node.sb = std::move(sb);
+}
+
+unsigned long long NewOwner()
+{
+   static std::atomic<unsigned long long> lastOwner { 0 };
+   return ++lastOwner;
+}
+
+NodePtr MakeNode(SeqBlock::SampleBlockPtr sb, unsigned long long owner)
+{
+   // Each thread makes its own sequence of priorities; they need to be
+   // independent of the positions of the nodes, not unpredictable
+   static thread_local std::minstd_rand engine;
+   auto result = std::make_shared<Node>();
+   SetBlock(*result, std::move(sb));
+   result->priority = engine();
+   result->owner = owner;
+   Update(*result);
+   return result;
+}
+
+//! A node that the owner may change: the given one if the owner made it,
+//! else a copy, which shares the children
+NodePtr Own(NodePtr p, unsigned long long owner)
+{
+   if (p->owner != owner) {
+      p = std::make_shared<Node>(*p);
+      p->owner = owner;
+   }
+   return p;
+}
+
+NodePtr Merge(NodePtr a, NodePtr b, unsigned long long owner)
+{
+   if (!a)
+      return b;
+   if (!b)
+      return a;
+   if (a->priority > b->priority) {
+      a = Own(std::move(a), owner);
+      a->right = Merge(std::move(a->right), std::move(b), owner);
+      Update(*a);
+      return a;
+   }
+   else {
+      b = Own(std::move(b), owner);
+      b->left = Merge(std::move(a), std::move(b->left), owner);
+      Update(*b);
+      return b;
+   }
+}
+
+//! @return the first k blocks, and the rest
+std::pair<NodePtr, NodePtr> Split(
+   NodePtr p, size_t k, unsigned long long owner)
+{
+   if (k == 0)
+      return { nullptr, std::move(p) };
+   if (k >= Size(p))
+      return { std::move(p), nullptr };
+   p = Own(std::move(p), owner);
+   const auto leftSize = Size(p->left);
+   if (k <= leftSize) {
+      auto [first, rest] = Split(std::move(p->left), k, owner);
+      p->left = std::move(rest);
+      Update(*p);
+      return { std::move(first), std::move(p) };
+   }
+   else {
+      auto [first, rest] =
+         Split(std::move(p->right), k - leftSize - 1, owner);
+      p->right = std::move(first);
+      Update(*p);
+      return { std::move(p), std::move(rest) };
+   }
+}
+
+NodePtr Replace(NodePtr p, size_t i, SeqBlock::SampleBlockPtr& sb,
+   unsigned long long owner)
+{
+   p = Own(std::move(p), owner);
+   const auto leftSize = Size(p->left);
+   if (i < leftSize)
+      p->left = Replace(std::move(p->left), i, sb, owner);
+   else if (i > leftSize)
+      p->right = Replace(std::move(p->right), i - leftSize - 1, sb, owner);
+   else
+      SetBlock(*p, std::move(sb));
+   Update(*p);
+   return p;
+}
+
+//! Add statistics of the blocks of the subtree from first up to but not
+//! including last
+void Summarize(const Node* p, size_t first, size_t last, BlockArray::Summary& result)
+{
+   if (!p || first >= last)
+      return;
+   if (first == 0 && last >= p->size) {
+      result.Add(p->subtree);
+      return;
+   }
+   const auto leftSize = Size(p->left);
+   if (first < leftSize)
+      Summarize(p->left.get(), first, std::min(last, leftSize), result);
+   if (first <= leftSize && leftSize < last)
+      result.Add(p->block);
+   if (last > leftSize + 1)
+      Summarize(p->right.get(), first > leftSize ? first - leftSize - 1 : 0,
+         last - leftSize - 1, result);
+}
+}
+
+BlockArray::BlockArray()
+   : mOwner{ NewOwner() }
+{
+}
+
+BlockArray::BlockArray(const BlockArray& other)
+   : mRoot{ other.mRoot }
+   , mOwner{ NewOwner() }
+{
+   other.Renew();
+}
+
+BlockArray& BlockArray::operator=(const BlockArray& other)
+{
+   if (this != &other) {
+      mRoot = other.mRoot;
+      Renew();
+      other.Renew();
+   }
+   return *this;
+}
+
+BlockArray::BlockArray(BlockArray&& other) noexcept
+   : mRoot{ std::move(other.mRoot) }
+   , mOwner{ other.mOwner.load(std::memory_order_relaxed) }
+{
+   other.Renew();
+}
+
+BlockArray& BlockArray::operator=(BlockArray&& other) noexcept
+{
+   if (this != &other) {
+      mRoot = std::move(other.mRoot);
+      mOwner.store(
+         other.mOwner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      other.Renew();
+   }
+   return *this;
+}
+
+BlockArray::~BlockArray() = default;
+
+void BlockArray::Renew() const
+{
+   mOwner.store(NewOwner(), std::memory_order_relaxed);
+}
+
+size_t BlockArray::size() const
+{
+   return Size(mRoot);
+}
+
+sampleCount BlockArray::GetNumSamples() const
+{
+   return Samples(mRoot);
+}
+
+SeqBlock BlockArray::operator[](size_t i) const
+{
+   assert(i < size());
+   sampleCount start = 0;
+   auto p = mRoot.get();
+   while (true) {
+      const auto leftSize = Size(p->left);
+      if (i < leftSize)
+         p = p->left.get();
+      else {
+         start += Samples(p->left);
+         if (i == leftSize)
+            return { p->sb, start };
+         start += p->length;
+         i -= leftSize + 1;
+         p = p->right.get();
+      }
+   }
+}
+
+auto BlockArray::end() const -> const_iterator
+{
+   const_iterator result;
+   result.mIndex = size();
+   result.mBlock.start = GetNumSamples();
+   return result;
+}
+
+auto BlockArray::At(size_t i) const -> const_iterator
+{
+   if (i >= size())
+      return end();
+   const_iterator result;
+   result.mIndex = i;
+   sampleCount start = 0;
+   auto p = mRoot.get();
+   while (true) {
+      const auto leftSize = Size(p->left);
+      if (i < leftSize) {
+         result.mStack.push_back(p);
+         p = p->left.get();
+      }
+      else {
+         start += Samples(p->left);
+         if (i == leftSize) {
+            result.mStack.push_back(p);
+            result.mBlock = { p->sb, start };
+            return result;
+         }
+         start += p->length;
+         i -= leftSize + 1;
+         p = p->right.get();
+      }
+   }
+}
+
+auto BlockArray::const_iterator::operator++() -> const_iterator&
+{
+   assert(!mStack.empty());
+   auto p = mStack.back();
+   mStack.pop_back();
+   mBlock.start += p->length;
+   ++mIndex;
+   for (p = p->right.get(); p; p = p->left.get())
+      mStack.push_back(p);
+   mBlock.sb = mStack.empty() ? nullptr : mStack.back()->sb;
+   return *this;
+}
+
+size_t BlockArray::FindBlock(sampleCount pos) const
+{
+   assert(0 <= pos && pos < GetNumSamples());
+   size_t result = 0;
+   auto p = mRoot.get();
+   while (p) {
+      const auto leftSamples = Samples(p->left);
+      if (pos < leftSamples)
+         p = p->left.get();
+      else {
+         result += Size(p->left);
+         pos -= leftSamples;
+         if (pos < p->length)
+            break;
+         pos -= p->length;
+         ++result;
+         p = p->right.get();
+      }
+   }
+   return result;
+}
+
+auto BlockArray::GetSummary(size_t first, size_t last) const -> Summary
+{
+   assert(first <= last && last <= size());
+   Summary result;
+   Summarize(mRoot.get(), first, last, result);
+   return result;
+}
+
+void BlockArray::push_back(SeqBlock::SampleBlockPtr sb)
+{
+   const auto owner = mOwner.load(std::memory_order_relaxed);
+   mRoot = Merge(std::move(mRoot), MakeNode(std::move(sb), owner), owner);
+}
+
+void BlockArray::pop_back()
+{
+   assert(!empty());
+   mRoot = Split(std::move(mRoot), size() - 1,
+      mOwner.load(std::memory_order_relaxed)).first;
+}
+
+void BlockArray::Set(size_t i, SeqBlock::SampleBlockPtr sb)
+{
+   assert(i < size());
+   mRoot = Replace(std::move(mRoot), i, sb,
+      mOwner.load(std::memory_order_relaxed));
+}
+
+void BlockArray::Append(const BlockArray& blocks)
+{
+   // Copy first, in case blocks is this
+   auto root = blocks.mRoot;
+   // Now both share the nodes of blocks
+   blocks.Renew();
+   mRoot = Merge(std::move(mRoot), std::move(root),
+      mOwner.load(std::memory_order_relaxed));
+}
+
+BlockArray BlockArray::Slice(size_t first, size_t last) const
+{
+   assert(first <= last && last <= size());
+   // The slice shares nodes with this array, but changes none of them
+   Renew();
+   BlockArray result;
+   const auto owner = result.mOwner.load(std::memory_order_relaxed);
+   auto init = Split(mRoot, last, owner).first;
+   result.mRoot = Split(std::move(init), first, owner).second;
+   return result;
+}
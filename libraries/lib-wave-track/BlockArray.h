@@ -0,0 +1,208 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BlockArray.h
+
+  @brief Balanced tree of the sample blocks of a Sequence
+
+**********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "SampleCount.h"
+
+class SampleBlock;
+
+// This is an internal data structure!  For advanced use only.
+class SeqBlock {
+ public:
+   using SampleBlockPtr = std::shared_ptr<SampleBlock>;
+   SampleBlockPtr sb;
+   ///the sample in the global wavetrack that this block starts at.
+   sampleCount start;
+
+   SeqBlock()
+      : sb{}, start(0)
+   {}
+
+   SeqBlock(const SampleBlockPtr &sb_, sampleCount start_)
+      : sb(sb_), start(start_)
+   {}
+
+   // Construct a SeqBlock with changed start, same file
+   SeqBlock Plus(sampleCount delta) const
+   {
+      return SeqBlock(sb, start + delta);
+   }
+};
+
+//! Sequence of sample blocks, indexed both by position and by sample
+/*!
+ The blocks are the nodes of a treap.  Each node stores the length of its block
+ and the totals of its subtree, so that the start of a block is not stored but
+ implied by the lengths of the blocks before it.  Finding a block, by index or
+ by sample, and splitting or joining arrays, take logarithmic time, and so do
+ insertions and deletions in the middle of a long sequence.
+
+ Copies share nodes until either is changed, and then copy only the nodes on
+ the paths to the changes.  As for a std::vector, there must be no
+ modification concurrent with other use of the same array; distinct arrays may
+ be used concurrently, even if they share nodes.
+
+ Whether a node may be changed in place is decided by a mark of ownership, not
+ by the count of references, which another thread may be changing while it
+ still reads the node.  Each node is marked with the owner of the array that
+ made it.  Sharing nodes with another array gives both arrays new owners, so
+ that the first change after sharing copies the nodes on the path, even if the
+ other array is gone by then.
+
+ Elements are read as SeqBlock values, with their starts computed, so that code
+ written for a vector of SeqBlock can read this array too.
+
+ Each node also keeps the extremes and sum of squares of its subtree, from the
+ statistics of whole blocks, so that they are found for any range of blocks
+ without reading the blocks.
+ */
+class WAVE_TRACK_API BlockArray final
+{
+public:
+   //! Defined only in the implementation
+   struct Node;
+   using NodePtr = std::shared_ptr<Node>;
+
+   using size_type = size_t;
+   using value_type = SeqBlock;
+
+   //! Extremes and sum of squares of the samples of some blocks
+   struct Summary final
+   {
+      float min { std::numeric_limits<float>::infinity() };
+      float max { -std::numeric_limits<float>::infinity() };
+      double sumOfSquares {};
+      sampleCount samples {};
+
+      void Add(const Summary& other)
+      {
+         min = std::min(min, other.min);
+         max = std::max(max, other.max);
+         sumOfSquares += other.sumOfSquares;
+         samples += other.samples;
+      }
+   };
+
+   //! Visits the blocks in order in constant amortized time per block
+   class WAVE_TRACK_API const_iterator
+   {
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = SeqBlock;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const SeqBlock*;
+      using reference = const SeqBlock&;
+
+      const_iterator() = default;
+
+      reference operator*() const { return mBlock; }
+      pointer operator->() const { return &mBlock; }
+
+      const_iterator& operator++();
+      const_iterator operator++(int)
+      {
+         auto result = *this;
+         ++*this;
+         return result;
+      }
+
+      //! Position of the block in the array
+      size_t Index() const { return mIndex; }
+
+      friend bool operator==(const const_iterator& a, const const_iterator& b)
+      {
+         return a.mIndex == b.mIndex;
+      }
+      friend bool operator!=(const const_iterator& a, const const_iterator& b)
+      {
+         return !(a == b);
+      }
+
+   private:
+      friend BlockArray;
+      //! Nodes whose blocks are not yet visited, the current one last
+      std::vector<const Node*> mStack;
+      SeqBlock mBlock;
+      size_t mIndex {};
+   };
+
+   BlockArray();
+   BlockArray(const BlockArray& other);
+   BlockArray& operator=(const BlockArray& other);
+   //! The moved-from array is left empty
+   BlockArray(BlockArray&& other) noexcept;
+   BlockArray& operator=(BlockArray&& other) noexcept;
+   ~BlockArray();
+
+   size_t size() const;
+   bool empty() const { return !mRoot; }
+
+   //! Total of the lengths of all blocks
+   sampleCount GetNumSamples() const;
+
+   //! @pre `i < size()`
+   SeqBlock operator[](size_t i) const;
+   //! @pre `!empty()`
+   SeqBlock front() const { return (*this)[0]; }
+   //! @pre `!empty()`
+   SeqBlock back() const { return (*this)[size() - 1]; }
+
+   const_iterator begin() const { return At(0); }
+   const_iterator end() const;
+   //! @return iterator at the block of index i, or end() if `i >= size()`
+   const_iterator At(size_t i) const;
+
+   //! @return index of the block that contains the sample
+   /*! @pre `0 <= pos && pos < GetNumSamples()` */
+   size_t FindBlock(sampleCount pos) const;
+
+   //! @return the summary of the blocks from first up to but not including
+   //! last, in logarithmic time
+   /*! @pre `first <= last && last <= size()` */
+   Summary GetSummary(size_t first, size_t last) const;
+
+   //! @return whether both arrays have the same tree (and so the same blocks)
+   bool Shares(const BlockArray& other) const { return mRoot == other.mRoot; }
+
+   //! Append a block, whose start is the end of the array
+   void push_back(SeqBlock::SampleBlockPtr sb);
+   //! @pre `!empty()`
+   void pop_back();
+   //! Replace the block of index i, moving the starts of all later blocks if
+   //! its length changes
+   /*! @pre `i < size()` */
+   void Set(size_t i, SeqBlock::SampleBlockPtr sb);
+   //! Append all blocks of another array, which is unchanged, but shares its
+   //! nodes
+   void Append(const BlockArray& blocks);
+   //! @return the blocks from first up to but not including last, sharing
+   //! nodes with this array
+   /*! @pre `first <= last && last <= size()` */
+   BlockArray Slice(size_t first, size_t last) const;
+   void clear() { mRoot.reset(); }
+
+private:
+   //! Give this array a new owner, after it shares its nodes
+   void Renew() const;
+
+   NodePtr mRoot;
+   //! Marks the nodes that only this array has, and so may change in place;
+   //! atomic only because const arrays may be copied concurrently
+   mutable std::atomic<unsigned long long> mOwner;
+};
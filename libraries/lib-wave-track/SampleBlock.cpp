@@ -13,6 +13,15 @@ SampleBlock.cpp
 
 #include <wx/defs.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
 {
    auto &factory = Factory::Get();
@@ -21,6 +30,39 @@ SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
    return factory( project );
 }
 
+//! Summaries of blocks over 4096 samples, least recently used last
+struct SampleBlockFactory::Summary4kCache final
+{
+   struct Entry final
+   {
+      const SampleBlock *key;
+      //! Detects another block made at the same address
+      std::weak_ptr<SampleBlock> block;
+      std::vector<float> summary;
+   };
+   using Entries = std::list<Entry>;
+
+   //! Counts the bookkeeping too, so that empty summaries are also bounded
+   static size_t Bytes(const Entry &entry)
+   {
+      return sizeof(Entry) + sizeof(Entries::iterator) +
+         entry.summary.size() * sizeof(float);
+   }
+
+   explicit Summary4kCache(size_t maxBytes) : maxBytes{ maxBytes } {}
+
+   const size_t maxBytes;
+   std::mutex mutex;
+   Entries entries;
+   std::unordered_map<const SampleBlock*, Entries::iterator> index;
+   size_t bytes{ 0 };
+};
+
+SampleBlockFactory::SampleBlockFactory(size_t summary4kCacheBytes)
+   : mSummary4kCache{ std::make_unique<Summary4kCache>(summary4kCacheBytes) }
+{
+}
+
 SampleBlockFactory::~SampleBlockFactory() = default;
 
 SampleBlockPtr SampleBlockFactory::Create(constSamplePtr src,
@@ -103,3 +145,101 @@ size_t SampleBlock::GetSamples(samplePtr dest,
    }
 }
 
+namespace {
+// Triples of min, max, and rms
+constexpr size_t SummaryFields = 3;
+
+bool ComputeSummary4k(SampleBlock &block, std::vector<float> &summary4k)
+{
+   constexpr size_t fields = SummaryFields;
+   constexpr size_t ratio = 4096 / 256;
+
+   const auto sampleCount = block.GetSampleCount();
+   const auto frames256 = (sampleCount + 255) / 256;
+   std::vector<float> summary256(frames256 * fields);
+   if (!block.GetSummary256(summary256.data(), 0, frames256))
+      return false;
+
+   const auto frames4k = (sampleCount + 4095) / 4096;
+   summary4k.resize(frames4k * fields);
+   for (size_t i = 0; i < frames4k; ++i) {
+      float min = FLT_MAX;
+      float max = -FLT_MAX;
+      double sumsq = 0.0;
+      const auto end = std::min(frames256, (i + 1) * ratio);
+      for (auto j = i * ratio; j < end; ++j) {
+         const auto frame = &summary256[j * fields];
+         min = std::min(min, frame[0]);
+         max = std::max(max, frame[1]);
+         // Weigh the last frame of 256 by the samples it really has
+         const auto count = std::min<size_t>(256, sampleCount - j * 256);
+         sumsq += double(frame[2]) * frame[2] * count;
+      }
+      const auto count = std::min<size_t>(4096, sampleCount - i * 4096);
+      summary4k[i * fields] = min;
+      summary4k[i * fields + 1] = max;
+      summary4k[i * fields + 2] = static_cast<float>(sqrt(sumsq / count));
+   }
+   return true;
+}
+
+void CopySummary(const std::vector<float> &summary,
+   float *dest, size_t frameoffset, size_t numframes)
+{
+   constexpr size_t fields = SummaryFields;
+   const auto frames = summary.size() / fields;
+   const auto copied =
+      frameoffset < frames ? std::min(numframes, frames - frameoffset) : 0;
+   if (copied > 0)
+      std::copy_n(&summary[frameoffset * fields], copied * fields, dest);
+   std::fill(dest + copied * fields, dest + numframes * fields, 0.0f);
+}
+}
+
+bool SampleBlockFactory::GetSummary4k(const SampleBlockPtr &pBlock,
+   float *dest, size_t frameoffset, size_t numframes)
+{
+   auto &cache = *mSummary4kCache;
+   const auto key = pBlock.get();
+   // Destroyed after the lock is released
+   Summary4kCache::Entries evicted;
+   {
+      std::lock_guard<std::mutex> lock{ cache.mutex };
+      if (const auto found = cache.index.find(key);
+          found != cache.index.end()) {
+         const auto iter = found->second;
+         if (iter->block.lock() == pBlock) {
+            cache.entries.splice(cache.entries.begin(), cache.entries, iter);
+            CopySummary(iter->summary, dest, frameoffset, numframes);
+            return true;
+         }
+         cache.bytes -= Summary4kCache::Bytes(*iter);
+         cache.index.erase(found);
+         evicted.splice(evicted.end(), cache.entries, iter);
+      }
+   }
+
+   // Read the 256 summary without the lock
+   std::vector<float> summary;
+   if (!ComputeSummary4k(*pBlock, summary)) {
+      // Try again next time
+      std::fill(dest, dest + numframes * SummaryFields, 0.0f);
+      return false;
+   }
+   CopySummary(summary, dest, frameoffset, numframes);
+
+   std::lock_guard<std::mutex> lock{ cache.mutex };
+   // Another thread may have computed it meanwhile
+   if (cache.index.count(key))
+      return true;
+   cache.entries.push_front({ key, pBlock, move(summary) });
+   cache.index.emplace(key, cache.entries.begin());
+   cache.bytes += Summary4kCache::Bytes(cache.entries.front());
+   while (cache.bytes > cache.maxBytes && cache.entries.size() > 1) {
+      const auto last = std::prev(cache.entries.end());
+      cache.bytes -= Summary4kCache::Bytes(*last);
+      cache.index.erase(last->key);
+      evicted.splice(evicted.end(), cache.entries, last);
+   }
+   return true;
+}
@@ -148,7 +148,24 @@ public:
    /*! @return ids of all sample blocks created by this factory and still extant */
    virtual SampleBlockIDs GetActiveBlockIDs() = 0;
 
+   //! Summary of a block over frames of 4096 samples, as for GetSummary256
+   /*!
+    Not stored, but computed from the 256 summary when first needed, for
+    display at zooms between those of the other two summaries, and kept in a
+    cache of bounded size.  Non-throwing, fills with zeroes on failure.  May
+    be called from any thread.
+    */
+   bool GetSummary4k(const SampleBlockPtr &pBlock,
+      float *dest, size_t frameoffset, size_t numframes);
+
+   //! Default bound on the bytes of summaries that GetSummary4k() keeps
+   static constexpr size_t Summary4kCacheBytes = 16 * 1024 * 1024;
+
 protected:
+   //! @param summary4kCacheBytes bound on the cache of GetSummary4k()
+   explicit SampleBlockFactory(
+      size_t summary4kCacheBytes = Summary4kCacheBytes);
+
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by Create
    virtual SampleBlockPtr DoCreate(constSamplePtr src,
@@ -169,6 +186,10 @@ protected:
 
    virtual SampleBlockPtr
    DoCreateFromId(sampleFormat srcformat, SampleBlockID id) = 0;
+
+private:
+   struct Summary4kCache;
+   const std::unique_ptr<Summary4kCache> mSummary4kCache;
 };
 
 #endif
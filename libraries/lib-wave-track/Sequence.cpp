@@ -70,7 +70,14 @@ Sequence::Sequence(
    mMinSamples(orig.mMinSamples),
    mMaxSamples(orig.mMaxSamples)
 {
-   Paste(0, &orig);
+   if (pFactory == orig.mpFactory) {
+      // Blocks would be shared anyway; share the array too, until either
+      // sequence changes
+      mBlock = orig.mBlock;
+      mNumSamples = orig.mNumSamples;
+   }
+   else
+      Paste(0, &orig);
 }
 
 Sequence::~Sequence()
@@ -89,8 +96,8 @@ size_t Sequence::GetIdealBlockSize() const
 
 bool Sequence::CloseLock() noexcept
 {
-   for (unsigned int i = 0; i < mBlock.size(); i++)
-      mBlock[i].sb->CloseLock();
+   for (const auto &block : mBlock)
+      block.sb->CloseLock();
 
    return true;
 }
@@ -174,10 +181,6 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
    } );
 
    BlockArray newBlockArray;
-   // Use the ratio of old to NEW mMaxSamples to make a reasonable guess
-   // at allocation.
-   newBlockArray.reserve
-      (1 + mBlock.size() * ((float)oldMaxSamples / (float)mMaxSamples));
 
    {
       size_t oldSize = oldMaxSamples;
@@ -185,9 +188,8 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
       size_t newSize = oldMaxSamples;
       SampleBuffer bufferNew(newSize, format);
 
-      for (size_t i = 0, nn = mBlock.size(); i < nn; i++)
+      for (const auto &oldSeqBlock : mBlock)
       {
-         SeqBlock &oldSeqBlock = mBlock[i];
          const auto &oldBlockFile = oldSeqBlock.sb;
          const auto len = oldBlockFile->GetSampleCount();
          ensureSampleBufferSize(bufferOld, oldFormats.Stored(), oldSize, len);
@@ -216,9 +218,8 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
          //    from the old blocks... Oh no!
 
          // Using Blockify will handle the cases where len > the NEW mMaxSamples. Previous code did not.
-         const auto blockstart = oldSeqBlock.start;
          Blockify(*mpFactory, mMaxSamples, format,
-                  newBlockArray, blockstart, bufferNew.ptr(), len);
+                  newBlockArray, bufferNew.ptr(), len);
 
          if (progressReport)
             progressReport(len);
@@ -412,8 +413,6 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    wxUnusedVar(numBlocks);
    wxASSERT(b0 <= b1);
 
-   dest->mBlock.reserve(b1 - b0 + 1);
-
    auto bufferSize = mMaxSamples;
    const auto format = mSampleFormats.Stored();
    SampleBuffer buffer(bufferSize, format);
@@ -440,10 +439,19 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       --b0;
 
    // If there are blocks in the middle, use the blocks whole
-   for (int bb = b0 + 1; bb < b1; ++bb)
-      AppendBlock(pUseFactory, format,
-         dest->mBlock, dest->mNumSamples, mBlock[bb]);
-      // Increase ref count or duplicate file
+   if (b0 + 1 < b1) {
+      if (!pUseFactory) {
+         // Share the nodes of the tree too
+         dest->mBlock.Append(mBlock.Slice(b0 + 1, b1));
+         dest->mNumSamples = dest->mBlock.GetNumSamples();
+      }
+      else
+         for (auto iter = mBlock.At(b0 + 1), end = mBlock.At(b1);
+              iter != end; ++iter)
+            AppendBlock(pUseFactory, format,
+               dest->mBlock, dest->mNumSamples, *iter);
+            // Duplicate file
+   }
 
    // Do the last block
    if (b1 > b0) {
@@ -551,24 +559,30 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // minimum size
 
       // Build and swap a copy so there is a strong exception safety guarantee
+      // (the copy shares the tree until it changes)
       BlockArray newBlock{ mBlock };
       sampleCount samples = mNumSamples;
-      for (unsigned int i = 0; i < srcNumBlocks; i++)
-         // AppendBlock may throw for limited disk space, if pasting from
-         // one project into another.
-         AppendBlock(pUseFactory, format,
-            newBlock, samples, srcBlock[i]);
+      if (!pUseFactory) {
+         newBlock.Append(srcBlock);
+         samples += addedLen;
+      }
+      else
+         for (const auto &block : srcBlock)
+            // AppendBlock may throw for limited disk space, if pasting from
+            // one project into another.
+            AppendBlock(pUseFactory, format,
+               newBlock, samples, block);
 
       CommitChangesIfConsistent
-         (newBlock, samples, wxT("Paste branch one"));
+         (newBlock, samples, wxT("Paste branch one"), numBlocks);
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
 
    const int b = (s == mNumSamples) ? mBlock.size() - 1 : FindBlock(s);
    wxASSERT((b >= 0) && (b < (int)numBlocks));
-   SeqBlock *const pBlock = &mBlock[b];
-   const auto length = pBlock->sb->GetSampleCount();
+   const SeqBlock splitBlock = mBlock[b];
+   const auto length = splitBlock.sb->GetSampleCount();
    const auto largerBlockLen = addedLen + length;
    // PRL: when insertion point is the first sample of a block,
    // and the following test fails, perhaps we could test
@@ -577,39 +591,38 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // Special case: we can fit all of the NEW samples inside of
       // one block!
 
-      SeqBlock &block = *pBlock;
       // largerBlockLen is not more than mMaxSamples...
       SampleBuffer buffer(largerBlockLen.as_size_t(), format);
 
       // ...and addedLen is not more than largerBlockLen
       auto sAddedLen = addedLen.as_size_t();
       // s lies within block:
-      auto splitPoint = ( s - block.start ).as_size_t();
-      Read(buffer.ptr(), format, block, 0, splitPoint, true);
+      auto splitPoint = ( s - splitBlock.start ).as_size_t();
+      Read(buffer.ptr(), format, splitBlock, 0, splitPoint, true);
       src->Get(0, buffer.ptr() + splitPoint*sampleSize,
                format, 0, sAddedLen, true);
       Read(buffer.ptr() + (splitPoint + sAddedLen) * sampleSize,
-           format, block,
+           format, splitBlock,
            splitPoint, length - splitPoint, true);
 
       // largerBlockLen is not more than mMaxSamples...
-      block.sb = mpFactory->Create(
+      auto sb = mpFactory->Create(
          buffer.ptr(),
          largerBlockLen.as_size_t(),
          format);
 
       // Don't make a duplicate array.  We can still give Strong-guarantee
-      // if we modify only one block in place.
-
-      // use No-fail-guarantee in remaining steps
-      for (unsigned int i = b + 1; i < numBlocks; i++)
-         mBlock[i].start += addedLen;
+      // if we modify only one block in place; the starts of later blocks
+      // follow from its length.
+      // Copies the array if it is shared, before anything changes
+      mBlock.Set(b, std::move(sb));
 
       mNumSamples += addedLen;
 
       // This consistency check won't throw, it asserts.
       // Proof that we kept consistency is not hard.
-      ConsistencyCheck(wxT("Paste branch two"), false);
+      ConsistencyCheck(mBlock, mMaxSamples, b, b + 1, mNumSamples,
+         wxT("Paste branch two"), false);
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
@@ -618,16 +631,12 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    // it's simplest to just lump all the data together
    // into one big block along with the split block,
    // then resplit it all
-   BlockArray newBlock;
-   newBlock.reserve(numBlocks + srcNumBlocks + 2);
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
+   BlockArray newBlock = mBlock.Slice(0, b);
 
-   SeqBlock &splitBlock = mBlock[b];
-   auto splitLen = splitBlock.sb->GetSampleCount();
+   auto splitLen = length;
    // s lies within splitBlock
    auto splitPoint = ( s - splitBlock.start ).as_size_t();
 
-   unsigned int i;
    if (srcNumBlocks <= 4) {
 
       // addedLen is at most four times maximum block size
@@ -644,7 +653,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
            splitLen - splitPoint, true);
 
       Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, splitBlock.start, sumBuffer.ptr(), sum);
+               newBlock, sumBuffer.ptr(), sum);
    } else {
 
       // The final case is that we're inserting at least five blocks.
@@ -671,14 +680,15 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
                format, 0, srcFirstTwoLen, true);
 
       Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, splitBlock.start, sampleBuffer.ptr(), leftLen);
+               newBlock, sampleBuffer.ptr(), leftLen);
 
-      for (i = 2; i < srcNumBlocks - 2; i++) {
-         const SeqBlock &block = srcBlock[i];
-         auto sb = ShareOrCopySampleBlock(
-            pUseFactory, format, block.sb );
-         newBlock.push_back(SeqBlock(sb, block.start + s));
-      }
+      if (!pUseFactory)
+         newBlock.Append(srcBlock.Slice(2, srcNumBlocks - 2));
+      else
+         for (auto iter = srcBlock.At(2), end = srcBlock.At(srcNumBlocks - 2);
+              iter != end; ++iter)
+            newBlock.push_back(ShareOrCopySampleBlock(
+               pUseFactory, format, iter->sb ));
 
       auto lastStart = penultimate.start;
       src->Get(srcNumBlocks - 2, sampleBuffer.ptr(), format,
@@ -687,16 +697,16 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
            splitBlock, splitPoint, rightSplit, true);
 
       Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, s + lastStart, sampleBuffer.ptr(), rightLen);
+               newBlock, sampleBuffer.ptr(), rightLen);
    }
 
-   // Copy remaining blocks to NEW block array and
+   // Join the remaining blocks to the NEW block array and
    // swap the NEW block array in for the old
-   for (i = b + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(addedLen));
+   const auto newEnd = newBlock.size();
+   newBlock.Append(mBlock.Slice(b + 1, numBlocks));
 
    CommitChangesIfConsistent
-      (newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
+      (newBlock, mNumSamples + addedLen, wxT("Paste branch three"), b, newEnd);
 
    mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
 }
@@ -729,18 +739,13 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
 
    sampleCount pos = 0;
 
-   // Could nBlocks overflow a size_t?  Not very likely.  You need perhaps
-   // 2 ^ 52 samples which is over 3000 years at 44.1 kHz.
-   auto nBlocks = (len + idealSamples - 1) / idealSamples;
-   sTrack.mBlock.reserve(nBlocks.as_size_t());
-
    const auto format = mSampleFormats.Stored();
    if (len >= idealSamples) {
       auto silentFile = factory.CreateSilent(
          idealSamples,
          format);
       while (len >= idealSamples) {
-         sTrack.mBlock.push_back(SeqBlock(silentFile, pos));
+         sTrack.mBlock.push_back(silentFile);
 
          pos += idealSamples;
          len -= idealSamples;
@@ -748,8 +753,8 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    }
    if (len != 0) {
       // len is not more than idealSamples:
-      sTrack.mBlock.push_back(SeqBlock(
-         factory.CreateSilent(len.as_size_t(), format), pos));
+      sTrack.mBlock.push_back(
+         factory.CreateSilent(len.as_size_t(), format));
       pos += len;
    }
 
@@ -767,12 +772,11 @@ void Sequence::AppendBlock( SampleBlockFactory *pFactory, sampleFormat format,
       THROW_INCONSISTENCY_EXCEPTION;
 
    auto sb = ShareOrCopySampleBlock( pFactory, format, b.sb );
-   SeqBlock newBlock(sb, mNumSamples);
 
-   // We can assume newBlock.sb is not null
+   // We can assume sb is not null
 
-   mBlock.push_back(newBlock);
-   mNumSamples += newBlock.sb->GetSampleCount();
+   mNumSamples += sb->GetSampleCount();
+   mBlock.push_back(std::move(sb));
 
    // Don't do a consistency check here because this
    // function gets called in an inner loop.
@@ -795,16 +799,14 @@ size_t Sequence::GetBestBlockSize(sampleCount start) const
       return mMaxSamples;
 
    int b = FindBlock(start);
-   int numBlocks = mBlock.size();
+   auto iter = mBlock.At(b), end = mBlock.end();
 
-   const SeqBlock &block = mBlock[b];
    // start is in block:
-   auto result = (block.start + block.sb->GetSampleCount() - start).as_size_t();
+   auto result = (iter->start + iter->sb->GetSampleCount() - start).as_size_t();
 
    decltype(result) length;
-   while(result < mMinSamples && b+1<numBlocks &&
-         ((length = mBlock[b+1].sb->GetSampleCount()) + result) <= mMaxSamples) {
-      b++;
+   while(result < mMinSamples && ++iter != end &&
+         ((length = iter->sb->GetSampleCount()) + result) <= mMaxSamples) {
       result += length;
    }
 
@@ -857,7 +859,23 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          }
       }
 
-      mBlock.push_back(wb);
+      // Starts are implied by the lengths of previous blocks, but check the
+      // saved start
+      auto &blocks = mBlock;
+      const auto numSamples = blocks.GetNumSamples();
+      if (wb.start != numSamples)
+      {
+         wxLogWarning(
+            wxT("Gap detected in project file.\n")
+            wxT("   Start (%s) for block file %lld is not one sample past end of previous block (%s).\n")
+            wxT("   Moving start so blocks are contiguous."),
+            // PRL:  Why bother with Internat when the above is just wxT?
+            Internat::ToString(wb.start.as_double(), 0),
+            wb.sb->GetBlockID(),
+            Internat::ToString(numSamples.as_double(), 0));
+         mErrorOpening = true;
+      }
+      blocks.push_back(std::move(wb.sb));
 
       return true;
    }
@@ -957,26 +975,8 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
 
    // Make sure that the sequence is valid.
 
-   // Make sure that start times and lengths are consistent
-   sampleCount numSamples = 0;
-   for (unsigned b = 0, nn = mBlock.size(); b < nn;  b++)
-   {
-      SeqBlock &block = mBlock[b];
-      if (block.start != numSamples)
-      {
-         wxLogWarning(
-            wxT("Gap detected in project file.\n")
-            wxT("   Start (%s) for block file %lld is not one sample past end of previous block (%s).\n")
-            wxT("   Moving start so blocks are contiguous."),
-            // PRL:  Why bother with Internat when the above is just wxT?
-            Internat::ToString(block.start.as_double(), 0),
-            block.sb->GetBlockID(),
-            Internat::ToString(numSamples.as_double(), 0));
-         block.start = numSamples;
-         mErrorOpening = true;
-      }
-      numSamples += block.sb->GetSampleCount();
-   }
+   // Starts of blocks were checked as they were read, and are contiguous
+   const auto numSamples = mBlock.GetNumSamples();
 
    if (mNumSamples != numSamples)
    {
@@ -1004,8 +1004,6 @@ XMLTagHandler *Sequence::HandleXMLChild(const std::string_view& tag)
 void Sequence::WriteXML(XMLWriter &xmlFile) const
 // may throw
 {
-   unsigned int b;
-
    xmlFile.StartTag(Sequence_tag);
 
    xmlFile.WriteAttr(MaxSamples_attr, mMaxSamples);
@@ -1016,8 +1014,7 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
       static_cast<size_t>( mSampleFormats.Effective() ));
    xmlFile.WriteAttr(NumSamples_attr, mNumSamples.as_long_long() );
 
-   for (b = 0; b < mBlock.size(); b++) {
-      const SeqBlock &bb = mBlock[b];
+   for (const auto &bb : mBlock) {
 
       // See http://bugzilla.audacityteam.org/show_bug.cgi?id=451.
       if (bb.sb->GetSampleCount() > mMaxSamples)
@@ -1052,51 +1049,23 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
    xmlFile.EndTag(Sequence_tag);
 }
 
+bool Sequence::WritesSameXML(const Sequence &other) const
+{
+   return mMaxSamples == other.mMaxSamples &&
+      mSampleFormats.Stored() == other.mSampleFormats.Stored() &&
+      mSampleFormats.Effective() == other.mSampleFormats.Effective() &&
+      mNumSamples == other.mNumSamples &&
+      mBlock.Shares(other.mBlock);
+}
+
 int Sequence::FindBlock(sampleCount pos) const
 {
    wxASSERT(pos >= 0 && pos < mNumSamples);
 
-   if (pos == 0)
-      return 0;
-
-   int numBlocks = mBlock.size();
-
-   size_t lo = 0, hi = numBlocks, guess;
-   sampleCount loSamples = 0, hiSamples = mNumSamples;
-
-   while (true) {
-      //this is not a binary search, but a
-      //dictionary search where we guess something smarter than the binary division
-      //of the unsearched area, since samples are usually proportional to block file number.
-      const double frac = (pos - loSamples).as_double() /
-         (hiSamples - loSamples).as_double();
-      guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
-      const SeqBlock &block = mBlock[guess];
-
-      wxASSERT(block.sb->GetSampleCount() > 0);
-      wxASSERT(lo <= guess && guess < hi && lo < hi);
-
-      if (pos < block.start) {
-         wxASSERT(lo != guess);
-         hi = guess;
-         hiSamples = block.start;
-      }
-      else {
-         const sampleCount nextStart = block.start + block.sb->GetSampleCount();
-         if (pos < nextStart)
-            break;
-         else {
-            wxASSERT(guess < hi - 1);
-            lo = guess + 1;
-            loSamples = nextStart;
-         }
-      }
-   }
-
-   const int rval = guess;
-   wxASSERT(rval >= 0 && rval < numBlocks &&
-            pos >= mBlock[rval].start &&
-            pos < mBlock[rval].start + mBlock[rval].sb->GetSampleCount());
+   // Logarithmic search of the lengths stored in the tree; this does not
+   // visit the sample blocks
+   const int rval = mBlock.FindBlock(pos);
+   wxASSERT(rval >= 0 && rval < (int)mBlock.size());
 
    return rval;
 }
@@ -1133,10 +1102,10 @@ AudioSegmentSampleView Sequence::GetFloatSampleView(
    // no narrowing possible.
    const auto sequenceOffset = (start - GetBlockStart(start)).as_size_t();
    auto cursor = start;
-   while (cursor < start + length)
+   for (auto iter = mBlock.At(FindBlock(start)); cursor < start + length;
+        ++iter)
    {
-      const auto b = FindBlock(cursor);
-      const SeqBlock& block = mBlock[b];
+      const SeqBlock& block = *iter;
       blockViews.push_back(block.sb->GetFloatSampleView(mayThrow));
       cursor = block.start + block.sb->GetSampleCount();
    }
@@ -1186,8 +1155,8 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
    sampleCount start, size_t len, bool mayThrow) const
 {
    bool result = true;
-   while (len) {
-      const SeqBlock &block = mBlock[b];
+   for (auto iter = mBlock.At(b); len; ++iter) {
+      const SeqBlock &block = *iter;
       // start is in block
       const auto bstart = (start - block.start).as_size_t();
       // bstart is not more than block length
@@ -1198,7 +1167,6 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
 
       len -= blen;
       buffer += (blen * SAMPLE_SIZE(format));
-      b++;
       start += blen;
    }
    return result;
@@ -1228,18 +1196,20 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
    }
 
    int b = FindBlock(start);
-   BlockArray newBlock;
-   std::copy( mBlock.begin(), mBlock.begin() + b, std::back_inserter(newBlock) );
+   const auto firstNew = b;
+   BlockArray newBlock = mBlock.Slice(0, b);
 
-   while (len > 0
+   for (auto iter = mBlock.At(b);
+      len > 0
       // Redundant termination condition,
       // but it guards against infinite loop in case of inconsistencies
       // (too-small files, not yet seen?)
       // that cause the loop to make no progress because blen == 0
-      && b < (int)size
+      && b < (int)size;
+      ++iter
    ) {
-      newBlock.push_back( mBlock[b] );
-      SeqBlock &block = newBlock.back();
+      const SeqBlock &block = *iter;
+      SeqBlock::SampleBlockPtr sb;
       // start is within block
       const auto bstart = ( start - block.start ).as_size_t();
       const auto fileLength = block.sb->GetSampleCount();
@@ -1291,7 +1261,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
          else
             ClearSamples(scratch.ptr(), dstFormat, bstart, blen);
 
-         block.sb = factory.Create(
+         sb = factory.Create(
             scratch.ptr(),
             fileLength,
             dstFormat);
@@ -1299,10 +1269,11 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       else {
          // Avoid reading the disk when the replacement is total
          if (useBuffer)
-            block.sb = factory.Create(useBuffer, fileLength, dstFormat);
+            sb = factory.Create(useBuffer, fileLength, dstFormat);
          else
-            block.sb = factory.CreateSilent(fileLength, dstFormat);
+            sb = factory.CreateSilent(fileLength, dstFormat);
       }
+      newBlock.push_back(std::move(sb));
 
       // blen might be zero for inconsistent Sequence...
       if( buffer )
@@ -1315,9 +1286,10 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       b++;
    }
 
-   std::copy( mBlock.begin() + b, mBlock.end(), std::back_inserter(newBlock) );
+   newBlock.Append(mBlock.Slice(b, size));
 
-   CommitChangesIfConsistent( newBlock, mNumSamples, wxT("SetSamples") );
+   CommitChangesIfConsistent(
+      newBlock, mNumSamples, wxT("SetSamples"), firstNew, b );
 
    mSampleFormats.UpdateEffective(effectiveFormat);
 }
@@ -1358,7 +1330,7 @@ void Sequence::AppendSharedBlock(const SeqBlock::SampleBlockPtr &pBlock)
       THROW_INCONSISTENCY_EXCEPTION;
 
    BlockArray newBlock;
-   newBlock.emplace_back( pBlock, mNumSamples );
+   newBlock.push_back( pBlock );
    auto newNumSamples = mNumSamples + len;
 
    AppendBlocksIfConsistent(newBlock, false,
@@ -1447,8 +1419,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
 
    // If the last block is not full, we need to add samples to it
    int numBlocks = mBlock.size();
-   SeqBlock *pLastBlock;
-   decltype(pLastBlock->sb->GetSampleCount()) length;
+   SeqBlock lastBlock;
+   decltype(lastBlock.sb->GetSampleCount()) length;
    size_t bufferSize = mMaxSamples;
    const auto dstFormat = mSampleFormats.Stored();
    SampleBuffer buffer2(bufferSize, dstFormat);
@@ -1456,9 +1428,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    if (coalesce &&
        numBlocks > 0 &&
        (length =
-        (pLastBlock = &mBlock.back())->sb->GetSampleCount()) < mMinSamples) {
+        (lastBlock = mBlock.back()).sb->GetSampleCount()) < mMinSamples) {
       // Enlarge a sub-minimum block at the end
-      const SeqBlock &lastBlock = *pLastBlock;
       const auto addLen = std::min(mMaxSamples - length, len);
 
       // Reading same format as was saved before causes no dithering
@@ -1475,9 +1446,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
          buffer2.ptr(),
          newLastBlockLen,
          dstFormat);
-      SeqBlock newLastBlock(pBlock, lastBlock.start);
-
-      newBlock.push_back( newLastBlock );
+      newBlock.push_back( pBlock );
 
       len -= addLen;
       newNumSamples += addLen;
@@ -1503,7 +1472,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
          pBlock = factory.Create(buffer2.ptr(), addedLen, dstFormat);
       }
 
-      newBlock.push_back(SeqBlock(pBlock, newNumSamples));
+      newBlock.push_back(pBlock);
 
       buffer += addedLen * SAMPLE_SIZE(format);
       newNumSamples += addedLen;
@@ -1552,26 +1521,20 @@ void Sequence::Flush()
 
 void Sequence::Blockify(SampleBlockFactory &factory,
                         size_t mMaxSamples, sampleFormat mSampleFormat,
-                        BlockArray &list, sampleCount start,
+                        BlockArray &list,
                         constSamplePtr buffer, size_t len)
 {
    if (len <= 0)
       return;
 
    auto num = (len + (mMaxSamples - 1)) / mMaxSamples;
-   list.reserve(list.size() + num);
 
    for (decltype(num) i = 0; i < num; i++) {
-      SeqBlock b;
-
       const auto offset = i * len / num;
-      b.start = start + offset;
       int newLen = ((i + 1) * len / num) - offset;
       auto bufStart = buffer + (offset * SAMPLE_SIZE(mSampleFormat));
 
-      b.sb = factory.Create(bufStart, newLen, mSampleFormat);
-
-      list.push_back(b);
+      list.push_back(factory.Create(bufStart, newLen, mSampleFormat));
    }
 }
 
@@ -1594,8 +1557,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    const auto format = mSampleFormats.Stored();
    auto sampleSize = SAMPLE_SIZE(format);
 
-   SeqBlock *pBlock;
-   decltype(pBlock->sb->GetSampleCount()) length;
+   SeqBlock block;
+   decltype(block.sb->GetSampleCount()) length;
 
    // One buffer for reuse in various branches here
    SampleBuffer scratch;
@@ -1606,8 +1569,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // block and the resulting length is not too small, perform the
    // deletion within this block:
    if (b0 == b1 &&
-       (length = (pBlock = &mBlock[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
-      SeqBlock &b = *pBlock;
+       (length = (block = mBlock[b0]).sb->GetSampleCount()) - len >= mMinSamples) {
+      const SeqBlock &b = block;
       // start is within block
       auto pos = ( start - b.start ).as_size_t();
 
@@ -1628,32 +1591,28 @@ void Sequence::Delete(sampleCount start, sampleCount len)
            // is not more than the length of the block
            ( pos + len ).as_size_t(), newLen - pos, true);
 
-      b.sb = factory.Create(scratch.ptr(), newLen, format);
+      auto sb = factory.Create(scratch.ptr(), newLen, format);
 
       // Don't make a duplicate array.  We can still give Strong-guarantee
-      // if we modify only one block in place.
+      // if we modify only one block in place; the starts of later blocks
+      // follow from its length.
+      // Copies the array if it is shared, before anything changes
+      mBlock.Set(b0, std::move(sb));
 
       // use No-fail-guarantee in remaining steps
 
-      for (unsigned int j = b0 + 1; j < numBlocks; j++)
-         mBlock[j].start -= len;
-
       mNumSamples -= len;
 
       // This consistency check won't throw, it asserts.
       // Proof that we kept consistency is not hard.
-      ConsistencyCheck(wxT("Delete - branch one"), false);
+      ConsistencyCheck(mBlock, mMaxSamples, b0, b0 + 1, mNumSamples,
+         wxT("Delete - branch one"), false);
       return;
    }
 
-   // Create a NEW array of blocks
-   BlockArray newBlock;
-   newBlock.reserve(numBlocks - (b1 - b0) + 2);
-
-   // Copy the blocks before the deletion point over to
-   // the NEW array
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
-   unsigned int i;
+   // Create a NEW array of blocks, sharing the blocks before the deletion
+   // point
+   BlockArray newBlock = mBlock.Slice(0, b0);
 
    // First grab the samples in block b0 before the deletion point
    // into preBuffer.  If this is enough samples for its own block,
@@ -1672,7 +1631,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
          auto pFile =
             factory.Create(scratch.ptr(), preBufferLen, format);
 
-         newBlock.push_back(SeqBlock(pFile, preBlock.start));
+         newBlock.push_back(pFile);
       } else {
          const SeqBlock &prepreBlock = mBlock[b0 - 1];
          const auto prepreLen = prepreBlock.sb->GetSampleCount();
@@ -1689,7 +1648,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.pop_back();
          Blockify(*mpFactory, mMaxSamples, format,
-                  newBlock, prepreBlock.start, scratch.ptr(), sum);
+                  newBlock, scratch.ptr(), sum);
       }
    }
    else {
@@ -1718,9 +1677,9 @@ void Sequence::Delete(sampleCount start, sampleCount len)
          auto file =
             factory.Create(scratch.ptr(), postBufferLen, format);
 
-         newBlock.push_back(SeqBlock(file, start));
+         newBlock.push_back(file);
       } else {
-         SeqBlock &postpostBlock = mBlock[b1 + 1];
+         const SeqBlock &postpostBlock = mBlock[b1 + 1];
          const auto postpostLen = postpostBlock.sb->GetSampleCount();
          const auto sum = postpostLen + postBufferLen;
 
@@ -1734,7 +1693,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
               postpostBlock, 0, postpostLen, true);
 
          Blockify(*mpFactory, mMaxSamples, format,
-                  newBlock, start, scratch.ptr(), sum);
+                  newBlock, scratch.ptr(), sum);
          b1++;
       }
    }
@@ -1743,21 +1702,23 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       // right on the end of a block.
    }
 
-   // Copy the remaining blocks over from the old array
-   for (i = b1 + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(-len));
+   // Join the remaining blocks of the old array
+   const auto newEnd = newBlock.size();
+   newBlock.Append(mBlock.Slice(b1 + 1, numBlocks));
 
-   CommitChangesIfConsistent
-      (newBlock, mNumSamples - len, wxT("Delete - branch two"));
+   // New blocks may begin before b0, if the previous block was combined
+   CommitChangesIfConsistent(newBlock, mNumSamples - len,
+      wxT("Delete - branch two"), b0 > 0 ? b0 - 1 : 0, newEnd);
 }
 
 void Sequence::ConsistencyCheck(const wxChar *whereStr, bool mayThrow) const
 {
-   ConsistencyCheck(mBlock, mMaxSamples, 0, mNumSamples, whereStr, mayThrow);
+   ConsistencyCheck(mBlock, mMaxSamples, 0, mBlock.size(), mNumSamples,
+      whereStr, mayThrow);
 }
 
 void Sequence::ConsistencyCheck
-   (const BlockArray &mBlock, size_t maxSamples, size_t from,
+   (const BlockArray &mBlock, size_t maxSamples, size_t from, size_t to,
     sampleCount mNumSamples, const wxChar *whereStr,
     bool WXUNUSED(mayThrow))
 {
@@ -1765,28 +1726,20 @@ void Sequence::ConsistencyCheck
    // gives a little more discrimination
    std::optional<InconsistencyException> ex;
 
-   unsigned int numBlocks = mBlock.size();
-
-   unsigned int i;
-   sampleCount pos = from < numBlocks ? mBlock[from].start : mNumSamples;
-   if ( from == 0 && pos != 0 )
-      ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-
-   for (i = from; !ex && i < numBlocks; i++) {
-      const SeqBlock &seqBlock = mBlock[i];
-      if (pos != seqBlock.start)
-         ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-
+   // Starts of blocks are implied by the lengths of previous blocks and need
+   // no check
+   for (auto iter = mBlock.At(from), end = mBlock.At(to);
+        !ex && iter != end; ++iter) {
+      const SeqBlock &seqBlock = *iter;
       if ( seqBlock.sb ) {
          const auto length = seqBlock.sb->GetSampleCount();
          if (length > maxSamples)
             ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-         pos += length;
       }
       else
          ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
    }
-   if ( !ex && pos != mNumSamples )
+   if ( !ex && mBlock.GetNumSamples() != mNumSamples )
       ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
 
    if ( ex )
@@ -1808,14 +1761,15 @@ void Sequence::ConsistencyCheck
 }
 
 void Sequence::CommitChangesIfConsistent
-   (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr)
+   (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr,
+    size_t from, size_t to)
 {
-   ConsistencyCheck( newBlock, mMaxSamples, 0, numSamples, whereStr ); // may throw
+   ConsistencyCheck( newBlock, mMaxSamples, from, to, numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
 
-   mBlock.swap(newBlock);
+   mBlock = std::move(newBlock);
    mNumSamples = numSamples;
 }
 
@@ -1829,31 +1783,28 @@ void Sequence::AppendBlocksIfConsistent
    if (additionalBlocks.empty())
       return;
 
-   bool tmpValid = false;
-   SeqBlock tmp;
+   auto &blocks = mBlock;
 
-   if ( replaceLast && ! mBlock.empty() ) {
-      tmp = mBlock.back(), tmpValid = true;
-      mBlock.pop_back();
-   }
+   // Shares the tree, so that changes copy only the nodes they visit
+   const auto saved = blocks;
 
-   auto prevSize = mBlock.size();
+   if ( replaceLast && ! blocks.empty() )
+      blocks.pop_back();
+
+   auto prevSize = blocks.size();
 
    bool consistent = false;
    auto cleanup = finally( [&] {
-      if ( !consistent ) {
-         mBlock.resize( prevSize );
-         if ( tmpValid )
-            mBlock.push_back( tmp );
-      }
+      if ( !consistent )
+         blocks = saved;
    } );
 
-   std::copy( additionalBlocks.begin(), additionalBlocks.end(),
-              std::back_inserter( mBlock ) );
+   blocks.Append( additionalBlocks );
 
    // Check consistency only of the blocks that were added,
    // avoiding quadratic time for repeated checking of repeating appends
-   ConsistencyCheck( mBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
+   ConsistencyCheck( blocks, mMaxSamples, prevSize, blocks.size(),
+      numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
@@ -1865,11 +1816,12 @@ void Sequence::AppendBlocksIfConsistent
 void Sequence::DebugPrintf
    (const BlockArray &mBlock, sampleCount mNumSamples, wxString *dest)
 {
-   unsigned int i;
+   unsigned int i = 0;
    decltype(mNumSamples) pos = 0;
 
-   for (i = 0; i < mBlock.size(); i++) {
-      const SeqBlock &seqBlock = mBlock[i];
+   for (auto iter = mBlock.begin(), end = mBlock.end(); iter != end;
+        ++iter, ++i) {
+      const SeqBlock &seqBlock = *iter;
       *dest += wxString::Format
          (wxT("   Block %3u: start %8lld, len %8lld, refs %ld, id %lld"),
           i,
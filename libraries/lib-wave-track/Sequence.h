@@ -14,7 +14,9 @@
 
 #include <vector>
 #include <functional>
+#include <limits>
 
+#include "BlockArray.h"
 #include "SampleFormat.h"
 #include "XMLTagHandler.h"
 
@@ -25,29 +27,6 @@ class SampleBlock;
 class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
 
-// This is an internal data structure!  For advanced use only.
-class SeqBlock {
- public:
-   using SampleBlockPtr = std::shared_ptr<SampleBlock>;
-   SampleBlockPtr sb;
-   ///the sample in the global wavetrack that this block starts at.
-   sampleCount start;
-
-   SeqBlock()
-      : sb{}, start(0)
-   {}
-
-   SeqBlock(const SampleBlockPtr &sb_, sampleCount start_)
-      : sb(sb_), start(start_)
-   {}
-
-   // Construct a SeqBlock with changed start, same file
-   SeqBlock Plus(sampleCount delta) const
-   {
-      return SeqBlock(sb, start + delta);
-   }
-};
-class BlockArray : public std::vector<SeqBlock> {};
 using BlockPtrArray = std::vector<SeqBlock*>; // non-owning pointers
 
 class WAVE_TRACK_API Sequence final : public XMLTagHandler{
@@ -185,6 +164,9 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    void HandleXMLEndTag(const std::string_view& tag) override;
    XMLTagHandler *HandleXMLChild(const std::string_view& tag) override;
    void WriteXML(XMLWriter &xmlFile) const /* not override */;
+   //! Whether WriteXML() certainly makes the same calls for both sequences;
+   //! true only if they share the block array
+   bool WritesSameXML(const Sequence &other) const;
 
    bool GetErrorOpening() const { return mErrorOpening; }
 
@@ -229,7 +211,7 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    // you're doing!
    //
 
-   BlockArray &GetBlockArray() { return mBlock; }
+   //! Read only; Sequence's own members change it
    const BlockArray &GetBlockArray() const { return mBlock; }
 
    size_t GetAppendBufferLen() const { return mAppendBufferLen; }
@@ -249,7 +231,9 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
 
    SampleBlockFactoryPtr mpFactory;
 
-   BlockArray    mBlock;
+   //! Shares its nodes with copies of the sequence until either is changed, so
+   //! that copies for undo history cost little
+   BlockArray mBlock;
    SampleFormats  mSampleFormats;
 
    // Not size_t!  May need to be large:
@@ -288,7 +272,6 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
                         size_t maxSamples,
                         sampleFormat format,
                         BlockArray &list,
-                        sampleCount start,
                         constSamplePtr buffer,
                         size_t len);
 
@@ -321,8 +304,10 @@ public:
       (const BlockArray &block, sampleCount numSamples, wxString *dest);
 
 private:
+   // Checks the blocks from index from up to but not including to, and the
+   // total length
    static void ConsistencyCheck
-      (const BlockArray &block, size_t maxSamples, size_t from,
+      (const BlockArray &block, size_t maxSamples, size_t from, size_t to,
        sampleCount numSamples, const wxChar *whereStr,
        bool mayThrow = true);
 
@@ -330,8 +315,11 @@ private:
    // They either throw because final consistency check fails, or swap the
    // changed contents into place.
 
+   // Blocks outside of the range from, to are shared with the old array and
+   // are not checked again, so that edits take logarithmic time
    void CommitChangesIfConsistent
-      (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr);
+      (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr,
+       size_t from = 0, size_t to = std::numeric_limits<size_t>::max());
 
    void AppendBlocksIfConsistent
       (BlockArray &additionalBlocks, bool replaceLast,
@@ -28,6 +28,7 @@
 #include "Sequence.h"
 #include "TimeAndPitchInterface.h"
 #include "UserException.h"
+#include "XMLWriter.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -417,7 +418,9 @@ void WaveClip::SetEnvelope(std::unique_ptr<Envelope> p)
 const BlockArray* WaveClip::GetSequenceBlockArray(size_t ii) const
 {
    assert(ii < NChannels());
-   return &mSequences[ii]->GetBlockArray();
+   // Const access, which doesn't unshare the array
+   const Sequence &sequence = *mSequences[ii];
+   return &sequence.GetBlockArray();
 }
 
 size_t WaveClip::GetAppendBufferLen(size_t iChannel) const
@@ -694,7 +697,8 @@ size_t WaveClip::CountBlocks() const
 {
    return std::accumulate(mSequences.begin(), mSequences.end(), size_t{},
    [](size_t acc, auto &pSequence){
-      return acc + pSequence->GetBlockArray().size(); });
+      const Sequence &sequence = *pSequence;
+      return acc + sequence.GetBlockArray().size(); });
 }
 
 //! A hint for sizing of well aligned fetches
@@ -734,9 +738,21 @@ constSamplePtr WaveClip::GetAppendBuffer(size_t ii) const
 
 void WaveClip::MarkChanged() noexcept // NOFAIL-GUARANTEE
 {
+   mContentVersion = NewContentVersion();
    Attachments::ForEach(std::mem_fn(&WaveClipListener::MarkChanged));
 }
 
+size_t WaveClip::NewContentVersion() noexcept
+{
+   static std::atomic<size_t> lastVersion { 0 };
+   return ++lastVersion;
+}
+
+size_t WaveClip::GetContentVersion() const
+{
+   return mContentVersion;
+}
+
 std::pair<float, float> WaveClip::GetMinMax(size_t ii,
    double t0, double t1, bool mayThrow) const
 {
@@ -1073,6 +1089,19 @@ void WaveClip::WriteXML(size_t ii, XMLWriter &xmlFile) const
       // problems, don't save me.
       return;
 
+   WriteXMLStart(xmlFile);
+
+   mSequences[ii]->WriteXML(xmlFile);
+   mEnvelope->WriteXML(xmlFile);
+
+   for (const auto &clip: mCutLines)
+      clip->WriteXML(ii, xmlFile);
+
+   xmlFile.EndTag(WaveClip_tag);
+}
+
+void WaveClip::WriteXMLStart(XMLWriter &xmlFile) const
+{
    xmlFile.StartTag(WaveClip_tag);
    xmlFile.WriteAttr(Offset_attr, mSequenceOffset, 8);
    xmlFile.WriteAttr(TrimLeft_attr, mTrimLeft, 8);
@@ -1086,14 +1115,40 @@ void WaveClip::WriteXML(size_t ii, XMLWriter &xmlFile) const
    Attachments::ForEach([&](const WaveClipListener &listener){
       listener.WriteXMLAttributes(xmlFile);
    });
+}
 
-   mSequences[ii]->WriteXML(xmlFile);
-   mEnvelope->WriteXML(xmlFile);
+bool WaveClip::WritesSameXML(size_t ii, const WaveClip &other) const
+{
+   assert(ii < NChannels());
 
-   for (const auto &clip: mCutLines)
-      clip->WriteXML(ii, xmlFile);
+   // See the test for emptiness in WriteXML()
+   const auto empty = GetSequenceSamplesCount() <= 0;
+   if (empty != (other.GetSequenceSamplesCount() <= 0))
+      return false;
+   if (empty)
+      return true;
+   if (ii >= other.NChannels())
+      return false;
 
-   xmlFile.EndTag(WaveClip_tag);
+   XMLCallRecorder start, otherStart;
+   WriteXMLStart(start);
+   other.WriteXMLStart(otherStart);
+   if (start.GetRecord() != otherStart.GetRecord() ||
+       !mSequences[ii]->WritesSameXML(*other.mSequences[ii]))
+      return false;
+
+   // Envelopes are small enough to record whole
+   XMLCallRecorder envelope, otherEnvelope;
+   mEnvelope->WriteXML(envelope);
+   other.mEnvelope->WriteXML(otherEnvelope);
+   if (envelope.GetRecord() != otherEnvelope.GetRecord())
+      return false;
+
+   return std::equal(mCutLines.begin(), mCutLines.end(),
+      other.mCutLines.begin(), other.mCutLines.end(),
+      [ii](const auto &pCutLine, const auto &pOtherCutLine) {
+         return pCutLine->WritesSameXML(ii, *pOtherCutLine);
+      });
 }
 
 /*! @excsafety{Strong} */
@@ -1804,6 +1859,7 @@ sampleCount WaveClip::GetVisibleSampleCount() const
 void WaveClip::SetTrimLeft(double trim)
 {
     mTrimLeft = std::max(.0, trim);
+    mContentVersion = NewContentVersion();
 }
 
 double WaveClip::GetTrimLeft() const noexcept
@@ -1814,6 +1870,7 @@ double WaveClip::GetTrimLeft() const noexcept
 void WaveClip::SetTrimRight(double trim)
 {
     mTrimRight = std::max(.0, trim);
+    mContentVersion = NewContentVersion();
 }
 
 double WaveClip::GetTrimRight() const noexcept
@@ -1855,12 +1912,14 @@ void WaveClip::TrimLeftTo(double to)
    mTrimLeft =
       std::clamp(to, SnapToTrackSample(mSequenceOffset), GetPlayEndTime()) -
       mSequenceOffset;
+   mContentVersion = NewContentVersion();
 }
 
 void WaveClip::TrimRightTo(double to)
 {
    const auto endTime = SnapToTrackSample(GetSequenceEndTime());
    mTrimRight = endTime - std::clamp(to, GetPlayStartTime(), endTime);
+   mContentVersion = NewContentVersion();
 }
 
 double WaveClip::GetSequenceStartTime() const noexcept
@@ -22,6 +22,7 @@
 
 #include <wx/longlong.h>
 
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <optional>
@@ -373,6 +374,9 @@ public:
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const override;
 
+   //! Changed by MarkChanged() and by trimming
+   size_t GetContentVersion() const override;
+
    // Resample clip. This also will set the rate, but without changing
    // the length of the clip
    void Resample(int rate, BasicUI::ProgressDialog *progress = nullptr);
@@ -767,6 +771,12 @@ public:
     @pre `ii < NChannels()`
     */
    void WriteXML(size_t ii, XMLWriter &xmlFile) const;
+   //! Whether WriteXML() certainly makes the same calls for both clips
+   /*!
+    @param ii identifies the channel
+    @pre `ii < NChannels()`
+    */
+   bool WritesSameXML(size_t ii, const WaveClip &other) const;
 
    // AWD, Oct 2009: for pasting whitespace at the end of selection
    bool GetIsPlaceholder() const { return mIsPlaceholder; }
@@ -863,6 +873,8 @@ public:
             bool copyCutlines, CreateToken token);
 
 private:
+   //! The start tag and attributes that WriteXML() writes
+   void WriteXMLStart(XMLWriter &xmlFile) const;
    static void TransferSequence(WaveClip &origClip, WaveClip &newClip);
    static void FixSplitCutlines(
       WaveClipHolders &myCutlines, WaveClipHolders &newCutlines);
@@ -872,6 +884,7 @@ private:
    //! Called by mutating operations; notifies listeners
    /*! @excsafety{No-fail} */
    void MarkChanged() noexcept;
+   static size_t NewContentVersion() noexcept;
 
    // Always gives non-negative answer, not more than sample sequence length
    // even if t0 really falls outside that range
@@ -948,6 +961,8 @@ private:
 
    PitchAndSpeedPreset mPitchAndSpeedPreset { PitchAndSpeedPreset::Default };
    int mCentShift { 0 };
+   //! Atomic, because playback and its renderers read it
+   std::atomic<size_t> mContentVersion { NewContentVersion() };
 
    // Used in GetStretchRatio which computes the factor, by which the sample
    // interval is multiplied, to get a realtime duration.
@@ -61,6 +61,7 @@ from the project that will own the track.
 #include "QualitySettings.h"
 #include "SyncLock.h"
 #include "TimeWarper.h"
+#include "XMLWriter.h"
 
 
 #include "InconsistencyException.h"
@@ -2465,7 +2466,18 @@ void WaveTrack::WriteOneXML(const WaveChannel &channel, XMLWriter &xmlFile,
 {
    // Track data has always been written using channel-major iteration.
    // Do it still this way for compatibility.
+   WriteOneXMLStart(channel, xmlFile, iChannel, nChannels);
 
+   for (const auto &clip : channel.Intervals())
+      clip->WriteXML(xmlFile);
+
+   xmlFile.EndTag(WaveTrack_tag);
+}
+
+void WaveTrack::WriteOneXMLStart(const WaveChannel &channel,
+   XMLWriter &xmlFile, size_t iChannel, size_t nChannels)
+// may throw
+{
    // Some values don't vary independently in channels but have been written
    // redundantly for each channel.  Keep doing this in 3.4 and later in case
    // a project is opened in an earlier version.
@@ -2511,11 +2523,34 @@ void WaveTrack::WriteOneXML(const WaveChannel &channel, XMLWriter &xmlFile,
    // NOT written redundantly any more
    if (iChannel == 0)
       WaveTrackIORegistry::Get().CallWriters(track, xmlFile);
+}
 
-   for (const auto &clip : channel.Intervals())
-      clip->WriteXML(xmlFile);
+bool WaveTrack::WritesSameXML(const WaveTrack &other) const
+{
+   const auto channels = Channels();
+   const auto otherChannels = other.Channels();
+   const auto nChannels = channels.size();
+   const auto &clips = NarrowClips();
+   const auto &otherClips = other.NarrowClips();
+   if (otherChannels.size() != nChannels ||
+       otherClips.size() != clips.size())
+      return false;
 
-   xmlFile.EndTag(WaveTrack_tag);
+   size_t iChannel = 0;
+   auto pOtherChannel = otherChannels.begin();
+   for (const auto pChannel : channels) {
+      XMLCallRecorder start, otherStart;
+      WriteOneXMLStart(*pChannel, start, iChannel, nChannels);
+      WriteOneXMLStart(**pOtherChannel++, otherStart, iChannel, nChannels);
+      if (start.GetRecord() != otherStart.GetRecord())
+         return false;
+      // WriteOneXML() visits the channels of the clips in this order
+      for (size_t ii = 0; ii < clips.size(); ++ii)
+         if (!clips[ii]->WritesSameXML(iChannel, *otherClips[ii]))
+            return false;
+      ++iChannel;
+   }
+   return true;
 }
 
 std::optional<TranslatableString> WaveTrack::GetErrorOpening() const
@@ -2844,42 +2879,38 @@ void WaveChannel::GetEnvelopeValues(
    return GetTrack().GetEnvelopeValues(buffer, bufferLen, t0, backwards);
 }
 
-void WaveTrack::GetEnvelopeValues(
-   double* buffer, size_t bufferLen, double t0, bool backwards) const
+bool WaveChannel::GetEnvelopeSegments(
+   EnvelopeSegments& segments, size_t bufferLen, double t0,
+   bool backwards, size_t maxSize) const
 {
-   auto pTrack = this;
-   if (!pTrack)
-      return;
-
-   if (backwards)
-      t0 -= bufferLen / pTrack->GetRate();
-   // The output buffer corresponds to an unbroken span of time which the callers expect
-   // to be fully valid.  As clips are processed below, the output buffer is updated with
-   // envelope values from any portion of a clip, start, end, middle, or none at all.
-   // Since this does not guarantee that the entire buffer is filled with values we need
-   // to initialize the entire buffer to a default value.
-   //
-   // This does mean that, in the cases where a usable clip is located, the buffer value will
-   // be set twice.  Unfortunately, there is no easy way around this since the clips are not
-   // stored in increasing time order.  If they were, we could just track the time as the
-   // buffer is filled.
-   for (decltype(bufferLen) i = 0; i < bufferLen; i++)
-   {
-      buffer[i] = 1.0;
-   }
+   return GetTrack().GetEnvelopeSegments(
+      segments, bufferLen, t0, backwards, maxSize);
+}
 
+namespace {
+//! Visit each clip envelope with the sub-range of a buffer of envelope values,
+//! starting at time t0, that its clip covers
+/*!
+ @param visit called with the envelope, offset and length of the sub-range,
+    and the time at its start
+ @return false if the visit stopped early because of a clip of no samples
+ */
+template<typename Visit>
+bool VisitClipEnvelopes(
+   const WaveTrack &track, size_t bufferLen, double t0, const Visit &visit)
+{
    double startTime = t0;
-   const auto rate = pTrack->GetRate();
+   const auto rate = track.GetRate();
    auto tstep = 1.0 / rate;
    double endTime = t0 + tstep * bufferLen;
-   for (const auto &clip: pTrack->Intervals())
+   for (const auto &clip: track.Intervals())
    {
       // IF clip intersects startTime..endTime THEN...
       auto dClipStartTime = clip->GetPlayStartTime();
       auto dClipEndTime = clip->GetPlayEndTime();
       if ((dClipStartTime < endTime) && (dClipEndTime > startTime))
       {
-         auto rbuf = buffer;
+         size_t offset = 0;
          auto rlen = bufferLen;
          auto rt0 = t0;
 
@@ -2889,7 +2920,7 @@ void WaveTrack::GetEnvelopeValues(
             // (endTime - startTime) which is bufferLen:
             auto nDiff = (sampleCount)floor((dClipStartTime - rt0) * rate + 0.5);
             auto snDiff = nDiff.as_size_t();
-            rbuf += snDiff;
+            offset += snDiff;
             wxASSERT(snDiff <= rlen);
             rlen -= snDiff;
             rt0 = dClipStartTime;
@@ -2900,7 +2931,7 @@ void WaveTrack::GetEnvelopeValues(
             auto nClipLen = clip->GetPlayEndSample() - clip->GetPlayStartSample();
 
             if (nClipLen <= 0) // Testing for bug 641, this problem is consistently '== 0', but doesn't hurt to check <.
-               return;
+               return false;
 
             // This check prevents problem cited in http://bugzilla.audacityteam.org/show_bug.cgi?id=528#c11,
             // Gale's cross_fade_out project, which was already corrupted by bug 528.
@@ -2912,13 +2943,116 @@ void WaveTrack::GetEnvelopeValues(
          }
          // Samples are obtained for the purpose of rendering a wave track,
          // so quantize time
-         clip->GetEnvelope().GetValues(rbuf, rlen, rt0, tstep);
+         visit(clip->GetEnvelope(), offset, rlen, rt0);
       }
    }
+   return true;
+}
+}
+
+void WaveTrack::GetEnvelopeValues(
+   double* buffer, size_t bufferLen, double t0, bool backwards) const
+{
+   auto pTrack = this;
+   if (!pTrack)
+      return;
+
+   if (backwards)
+      t0 -= bufferLen / pTrack->GetRate();
+   // The output buffer corresponds to an unbroken span of time which the callers expect
+   // to be fully valid.  As clips are processed below, the output buffer is updated with
+   // envelope values from any portion of a clip, start, end, middle, or none at all.
+   // Since this does not guarantee that the entire buffer is filled with values we need
+   // to initialize the entire buffer to a default value.
+   //
+   // This does mean that, in the cases where a usable clip is located, the buffer value will
+   // be set twice.  Unfortunately, there is no easy way around this since the clips are not
+   // stored in increasing time order.  If they were, we could just track the time as the
+   // buffer is filled.
+   for (decltype(bufferLen) i = 0; i < bufferLen; i++)
+   {
+      buffer[i] = 1.0;
+   }
+
+   const auto tstep = 1.0 / pTrack->GetRate();
+   if (!VisitClipEnvelopes(*pTrack, bufferLen, t0,
+      [&](const Envelope &envelope, size_t offset, size_t len, double rt0){
+         envelope.GetValues(buffer + offset, len, rt0, tstep);
+      }))
+      return;
    if (backwards)
       std::reverse(buffer, buffer + bufferLen);
 }
 
+bool WaveTrack::GetEnvelopeSegments(
+   EnvelopeSegments& segments, size_t bufferLen, double t0,
+   bool backwards, size_t maxSize) const
+{
+   if (backwards)
+      t0 -= bufferLen / GetRate();
+   segments.clear();
+   const auto full = [&]{ return segments.size() >= maxSize; };
+
+   // Clips are not stored in increasing time order, so each visit finds the
+   // next one by offset, and the gaps between them get unit values.  All is
+   // appended in place, so that nothing is allocated within the capacity.
+   const auto tstep = 1.0 / GetRate();
+   size_t position = 0;
+   // Offset, and order of visit to break ties
+   using Key = std::pair<size_t, size_t>;
+   std::optional<Key> last;
+   bool complete = true;
+   while (true) {
+      std::optional<Key> next;
+      const Envelope *pEnvelope{};
+      size_t len{};
+      double rt0{};
+      size_t index = 0;
+      complete = VisitClipEnvelopes(*this, bufferLen, t0,
+         [&](const Envelope &envelope, size_t offset, size_t rlen, double t){
+            const Key key{ offset, index++ };
+            if (rlen == 0 || (last && key <= *last) || (next && *next <= key))
+               return;
+            next = key;
+            pEnvelope = &envelope;
+            len = rlen;
+            rt0 = t;
+         });
+      if (!next)
+         break;
+      last = next;
+
+      const auto offset = next->first;
+      const auto end = offset + len;
+      if (offset > position) {
+         if (full())
+            return false;
+         AppendConstantEnvelopeSegment(segments, offset - position, 1.0);
+      }
+      else if (offset < position) {
+         // Rounding of clip boundaries may overlap adjacent clips by a sample
+         const auto skip = std::min(position - offset, len);
+         len -= skip;
+         rt0 += skip * tstep;
+      }
+      if (len > 0 &&
+          !pEnvelope->GetSegments(segments, len, rt0, tstep, maxSize))
+         return false;
+      position = std::max(position, end);
+   }
+   if (position < bufferLen) {
+      if (full())
+         return false;
+      AppendConstantEnvelopeSegment(segments, bufferLen - position, 1.0);
+   }
+
+   // As in GetEnvelopeValues, values are left unreversed after a clip of
+   // no samples
+   if (backwards && complete)
+      ReverseEnvelopeSegments(segments);
+   return true;
+}
+
 // When the time is both the end of a clip and the start of the next clip, the
 // latter clip is returned.
 auto WaveTrack::GetClipAtTime(double time) const -> IntervalConstHolder
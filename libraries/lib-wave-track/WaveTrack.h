@@ -113,6 +113,9 @@ public:
    void GetEnvelopeValues(
       double* buffer, size_t bufferLen, double t0,
       bool backwards) const override;
+   bool GetEnvelopeSegments(
+      EnvelopeSegments& segments, size_t bufferLen, double t0,
+      bool backwards, size_t maxSize) const override;
    sampleFormat WidestEffectiveFormat() const override;
 
    ChannelGroup &DoGetChannelGroup() const override;
@@ -507,6 +510,10 @@ public:
       double* buffer, size_t bufferLen, double t0,
       bool backwards) const override;
 
+   bool GetEnvelopeSegments(
+      EnvelopeSegments& segments, size_t bufferLen, double t0,
+      bool backwards, size_t maxSize) const override;
+
    //
    // Getting information about the track's internal block sizes
    // and alignment for efficiency
@@ -525,6 +532,13 @@ public:
    void HandleXMLEndTag(const std::string_view& tag) override;
    XMLTagHandler *HandleXMLChild(const std::string_view& tag) override;
    void WriteXML(XMLWriter &xmlFile) const override;
+   //! Whether WriteXML() certainly makes the same calls for both tracks
+   /*!
+    False when it is not cheap to be sure.  Compares the block arrays of
+    sequences by identity, not contents, so an unchanged copy of a track,
+    as kept in undo states, compares equal without reading its blocks.
+    */
+   bool WritesSameXML(const WaveTrack &other) const;
 
    // Returns true if an error occurred while reading from XML
    std::optional<TranslatableString> GetErrorOpening() const override;
@@ -739,6 +753,9 @@ private:
    static void JoinOne(WaveTrack& track, double t0, double t1);
    static void WriteOneXML(const WaveChannel &channel, XMLWriter &xmlFile,
       size_t iChannel, size_t nChannels);
+   //! The start tag and all else that WriteOneXML() writes before the clips
+   static void WriteOneXMLStart(const WaveChannel &channel,
+      XMLWriter &xmlFile, size_t iChannel, size_t nChannels);
    void ExpandOneCutLine(double cutLinePosition,
       double* cutlineStart, double* cutlineEnd);
    void ApplyPitchAndSpeedOnIntervals(
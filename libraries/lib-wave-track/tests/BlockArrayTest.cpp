@@ -0,0 +1,428 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BlockArrayTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "Sequence.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace
+{
+// Set to `true` to print the time taken by edits in the middle of a long
+// sequence
+static constexpr auto runLocally = false;
+
+const auto factory = std::make_shared<MockSampleBlockFactory>();
+
+SeqBlock::SampleBlockPtr MakeBlock(size_t length)
+{
+   std::vector<float> samples(length);
+   return factory->Create(
+      reinterpret_cast<constSamplePtr>(samples.data()), length, floatSample);
+}
+
+//! Checks the array against the vector of its blocks
+void Check(const BlockArray& blocks,
+   const std::vector<SeqBlock::SampleBlockPtr>& expected)
+{
+   REQUIRE(blocks.size() == expected.size());
+   REQUIRE(blocks.empty() == expected.empty());
+   sampleCount start = 0;
+   size_t ii = 0;
+   for (const auto& block : blocks)
+   {
+      REQUIRE(ii < expected.size());
+      REQUIRE(block.sb == expected[ii]);
+      REQUIRE(block.start == start);
+      const auto indexed = blocks[ii];
+      REQUIRE(indexed.sb == expected[ii]);
+      REQUIRE(indexed.start == start);
+      const auto length = block.sb->GetSampleCount();
+      if (length > 0)
+      {
+         REQUIRE(blocks.FindBlock(start) == ii);
+         REQUIRE(blocks.FindBlock(start + length - 1) == ii);
+      }
+      start += length;
+      ++ii;
+   }
+   REQUIRE(ii == expected.size());
+   REQUIRE(blocks.GetNumSamples() == start);
+}
+
+std::vector<float> GetSamples(const Sequence& sequence)
+{
+   std::vector<float> result(sequence.GetNumSamples().as_size_t());
+   sequence.Get(reinterpret_cast<samplePtr>(result.data()), floatSample, 0,
+      result.size(), true);
+   return result;
+}
+
+//! Makes sequences of small blocks, so that tests have many
+struct BlockSizeSetting
+{
+   explicit BlockSizeSetting(size_t bytes)
+   {
+      Sequence::SetMaxDiskBlockSize(bytes);
+   }
+   ~BlockSizeSetting()
+   {
+      Sequence::SetMaxDiskBlockSize(oldBytes);
+   }
+   const size_t oldBytes = Sequence::GetMaxDiskBlockSize();
+};
+
+std::unique_ptr<Sequence> MakeSequence(const std::vector<float>& samples)
+{
+   auto result = std::make_unique<Sequence>(
+      factory, SampleFormats { floatSample, floatSample });
+   result->Append(reinterpret_cast<constSamplePtr>(samples.data()),
+      floatSample, samples.size(), 1, floatSample);
+   result->Flush();
+   return result;
+}
+} // namespace
+
+TEST_CASE("BlockArray")
+{
+   std::mt19937 engine { 42 };
+   BlockArray blocks;
+   std::vector<SeqBlock::SampleBlockPtr> expected;
+   Check(blocks, expected);
+
+   for (size_t ii = 0; ii < 100; ++ii)
+   {
+      // Include some empty blocks
+      expected.push_back(MakeBlock(engine() % 10));
+      blocks.push_back(expected.back());
+   }
+   Check(blocks, expected);
+
+   SECTION("Copies do not see later changes")
+   {
+      const auto copy = blocks;
+      const auto expectedCopy = expected;
+      REQUIRE(copy.Shares(blocks));
+      blocks.Set(50, expected[50] = MakeBlock(20));
+      blocks.pop_back();
+      expected.pop_back();
+      REQUIRE(!copy.Shares(blocks));
+      Check(blocks, expected);
+      Check(copy, expectedCopy);
+   }
+
+   SECTION("Slices and appends")
+   {
+      for (auto round = 0; round < 200; ++round)
+      {
+         const auto size = expected.size();
+         auto first = engine() % (size + 1);
+         auto last = engine() % (size + 1);
+         if (first > last)
+            std::swap(first, last);
+         // Replace a range with some new blocks and a range of the array
+         const auto count = engine() % 3;
+         auto first2 = engine() % (size + 1);
+         auto last2 = engine() % (size + 1);
+         if (first2 > last2)
+            std::swap(first2, last2);
+
+         auto newBlocks = blocks.Slice(0, first);
+         std::vector<SeqBlock::SampleBlockPtr> newExpected(
+            expected.begin(), expected.begin() + first);
+         for (size_t jj = 0; jj < count; ++jj)
+         {
+            newExpected.push_back(MakeBlock(1 + engine() % 10));
+            newBlocks.push_back(newExpected.back());
+         }
+         newBlocks.Append(blocks.Slice(first2, last2));
+         newExpected.insert(newExpected.end(), expected.begin() + first2,
+            expected.begin() + last2);
+         newBlocks.Append(blocks.Slice(last, size));
+         newExpected.insert(
+            newExpected.end(), expected.begin() + last, expected.end());
+
+         blocks = newBlocks;
+         expected = newExpected;
+         Check(blocks, expected);
+      }
+   }
+
+   SECTION("Appends to itself")
+   {
+      blocks.Append(blocks);
+      const auto copy = expected;
+      expected.insert(expected.end(), copy.begin(), copy.end());
+      Check(blocks, expected);
+   }
+
+   SECTION("Iterates from any block")
+   {
+      const auto iter = blocks.At(37);
+      REQUIRE(iter.Index() == 37);
+      REQUIRE(iter->sb == expected[37]);
+      REQUIRE(iter->start == blocks[37].start);
+      REQUIRE(blocks.At(expected.size()) == blocks.end());
+   }
+
+   SECTION("Slices do not see later changes")
+   {
+      const auto slice = blocks.Slice(20, 80);
+      const std::vector<SeqBlock::SampleBlockPtr> expectedSlice(
+         expected.begin() + 20, expected.begin() + 80);
+      for (size_t ii = 0; ii < expected.size(); ++ii)
+         blocks.Set(ii, expected[ii] = MakeBlock(engine() % 10));
+      Check(blocks, expected);
+      Check(slice, expectedSlice);
+   }
+
+   SECTION("A copy read by another thread is never modified")
+   {
+      std::vector<bool> unchanged;
+      std::thread reader;
+      {
+         auto copy = blocks;
+         reader = std::thread([copy = std::move(copy), &expected, &unchanged] {
+            for (int ii = 0; ii < 100; ++ii)
+               unchanged.push_back(std::equal(copy.begin(), copy.end(),
+                  expected.begin(), expected.end(),
+                  [](const SeqBlock& block, const auto& sb) {
+                     return block.sb == sb;
+                  }));
+         });
+      }
+      // The copy may be gone, or not, by now
+      auto changed = expected;
+      for (size_t ii = 0; ii < changed.size(); ++ii)
+         blocks.Set(ii, changed[ii] = MakeBlock(engine() % 10));
+      reader.join();
+      REQUIRE(std::all_of(unchanged.begin(), unchanged.end(),
+         [](bool value) { return value; }));
+      Check(blocks, changed);
+   }
+}
+
+TEST_CASE("BlockArray summaries")
+{
+   std::mt19937 engine { 3 };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   BlockArray blocks;
+   std::vector<std::vector<float>> expected;
+   for (size_t ii = 0; ii < 300; ++ii)
+   {
+      // Include some empty blocks
+      expected.emplace_back(engine() % 20);
+      for (auto& sample : expected.back())
+         sample = distribution(engine);
+      blocks.push_back(factory->Create(
+         reinterpret_cast<constSamplePtr>(expected.back().data()),
+         expected.back().size(), floatSample));
+   }
+
+   for (auto round = 0; round < 200; ++round)
+   {
+      auto first = engine() % (expected.size() + 1);
+      auto last = engine() % (expected.size() + 1);
+      if (first > last)
+         std::swap(first, last);
+      float min = std::numeric_limits<float>::infinity();
+      float max = -min;
+      double sumOfSquares = 0;
+      size_t samples = 0;
+      for (auto ii = first; ii < last; ++ii)
+         for (auto sample : expected[ii])
+         {
+            min = std::min(min, sample);
+            max = std::max(max, sample);
+            sumOfSquares += double(sample) * sample;
+            ++samples;
+         }
+
+      const auto summary = blocks.GetSummary(first, last);
+      REQUIRE(summary.samples == samples);
+      REQUIRE(summary.min == min);
+      REQUIRE(summary.max == max);
+      REQUIRE(summary.sumOfSquares == Approx(sumOfSquares).margin(1e-4));
+
+      // Summaries follow changes, and copies keep theirs
+      const auto copy = blocks;
+      const auto index = engine() % expected.size();
+      expected[index].assign(5, 2.0f);
+      blocks.Set(index, factory->Create(
+         reinterpret_cast<constSamplePtr>(expected[index].data()), 5,
+         floatSample));
+      REQUIRE(blocks.GetSummary(0, expected.size()).max == 2.0f);
+      REQUIRE(copy.GetSummary(first, last).max == max);
+   }
+}
+
+TEST_CASE("Sequence edits")
+{
+   const BlockSizeSetting setting { 4096 };
+   std::mt19937 engine { 7 };
+   std::vector<float> expected(1000000);
+   for (size_t ii = 0; ii < expected.size(); ++ii)
+      expected[ii] = static_cast<float>(ii);
+   const auto sequence = MakeSequence(expected);
+   REQUIRE(sequence->GetBlockArray().GetNumSamples() == expected.size());
+
+   for (auto round = 0; round < 20; ++round)
+   {
+      const auto size = expected.size();
+      const auto start = engine() % size;
+      const auto len = 1 + engine() % std::min<size_t>(size - start, 300000);
+      switch (engine() % 3)
+      {
+      case 0:
+         sequence->Delete(start, len);
+         expected.erase(expected.begin() + start, expected.begin() + start + len);
+         break;
+      case 1:
+         sequence->InsertSilence(start, len);
+         expected.insert(expected.begin() + start, len, 0.0f);
+         break;
+      case 2:
+      {
+         const auto copy = sequence->Copy(factory, start, start + len);
+         const auto at = engine() % (size + 1);
+         sequence->Paste(at, copy.get());
+         std::vector<float> pasted(
+            expected.begin() + start, expected.begin() + start + len);
+         expected.insert(expected.begin() + at, pasted.begin(), pasted.end());
+         break;
+      }
+      }
+      REQUIRE(sequence->GetNumSamples() == expected.size());
+      REQUIRE(sequence->GetBlockArray().GetNumSamples() == expected.size());
+      REQUIRE(GetSamples(*sequence) == expected);
+   }
+}
+
+TEST_CASE("SampleBlockFactory::GetSummary4k")
+{
+   std::mt19937 engine { 4 };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   const auto makeBlock = [&](SampleBlockFactory& blockFactory, size_t length)
+   {
+      std::vector<float> samples(length);
+      for (auto& sample : samples)
+         sample = distribution(engine);
+      return std::make_pair(
+         blockFactory.Create(reinterpret_cast<constSamplePtr>(samples.data()),
+            length, floatSample),
+         samples);
+   };
+   const auto reads = [](const SampleBlockPtr& pBlock) {
+      return static_cast<MockSampleBlock&>(*pBlock).summary256Reads.load();
+   };
+
+   SECTION("Summarizes frames of 4096 samples")
+   {
+      // Ends with a partial frame
+      const auto [pBlock, samples] = makeBlock(*factory, 3 * 4096 + 1000);
+      std::vector<float> summary(4 * 3, -1.0f);
+      // Frames beyond the block are zeroes
+      REQUIRE(factory->GetSummary4k(pBlock, summary.data(), 1, 4));
+      for (size_t frame = 1; frame < 4; ++frame)
+      {
+         const auto first = samples.begin() + frame * 4096;
+         const auto last = samples.begin() +
+            std::min(samples.size(), (frame + 1) * 4096);
+         const auto [min, max] = std::minmax_element(first, last);
+         double sumsq = 0;
+         for (auto iter = first; iter != last; ++iter)
+            sumsq += double(*iter) * *iter;
+         const auto pFrame = &summary[(frame - 1) * 3];
+         REQUIRE(pFrame[0] == *min);
+         REQUIRE(pFrame[1] == *max);
+         REQUIRE(pFrame[2] ==
+            Approx(std::sqrt(sumsq / (last - first))).epsilon(1e-5));
+      }
+      REQUIRE(summary[9] == 0);
+      REQUIRE(summary[10] == 0);
+      REQUIRE(summary[11] == 0);
+   }
+
+   SECTION("Computes each summary once while it is cached")
+   {
+      const auto [pBlock, samples] = makeBlock(*factory, 10000);
+      std::vector<float> first(3 * 3), second(3 * 3);
+      REQUIRE(factory->GetSummary4k(pBlock, first.data(), 0, 3));
+      REQUIRE(factory->GetSummary4k(pBlock, second.data(), 0, 3));
+      REQUIRE(reads(pBlock) == 1);
+      REQUIRE(first == second);
+   }
+
+   SECTION("Keeps the cache within its bound")
+   {
+      // Room for the summaries of a few blocks only
+      MockSampleBlockFactory smallFactory { 1000 };
+      std::vector<SampleBlockPtr> blocks;
+      float summary[3];
+      for (size_t ii = 0; ii < 100; ++ii)
+      {
+         blocks.push_back(makeBlock(smallFactory, 4096).first);
+         smallFactory.GetSummary4k(blocks.back(), summary, 0, 1);
+      }
+      // The most recent is still cached, the first was evicted
+      smallFactory.GetSummary4k(blocks.back(), summary, 0, 1);
+      REQUIRE(reads(blocks.back()) == 1);
+      smallFactory.GetSummary4k(blocks.front(), summary, 0, 1);
+      REQUIRE(reads(blocks.front()) == 2);
+   }
+
+   SECTION("Does not mistake a new block for an old one at the same address")
+   {
+      MockSampleBlockFactory smallFactory;
+      float summary[3];
+      auto pBlock = makeBlock(smallFactory, 4096).first;
+      smallFactory.GetSummary4k(pBlock, summary, 0, 1);
+      const auto address = pBlock.get();
+      pBlock.reset();
+      // Whether or not the allocator reuses the address
+      for (int ii = 0; ii < 10; ++ii)
+      {
+         auto [pNew, samples] = makeBlock(smallFactory, 4096);
+         smallFactory.GetSummary4k(pNew, summary, 0, 1);
+         REQUIRE(summary[1] == *std::max_element(samples.begin(), samples.end()));
+         if (pNew.get() == address)
+            break;
+      }
+   }
+}
+
+TEST_CASE("Sequence edit benchmark")
+{
+   if (!runLocally)
+      return;
+
+   // 100k blocks, as for some hours of audio, but smaller
+   const BlockSizeSetting setting { 1024 };
+   constexpr auto blockSize = 256;
+   const auto sequence =
+      MakeSequence(std::vector<float>(100000 * blockSize));
+   const auto copy = sequence->Copy(factory, 0, 10 * blockSize);
+
+   constexpr auto numEdits = 1000;
+   const auto middle = sequence->GetNumSamples() / 2;
+   const auto start = std::chrono::steady_clock::now();
+   for (auto ii = 0; ii < numEdits; ++ii)
+   {
+      sequence->Paste(middle, copy.get());
+      sequence->Delete(middle, copy->GetNumSamples());
+   }
+   const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+   std::cout << sequence->GetBlockArray().size() << " blocks: "
+             << elapsed.count() / numEdits << " us per paste and delete\n";
+}
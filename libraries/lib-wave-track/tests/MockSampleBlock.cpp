@@ -10,6 +10,9 @@
 **********************************************************************/
 #include "MockSampleBlock.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace
 {
 std::vector<char>
@@ -52,6 +55,31 @@ size_t MockSampleBlock::GetSampleCount() const
 bool MockSampleBlock::GetSummary256(
    float* dest, size_t frameoffset, size_t numframes)
 {
+   ++summary256Reads;
+   // Treats the data as floats, as GetFloatSampleView() does
+   const auto samples = reinterpret_cast<const float*>(data.data());
+   const auto count = data.size() / sizeof(float);
+   for (auto frame = frameoffset; frame < frameoffset + numframes; ++frame)
+   {
+      const auto first = std::min(count, frame * 256);
+      const auto last = std::min(count, first + 256);
+      MinMaxRMS result;
+      if (first < last)
+      {
+         result = { samples[first], samples[first], 0 };
+         double sumsq = 0;
+         for (auto ii = first; ii < last; ++ii)
+         {
+            result.min = std::min(result.min, samples[ii]);
+            result.max = std::max(result.max, samples[ii]);
+            sumsq += double(samples[ii]) * samples[ii];
+         }
+         result.RMS = static_cast<float>(std::sqrt(sumsq / (last - first)));
+      }
+      *dest++ = result.min;
+      *dest++ = result.max;
+      *dest++ = result.RMS;
+   }
    return true;
 }
 
@@ -88,7 +116,21 @@ MinMaxRMS MockSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 
 MinMaxRMS MockSampleBlock::DoGetMinMaxRMS() const
 {
-   return { 0, 0, 0 };
+   // Treats the data as floats, as GetFloatSampleView() does
+   const auto samples = reinterpret_cast<const float*>(data.data());
+   const auto count = data.size() / sizeof(float);
+   if (count == 0)
+      return { 0, 0, 0 };
+   MinMaxRMS result { samples[0], samples[0], 0 };
+   double sumsq = 0;
+   for (size_t ii = 0; ii < count; ++ii)
+   {
+      result.min = std::min(result.min, samples[ii]);
+      result.max = std::max(result.max, samples[ii]);
+      sumsq += double(samples[ii]) * samples[ii];
+   }
+   result.RMS = static_cast<float>(std::sqrt(sumsq / count));
+   return result;
 }
 
 BlockSampleView MockSampleBlock::GetFloatSampleView(bool mayThrow)
@@ -12,6 +12,8 @@
 
 #include "SampleBlock.h"
 
+#include <atomic>
+
 class MockSampleBlock final : public SampleBlock
 {
 public:
@@ -50,4 +52,6 @@ public:
    const long long id;
    const sampleFormat srcFormat;
    const std::vector<char> data;
+   //! Count of calls to GetSummary256()
+   std::atomic<int> summary256Reads { 0 };
 };
@@ -15,6 +15,14 @@
 
 class MockSampleBlockFactory final : public SampleBlockFactory
 {
+public:
+   explicit MockSampleBlockFactory(
+      size_t summary4kCacheBytes = Summary4kCacheBytes)
+       : SampleBlockFactory { summary4kCacheBytes }
+   {
+   }
+
+private:
    SampleBlockIDs GetActiveBlockIDs() override
    {
       std::vector<long long> ids(blockIdCount);
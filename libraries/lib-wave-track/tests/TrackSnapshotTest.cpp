@@ -0,0 +1,141 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TrackSnapshotTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "SampleFormat.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+// Set to `true` to print the time taken to snapshot a growing number of
+// tracks, as the undo manager does on each PushState
+static constexpr auto runLocally = false;
+
+constexpr auto sampleRate = 44100;
+
+const auto sampleBlockFactory = std::make_shared<MockSampleBlockFactory>();
+
+std::shared_ptr<WaveTrack> MakeTrack(TrackList& list, size_t numSamples)
+{
+   const auto track =
+      WaveTrack::Create(sampleBlockFactory, floatSample, sampleRate);
+   list.Add(track);
+   std::vector<float> samples(numSamples);
+   for (size_t ii = 0; ii < numSamples; ++ii)
+      samples[ii] = static_cast<float>(ii % 100) / 100;
+   track->Append(0, reinterpret_cast<constSamplePtr>(samples.data()),
+      floatSample, numSamples);
+   track->Flush();
+   return track;
+}
+
+//! What TrackListRestorer does
+std::shared_ptr<TrackList> Snapshot(const TrackList& tracks)
+{
+   auto result = TrackList::Create(nullptr);
+   for (auto pTrack : tracks)
+      result->Add(pTrack->Duplicate());
+   return result;
+}
+
+std::vector<float> GetSamples(const WaveTrack& track)
+{
+   std::vector<float> result(track.GetVisibleSampleCount().as_size_t());
+   float* const buffers[] { result.data() };
+   track.GetFloats(0, 1, buffers, 0, result.size());
+   return result;
+}
+} // namespace
+
+TEST_CASE("Track snapshots")
+{
+   MockedPrefs prefs;
+   const auto project = AudacityProject::Create();
+   auto& tracks = TrackList::Get(*project);
+   const auto track = MakeTrack(tracks, 10 * sampleRate);
+
+   const auto snapshot = Snapshot(tracks);
+   const auto copy = *snapshot->Any<WaveTrack>().begin();
+   const auto before = GetSamples(*copy);
+   REQUIRE(before == GetSamples(*track));
+
+   SECTION("share block arrays until modified")
+   {
+      REQUIRE(track->GetClip(0)->GetSequenceBlockArray(0)->Shares(
+         *copy->GetClip(0)->GetSequenceBlockArray(0)));
+      track->Clear(1, 2);
+      REQUIRE(!track->GetClip(0)->GetSequenceBlockArray(0)->Shares(
+         *copy->GetClip(0)->GetSequenceBlockArray(0)));
+      REQUIRE(GetSamples(*track).size() == before.size() - sampleRate);
+      REQUIRE(GetSamples(*copy) == before);
+   }
+
+   SECTION("do not see later changes of envelopes")
+   {
+      auto& envelope = track->GetClip(0)->GetEnvelope();
+      envelope.InsertOrReplace(1, 0.5);
+      REQUIRE(envelope.GetNumberOfPoints() == 1);
+      REQUIRE(copy->GetClip(0)->GetEnvelope().GetNumberOfPoints() == 0);
+   }
+
+   SECTION("write the same XML as the track until it is modified")
+   {
+      REQUIRE(track->WritesSameXML(*copy));
+      SECTION("in its samples")
+      {
+         track->Clear(1, 2);
+      }
+      SECTION("in an envelope")
+      {
+         track->GetClip(0)->GetEnvelope().InsertOrReplace(1, 0.5);
+      }
+      SECTION("in a clip")
+      {
+         track->GetClip(0)->SetName("clip");
+      }
+      SECTION("in its gain")
+      {
+         track->SetGain(0.5f);
+      }
+      REQUIRE(!track->WritesSameXML(*copy));
+   }
+}
+
+TEST_CASE("Track snapshot benchmark")
+{
+   if (!runLocally)
+      return;
+
+   MockedPrefs prefs;
+   const auto project = AudacityProject::Create();
+   auto& tracks = TrackList::Get(*project);
+   // Ten minutes per track
+   constexpr auto trackLength = 600 * sampleRate;
+   for (auto numTracks : { 1, 2, 4, 8, 16, 32 })
+   {
+      while (tracks.Size() < numTracks)
+         MakeTrack(tracks, trackLength);
+      constexpr auto numSnapshots = 100;
+      const auto start = std::chrono::steady_clock::now();
+      for (auto ii = 0; ii < numSnapshots; ++ii)
+         Snapshot(tracks);
+      const auto elapsed =
+         std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+      std::cout << numTracks << " tracks: "
+                << elapsed.count() / numSnapshots << " us per snapshot\n";
+   }
+}
@@ -432,6 +432,113 @@ void XMLStringWriter::Write(const wxString &data)
    Append(data);
 }
 
+///
+/// XMLCallRecorder class
+///
+XMLCallRecorder::XMLCallRecorder()
+{
+}
+
+XMLCallRecorder::~XMLCallRecorder()
+{
+}
+
+void XMLCallRecorder::Record(char code, const wxString &string)
+{
+   const auto utf8 = string.utf8_str();
+   const auto length = utf8.length();
+   mRecord.push_back(code);
+   Record(length);
+   mRecord.append(utf8.data(), length);
+}
+
+void XMLCallRecorder::StartTag(const wxString &name)
+{
+   Record('<', name);
+}
+
+void XMLCallRecorder::EndTag(const wxString &name)
+{
+   Record('>', name);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, const wxString &value)
+{
+   Record('a', name);
+   Record('s', value);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, const wxChar *value)
+{
+   WriteAttr(name, wxString{ value });
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, int value)
+{
+   Record('a', name);
+   mRecord.push_back('i');
+   Record(value);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, bool value)
+{
+   Record('a', name);
+   mRecord.push_back('b');
+   Record(value);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, long value)
+{
+   Record('a', name);
+   mRecord.push_back('l');
+   Record(value);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, long long value)
+{
+   Record('a', name);
+   mRecord.push_back('L');
+   Record(value);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, size_t value)
+{
+   Record('a', name);
+   mRecord.push_back('z');
+   Record(value);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, float value, int digits)
+{
+   Record('a', name);
+   mRecord.push_back('f');
+   Record(value);
+   Record(digits);
+}
+
+void XMLCallRecorder::WriteAttr(const wxString &name, double value, int digits)
+{
+   Record('a', name);
+   mRecord.push_back('d');
+   Record(value);
+   Record(digits);
+}
+
+void XMLCallRecorder::WriteData(const wxString &value)
+{
+   Record('D', value);
+}
+
+void XMLCallRecorder::WriteSubTree(const wxString &value)
+{
+   Record('T', value);
+}
+
+void XMLCallRecorder::Write(const wxString &data)
+{
+   Record('W', data);
+}
+
 void XMLUtf8BufferWriter::StartTag(const std::string_view& name)
 {
    if (mInTag)
@@ -10,6 +10,7 @@
 #ifndef __AUDACITY_XML_XML_FILE_WRITER__
 #define __AUDACITY_XML_XML_FILE_WRITER__
 
+#include <string>
 #include <vector>
 #include <wx/ffile.h> // to inherit
 
@@ -149,6 +150,54 @@ class XML_API XMLStringWriter final : public wxString, public XMLWriter {
 
 };
 
+///
+/// XMLCallRecorder
+///
+
+//! Records exactly the calls made to it, not their formatting
+/*!
+ Equal records mean that any writer, given the same calls, writes the same
+ output, so comparing records finds whether two objects serialize alike.
+ */
+class XML_API XMLCallRecorder final : public XMLWriter {
+
+ public:
+
+   XMLCallRecorder();
+   virtual ~XMLCallRecorder();
+
+   void StartTag(const wxString &name) override;
+   void EndTag(const wxString &name) override;
+
+   void WriteAttr(const wxString &name, const wxString &value) override;
+   void WriteAttr(const wxString &name, const wxChar *value) override;
+
+   void WriteAttr(const wxString &name, int value) override;
+   void WriteAttr(const wxString &name, bool value) override;
+   void WriteAttr(const wxString &name, long value) override;
+   void WriteAttr(const wxString &name, long long value) override;
+   void WriteAttr(const wxString &name, size_t value) override;
+   void WriteAttr(const wxString &name, float value, int digits = -1) override;
+   void WriteAttr(const wxString &name, double value, int digits = -1) override;
+
+   void WriteData(const wxString &value) override;
+
+   void WriteSubTree(const wxString &value) override;
+
+   void Write(const wxString &data) override;
+
+   const std::string &GetRecord() const { return mRecord; }
+
+ private:
+   void Record(char code, const wxString &string);
+   template<typename Value> void Record(const Value &value)
+   {
+      mRecord.append(reinterpret_cast<const char *>(&value), sizeof(value));
+   }
+
+   std::string mRecord;
+};
+
 class XML_API XMLUtf8BufferWriter final
 {
 public:
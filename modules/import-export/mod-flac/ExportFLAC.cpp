@@ -223,6 +223,9 @@ public:
    CreateOptionsEditor(int, ExportOptionsEditor::Listener* listener) const override;
 
    std::unique_ptr<ExportProcessor> CreateProcessor(int format) const override;
+
+   // Each processor owns its FLAC::Encoder::File
+   bool SupportsConcurrentExport(int) const override { return true; }
 };
 
 //----------------------------------------------------------------------------
@@ -1645,6 +1645,9 @@ public:
 
    std::unique_ptr<ExportProcessor> CreateProcessor(int format) const override;
 
+   // LAME keeps all state in the lame_global_flags of a processor
+   bool SupportsConcurrentExport(int) const override { return true; }
+
    std::vector<std::string> GetMimeTypes(int) const override;
 
    bool ParseConfig(
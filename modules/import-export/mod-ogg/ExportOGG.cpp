@@ -153,6 +153,9 @@ public:
    CreateOptionsEditor(int, ExportOptionsEditor::Listener*) const override;
 
    std::unique_ptr<ExportProcessor> CreateProcessor(int format) const override;
+
+   // libvorbis and libogg keep all state in the streams of a processor
+   bool SupportsConcurrentExport(int) const override { return true; }
 };
 
 ExportOGG::ExportOGG() = default;
@@ -481,6 +481,9 @@ public:
    CreateOptionsEditor(int, ExportOptionsEditor::Listener*) const override;
 
    std::unique_ptr<ExportProcessor> CreateProcessor(int format) const override;
+
+   // libopus keeps all state in the encoder of a processor
+   bool SupportsConcurrentExport(int) const override { return true; }
 };
 
 ExportOpus::ExportOpus() = default;
@@ -454,6 +454,9 @@ public:
     * file type, or giving the user full control over libsndfile.
     */
    std::unique_ptr<ExportProcessor> CreateProcessor(int format) const override;
+
+   // Each processor writes through its own SNDFILE
+   bool SupportsConcurrentExport(int) const override { return true; }
 };
 
 ExportPCM::ExportPCM() = default;
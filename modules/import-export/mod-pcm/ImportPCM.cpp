@@ -35,9 +35,11 @@
 
 #include "FileFormats.h"
 #include "GetAcidizerTags.h"
+#include "ImportPipeline.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
+#include "Sequence.h"
 #include "WaveTrack.h"
 
 #include <algorithm>
@@ -97,7 +99,21 @@ public:
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)) override
    {}
 
+   // Each handle has its own SNDFILE, so files can be decoded at once
+   bool SupportsConcurrentImport() const override { return true; }
+   void Decode(ImportProgressListener& progressListener,
+      DecodedAudio& audio, Tags* tags,
+      std::optional<LibFileFormats::AcidizerTags>& outAcidTags) override;
+
 private:
+   //! Format of the samples that libsndfile gives
+   sampleFormat DecodingFormat() const;
+   //! @return false if an error or cancellation was reported to the listener
+   bool DecodeSamples(ImportProgressListener& progressListener,
+      size_t maxBlockSize, const ImportPipeline::Consumer &consumer);
+   void ReadTags(Tags* tags,
+      std::optional<LibFileFormats::AcidizerTags>& outAcidTags);
+
    SFFile                mFile;
    const SF_INFO         mInfo;
    sampleFormat          mEffectiveFormat;
@@ -295,9 +311,75 @@ void PCMImportFileHandle::Import(
       mFormat,
       mInfo.samplerate);
 
+   std::vector<WaveChannel *> channels;
+   for (auto channel : track->Channels())
+      channels.push_back(channel.get());
+   const auto format = DecodingFormat();
+   if (!DecodeSamples(progressListener, track->GetMaxBlockSize(),
+      [&](const constSamplePtr *buffers, size_t frames) {
+         for (size_t iChannel = 0; iChannel < channels.size(); ++iChannel)
+            channels[iChannel]->AppendBuffer(
+               buffers[iChannel], format, frames, 1, mEffectiveFormat);
+      }))
+      return;
+
+   ImportUtils::FinalizeImport(outTracks, *track);
+
+   ReadTags(tags, outAcidTags);
+
+   progressListener.OnImportResult(IsStopped()
+                                   ? ImportProgressListener::ImportResult::Stopped
+                                   : ImportProgressListener::ImportResult::Success);
+}
+
+void PCMImportFileHandle::Decode(ImportProgressListener& progressListener,
+   DecodedAudio& audio, Tags* tags,
+   std::optional<LibFileFormats::AcidizerTags>& outAcidTags)
+{
+   BeginImport();
+
+   wxASSERT(mFile.get());
+
+   // mFormat was chosen from preferences when the file was opened
+   audio.trackFormat = mFormat;
+   audio.effectiveFormat = mEffectiveFormat;
+   audio.format = DecodingFormat();
+   audio.rate = mInfo.samplerate;
+   audio.channels.clear();
+   audio.channels.resize(std::max(mInfo.channels, 0));
+   const auto size = SAMPLE_SIZE(audio.format);
+   if (mInfo.frames > 0)
+      for (auto &channel : audio.channels)
+         channel.reserve(mInfo.frames * size);
+
+   if (!DecodeSamples(progressListener,
+      Sequence::GetMaxDiskBlockSize() / SAMPLE_SIZE(mFormat),
+      [&](const constSamplePtr *buffers, size_t frames) {
+         for (size_t iChannel = 0; iChannel < audio.channels.size(); ++iChannel)
+            audio.channels[iChannel].insert(audio.channels[iChannel].end(),
+               buffers[iChannel], buffers[iChannel] + frames * size);
+      }))
+      return;
+
+   ReadTags(tags, outAcidTags);
+
+   progressListener.OnImportResult(IsStopped()
+                                   ? ImportProgressListener::ImportResult::Stopped
+                                   : ImportProgressListener::ImportResult::Success);
+}
+
+sampleFormat PCMImportFileHandle::DecodingFormat() const
+{
+   //import 24 bit int as float and have the append function convert it.  This is how PCMAliasBlockFile worked too.
+   return (mFormat == int16Sample) ? int16Sample : floatSample;
+}
+
+bool PCMImportFileHandle::DecodeSamples(
+   ImportProgressListener& progressListener, size_t maxBlockSize,
+   const ImportPipeline::Consumer &consumer)
+{
    auto fileTotalFrames =
       (sampleCount)mInfo.frames; // convert from sf_count_t
-   auto maxBlockSize = track->GetMaxBlockSize();
 
    {
       // Otherwise, we're in the "copy" mode, where we read in the actual
@@ -309,7 +391,7 @@ void PCMImportFileHandle::Import(
       if (mInfo.channels < 1)
       {
          progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
-         return;
+         return false;
       }
       auto maxBlock = std::min(maxBlockSize,
          std::numeric_limits<type>::max() /
@@ -318,76 +400,44 @@ void PCMImportFileHandle::Import(
       if (maxBlock < 1)
       {
          progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
-         return;
+         return false;
       }
 
-      SampleBuffer srcbuffer, buffer;
-      wxASSERT(mInfo.channels >= 0);
-      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr() ||
-             NULL == buffer.Allocate(maxBlock, mFormat).ptr())
-      {
-         maxBlock /= 2;
-         if (maxBlock < 1)
-         {
-            progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
-            return;
-         }
-      }
-
-      decltype(fileTotalFrames) framescompleted = 0;
-
-      long block;
-      do {
-         block = maxBlock;
-
-         if (mFormat == int16Sample)
-            block = SFCall<sf_count_t>(sf_readf_short, mFile.get(), (short *)srcbuffer.ptr(), block);
-         //import 24 bit int as float and have the append function convert it.  This is how PCMAliasBlockFile worked too.
-         else
-            block = SFCall<sf_count_t>(sf_readf_float, mFile.get(), (float *)srcbuffer.ptr(), block);
-
-         if(block < 0 || block > (long)maxBlock) {
-            wxASSERT(false);
-            block = maxBlock;
-         }
-
-         if (block) {
-            unsigned c = 0;
-            ImportUtils::ForEachChannel(*track, [&](auto& channel)
-            {
-               if (mFormat==int16Sample) {
-                  for(int j=0; j<block; j++)
-                     ((short *)buffer.ptr())[j] =
-                        ((short *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-               else {
-                  for(int j=0; j<block; j++)
-                     ((float *)buffer.ptr())[j] =
-                        ((float *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-
-               channel.AppendBuffer(
-                  buffer.ptr(),
-                  (mFormat == int16Sample) ? int16Sample : floatSample,
-                  block, 1, mEffectiveFormat
-               );
-               ++c;
-            });
-            framescompleted += block;
-         }
-         if(fileTotalFrames > 0)
-            progressListener.OnImportProgress(framescompleted.as_double() / fileTotalFrames.as_double());
-      } while (block > 0 && !IsCancelled() && !IsStopped());
+      // Decoding, deinterleaving, and appending overlap in time
+      const auto format = DecodingFormat();
+      ImportPipeline::Run(mInfo.channels, format, maxBlock,
+         [&](samplePtr buffer, size_t maxFrames) -> size_t {
+            sf_count_t block;
+            if (format == int16Sample)
+               block = SFCall<sf_count_t>(sf_readf_short, mFile.get(), (short *)buffer, maxFrames);
+            else
+               block = SFCall<sf_count_t>(sf_readf_float, mFile.get(), (float *)buffer, maxFrames);
+
+            if(block < 0 || block > (sf_count_t)maxFrames) {
+               wxASSERT(false);
+               block = maxFrames;
+            }
+            return block;
+         },
+         consumer,
+         [&](sampleCount framescompleted) {
+            if(fileTotalFrames > 0)
+               progressListener.OnImportProgress(framescompleted.as_double() / fileTotalFrames.as_double());
+            return !IsCancelled() && !IsStopped();
+         });
    }
 
    if(IsCancelled())
    {
       progressListener.OnImportResult(ImportProgressListener::ImportResult::Cancelled);
-      return;
+      return false;
    }
+   return true;
+}
 
-   ImportUtils::FinalizeImport(outTracks, *track);
-
+void PCMImportFileHandle::ReadTags(Tags* tags,
+   std::optional<LibFileFormats::AcidizerTags>& outAcidTags)
+{
    const char *str;
 
    str = sf_get_string(mFile.get(), SF_STR_TITLE);
@@ -583,10 +633,6 @@ void PCMImportFileHandle::Import(
       }
    }
 #endif
-
-   progressListener.OnImportResult(IsStopped()
-                                   ? ImportProgressListener::ImportResult::Stopped
-                                   : ImportProgressListener::ImportResult::Success);
 }
 
 PCMImportFileHandle::~PCMImportFileHandle()
@@ -294,6 +294,9 @@ public:
    CreateOptionsEditor(int, ExportOptionsEditor::Listener*) const override;
 
    std::unique_ptr<ExportProcessor> CreateProcessor(int format) const override;
+
+   // Each processor owns its WavpackContext
+   bool SupportsConcurrentExport(int) const override { return true; }
 };
 
 ExportWavPack::ExportWavPack() = default;
@@ -424,9 +424,10 @@ int ProjectAudioManager::PlayPlayRegion(const SelectedRegion &selectedRegion,
             [tless, diff](auto&) -> std::unique_ptr<PlaybackPolicy> {
                return std::make_unique<CutPreviewPlaybackPolicy>(tless, diff);
             };
-         token = gAudioIO->StartStream(
-            MakeTransportTracks(TrackList::Get(*p), false, nonWaveToo),
-            tcp0, tcp1, tcp1, myOptions);
+         const auto sequences =
+            MakeTransportTracks(TrackList::Get(*p), false, nonWaveToo);
+         PrepareTransportTracks(sequences, tcp0, backwards);
+         token = gAudioIO->StartStream(sequences, tcp0, tcp1, tcp1, myOptions);
       }
       else {
          double mixerLimit = t1;
@@ -435,9 +436,12 @@ int ProjectAudioManager::PlayPlayRegion(const SelectedRegion &selectedRegion,
             if (pStartTime && *pStartTime >= t1)
                t1 = latestEnd;
          }
-         token = gAudioIO->StartStream(
-            MakeTransportTracks(tracks, false, nonWaveToo),
-            t0, t1, mixerLimit, options);
+         const auto sequences = MakeTransportTracks(tracks, false, nonWaveToo);
+         // Looped play comes back to t0 at each pass
+         PrepareTransportTracks(sequences, t0, backwards);
+         if (pStartTime && *pStartTime != t0)
+            PrepareTransportTracks(sequences, *pStartTime, backwards);
+         token = gAudioIO->StartStream(sequences, t0, t1, mixerLimit, options);
       }
       if (token != 0) {
          success = true;
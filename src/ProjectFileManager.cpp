@@ -1423,14 +1423,21 @@ bool ProjectFileManager::ImportAndRunTempoDetection(
    const auto projectWasEmpty =
       TrackList::Get(mProject).Any<WaveTrack>().empty();
    std::vector<std::shared_ptr<ClipMirAudioReader>> resultingReaders;
-   const auto success = std::all_of(
-      fileNames.begin(), fileNames.end(), [&](const FilePath& fileName) {
-         std::shared_ptr<ClipMirAudioReader> resultingReader;
-         const auto success = DoImport(fileName, addToHistory, resultingReader);
-         if (success && resultingReader)
-            resultingReaders.push_back(std::move(resultingReader));
-         return success;
-      });
+   // Other files of the batch are decoded while each one is committed
+   auto success = true;
+   Importer::Get().ImportBatch(mProject,
+      FilePaths { fileNames.begin(), fileNames.end() },
+      [this](const FilePath&) {
+         return std::make_unique<ImportProgress>(mProject);
+      },
+      [&](const FilePath& fileName, const Importer::BatchImportFunction& import)
+   {
+      std::shared_ptr<ClipMirAudioReader> resultingReader;
+      success = DoImport(fileName, addToHistory, resultingReader, import);
+      if (success && resultingReader)
+         resultingReaders.push_back(std::move(resultingReader));
+      return success;
+   });
    // At the moment, one failing import doesn't revert the project state, hence
    // we still run the analysis on what was successfully imported.
    // TODO implement reverting of the project state on failure.
@@ -1450,7 +1457,8 @@ bool ProjectFileManager::ImportAndRunTempoDetection(
 // If pNewTrackList is passed in non-NULL, it gets filled with the pointers to NEW tracks.
 bool ProjectFileManager::DoImport(
    const FilePath& fileName, bool addToHistory,
-   std::shared_ptr<ClipMirAudioReader>& resultingReader)
+   std::shared_ptr<ClipMirAudioReader>& resultingReader,
+   const Importer::BatchImportFunction& import)
 {
    auto &project = mProject;
    auto &projectFileIO = ProjectFileIO::Get(project);
@@ -1519,9 +1527,12 @@ bool ProjectFileManager::DoImport(
 
       ImportProgress importProgress(project);
       std::optional<LibFileFormats::AcidizerTags> acidTags;
-      bool success = Importer::Get().Import(
-         project, fileName, &importProgress, &WaveTrackFactory::Get(project),
-         newTracks, newTags.get(), acidTags, errorMessage);
+      bool success = import ?
+         import(&WaveTrackFactory::Get(project),
+            newTracks, newTags.get(), acidTags, errorMessage) :
+         Importer::Get().Import(
+            project, fileName, &importProgress, &WaveTrackFactory::Get(project),
+            newTracks, newTags.get(), acidTags, errorMessage);
       if (!errorMessage.empty()) {
          // Error message derived from Importer::Import
          // Additional help via a Help button links to the manual.
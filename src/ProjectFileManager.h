@@ -17,6 +17,7 @@ Paul Licameli split from AudacityProject.h
 
 #include "ClientData.h" // to inherit
 #include "FileNames.h" // for FileType
+#include "Import.h" // for Importer::BatchImportFunction
 
 class wxString;
 class wxFileName;
@@ -120,9 +121,14 @@ private:
    bool ImportAndRunTempoDetection(
       const std::vector<FilePath>& fileNames, bool addToHistory);
 
+   /*!
+    @param import if not empty, imports the file instead of Importer::Import,
+    as when the file is one of a batch
+    */
    bool DoImport(
       const FilePath& fileName, bool addToHistory,
-      std::shared_ptr<ClipMirAudioReader>& resultingReader);
+      std::shared_ptr<ClipMirAudioReader>& resultingReader,
+      const Importer::BatchImportFunction& import = {});
 
    /*!
     @param fileName a path assumed to exist and contain an .aup3 project
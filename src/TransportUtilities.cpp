@@ -19,6 +19,7 @@
 #include "ProjectAudioIO.h"
 #include "ProjectAudioManager.h"
 #include "SampleTrack.h"
+#include "StretchedClipCache.h"
 #include "StretchingSequence.h"
 #include "ViewInfo.h"
 #include "toolbars/ControlToolBar.h"
@@ -213,8 +214,9 @@ TransportSequences MakeTransportTracks(
       const auto range = trackList.Any<WaveTrack>()
          + (selectedOnly ? &Track::IsSelected : &Track::Any);
       for (auto pTrack : range)
-         result.playbackSequences.push_back(
-            StretchingSequence::Create(*pTrack, pTrack->GetClipInterfaces()));
+         result.playbackSequences.push_back(StretchingSequence::Create(
+            *pTrack, pTrack->GetClipInterfaces(),
+            StretchedClipCache::GetForPlayback()));
    }
    if (nonWaveToo) {
       const auto range = trackList.Any<const PlayableTrack>() +
@@ -229,3 +231,13 @@ TransportSequences MakeTransportTracks(
    }
    return result;
 }
+
+void PrepareTransportTracks(
+   const TransportSequences &sequences, double t0, bool backwards)
+{
+   for (const auto &pSequence : sequences.playbackSequences)
+      if (const auto pStretching =
+         dynamic_cast<const StretchingSequence *>(pSequence.get()))
+         pStretching->PrepareToPlay(t0, backwards
+            ? PlaybackDirection::backward : PlaybackDirection::forward);
+}
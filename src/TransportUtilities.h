@@ -45,4 +45,9 @@ struct AUDACITY_DLL_API TransportUtilities
 TransportSequences MakeTransportTracks(
    TrackList &trackList, bool selectedOnly, bool nonWaveToo = false);
 
+//! Lets stretched clips prepare, off the audio thread, for playback that
+//! starts from `t0`, and may come back to it
+void PrepareTransportTracks(
+   const TransportSequences &sequences, double t0, bool backwards);
+
 #endif
@@ -144,7 +144,7 @@ struct EffectBassTreble::Instance
    static void Coefficients(double hz, double slope, double gain, double samplerate, int type,
       double& a0, double& a1, double& a2, double& b0, double& b1, double& b2);
 
-   static float DoFilter(EffectBassTrebleState& data, float in);
+   static void UpdateFilter(EffectBassTrebleState& data);
 
    EffectBassTrebleState mState;
    std::vector<EffectBassTreble::Instance> mSlaves;
@@ -404,15 +404,9 @@ void EffectBassTreble::Instance::InstanceInit(EffectSettings& settings, EffectBa
    data.b1Treble = 0;
    data.b2Treble = 0;
 
-   data.xn1Bass = 0;
-   data.xn2Bass = 0;
-   data.yn1Bass = 0;
-   data.yn2Bass = 0;
-
-   data.xn1Treble = 0;
-   data.xn2Treble = 0;
-   data.yn1Treble = 0;
-   data.yn2Treble = 0;
+   Biquad sections[2];
+   data.filter = BiquadCascade{ sections, 2, 1 };
+   UpdateFilter(data);
 
    data.bass = -1;
    data.treble = -1;
@@ -426,7 +420,6 @@ size_t EffectBassTreble::Instance::InstanceProcess(EffectSettings &settings,
 {
    auto& ms = GetSettings(settings);
 
-   const float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
 
    // Set value to ensure correct rounding
@@ -447,8 +440,11 @@ size_t EffectBassTreble::Instance::InstanceProcess(EffectSettings &settings,
                   data.a0Treble, data.a1Treble, data.a2Treble,
                   data.b0Treble, data.b1Treble, data.b2Treble);
 
+   UpdateFilter(data);
+
+   data.filter.Process(inBlock, outBlock, blockLen);
    for (decltype(blockLen) i = 0; i < blockLen; i++) {
-      obuf[i] = DoFilter(data, ibuf[i]) * data.gain;
+      obuf[i] *= data.gain;
    }
 
    return blockLen;
@@ -487,26 +483,24 @@ void EffectBassTreble::Instance::Coefficients(double hz, double slope, double ga
    }
 }
 
-float EffectBassTreble::Instance::DoFilter(EffectBassTrebleState & data, float in)
+void EffectBassTreble::Instance::UpdateFilter(EffectBassTrebleState & data)
 {
-   // Bass filter
-   float out = (data.b0Bass * in + data.b1Bass * data.xn1Bass + data.b2Bass * data.xn2Bass -
-         data.a1Bass * data.yn1Bass - data.a2Bass * data.yn2Bass) / data.a0Bass;
-   data.xn2Bass = data.xn1Bass;
-   data.xn1Bass = in;
-   data.yn2Bass = data.yn1Bass;
-   data.yn1Bass = out;
+   Biquad sections[2];
+   auto& bass = sections[0];
+   bass.fNumerCoeffs[Biquad::B0] = data.b0Bass / data.a0Bass;
+   bass.fNumerCoeffs[Biquad::B1] = data.b1Bass / data.a0Bass;
+   bass.fNumerCoeffs[Biquad::B2] = data.b2Bass / data.a0Bass;
+   bass.fDenomCoeffs[Biquad::A1] = data.a1Bass / data.a0Bass;
+   bass.fDenomCoeffs[Biquad::A2] = data.a2Bass / data.a0Bass;
 
-   // Treble filter
-   in = out;
-   out = (data.b0Treble * in + data.b1Treble * data.xn1Treble + data.b2Treble * data.xn2Treble -
-         data.a1Treble * data.yn1Treble - data.a2Treble * data.yn2Treble) / data.a0Treble;
-   data.xn2Treble = data.xn1Treble;
-   data.xn1Treble = in;
-   data.yn2Treble = data.yn1Treble;
-   data.yn1Treble = out;
+   auto& treble = sections[1];
+   treble.fNumerCoeffs[Biquad::B0] = data.b0Treble / data.a0Treble;
+   treble.fNumerCoeffs[Biquad::B1] = data.b1Treble / data.a0Treble;
+   treble.fNumerCoeffs[Biquad::B2] = data.b2Treble / data.a0Treble;
+   treble.fDenomCoeffs[Biquad::A1] = data.a1Treble / data.a0Treble;
+   treble.fDenomCoeffs[Biquad::A2] = data.a2Treble / data.a0Treble;
 
-   return out;
+   data.filter.SetSections(sections);
 }
 
 
@@ -9,7 +9,14 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+#include <algorithm>
 #include <cstring>
+#include <vector>
+
+namespace {
+// Samples of each channel for one call of the weighting filter
+constexpr size_t WeightingBlockSize = 4096;
+}
 
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount{ channels }
@@ -19,16 +26,13 @@ EBUR128::EBUR128(double rate, size_t channels)
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
-   mWeightingFilter.reinit(mChannelCount, false);
+   mWeightingFilter =
+      BiquadCascade{ CalcWeightingFilter(mRate).get(), 2, mChannelCount };
+   mWeighted.reinit(mChannelCount);
    for(size_t channel = 0; channel < mChannelCount; ++channel)
-      mWeightingFilter[channel] = CalcWeightingFilter(mRate);
+      mWeighted[channel].reinit(WeightingBlockSize);
 
    memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
-   for(size_t channel = 0; channel < mChannelCount; ++channel)
-   {
-      mWeightingFilter[channel][0].Reset();
-      mWeightingFilter[channel][1].Reset();
-   }
 }
 
 // fs: sample rate
@@ -80,18 +84,34 @@ ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
    return pBiquad;
 }
 
-void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
+void EBUR128::ProcessSamples(const float* const* samples, size_t len)
 {
-   double value;
-   value = mWeightingFilter[channel][0].ProcessOne(x_in);
-   value = mWeightingFilter[channel][1].ProcessOne(value);
-   if(channel == 0)
-      mBlockRingBuffer[mBlockRingPos] = value * value;
-   else
+   std::vector<const float*> in(samples, samples + mChannelCount);
+   std::vector<float*> weighted(mChannelCount);
+   for(size_t channel = 0; channel < mChannelCount; ++channel)
+      weighted[channel] = mWeighted[channel].get();
+
+   while(len > 0)
    {
-      // Add the power of additional channels to the power of first channel.
-      // As a result, stereo tracks appear about 3 LUFS louder, as specified.
-      mBlockRingBuffer[mBlockRingPos] += value * value;
+      const auto block = std::min(len, WeightingBlockSize);
+      mWeightingFilter.Process(in.data(), weighted.data(), block);
+      for(size_t i = 0; i < block; ++i)
+      {
+         // Add the power of additional channels to the power of first
+         // channel. As a result, stereo tracks appear about 3 LUFS louder,
+         // as specified.
+         double power = 0;
+         for(size_t channel = 0; channel < mChannelCount; ++channel)
+         {
+            const double value = weighted[channel][i];
+            power += value * value;
+         }
+         mBlockRingBuffer[mBlockRingPos] = power;
+         NextSample();
+      }
+      for(auto& pointer : in)
+         pointer += block;
+      len -= block;
    }
 }
 
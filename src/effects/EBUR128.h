@@ -27,13 +27,14 @@ public:
    ~EBUR128() = default;
 
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
-   void ProcessSampleFromChannel(float x_in, size_t channel) const;
-   void NextSample();
+   //! Takes len samples of each channel
+   void ProcessSamples(const float* const* samples, size_t len);
    double IntegrativeLoudness();
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
 
 private:
+   void NextSample();
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
    void AddBlockToHistogram(size_t validLen);
 
@@ -50,11 +51,10 @@ private:
    const size_t mBlockSize;
    const size_t mBlockOverlap;
 
-   /// This is be an array of arrays of the type
-   /// mWeightingFilter[CHANNEL][FILTER] with
-   /// CHANNEL = LEFT/RIGHT (0/1) and
-   /// FILTER  = HSF/HPF    (0/1)
-   ArrayOf<ArrayOf<Biquad>> mWeightingFilter;
+   /// HSF and HPF for each channel
+   BiquadCascade mWeightingFilter;
+   /// Weighted samples of each channel, for one call of mWeightingFilter
+   ArrayOf<Floats> mWeighted;
 };
 
 #endif
@@ -13,6 +13,8 @@
 #include "ExportAudioDialog.h"
 
 #include <numeric>
+#include <set>
+#include <thread>
 
 #include <wx/frame.h>
 
@@ -864,42 +866,68 @@ void ExportAudioDialog::UpdateTrackExportSettings(const ExportPlugin& plugin, in
    std::swap(mExportSettings, exportSettings);
 }
 
-ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin,
-                                                      int formatIndex,
-                                                      const ExportProcessor::Parameters& parameters,
-                                                      FilePaths& exporterFiles)
+namespace
 {
-   auto ok = ExportResult::Success;   // did it work?
-   /* Go round again and do the exporting (so this run is slow but
-    * non-interactive) */
-   for(auto& activeSetting : mExportSettings)
-   {
-      /* get the settings to use for the export from the array */
-      // Bug 1440 fix.
-      if( activeSetting.filename.GetName().empty() )
-         continue;
-
-      // Export it
-      ok = DoExport(plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
-         activeSetting.t0, activeSetting.t1, false, activeSetting.tags, exporterFiles);
-
-      if (ok == ExportResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
-            // User decided not to continue - bail out!
-            break;
-         }
+//! Finds a name for an exported file, or makes a backup of the file that it
+//! replaces
+/*! @return the path to export to */
+wxString PrepareExportFile(
+   const wxFileName& filename, bool overwrite, wxFileName& backup)
+{
+   wxFileName name;
+
+   if (overwrite) {
+      name = filename;
+      backup.Assign(name);
+
+      int suffix = 0;
+      do {
+         backup.SetName(name.GetName() +
+                           wxString::Format(wxT("%d"), suffix));
+         ++suffix;
+      }
+      while (backup.FileExists());
+      ::wxRenameFile(filename.GetFullPath(), backup.GetFullPath());
+   }
+   else {
+      name = filename;
+      int i = 2;
+      wxString base(name.GetName());
+      while (name.FileExists()) {
+         name.SetName(wxString::Format(wxT("%s-%d"), base, i++));
       }
-      else if (ok != ExportResult::Success) {
-         break;
+   }
+   return name.GetFullPath();
+}
+
+//! Removes the backup made by PrepareExportFile, or restores it
+void FinishExportFile(
+   const wxFileName& backup, const wxString& fullPath, bool success)
+{
+   if (backup.IsOk()) {
+      if ( success )
+         // Remove backup
+         ::wxRemoveFile(backup.GetFullPath());
+      else {
+         // Restore original
+         ::wxRemoveFile(fullPath);
+         ::wxRenameFile(backup.GetFullPath(), fullPath);
       }
    }
+   else {
+      if ( ! success )
+         // Remove any new, and only partially written, file.
+         ::wxRemoveFile(fullPath);
+   }
+}
+}
 
-   return ok;
+ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin,
+                                                      int formatIndex,
+                                                      const ExportProcessor::Parameters& parameters,
+                                                      FilePaths& exporterFiles)
+{
+   return DoExportSplit(plugin, formatIndex, parameters, false, {}, exporterFiles);
 }
 
 ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin,
@@ -914,6 +942,9 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
 
    auto waveTracks = tracks.Any<WaveTrack>() -
       (anySolo ? &WaveTrack::GetNotSolo : &WaveTrack::GetMute);
+   // One for each of mExportSettings
+   const std::vector<WaveTrack*> exportedTracks {
+      waveTracks.begin(), waveTracks.end() };
 
    auto& selectionState = SelectionState::Get( mProject );
 
@@ -922,131 +953,110 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
    for (auto tr : tracks.Selected<WaveTrack>())
       tr->SetSelected(false);
 
-   auto ok = ExportResult::Success;
-
-   int count = 0;
-   for (auto tr : waveTracks) {
-
-      wxLogDebug( "Get setting %i", count );
-      /* get the settings to use for the export from the array */
-      auto& activeSetting = mExportSettings[count];
-      if( activeSetting.filename.GetName().empty() ){
-         count++;
-         continue;
-      }
-
-      /* Select the track */
-      SelectionStateChanger changer2{ selectionState, tracks };
-      tr->SetSelected(true);
-
-      // Export the data. "channels" are per track.
-      ok = DoExport(plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
-         activeSetting.t0, activeSetting.t1, true, activeSetting.tags, exporterFiles);
-
-      if (ok == ExportResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
-            // User decided not to continue - bail out!
-            break;
-         }
-      }
-
-      else if (ok != ExportResult::Success) {
-         break;
-      }
-      // increment export counter
-      count++;
-   }
-
-
-   return ok ;
+   return DoExportSplit(plugin, formatIndex, parameters, true,
+      [&](size_t index) {
+         /* Select the track, for the mixer that is made next */
+         for (auto tr : exportedTracks)
+            tr->SetSelected(false);
+         exportedTracks[index]->SetSelected(true);
+      }, exporterFiles);
 }
 
-ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
-                                         int formatIndex,
-                                         const ExportProcessor::Parameters& parameters,
-                                         const wxFileName& filename,
-                                         int channels,
-                                         double t0, double t1, bool selectedOnly,
-                                         const Tags& tags,
-                                         FilePaths& exportedFiles)
+ExportResult ExportAudioDialog::DoExportSplit(const ExportPlugin& plugin,
+                                              int formatIndex,
+                                              const ExportProcessor::Parameters& parameters,
+                                              bool selectedOnly,
+                                              const std::function<void(size_t)>& select,
+                                              FilePaths& exportedFiles)
 {
-   wxFileName name;
-
-   wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (filename.GetFullName()));
-   wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), channels, t0, t1);
-   if (selectedOnly)
-      wxLogDebug(wxT("Selected Region Only"));
-   else
-      wxLogDebug(wxT("Whole Project"));
-
-   wxFileName backup;
-   if (mOverwriteExisting->GetValue()) {
-      name = filename;
-      backup.Assign(name);
-
-      int suffix = 0;
-      do {
-         backup.SetName(name.GetName() +
-                           wxString::Format(wxT("%d"), suffix));
-         ++suffix;
-      }
-      while (backup.FileExists());
-      ::wxRenameFile(filename.GetFullPath(), backup.GetFullPath());
-   }
-   else {
-      name = filename;
-      int i = 2;
-      wxString base(name.GetName());
-      while (name.FileExists()) {
-         name.SetName(wxString::Format(wxT("%s-%d"), base, i++));
-      }
-   }
+   // Files are written at the same time only when the encoder allows it, and
+   // when no two of them may have the same name
+   auto concurrent = plugin.SupportsConcurrentExport(formatIndex);
+   std::set<wxString> paths;
+   for (const auto& setting : mExportSettings)
+      if (!setting.filename.GetName().empty() &&
+          !paths.insert(setting.filename.GetFullPath()).second)
+         concurrent = false;
+
+   struct ExportedFile
+   {
+      wxFileName backup;
+      wxString fullPath;
+   };
+   std::vector<ExportedFile> files(mExportSettings.size());
 
-   bool success{false};
-   const wxString fullPath{name.GetFullPath()};
-
-   auto cleanup = finally( [&] {
-      if (backup.IsOk()) {
-         if ( success )
-            // Remove backup
-            ::wxRemoveFile(backup.GetFullPath());
-         else {
-            // Restore original
-            ::wxRemoveFile(fullPath);
-            ::wxRenameFile(backup.GetFullPath(), fullPath);
+   auto ok = ExportResult::Success;   // did it work?
+   bool proceed = true;
+   bool askedToContinue = false;
+   ExportProgressUI::ShowBatch(mExportSettings.size(),
+      [&](size_t index) -> ExportTask
+      {
+         /* get the settings to use for the export from the array */
+         const auto& activeSetting = mExportSettings[index];
+         // Bug 1440 fix.
+         if( activeSetting.filename.GetName().empty() )
+            return {};
+
+         wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (activeSetting.filename.GetFullName()));
+         wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), activeSetting.channels, activeSetting.t0, activeSetting.t1);
+         if (selectedOnly)
+            wxLogDebug(wxT("Selected Region Only"));
+         else
+            wxLogDebug(wxT("Whole Project"));
+
+         auto& file = files[index];
+         file.fullPath = PrepareExportFile(activeSetting.filename,
+            mOverwriteExisting->GetValue(), file.backup);
+         if (select)
+            select(index);
+
+         return ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
+                                   .SetParameters(parameters)
+                                   .SetRange(activeSetting.t0, activeSetting.t1, selectedOnly)
+                                   .SetTags(&activeSetting.tags)
+                                   .SetNumChannels(activeSetting.channels)
+                                   .SetFileName(file.fullPath)
+                                   .SetSampleRate(mExportOptionsPanel->GetSampleRate())
+                                   .Build(mProject);
+      },
+      [&](size_t index, ExportResult result)
+      {
+         const auto& file = files[index];
+         const auto success =
+            result == ExportResult::Success || result == ExportResult::Stopped;
+         FinishExportFile(file.backup, file.fullPath, success);
+         if (success)
+            exportedFiles.push_back(file.fullPath);
+
+         // Files that were running when the batch stopped finish anyway
+         if (!proceed)
+            return false;
+         ok = result;
+
+         if (ok == ExportResult::Stopped) {
+            // Files stopped together are asked about once
+            if (askedToContinue)
+               return true;
+            askedToContinue = true;
+            AudacityMessageDialog dlgMessage(
+               nullptr,
+               XO("Continue to export remaining files?"),
+               XO("Export"),
+               wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
+            if (dlgMessage.ShowModal() != wxID_YES ) {
+               // User decided not to continue - bail out!
+               proceed = false;
+            }
+            return proceed;
          }
-      }
-      else {
-         if ( ! success )
-            // Remove any new, and only partially written, file.
-            ::wxRemoveFile(fullPath);
-      }
-   } );
+         askedToContinue = false;
+         if (ok != ExportResult::Success)
+            proceed = false;
+         return proceed;
+      },
+      concurrent ? std::thread::hardware_concurrency() : 1);
 
-   auto result = ExportResult::Error;
-   ExportProgressUI::ExceptionWrappedCall([&]
-   {
-      result = ExportProgressUI::Show(ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
-                                    .SetParameters(parameters)
-                                    .SetRange(t0, t1, selectedOnly)
-                                    .SetTags(&tags)
-                                    .SetNumChannels(channels)
-                                    .SetFileName(fullPath)
-                                    .SetSampleRate(mExportOptionsPanel->GetSampleRate())
-                                    .Build(mProject));
-   });
-
-   success = result == ExportResult::Success || result == ExportResult::Stopped;
-
-   if(success)
-      exportedFiles.push_back(fullPath);
-
-   return result;
+   return ok;
 }
 
 
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "wxPanelWrapper.h"
 #include "ExportTypes.h"
 #include <wx/filename.h>
@@ -102,14 +104,18 @@ private:
                                       const ExportProcessor::Parameters& parameters,
                                       FilePaths& exporterFiles);
    
-   ExportResult DoExport(const ExportPlugin& plugin,
-                         int formatIndex,
-                         const ExportProcessor::Parameters& parameters,
-                         const wxFileName& filename,
-                         int channels,
-                         double t0, double t1, bool selectedOnly,
-                         const Tags& tags,
-                         FilePaths& exportedFiles);
+   /*!
+    Exports a file for each of mExportSettings, several at once when the
+    plugin supports it
+    @param select if not empty, called with the index of a setting before its
+    export task is made
+    */
+   ExportResult DoExportSplit(const ExportPlugin& plugin,
+                              int formatIndex,
+                              const ExportProcessor::Parameters& parameters,
+                              bool selectedOnly,
+                              const std::function<void(size_t)>& select,
+                              FilePaths& exportedFiles);
    
    AudacityProject& mProject;
 
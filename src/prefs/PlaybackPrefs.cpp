@@ -24,8 +24,10 @@
 #include <wx/defs.h>
 #include <wx/textctrl.h>
 
+#include "AudioIO.h"
 #include "ShuttleGui.h"
 #include "Prefs.h"
+#include "StretchedClipCache.h"
 
 PlaybackPrefs::PlaybackPrefs(wxWindow * parent, wxWindowID winid)
 :  PrefsPanel(parent, winid, XO("Playback"))
@@ -152,8 +154,19 @@ void PlaybackPrefs::PopulateOrExchange(ShuttleGui & S)
          S.TieCheckBox(XXO("Always scrub un&pinned"),
             {UnpinnedScrubbingPreferenceKey(),
              UnpinnedScrubbingPreferenceDefault()});
+         S.TieCheckBox(XXO("&Render stretched clips in the background"),
+            StretchedClipRendering);
       }
       S.EndVerticalLay();
+
+      S.StartTwoColumn();
+      {
+         S.TieSpinCtrl(XXO("Track processing &threads (0 = automatic):"),
+            AudioIOPlaybackThreads, 64, 0);
+         S.TieSpinCtrl(XXO("Memory for rendered stretched &clips (MB):"),
+            StretchedClipCacheSize, 4096, 0);
+      }
+      S.EndTwoColumn();
    }
    S.EndStatic();
 
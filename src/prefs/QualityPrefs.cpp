@@ -26,8 +26,10 @@
 #include "AudioIOBase.h"
 #include "Dither.h"
 #include "Prefs.h"
+#include "ProjectFileIO.h"
 #include "Resample.h"
 #include "ShuttleGui.h"
+#include "SpectrogramTileStore.h"
 
 //////////
 BEGIN_EVENT_TABLE(QualityPrefs, PrefsPanel)
@@ -104,6 +106,21 @@ void QualityPrefs::PopulateOrExchange(ShuttleGui & S)
       S.EndMultiColumn();
    }
    S.EndStatic();
+
+   S.StartStatic(XO("Project Storage"));
+   {
+      S.StartMultiColumn(2);
+      {
+         S.TieChoice(XXO("Sample &compression:"),
+                     SampleBlockCodecSetting);
+      }
+      S.EndMultiColumn();
+      S.AddFixedText(
+         XO("Applies to projects opened after the change."));
+      S.TieCheckBox(XXO("&Keep computed spectrograms in the project file"),
+                    SpectrogramTileCacheSetting);
+   }
+   S.EndStatic();
    S.EndScroller();
 
 }
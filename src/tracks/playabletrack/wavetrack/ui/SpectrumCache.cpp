@@ -14,10 +14,16 @@
 #include "RealFFTf.h"
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "SpectrogramTileStore.h"
 #include "WaveClipUIUtilities.h"
 #include "WaveTrack.h"
 #include "WideSampleSequence.h"
+#include "concurrency/ParallelChunks.h"
+#include "spectrogram/SpectrogramColumns.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <unordered_map>
 
 namespace {
 
@@ -70,6 +76,112 @@ void ComputeSpectrogramGainFactors
    }
 }
 
+//! Levels in spectrogram tiles are in these units
+constexpr float TileLevelsPerDB = 100.0f;
+//! Change it when tile contents are computed differently, so that tiles
+//! stored by earlier versions are not found
+constexpr unsigned long long TileFormat = 1;
+
+//! FNV-1a
+struct TileHash
+{
+   void Add(unsigned long long x)
+   {
+      for (int ii = 0; ii < 8; ++ii) {
+         value ^= (x >> (8 * ii)) & 0xff;
+         value *= 1099511628211ull;
+      }
+   }
+   unsigned long long value = 14695981039346656037ull;
+};
+
+unsigned long long TileParams(const SpectrogramSettings &settings, int rate)
+{
+   TileHash hash;
+   hash.Add(TileFormat);
+   hash.Add(settings.windowType);
+   hash.Add(settings.WindowSize());
+   hash.Add(settings.ZeroPaddingFactor());
+   hash.Add(settings.frequencyGain);
+   // The gain factors depend on the rate only when there is gain
+   if (settings.frequencyGain > 0)
+      hash.Add(rate);
+   return hash.value;
+}
+
+//! Hash the ids of blocks from which the columns of a tile read samples
+unsigned long long TileContext(
+   const BlockArray &blocks, size_t iBlock, size_t windowSize)
+{
+   const auto half = sampleCount(windowSize / 2);
+   const auto &block = blocks[iBlock];
+   auto first = iBlock, last = iBlock;
+   while (first > 0 && blocks[first].start > block.start - half)
+      --first;
+   const auto end = block.start + block.sb->GetSampleCount();
+   while (last + 1 < blocks.size() && blocks[last + 1].start < end + half)
+      ++last;
+
+   TileHash hash;
+   for (auto ii = first; ii <= last; ++ii)
+      hash.Add(blocks[ii].sb->GetBlockID());
+   return hash.value;
+}
+
+int16_t EncodeLevel(float dB)
+{
+   return static_cast<int16_t>(std::clamp<long>(
+      lrintf(dB * TileLevelsPerDB), INT16_MIN, INT16_MAX));
+}
+
+float DecodeLevel(int16_t level)
+{
+   return level / TileLevelsPerDB;
+}
+
+//! Compute the plain STFT column centered at `center` in the whole sequence,
+//! ignoring any trimming of the clip
+void ComputeSequenceColumn(
+   const SpectrogramSettings &settings, const Sequence &sequence,
+   sampleCount center, const std::vector<float> &gainFactors,
+   float * __restrict scratch, float * __restrict out)
+{
+   const size_t windowSize = settings.WindowSize();
+   const size_t zeroPaddingFactor = settings.ZeroPaddingFactor();
+   const size_t padding = (windowSize * (zeroPaddingFactor - 1)) / 2;
+   const size_t fftLen = windowSize * zeroPaddingFactor;
+   const auto numSamples = sequence.GetNumSamples();
+
+   // Take a window of the sequence centered at this sample, padded with
+   // zeroes beyond its ends
+   float *adj = scratch + padding;
+   auto from = center - windowSize / 2;
+   auto myLen = windowSize;
+   if (from < 0) {
+      const auto lead = (-from).as_size_t();
+      std::fill(adj, adj + lead, 0.0f);
+      adj += lead;
+      myLen -= lead;
+      from = 0;
+   }
+   if (from + myLen > numSamples) {
+      const auto newLen = (numSamples - from).as_size_t();
+      std::fill(adj + newLen, adj + myLen, 0.0f);
+      myLen = newLen;
+   }
+   if (myLen > 0) {
+      constexpr auto mayThrow = false; // Don't throw just for display
+      sequence.GetFloatSampleView(from, myLen, mayThrow).Copy(adj, myLen);
+   }
+
+   // The window is zero in the padding, so the scratch there need not be
+   // cleared
+   ComputeSpectrumUsingRealFFTf(
+      scratch, settings.hFFT.get(), settings.window.get(), fftLen, out);
+   for (size_t ii = 0; ii < gainFactors.size(); ++ii)
+      out[ii] += gainFactors[ii];
+}
+
 }
 
 bool SpecCache::Matches(
@@ -91,11 +203,14 @@ bool SpecCache::Matches(
       algorithm == settings.algorithm;
 }
 
+template<typename Add>
 bool SpecCache::CalculateOneSpectrum(
    const SpectrogramSettings& settings, const WaveChannelInterval& clip,
    const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
    const std::vector<float>& gainFactors, float* __restrict scratch,
-   float* __restrict out) const
+   float* __restrict out,
+   std::optional<AudioSegmentSampleView> &sampleCacheHolder,
+   const Add &add) const
 {
    bool result = false;
    const bool reassignment =
@@ -127,7 +242,10 @@ bool SpecCache::CalculateOneSpectrum(
    auto nBins = settings.NBins();
 
    if (from < 0 || from >= numSamples) {
-      if (xx >= 0 && xx < (int)len) {
+      // With reassignment the column is already zeroed, and filling it again
+      // would undo powers that other columns added, but only if they came
+      // first, as they don't when columns are computed in parallel
+      if (!reassignment && xx >= 0 && xx < (int)len) {
          // Pixel column is out of bounds of the clip!  Should not happen.
          float *const results = &out[nBins * xx];
          std::fill(results, results + nBins, 0.0f);
@@ -169,10 +287,10 @@ bool SpecCache::CalculateOneSpectrum(
          if (myLen > 0) {
             constexpr auto iChannel = 0u;
             constexpr auto mayThrow = false; // Don't throw just for display
-            mSampleCacheHolder.emplace(
+            sampleCacheHolder.emplace(
                clip.GetSampleView(from, myLen, mayThrow));
             floats.resize(myLen);
-            mSampleCacheHolder->Copy(floats.data(), myLen);
+            sampleCacheHolder->Copy(floats.data(), myLen);
             useBuffer = floats.data();
             if (copy) {
                if (useBuffer)
@@ -280,13 +398,8 @@ bool SpecCache::CalculateOneSpectrum(
 
                   // This is non-negative, because bin and correctedX are
                   auto ind = (int)nBins * correctedX + bin;
-#ifdef _OPENMP
-                  // This assignment can race if index reaches into another thread's bins.
-                  // The probability of a race very low, so this carries little overhead,
-                  // about 5% slower vs allowing it to race.
-                  #pragma omp atomic update
-#endif
-                  out[ind] += power;
+                  // The index may reach into columns of other threads
+                  add(ind, power);
                }
             }
          }
@@ -359,110 +472,174 @@ void SpecCache::Populate(
 
    const size_t bufferSize = fftLen;
    const size_t scratchSize = reassignment ? 3 * bufferSize : bufferSize;
-   std::vector<float> scratch(scratchSize);
 
    std::vector<float> gainFactors;
    if (!autocorrelation)
       ComputeSpectrogramGainFactors(
          fftLen, sampleRate, frequencyGainSetting, gainFactors);
 
+   // Only the main thread populates caches, and it takes part in the work
+   using namespace audacity::concurrency;
+   auto &pool = WorkStealingPool::GetShared();
+
+   // Need to look beyond the edges of the ranges to accumulate more time
+   // reassignments
+   const double pixelsPerSample =
+      pixelsPerSecond * clip.GetStretchRatio() / sampleRate;
+   const int edgeLimit = std::min((int)(0.5 + fftLen * pixelsPerSample), 100);
+
+   // Each chunk of columns has its own scratch space and sample view
+   struct ColumnState {
+      std::vector<float> scratch;
+      std::optional<AudioSegmentSampleView> sampleCacheHolder;
+   };
+   const auto makeState = [&]{
+      return ColumnState{ std::vector<float>(scratchSize), {} };
+   };
+
    // Loop over the ranges before and after the copied portion and compute anew.
    // One of the ranges may be empty.
    for (int jj = 0; jj < 2; ++jj) {
       const int lowerBoundX = jj == 0 ? 0 : copyEnd;
       const int upperBoundX = jj == 0 ? copyBegin : numPixels;
+      ComputeSpectrogramColumns(&pool, reassignment, lowerBoundX, upperBoundX,
+         edgeLimit, nBins, freq.data(), gainFactors, makeState,
+         [&](ColumnState &state, int xx, const auto &add) {
+            return CalculateOneSpectrum(
+               settings, clip, xx, pixelsPerSecond, lowerBoundX, upperBoundX,
+               gainFactors, state.scratch.data(), freq.data(),
+               state.sampleCacheHolder, add);
+         });
+   }
+}
 
-// todo(mhodgkinson): I don't find an option to define _OPENMP anywhere. Is this
-// still of interest?
-#ifdef _OPENMP
-      // Storage for mutable per-thread data.
-      // private clause ensures one copy per thread
-      struct ThreadLocalStorage {
-         ThreadLocalStorage()  { }
-         ~ThreadLocalStorage() { }
-
-         void init(SampleTrackCache &waveTrackCache, size_t scratchSize) {
-            if (!cache) {
-               cache = std::make_unique<SampleTrackCache>(waveTrackCache.GetTrack());
-               scratch.resize(scratchSize);
-            }
-         }
-         std::unique_ptr<SampleTrackCache> cache;
-         std::vector<float> scratch;
-      } tls;
-
-      #pragma omp parallel for private(tls)
-#endif
-      for (auto xx = lowerBoundX; xx < upperBoundX; ++xx)
-      {
-#ifdef _OPENMP
-         tls.init(waveTrackCache, scratchSize);
-         SampleTrackCache& cache = *tls.cache;
-         float* buffer = &tls.scratch[0];
-#else
-         float* buffer = &scratch[0];
-#endif
-         CalculateOneSpectrum(
-            settings, clip, xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-            gainFactors, buffer, &freq[0]);
+bool SpecCache::PopulateFromTiles(SpectrogramTileStore &store,
+   const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+   int copyBegin, int copyEnd, size_t numPixels)
+{
+   const size_t windowSize = settings.WindowSize();
+   if (settings.algorithm != SpectrogramSettings::algSTFT || spp < windowSize)
+      return false;
+
+   // Columns of tiles are at most a pixel apart.  Their spacing is the window
+   // size times a power of two, so that nearby zoom levels share tiles.
+   size_t hop = windowSize;
+   while (2 * hop <= spp)
+      hop *= 2;
+
+   const auto &sequence = clip.GetSequence();
+   const auto &blocks = sequence.GetBlockArray();
+   const auto numSamples = sequence.GetNumSamples();
+   const auto offset = clip.TimeToSamples(clip.GetTrimLeft());
+   const auto nBins = settings.NBins();
+   const auto params = TileParams(settings, clip.GetRate());
+
+   const auto forEachDirty = [&](const auto &f) {
+      for (int jj = 0; jj < 2; ++jj) {
+         const int lowerBoundX = jj == 0 ? 0 : copyEnd;
+         const int upperBoundX = jj == 0 ? copyBegin : numPixels;
+         for (int xx = lowerBoundX; xx < upperBoundX; ++xx)
+            f(xx);
       }
+   };
+
+   // Find the blocks under the dirty columns, and look up their tiles
+   using Tile = SpectrogramTileStore::Tile;
+   std::vector<int> columnBlocks(numPixels, -1);
+   std::unordered_map<int, size_t> tileIndices;
+   std::vector<Tile> tiles;
+   forEachDirty([&](int xx) {
+      const auto pos = where[xx] + offset;
+      if (pos < 0 || pos >= numSamples)
+         // Should not happen
+         return;
+      const auto iBlock = sequence.FindBlock(pos);
+      columnBlocks[xx] = iBlock;
+      if (tileIndices.emplace(iBlock, tiles.size()).second) {
+         const auto &block = blocks[iBlock];
+         const auto nColumns =
+            std::max<size_t>(1, (block.sb->GetSampleCount() + hop - 1) / hop);
+         tiles.push_back({ { block.sb->GetBlockID(), params, nColumns },
+            TileContext(blocks, iBlock, windowSize), {} });
+      }
+   });
+
+   std::vector<size_t> missing;
+   for (size_t ii = 0; ii < tiles.size(); ++ii) {
+      auto &tile = tiles[ii];
+      if (!store.Load(tile.key, tile.context, tile.data) ||
+          tile.data.size() != tile.key.nColumns * nBins)
+         missing.push_back(ii);
+   }
 
-      if (reassignment) {
-         // Need to look beyond the edges of the range to accumulate more
-         // time reassignments.
-         // I'm not sure what's a good stopping criterion?
-         auto xx = lowerBoundX;
-         const double pixelsPerSample =
-            pixelsPerSecond * clip.GetStretchRatio() / sampleRate;
-         const int limit = std::min((int)(0.5 + fftLen * pixelsPerSample), 100);
-         for (int ii = 0; ii < limit; ++ii)
-         {
-            const bool result = CalculateOneSpectrum(
-               settings, clip, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-               gainFactors, &scratch[0], &freq[0]);
-            if (!result)
-               break;
-         }
-
-         xx = upperBoundX;
-         for (int ii = 0; ii < limit; ++ii)
-         {
-            const bool result = CalculateOneSpectrum(
-               settings, clip, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
-               gainFactors, &scratch[0], &freq[0]);
-            if (!result)
-               break;
-         }
-
-         // Now Convert to dB terms.  Do this only after accumulating
-         // power values, which may cross columns with the time correction.
-#ifdef _OPENMP
-         #pragma omp parallel for
-#endif
-         for (xx = lowerBoundX; xx < upperBoundX; ++xx) {
-            float *const results = &freq[nBins * xx];
-            for (size_t ii = 0; ii < nBins; ++ii) {
-               float &power = results[ii];
-               if (power <= 0)
-                  power = -160.0;
-               else
-                  power = 10.0*log10f(power);
-            }
-            if (!gainFactors.empty()) {
-               // Apply a frequency-dependent gain factor
-               for (size_t ii = 0; ii < nBins; ++ii)
-                  results[ii] += gainFactors[ii];
+   if (!missing.empty()) {
+      const size_t fftLen = windowSize * settings.ZeroPaddingFactor();
+      std::vector<float> gainFactors;
+      ComputeSpectrogramGainFactors(
+         fftLen, clip.GetRate(), settings.frequencyGain, gainFactors);
+
+      std::vector<int> tileBlocks(tiles.size());
+      for (const auto [iBlock, ii] : tileIndices)
+         tileBlocks[ii] = iBlock;
+
+      using namespace audacity::concurrency;
+      ParallelChunks(&WorkStealingPool::GetShared(), missing.size(), 1,
+         [&](size_t begin, size_t end) {
+         std::vector<float> scratch(fftLen);
+         std::vector<float> column(nBins);
+         for (auto ii = begin; ii < end; ++ii) {
+            auto &tile = tiles[missing[ii]];
+            const auto &block = blocks[tileBlocks[missing[ii]]];
+            const auto blockLen = block.sb->GetSampleCount();
+            const auto nColumns = tile.key.nColumns;
+            tile.data.resize(nColumns * nBins);
+            for (size_t gg = 0; gg < nColumns; ++gg) {
+               // Center each column in its share of the block
+               const auto center = block.start +
+                  sampleCount((2 * gg + 1) * blockLen / (2 * nColumns));
+               ComputeSequenceColumn(settings, sequence, center, gainFactors,
+                  scratch.data(), column.data());
+               std::transform(column.begin(), column.end(),
+                  tile.data.begin() + gg * nBins, EncodeLevel);
             }
          }
+      });
+   }
+
+   forEachDirty([&](int xx) {
+      float *const results = &freq[nBins * xx];
+      const auto iBlock = columnBlocks[xx];
+      if (iBlock < 0) {
+         std::fill(results, results + nBins, 0.0f);
+         return;
       }
+      const auto &block = blocks[iBlock];
+      const auto &tile = tiles[tileIndices[iBlock]];
+      const auto nColumns = tile.key.nColumns;
+      const auto gg = std::min(nColumns - 1,
+         (where[xx] + offset - block.start).as_size_t() * nColumns /
+            block.sb->GetSampleCount());
+      const auto levels = tile.data.begin() + gg * nBins;
+      std::transform(levels, levels + nBins, results, DecodeLevel);
+   });
+
+   // Written when the application is next idle
+   if (!missing.empty()) {
+      std::vector<Tile> computed;
+      computed.reserve(missing.size());
+      for (auto ii : missing)
+         computed.push_back(std::move(tiles[ii]));
+      store.Store(std::move(computed));
    }
+
+   return true;
 }
 
 bool WaveClipSpectrumCache::GetSpectrogram(
    const WaveChannelInterval &clip,
    const float*& spectrogram, SpectrogramSettings& settings,
    const sampleCount*& where, size_t numPixels, double t0,
-   double pixelsPerSecond)
+   double pixelsPerSecond, SpectrogramTileStore *pTileStore)
 
 {
    auto &mSpecCache = mSpecCaches[clip.GetChannelIndex()];
@@ -562,8 +739,10 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       mSpecCache->where, numPixels, addBias, correction, t0, sampleRate,
       stretchRatio, samplesPerPixel);
 
-   mSpecCache->Populate(
-      settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
+   if (!(pTileStore && mSpecCache->PopulateFromTiles(
+      *pTileStore, settings, clip, copyBegin, copyEnd, numPixels)))
+      mSpecCache->Populate(
+         settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
 
    mSpecCache->dirty = mDirty;
    spectrogram = &mSpecCache->freq[0];
@@ -13,6 +13,7 @@
 
 class sampleCount;
 class SpectrogramSettings;
+class SpectrogramTileStore;
 class WaveClipChannel;
 using WaveChannelInterval = WaveClipChannel;
 class WideSampleSequence;
@@ -55,6 +56,18 @@ public:
       const SpectrogramSettings& settings, const WaveChannelInterval& clip,
       int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond);
 
+   //! Like Populate, but copy the dirty columns from tiles of whole sample
+   //! blocks, computing and storing only the tiles not found in `store`
+   /*!
+    Each column is taken from the nearest column of a tile, which is less
+    than a pixel away.
+    @return false, having done nothing, if the algorithm is not plain STFT,
+    or if zoomed in so far that a pixel is narrower than the window
+    */
+   bool PopulateFromTiles(SpectrogramTileStore &store,
+      const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+      int copyBegin, int copyEnd, size_t numPixels);
+
    size_t       len { 0 }; // counts pixels, not samples
    int          algorithm;
    double       spp; // samples per pixel
@@ -72,13 +85,20 @@ public:
 
 private:
    // Calculate one column of the spectrum
+   /*!
+    @param sampleCacheHolder keeps the last samples read alive for the next
+    column; each thread must have its own
+    @param add called as add(index, power) to accumulate reassigned power
+    into out[index]
+    */
+   template<typename Add>
    bool CalculateOneSpectrum(
       const SpectrogramSettings& settings, const WaveChannelInterval &clip,
       const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
       const std::vector<float>& gainFactors, float* __restrict scratch,
-      float* __restrict out) const;
-
-   mutable std::optional<AudioSegmentSampleView> mSampleCacheHolder;
+      float* __restrict out,
+      std::optional<AudioSegmentSampleView> &sampleCacheHolder,
+      const Add &add) const;
 };
 
 class SpecPxCache {
@@ -128,7 +148,9 @@ struct WaveClipSpectrumCache final : WaveClipListener
       const float *&spectrogram,
       SpectrogramSettings &spectrogramSettings,
       const sampleCount *&where, size_t numPixels,
-      double t0 /*absolute time*/, double pixelsPerSecond);
+      double t0 /*absolute time*/, double pixelsPerSecond,
+      //! If not null, where to find and keep columns for other sessions
+      SpectrogramTileStore *pTileStore = nullptr);
 
    void MakeStereo(WaveClipListener &&other, bool aligned) override;
    void SwapChannels() override;
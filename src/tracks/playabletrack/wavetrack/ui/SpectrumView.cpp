@@ -16,6 +16,7 @@ Paul Licameli split from WaveChannelView.cpp
 
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "SpectrogramTileStore.h"
 
 #include "ClipParameters.h"
 #include "SpectrumVRulerControls.h"
@@ -424,9 +425,14 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
    const double binUnit = sampleRate / (2 * half);
    const float *freq = 0;
    const sampleCount *where = 0;
+   SpectrogramTileStore *pTileStore = nullptr;
+   if (SpectrogramTileCacheSetting.Read())
+      if (const auto pTrackList = channel.GetTrack().GetOwner())
+         if (const auto pProject = pTrackList->GetOwner())
+            pTileStore = &SpectrogramTileStore::Get(*pProject);
    bool updated = WaveClipSpectrumCache::Get(clip).GetSpectrogram(
       clip, freq, settings, where, (size_t)hiddenMid.width, t0,
-      averagePixelsPerSecond);
+      averagePixelsPerSecond, pTileStore);
    auto nBins = settings.NBins();
 
    float minFreq, maxFreq;
@@ -30,6 +30,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
 #include "../../../../TrackPanelDrawingContext.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelMouseEvent.h"
 #include "ViewInfo.h"
 #include "WaveChannelUtilities.h"
@@ -45,6 +46,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include <wx/dc.h>
 
 #include <wx/dcmemory.h>
+#include <wx/weakref.h>
 #include "waveform/WaveBitmapCache.h"
 #include "waveform/WaveDataCache.h"
 #include "waveform/WavePaintParameters.h"
@@ -235,6 +237,9 @@ public:
       {
          auto dataCache = std::make_shared<WaveDataCache>(clip, channelIndex);
 
+         // Stored blocks are read in the background; repaint when they arrive
+         dataCache->SetDataReadyCallback(mDataReady);
+
          auto bitmapCache = std::make_unique<WaveBitmapCache>(
             clip, dataCache,
             [] { return std::make_unique<WaveBitmapCacheElementWX>(); });
@@ -246,6 +251,12 @@ public:
       return *this;
    }
 
+   //! Sets the window to refresh when data read in the background arrive
+   void SetRepaintWindow(wxWindow* window)
+   {
+      *mRepaintWindow = window;
+   }
+
    void SetSelection(const ZoomInfo& zoomInfo, float t0, float t1, bool selected)
    {
       for (auto& channelCache : mChannelCaches)
@@ -324,8 +335,23 @@ private:
       std::unique_ptr<WaveBitmapCache> BitmapCache;
    };
 
+   //! Used only on the main thread, and shared weakly with the callbacks of
+   //! the data caches
+   using RepaintWindow = wxWeakRef<wxWindow>;
+
    std::vector<ChannelCaches> mChannelCaches;
    std::atomic<bool> mChanged = false;
+   const std::shared_ptr<RepaintWindow> mRepaintWindow =
+      std::make_shared<RepaintWindow>();
+   //! Shared by the caches of all channels, so that data that arrive
+   //! together cause one repaint
+   const GraphicsDataCacheBase::DataReadyCallback mDataReady =
+      GraphicsDataCacheBase::CoalescedRefresh(
+         [window = std::weak_ptr<RepaintWindow>(mRepaintWindow)]
+         {
+            if (const auto pWindow = window.lock(); pWindow && *pWindow)
+               (*pWindow)->Refresh(false);
+         });
 };
 
 void DrawWaveform(
@@ -366,6 +392,7 @@ void DrawWaveform(
          ColorFromWXPen(muted ? artist->muteClippedPen : artist->clippedPen))
       .SetEnvelope(clip.GetEnvelope());
 
+   clipPainter.SetRepaintWindow(artist->parent);
    clipPainter.SetSelection(
       zoomInfo, artist->pSelectedRegion->t0() - sequenceStartTime,
       artist->pSelectedRegion->t1() - sequenceStartTime,